@@ -0,0 +1,204 @@
+/// @file BCMetrics.h
+/// @brief The fixed size registry of the clock's counters and gauges, rendered in the Prometheus
+///        text format.
+/// @details The values are set where they are measured (e.g. the time task, the NTP syncs, the WiFi
+///          events) and read by the metrics server (`BinaryClockMetrics`) on each scrape:
+///          - the registry is a fixed array indexed by `BCMetric`, the names and help texts are a
+///            constant table; nothing is allocated, `Render()` writes into the caller's buffer;
+///          - each metric has one writer and a value is one 32 bit word, it is written and read
+///            whole without a lock so a scrape never blocks the time task;
+///          - a gauge that was never set (`BC_METRIC_UNSET`) isn't rendered, e.g. the stack of a
+///            task that isn't running; the counters are always rendered.
+///          The metrics with the same name (e.g. `bc_stack_free_bytes`) are consecutive in the
+///          table, their `task` label tells them apart.
+/// @note    No Arduino or FreeRTOS dependencies, the same code can be checked on the host.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_METRICS_H__
+#define __BC_METRICS_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// For size_t
+#include <stdio.h>                     /// For snprintf()
+#include <string.h>                    /// For strcmp()
+
+#define BC_METRIC_UNSET   INT32_MIN    ///< The value of a gauge that was never set, not rendered.
+
+namespace BinaryClockShield
+   {
+   /// @brief The metrics of the clock, the index in the registry.
+   enum class BCMetric : uint8_t
+      {
+      TickLatencyUs = 0,               ///< Gauge: the time (µs) from the RTC tick interrupt to the time read.
+      TickLatencyMaxUs,                ///< Gauge: the largest tick latency (µs) since boot.
+      Ticks,                           ///< Counter: the RTC ticks dispatched.
+      TicksMissed,                     ///< Counter: the RTC seconds skipped between two dispatched ticks.
+      I2CTransactions,                 ///< Counter: the I2C transactions made with the RTC.
+      NtpOffsetUs,                     ///< Gauge: the offset (µs) of the last NTP sync, server - system time.
+      NtpDelayUs,                      ///< Gauge: the round trip delay (µs) of the last NTP query.
+      NtpSyncs,                        ///< Counter: the successful NTP syncs.
+      NtpFailures,                     ///< Counter: the failed NTP syncs.
+      WiFiRssi,                        ///< Gauge: the signal strength (dBm) of the AP, sampled on the scrape.
+      WiFiReconnects,                  ///< Counter: the WiFi connections lost and reconnected.
+      HeapFree,                        ///< Gauge: the free heap (bytes), sampled on the scrape.
+      HeapMinFree,                     ///< Gauge: the lowest free heap (bytes) since boot.
+      StackTimeTask,                   ///< Gauge: the stack high water mark (bytes) of the time task.
+      StackCallbackTask,               ///< Gauge: the stack high water mark (bytes) of the callback task.
+      StackDutyTask,                   ///< Gauge: the stack high water mark (bytes) of the WiFi duty cycle task.
+      StackMetricsTask,                ///< Gauge: the stack high water mark (bytes) of the metrics server task.
+      Count                            ///< The number of metrics, not a metric.
+      };
+
+   /// @brief The type of a metric, the Prometheus `# TYPE`.
+   enum class BCMetricType : uint8_t
+      {
+      Counter = 0,                     ///< Only goes up, reset by a reboot.
+      Gauge                            ///< Goes up and down.
+      };
+
+   /// @brief The constant description of a metric.
+   struct BCMetricInfo
+      {
+      const char*  name;               ///< The metric name, e.g. "bc_ticks_total".
+      const char*  help;               ///< The `# HELP` text.
+      BCMetricType type;               ///< Counter or gauge.
+      const char*  task;               ///< The `task` label (also the FreeRTOS task name), `nullptr` for none.
+      };
+
+   /// @brief The fixed size metrics registry (Singleton pattern).
+   /// @author Chris-70 (2026/10)
+   class BCMetrics
+      {
+   public:
+      /// @brief Singleton access method for the `BCMetrics` instance.
+      static BCMetrics& get_Instance()
+         {
+         static BCMetrics instance;    // Guaranteed to be destroyed, instantiated on first use
+         return instance;
+         }
+
+      /// @brief Get the constant description of a metric.
+      static const BCMetricInfo& GetInfo(BCMetric metric)
+         {
+         static const BCMetricInfo table[] =
+            {
+            { "bc_tick_latency_us",        "The time (us) from the RTC tick interrupt to the time read, last tick.", BCMetricType::Gauge,   nullptr },
+            { "bc_tick_latency_max_us",    "The largest tick latency (us) since boot.",                              BCMetricType::Gauge,   nullptr },
+            { "bc_ticks_total",            "The RTC ticks dispatched to the display.",                               BCMetricType::Counter, nullptr },
+            { "bc_ticks_missed_total",     "The RTC seconds skipped between two dispatched ticks.",                  BCMetricType::Counter, nullptr },
+            { "bc_i2c_transactions_total", "The I2C transactions made with the RTC.",                                BCMetricType::Counter, nullptr },
+            { "bc_ntp_offset_us",          "The offset (us) of the last NTP sync, server - system time.",            BCMetricType::Gauge,   nullptr },
+            { "bc_ntp_delay_us",           "The round trip delay (us) of the last NTP query.",                       BCMetricType::Gauge,   nullptr },
+            { "bc_ntp_syncs_total",        "The successful NTP syncs.",                                              BCMetricType::Counter, nullptr },
+            { "bc_ntp_failures_total",     "The failed NTP syncs.",                                                  BCMetricType::Counter, nullptr },
+            { "bc_wifi_rssi_dbm",          "The signal strength (dBm) of the AP connected to.",                      BCMetricType::Gauge,   nullptr },
+            { "bc_wifi_reconnects_total",  "The WiFi connections lost, reconnected by the state machine.",           BCMetricType::Counter, nullptr },
+            { "bc_heap_free_bytes",        "The free heap (bytes).",                                                 BCMetricType::Gauge,   nullptr },
+            { "bc_heap_min_free_bytes",    "The lowest free heap (bytes) since boot.",                               BCMetricType::Gauge,   nullptr },
+            { "bc_stack_free_bytes",       "The stack high water mark (bytes) of the task, the least stack free.",   BCMetricType::Gauge,   "TimeTask" },
+            { "bc_stack_free_bytes",       "The stack high water mark (bytes) of the task, the least stack free.",   BCMetricType::Gauge,   "CallbackTask" },
+            { "bc_stack_free_bytes",       "The stack high water mark (bytes) of the task, the least stack free.",   BCMetricType::Gauge,   "WiFiDutyTask" },
+            { "bc_stack_free_bytes",       "The stack high water mark (bytes) of the task, the least stack free.",   BCMetricType::Gauge,   "MetricsTask" },
+            };
+         static_assert((sizeof(table) / sizeof(table[0])) == static_cast<size_t>(BCMetric::Count), "A BCMetric without a BCMetricInfo");
+
+         return table[static_cast<uint8_t>(metric)];
+         }
+
+      /// @brief Set a gauge, or a counter kept elsewhere (e.g. the RTC's I2C count).
+      void Set(BCMetric metric, int32_t value)
+         { values[static_cast<uint8_t>(metric)] = value; }
+
+      /// @brief Add to a counter.
+      void Add(BCMetric metric, uint32_t count = 1)
+         { values[static_cast<uint8_t>(metric)] = (int32_t)((uint32_t)values[static_cast<uint8_t>(metric)] + count); }
+
+      /// @brief Set a gauge to `value` if it is larger (or unset), e.g. a maximum since boot.
+      void Max(BCMetric metric, int32_t value)
+         {
+         int32_t current = values[static_cast<uint8_t>(metric)];
+         if ((current == BC_METRIC_UNSET) || (value > current)) { values[static_cast<uint8_t>(metric)] = value; }
+         }
+
+      /// @brief Set a gauge to `value` if it is smaller (or unset), e.g. a minimum since boot.
+      void Min(BCMetric metric, int32_t value)
+         {
+         int32_t current = values[static_cast<uint8_t>(metric)];
+         if ((current == BC_METRIC_UNSET) || (value < current)) { values[static_cast<uint8_t>(metric)] = value; }
+         }
+
+      /// @brief Clamp a 64 bit value (e.g. an offset in µs) to a gauge value, `BC_METRIC_UNSET` excluded.
+      static int32_t Clamp(int64_t value)
+         { return (value > INT32_MAX) ? INT32_MAX : ((value <= (int64_t)BC_METRIC_UNSET) ? (BC_METRIC_UNSET + 1) : (int32_t)value); }
+
+      /// @brief Get the value of a metric, `BC_METRIC_UNSET` for a gauge never set.
+      int32_t Get(BCMetric metric) const
+         { return values[static_cast<uint8_t>(metric)]; }
+
+      /// @brief Write the metrics in the Prometheus text format (version 0.0.4) into `buffer`.
+      /// @details Nothing is allocated, `snprintf()` writes into the buffer; the `# HELP` and
+      ///          `# TYPE` lines are written once for the consecutive metrics of the same name.
+      /// @param buffer The buffer, NUL terminated on success.
+      /// @param size The size of the buffer.
+      /// @return The length of the text, 0 if the buffer is too small.
+      /// @author Chris-70 (2026/10)
+      size_t Render(char* buffer, size_t size) const
+         {
+         size_t length = 0;
+         const char* lastName = nullptr;
+         for (uint8_t i = 0; i < static_cast<uint8_t>(BCMetric::Count); i++)
+            {
+            const BCMetricInfo& info = GetInfo(static_cast<BCMetric>(i));
+            int32_t value = values[i];   // Read once, the writer may change it.
+            bool counter = (info.type == BCMetricType::Counter);
+            if (!counter && (value == BC_METRIC_UNSET)) { continue; }
+
+            int written;
+            if ((lastName == nullptr) || (strcmp(lastName, info.name) != 0))
+               {
+               written = snprintf(buffer + length, size - length, "# HELP %s %s\n# TYPE %s %s\n",
+                                  info.name, info.help, info.name, (counter ? "counter" : "gauge"));
+               if ((written < 0) || ((size_t)written >= (size - length))) { return 0; }
+               length += (size_t)written;
+               lastName = info.name;
+               }
+
+            if (info.task != nullptr)
+               {
+               written = counter ? snprintf(buffer + length, size - length, "%s{task=\"%s\"} %lu\n", info.name, info.task, (unsigned long)(uint32_t)value)
+                                 : snprintf(buffer + length, size - length, "%s{task=\"%s\"} %ld\n", info.name, info.task, (long)value);
+               }
+            else
+               {
+               written = counter ? snprintf(buffer + length, size - length, "%s %lu\n", info.name, (unsigned long)(uint32_t)value)
+                                 : snprintf(buffer + length, size - length, "%s %ld\n", info.name, (long)value);
+               }
+            if ((written < 0) || ((size_t)written >= (size - length))) { return 0; }
+            length += (size_t)written;
+            }
+
+         return length;
+         }
+
+   protected:
+      /// @brief Protected constructor for Singleton pattern, the gauges start unset.
+      ///        Use `get_Instance()` to get the single instance.
+      /// @see get_Instance()
+      BCMetrics()
+         {
+         for (uint8_t i = 0; i < static_cast<uint8_t>(BCMetric::Count); i++)
+            { values[i] = (GetInfo(static_cast<BCMetric>(i)).type == BCMetricType::Counter) ? 0 : BC_METRIC_UNSET; }
+         }
+
+      /// @brief Removed copy constructor for Singleton pattern
+      BCMetrics(const BCMetrics&) = delete;
+      /// @brief Removed assignment operator for Singleton pattern
+      BCMetrics& operator=(const BCMetrics&) = delete;
+
+   private:
+      volatile int32_t values[static_cast<uint8_t>(BCMetric::Count)];   ///< The values, one word each.
+      }; // class BCMetrics
+   } // namespace BinaryClockShield
+
+#endif // __BC_METRICS_H__
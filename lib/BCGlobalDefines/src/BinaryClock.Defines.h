@@ -498,6 +498,35 @@
 #define HW_DEBUG_SETUP ((DEBUG_SETUP_PIN >= 0) && (SERIAL_SETUP_CODE))  ///< Include code to support H/W to control setup display
 #define HW_DEBUG_TIME  ((DEBUG_TIME_PIN  >= 0) && (SERIAL_TIME_CODE))   ///< Include code to support H/W to control time  display
 #define HARDWARE_DEBUG (HW_DEBUG_SETUP ||  HW_DEBUG_TIME)
+
+/// The binary serial command protocol (`BCSerialCommand`) used to provision the clock in bulk
+/// (e.g. time, alarm, colors, melody and WiFi credentials) from `test/bc_provision.py`.
+#ifndef SERIAL_COMMAND_CODE
+   #define SERIAL_COMMAND_CODE (SERIAL_SETUP_CODE && STL_USED)  ///< If (true) - binary command code included, (false) - code removed
+#endif
+
+/// The event engine (`BCEventEngine`) for the hourly chimes, countdown timers, snooze and software alarms.
+#ifndef EVENT_ENGINE_CODE
+   #define EVENT_ENGINE_CODE   STL_USED   ///< If (true) - event engine code included, (false) - code removed
+#endif
+
+/// The cron style alarm rules (`BCCronAlarm`), e.g. "30 6 * * MON-FRI", used to program the RTC alarms.
+#ifndef CRON_ALARM_CODE
+   #define CRON_ALARM_CODE     STL_USED   ///< If (true) - cron alarm code included, (false) - code removed
+#endif
+/// The cron rules kept in NVS (ESP32 `Preferences`), a rule set by `SetCronAlarm()` is restored after a reboot.
+#ifndef CRON_ALARM_NVS
+   #define CRON_ALARM_NVS      (CRON_ALARM_CODE && ESP32_WIFI)  ///< If (true) - cron rules saved in NVS, (false) - RAM only
+#endif
+
+/// The gradual (slew) correction of the RTC time (`BCTimeSlew`), the time task writes the RTC phase.
+#ifndef TIME_SLEW_CODE
+   #define TIME_SLEW_CODE      FREE_RTOS  ///< If (true) - time slew code included, (false) - code removed
+#endif
+/// The counters and gauges of the clock (`BCMetrics`), e.g. the tick latency, served by `BinaryClockMetrics`.
+#ifndef METRICS_CODE
+   #define METRICS_CODE        FREE_RTOS  ///< If (true) - metrics code included, (false) - code removed
+#endif
 #define DEVELOPMENT    (DEV_BOARD || DEV_CODE) 
 
 //#####################################################################################//  
@@ -670,6 +699,9 @@
 #ifndef DEFAULT_ALARM_REPEAT
    #define DEFAULT_ALARM_REPEAT       3   ///< How many times to play the melody alarm
 #endif
+#ifndef DEFAULT_SNOOZE_SECONDS
+   #define DEFAULT_SNOOZE_SECONDS   540   ///< The default snooze time in seconds (9 minutes)
+#endif
 #ifndef DEFAULT_SERIAL_SPEED
    #define DEFAULT_SERIAL_SPEED   115200  ///< Default serial output speed in bps
 #endif
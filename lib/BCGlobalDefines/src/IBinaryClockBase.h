@@ -81,6 +81,29 @@ namespace BinaryClockShield
       /// @ingroup properties
       virtual DateTime get_Time() const = 0;
 
+      /// @brief Correct the time to `value`, gradually (slew) if the clock supports it.
+      /// @details Used to apply the NTP time without the display jumping over or repeating seconds.
+      ///          The default steps the time with `set_Time()`.
+      /// @param value The correct time, whole seconds.
+      /// @param fractionMs The milliseconds elapsed in the second `value`. {0}
+      /// @return True if the time is slewed, false if it was stepped.
+      /// @author Chris-70 (2026/10)
+      virtual bool AdjustTime(DateTime value, uint16_t fractionMs = 0)
+         { 
+         set_Time(value);
+         return false;
+         }
+
+      /// @brief Plan a leap second announced by the NTP servers, made on the RTC at the event.
+      /// @details The default doesn't support it, the caller corrects the time after the event.
+      /// @param value The local time of the first second after the leap, 00:00:00 UTC of the 1st.
+      /// @param leap +1 insert (23:59:60); -1 delete (23:59:59); 0 cancels the leap planned.
+      /// @param smearS The window (s) ending at the leap to smear the second over, 0 to show :60. {0}
+      /// @return True if the clock makes the leap second.
+      /// @author Chris-70 (2026/10)
+      virtual bool ScheduleLeapSecond(DateTime value, int8_t leap, uint32_t smearS = 0)
+         { return false; }
+
       /// @brief The property method called to set/get the current 'Alarm' property.
       /// @param value The AlarmTime structure containing the alarm time and status.
       /// @return An AlarmTime structure containing the alarm time and status.
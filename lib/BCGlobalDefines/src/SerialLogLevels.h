@@ -0,0 +1,246 @@
+/// @file SerialLogLevels.h
+/// @brief Per-module compile-time log levels with a runtime ceiling for the serial output.
+/// @details Each module has its own level, `LOG_LEVEL_<MODULE>`, resolved by the preprocessor.
+///          A `LOG_<MODULE>_<LEVEL>(CMD_STRING)` macro above the module level is replaced with
+///          whitespace, the same as the other `SERIAL_*` macros, so the disabled statements
+///          generate no code and no string literals. The enabled statements use the streaming
+///          syntax of `SERIAL_STREAM()`, e.g. `LOG_NTP_DEBUG("Offset: " << offset << endl)`.
+///
+///          The runtime ceiling, `set_SerialLogCeiling()`, can lower the output further without a
+///          rebuild (e.g. from the serial menu). It can't enable a level removed at compile time.
+///          When `SERIAL_LOG_CEILING_CODE` is false (e.g. `LIMITED_MEMORY` boards) the check is removed.
+/// @verbatim
+///################################################################################//
+/// Set in `board_select.h` or with build flags, e.g. -DLOG_LEVEL_NTP=LOG_LEVEL_VERBOSE
+/// =========================================
+/// #define LOG_LEVEL_DEFAULT  LOG_LEVEL_DEBUG  // Used by every module not defined below.
+/// #define LOG_LEVEL_RTC      LOG_LEVEL_WARN
+/// #define LOG_LEVEL_NTP      LOG_LEVEL_VERBOSE
+/// #define LOG_LEVEL_WAN      LOG_LEVEL_INFO
+/// #define LOG_LEVEL_MENU     LOG_LEVEL_NONE   // Module contributes zero bytes.
+/// #define LOG_LEVEL_DISPLAY  LOG_LEVEL_ERROR
+///################################################################################//
+/// @endverbatim
+/// @remarks The default level is `LOG_LEVEL_DEBUG` when DEV_CODE is true and `LOG_LEVEL_NONE` otherwise,
+///          this keeps the same output as the `SERIAL_STREAM()` statements these macros replaced.
+/// @note    This file is included at the end of `SerialOutput.Defines.h`, don't include it directly.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __SERIALLOGLEVELS_H__
+#define __SERIALLOGLEVELS_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#define LOG_LEVEL_NONE      0          ///< No output from the module.
+#define LOG_LEVEL_ERROR     1          ///< Failures the clock can't recover from by itself.
+#define LOG_LEVEL_WARN      2          ///< Unexpected conditions the clock recovered from.
+#define LOG_LEVEL_INFO      3          ///< Normal state changes, e.g. connected, synced.
+#define LOG_LEVEL_DEBUG     4          ///< Development details, the `// *** DEBUG ***` statements.
+#define LOG_LEVEL_VERBOSE   5          ///< Everything, e.g. per packet or per second details.
+
+#ifndef LOG_LEVEL_DEFAULT
+   #if DEV_CODE
+      #define LOG_LEVEL_DEFAULT  LOG_LEVEL_DEBUG  ///< Development builds keep the debug output.
+   #else
+      #define LOG_LEVEL_DEFAULT  LOG_LEVEL_NONE   ///< Release builds remove the module output.
+   #endif
+#endif
+
+/// Without the base serial macros there is nothing to output, remove every module.
+#if !(DEV_CODE || DEBUG_OUTPUT || SERIAL_OUTPUT)
+   #undef  LOG_LEVEL_DEFAULT
+   #define LOG_LEVEL_DEFAULT     LOG_LEVEL_NONE
+   #undef  LOG_LEVEL_RTC
+   #undef  LOG_LEVEL_NTP
+   #undef  LOG_LEVEL_WAN
+   #undef  LOG_LEVEL_MENU
+   #undef  LOG_LEVEL_DISPLAY
+#endif
+
+#ifndef LOG_LEVEL_RTC
+   #define LOG_LEVEL_RTC      LOG_LEVEL_DEFAULT  ///< The DS3231 RTC, time and alarm registers (BinaryClock).
+#endif
+#ifndef LOG_LEVEL_NTP
+   #define LOG_LEVEL_NTP      LOG_LEVEL_DEFAULT  ///< The NTP client and time sync (BinaryClockNTP).
+#endif
+#ifndef LOG_LEVEL_WAN
+   #define LOG_LEVEL_WAN      LOG_LEVEL_DEFAULT  ///< WiFi connections, WPS and the stored credentials (BinaryClockWAN, BinaryClockWPS, BinaryClockSettings).
+#endif
+#ifndef LOG_LEVEL_MENU
+   #define LOG_LEVEL_MENU     LOG_LEVEL_DEFAULT  ///< The settings menu (BCMenu).
+#endif
+#ifndef LOG_LEVEL_DISPLAY
+   #define LOG_LEVEL_DISPLAY  LOG_LEVEL_DEFAULT  ///< The LED display, splash screen and time formats.
+#endif
+
+#ifndef SERIAL_LOG_CEILING_CODE
+   #if LIMITED_MEMORY
+      #define SERIAL_LOG_CEILING_CODE  false  ///< No runtime ceiling on boards with limited memory.
+   #else
+      #define SERIAL_LOG_CEILING_CODE  true   ///< Include the runtime ceiling check.
+   #endif
+#endif
+
+#if SERIAL_LOG_CEILING_CODE
+namespace BinaryClockShield
+   {
+   /// @brief The runtime log level ceiling, statements above this level are skipped.
+   inline volatile uint8_t serialLogCeiling = LOG_LEVEL_VERBOSE;
+
+   /// @brief Property pattern for the runtime log level ceiling (`LOG_LEVEL_NONE` to `LOG_LEVEL_VERBOSE`).
+   /// @param value The new ceiling, values above `LOG_LEVEL_VERBOSE` are limited to `LOG_LEVEL_VERBOSE`.
+   /// @see get_SerialLogCeiling()
+   inline void set_SerialLogCeiling(uint8_t value)
+      { serialLogCeiling = (value > LOG_LEVEL_VERBOSE) ? LOG_LEVEL_VERBOSE : value; }
+
+   /// @copydoc set_SerialLogCeiling()
+   /// @see set_SerialLogCeiling()
+   inline uint8_t get_SerialLogCeiling()
+      { return serialLogCeiling; }
+   }
+
+   /// The statement is in its own scope so it is safe in an `if () ... else` without braces.
+   /// `TEXT` is the source text of the statement, `#CMD_STRING`, for the tokenized output.
+   #define SERIAL_LOG_MACRO(LEVEL, TEXT, CMD_STRING) \
+         { if ((LEVEL) <= BinaryClockShield::serialLogCeiling) { SERIAL_STREAM_TEXT_MACRO(TEXT, CMD_STRING) } }
+#else
+   #define SERIAL_LOG_MACRO(LEVEL, TEXT, CMD_STRING) SERIAL_STREAM_TEXT_MACRO(TEXT, CMD_STRING)
+#endif
+
+// RTC module
+#if LOG_LEVEL_RTC >= LOG_LEVEL_ERROR
+   #define LOG_RTC_ERROR(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_ERROR, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_RTC_ERROR(CMD_STRING)
+#endif
+#if LOG_LEVEL_RTC >= LOG_LEVEL_WARN
+   #define LOG_RTC_WARN(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_WARN, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_RTC_WARN(CMD_STRING)
+#endif
+#if LOG_LEVEL_RTC >= LOG_LEVEL_INFO
+   #define LOG_RTC_INFO(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_INFO, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_RTC_INFO(CMD_STRING)
+#endif
+#if LOG_LEVEL_RTC >= LOG_LEVEL_DEBUG
+   #define LOG_RTC_DEBUG(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_DEBUG, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_RTC_DEBUG(CMD_STRING)
+#endif
+#if LOG_LEVEL_RTC >= LOG_LEVEL_VERBOSE
+   #define LOG_RTC_VERBOSE(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_VERBOSE, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_RTC_VERBOSE(CMD_STRING)
+#endif
+
+// NTP module
+#if LOG_LEVEL_NTP >= LOG_LEVEL_ERROR
+   #define LOG_NTP_ERROR(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_ERROR, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_NTP_ERROR(CMD_STRING)
+#endif
+#if LOG_LEVEL_NTP >= LOG_LEVEL_WARN
+   #define LOG_NTP_WARN(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_WARN, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_NTP_WARN(CMD_STRING)
+#endif
+#if LOG_LEVEL_NTP >= LOG_LEVEL_INFO
+   #define LOG_NTP_INFO(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_INFO, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_NTP_INFO(CMD_STRING)
+#endif
+#if LOG_LEVEL_NTP >= LOG_LEVEL_DEBUG
+   #define LOG_NTP_DEBUG(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_DEBUG, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_NTP_DEBUG(CMD_STRING)
+#endif
+#if LOG_LEVEL_NTP >= LOG_LEVEL_VERBOSE
+   #define LOG_NTP_VERBOSE(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_VERBOSE, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_NTP_VERBOSE(CMD_STRING)
+#endif
+
+// WAN module
+#if LOG_LEVEL_WAN >= LOG_LEVEL_ERROR
+   #define LOG_WAN_ERROR(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_ERROR, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_WAN_ERROR(CMD_STRING)
+#endif
+#if LOG_LEVEL_WAN >= LOG_LEVEL_WARN
+   #define LOG_WAN_WARN(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_WARN, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_WAN_WARN(CMD_STRING)
+#endif
+#if LOG_LEVEL_WAN >= LOG_LEVEL_INFO
+   #define LOG_WAN_INFO(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_INFO, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_WAN_INFO(CMD_STRING)
+#endif
+#if LOG_LEVEL_WAN >= LOG_LEVEL_DEBUG
+   #define LOG_WAN_DEBUG(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_DEBUG, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_WAN_DEBUG(CMD_STRING)
+#endif
+#if LOG_LEVEL_WAN >= LOG_LEVEL_VERBOSE
+   #define LOG_WAN_VERBOSE(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_VERBOSE, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_WAN_VERBOSE(CMD_STRING)
+#endif
+
+// MENU module
+#if LOG_LEVEL_MENU >= LOG_LEVEL_ERROR
+   #define LOG_MENU_ERROR(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_ERROR, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_MENU_ERROR(CMD_STRING)
+#endif
+#if LOG_LEVEL_MENU >= LOG_LEVEL_WARN
+   #define LOG_MENU_WARN(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_WARN, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_MENU_WARN(CMD_STRING)
+#endif
+#if LOG_LEVEL_MENU >= LOG_LEVEL_INFO
+   #define LOG_MENU_INFO(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_INFO, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_MENU_INFO(CMD_STRING)
+#endif
+#if LOG_LEVEL_MENU >= LOG_LEVEL_DEBUG
+   #define LOG_MENU_DEBUG(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_DEBUG, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_MENU_DEBUG(CMD_STRING)
+#endif
+#if LOG_LEVEL_MENU >= LOG_LEVEL_VERBOSE
+   #define LOG_MENU_VERBOSE(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_VERBOSE, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_MENU_VERBOSE(CMD_STRING)
+#endif
+
+// DISPLAY module
+#if LOG_LEVEL_DISPLAY >= LOG_LEVEL_ERROR
+   #define LOG_DISPLAY_ERROR(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_ERROR, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_DISPLAY_ERROR(CMD_STRING)
+#endif
+#if LOG_LEVEL_DISPLAY >= LOG_LEVEL_WARN
+   #define LOG_DISPLAY_WARN(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_WARN, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_DISPLAY_WARN(CMD_STRING)
+#endif
+#if LOG_LEVEL_DISPLAY >= LOG_LEVEL_INFO
+   #define LOG_DISPLAY_INFO(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_INFO, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_DISPLAY_INFO(CMD_STRING)
+#endif
+#if LOG_LEVEL_DISPLAY >= LOG_LEVEL_DEBUG
+   #define LOG_DISPLAY_DEBUG(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_DEBUG, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_DISPLAY_DEBUG(CMD_STRING)
+#endif
+#if LOG_LEVEL_DISPLAY >= LOG_LEVEL_VERBOSE
+   #define LOG_DISPLAY_VERBOSE(CMD_STRING) SERIAL_LOG_MACRO(LOG_LEVEL_VERBOSE, #CMD_STRING, CMD_STRING)
+#else
+   #define LOG_DISPLAY_VERBOSE(CMD_STRING)
+#endif
+
+#endif // __SERIALLOGLEVELS_H__
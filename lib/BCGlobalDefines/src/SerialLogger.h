@@ -0,0 +1,318 @@
+/// @file SerialLogger.h
+/// @brief Asynchronous, ring-buffered serial logger used behind the `SERIAL_*` output macros.
+/// @details The `SERIAL_*_MACRO` base macros in `SerialOutput.Defines.h` format and write the
+///          output on the calling task. When the UART is slow (e.g. 115200 bps is ~11.5 bytes/ms)
+///          a long debug line will stall the calling task, this includes the time and NTP tasks
+///          which then delays the time display.
+///          When `SERIAL_ASYNC_LOG` is true the base macros format the output into a small buffer
+///          on the caller's stack (`SerialLogLine`) then copy it into a lock-free ring buffer of
+///          fixed size slots (`SerialLogger`). A low priority drain task writes the slots to the
+///          UART. The caller never waits on the UART and never takes a lock.
+///
+///          The ring buffer is a bounded multi-producer / single-consumer queue. Each slot has a
+///          sequence number that tells the producers and the consumer who owns the slot, the only
+///          shared write is a compare and swap on the enqueue position. When the ring is full the
+///          message is discarded and the dropped count is incremented, the drain task reports the
+///          number of dropped messages the next time it runs.
+///          Before `Begin()` is called, or after `End()`, messages are written synchronously so the
+///          early setup output and the Purgatory output are never lost.
+/// @remarks Messages longer than `SERIAL_LOG_SLOT_SIZE` are split over several slots. Slots from
+///          different tasks can be interleaved if the messages are split.
+/// @note    Direct `Serial <<` and `Serial.print()` calls (e.g. the serial menu) bypass the logger
+///          and can appear before queued messages that were created earlier.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __SERIALLOGGER_H__
+#define __SERIALLOGGER_H__
+
+#include <Arduino.h>                   /// For `Print`, `Serial` and `millis()`
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+#include <string.h>                    /// memcpy
+
+#include <atomic>                      /// std::atomic
+#include <Streaming.h>                 /// Streaming serial output with `operator<<` (https://github.com/janelia-arduino/Streaming)
+
+#include <freertos/FreeRTOS.h>         /// For FreeRTOS types and functions.
+#include <freertos/task.h>             /// For FreeRTOS Task functions and types.
+
+#ifndef SERIAL_LOG_SLOT_SIZE
+   #define SERIAL_LOG_SLOT_SIZE       124U    ///< Bytes of text per ring buffer slot (also the `SerialLogLine` buffer size).
+#endif
+#ifndef SERIAL_LOG_SLOT_COUNT
+   #define SERIAL_LOG_SLOT_COUNT       32U    ///< Number of ring buffer slots, MUST be a power of 2.
+#endif
+#ifndef SERIAL_LOG_STACKSIZE
+   #define SERIAL_LOG_STACKSIZE      2560U    ///< Stack size of the drain task.
+#endif
+#ifndef SERIAL_LOG_PRIORITY
+   #define SERIAL_LOG_PRIORITY  (tskIDLE_PRIORITY + 1U) ///< Drain task priority, below all the clock tasks.
+#endif
+#define SERIAL_LOG_DRAIN_MS           50U     ///< Maximum time the drain task sleeps between checks.
+
+#ifndef FOREVER
+   #define FOREVER while(true)         ///< Infinite loop, e.g. used in task methods.
+#endif
+
+namespace BinaryClockShield
+   {
+   #pragma region SerialLogger Class
+   /// @brief Singleton lock-free ring buffer with a drain task to write the messages to the UART.
+   /// @details Producers call `Push()` from any task (not from an ISR), the drain task is the only
+   ///          consumer. See the file description for the design.
+   /// @author Chris-70 (2026/10)
+   class SerialLogger
+      {
+   public:
+      /// @brief The singleton instance accessor.
+      static SerialLogger& get_Instance()
+         {
+         static SerialLogger instance;
+         return instance;
+         }
+
+      /// @brief Start the drain task, from now on all messages are queued.
+      /// @param output The output stream to write the messages to, default: `Serial`.
+      /// @param priority The drain task priority, keep it below the time and callback tasks.
+      /// @return Flag: true - the drain task is running; false - failed, output remains synchronous.
+      bool Begin(Print& output = Serial, UBaseType_t priority = SERIAL_LOG_PRIORITY)
+         {
+         if (drainTask.load() != nullptr) { return true; }
+
+         outputPtr = &output;
+         stopRequest = false;
+         TaskHandle_t handle = nullptr;
+         if (xTaskCreate(DrainTaskWrapper, "SerialLogTask", SERIAL_LOG_STACKSIZE, this, priority, &handle) == pdPASS)
+            {
+            drainTask.store(handle);
+            queueing.store(true);
+            }
+
+         return queueing.load();
+         }
+
+      /// @brief Stop the drain task then write any queued messages synchronously.
+      /// @details The producers are stopped first: the new messages are written synchronously and
+      ///          the `Push()` calls that took the drain task are waited for, only then is the task
+      ///          told to exit. No producer notifies the task once it deleted itself, no slot is
+      ///          queued after the last `Drain()`.
+      void End()
+         {
+         TaskHandle_t handle = drainTask.load();
+         if (handle == nullptr) { return; }
+
+         queueing.store(false);
+         while (producers.load() != 0U)
+            { vTaskDelay(1); }
+
+         stopRequest = true;
+         xTaskNotifyGive(handle);
+         // Let the task finish writing its current slot and exit on its own, it is the only consumer.
+         while (drainTask.load() != nullptr)
+            { vTaskDelay(pdMS_TO_TICKS(10)); }
+
+         Drain();
+         }
+
+      /// @brief Queue the message, or write it directly if the drain task isn't running.
+      /// @param data Pointer to the text to write, it doesn't need to be null terminated.
+      /// @param length The number of bytes to write.
+      /// @return Flag: true - the message was queued/written; false - ring was full, message dropped.
+      bool Push(const char* data, size_t length)
+         {
+         if (length == 0) { return true; }
+
+         // Counted before `queueing` is read: `End()` clears it, then waits for the count to be 0.
+         producers.fetch_add(1U);
+         if (!queueing.load())
+            {
+            producers.fetch_sub(1U);
+            outputPtr->write(reinterpret_cast<const uint8_t*>(data), length);
+            return true;
+            }
+
+         bool result = true;
+         while (result && (length > 0))
+            {
+            size_t chunk = (length > SERIAL_LOG_SLOT_SIZE) ? SERIAL_LOG_SLOT_SIZE : length;
+            result = pushSlot(data, chunk);
+            data   += chunk;
+            length -= chunk;
+            }
+
+         xTaskNotifyGive(drainTask.load());   // Still running, `End()` waits for this `Push()`.
+         producers.fetch_sub(1U);
+         return result;
+         }
+
+      /// @brief Write all the queued slots to the output.
+      /// @remarks Only the drain task, or the caller after `End()`, can drain as there is a single consumer.
+      /// @return The number of slots written.
+      size_t Drain()
+         {
+         size_t count = 0;
+         FOREVER
+            {
+            Slot& slot = slots[dequeuePos & SlotMask];
+            uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+            if ((int32_t)(seq - (dequeuePos + 1U)) < 0) { break; }  // Empty.
+
+            outputPtr->write(reinterpret_cast<const uint8_t*>(slot.data), slot.length);
+            slot.sequence.store(dequeuePos + SlotMask + 1U, std::memory_order_release);
+            dequeuePos++;
+            count++;
+            }
+
+         uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+         if (dropped != reportedDrops)
+            {
+            *outputPtr << F("\n[SerialLogger] ") << (dropped - reportedDrops) << F(" message(s) dropped.\n");
+            reportedDrops = dropped;
+            }
+
+         return count;
+         }
+
+      /// @brief The total number of messages dropped because the ring buffer was full.
+      uint32_t get_DroppedCount() const  { return droppedCount.load(std::memory_order_relaxed); }
+      /// @brief The total number of messages that were queued.
+      uint32_t get_QueuedCount() const   { return queuedCount.load(std::memory_order_relaxed); }
+      /// @brief Flag: true - messages are queued; false - messages are written synchronously.
+      bool get_IsRunning() const         { return queueing.load(); }
+
+   protected:
+      /// @brief A fixed size ring buffer slot, `sequence` determines the owner of the slot.
+      struct Slot
+         {
+         std::atomic<uint32_t> sequence;  ///< == pos: free for producer; == pos+1: ready for the consumer.
+         uint8_t length;                  ///< The number of valid bytes in `data`.
+         char data[SERIAL_LOG_SLOT_SIZE]; ///< The message text, not null terminated.
+         };
+
+      static_assert((SERIAL_LOG_SLOT_COUNT & (SERIAL_LOG_SLOT_COUNT - 1U)) == 0, "SERIAL_LOG_SLOT_COUNT must be a power of 2");
+      static_assert(SERIAL_LOG_SLOT_SIZE <= UINT8_MAX, "SERIAL_LOG_SLOT_SIZE must fit in the uint8_t length");
+
+      static constexpr uint32_t SlotMask = SERIAL_LOG_SLOT_COUNT - 1U;
+
+      SerialLogger() : outputPtr(&Serial)
+         {
+         for (uint32_t i = 0; i < SERIAL_LOG_SLOT_COUNT; i++)
+            { slots[i].sequence.store(i, std::memory_order_relaxed); }
+         }
+
+      SerialLogger(const SerialLogger&) = delete;
+      SerialLogger& operator=(const SerialLogger&) = delete;
+
+      /// @brief Claim the next free slot and copy the data into it (lock-free).
+      bool pushSlot(const char* data, size_t length)
+         {
+         uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+         Slot* slot;
+         FOREVER
+            {
+            slot = &slots[pos & SlotMask];
+            uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0)
+               {
+               if (enqueuePos.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed))
+                  { break; }
+               }
+            else if (diff < 0)
+               {
+               droppedCount.fetch_add(1U, std::memory_order_relaxed);
+               return false;
+               }
+            else
+               { pos = enqueuePos.load(std::memory_order_relaxed); }
+            }
+
+         memcpy(slot->data, data, length);
+         slot->length = (uint8_t)length;
+         slot->sequence.store(pos + 1U, std::memory_order_release);
+         queuedCount.fetch_add(1U, std::memory_order_relaxed);
+         return true;
+         }
+
+      /// @brief The drain task, waits for a notification (or timeout) then writes the queued slots.
+      void DrainTask()
+         {
+         while (!stopRequest)
+            {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SERIAL_LOG_DRAIN_MS));
+            Drain();
+            }
+
+         drainTask.store(nullptr);
+         vTaskDelete(nullptr);
+         }
+
+      static void DrainTaskWrapper(void* param)
+         { static_cast<SerialLogger*>(param)->DrainTask(); }
+
+   private:
+      Slot slots[SERIAL_LOG_SLOT_COUNT];                 ///< The ring buffer.
+      std::atomic<uint32_t> enqueuePos    { 0U };       ///< Next position for the producers.
+      uint32_t              dequeuePos    = 0U;         ///< Next position for the (single) consumer.
+      std::atomic<uint32_t> droppedCount  { 0U };       ///< Messages dropped, ring buffer was full.
+      std::atomic<uint32_t> queuedCount   { 0U };       ///< Messages queued.
+      uint32_t              reportedDrops = 0U;         ///< Dropped count last reported by the drain task.
+      Print*                outputPtr;                  ///< Where the messages are written.
+      std::atomic<TaskHandle_t> drainTask { nullptr };  ///< The drain task handle, `nullptr` when not running.
+      std::atomic<bool>     queueing      { false };    ///< Flag: `Push()` queues the messages, cleared first by `End()`.
+      std::atomic<uint32_t> producers     { 0U };       ///< The `Push()` calls in progress.
+      volatile bool         stopRequest   = false;      ///< Request the drain task to exit.
+      }; // class SerialLogger
+   #pragma endregion
+
+   #pragma region SerialLogLine Class
+   /// @brief A `Print` object on the caller's stack to format one message for the `SerialLogger`.
+   /// @details The `SERIAL_*_MACRO` macros create one of these in their own scope, stream or print
+   ///          into it, then the destructor pushes the message to the ring buffer. This keeps the
+   ///          `Serial << ...` syntax of the macros unchanged. A full buffer is pushed as a chunk.
+   /// @author Chris-70 (2026/10)
+   class SerialLogLine : public Print
+      {
+   public:
+      SerialLogLine() = default;
+      ~SerialLogLine() override { flush(); }
+
+      size_t write(uint8_t value) override
+         {
+         if (length >= sizeof(buffer)) { flush(); }
+         buffer[length++] = (char)value;
+         return 1;
+         }
+
+      size_t write(const uint8_t* data, size_t size) override
+         {
+         size_t remaining = size;
+         while (remaining > 0)
+            {
+            if (length >= sizeof(buffer)) { flush(); }
+            size_t chunk = sizeof(buffer) - length;
+            if (chunk > remaining) { chunk = remaining; }
+            memcpy(buffer + length, data, chunk);
+            length    += chunk;
+            data      += chunk;
+            remaining -= chunk;
+            }
+
+         return size;
+         }
+
+      void flush() override
+         {
+         SerialLogger::get_Instance().Push(buffer, length);
+         length = 0;
+         }
+
+   private:
+      char buffer[SERIAL_LOG_SLOT_SIZE];  ///< The formatted message text.
+      size_t length = 0;                  ///< The number of bytes in `buffer`.
+      }; // class SerialLogLine
+   #pragma endregion
+   } // namespace BinaryClockShield
+
+#endif // __SERIALLOGGER_H__
@@ -17,6 +17,8 @@
 /// #define DEV_CODE        true  // true to enable; false to disable
 /// #define DEBUG_OUTPUT    true  // true to enable; false to disable
 /// #define PRINTF_OK       true  // true to enable; false to disable
+/// #define SERIAL_ASYNC_LOG true // true: queue the output (SerialLogger.h); false: write on the caller
+/// #define SERIAL_TOKENIZED false // true: the output macros write binary tokens (SerialTokenLog.h); false: text
 ///################################################################################//
 /// @endverbatim
 
@@ -32,6 +34,20 @@
    #define PRINTF_OK       true        ///< If PRINTF_OK hasn't been defined, assume printf is available.
 #endif
 
+/// Tokenized binary output for the output macros, decoded on the host by `test/detokenize.py`.
+#ifndef SERIAL_TOKENIZED
+   #define SERIAL_TOKENIZED     false  ///< true: the output macros write a token frame (SerialTokenLog.h); false: text
+#endif
+
+/// The asynchronous logger needs FreeRTOS and the ESP32 core `Print::printf()`, default is ON for ESP32 boards.
+#ifndef SERIAL_ASYNC_LOG
+   #if defined(ARDUINO_ARCH_ESP32) && defined(FREE_RTOS) && FREE_RTOS
+      #define SERIAL_ASYNC_LOG   true  ///< Queue the serial output, written by a low priority task.
+   #else
+      #define SERIAL_ASYNC_LOG   false ///< Write the serial output synchronously on the calling task.
+   #endif
+#endif
+
 // ##################################################################################### //
 /// These methods/functions can be redefined if the definition is placed BEFORE the 
 /// `#include <BinaryClock.Defines.h>` statement in the source file where it is used.
@@ -65,7 +81,16 @@
 /// The base macros are defined first, then the higher level macros are defined that
 /// use the base macros. This allows for more flexibility in controlling the output.
 /// The output commands can be changed here if needed, e.g. to change from Serial to another output method.
-#if DEV_CODE || DEBUG_OUTPUT || SERIAL_OUTPUT
+/// When SERIAL_ASYNC_LOG is true the output is formatted into a `SerialLogLine` on the stack, in its 
+/// own scope, and queued in the `SerialLogger` ring buffer. The syntax of the macros is the same.
+#if (DEV_CODE || DEBUG_OUTPUT || SERIAL_OUTPUT) && SERIAL_ASYNC_LOG
+   #include "SerialLogger.h"           // Lock-free ring buffer logger with a low priority drain task.
+
+   #define SERIAL_PRINT_MACRO(STRING) { BinaryClockShield::SerialLogLine logLine_; logLine_.print(STRING); }
+   #define SERIAL_PRINTLN_MACRO(STRING) { BinaryClockShield::SerialLogLine logLine_; logLine_.println(STRING); }
+   #define SERIAL_STREAM_MACRO(CMD_STRING) { BinaryClockShield::SerialLogLine logLine_; logLine_ << CMD_STRING; }
+   #define SERIAL_PRINTF_MACRO(FORMAT, ...) { BinaryClockShield::SerialLogLine logLine_; logLine_.printf(FORMAT, __VA_ARGS__); }
+#elif DEV_CODE || DEBUG_OUTPUT || SERIAL_OUTPUT
    #define SERIAL_PRINT_MACRO(STRING) Serial.print(STRING);
    #define SERIAL_PRINTLN_MACRO(STRING) Serial.println(STRING);
    #define SERIAL_STREAM_MACRO(CMD_STRING) Serial << CMD_STRING;
@@ -82,12 +107,31 @@
    #define SERIAL_PRINTF_MACRO(FORMAT, ...)
 #endif
 
+/// The `*_TEXT_MACRO`s have the source text of the statement, `TEXT` is `#STRING` taken by the macro
+/// the code calls, before the argument is macro expanded. Only the tokenized output uses it.
+/// Tokenized mode: the format string, or the text of the statement, is replaced by its hash at compile
+/// time and the values are written in binary. No `printf()` is needed so this works when PRINTF_OK is false.
+/// `SERIAL_STREAM_MACRO` stays text, it is used by the serial menu (`SERIAL_SETUP_STREAM()`).
+#if (DEV_CODE || DEBUG_OUTPUT || SERIAL_OUTPUT) && SERIAL_TOKENIZED
+   #include "SerialTokenLog.h"         // Compile time format string tokens with binary arguments.
+
+   #undef  SERIAL_PRINTF_MACRO
+   #define SERIAL_PRINTF_MACRO(FORMAT, ...) BinaryClockShield::TokenLog::Emit(SERIAL_TOKEN(FORMAT), __VA_ARGS__);
+   #define SERIAL_PRINT_TEXT_MACRO(TEXT, STRING) SERIAL_TOKEN_STREAM(TEXT, (STRING))
+   #define SERIAL_PRINTLN_TEXT_MACRO(TEXT, STRING) SERIAL_TOKEN_STREAM(TEXT " << endl", (STRING) << endl)
+   #define SERIAL_STREAM_TEXT_MACRO(TEXT, CMD_STRING) SERIAL_TOKEN_STREAM(TEXT, CMD_STRING)
+#else
+   #define SERIAL_PRINT_TEXT_MACRO(TEXT, STRING) SERIAL_PRINT_MACRO(STRING)
+   #define SERIAL_PRINTLN_TEXT_MACRO(TEXT, STRING) SERIAL_PRINTLN_MACRO(STRING)
+   #define SERIAL_STREAM_TEXT_MACRO(TEXT, CMD_STRING) SERIAL_STREAM_MACRO(CMD_STRING)
+#endif
+
 /// These output MACROs are available for all general serial output.
 /// SERIAL_OUTPUT is defined true if either SERIAL_SETUP_CODE or SERIAL_TIME_CODE is true.
 #if SERIAL_OUTPUT
-   #define SERIAL_OUT_PRINT(STRING) SERIAL_PRINT_MACRO(STRING)
-   #define SERIAL_OUT_PRINTLN(STRING) SERIAL_PRINTLN_MACRO(STRING)
-   #define SERIAL_OUT_STREAM(CMD_STRING) SERIAL_STREAM_MACRO(CMD_STRING)
+   #define SERIAL_OUT_PRINT(STRING) SERIAL_PRINT_TEXT_MACRO(#STRING, STRING)
+   #define SERIAL_OUT_PRINTLN(STRING) SERIAL_PRINTLN_TEXT_MACRO(#STRING, STRING)
+   #define SERIAL_OUT_STREAM(CMD_STRING) SERIAL_STREAM_TEXT_MACRO(#CMD_STRING, CMD_STRING)
    #define SERIAL_OUT_PRINTF(FORMAT, ...) SERIAL_PRINTF_MACRO(FORMAT, __VA_ARGS__)
 #else
    // Replace the macros with whitespace.
@@ -102,9 +146,9 @@
 /// This allows for debugging output to be included in the code
 /// only during development, but removed from the final code. 
 #if DEV_CODE
-   #define SERIAL_PRINT(STRING) SERIAL_PRINT_MACRO(STRING)
-   #define SERIAL_PRINTLN(STRING) SERIAL_PRINTLN_MACRO(STRING)
-   #define SERIAL_STREAM(CMD_STRING) SERIAL_STREAM_MACRO(CMD_STRING)
+   #define SERIAL_PRINT(STRING) SERIAL_PRINT_TEXT_MACRO(#STRING, STRING)
+   #define SERIAL_PRINTLN(STRING) SERIAL_PRINTLN_TEXT_MACRO(#STRING, STRING)
+   #define SERIAL_STREAM(CMD_STRING) SERIAL_STREAM_TEXT_MACRO(#CMD_STRING, CMD_STRING)
    #define SERIAL_PRINTF(FORMAT, ...) SERIAL_PRINTF_MACRO(FORMAT, __VA_ARGS__)
 #else
    // Replace the macros with whitespace.
@@ -119,9 +163,9 @@
 /// included in code that is released. The `DEBUG_...` statements should
 /// be removed from the code BEFORE committing to the repo.
 #if DEBUG_OUTPUT
-   #define DEBUG_PRINT(STRING) SERIAL_PRINT_MACRO(STRING)
-   #define DEBUG_PRINTLN(STRING) SERIAL_PRINTLN_MACRO(STRING)
-   #define DEBUG_STREAM(CMD_STRING) SERIAL_STREAM_MACRO(CMD_STRING)
+   #define DEBUG_PRINT(STRING) SERIAL_PRINT_TEXT_MACRO(#STRING, STRING)
+   #define DEBUG_PRINTLN(STRING) SERIAL_PRINTLN_TEXT_MACRO(#STRING, STRING)
+   #define DEBUG_STREAM(CMD_STRING) SERIAL_STREAM_TEXT_MACRO(#CMD_STRING, CMD_STRING)
    #define DEBUG_PRINTF(FORMAT, ...) SERIAL_PRINTF_MACRO(FORMAT, __VA_ARGS__)
 #else
    // Replace the macros with whitespace.
@@ -131,4 +175,7 @@
    #define DEBUG_PRINTF(FORMAT, ...)
 #endif
 
+/// Per-module log levels: `LOG_<MODULE>_<LEVEL>(CMD_STRING)`, e.g. `LOG_NTP_WARN("Timeout" << endl)`.
+#include "SerialLogLevels.h"           // Compile-time module levels with a runtime ceiling.
+
 #endif // __SERIALOUTPUT_DEFINES_H__
@@ -0,0 +1,398 @@
+/// @file SerialTokenLog.h
+/// @brief Tokenized binary logging for the serial output macros.
+/// @details When `SERIAL_TOKENIZED` is true the text of the serial output macros is replaced at
+///          compile time by a 32 bit (or 16 bit) FNV-1a hash, the token, and only the values are
+///          written, in binary. The text is only used in constant expressions so it is never stored
+///          in flash, and nothing is formatted on the target.
+///          - `SERIAL_PRINTF`, `SERIAL_OUT_PRINTF`, `DEBUG_PRINTF`: the token of the format string,
+///            the arguments follow as the format expects them. This also allows the `*PRINTF`
+///            macros on boards without `printf()` support (i.e. `PRINTF_OK` false).
+///          - `SERIAL_STREAM`, `SERIAL_OUT_STREAM`, `DEBUG_STREAM`, the `LOG_<MODULE>_<LEVEL>` macros
+///            and the `*PRINT`/`*PRINTLN` macros: the token of the statement's source text (the
+///            stringized macro argument). The operands of `<<` that are literals, i.e. string
+///            literals, `F()` of string literals and `endl`, are in the token and dropped; each
+///            other operand is written with a type tag.
+///
+///          The host tool `test/detokenize.py` builds the token database from the sources (the
+///          same hash over the same text) and decodes the serial stream back to text. Normal
+///          text output (e.g. the serial menu) passes through the decoder unchanged.
+/// @par Frame format:
+/// @verbatim
+///   0x1B | length (u8) | token (u16/u32 LE) | argument bytes ...
+///   length : The number of bytes after the length byte (token + arguments).
+///   Printf arguments, as the format:
+///   Integers (%d %i %u %x %X %o %c %p) : zigzag varint (LEB128), unsigned 32 bit values > INT32_MAX arrive negative.
+///   Floating point (%f %e %g)          : IEEE-754 float, 4 bytes little endian.
+///   Strings (%s)                       : length (u8) followed by the characters, truncated to fit the frame.
+///   Stream operands, a tag (char) then the value:
+///   'i' signed, 'u' unsigned (32 bit, arrives negative > INT32_MAX), 'U' unsigned 64 bit : zigzag varint.
+///   'c' char : 1 byte.  'f' float : 4 bytes.  's' string : as %s.  'a' IPv4 address : 4 bytes.
+///   'b' `_BASED` (e.g. `_HEX(x)`) : the base (u8), then the value as a zigzag varint.
+/// @endverbatim
+/// @remarks The format must be a string literal, e.g. `SERIAL_PRINTF("x=%d\n", x)`. Adjacent literals
+///          are supported. A format with no arguments isn't supported by the `*PRINTF` macros.
+///          A stream statement has at most 32 operands. The source text is the argument the
+///          statement was written with, so the output macros can't be called from another macro
+///          that passes its own parameter (the text would be the parameter's name).
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __SERIALTOKENLOG_H__
+#define __SERIALTOKENLOG_H__
+
+#include <Arduino.h>                   /// For `Serial`, `String`
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+#include <string.h>                    /// memcpy, strlen
+#include <Streaming.h>                 /// For `_BASED`, `endl`
+#if defined(ARDUINO_ARCH_ESP32)
+   #include <IPAddress.h>              /// For `IPAddress`
+#endif
+
+#ifndef SERIAL_TOKEN_BITS
+   #define SERIAL_TOKEN_BITS     32    ///< Token size in bits: 32 or 16. Must match `detokenize.py --bits`.
+#endif
+#define SERIAL_TOKEN_ESCAPE    0x1B    ///< First byte of every token frame (ASCII ESC).
+#ifndef SERIAL_TOKEN_FRAME_MAX
+   #if SERIAL_ASYNC_LOG
+      #define SERIAL_TOKEN_FRAME_MAX  SERIAL_LOG_SLOT_SIZE  ///< Maximum frame size, one ring buffer slot.
+   #else
+      #define SERIAL_TOKEN_FRAME_MAX  64U  ///< Maximum frame size, including the escape and length bytes.
+   #endif
+#endif
+#define SERIAL_TOKEN_OPERANDS_MAX 32U  ///< Maximum operands in a stream statement (bits in the literals mask).
+
+/// @brief Compile-time token for the format string literal `FORMAT`.
+#define SERIAL_TOKEN(FORMAT) (BinaryClockShield::TokenValue<BinaryClockShield::TokenHash(FORMAT)>::value)
+
+/// @brief Write the stream statement `CMD_STRING` as a token frame, `TEXT` is its source text
+///        (i.e. `#CMD_STRING` taken before the argument is macro expanded).
+#define SERIAL_TOKEN_STREAM(TEXT, CMD_STRING) \
+      { static_assert(BinaryClockShield::TokenOperands(TEXT) <= SERIAL_TOKEN_OPERANDS_MAX, "Too many operands to tokenize"); \
+        BinaryClockShield::TokenLog logFrame_(SERIAL_TOKEN(TEXT)); \
+        BinaryClockShield::TokenStream<BinaryClockShield::TokenLiterals(TEXT), 0>{ logFrame_ } << CMD_STRING; \
+        logFrame_.Send(); }
+
+namespace BinaryClockShield
+   {
+   #if SERIAL_TOKEN_BITS == 16
+   typedef uint16_t token_t;           ///< The token type written in the frame.
+   #elif SERIAL_TOKEN_BITS == 32
+   typedef uint32_t token_t;           ///< The token type written in the frame.
+   #else
+      #error "SERIAL_TOKEN_BITS must be 16 or 32"
+   #endif
+
+   /// @brief FNV-1a hash of the null terminated string, xor-folded to 16 bits when `SERIAL_TOKEN_BITS` is 16.
+   constexpr token_t TokenHash(const char* text)
+      {
+      uint32_t hash = 2166136261UL;
+      while (*text != '\0')
+         {
+         hash ^= (uint8_t)(*text++);
+         hash *= 16777619UL;
+         }
+
+      #if SERIAL_TOKEN_BITS == 16
+      return (token_t)((hash >> 16) ^ (hash & 0xFFFFU));
+      #else
+      return hash;
+      #endif
+      }
+
+   /// @brief Forces `TokenHash()` to be evaluated at compile time so the literal isn't kept.
+   template<token_t V>
+   struct TokenValue
+      {
+      static constexpr token_t value = V;
+      };
+
+   /// @brief The end of the stream operand starting at `text`: the next `<<` outside of any
+   ///        parentheses, brackets or literals, or the end of the text.
+   constexpr const char* TokenOperandEnd(const char* text)
+      {
+      int depth = 0;
+      for (; *text != '\0'; text++)
+         {
+         char ch = *text;
+         if ((ch == '"') || (ch == '\''))
+            {
+            for (text++; (*text != '\0') && (*text != ch); text++)
+               {
+               if ((*text == '\\') && (text[1] != '\0')) { text++; }
+               }
+            if (*text == '\0') { break; }
+            }
+         else if ((ch == '(') || (ch == '[') || (ch == '{')) { depth++; }
+         else if ((ch == ')') || (ch == ']') || (ch == '}')) { depth--; }
+         else if ((depth == 0) && (ch == '<') && (text[1] == '<')) { break; }
+         }
+
+      return text;
+      }
+
+   /// @brief True if the stream operand `[begin, end)` is a literal: one or more string literals,
+   ///        `F()` of string literals, or `endl`. The stringized text has single spaces only.
+   constexpr bool TokenIsLiteral(const char* begin, const char* end)
+      {
+      while ((begin < end) && (*begin == ' ')) { begin++; }
+      while ((end > begin) && (end[-1] == ' ')) { end--; }
+      if (((end - begin) == 4) && (begin[0] == 'e') && (begin[1] == 'n') && (begin[2] == 'd') && (begin[3] == 'l'))
+         { return true; }
+
+      if ((begin < end) && (*begin == 'F'))
+         {
+         for (begin++; (begin < end) && (*begin == ' '); begin++) { }
+         if ((begin >= end) || (*begin != '(') || (end[-1] != ')')) { return false; }
+         begin++;
+         end--;
+         while ((begin < end) && (*begin == ' ')) { begin++; }
+         while ((end > begin) && (end[-1] == ' ')) { end--; }
+         }
+
+      if (begin >= end) { return false; }
+      while (begin < end)
+         {
+         if (*begin != '"') { return false; }
+         for (begin++; (begin < end) && (*begin != '"'); begin++)
+            {
+            if (*begin == '\\') { begin++; }
+            }
+         if (begin >= end) { return false; }
+         for (begin++; (begin < end) && (*begin == ' '); begin++) { }
+         }
+
+      return true;
+      }
+
+   /// @brief The number of operands in the stream text.
+   constexpr uint8_t TokenOperands(const char* text)
+      {
+      uint8_t count = 1;
+      for (const char* end = TokenOperandEnd(text); *end != '\0'; end = TokenOperandEnd(end + 2)) { count++; }
+      return count;
+      }
+
+   /// @brief Bit flags: the operands of the stream text that are literals, see `TokenIsLiteral()`.
+   constexpr uint32_t TokenLiterals(const char* text)
+      {
+      uint32_t literals = 0;
+      for (uint8_t index = 0; index < SERIAL_TOKEN_OPERANDS_MAX; index++)
+         {
+         const char* end = TokenOperandEnd(text);
+         if (TokenIsLiteral(text, end)) { literals |= (1UL << index); }
+         if (*end == '\0') { break; }
+         text = end + 2;
+         }
+
+      return literals;
+      }
+
+   /// @brief Selects the `TokenStream` operand overload at compile time.
+   template<bool V>
+   struct TokenBool { };
+
+   template<uint32_t LITERALS, uint8_t INDEX>
+   class TokenStream;
+
+   #pragma region TokenLog Class
+   /// @brief Formats the token frame on the stack and writes it in one call.
+   /// @details No heap, no `printf()`. When the asynchronous logger is used the frame is
+   ///          queued as a single message so frames from different tasks never interleave.
+   /// @author Chris-70 (2026/10)
+   class TokenLog
+      {
+   public:
+      /// @brief Write the token frame with all the arguments.
+      template<typename... Args>
+      static void Emit(token_t token, Args... args)
+         {
+         TokenLog frame(token);
+         frame.putAll(args...);
+         frame.send();
+         }
+
+      /// @brief The frame of a stream statement, the operands are added by `TokenStream`.
+      explicit TokenLog(token_t token) : length(2U), full(false)
+         { putRaw(&token, sizeof(token)); }
+
+      /// @brief Write the frame.
+      void Send()
+         { send(); }
+
+   protected:
+      template<uint32_t LITERALS, uint8_t INDEX>
+      friend class TokenStream;
+
+      void putAll() { }
+
+      template<typename T, typename... Rest>
+      void putAll(T first, Rest... rest)
+         {
+         put(first);
+         putAll(rest...);
+         }
+
+      void putRaw(const void* data, size_t size)
+         {
+         if ((length + size) > sizeof(buffer)) { full = true; return; }
+         memcpy(buffer + length, data, size);
+         length += size;
+         }
+
+      /// @brief Zigzag LEB128 varint, small values of either sign take 1 byte.
+      void putVarint(int32_t value)
+         {
+         uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+         do {
+            uint8_t byte = zigzag & 0x7FU;
+            zigzag >>= 7;
+            if (zigzag != 0) { byte |= 0x80U; }
+            putRaw(&byte, 1);
+            } while (zigzag != 0 && !full);
+         }
+
+      /// @brief 64 bit zigzag LEB128 varint, only used for `long long` arguments.
+      void putVarint64(int64_t value)
+         {
+         uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+         do {
+            uint8_t byte = zigzag & 0x7FU;
+            zigzag >>= 7;
+            if (zigzag != 0) { byte |= 0x80U; }
+            putRaw(&byte, 1);
+            } while (zigzag != 0 && !full);
+         }
+
+      void put(bool value)               { putVarint(value ? 1 : 0); }
+      void put(char value)               { putVarint((int32_t)value); }
+      void put(signed char value)        { putVarint((int32_t)value); }
+      void put(unsigned char value)      { putVarint((int32_t)value); }
+      void put(short value)              { putVarint((int32_t)value); }
+      void put(unsigned short value)     { putVarint((int32_t)value); }
+      void put(int value)                { putVarint((int32_t)value); }
+      void put(unsigned int value)       { putVarint((int32_t)value); }
+      void put(long value)               { putVarint((int32_t)value); }
+      void put(unsigned long value)      { putVarint((int32_t)value); }
+      void put(long long value)          { putVarint64((int64_t)value); }
+      void put(unsigned long long value) { putVarint64((int64_t)value); }
+      void put(const void* value)        { putVarint((int32_t)(uintptr_t)value); }
+      void put(double value)
+         {
+         float single = (float)value;
+         putRaw(&single, sizeof(single));
+         }
+
+      void put(const char* text)
+         {
+         if (text == nullptr) { text = "(null)"; }
+         size_t size = strlen(text);
+         size_t room = (length < sizeof(buffer)) ? (sizeof(buffer) - length - 1U) : 0U;
+         if (size > room) { size = room; }
+         uint8_t size8 = (uint8_t)size;
+         putRaw(&size8, 1);
+         putRaw(text, size);
+         }
+
+      void put(const String& text)       { put(text.c_str()); }
+
+      /// @brief The stream operands: the type tag then the value, as `Print` would print it.
+      void putTag(char tag)                     { putRaw(&tag, 1); }
+      void putTagged(char value)                { putTag('c'); putRaw(&value, 1); }
+      void putTagged(signed char value)         { putTag('i'); putVarint((int32_t)value); }
+      void putTagged(unsigned char value)       { putTag('u'); putVarint((int32_t)value); }
+      void putTagged(bool value)                { putTag('u'); putVarint(value ? 1 : 0); }
+      void putTagged(short value)               { putTag('i'); putVarint((int32_t)value); }
+      void putTagged(unsigned short value)      { putTag('u'); putVarint((int32_t)value); }
+      void putTagged(int value)                 { putTag('i'); putVarint((int32_t)value); }
+      void putTagged(unsigned int value)        { putTag('u'); putVarint((int32_t)value); }
+      void putTagged(long value)                { putTag('i'); putVarint((int32_t)value); }
+      void putTagged(unsigned long value)       { putTag('u'); putVarint((int32_t)value); }
+      void putTagged(long long value)           { putTag('i'); putVarint64((int64_t)value); }
+      void putTagged(unsigned long long value)  { putTag('U'); putVarint64((int64_t)value); }
+      void putTagged(double value)              { putTag('f'); put(value); }
+      void putTagged(const char* text)          { putTag('s'); put(text); }
+      void putTagged(const String& text)        { putTag('s'); put(text.c_str()); }
+      void putTagged(const _BASED& value)
+         {
+         putTag('b');
+         uint8_t base = (uint8_t)value.base;
+         putRaw(&base, 1);
+         putVarint((int32_t)value.val);
+         }
+
+      void putTagged(const __FlashStringHelper* text)
+         {
+         #if defined(__AVR__)
+         char copy[SERIAL_TOKEN_FRAME_MAX];
+         strncpy_P(copy, reinterpret_cast<const char*>(text), sizeof(copy) - 1U);
+         copy[sizeof(copy) - 1U] = '\0';
+         putTagged((const char*)copy);
+         #else
+         putTagged(reinterpret_cast<const char*>(text));
+         #endif
+         }
+
+      #if defined(ARDUINO_ARCH_ESP32)
+      void putTagged(const IPAddress& address)
+         {
+         putTag('a');
+         for (int i = 0; i < 4; i++)
+            {
+            uint8_t byte = address[i];
+            putRaw(&byte, 1);
+            }
+         }
+      #endif
+
+      /// @brief Add the frame header and write the frame.
+      void send()
+         {
+         buffer[0] = SERIAL_TOKEN_ESCAPE;
+         buffer[1] = (uint8_t)(length - 2U);
+         #if SERIAL_ASYNC_LOG
+         SerialLogger::get_Instance().Push(reinterpret_cast<const char*>(buffer), length);
+         #else
+         Serial.write(buffer, length);
+         #endif
+         }
+
+   private:
+      uint8_t buffer[SERIAL_TOKEN_FRAME_MAX];   ///< The frame being built.
+      size_t  length;                           ///< Bytes used in `buffer`.
+      bool    full;                             ///< Frame is full, remaining arguments are dropped.
+      }; // class TokenLog
+   #pragma endregion
+
+   #pragma region TokenStream Class
+   /// @brief The `<<` operands of a tokenized stream statement, `INDEX` is the operand's position.
+   /// @details The literal operands (bit set in `LITERALS`) are in the token: the always inlined
+   ///          operator doesn't use them, so they aren't kept in flash. The other operands are
+   ///          added to the frame with their type tag.
+   /// @author Chris-70 (2026/10)
+   template<uint32_t LITERALS, uint8_t INDEX>
+   class TokenStream
+      {
+   public:
+      TokenLog& frame;                          ///< The frame of the statement.
+
+      template<typename T>
+      inline __attribute__((always_inline)) TokenStream<LITERALS, INDEX + 1> operator<<(const T& value)
+         {
+         putOperand(value, TokenBool<((LITERALS >> (INDEX % SERIAL_TOKEN_OPERANDS_MAX)) & 1UL) != 0>());
+         return TokenStream<LITERALS, INDEX + 1>{ frame };
+         }
+
+   private:
+      template<typename T>
+      inline __attribute__((always_inline)) void putOperand(const T&, TokenBool<true>)
+         { }
+
+      template<typename T>
+      void putOperand(const T& value, TokenBool<false>)
+         { frame.putTagged(value); }
+      }; // class TokenStream
+   #pragma endregion
+   } // namespace BinaryClockShield
+
+#endif // __SERIALTOKENLOG_H__
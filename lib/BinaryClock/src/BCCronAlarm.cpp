@@ -0,0 +1,269 @@
+/// @file BCCronAlarm.cpp
+/// @brief This file contains the implementation of the `BCCronAlarm` class, the cron style
+///        alarm rule compiled into bitmasks.
+/// @author Chris-70 (2026/10)
+
+#include "BCCronAlarm.h"
+
+namespace BinaryClockShield
+   {
+   static const char* const MonthNames[]   = { "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC", nullptr };
+   static const char* const WeekdayNames[] = { "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT", nullptr };
+
+   /// @brief The cron shortcuts and the expression they replace.
+   static const char* const Shortcuts[][2] =
+         {
+         { "@yearly",   "0 0 1 1 *" },
+         { "@annually", "0 0 1 1 *" },
+         { "@monthly",  "0 0 1 * *" },
+         { "@weekly",   "0 0 * * 0" },
+         { "@daily",    "0 0 * * *" },
+         { "@midnight", "0 0 * * *" },
+         { "@hourly",   "0 * * * *" },
+         };
+
+   /// @brief Count trailing zeros of a non zero value.
+   static inline uint8_t ctz32(uint32_t value) { return (uint8_t)__builtin_ctzl(value); }
+   static inline uint8_t ctz64(uint64_t value) { return (uint8_t)__builtin_ctzll(value); }
+
+   static bool sameText(const char* a, const char* b)
+      {
+      while (*a && *b)
+         {
+         char ca = ((*a >= 'a') && (*a <= 'z')) ? (char)(*a - 'a' + 'A') : *a;
+         char cb = ((*b >= 'a') && (*b <= 'z')) ? (char)(*b - 'a' + 'A') : *b;
+         if (ca != cb) { return false; }
+         a++; b++;
+         }
+
+      return (*a == *b);
+      }
+
+   bool BCCronAlarm::Parse(const char* expression)
+      {
+      Clear();
+      if (expression == nullptr) { return false; }
+
+      while (*expression == ' ') { expression++; }
+      if (*expression == '@')
+         {
+         for (const auto& shortcut : Shortcuts)
+            {
+            if (sameText(expression, shortcut[0])) { return Parse(shortcut[1]); }
+            }
+
+         return false;
+         }
+
+      uint64_t minuteMask = 0, hourMask = 0, dayMask = 0, monthMask = 0, weekdayMask = 0;
+      bool any = false;
+      const char* text = expression;
+      if (((text = parseField(text, 0, 59, nullptr,      minuteMask,  any))        == nullptr)
+       || ((text = parseField(text, 0, 23, nullptr,      hourMask,    any))        == nullptr)
+       || ((text = parseField(text, 1, 31, nullptr,      dayMask,     anyDay))     == nullptr)
+       || ((text = parseField(text, 1, 12, MonthNames,   monthMask,   any))        == nullptr)
+       || ((text = parseField(text, 0,  7, WeekdayNames, weekdayMask, anyWeekday)) == nullptr))
+         {
+         Clear();
+         return false;
+         }
+
+      while (*text == ' ') { text++; }
+      if (*text != '\0')
+         {
+         Clear();
+         return false;
+         }
+
+      // Weekday 7 is also Sunday.
+      if (weekdayMask & (1U << 7)) { weekdayMask = (weekdayMask | 1U) & 0x7FU; }
+
+      minutes  = minuteMask;
+      hours    = (uint32_t)hourMask;
+      days     = (uint32_t)dayMask;
+      months   = (uint16_t)monthMask;
+      weekdays = (uint8_t)weekdayMask;
+      return true;
+      }
+
+   void BCCronAlarm::Clear()
+      {
+      minutes    = 0;
+      hours      = 0;
+      days       = 0;
+      months     = 0;
+      weekdays   = 0;
+      anyDay     = true;
+      anyWeekday = true;
+      }
+
+   bool BCCronAlarm::Matches(uint32_t time) const
+      {
+      uint32_t dayCount = time / BCCRON_SECONDS_DAY;
+      uint32_t seconds  = time % BCCRON_SECONDS_DAY;
+      uint16_t year;
+      uint8_t  month, day;
+      CivilFromDays(dayCount, year, month, day);
+
+      return ((minutes & (1ULL << ((seconds % 3600) / 60))) != 0)
+          && ((hours   & (1UL  << (seconds / 3600)))        != 0)
+          && ((months  & (1U   << month))                   != 0)
+          && dayMatches(day, (uint8_t)((dayCount + 4) % 7));   // 1970-01-01 was a Thursday (4)
+      }
+
+   uint32_t BCCronAlarm::NextMatch(uint32_t time) const
+      {
+      if (!get_IsValid()) { return 0; }
+
+      uint32_t next = (time / 60 + 1) * 60;  // The next whole minute.
+      for (uint16_t guard = 0; guard < BCCRON_SEARCH_DAYS; guard++)
+         {
+         uint32_t dayCount = next / BCCRON_SECONDS_DAY;
+         uint32_t seconds  = next % BCCRON_SECONDS_DAY;
+         uint16_t year;
+         uint8_t  month, day;
+         CivilFromDays(dayCount, year, month, day);
+
+         if ((months & (1U << month)) == 0)
+            {
+            // Skip to the first day of the next month.
+            next = (dayCount + (DaysInMonth(year, month) - day) + 1) * BCCRON_SECONDS_DAY;
+            continue;
+            }
+
+         if (dayMatches(day, (uint8_t)((dayCount + 4) % 7)))
+            {
+            uint8_t hour   = (uint8_t)(seconds / 3600);
+            uint8_t minute = (uint8_t)((seconds % 3600) / 60);
+            uint32_t start = dayCount * BCCRON_SECONDS_DAY;
+
+            if (hours & (1UL << hour))
+               {
+               uint64_t minuteMask = minutes >> minute;
+               if (minuteMask != 0)
+                  { return start + hour * 3600UL + (minute + ctz64(minuteMask)) * 60UL; }
+               }
+
+            // The first matching hour after this one, at its first matching minute.
+            uint32_t hourMask = (hour < 23) ? (hours >> (hour + 1)) : 0;
+            if (hourMask != 0)
+               { return start + (hour + 1 + ctz32(hourMask)) * 3600UL + ctz64(minutes) * 60UL; }
+            }
+
+         next = (dayCount + 1) * BCCRON_SECONDS_DAY;
+         }
+
+      return 0;
+      }
+
+   //################################################################################//
+   // Date helpers
+   //################################################################################//
+
+   void BCCronAlarm::CivilFromDays(uint32_t dayCount, uint16_t& year, uint8_t& month, uint8_t& day)
+      {
+      // Howard Hinnant's days to civil algorithm, for unsigned days since 1970-01-01.
+      uint32_t z   = dayCount + 719468UL;
+      uint32_t era = z / 146097UL;
+      uint32_t doe = z - era * 146097UL;                                         // [0, 146096]
+      uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;     // [0, 399]
+      uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                   // [0, 365]
+      uint32_t mp  = (5 * doy + 2) / 153;                                       // [0, 11]
+      day   = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+      month = (uint8_t)((mp < 10) ? (mp + 3) : (mp - 9));
+      year  = (uint16_t)(yoe + era * 400 + ((month <= 2) ? 1 : 0));
+      }
+
+   uint8_t BCCronAlarm::DaysInMonth(uint16_t year, uint8_t month)
+      {
+      static const uint8_t monthDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+      bool leap = ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0));
+      return ((month == 2) && leap) ? 29 : monthDays[month - 1];
+      }
+
+   //################################################################################//
+   // Parser helpers
+   //################################################################################//
+
+   const char* BCCronAlarm::parseValue(const char* text, const char* const* names, uint8_t minValue, int& value)
+      {
+      if ((*text >= '0') && (*text <= '9'))
+         {
+         value = 0;
+         while ((*text >= '0') && (*text <= '9'))
+            {
+            value = value * 10 + (*text++ - '0');
+            if (value > 255) { return nullptr; }
+            }
+
+         return text;
+         }
+
+      // A three letter name, e.g. "JAN" or "mon".
+      if (names != nullptr)
+         {
+         char name[4] = { 0 };
+         for (int i = 0; i < 3; i++)
+            {
+            if (text[i] == '\0') { return nullptr; }
+            name[i] = text[i];
+            }
+
+         for (int i = 0; names[i] != nullptr; i++)
+            {
+            if (sameText(name, names[i]))
+               {
+               value = i + minValue;
+               return text + 3;
+               }
+            }
+         }
+
+      return nullptr;
+      }
+
+   const char* BCCronAlarm::parseField(const char* text, uint8_t minValue, uint8_t maxValue, const char* const* names, uint64_t& mask, bool& any)
+      {
+      while (*text == ' ') { text++; }
+      if (*text == '\0') { return nullptr; }
+
+      any  = (*text == '*');
+      mask = 0;
+      for (;;)
+         {
+         int first = minValue;
+         int last  = maxValue;
+         int step  = 1;
+         bool single = false;
+
+         if (*text == '*')
+            { text++; }
+         else
+            {
+            if ((text = parseValue(text, names, minValue, first)) == nullptr) { return nullptr; }
+            last = first;
+            single = (*text != '-');
+            if (*text == '-')
+               {
+               if ((text = parseValue(text + 1, names, minValue, last)) == nullptr) { return nullptr; }
+               }
+            }
+
+         if (*text == '/')
+            {
+            if ((text = parseValue(text + 1, nullptr, 0, step)) == nullptr) { return nullptr; }
+            if (single) { last = maxValue; }   // "N/S" is "N-max/S"
+            }
+
+         if ((first < minValue) || (last > maxValue) || (first > last) || (step < 1)) { return nullptr; }
+
+         for (int value = first; value <= last; value += step)
+            { mask |= (1ULL << value); }
+
+         if (*text != ',') { break; }
+         text++;
+         }
+
+      return ((*text == ' ') || (*text == '\0')) ? text : nullptr;
+      }
+   } // namespace BinaryClockShield
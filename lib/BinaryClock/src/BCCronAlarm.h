@@ -0,0 +1,123 @@
+/// @file BCCronAlarm.h
+/// @brief This file contains the declaration of the `BCCronAlarm` class, a cron style alarm rule
+///        compiled into bitmasks, e.g. "30 6 * * 1-5" (weekdays at 06:30) or "*/15 9-17 * * *".
+/// @details The five fields (minute; hour; day of month; month; weekday) are compiled once by `Parse()`
+///          into a 64-bit minute mask, a 32-bit hour mask, a 32-bit day of month mask, a 16-bit month
+///          mask and an 8-bit weekday mask. `Matches()` is then a few AND operations and `NextMatch()`
+///          skips whole months, days and hours using count trailing zeros on the masks instead of
+///          stepping minute by minute. The result of `NextMatch()` is used to program the RTC alarm
+///          with the DS3231 date match mode, after the alarm fires the next match is programmed.
+/// @remarks The syntax is the standard (Vixie) cron syntax: `*`; `N`; `N-M`; `*/S`; `N-M/S`; lists
+///          with `,`; the month (`JAN` - `DEC`) and weekday (`SUN` - `SAT`) names; the weekday
+///          `0` and `7` are both Sunday. When both the day of month and weekday are restricted the
+///          rule matches either one (cron semantics). The shortcuts `@yearly`; `@monthly`; `@weekly`;
+///          `@daily` and `@hourly` are also accepted.
+/// @note    The class only uses integer time (unixtime seconds, the RTC local time) and has no
+///          Arduino dependencies so the same code can be checked on the host.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_CRONALARM_H__
+#define __BC_CRONALARM_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef BCCRON_SEARCH_DAYS
+   #define BCCRON_SEARCH_DAYS   2930U  ///< `NextMatch()` search limit in days (8 years, e.g. "0 0 29 2 *").
+#endif
+#define BCCRON_SECONDS_DAY     86400UL ///< The number of seconds in a day.
+
+namespace BinaryClockShield
+   {
+   /// @brief A cron style alarm rule compiled into bitmasks.
+   /// @author Chris-70 (2026/10)
+   class BCCronAlarm
+      {
+   public:
+      BCCronAlarm() = default;
+
+      /// @brief Constructor that compiles the cron expression.
+      /// @param expression The cron expression, check `get_IsValid()` for the result.
+      BCCronAlarm(const char* expression) { Parse(expression); }
+
+      /// @brief Compile the 5 field cron expression into the bitmasks.
+      /// @param expression The cron expression, e.g. "30 6 * * MON-FRI".
+      /// @return True if the expression is valid. On error the rule is cleared (never matches).
+      /// @author Chris-70 (2026/10)
+      bool Parse(const char* expression);
+
+      /// @brief Clear the rule, it no longer matches any time.
+      void Clear();
+
+      /// @brief Check if the minute containing `time` matches the rule.
+      /// @param time The time to check, unixtime (local).
+      /// @return True if the rule matches (the seconds are ignored).
+      /// @author Chris-70 (2026/10)
+      bool Matches(uint32_t time) const;
+
+      /// @brief Find the first matching minute after `time`.
+      /// @details Months, days and hours that don't match are skipped whole, the matching hour
+      ///          and minute are found with count trailing zeros on the masks.
+      /// @param time The start time, unixtime (local). The result is always later than `time`.
+      /// @return The time of the next match (seconds == 0), or `0` if there is no match within
+      ///         `BCCRON_SEARCH_DAYS` (e.g. "0 0 31 2 *") or the rule isn't valid.
+      /// @author Chris-70 (2026/10)
+      uint32_t NextMatch(uint32_t time) const;
+
+      /// @brief Read only property: The rule was compiled successfully.
+      bool get_IsValid() const { return (minutes != 0); }
+
+      /// @brief Read only property: The minute bitmask, bit `n` is minute `n` (0 - 59).
+      uint64_t get_Minutes() const { return minutes; }
+
+      /// @brief Read only property: The hour bitmask, bit `n` is hour `n` (0 - 23).
+      uint32_t get_Hours() const { return hours; }
+
+      /// @brief Read only property: The day of month bitmask, bit `n` is day `n` (1 - 31).
+      uint32_t get_Days() const { return days; }
+
+      /// @brief Read only property: The month bitmask, bit `n` is month `n` (1 - 12).
+      uint16_t get_Months() const { return months; }
+
+      /// @brief Read only property: The weekday bitmask, bit `n` is weekday `n` (0 = Sunday - 6).
+      uint8_t get_Weekdays() const { return weekdays; }
+
+      /// @brief Convert days since 1970-01-01 to the civil date.
+      /// @param dayCount The number of days since 1970-01-01.
+      /// @param year Returns the year.
+      /// @param month Returns the month (1 - 12).
+      /// @param day Returns the day of the month (1 - 31).
+      static void CivilFromDays(uint32_t dayCount, uint16_t& year, uint8_t& month, uint8_t& day);
+
+      /// @brief The number of days in the month.
+      static uint8_t DaysInMonth(uint16_t year, uint8_t month);
+
+   protected:
+      /// @brief Compile one field, e.g. "1-5", "*/15" or "JAN,JUL", into `mask`.
+      /// @return The position after the field, or `nullptr` on error.
+      static const char* parseField(const char* text, uint8_t minValue, uint8_t maxValue, const char* const* names, uint64_t& mask, bool& any);
+
+      /// @brief Parse a number or a name in the field, returns `nullptr` on error.
+      static const char* parseValue(const char* text, const char* const* names, uint8_t minValue, int& value);
+
+      /// @brief Check the day of month / weekday part of the rule.
+      bool dayMatches(uint8_t day, uint8_t weekday) const
+         {
+         bool domMatch = (days     & (1UL << day))     != 0;
+         bool dowMatch = (weekdays & (1U  << weekday)) != 0;
+         return (anyDay || anyWeekday) ? (domMatch && dowMatch) : (domMatch || dowMatch);
+         }
+
+   private:
+      uint64_t minutes    = 0;         ///< Bit `n` set: minute `n` matches.
+      uint32_t hours      = 0;         ///< Bit `n` set: hour `n` matches.
+      uint32_t days       = 0;         ///< Bit `n` set: day of month `n` matches.
+      uint16_t months     = 0;         ///< Bit `n` set: month `n` matches.
+      uint8_t  weekdays   = 0;         ///< Bit `n` set: weekday `n` (0 = Sunday) matches.
+      bool     anyDay     = true;      ///< The day of month field is `*`.
+      bool     anyWeekday = true;      ///< The weekday field is `*`.
+      }; // class BCCronAlarm
+   } // namespace BinaryClockShield
+
+#endif // __BC_CRONALARM_H__
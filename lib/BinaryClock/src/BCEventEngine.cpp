@@ -0,0 +1,197 @@
+/// @file BCEventEngine.cpp
+/// @brief This file contains the implementation of the `BCEventEngine` class, the min-heap
+///        scheduler for the clock events.
+/// @author Chris-70 (2026/10)
+
+#include "BCEventEngine.h"
+
+namespace BinaryClockShield
+   {
+   uint8_t BCEventEngine::Add(const ClockEvent& event)
+      {
+      if (count >= BCEVENT_MAX_EVENTS) { return 0; }
+
+      uint8_t id = newId();
+      heap[count] = event;
+      heap[count].id = id;
+      siftUp(count++);
+      return id;
+      }
+
+   uint8_t BCEventEngine::AddChime(uint32_t now, uint8_t melody, uint8_t repeat, uint8_t pattern)
+      {
+      ClockEvent event = { nextAfter(0, BCEVENT_SECONDS_HOUR, now), BCEVENT_SECONDS_HOUR, 0, EventType::Chime, melody, repeat, pattern };
+      return Add(event);
+      }
+
+   uint8_t BCEventEngine::AddTimer(uint32_t now, uint32_t seconds, uint8_t melody, bool periodic, uint8_t pattern)
+      {
+      if (seconds == 0) { return 0; }
+
+      ClockEvent event = { now + seconds, (periodic ? seconds : 0), 0, EventType::Timer, melody, 1, pattern };
+      return Add(event);
+      }
+
+   uint8_t BCEventEngine::AddSnooze(uint32_t now, uint32_t seconds, uint8_t melody, uint8_t repeat)
+      {
+      CancelType(EventType::Snooze);
+      ClockEvent event = { now + seconds, 0, 0, EventType::Snooze, melody, repeat, BCEVENT_NO_PATTERN };
+      return Add(event);
+      }
+
+   uint8_t BCEventEngine::AddAlarm(uint32_t fireTime, uint32_t period, uint8_t melody, uint8_t repeat, uint8_t pattern)
+      {
+      ClockEvent event = { fireTime, period, 0, EventType::Alarm, melody, repeat, pattern };
+      return Add(event);
+      }
+
+   bool BCEventEngine::Cancel(uint8_t id)
+      {
+      for (size_t i = 0; i < count; i++)
+         {
+         if (heap[i].id == id)
+            {
+            removeAt(i);
+            return true;
+            }
+         }
+
+      return false;
+      }
+
+   size_t BCEventEngine::CancelType(EventType type)
+      {
+      size_t removed = 0;
+      for (size_t i = 0; i < count; )
+         {
+         if (heap[i].type == type)
+            {
+            heap[i] = heap[--count];
+            removed++;
+            }
+         else
+            { i++; }
+         }
+
+      if (removed > 0) { heapify(); }
+      return removed;
+      }
+
+   bool BCEventEngine::PopDue(uint32_t now, ClockEvent& event)
+      {
+      // The O(1) path: nothing is due.
+      if ((count == 0) || (heap[0].nextFire > now)) { return false; }
+
+      event = heap[0];
+      if (heap[0].period > 0)
+         {
+         // Skip the missed periods and keep the entry, only the top moved later.
+         heap[0].nextFire = nextAfter(heap[0].nextFire, heap[0].period, now);
+         siftDown(0);
+         }
+      else
+         {
+         removeAt(0);
+         }
+
+      return true;
+      }
+
+   void BCEventEngine::TimeChanged(uint32_t before, uint32_t after)
+      {
+      for (size_t i = 0; i < count; i++)
+         {
+         ClockEvent& event = heap[i];
+         if ((event.type == EventType::Timer) || (event.type == EventType::Snooze))
+            {
+            // Relative events keep the remaining time.
+            uint32_t remaining = (event.nextFire > before) ? (event.nextFire - before) : 0;
+            event.nextFire = after + remaining;
+            }
+         else if ((event.period > 0) && (event.nextFire <= after))
+            {
+            event.nextFire = nextAfter(event.nextFire, event.period, after);
+            }
+         else if ((event.period > 0) && (after < before))
+            {
+            // Stepped back: the next occurrence may now be a period (or more) earlier.
+            uint32_t offset = event.nextFire % event.period;
+            event.nextFire = nextAfter(offset, event.period, after);
+            }
+         }
+
+      heapify();
+      }
+
+   //################################################################################//
+   // Heap helpers
+   //################################################################################//
+
+   void BCEventEngine::siftUp(size_t index)
+      {
+      ClockEvent event = heap[index];
+      while (index > 0)
+         {
+         size_t parent = (index - 1) / 2;
+         if (!before(event, heap[parent])) { break; }
+         heap[index] = heap[parent];
+         index = parent;
+         }
+
+      heap[index] = event;
+      }
+
+   void BCEventEngine::siftDown(size_t index)
+      {
+      ClockEvent event = heap[index];
+      for (;;)
+         {
+         size_t child = 2 * index + 1;
+         if (child >= count) { break; }
+         if (((child + 1) < count) && before(heap[child + 1], heap[child])) { child++; }
+         if (!before(heap[child], event)) { break; }
+         heap[index] = heap[child];
+         index = child;
+         }
+
+      heap[index] = event;
+      }
+
+   void BCEventEngine::removeAt(size_t index)
+      {
+      heap[index] = heap[--count];
+      if (index < count)
+         {
+         siftDown(index);
+         siftUp(index);
+         }
+      }
+
+   void BCEventEngine::heapify()
+      {
+      for (size_t i = count / 2; i-- > 0; )
+         { siftDown(i); }
+      }
+
+   uint8_t BCEventEngine::newId()
+      {
+      // Ids wrap around 1 - 255, skip the ones still in use.
+      for (;;)
+         {
+         if (++lastId == 0) { lastId = 1; }
+
+         bool used = false;
+         for (size_t i = 0; (i < count) && !used; i++)
+            { used = (heap[i].id == lastId); }
+
+         if (!used) { return lastId; }
+         }
+      }
+
+   uint32_t BCEventEngine::nextAfter(uint32_t start, uint32_t period, uint32_t now)
+      {
+      if (start > now) { return start; }
+
+      return start + ((now - start) / period + 1) * period;
+      }
+   } // namespace BinaryClockShield
@@ -0,0 +1,145 @@
+/// @file BCEventEngine.h
+/// @brief This file contains the declaration of the `BCEventEngine` class, the scheduler for the
+///        hourly chimes, countdown timers, snooze and software alarms.
+/// @details All the events are entries in a single binary min-heap ordered by the next fire time.
+///          The clock checks the heap once per tick from `TimeDispatch()`; when nothing is due this is
+///          a single compare with the top entry, O(1). A due event is removed, O(log n), and a periodic
+///          event is put back with its next fire time.
+/// @remarks The class only uses integer time (unixtime seconds, the RTC local time) and has no
+///          Arduino or FreeRTOS dependencies so the same code can be fast-forwarded on the host:
+///          call `PopDue()` with any time value, the missed periods are skipped, not replayed.
+///          The caller provides any locking required (e.g. `BinaryClock` uses a critical section).
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_EVENTENGINE_H__
+#define __BC_EVENTENGINE_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef BCEVENT_MAX_EVENTS
+   #define BCEVENT_MAX_EVENTS    16U   ///< The maximum number of scheduled events.
+#endif
+#define BCEVENT_NO_PATTERN     0xFFU   ///< No LED pattern is displayed when the event fires.
+#define BCEVENT_SECONDS_HOUR   3600UL  ///< Period of the hourly chime.
+
+namespace BinaryClockShield
+   {
+   /// @brief The type of a scheduled event, also the priority when several fire on the same tick. Type: uint8_t
+   enum class EventType : uint8_t
+      {
+      Chime = 0,     ///< Hourly chime, always on the hour.
+      Timer,         ///< Countdown timer, relative to when it was started.
+      Snooze,        ///< Snooze after an alarm, relative to when it was started.
+      Alarm          ///< Software alarm at a wall clock time, optionally repeating.
+      };
+
+   /// @brief A scheduled event, an entry in the `BCEventEngine` heap.
+   struct ClockEvent
+      {
+      uint32_t nextFire;   ///< The next fire time, unixtime (seconds).
+      uint32_t period;     ///< The repeat period in seconds, `0` for a one shot event.
+      uint8_t  id;         ///< The handle returned when the event was added, never `0`.
+      EventType type;      ///< The type of event.
+      uint8_t  melody;     ///< The melody registry id to play when it fires.
+      uint8_t  repeat;     ///< The number of times to play the melody, `0` for no sound.
+      uint8_t  pattern;    ///< The `LedPattern` to display when it fires, `BCEVENT_NO_PATTERN` for none.
+      };
+
+   /// @brief Min-heap scheduler for the clock events (chimes, timers, snooze and software alarms).
+   /// @author Chris-70 (2026/10)
+   class BCEventEngine
+      {
+   public:
+      BCEventEngine() = default;
+
+      /// @brief Add an event. The `id` in `event` is ignored, a new one is assigned.
+      /// @param event The event, `nextFire` must be set.
+      /// @return The event id (1 - 255), or `0` if the engine is full.
+      /// @author Chris-70 (2026/10)
+      uint8_t Add(const ClockEvent& event);
+
+      /// @brief Add an hourly chime that fires on the next hour after `now`, then every hour.
+      /// @return The event id, or `0` if the engine is full.
+      uint8_t AddChime(uint32_t now, uint8_t melody, uint8_t repeat = 1, uint8_t pattern = BCEVENT_NO_PATTERN);
+
+      /// @brief Add a countdown timer that fires `seconds` after `now`.
+      /// @param periodic If true the timer restarts every time it fires.
+      /// @return The event id, or `0` if the engine is full.
+      uint8_t AddTimer(uint32_t now, uint32_t seconds, uint8_t melody, bool periodic = false, uint8_t pattern = BCEVENT_NO_PATTERN);
+
+      /// @brief Add a one shot snooze that fires `seconds` after `now`. Only one snooze exists at a time.
+      /// @return The event id, or `0` if the engine is full.
+      uint8_t AddSnooze(uint32_t now, uint32_t seconds, uint8_t melody, uint8_t repeat);
+
+      /// @brief Add a software alarm at `fireTime`, repeating every `period` seconds (`0` one shot).
+      /// @return The event id, or `0` if the engine is full.
+      uint8_t AddAlarm(uint32_t fireTime, uint32_t period, uint8_t melody, uint8_t repeat, uint8_t pattern = BCEVENT_NO_PATTERN);
+
+      /// @brief Remove the event with the id.
+      /// @return True if the event was found and removed.
+      /// @author Chris-70 (2026/10)
+      bool Cancel(uint8_t id);
+
+      /// @brief Remove all the events of the type, e.g. all the chimes.
+      /// @return The number of events removed.
+      size_t CancelType(EventType type);
+
+      /// @brief Remove all the events.
+      void Clear() { count = 0; }
+
+      /// @brief Remove the first event due at `now` and return it in `event`.
+      /// @details Call repeatedly until it returns false, or once per tick: the events not
+      ///          taken stay due and are returned by the next calls, the highest `EventType` of
+      ///          the same time first. A periodic event is rescheduled to the first period after
+      ///          `now`, so a jump forward fires it once, not once per missed period. When nothing
+      ///          is due this is one compare.
+      /// @param now The current time, unixtime.
+      /// @param event Returns the event that fired.
+      /// @return True if an event was due.
+      /// @author Chris-70 (2026/10)
+      bool PopDue(uint32_t now, ClockEvent& event);
+
+      /// @brief Adjust the events after the clock was set (a time step).
+      /// @details Timers and snooze keep their remaining time (shifted by the step). Chimes
+      ///          and alarms are wall clock times: the ones now in the past are moved to their
+      ///          first period after `after`, one shot alarms in the past are fired on the
+      ///          next `PopDue()`.
+      /// @param before The time before the step.
+      /// @param after The time after the step.
+      /// @author Chris-70 (2026/10)
+      void TimeChanged(uint32_t before, uint32_t after);
+
+      /// @brief Read only property: The next fire time, `UINT32_MAX` when empty.
+      uint32_t get_NextFire() const
+         { return (count > 0) ? heap[0].nextFire : UINT32_MAX; }
+
+      /// @brief Read only property: The number of scheduled events.
+      size_t get_Count() const { return count; }
+
+      /// @brief Read only property: The event at `index` (heap order, not time order).
+      const ClockEvent& get_Event(size_t index) const { return heap[index]; }
+
+   protected:
+      /// @brief Return true if event `a` should fire before event `b`.
+      static bool before(const ClockEvent& a, const ClockEvent& b)
+         { return (a.nextFire != b.nextFire) ? (a.nextFire < b.nextFire) : (a.type > b.type); }
+
+      void siftUp(size_t index);
+      void siftDown(size_t index);
+      void removeAt(size_t index);
+      void heapify();
+      uint8_t newId();
+
+      /// @brief The first time after `now` in the sequence `start + n * period`.
+      static uint32_t nextAfter(uint32_t start, uint32_t period, uint32_t now);
+
+   private:
+      ClockEvent heap[BCEVENT_MAX_EVENTS];   ///< The binary min-heap, `heap[0]` fires first.
+      size_t  count  = 0;                    ///< The number of events in the heap.
+      uint8_t lastId = 0;                    ///< The last id assigned.
+      }; // class BCEventEngine
+   } // namespace BinaryClockShield
+
+#endif // __BC_EVENTENGINE_H__
@@ -0,0 +1,74 @@
+/// @file BCLeapSecond.cpp
+/// @brief This file contains the implementation of the `BCLeapSecond` class, the leap second plan
+///        of the RTC time.
+/// @author Chris-70 (2026/10)
+
+#include "BCLeapSecond.h"
+
+#define BC_LEAP_MIN_SMEAR_S   (2000 / BC_SLEW_STEP_MS)   ///< The shortest smear window (s), half the slew rate.
+
+namespace BinaryClockShield
+   {
+   int32_t BCLeapSecond::Schedule(uint32_t atS, int8_t leap, uint32_t smearS)
+      {
+      leap = (leap > 0) ? 1 : ((leap < 0) ? -1 : 0);
+      if ((smearS != 0) && (smearS < BC_LEAP_MIN_SMEAR_S)) { smearS = BC_LEAP_MIN_SMEAR_S; }
+      if ((smearS >= atS) && (leap != 0)) { smearS = 0; }
+      if ((leap == this->leap) && (atS == this->atS) && (smearS == this->smearS)) { return 0; }   // The same plan, keep going.
+
+      int32_t smeared = smearedMs;
+      this->atS = atS;
+      this->leap = leap;
+      this->smearS = smearS;
+      smearedMs = 0;
+      return smeared;
+      }
+
+   BCLeapAction BCLeapSecond::Tick(uint32_t nowS, bool blocked, int32_t& slewMs)
+      {
+      slewMs = 0;
+      if (leap == 0) { return BCLeapAction::None; }
+
+      int32_t leapMs = -(int32_t)leap * 1000;   // An inserted second: the RTC loses a second.
+      if (smearS > 0)
+         {
+         uint32_t startS = atS - smearS;
+         if (nowS < startS) { return BCLeapAction::None; }
+         if (nowS > atS + 1)
+            {
+            Cancel();      // Missed, e.g. the RTC was stepped over it, the next sync corrects it.
+            return BCLeapAction::None;
+            }
+
+         // The part of the second for the time elapsed in the window, all of it at the event.
+         int32_t target = (nowS >= atS) ? leapMs : (int32_t)((int64_t)leapMs * (int64_t)(nowS - startS) / (int64_t)smearS);
+         int32_t delta = target - smearedMs;
+         if (nowS >= atS)
+            {
+            Cancel();      // The system clock is stepped now, the rest is slewed.
+            slewMs = delta;
+            return (delta != 0) ? BCLeapAction::Slew : BCLeapAction::None;
+            }
+         if ((delta > -BC_SLEW_MIN_MS) && (delta < BC_SLEW_MIN_MS)) { return BCLeapAction::None; }
+
+         smearedMs = target;
+         slewMs = delta;
+         return BCLeapAction::Slew;
+         }
+
+      // Show :60, made on the tick of 00:00:00 (insert) or 23:59:59 (delete).
+      uint32_t secondS = (leap > 0) ? atS : (atS - 1);
+      if (nowS < secondS) { return BCLeapAction::None; }
+
+      int8_t value = leap;
+      Cancel();
+      if (nowS > secondS + 1) { return BCLeapAction::None; }   // Missed.
+      if (blocked || (nowS != secondS))
+         {
+         slewMs = leapMs;  // The alarm second can't be repeated or skipped, or the tick was missed.
+         return BCLeapAction::Slew;
+         }
+
+      return (value > 0) ? BCLeapAction::Repeat : BCLeapAction::Skip;
+      }
+   } // namespace BinaryClockShield
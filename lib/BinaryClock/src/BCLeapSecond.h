@@ -0,0 +1,88 @@
+/// @file BCLeapSecond.h
+/// @brief This file contains the declaration of the `BCLeapSecond` class, the leap second plan of
+///        the RTC time.
+/// @details `DateTime` and the DS3231 can't count to 23:59:60, the leap second is made on the RTC
+///          at the event, so the RTC doesn't need a sync after it to be right:
+///          - show :60 (no smear window): the tick of the first second after an inserted leap
+///            writes 23:59:59 again and the display shows second 60; the tick of 23:59:59 before a
+///            deleted leap writes 00:00:00;
+///          - smear: the second is spread over the window ending at the event, the phase of the
+///            RTC second is moved in `BC_SLEW_MIN_MS` steps (`BCTimeSlew`) as the window elapses.
+///          When the RTC alarm fires in the second repeated or skipped, the second is slewed out
+///          instead so the alarm fires once.
+/// @note    The class only plans the leap (integer seconds and ms) and has no Arduino dependencies
+///          so the same code is checked on the host, `test/host/test_leap_second.cpp` (the Python
+///          model is `test/leap_second_sim.py`); `BinaryClock` does the RTC writes.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_LEAPSECOND_H__
+#define __BC_LEAPSECOND_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#include "BCTimeSlew.h"                /// For `BC_SLEW_MIN_MS` and `BC_SLEW_STEP_MS`.
+
+namespace BinaryClockShield
+   {
+   /// @brief What to do on the RTC at the current tick.
+   enum class BCLeapAction : uint8_t
+      {
+      None = 0,                        ///< Nothing to do.
+      Repeat,                          ///< Write the current second - 1 and show second 60 (inserted leap).
+      Skip,                            ///< Write the current second + 1 (deleted leap).
+      Slew                             ///< Slew the RTC by the ms returned.
+      };
+
+   /// @brief The leap second plan of the RTC time.
+   /// @author Chris-70 (2026/10)
+   class BCLeapSecond
+      {
+   public:
+      BCLeapSecond() = default;
+
+      /// @brief Plan a leap second.
+      /// @param atS The RTC time (unixtime, local) of the first second after the leap.
+      /// @param leap +1 insert; -1 delete; 0 cancels.
+      /// @param smearS The smear window (s) ending at `atS`; 0 shows second 60 (insert) or skips
+      ///               23:59:59 (delete). A window shorter than the slew needs is lengthened.
+      /// @return The ms smeared so far by the plan replaced, the caller slews them back.
+      /// @author Chris-70 (2026/10)
+      int32_t Schedule(uint32_t atS, int8_t leap, uint32_t smearS = 0);
+
+      /// @brief Get the action for the RTC tick of `nowS`, called once per tick (or more, the
+      ///        repeated calls in the same second do nothing).
+      /// @param nowS The RTC time (unixtime, local) of the tick.
+      /// @param blocked True if the RTC alarm fires in the second repeated or skipped.
+      /// @param slewMs Returns the ms to slew for `Slew`: > 0 gain; < 0 lose.
+      /// @return The action, the plan is done after `Repeat`, `Skip` or the last `Slew`.
+      /// @author Chris-70 (2026/10)
+      BCLeapAction Tick(uint32_t nowS, bool blocked, int32_t& slewMs);
+
+      /// @brief The RTC was stepped, the ms smeared so far are gone with it.
+      void Stepped() { smearedMs = 0; }
+
+      /// @brief Stop the plan.
+      void Cancel() { leap = 0; smearedMs = 0; }
+
+      /// @brief Read only property: Flag: a leap second is planned.
+      bool get_IsPending() const { return (leap != 0); }
+
+      /// @brief Read only property: The leap second planned: +1 insert; -1 delete; 0 none.
+      int8_t get_Leap() const { return leap; }
+
+      /// @brief Read only property: The RTC time (unixtime) of the first second after the leap.
+      uint32_t get_AtS() const { return atS; }
+
+      /// @brief Read only property: The ms the RTC was smeared so far, < 0 behind the system clock.
+      int32_t get_SmearedMs() const { return smearedMs; }
+
+   private:
+      uint32_t atS       = 0;          ///< The RTC time (unixtime) of the first second after the leap.
+      uint32_t smearS    = 0;          ///< The smear window (s), 0 for none.
+      int32_t  smearedMs = 0;          ///< The ms smeared so far.
+      int8_t   leap      = 0;          ///< The leap second planned: +1 insert; -1 delete; 0 none.
+      }; // class BCLeapSecond
+   } // namespace BinaryClockShield
+
+#endif // __BC_LEAPSECOND_H__
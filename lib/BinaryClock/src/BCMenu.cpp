@@ -213,6 +213,11 @@ namespace BinaryClockShield
 
    SettingsState BCMenu::ProcessMenu()
       {
+      #if SERIAL_SETUP_CODE && SERIAL_LOG_CEILING_CODE && !SERIAL_COMMAND_CODE
+      while (Serial.available() > 0)
+         { SerialInput(Serial.read()); }
+      #endif
+
       // Main menu handling
       if ((settingsOption == 0) && (settingsLevel == 0))
          {
@@ -706,6 +711,9 @@ namespace BinaryClockShield
       Serial << F("S1 - Time Settings ") << fillStr('-', 25) << endl;
       Serial << F("S2 - Stop Alarm Melody ") << fillStr('-', 21) << endl;
       Serial << F("S3 - Alarm Settings ") << fillStr('-', 24) << endl;
+      #if SERIAL_LOG_CEILING_CODE
+      Serial << F("L0 - L5 - Log Level (None - Verbose) ") << fillStr('-', 7) << endl;
+      #endif
       Serial << strSeparator << endl;
       Serial << strSeparator << endl;
       Serial << strCurrentTime;
@@ -738,6 +746,25 @@ namespace BinaryClockShield
       Serial << strSeparator << endl;
       }
 
+   #if SERIAL_LOG_CEILING_CODE
+   ////////////////////////////////////////////////////////////////////////////////////
+   // Read the log level command: 'L' or 'l' followed by '0' (None) to '5' (Verbose)
+
+   void BCMenu::SerialInput(int ch)
+      {
+      if (!isSerialSetup) { return; }
+
+      if (logCommand && (ch >= '0') && (ch <= ('0' + LOG_LEVEL_VERBOSE)))
+         {
+         static const char* const levelNames[] = { "None", "Error", "Warn", "Info", "Debug", "Verbose" };
+         set_SerialLogCeiling((uint8_t)(ch - '0'));
+         Serial << F("Log level: ") << levelNames[get_SerialLogCeiling()] << endl;
+         }
+
+      logCommand = ((ch == 'L') || (ch == 'l'));
+      }
+   #endif
+
       ////////////////////////////////////////////////////////////////////////////////////
    // Show alarm/time settings
 
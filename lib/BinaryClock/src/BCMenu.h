@@ -208,6 +208,20 @@ namespace BinaryClockShield
       /// @copydoc set_IsSerialSetup()
       /// @see set_IsSerialSetup()
       bool get_IsSerialSetup() const { return isSerialSetup; }
+
+      #if SERIAL_LOG_CEILING_CODE
+      /// @brief The method called with each character received on the serial monitor.
+      /// @details This handles the log level command: 'L' followed by a digit 0 - 5. The digit
+      ///          sets the runtime log ceiling, `set_SerialLogCeiling()`, for the `LOG_<MODULE>_<LEVEL>()`
+      ///          output, e.g. "L2" shows only errors and warnings. It can't enable a level removed at
+      ///          compile time by `LOG_LEVEL_<MODULE>`. Any other input is ignored.
+      /// @remarks When `SERIAL_COMMAND_CODE` is true, the `BCSerialCommand` class reads the serial
+      ///          port and passes the text characters (outside of a command frame) to this method.
+      ///          Otherwise `ProcessMenu()` reads the serial port.
+      /// @param ch The character received.
+      /// @author Chris-70 (2026/10)
+      void SerialInput(int ch);
+      #endif
       #endif
 
       #if SERIAL_TIME_CODE
@@ -399,6 +413,9 @@ namespace BinaryClockShield
       #endif
       #if SERIAL_SETUP_CODE
       bool isSerialSetup;  ///< Flag to indicate if serial setup is enabled, default value to be set in constructor.
+      #if SERIAL_LOG_CEILING_CODE
+      bool logCommand = false;       ///< Flag the 'L' was received, the next character is the log level.
+      #endif
       #endif
 
       char buffer[64] = { 0 };       ///< Buffer for the DateTime string conversions
@@ -0,0 +1,468 @@
+/// @file BCSerialCommand.cpp
+/// @brief This file contains the implementation of the `BCSerialCommand` class,
+///        the binary serial command protocol for bulk configuration.
+/// @author Chris-70 (2026/10)
+
+#include <Arduino.h>             /// Arduino core library. This needs to be the first include file.
+
+#include <BinaryClock.Defines.h> /// BinaryClock project-wide definitions and MACROs.
+#include "BCSerialCommand.h"     /// Binary Clock serial command protocol class.
+
+#if SERIAL_COMMAND_CODE
+#include "BinaryClock.h"         /// The BinaryClock class, the target of the built-in commands.
+
+#if SERIAL_ASYNC_LOG
+   #include "SerialLogger.h"     /// The reply is queued with the log output so they never interleave.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// Little endian reads, the records aren't aligned.
+   static inline uint16_t readU16(const uint8_t* data)
+      { return (uint16_t)(data[0] | (data[1] << 8)); }
+
+   static inline uint32_t readU32(const uint8_t* data)
+      { return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24); }
+
+   BCSerialCommand::BCSerialCommand(BinaryClock& clock)
+         : clock(clock)
+      {
+      }
+
+   void BCSerialCommand::Process()
+      {
+      // Discard a partial frame when the host stopped sending, e.g. the tool was interrupted.
+      if (inFrame && (frameLength > 0) && ((millis() - lastByteTime) > BCCMD_FRAME_TIMEOUT))
+         {
+         inFrame  = false;
+         overflow = false;
+         frameLength = 0;
+         errorCount++;
+         }
+
+      while (Serial.available() > 0)
+         {
+         int ch = Serial.read();
+         if (ch < 0) { break; }
+
+         if (ch == 0x00)
+            {
+            // The delimiter: starts a frame when empty, ends it otherwise.
+            if (inFrame && (frameLength > 0))
+               {
+               if (overflow) { errorCount++; }
+               else          { processFrame(); }
+
+               inFrame = false;
+               }
+            else
+               { inFrame = true; }
+
+            overflow = false;
+            frameLength = 0;
+            lastByteTime = millis();
+            }
+         else if (inFrame)
+            {
+            if (frameLength < sizeof(frame))
+               { frame[frameLength++] = (uint8_t)ch; }
+            else
+               { overflow = true; }
+
+            lastByteTime = millis();
+            }
+         else if (textHandler != nullptr)
+            {
+            textHandler(ch);
+            }
+         }
+      }
+
+   bool BCSerialCommand::RegisterCommand(uint8_t command, CommandHandler handler, CommitHandler commit)
+      {
+      if ((command < BCCMD_USER_FIRST) || (command > BCCMD_USER_LAST) || (handler == nullptr)) { return false; }
+
+      int index = findHandler(command);
+      if (index < 0)
+         {
+         if (handlerCount >= BCCMD_MAX_HANDLERS) { return false; }
+         index = handlerCount++;
+         handlerCommands[index] = command;
+         }
+
+      handlers[index] = handler;
+      commits[index] = commit;
+      return true;
+      }
+
+   //################################################################################//
+   // COBS and CRC
+   //################################################################################//
+
+   size_t BCSerialCommand::CobsEncode(const uint8_t* data, size_t length, uint8_t* output)
+      {
+      size_t codeIndex = 0;
+      size_t outIndex  = 1;
+      uint8_t code     = 1;
+
+      for (size_t i = 0; i < length; i++)
+         {
+         if (data[i] == 0x00)
+            {
+            output[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+            }
+         else
+            {
+            output[outIndex++] = data[i];
+            if (++code == 0xFF)
+               {
+               output[codeIndex] = code;
+               codeIndex = outIndex++;
+               code = 1;
+               }
+            }
+         }
+
+      output[codeIndex] = code;
+      return outIndex;
+      }
+
+   size_t BCSerialCommand::CobsDecode(uint8_t* data, size_t length)
+      {
+      size_t readIndex  = 0;
+      size_t writeIndex = 0;
+
+      while (readIndex < length)
+         {
+         uint8_t code = data[readIndex++];
+         if ((code == 0x00) || ((readIndex + code - 1U) > length)) { return 0; }
+
+         for (uint8_t i = 1; i < code; i++)
+            { data[writeIndex++] = data[readIndex++]; }
+
+         // A code of 0xFF is a full block without a zero; the last block has no zero either.
+         if ((code != 0xFF) && (readIndex < length))
+            { data[writeIndex++] = 0x00; }
+         }
+
+      return writeIndex;
+      }
+
+   uint16_t BCSerialCommand::Crc16(const uint8_t* data, size_t length)
+      {
+      uint16_t crc = 0xFFFFU;
+      while (length-- > 0)
+         {
+         crc ^= (uint16_t)(*data++) << 8;
+         for (uint8_t bit = 0; bit < 8; bit++)
+            { crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1); }
+         }
+
+      return crc;
+      }
+
+   //################################################################################//
+   // Frame processing
+   //################################################################################//
+
+   void BCSerialCommand::processFrame()
+      {
+      size_t length = CobsDecode(frame, frameLength);
+
+      // Smallest frame: version, sequence and CRC.
+      if ((length < 4) || (Crc16(frame, length - 2) != readU16(frame + length - 2)))
+         {
+         errorCount++;
+         LOG_MENU_WARN("Serial command: bad frame (" << frameLength << " bytes)." << endl)
+         return;
+         }
+
+      uint8_t sequence = frame[1];
+      if (frame[0] != BCCMD_VERSION)
+         {
+         errorCount++;
+         sendReply(sequence, Status::BadVersion, 0, false);
+         return;
+         }
+
+      frameCount++;
+      const uint8_t* body = frame + 2;
+      size_t bodyLength   = length - 4;
+      uint8_t index       = 0;
+      Status status       = Status::Ok;
+
+      // Don't change the settings under the user while the menu is in use.
+      handlerUsed = 0;
+      if (clock.get_SettingsState() != SettingsState::Inactive)
+         { status = Status::Busy; }
+      else
+         { status = processRecords(body, bodyLength, Phase::Validate, false, index); }
+
+      if (status == Status::Ok)
+         {
+         // The handler records first, they can fail: a checkpoint, apply, then one commit per
+         // store (e.g. a single NVS save for the WiFi credentials and the timezone). On a
+         // failure the stores not committed are rolled back and nothing else is applied.
+         uint8_t begun = 0;
+         uint8_t committed = 0;
+         status = callCommits(Phase::Begin, handlerUsed, begun);
+         if (status == Status::Ok) { status = processRecords(body, bodyLength, Phase::Apply, false, index); }
+         if (status == Status::Ok) { status = callCommits(Phase::Commit, begun, committed); }
+
+         if (status == Status::Ok)
+            { processRecords(body, bodyLength, Phase::Apply, true, index); }   // Validated, the built-in records can't fail.
+         else
+            {
+            uint8_t undone = 0;
+            callCommits(Phase::Rollback, begun & ~committed, undone);
+            }
+         }
+
+      // Only add the status block when it was requested.
+      bool addStatus = false;
+      for (size_t pos = 0; (pos + 2) <= bodyLength; pos += 2 + body[pos + 1])
+         {
+         if (body[pos] == (uint8_t)Command::Status) { addStatus = true; break; }
+         }
+
+      LOG_MENU_INFO("Serial command #" << sequence << ": status " << (uint8_t)status << ", record " << index << endl)
+      sendReply(sequence, status, index, addStatus);
+      }
+
+   BCSerialCommand::Status BCSerialCommand::processRecords(const uint8_t* body, size_t length, Phase phase, bool builtIn, uint8_t& index)
+      {
+      size_t pos = 0;
+      for (index = 0; pos < length; index++)
+         {
+         if ((pos + 2) > length) { return Status::BadLength; }
+         uint8_t command = body[pos];
+         uint8_t size    = body[pos + 1];
+         const uint8_t* data = body + pos + 2;
+         if ((pos + 2 + size) > length) { return Status::BadLength; }
+
+         Status status = Status::Ok;
+         int handler = findHandler(command);
+         if (handler >= 0)
+            {
+            if (phase == Phase::Validate)
+               {
+               status = handlers[handler](phase, data, size);
+               handlerUsed |= (1U << handler);
+               }
+            else if (!builtIn)
+               { status = handlers[handler](phase, data, size); }
+            }
+         else if ((phase == Phase::Validate) || builtIn)
+            {
+            status = builtInCommand((Command)command, data, size, phase);
+            }
+
+         if (status != Status::Ok) { return status; }
+         pos += 2 + size;
+         }
+
+      return Status::Ok;
+      }
+
+   BCSerialCommand::Status BCSerialCommand::callCommits(Phase phase, uint8_t mask, uint8_t& done)
+      {
+      Status result = Status::Ok;
+      for (uint8_t i = 0; i < handlerCount; i++)
+         {
+         if (((mask & (1U << i)) == 0) || ((done & (1U << i)) != 0)) { continue; }
+
+         Status status = (commits[i] != nullptr) ? commits[i](phase) : Status::Ok;
+         if (status != Status::Ok)
+            {
+            if (result == Status::Ok) { result = status; }
+            if (phase != Phase::Rollback) { break; }
+            continue;
+            }
+
+         // Done for every handler in the mask sharing the commit handler, it is called once.
+         for (uint8_t j = i; j < handlerCount; j++)
+            {
+            if (((mask & (1U << j)) != 0) && (commits[j] == commits[i])) { done |= (1U << j); }
+            }
+         }
+
+      return result;
+      }
+
+   BCSerialCommand::Status BCSerialCommand::builtInCommand(Command command, const uint8_t* data, uint8_t length, Phase phase)
+      {
+      bool apply = (phase == Phase::Apply);
+      switch (command)
+         {
+         case Command::Ping:
+         case Command::Status:
+            return (length == 0) ? Status::Ok : Status::BadLength;
+
+         case Command::Time:
+            {
+            if (length != 4) { return Status::BadLength; }
+            DateTime time(readU32(data));
+            if (!time.isValid()) { return Status::BadValue; }
+            if (apply) { clock.set_Time(time); }
+            return Status::Ok;
+            }
+
+         case Command::Alarm:
+            {
+            // number, hour, minute, day, repeat, status, melody
+            if (length != 7) { return Status::BadLength; }
+            if ((data[0] < ALARM_1) || (data[0] > ALARM_2) || (data[1] > 23) || (data[2] > 59) || (data[3] > 31)
+                  || (data[4] >= (uint8_t)AlarmTime::endTag) || (data[5] > 1) || (data[6] >= clock.get_MelodyCount()))
+               { return Status::BadValue; }
+
+            if (apply)
+               {
+               uint8_t day = (data[3] == 0) ? 1 : data[3];
+               AlarmTime alarm(DateTime(DateTime::WeekdayEpoch.year(), DateTime::WeekdayEpoch.month(), day, data[1], data[2], 0)
+                             , (AlarmTime::Repeat)data[4]);
+               alarm.number = data[0];
+               alarm.status = data[5];
+               alarm.melody = data[6];
+               clock.set_Alarm(alarm);
+               }
+            return Status::Ok;
+            }
+
+         case Command::HourMode:
+            if (length != 1) { return Status::BadLength; }
+            if (data[0] > 1) { return Status::BadValue; }
+            if (apply) { clock.set_Is12HourFormat(data[0] == 1); }
+            return Status::Ok;
+
+         case Command::Brightness:
+            if (length != 1) { return Status::BadLength; }
+            if (apply) { clock.set_Brightness(data[0]); }
+            return Status::Ok;
+
+         case Command::OnColors:
+         case Command::OffColors:
+            {
+            if (length != (NUM_LEDS * 3)) { return Status::BadLength; }
+            if (apply)
+               {
+               fl::array<CRGB, NUM_LEDS> colors;
+               for (size_t i = 0; i < NUM_LEDS; i++)
+                  { colors[i] = CRGB(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]); }
+
+               if (command == Command::OnColors) { clock.set_OnColors(colors);  }
+               else                              { clock.set_OffColors(colors); }
+               }
+            return Status::Ok;
+            }
+
+         case Command::AmPmColors:
+            if (length != 6) { return Status::BadLength; }
+            if (apply)
+               {
+               clock.set_AmColor(CRGB(data[0], data[1], data[2]));
+               clock.set_PmColor(CRGB(data[3], data[4], data[5]));
+               }
+            return Status::Ok;
+
+         case Command::Melody:
+            if (length != 1) { return Status::BadLength; }
+            if (data[0] >= clock.get_MelodyCount()) { return Status::BadValue; }
+            if (apply) { clock.set_Melody(data[0]); }
+            return Status::Ok;
+
+         case Command::MelodyNotes:
+            {
+            if ((length == 0) || ((length % 4) != 0)) { return Status::BadLength; }
+            if (!apply && clock.get_IsMelodyPlaying()) { return Status::Busy; }   // Not while the alarm sounds.
+            if (apply)
+               {
+               // The registry holds a reference to `melody`, the same vector for every upload: the
+               // notes are built aside and swapped in under the player's lock.
+               std::vector<Note> notes;
+               notes.reserve(length / 4);
+               for (uint8_t i = 0; i < length; i += 4)
+                  { notes.push_back({ readU16(data + i), (unsigned long)readU16(data + i + 2) }); }
+
+               if (melodyId < 0)
+                  {
+                  melody.swap(notes);
+                  melodyId = (int)clock.RegisterMelody(melody);
+                  }
+               else
+                  { clock.ReplaceMelody(melody, notes); }
+               clock.set_Melody((size_t)melodyId);
+               }
+            return Status::Ok;
+            }
+
+         default:
+            return Status::UnknownCommand;
+         }
+      }
+
+   int BCSerialCommand::findHandler(uint8_t command) const
+      {
+      for (uint8_t i = 0; i < handlerCount; i++)
+         {
+         if (handlerCommands[i] == command) { return i; }
+         }
+
+      return -1;
+      }
+
+   void BCSerialCommand::fillStatus(StatusBlock& status)
+      {
+      AlarmTime alarm = clock.get_Alarm();
+      status.time        = clock.get_Time().unixtime();
+      status.alarmHour   = alarm.time.hour();
+      status.alarmMinute = alarm.time.minute();
+      status.alarmStatus = alarm.status;
+      status.alarmRepeat = (uint8_t)alarm.freq;
+      status.flags       = (clock.get_Is12HourFormat() ? 0x01 : 0x00)
+                         | ((clock.get_SettingsState() != SettingsState::Inactive) ? 0x02 : 0x00)
+                         | (alarm.fired ? 0x04 : 0x00);
+      status.brightness  = clock.get_Brightness();
+      status.melody      = (uint8_t)clock.get_Melody();
+      status.melodyCount = (uint8_t)clock.get_MelodyCount();
+      status.frames      = frameCount;
+      status.errors      = errorCount;
+      }
+
+   void BCSerialCommand::sendReply(uint8_t sequence, Status status, uint8_t index, bool addStatus)
+      {
+      // version, sequence, status, index, [status block], CRC
+      uint8_t reply[4 + sizeof(StatusBlock) + 2];
+      size_t length = 0;
+      reply[length++] = BCCMD_VERSION;
+      reply[length++] = sequence;
+      reply[length++] = (uint8_t)status;
+      reply[length++] = index;
+      if (addStatus)
+         {
+         StatusBlock block;
+         fillStatus(block);
+         memcpy(reply + length, &block, sizeof(block));
+         length += sizeof(block);
+         }
+
+      uint16_t crc = Crc16(reply, length);
+      reply[length++] = (uint8_t)(crc & 0xFF);
+      reply[length++] = (uint8_t)(crc >> 8);
+
+      // Delimiters on both sides so the host can find the reply among the text output.
+      uint8_t encoded[sizeof(reply) + 4];
+      encoded[0] = 0x00;
+      size_t size = 1 + CobsEncode(reply, length, encoded + 1);
+      encoded[size++] = 0x00;
+
+      #if SERIAL_ASYNC_LOG
+      SerialLogger::get_Instance().Push(reinterpret_cast<const char*>(encoded), size);
+      #else
+      Serial.write(encoded, size);
+      #endif
+      }
+   } // namespace BinaryClockShield
+
+#endif // SERIAL_COMMAND_CODE
@@ -0,0 +1,259 @@
+/// @file BCSerialCommand.h
+/// @brief This file contains the declaration of the `BCSerialCommand` class, the binary serial command protocol.
+/// @details The `BCSerialCommand` class reads framed binary commands from the serial port to configure
+///          the clock in bulk, e.g. to provision a rack of clocks from the host tool `test/bc_provision.py`.
+///          All the settings in one request frame are applied together or not at all and the reply is
+///          a single compact status frame.
+/// @par Frame format:
+/// @verbatim
+///   0x00 | COBS( version | sequence | body ... | CRC-16 (LE) ) | 0x00
+///   COBS     : Consistent Overhead Byte Stuffing, the encoded frame never contains 0x00.
+///   version  : BCCMD_VERSION, a frame with a different version is rejected.
+///   sequence : Any value chosen by the host, it is returned in the reply.
+///   CRC-16   : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of the version, sequence and body.
+///
+///   Request body : One or more records: command (u8) | length (u8) | data[length]
+///   Reply body   : status (u8) | record index (u8) | [ status block when requested ]
+/// @endverbatim
+/// @par Commands:
+/// @verbatim
+///   0x01 Ping           : (none)
+///   0x02 Status         : (none), adds the status block to the reply (see `StatusBlock`).
+///   0x10 Time           : unixtime (u32 LE), local time.
+///   0x11 Alarm          : number, hour, minute, day, repeat, status, melody (7 x u8)
+///   0x12 Hour mode      : 0 - 24 hour; 1 - 12 hour
+///   0x13 Brightness     : 0 - 255
+///   0x14 On colors      : NUM_LEDS x RGB
+///   0x15 Off colors     : NUM_LEDS x RGB
+///   0x16 AM/PM colors   : AM RGB | PM RGB
+///   0x17 Melody select  : registry id (u8)
+///   0x18 Melody notes   : (tone (u16 LE) | duration ms (u16 LE)) x N, registered and selected.
+///   0x40 - 0x5F         : Reserved for the handlers added with `RegisterCommand()`, e.g. WiFi credentials.
+/// @endverbatim
+/// @remarks The text characters received outside of a frame are passed to the text handler (e.g. the
+///          `BCMenu` log level command). The host sends a `0x00` before the frame to mark the start.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_SERIALCOMMAND_H__
+#define __BC_SERIALCOMMAND_H__
+
+#include <Arduino.h>             /// Arduino core library. This needs to be the first include file.
+#include <BinaryClock.Defines.h> /// BinaryClock project-wide definitions and MACROs.
+#include <BinaryClock.Structs.h> /// Global structures and enums used by the Binary Clock project.
+
+#if SERIAL_COMMAND_CODE
+#include <vector>
+
+#define BCCMD_VERSION              1U  ///< The protocol version, the first byte of every frame.
+#ifndef BCCMD_FRAME_SIZE
+   #define BCCMD_FRAME_SIZE      600U  ///< The largest encoded frame, room for the colors, a melody and a few WiFi credentials.
+#endif
+#define BCCMD_MAX_HANDLERS         8U  ///< The maximum number of commands added with `RegisterCommand()`.
+#define BCCMD_FRAME_TIMEOUT      500U  ///< Time (ms) without data before a partial frame is discarded.
+#define BCCMD_USER_FIRST        0x40U  ///< The first command number for the `RegisterCommand()` handlers.
+#define BCCMD_USER_LAST         0x5FU  ///< The last command number for the `RegisterCommand()` handlers.
+
+namespace BinaryClockShield
+   {
+   class BinaryClock;
+
+   /// @brief Handles the binary serial command protocol for the Binary Clock.
+   /// @details The class is called from `BinaryClock::loop()`. The received bytes are collected
+   ///          until the frame delimiter and then decoded, validated and applied. A frame is
+   ///          applied whole or not at all:
+   ///          - every record is validated first, nothing is changed unless all are valid;
+   ///          - the commit handlers of the handler records get `Begin` (e.g. a checkpoint), the
+   ///            handler records are applied, then each commit handler gets `Commit` once (e.g.
+   ///            a single NVS save shared by the WiFi credentials and the timezone);
+   ///          - if a record or a commit fails, the commit handlers not committed get `Rollback`
+   ///            and the built-in records aren't applied;
+   ///          - the built-in records are applied last, once validated they can't fail.
+   ///          The compact reply has the status and the index of the record that failed.
+   /// @author Chris-70 (2026/10)
+   class BCSerialCommand
+      {
+   public:
+      /// @brief The command numbers for the built-in commands. Type: uint8_t
+      enum class Command : uint8_t
+         {
+         Ping        = 0x01,   ///< No data, replies with the status.
+         Status      = 0x02,   ///< No data, adds the status block to the reply.
+         Time        = 0x10,   ///< Set the time.
+         Alarm       = 0x11,   ///< Set an alarm.
+         HourMode    = 0x12,   ///< Set the 12/24 hour mode.
+         Brightness  = 0x13,   ///< Set the LED brightness.
+         OnColors    = 0x14,   ///< Set the LED colors when ON.
+         OffColors   = 0x15,   ///< Set the LED colors when OFF.
+         AmPmColors  = 0x16,   ///< Set the AM and PM indicator colors.
+         Melody      = 0x17,   ///< Select a registered melody.
+         MelodyNotes = 0x18    ///< Upload, register and select a melody.
+         };
+
+      /// @brief The status returned in the reply and from the command handlers. Type: uint8_t
+      enum class Status : uint8_t
+         {
+         Ok = 0,           ///< All records were applied.
+         BadFrame,         ///< The frame failed the COBS decode, CRC or length checks.
+         BadVersion,       ///< The protocol version isn't supported.
+         UnknownCommand,   ///< The record command isn't known.
+         BadLength,        ///< The record data length is wrong for the command.
+         BadValue,         ///< A value in the record is out of range.
+         Busy,             ///< The settings menu is in use (or a melody plays for an upload), nothing was applied.
+         Failed            ///< The record was valid but it couldn't be applied or committed.
+         };
+
+      /// @brief The processing phase passed to the command handlers. Type: uint8_t
+      enum class Phase : uint8_t
+         {
+         Validate,         ///< Check the record only, nothing is changed.
+         Begin,            ///< Commit handler: before the first record is applied, e.g. keep a checkpoint.
+         Apply,            ///< Apply the record, all the records were validated.
+         Commit,           ///< Commit handler: once after all the records were applied, e.g. save to NVS.
+         Rollback          ///< Commit handler: a record or a commit failed, undo the records applied.
+         };
+
+      /// @brief The command handler function added with `RegisterCommand()`.
+      /// @param phase The processing phase, `Validate` or `Apply`.
+      /// @param data The record data.
+      /// @param length The number of bytes in `data`.
+      /// @return `Status::Ok` on success, otherwise the error status.
+      typedef Status (*CommandHandler)(Phase phase, const uint8_t* data, uint8_t length);
+
+      /// @brief The commit handler function added with `RegisterCommand()`, shared by the commands
+      ///        that change the same store so it is saved once per frame.
+      /// @param phase The processing phase, `Begin`, `Commit` or `Rollback`.
+      /// @return `Status::Ok` on success, otherwise the error status (ignored for `Rollback`).
+      typedef Status (*CommitHandler)(Phase phase);
+
+      /// @brief The compact status block added to the reply by the `Status` command (16 bytes, LE).
+      struct __attribute__((packed)) StatusBlock
+         {
+         uint32_t time;          ///< The current time, unixtime.
+         uint8_t  alarmHour;     ///< The alarm hour (0 - 23).
+         uint8_t  alarmMinute;   ///< The alarm minute (0 - 59).
+         uint8_t  alarmStatus;   ///< The alarm status: 0 - OFF; 1 - ON.
+         uint8_t  alarmRepeat;   ///< The alarm repeat frequency, `AlarmTime::Repeat`.
+         uint8_t  flags;         ///< Bit 0: 12 hour mode; Bit 1: settings menu in use; Bit 2: alarm ringing.
+         uint8_t  brightness;    ///< The LED brightness.
+         uint8_t  melody;        ///< The selected melody id.
+         uint8_t  melodyCount;   ///< The number of registered melodies.
+         uint16_t frames;        ///< The number of valid frames received.
+         uint16_t errors;        ///< The number of frames rejected.
+         };
+
+      /// @brief Constructor, the clock is the target of the built-in commands.
+      /// @param clock The `BinaryClock` instance.
+      BCSerialCommand(BinaryClock& clock);
+
+      /// @brief Read the available serial data and process any complete frame.
+      /// @details Call this method from the main loop. It never waits for data.
+      /// @author Chris-70 (2026/10)
+      void Process();
+
+      /// @brief Add a handler for a command in the range `BCCMD_USER_FIRST` - `BCCMD_USER_LAST`.
+      /// @details This is used by the libraries the `BinaryClock` library can't depend on,
+      ///          e.g. the application adds the WiFi credentials command from `BinaryClockWiFi`.
+      /// @param command The command number.
+      /// @param handler The handler function.
+      /// @param commit The commit handler, `nullptr` if the records need no commit or rollback.
+      ///               Commands that change the same store register the same commit handler.
+      /// @return True if the handler was added (or replaced), false if the command is out of
+      ///         range or there are already `BCCMD_MAX_HANDLERS` handlers.
+      /// @author Chris-70 (2026/10)
+      bool RegisterCommand(uint8_t command, CommandHandler handler, CommitHandler commit = nullptr);
+
+      /// @brief Property pattern for the 'TextHandler' property: The function called with each
+      ///        character received outside of a command frame.
+      /// @param value The function to call, `nullptr` to ignore the text.
+      /// @see get_TextHandler()
+      /// @author Chris-70 (2026/10)
+      void set_TextHandler(void (*value)(int ch))
+         { textHandler = value; }
+      /// @copydoc set_TextHandler()
+      /// @see set_TextHandler()
+      void (*get_TextHandler() const)(int ch)
+         { return textHandler; }
+
+      /// @brief Read only property: The number of valid frames received.
+      uint16_t get_FrameCount() const { return frameCount; }
+
+      /// @brief Read only property: The number of frames rejected (COBS, CRC, length or version).
+      uint16_t get_ErrorCount() const { return errorCount; }
+
+      /// @brief Encode the data with COBS. The output is never more than `length + length / 254 + 1` bytes.
+      /// @param data The data to encode.
+      /// @param length The number of bytes to encode.
+      /// @param output The buffer for the encoded data.
+      /// @return The number of bytes in `output`.
+      static size_t CobsEncode(const uint8_t* data, size_t length, uint8_t* output);
+
+      /// @brief Decode the COBS data in place.
+      /// @param data The encoded data, without the `0x00` delimiter, replaced by the decoded data.
+      /// @param length The number of encoded bytes.
+      /// @return The number of decoded bytes, or 0 if the data isn't valid.
+      static size_t CobsDecode(uint8_t* data, size_t length);
+
+      /// @brief The CRC-16/CCITT-FALSE of the data (poly 0x1021, init 0xFFFF).
+      static uint16_t Crc16(const uint8_t* data, size_t length);
+
+   protected:
+      /// @brief Decode, validate and apply the frame in `frame`, then send the reply.
+      void processFrame();
+
+      /// @brief Validate or apply the records in the body.
+      /// @param body The first record.
+      /// @param length The number of bytes in the records.
+      /// @param phase `Validate` (all the records) or `Apply`.
+      /// @param builtIn For `Apply`: true to apply the built-in records, false the handler records.
+      /// @param index Returns the index of the record that failed.
+      /// @return `Status::Ok` if all the records passed, otherwise the status of the failed record.
+      Status processRecords(const uint8_t* body, size_t length, Phase phase, bool builtIn, uint8_t& index);
+
+      /// @brief Call the commit handlers of the handlers in `mask`, a shared commit handler once.
+      /// @param phase `Begin`, `Commit` or `Rollback`.
+      /// @param mask Bit flags: The handlers.
+      /// @param done Returns the bit flags of the handlers done, a handler without a commit
+      ///             handler is always done.
+      /// @return `Status::Ok`, otherwise the status of the commit handler that failed; `Begin` and
+      ///         `Commit` stop at the first failure, `Rollback` calls them all.
+      Status callCommits(Phase phase, uint8_t mask, uint8_t& done);
+
+      /// @brief Validate or apply one built-in record.
+      Status builtInCommand(Command command, const uint8_t* data, uint8_t length, Phase phase);
+
+      /// @brief Get the handler index for the command, -1 if the command has no handler.
+      int findHandler(uint8_t command) const;
+
+      /// @brief Build the status block from the current clock settings.
+      void fillStatus(StatusBlock& status);
+
+      /// @brief Encode and send the reply frame.
+      void sendReply(uint8_t sequence, Status status, uint8_t index, bool addStatus);
+
+   private:
+      BinaryClock& clock;                          ///< The clock the built-in commands apply to.
+      void (*textHandler)(int ch) = nullptr;       ///< Called with the text received outside of a frame.
+
+      uint8_t frame[BCCMD_FRAME_SIZE];             ///< The frame being received, decoded in place.
+      size_t  frameLength = 0;                     ///< The number of bytes in `frame`.
+      bool    inFrame = false;                     ///< Flag: A `0x00` was received, collecting a frame.
+      bool    overflow = false;                    ///< Flag: The frame is too long, discard until the next `0x00`.
+      unsigned long lastByteTime = 0UL;            ///< millis() of the last byte received in a frame.
+
+      uint8_t  handlerCommands[BCCMD_MAX_HANDLERS] = { 0 };       ///< The command number of each handler.
+      CommandHandler handlers[BCCMD_MAX_HANDLERS]  = { nullptr }; ///< The handlers added with `RegisterCommand()`.
+      CommitHandler  commits[BCCMD_MAX_HANDLERS]   = { nullptr }; ///< The commit handler of each handler.
+      uint8_t  handlerCount = 0;                   ///< The number of handlers in use.
+      uint8_t  handlerUsed = 0;                    ///< Bit flags: The handler has a record in the frame.
+
+      std::vector<Note> melody;                    ///< The uploaded melody, it must outlive its registration.
+      int      melodyId = -1;                      ///< The registry id of the uploaded melody, -1 until registered.
+
+      uint16_t frameCount = 0;                     ///< The number of valid frames received.
+      uint16_t errorCount = 0;                     ///< The number of frames rejected.
+      }; // class BCSerialCommand
+   } // namespace BinaryClockShield
+
+#endif // SERIAL_COMMAND_CODE
+#endif // __BC_SERIALCOMMAND_H__
@@ -0,0 +1,80 @@
+/// @file BCTimeSlew.cpp
+/// @brief This file contains the implementation of the `BCTimeSlew` class, the gradual (slew)
+///        correction of the RTC time.
+/// @author Chris-70 (2026/10)
+
+#include "BCTimeSlew.h"
+
+namespace BinaryClockShield
+   {
+   bool BCTimeSlew::Start(int32_t offsetMs, uint32_t elapsedS)
+      {
+      int32_t magnitude = (offsetMs < 0) ? -offsetMs : offsetMs;
+      if (magnitude > BC_SLEW_MAX_MS)
+         {
+         remaining = 0;
+         return false;
+         }
+
+      // The drift is only known if the previous correction was completed, the offset is then
+      // the drift plus what was left uncorrected (too small to slew).
+      if ((elapsedS >= BC_AGING_MIN_S) && (remaining == 0))
+         {
+         driftPpb = (int32_t)((int64_t)(offsetMs - residual) * 1000000LL / (int64_t)elapsedS);   // ms/s => ppb
+         newDrift = true;
+         }
+
+      if (magnitude < BC_SLEW_MIN_MS)
+         {
+         remaining = 0;
+         residual = offsetMs;
+         }
+      else
+         {
+         remaining = offsetMs;
+         residual = 0;
+         }
+      return true;
+      }
+
+   int16_t BCTimeSlew::NextShift(bool blocked)
+      {
+      if ((remaining == 0) || blocked) { return 0; }
+
+      int32_t shift = remaining;
+      if (shift >  BC_SLEW_STEP_MS) { shift =  BC_SLEW_STEP_MS; }
+      if (shift < -BC_SLEW_STEP_MS) { shift = -BC_SLEW_STEP_MS; }
+      remaining -= shift;
+
+      return (int16_t)shift;
+      }
+
+   void BCTimeSlew::Undo(int16_t shift)
+      {
+      remaining += shift;
+
+      int32_t magnitude = (remaining < 0) ? -remaining : remaining;
+      if (magnitude < BC_SLEW_MIN_MS) 
+         { 
+         residual = remaining;
+         remaining = 0; 
+         }
+      }
+
+   int8_t BCTimeSlew::AgingOffset(int8_t current)
+      {
+      if (!newDrift) { return current; }
+      newDrift = false;
+
+      // The RTC is slow (drift > 0): lower the aging offset to speed up the oscillator. Round to the nearest LSB.
+      int32_t change = -((driftPpb >= 0) ? (driftPpb + BC_AGING_PPB / 2) : (driftPpb - BC_AGING_PPB / 2)) / BC_AGING_PPB;
+      if (change >  BC_AGING_STEP) { change =  BC_AGING_STEP; }
+      if (change < -BC_AGING_STEP) { change = -BC_AGING_STEP; }
+
+      int32_t value = (int32_t)current + change;
+      if (value >  127) { value =  127; }
+      if (value < -128) { value = -128; }
+
+      return (int8_t)value;
+      }
+   } // namespace BinaryClockShield
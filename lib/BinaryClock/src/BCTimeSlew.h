@@ -0,0 +1,117 @@
+/// @file BCTimeSlew.h
+/// @brief This file contains the declaration of the `BCTimeSlew` class, the gradual (slew) correction
+///        of the RTC time instead of a step.
+/// @details Stepping the RTC to the NTP time makes the display jump over, or repeat, seconds and an
+///          RTC alarm in a skipped second never fires. Small offsets are slewed instead: the DS3231
+///          resets its sub-second countdown when the seconds register is written, so the phase of
+///          the RTC second can be moved by writing it at a chosen point in the second:
+///          - gain `n` ms (RTC behind): write second S+1 `n` ms before the S+1 tick is due;
+///          - lose `n` ms (RTC ahead): write second S again `n` ms after its tick.
+///          Each second is shifted by at most `BC_SLEW_STEP_MS` (10%), so each second is still shown
+///          exactly once and lasts 0.9 to 1.1 seconds. No phase shift is made into or out of an alarm
+///          second, the alarm fires on the RTC's own tick, once. Offsets larger than `BC_SLEW_MAX_MS`
+///          are stepped as before.
+///          The offsets measured between corrections give the RTC drift, it is used to move the
+///          DS3231 aging offset register gradually (`AgingOffset()`), so the next offset is smaller.
+/// @note    The class only plans the corrections (integer ms) and has no Arduino dependencies so the
+///          same code is checked on the host with a virtual RTC (`test/host/test_time_slew.cpp`);
+///          `BinaryClock` does the timing and the RTC writes.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BC_TIMESLEW_H__
+#define __BC_TIMESLEW_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#ifndef BC_SLEW_STEP_MS
+   #define BC_SLEW_STEP_MS      100    ///< The maximum phase shift of one second in ms (10%).
+#endif
+#ifndef BC_SLEW_MAX_MS
+   #define BC_SLEW_MAX_MS     60000L   ///< Larger offsets (ms) are stepped, 60 s is slewed in 10 minutes.
+#endif
+#ifndef BC_SLEW_MIN_MS
+   #define BC_SLEW_MIN_MS        20    ///< Smaller offsets (ms) are ignored, about the write and tick latency.
+#endif
+#ifndef BC_AGING_PPB
+   #define BC_AGING_PPB         100    ///< The DS3231 aging offset LSB in ppb (~0.1 ppm at 25 C).
+#endif
+#ifndef BC_AGING_STEP
+   #define BC_AGING_STEP          2    ///< The maximum change of the aging offset at each correction.
+#endif
+#ifndef BC_AGING_MIN_S
+   #define BC_AGING_MIN_S     3600UL   ///< The minimum time between corrections (s) to measure the drift.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The gradual (slew) correction plan of the RTC time.
+   /// @author Chris-70 (2026/10)
+   class BCTimeSlew
+      {
+   public:
+      BCTimeSlew() = default;
+
+      /// @brief Start a correction of the RTC time.
+      /// @param offsetMs The offset to correct: correct time - RTC time, in ms.
+      /// @param elapsedS The time since the previous correction in seconds, `0` if unknown. Used
+      ///                 to measure the drift when the previous correction was completed.
+      /// @return True if the offset is slewed (or too small to correct); false if it is larger
+      ///         than `BC_SLEW_MAX_MS`, the caller steps the time.
+      /// @author Chris-70 (2026/10)
+      bool Start(int32_t offsetMs, uint32_t elapsedS = 0);
+
+      /// @brief Get the phase shift to make in the current second and remove it from the offset.
+      /// @param blocked True if the current or the next second is an alarm second, no shift is made.
+      /// @return The shift in ms: > 0 gain (write S+1 early); < 0 lose (write S late); 0 none.
+      /// @author Chris-70 (2026/10)
+      int16_t NextShift(bool blocked = false);
+
+      /// @brief Put back a shift from `NextShift()` that couldn't be made in time.
+      /// @details A remainder smaller than `BC_SLEW_MIN_MS` is dropped, it is within the latency.
+      /// @param shift The shift returned by `NextShift()`.
+      void Undo(int16_t shift);
+
+      /// @brief Get the time after the RTC tick (ms) to make a shift at: the current second written
+      ///        again `-shift` ms late (lose), or the next second `shift` ms early (gain).
+      /// @param shift The shift returned by `NextShift()`.
+      static uint16_t WriteAtMs(int16_t shift)
+         { return (uint16_t)((shift < 0) ? -shift : (1000 - shift)); }
+
+      /// @brief Get the second to write for a shift, relative to the current second: 0 lose, 1 gain.
+      ///        A gain has no RTC tick of its own, the caller dispatches the second written.
+      /// @param shift The shift returned by `NextShift()`.
+      static uint8_t WriteSecond(int16_t shift)
+         { return (shift > 0) ? 1 : 0; }
+
+      /// @brief Stop the correction, e.g. the time was stepped.
+      void Cancel() { remaining = 0; residual = 0; }
+
+      /// @brief Get the new DS3231 aging offset from the drift measured, moved gradually.
+      /// @details A positive aging offset slows the oscillator (~0.1 ppm per LSB). The change is
+      ///          limited to `BC_AGING_STEP` per correction, as the drift is measured again (with the
+      ///          new aging offset) at the next correction this converges without overshooting on a
+      ///          noisy measurement. Each drift measurement is only used once.
+      /// @param current The current aging offset register value.
+      /// @return The new aging offset, `current` if no new drift has been measured.
+      /// @author Chris-70 (2026/10)
+      int8_t AgingOffset(int8_t current);
+
+      /// @brief Read only property: Flag: a correction is in progress.
+      bool get_IsSlewing() const { return (remaining != 0); }
+
+      /// @brief Read only property: The offset (ms) still to correct, > 0 the RTC is behind.
+      int32_t get_Remaining() const { return remaining; }
+
+      /// @brief Read only property: The RTC drift measured at the last correction in ppb, > 0 the RTC is slow.
+      int32_t get_DriftPpb() const { return driftPpb; }
+
+   private:
+      int32_t remaining = 0;           ///< The offset still to correct in ms.
+      int32_t residual = 0;            ///< The offset left uncorrected (< `BC_SLEW_MIN_MS`) in ms.
+      int32_t driftPpb = 0;            ///< The RTC drift measured at the last correction in ppb.
+      bool    newDrift = false;        ///< Flag: `driftPpb` hasn't been used by `AgingOffset()` yet.
+      }; // class BCTimeSlew
+   } // namespace BinaryClockShield
+
+#endif // __BC_TIMESLEW_H__
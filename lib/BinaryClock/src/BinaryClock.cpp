@@ -178,6 +178,11 @@
 
 #include <assert.h>                 // Catch code logic errors during development.
 
+#if CRON_ALARM_NVS
+   #include <Preferences.h>         // ESP32 NVS storage of the cron rules, restored after a reboot.
+   #define CRON_NVS_NAMESPACE "bc_cron" ///< The NVS namespace of the cron rules, keys "alarm1" and "alarm2".
+#endif
+
 // // External EventGroup handle for FreeRTOS task synchronization
 // extern EventGroupHandle_t taskEventGroup;
 // #define SPLASH_COMPLETE_BIT  (1 << 0)
@@ -193,6 +198,32 @@ namespace BinaryClockShield
    static bool rtcMutexInitialized = false;
    #endif // FREE_RTOS
 
+   #if STL_USED
+      #if FREE_RTOS
+      // A registered melody is replaced (`ReplaceMelody()`, e.g. a serial upload) from the loop while
+      // it may be playing on another task: the player holds the mutex for the whole melody.
+      static SemaphoreHandle_t melodyMutex = nullptr;
+      #define MELODY_LOCK()    if (melodyMutex != nullptr) { xSemaphoreTake(melodyMutex, portMAX_DELAY); }
+      #define MELODY_UNLOCK()  if (melodyMutex != nullptr) { xSemaphoreGive(melodyMutex); }
+      #else
+      #define MELODY_LOCK()
+      #define MELODY_UNLOCK()
+      #endif
+   #endif // STL_USED
+
+   #if EVENT_ENGINE_CODE
+      #if FREE_RTOS && defined(ARDUINO_ARCH_ESP32)
+      // The event heap is changed by the time task (`TimeDispatch()`) and the user (e.g. `StartTimer()`),
+      // the operations are short and never block so a critical section is used, not a mutex.
+      static portMUX_TYPE eventMux = portMUX_INITIALIZER_UNLOCKED;
+      #define EVENT_LOCK()    taskENTER_CRITICAL(&eventMux);
+      #define EVENT_UNLOCK()  taskEXIT_CRITICAL(&eventMux);
+      #else
+      #define EVENT_LOCK()
+      #define EVENT_UNLOCK()
+      #endif
+   #endif // EVENT_ENGINE_CODE
+
    /// @brief Combined melody and duration notes for the alarm sound.
    /// @remarks See the links for details on creating your own melody using tone():
    /// @par  (http://www.arduino.cc/en/Tutorial/Tone)
@@ -551,6 +582,10 @@ namespace BinaryClockShield
       Serial.begin(DEFAULT_SERIAL_SPEED);
       delay(10);
       #endif
+      #if SERIAL_ASYNC_LOG
+      // From here on the SERIAL_* output is queued and written by a low priority task.
+      SerialLogger::get_Instance().Begin();
+      #endif
 
       pinMode(HeartbeatLED, OUTPUT);
       digitalWrite(HeartbeatLED, LOW);
@@ -561,7 +596,7 @@ namespace BinaryClockShield
       if (s2Pressed)       // User override check, display all the LED test patterns on the shield.
          { testLeds = true; }
 
-      SERIAL_STREAM("Display LED test patterns on the shield: " << (testLeds? "YES" : "NO") << "; S2 Button was: " 
+      LOG_DISPLAY_DEBUG("Display LED test patterns on the shield: " << (testLeds? "YES" : "NO") << "; S2 Button was: " 
              << (s2Pressed? "Pressed" : "OFF") << "; Value: " << buttonS2.get_Value() << " OnValue: is: " 
              << buttonS2.get_OnValue() << endl)   // *** DEBUG ***
 
@@ -573,6 +608,10 @@ namespace BinaryClockShield
       if (SetupRTC())
          {
          menu.Begin();
+         #if SERIAL_COMMAND_CODE && SERIAL_SETUP_CODE && SERIAL_LOG_CEILING_CODE
+         // The command protocol reads the serial port, pass the text to the menu.
+         command.set_TextHandler([](int ch) { BinaryClock::get_Instance().menu.SerialInput(ch); });
+         #endif
 
          testLeds = testLeds || RTC.lostPower();
          SetupFastLED(testLeds | true);   // *** DEBUG *** " | true"
@@ -617,6 +656,10 @@ namespace BinaryClockShield
          }
 
       set_CallbackTaskHandle(callbackHandle);
+
+      #if TIME_SLEW_CODE
+      slewTimer = xTimerCreate("SlewTimer", pdMS_TO_TICKS(100), pdFALSE, this, slewTimerCallback);
+      #endif
       #endif // FREE_RTOS
 
       isAmBlack = (AmColor == CRGB::Black);
@@ -625,7 +668,7 @@ namespace BinaryClockShield
 
       delay(150); // Wait to stabilize after setup
 
-      SERIAL_STREAM("Time: " << time.timestamp(get_Is12HourFormat() ? DateTime::TIMESTAMP_TIME12 : DateTime::TIMESTAMP_TIME)
+      LOG_DISPLAY_DEBUG("Time: " << time.timestamp(get_Is12HourFormat() ? DateTime::TIMESTAMP_TIME12 : DateTime::TIMESTAMP_TIME)
             << endl << "Date:  " << time.timestamp(DateTime::TIMESTAMP_DATE) << " (" << weekdays[(time.dayOfTheWeek() + time.dayNameOffset()) % 7] 
             << ")" << endl)   // *** DEBUG ***
       } // setup()
@@ -636,6 +679,9 @@ namespace BinaryClockShield
 
    void BinaryClock::loop()
       {
+      #if SERIAL_COMMAND_CODE
+      command.Process();
+      #endif
       SettingsState settingsState = menu.ProcessMenu();
 
       #if FREE_RTOS
@@ -655,7 +701,11 @@ namespace BinaryClockShield
          // Only display time when not in menu
          if (settingsState == SettingsState::Inactive)
             {
+            #if TIME_SLEW_CODE
+            DisplayBinaryTime(time.hour(), time.minute(), (showLeap ? 60 : time.second()), get_Is12HourFormat());
+            #else
             DisplayBinaryTime(time.hour(), time.minute(), time.second(), get_Is12HourFormat());
+            #endif
             SERIAL_TIME()
 
             // Check if the alarm has gone off
@@ -664,6 +714,21 @@ namespace BinaryClockShield
                PlayAlarm();
                Alarm2.fired = false;
                }
+
+            #if EVENT_ENGINE_CODE
+            if (eventFired)
+               {
+               EVENT_LOCK()
+               ClockEvent event = firedEvent;
+               eventFired = false;
+               EVENT_UNLOCK()
+
+               if (event.pattern != BCEVENT_NO_PATTERN)
+                  { DisplayLedPattern(static_cast<LedPattern>(event.pattern), 2000UL); }
+               if (event.repeat > 0)
+                  { PlayMelody(GetMelodyById(event.melody), event.repeat); }
+               }
+            #endif
             }
 
          #if FREE_RTOS
@@ -700,6 +765,9 @@ namespace BinaryClockShield
          , buttonDebugTime(DEBUG_TIME_PIN, CA_ON)
          #endif
          , menu(*this)
+         #if SERIAL_COMMAND_CODE
+         , command(*this)
+         #endif
          , idName(IBINARYCLOCK_IDNAME)
       {
       #if STL_USED   // For boards with enough memory to include Standard Template Libraries.
@@ -755,9 +823,12 @@ namespace BinaryClockShield
          rtcMutexInitialized = true;
          if (rtcMutexStatic == nullptr)
             {
-            SERIAL_PRINTLN("ERROR: Failed to create RTC mutex!")
+            LOG_RTC_ERROR("ERROR: Failed to create RTC mutex!" << endl)
             }
          }
+      #if STL_USED
+      if (melodyMutex == nullptr) { melodyMutex = xSemaphoreCreateMutex(); }
+      #endif
       #endif
 
       // Initialize the serial output properties to follow this initial value.
@@ -817,6 +888,12 @@ namespace BinaryClockShield
       // Note: Static RTC mutex is NOT deleted here - it's shared across the singleton instance
       // and is kept for the lifetime of the program
 
+      #if TIME_SLEW_CODE
+      if (slewTimer != nullptr) { xTimerDelete(slewTimer, 0); }
+      slewTimer = nullptr;
+      slewShift = 0;
+      #endif
+
       // Delete the created tasks
       vTaskDelete(get_TimeDispatchHandle());
       vTaskDelete(get_CallbackTaskHandle());
@@ -854,7 +931,7 @@ namespace BinaryClockShield
          time = ReadTime();
          }
 
-      SERIAL_STREAM((rtcValid? "Time from RTC: " : "RTC not valid, internal time: ") << time.timestamp(get_Is12HourFormat()? DateTime::TIMESTAMP_TIME12 : DateTime::TIMESTAMP_TIME) 
+      LOG_RTC_DEBUG((rtcValid? "Time from RTC: " : "RTC not valid, internal time: ") << time.timestamp(get_Is12HourFormat()? DateTime::TIMESTAMP_TIME12 : DateTime::TIMESTAMP_TIME) 
             << " internal date: " << time.timestamp(DateTime::TIMESTAMP_DATE) << endl)   // *** DEBUG ***
 
       return rtcValid;
@@ -923,12 +1000,26 @@ namespace BinaryClockShield
                { break; }
             }
 
+         // The table row is the `Repeat` value. The hour match is `Daily`, a one shot (`Never`) alarm
+         // isn't known after a reboot. The date match is `Monthly` unless the alarm has a cron rule
+         // saved, then it is the one shot match of the rule and the rule is restored.
+         auto repeatOf = [this](int index, uint8_t number)
+               {
+               if (index == (int)AlarmTime::Repeat::Never) { return AlarmTime::Repeat::Daily; }
+               #if CRON_ALARM_NVS
+               if ((index == (int)AlarmTime::Repeat::Monthly) && loadCronRule(number)) { return AlarmTime::Repeat::Never; }
+               #else
+               (void)number;
+               #endif
+               return (AlarmTime::Repeat)index;
+               };
+
          #ifndef UNO_R3
          if (index1 >= 0 && index1 < (int)(AlarmTime::Repeat::endTag))
-            { Alarm1.freq = (AlarmTime::Repeat)(repeatModeTable[index1][0]); }
+            { Alarm1.freq = repeatOf(index1, ALARM_1); }
          #endif
          if (index2 >= 0 && index2 < (int)(AlarmTime::Repeat::endTag))
-            { Alarm2.freq = (AlarmTime::Repeat)(repeatModeTable[index2][1]); }
+            { Alarm2.freq = repeatOf(index2, ALARM_2); }
 
          #ifndef UNO_R3
          RTC.disableAlarm(Alarm1.number); // Disable alarm 1, not yet supported.
@@ -978,12 +1069,12 @@ namespace BinaryClockShield
          Alarm2.fired = (status & DS3231_ALARM2_FLAG_MASK) ? (Alarm2.status == 1) && (alarm2inrange) : false; // Alarm 'ringing'
 
          #ifndef UNO_R3
-         SERIAL_STREAM("Alarm1: " <<  Alarm1.time.timestamp(DateTime::TIMESTAMP_TIME) << " (" << alarm1time.timestamp(DateTime::TIMESTAMP_TIME) << 
+         LOG_RTC_DEBUG("Alarm1: " <<  Alarm1.time.timestamp(DateTime::TIMESTAMP_TIME) << " (" << alarm1time.timestamp(DateTime::TIMESTAMP_TIME) << 
                (Alarm1.time.isValid() ? " Valid) " : " Bad Time) ") << (Alarm1.status > 0 ? " ON; " : " OFF; ") << alarm1delta <<
                (alarm1inrange ? " In Range; " : " Continue; ") << (Alarm1.fired ? " Alarm Fired " : " No Alarm ") << endl)   // *** DEBUG ***
          #endif
 
-         SERIAL_STREAM("Alarm2: " << Alarm2.time.timestamp(DateTime::TIMESTAMP_TIME) << " (" << alarm2time.timestamp(DateTime::TIMESTAMP_TIME) <<
+         LOG_RTC_DEBUG("Alarm2: " << Alarm2.time.timestamp(DateTime::TIMESTAMP_TIME) << " (" << alarm2time.timestamp(DateTime::TIMESTAMP_TIME) <<
                (Alarm2.time.isValid() ? " Valid) " : " Bad Time) ") << (Alarm2.status > 0 ? " ON; " : " OFF; ") << alarm2delta <<
                (alarm2inrange? " In Range; " : " Continue; ") << (Alarm2.fired? " Alarm Fired " : " No Alarm ") << endl)   // *** DEBUG ***
 
@@ -1085,11 +1176,11 @@ namespace BinaryClockShield
 
       if (taskCreated)
          {
-         SERIAL_STREAM("[" << millis() << "] Splash screen task created successfully" << endl)
+         LOG_DISPLAY_INFO("[" << millis() << "] Splash screen task created successfully" << endl)
          }
       else
          {
-         SERIAL_PRINTLN("ERROR: Failed to create splash screen task!")
+         LOG_DISPLAY_ERROR("ERROR: Failed to create splash screen task!" << endl)
          // Fall back to direct execution with a limited screen display.
          splashScreen(false);
          }
@@ -1137,6 +1228,12 @@ namespace BinaryClockShield
    void BinaryClock::RTCinterrupt()
       {
       set_RTCinterruptWasCalled(true);
+      #if TIME_SLEW_CODE
+      tickMicros = micros();
+      #endif
+      #if METRICS_CODE
+      isrTicks++;
+      #endif
 
       #if FREE_RTOS
       BaseType_t xHigherPriorityTaskWoken = pdFALSE;
@@ -1163,7 +1260,7 @@ namespace BinaryClockShield
       // RTC has. Caller can check for errors by comparing given `value` to get_Time().
       if (rtcValid && value.isTimeValid())
          {
-         SERIAL_STREAM(">>> Set time to: " << value.timestamp(timestampFormat) << "; from: " << time.timestamp(timestampFormat) << endl)   // *** DEBUG ***
+         LOG_RTC_DEBUG(">>> Set time to: " << value.timestamp(timestampFormat) << "; from: " << time.timestamp(timestampFormat) << endl)   // *** DEBUG ***
 
          // If the year is 2000, set it to 2001 so that the DayOfWeek() calculation works correctly
          // This would indicate that only the time was being set.
@@ -1173,22 +1270,261 @@ namespace BinaryClockShield
          time = ReadTime();
          if (time != value)
             { 
+            #if EVENT_ENGINE_CODE
+            DateTime before = time;
+            #endif
+            #if TIME_SLEW_CODE
+            cancelSlew();        // A step replaces any correction in progress.
+            leapSecond.Stepped();
+            #endif
             RTC.adjust(value, get_Is12HourFormat()); 
             time = ReadTime();
-            SERIAL_STREAM(">>> RTC time adjusted to: " << time.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl)   // *** DEBUG ***
+            #if EVENT_ENGINE_CODE
+            EVENT_LOCK()
+            events.TimeChanged(before.unixtime(), time.unixtime());
+            EVENT_UNLOCK()
+            #endif
+            #if CRON_ALARM_CODE
+            for (uint8_t number = ALARM_1; number <= ALARM_2; number++)
+               {
+               if (cronRule[number - 1].get_IsValid()) { programCronAlarm(number); }
+               }
+            #endif
+            LOG_RTC_DEBUG(">>> RTC time adjusted to: " << time.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl)   // *** DEBUG ***
             }
          else
-            { SERIAL_STREAM("     RTC has the same time: " << time.timestamp(timestampFormat) << ". Nothing to do." << endl) }  // *** DEBUG ***
+            { LOG_RTC_DEBUG("     RTC has the same time: " << time.timestamp(timestampFormat) << ". Nothing to do." << endl) }  // *** DEBUG ***
          }
       else
-         { SERIAL_STREAM("*** Invalid RTC / time. RTC Valid? " << (rtcValid ? "True, " : "False, ") << value.timestamp(timestampFormat) << endl) } // *** DEBUG ***
+         { LOG_RTC_DEBUG("*** Invalid RTC / time. RTC Valid? " << (rtcValid ? "True, " : "False, ") << value.timestamp(timestampFormat) << endl) } // *** DEBUG ***
+      }
+
+   #if TIME_SLEW_CODE
+   bool BinaryClock::AdjustTime(DateTime value, uint16_t fractionMs)
+      {
+      if (!rtcValid || !value.isValid()) { return false; }
+
+      // Where the RTC is in its second: the time since the last tick. Read again if it ticked meanwhile.
+      DateTime rtcTime;
+      unsigned long tick = 0UL;
+      unsigned long sinceTick = 0UL;
+      for (int i = 0; i < 2; i++)
+         {
+         tick = tickMicros;
+         rtcTime = ReadTime();
+         sinceTick = micros() - tick;
+         if (tick == tickMicros) { break; }
+         }
+
+      bool slewed = false;
+      int64_t offsetMs = 0;
+      uint32_t elapsedS = ((lastCorrection != 0UL) && (value.unixtime() > lastCorrection)) ? (value.unixtime() - lastCorrection) : 0UL;
+      if (timeSlew && (tick != 0UL) && (sinceTick < 1000000UL))
+         {
+         offsetMs = ((int64_t)value.unixtime() - (int64_t)rtcTime.unixtime()) * 1000LL + fractionMs - (int64_t)(sinceTick / 1000UL);
+         offsetMs += leapSecond.get_SmearedMs();   // The leap second smeared so far stays.
+         if ((offsetMs >= -BC_SLEW_MAX_MS) && (offsetMs <= BC_SLEW_MAX_MS))
+            { slewed = slew.Start((int32_t)offsetMs, elapsedS); }
+         }
+
+      if (slewed)
+         {
+         int8_t aging = RTC.getAgingOffset();
+         int8_t newAging = slew.AgingOffset(aging);
+         if (newAging != aging)
+            {
+            RTC.setAgingOffset(newAging);
+            LOG_RTC_INFO("AdjustTime(): RTC drift " << slew.get_DriftPpb() << " ppb; aging offset " << aging << " => " << newAging << endl)
+            }
+         LOG_RTC_INFO("AdjustTime(): offset " << (long)offsetMs << " ms; slewing over ~" << (long)((offsetMs < 0 ? -offsetMs : offsetMs) / BC_SLEW_STEP_MS) << " s" << endl)
+         }
+      else
+         {
+         LOG_RTC_INFO("AdjustTime(): offset " << (long)offsetMs << " ms; stepping to " << value.timestamp(DateTime::TIMESTAMP_DATETIME) << endl)
+         set_Time(value);
+         }
+
+      lastCorrection = value.unixtime();
+      return slewed;
+      }
+
+   bool BinaryClock::isAlarmSecond(const AlarmTime& alarm, const DateTime& value) const
+      {
+      // Only the minute and second are checked, every repeat mode (and cron rule) matches on them.
+      // A second that isn't the alarm may be blocked, that only delays the correction by a second.
+      uint8_t second = (alarm.number == ALARM_2) ? 0 : alarm.time.second();
+      return (alarm.status > 0) && (value.minute() == alarm.time.minute()) && (value.second() == second);
+      }
+
+   void BinaryClock::slewTime()
+      {
+      static uint32_t lastSecond = 0UL;
+      if ((time.unixtime() == lastSecond) || (slewShift != 0) || (slewTimer == nullptr)) { return; }   // One shift per second.
+      lastSecond = time.unixtime();
+
+      DateTime next = time + TimeSpan(1);
+      bool blocked = isAlarmSecond(Alarm2, time) || isAlarmSecond(Alarm2, next);
+      #ifndef UNO_R3
+      blocked = blocked || isAlarmSecond(Alarm1, time) || isAlarmSecond(Alarm1, next);
+      #endif
+
+      int16_t shift = slew.NextShift(blocked);
+      if (shift == 0) { return; }
+
+      // Lose: write this second again `-shift` ms after its tick; Gain: write the next second `shift` ms early.
+      unsigned long tick = tickMicros;
+      unsigned long writeAt = tick + (unsigned long)BCTimeSlew::WriteAtMs(shift) * 1000UL;
+      // The timer wakes the time task at the write (early, by less than a tick), it dispatches meanwhile.
+      long waitUs = (long)(writeAt - micros());
+      TickType_t waitTicks = (waitUs > 0L) ? pdMS_TO_TICKS(waitUs / 1000L) : 0;
+      slewTick = tick;
+      slewWriteAt = writeAt;
+      slewShift = shift;
+      if ((waitTicks == 0) || (xTimerChangePeriod(slewTimer, waitTicks, 0) != pdPASS))
+         {
+         slewShift = 0;
+         slew.Undo(shift);    // Too late in the second, try again on the next one.
+         }
+      }
+
+   void BinaryClock::slewWrite()
+      {
+      int16_t shift = slewShift;
+      slewShift = 0;
+      if (shift == 0) { return; }
+      if (tickMicros != slewTick)
+         {
+         slew.Undo(shift);    // The RTC ticked before the write (a late wake), try again on the next second.
+         return;
+         }
+
+      while ((long)(slewWriteAt - micros()) > 0L)
+         { ; }   // Woken less than a timer tick early, spin to the write time.
+
+      DateTime value = time + TimeSpan(BCTimeSlew::WriteSecond(shift));
+      RTC.adjust(value, get_Is12HourFormat());
+      unsigned long writeMicros = micros();
+      long lateMs = (long)((writeMicros - slewWriteAt) / 1000UL);
+      tickMicros = writeMicros;  // The RTC countdown restarted with the write.
+      if (lateMs >= BC_SLEW_MIN_MS) { slew.Start(slew.get_Remaining() + (int32_t)lateMs); }   // Written late, slew it back.
+
+      if (shift > 0)
+         {
+         // There is no tick for the second written, dispatch it like the RTC interrupt would:
+         // `time`, the alarms, the callbacks and the events of the new second; then `loop()` shows it.
+         set_CallbackTimeTriggered(callbackTimeEnabled);
+         TimeDispatch(TIME_TRIGGER);
+         set_RTCinterruptWasCalled(true);
+         }
+
+      if (!slew.get_IsSlewing())
+         { LOG_RTC_INFO("slewTime(): Time correction completed at " << value.timestamp(DateTime::TIMESTAMP_TIME) << endl) }
+      }
+
+   void BinaryClock::cancelSlew()
+      {
+      slew.Cancel();
+      if (slewTimer != nullptr) { xTimerStop(slewTimer, 0); }
+      slewShift = 0;       // A `SLEW_TRIGGER` already sent finds nothing to write.
+      }
+
+   void BinaryClock::slewTimerCallback(TimerHandle_t timer)
+      {
+      BinaryClock* clock = static_cast<BinaryClock*>(pvTimerGetTimerID(timer));
+      TaskHandle_t timeTask = clock->get_TimeDispatchHandle();
+      if (timeTask != nullptr) { xTaskNotify(timeTask, SLEW_TRIGGER, eSetBits); }
+      }
+
+   bool BinaryClock::ScheduleLeapSecond(DateTime value, int8_t leap, uint32_t smearS)
+      {
+      if (!rtcValid || ((leap != 0) && !value.isValid())) { return false; }
+
+      // A plan replaced part way through its smear: slew the part smeared back.
+      int32_t smearedMs = leapSecond.Schedule((leap != 0) ? value.unixtime() : 0UL, leap, smearS);
+      if (smearedMs != 0) { slew.Start(slew.get_Remaining() - smearedMs); }
+
+      if (leap == 0)
+         { LOG_RTC_INFO("ScheduleLeapSecond(): leap second cancelled" << endl) }
+      else
+         {
+         LOG_RTC_INFO("ScheduleLeapSecond(): " << ((leap > 0) ? "insert" : "delete") << " a second before " 
+                      << value.timestamp(DateTime::TIMESTAMP_DATETIME) << "; smear " << smearS << " s" << endl)
+         }
+      return true;
+      }
+
+   void BinaryClock::leapTime()
+      {
+      showLeap = false;    // Second 60 is shown for one second.
+      if (!leapSecond.get_IsPending()) { return; }
+
+      // The RTC alarm fires on the RTC's own tick, it can't be in the second repeated or skipped.
+      DateTime at(leapSecond.get_AtS());
+      DateTime before = at - TimeSpan(1);
+      bool blocked = isAlarmSecond(Alarm2, at) || isAlarmSecond(Alarm2, before);
+      #ifndef UNO_R3
+      blocked = blocked || isAlarmSecond(Alarm1, at) || isAlarmSecond(Alarm1, before);
+      #endif
+
+      int32_t slewMs = 0;
+      BCLeapAction action = leapSecond.Tick(time.unixtime(), blocked, slewMs);
+      if ((action == BCLeapAction::Repeat) || (action == BCLeapAction::Skip))
+         {
+         DateTime value = (action == BCLeapAction::Repeat) ? before : at;
+         RTC.adjust(value, get_Is12HourFormat());
+         unsigned long writeMicros = micros();
+         long lateMs = (long)((writeMicros - tickMicros) / 1000UL);
+         tickMicros = writeMicros;  // The RTC countdown restarted with the write.
+         time = ReadTime();
+         showLeap = (action == BCLeapAction::Repeat);
+         if (lateMs >= BC_SLEW_MIN_MS) { slew.Start(slew.get_Remaining() + (int32_t)lateMs); }   // The second started late.
+         LOG_RTC_INFO("leapTime(): leap second " << (showLeap ? "inserted" : "deleted") << " at " 
+                      << time.timestamp(DateTime::TIMESTAMP_TIME) << (showLeap ? " (:60)" : "") << endl)
+         }
+      else if (action == BCLeapAction::Slew)
+         {
+         slew.Start(slew.get_Remaining() + slewMs);
+         if (!leapSecond.get_IsPending())
+            { LOG_RTC_INFO("leapTime(): leap second slewed " << slewMs << " ms at " << time.timestamp(DateTime::TIMESTAMP_TIME) << endl) }
+         }
+      }
+   #endif
+
+   #if METRICS_CODE
+   void BinaryClock::countTick()
+      {
+      BCMetrics& metrics = BCMetrics::get_Instance();
+      #if TIME_SLEW_CODE
+      int32_t latencyUs = (int32_t)(micros() - tickMicros);
+      metrics.Set(BCMetric::TickLatencyUs, latencyUs);
+      metrics.Max(BCMetric::TickLatencyMaxUs, latencyUs);
+      #endif
+
+      // The interrupts since the last tick dispatched, more than one were missed (e.g. a busy task).
+      uint32_t ticks = isrTicks;
+      if ((dispatchedTicks != 0UL) && ((ticks - dispatchedTicks) > 1UL))
+         { metrics.Add(BCMetric::TicksMissed, ticks - dispatchedTicks - 1UL); }
+      dispatchedTicks = ticks;
+      metrics.Add(BCMetric::Ticks);
+      metrics.Set(BCMetric::I2CTransactions, (int32_t)RTC_I2C::transactions());
       }
+   #endif
 
    void BinaryClock::set_Alarm(AlarmTime value)
       {
       // Exit on bad input or missing RTC hardware.
       if (value.number < ALARM_1 || value.number > ALARM_2 || !rtcValid || !value.time.isValid()) { return; }
 
+      #if CRON_ALARM_CODE
+      if (cronRule[value.number - 1].get_IsValid())
+         {
+         cronRule[value.number - 1].Clear();   // A fixed alarm replaces the cron rule.
+         #if CRON_ALARM_NVS
+         saveCronRule(value.number, nullptr);
+         #endif
+         }
+      #endif
+
       // Set the alarm time and status in the RTC
       if (value.status >= 0)
          {
@@ -1221,6 +1557,114 @@ namespace BinaryClockShield
       else { ; } // Ignore bad (-ve) input status
       }
 
+   #if CRON_ALARM_CODE
+   bool BinaryClock::SetCronAlarm(uint8_t number, const char* expression, uint8_t melody)
+      {
+      if ((number < ALARM_1) || (number > ALARM_2) || !rtcValid) { return false; }
+
+      BCCronAlarm rule(expression);
+      if (!rule.get_IsValid())
+         {
+         LOG_RTC_WARN("*** Invalid cron expression: \"" << (expression ? expression : "") << "\"" << endl)
+         return false;
+         }
+
+      cronRule[number - 1] = rule;
+      AlarmTime& alarm = (number == ALARM_1) ? Alarm1 : Alarm2;
+      alarm.melody = melody;
+      if (!programCronAlarm(number))
+         {
+         ClearCronAlarm(number);
+         return false;
+         }
+
+      #if CRON_ALARM_NVS
+      saveCronRule(number, expression);
+      #endif
+      return true;
+      }
+
+   void BinaryClock::ClearCronAlarm(uint8_t number)
+      {
+      if ((number < ALARM_1) || (number > ALARM_2)) { return; }
+
+      cronRule[number - 1].Clear();
+      AlarmTime& alarm = (number == ALARM_1) ? Alarm1 : Alarm2;
+      alarm.status = 0;
+      if (rtcValid) { RTC.disableAlarm(number); }
+      #if CRON_ALARM_NVS
+      saveCronRule(number, nullptr);
+      #endif
+      }
+
+   bool BinaryClock::programCronAlarm(uint8_t number)
+      {
+      uint32_t next = cronRule[number - 1].NextMatch(time.unixtime());
+      if (next == 0) { return false; }
+
+      // The date match (date, hour, minute) is programmed as a one shot alarm: while the rule is
+      // kept `checkAlarm` programs the next match, without it the alarm is turned OFF once it fires
+      // instead of repeating on the same date each month.
+      DateTime when(next);
+      bool result = (number == ALARM_2)
+            ? RTC.setAlarm2(when, Ds3231Alarm2Mode::DS3231_A2_Date)
+            : RTC.setAlarm1(when, Ds3231Alarm1Mode::DS3231_A1_Date);
+
+      if (result)
+         {
+         AlarmTime& alarm = (number == ALARM_1) ? Alarm1 : Alarm2;
+         alarm.time   = when;
+         alarm.freq   = AlarmTime::Repeat::Never;
+         alarm.status = 1;
+         RTC.clearAlarm(number);
+         LOG_RTC_DEBUG(">>> Cron alarm " << number << " next: " << when.timestamp(DateTime::TIMESTAMP_DATETIME) << endl)
+         }
+
+      return result;
+      }
+
+   #if CRON_ALARM_NVS
+   void BinaryClock::saveCronRule(uint8_t number, const char* expression)
+      {
+      Preferences nvs;
+      const char* key = (number == ALARM_1) ? "alarm1" : "alarm2";
+      if (!nvs.begin(CRON_NVS_NAMESPACE, false))
+         {
+         LOG_RTC_WARN("*** Unable to open the NVS to save the cron rule of alarm " << number << endl)
+         return;
+         }
+
+      if (expression != nullptr)
+         { nvs.putString(key, expression); }
+      else if (nvs.isKey(key))
+         { nvs.remove(key); }
+      nvs.end();
+      }
+
+   bool BinaryClock::loadCronRule(uint8_t number)
+      {
+      Preferences nvs;
+      const char* key = (number == ALARM_1) ? "alarm1" : "alarm2";
+      if (!nvs.begin(CRON_NVS_NAMESPACE, true)) { return false; }   // Nothing saved yet.
+
+      String expression = nvs.isKey(key) ? nvs.getString(key, "") : String("");
+      nvs.end();
+      if (expression.length() == 0) { return false; }
+
+      BCCronAlarm rule(expression.c_str());
+      if (!rule.get_IsValid())
+         {
+         saveCronRule(number, nullptr);
+         return false;
+         }
+
+      cronRule[number - 1] = rule;
+      LOG_RTC_INFO("Cron alarm " << number << " restored: \"" << expression << "\"" << endl)
+      return true;
+      }
+   #endif // CRON_ALARM_NVS
+   #endif // CRON_ALARM_CODE
+
    AlarmTime BinaryClock::GetRtcAlarm(int number)
       {
       AlarmTime result;
@@ -1373,7 +1817,7 @@ namespace BinaryClockShield
       set_AlarmFormat(value? alarmFormat12 : alarmFormat24);
       RTC.setIs12HourMode(value); // Set the RTC to 12/24 hour mode
       #if DEV_CODE
-      SERIAL_STREAM(endl << "Is AM/PM? " << (value? "True" : "False") << "; Formats in use: " << TimeFormat << "; " 
+      LOG_DISPLAY_DEBUG(endl << "Is AM/PM? " << (value? "True" : "False") << "; Formats in use: " << TimeFormat << "; " 
             << AlarmFormat << "; e.g.:" << time.toString(buffer, sizeof(buffer), get_TimeFormat()) << endl) // *** DEBUG ***
       #endif
 
@@ -1504,6 +1948,12 @@ namespace BinaryClockShield
 
          uint8_t prevHour = time.hour();
          time = ReadTime();
+         #if METRICS_CODE
+         countTick();
+         #endif
+         #if TIME_SLEW_CODE
+         if (leapSecond.get_IsPending() || showLeap) { leapTime(); }
+         #endif
 
          /// @brief Lambda to check if an alarm was triggered, returns the result.
          /// @details If the alarm has fired, the alarm fired flag on the RTC 
@@ -1518,6 +1968,14 @@ namespace BinaryClockShield
                   {
                   alarm.fired = true;           // Set the flag, the alarm went off (e.g. ringing).
                   RTC.clearAlarm(alarm.number); // Clear the alarm flag for next alarm trigger.
+                  #if CRON_ALARM_CODE
+                  // A cron rule: program the next match, the alarm stays ON.
+                  if (cronRule[alarm.number - 1].get_IsValid())
+                     {
+                     programCronAlarm(alarm.number);
+                     return alarm.fired;
+                     }
+                  #endif
                   // If this was a one-shot alarm, turn it off.
                   if (alarm.freq == AlarmTime::Repeat::Never)
                      {
@@ -1555,6 +2013,20 @@ namespace BinaryClockShield
          set_RTCinterruptWasCalled(false);
          #endif
 
+         #if EVENT_ENGINE_CODE
+         // O(1) when nothing is due. One event is handed to `loop()` at a time: when several
+         // are due on the same tick the highest priority one (e.g. alarm over chime) is played
+         // first, the others stay due in the heap and are played on the next ticks.
+         EVENT_LOCK()
+         if (!eventFired && events.PopDue(time.unixtime(), firedEvent))
+            { eventFired = true; }
+         EVENT_UNLOCK()
+         #endif
+
+         #if TIME_SLEW_CODE
+         if (slew.get_IsSlewing()) { slewTime(); }
+         #endif
+
          uint8_t hour = time.hour();
          HourColor ampmColor = (hour < 12)? HourColor::Am : HourColor::Pm;
          // Check if we need to switch the hour colors, i.e. from PM to AM or AM to PM.
@@ -1576,7 +2048,7 @@ namespace BinaryClockShield
       uint32_t notificationValue;
       FOREVER
          {
-         BaseType_t notifyResult = xTaskNotifyWait ( TIME_TRIGGER | EXIT_TRIGGER
+         BaseType_t notifyResult = xTaskNotifyWait ( TIME_TRIGGER | SLEW_TRIGGER | EXIT_TRIGGER
                                                    , 0x0000
                                                    , &notificationValue
                                                    , pdMS_TO_TICKS(TIMETASK_DELAY_MS));
@@ -1585,6 +2057,10 @@ namespace BinaryClockShield
             {
             if (notificationValue & EXIT_TRIGGER)
                { break; }
+            #if TIME_SLEW_CODE
+            if (notificationValue & SLEW_TRIGGER)
+               { slewWrite(); }   // Once: `slewShift` is cleared by the write.
+            #endif
             if (notificationValue & TIME_TRIGGER)
                { set_CallbackTimeTriggered(true); }
 
@@ -1967,6 +2443,13 @@ namespace BinaryClockShield
       return melodyRegistry.size() - 1;
       }
 
+   void BinaryClock::ReplaceMelody(std::vector<Note>& melody, std::vector<Note>& notes)
+      {
+      MELODY_LOCK()
+      melody.swap(notes);
+      MELODY_UNLOCK()
+      }
+
    const std::vector<Note>& BinaryClock::GetMelodyById(size_t index) const
       {
       if (index < melodyRegistry.size())
@@ -1978,6 +2461,48 @@ namespace BinaryClockShield
       return defaultMelody;
       }
 
+   #if EVENT_ENGINE_CODE
+   uint8_t BinaryClock::AddChime(uint8_t melody, uint8_t repeat)
+      {
+      EVENT_LOCK()
+      uint8_t id = events.AddChime(time.unixtime(), melody, repeat);
+      EVENT_UNLOCK()
+      return id;
+      }
+
+   uint8_t BinaryClock::StartTimer(uint32_t seconds, uint8_t melody, bool periodic)
+      {
+      EVENT_LOCK()
+      uint8_t id = events.AddTimer(time.unixtime(), seconds, melody, periodic);
+      EVENT_UNLOCK()
+      return id;
+      }
+
+   uint8_t BinaryClock::Snooze(uint32_t seconds)
+      {
+      EVENT_LOCK()
+      uint8_t id = events.AddSnooze(time.unixtime(), seconds, Alarm2.melody, alarmRepeatMax);
+      EVENT_UNLOCK()
+      return id;
+      }
+
+   uint8_t BinaryClock::AddAlarmEvent(const DateTime& alarmTime, uint32_t period, uint8_t melody)
+      {
+      EVENT_LOCK()
+      uint8_t id = events.AddAlarm(alarmTime.unixtime(), period, melody, alarmRepeatMax);
+      EVENT_UNLOCK()
+      return id;
+      }
+
+   bool BinaryClock::CancelEvent(uint8_t id)
+      {
+      EVENT_LOCK()
+      bool result = events.Cancel(id);
+      EVENT_UNLOCK()
+      return result;
+      }
+   #endif // EVENT_ENGINE_CODE
+
    bool BinaryClock::PlayMelody(size_t id) const
       {
       // Validate index and get melody reference
@@ -1991,21 +2516,22 @@ namespace BinaryClockShield
       return false; // Invalid index
       }
 
-   void BinaryClock::PlayMelody(const std::vector<Note>& melody) const
+   void BinaryClock::PlayMelody(const std::vector<Note>& melody, int repeat) const
       {
-      if (melody.empty()) { return; }
-
-      unsigned long millis_time_now = 0;
-      unsigned long noteDuration;
+      MELODY_LOCK()
+      melodyPlaying = true;
 
-      for (int i = 0; i < alarmRepeatMax; i++)
+      bool stopped = false;
+      for (int i = 0; (i < repeat) && !stopped; i++)
          {
-         for (size_t thisNote = 0; thisNote < melody.size(); thisNote++)
+         for (size_t thisNote = 0; (thisNote < melody.size()) && !stopped; thisNote++)
             {
-            if (!playNote(const_cast<Note&>(melody[thisNote]), buttonS2)) 
-               { return; } // Exit if user stopped the melody
+            stopped = !playNote(const_cast<Note&>(melody[thisNote]), buttonS2);   // Exit if user stopped the melody
             }
          }
+
+      melodyPlaying = false;
+      MELODY_UNLOCK()
       }
    #else
    void BinaryClock::PlayAlarm(const AlarmTime& alarm) const
@@ -2139,14 +2665,18 @@ namespace BinaryClockShield
       if (curCall - lastCall > 950) 
          {
          lastCall = curCall;
-         Serial << F("Time: ") <<  get_Time().toString(buffer, sizeof(buffer), get_TimeFormat()) << F("  Binary: ");
-
+         // Build the binary string first so the line is written as one message, 
+         // in order with the `SERIAL_TIME()` prefix when the output is queued.
+         char binary[NUM_LEDS + 3];
+         size_t pos = 0;
          for (int i = NUM_LEDS - 1; i >= 0; i--)
             {
-            if (i == (HOUR_LEDS_OFFSET - 1) || i == (MINUTE_LEDS_OFFSET - 1)) Serial << (" "); // Insert a space between hours - minutes, and minutes - seconds.
-            Serial << (binaryArray[i] ? "1" : "0"); // Print 1 or 0 for each LED
+            if (i == (HOUR_LEDS_OFFSET - 1) || i == (MINUTE_LEDS_OFFSET - 1)) binary[pos++] = ' '; // Insert a space between hours - minutes, and minutes - seconds.
+            binary[pos++] = (binaryArray[i] ? '1' : '0'); // 1 or 0 for each LED
             }
-         Serial << endl;
+         binary[pos] = '\0';
+
+         SERIAL_STREAM_MACRO(F("Time: ") <<  get_Time().toString(buffer, sizeof(buffer), get_TimeFormat()) << F("  Binary: ") << binary << endl)
          }
       }
    #endif 
@@ -117,6 +117,20 @@
 
 #include "BCMenu.h"              /// Binary Clock Settings class: handles all settings and serial output.
 #include "BCButton.h"            /// Binary Clock Button class: handles all button related functionality.
+#include "BCSerialCommand.h"     /// Binary Clock serial command protocol class: bulk configuration over serial.
+#if EVENT_ENGINE_CODE
+   #include "BCEventEngine.h"    /// Binary Clock event engine class: chimes, timers, snooze and software alarms.
+#endif
+#if CRON_ALARM_CODE
+   #include "BCCronAlarm.h"      /// Binary Clock cron alarm class: cron style alarm rules compiled to bitmasks.
+#endif
+#if METRICS_CODE
+   #include <BCMetrics.h>        /// The metrics registry: the tick latency, missed ticks and I2C transactions.
+#endif
+#if TIME_SLEW_CODE
+   #include "BCTimeSlew.h"       /// Binary Clock time slew class: gradual correction of the RTC time.
+   #include "BCLeapSecond.h"     /// Binary Clock leap second class: the leap second made on the RTC.
+#endif
 
 #include <FastLED.h>             /// For control of the WS2812B LEDs. (https://github.com/FastLED/FastLED)
 #include <fl/array.h>            /// For fl::array used for the LEDS.
@@ -144,9 +158,11 @@
       #if __has_include(<FreeRTOS.h>)              // Typical
          #include <FreeRTOS.h>
          #include <task.h>
+         #include <timers.h>
       #elif __has_include(<freertos/FreeRTOS.h>)   // ESP32 boards
          #include <freertos/FreeRTOS.h>
          #include <freertos/task.h>
+         #include <freertos/timers.h>
       #elif __has_include(<Arduino_FreeRTOS.h>)    // Arduino UNO R4 WiFi
          #include <Arduino_FreeRTOS.h>
       #else
@@ -156,6 +172,7 @@
       #warning "BinaryClock.h - Cannot check for FreeRTOS.h file name variant/location. Using #include <freertos/FreeRTOS.h> as the default."
       #include <freertos/FreeRTOS.h>
       #include <freertos/task.h>
+      #include <freertos/timers.h>
    #endif // __has_include
 #endif // FREE_RTOS
 
@@ -172,6 +189,7 @@
 #define ALARM1_TRIGGER              0x0002
 #define ALARM2_TRIGGER              0x0004
 #define ALARMS_TRIGGER  (ALARM1_TRIGGER | ALARM2_TRIGGER)
+#define SLEW_TRIGGER                0x0008   ///< The time task: the RTC write of the slew shift is due.
 #define EXIT_TRIGGER                0x8000   
 #define ALL_TRIGGERS                0xFFFF
 
@@ -292,6 +310,34 @@ namespace BinaryClockShield
          { return time; }
       /// @}
 
+      #if TIME_SLEW_CODE
+      /// @brief Correct the time to `value` gradually (slew), large offsets are stepped.
+      /// @details The offset from the RTC is measured against the last RTC tick. Offsets up to
+      ///          `BC_SLEW_MAX_MS` are corrected by moving the phase of the RTC second by up to
+      ///          `BC_SLEW_STEP_MS` each second (`BCTimeSlew`), so every second and every alarm is
+      ///          shown exactly once. Larger offsets, or when `TimeSlew` is OFF, call `set_Time()`.
+      ///          The drift measured between corrections trims the DS3231 aging offset.
+      /// @param value The correct time, whole seconds.
+      /// @param fractionMs The milliseconds elapsed in the second `value`. {0}
+      /// @return True if the time is slewed (or already correct), false if it was stepped.
+      /// @see set_TimeSlew()
+      /// @author Chris-70 (2026/10)
+      bool AdjustTime(DateTime value, uint16_t fractionMs = 0) override;
+
+      /// @brief Plan a leap second announced by the NTP servers, made on the RTC at the event.
+      /// @details Without a smear window the display shows 23:59:60 for an inserted second (the
+      ///          RTC writes 23:59:59 again), 23:59:59 isn't shown for a deleted one. With a window
+      ///          the second is slewed out over the window ending at the event (`BCLeapSecond`),
+      ///          `AdjustTime()` keeps the part smeared so far. The RTC is right after the event
+      ///          without a sync.
+      /// @param value The local time of the first second after the leap.
+      /// @param leap +1 insert; -1 delete; 0 cancels the leap planned.
+      /// @param smearS The window (s) ending at the leap to smear the second over, 0 to show :60. {0}
+      /// @return True, the leap second is made (or cancelled); false if the RTC isn't valid.
+      /// @author Chris-70 (2026/10)
+      bool ScheduleLeapSecond(DateTime value, int8_t leap, uint32_t smearS = 0) override;
+      #endif
+
       /// @ingroup properties
       /// @{
       /// @brief The property method called to set/get the current 'Alarm' property.
@@ -499,6 +545,18 @@ namespace BinaryClockShield
       /// @see RegisterMelody()
       /// @author Chris-70 (2025/09)
       virtual const std::vector<Note>& GetMelodyById(size_t id) const override;
+
+      /// @brief Replace the notes of a registered melody, e.g. a melody uploaded again.
+      /// @details The notes are swapped in under the player's lock, a melody playing on another
+      ///          task is never changed under it: the call waits for the melody to end.
+      /// @param melody The registered melody, the vector passed to `RegisterMelody()`.
+      /// @param notes The new notes, returns the previous notes.
+      /// @see get_IsMelodyPlaying()
+      /// @author Chris-70 (2026/10)
+      void ReplaceMelody(std::vector<Note>& melody, std::vector<Note>& notes);
+
+      /// @brief Read only property: A melody is playing, e.g. the alarm is sounding.
+      bool get_IsMelodyPlaying() const { return melodyPlaying; }
       #endif
 
    //#################################################################################//  
@@ -533,6 +591,48 @@ namespace BinaryClockShield
       /// @author Chris-70 (2025/09)
       virtual void PlayAlarm() const { PlayAlarm(get_Alarm()); }
 
+      #if EVENT_ENGINE_CODE
+      /// @brief Add an hourly chime, it plays the melody on every hour.
+      /// @param melody The registered melody id to play.
+      /// @param repeat The number of times to play the melody. {1}
+      /// @return The event id used to cancel the chime, `0` if there are too many events.
+      /// @see CancelEvent()
+      /// @author Chris-70 (2026/10)
+      uint8_t AddChime(uint8_t melody, uint8_t repeat = 1);
+
+      /// @brief Start a countdown timer, it plays the melody when the time is up.
+      /// @param seconds The countdown time in seconds.
+      /// @param melody The registered melody id to play. {0}
+      /// @param periodic Flag: Restart the timer each time it expires. {false}
+      /// @return The event id used to cancel the timer, `0` on failure.
+      /// @see CancelEvent()
+      /// @author Chris-70 (2026/10)
+      uint8_t StartTimer(uint32_t seconds, uint8_t melody = 0, bool periodic = false);
+
+      /// @brief Snooze the alarm, it plays the alarm melody again after `seconds`.
+      /// @details Only one snooze exists, calling this again restarts the snooze time.
+      /// @param seconds The snooze time in seconds. {DEFAULT_SNOOZE_SECONDS}
+      /// @return The event id used to cancel the snooze, `0` on failure.
+      /// @see CancelEvent()
+      /// @author Chris-70 (2026/10)
+      uint8_t Snooze(uint32_t seconds = DEFAULT_SNOOZE_SECONDS);
+
+      /// @brief Add a software alarm in addition to the RTC alarms.
+      /// @param alarmTime The time of the first alarm.
+      /// @param period The repeat period in seconds, e.g. 86400 for daily; `0` for a single alarm.
+      /// @param melody The registered melody id to play. {0}
+      /// @return The event id used to cancel the alarm, `0` on failure.
+      /// @see CancelEvent()
+      /// @author Chris-70 (2026/10)
+      uint8_t AddAlarmEvent(const DateTime& alarmTime, uint32_t period, uint8_t melody = 0);
+
+      /// @brief Cancel a chime, timer, snooze or software alarm.
+      /// @param id The event id returned when the event was added.
+      /// @return True if the event was found and removed.
+      /// @author Chris-70 (2026/10)
+      bool CancelEvent(uint8_t id);
+      #endif
+
       /// @brief The method to read the time from the RTC (wrapper for RTC.now()). 
       /// @return A DateTime object containing the current time read from the RTC.
       DateTime ReadTime() override;
@@ -548,6 +648,47 @@ namespace BinaryClockShield
       /// @author Chris-80 (2025/07)
       AlarmTime GetRtcAlarm(int number);
 
+      #if CRON_ALARM_CODE
+      /// @brief Set the alarm `number` with a cron style rule, e.g. "30 6 * * MON-FRI" (weekdays at 06:30).
+      /// @details The rule is compiled into bitmasks and the RTC alarm is programmed with the next
+      ///          matching minute (DS3231 date match). Each time the alarm fires the following match
+      ///          is programmed, the same as when the time is set. Setting the alarm with `set_Alarm()`
+      ///          removes the rule.
+      /// @note With `CRON_ALARM_NVS` the rule is also saved in NVS and restored by `SetupAlarm()`.
+      ///       Without it the rule is in RAM only: after a reboot the date match left in the RTC is
+      ///       seen as a `Repeat::Monthly` alarm, set the rule again.
+      /// @param number The alarm number: 1 or 2.
+      /// @param expression The 5 field cron expression, see `BCCronAlarm`.
+      /// @param melody The registered melody id to play. {0}
+      /// @return True if the expression is valid and the RTC alarm was programmed.
+      /// @see BCCronAlarm
+      /// @author Chris-70 (2026/10)
+      bool SetCronAlarm(uint8_t number, const char* expression, uint8_t melody = 0);
+
+      /// @brief Remove the cron rule from the alarm `number` and turn the alarm OFF.
+      /// @param number The alarm number: 1 or 2.
+      /// @author Chris-70 (2026/10)
+      void ClearCronAlarm(uint8_t number);
+      #endif
+
+      #if TIME_SLEW_CODE
+      /// @brief Property: TimeSlew - Flag: `AdjustTime()` slews small offsets instead of stepping.
+      /// @param value True to slew (default), false to always step the time.
+      /// @see AdjustTime()
+      void set_TimeSlew(bool value)
+         { 
+         timeSlew = value; 
+         if (!value) { cancelSlew(); }
+         }
+      /// @copydoc set_TimeSlew()
+      bool get_TimeSlew() const
+         { return timeSlew; }
+
+      /// @brief Read only property: The time slew state, e.g. the offset remaining and the RTC drift.
+      const BCTimeSlew& get_Slew() const
+         { return slew; }
+      #endif
+
       #if !UNO_R3
       /// @brief Method to convert a DateTime value to a string inline. This method takes the format as a parameter
       ///        and copies it to the buffer before calling DateTime.toString() and returning the result.
@@ -587,7 +728,12 @@ namespace BinaryClockShield
       /// @see PlayMelody(size_t id)
       /// @see PlayAlarm(const AlarmTime& alarm)
       /// @author Chris-70 (2025/09)
-      void PlayMelody(const std::vector<Note>& melody) const;
+      void PlayMelody(const std::vector<Note>& melody) const
+         { PlayMelody(melody, alarmRepeatMax); }
+
+      /// @copydoc PlayMelody(const std::vector<Note>&) const
+      /// @param repeat The number of times to play the melody.
+      void PlayMelody(const std::vector<Note>& melody, int repeat) const;
       #else
       /// @brief Method to change the alarm melody with the melody Note array: `melodyArray`.
       /// @details Changes the default alarm melody to the given `melodyAlarm`. If the 
@@ -648,6 +794,63 @@ namespace BinaryClockShield
       /// @author Chris-80 (2025/07)
       bool SetupRTC();
 
+      #if CRON_ALARM_CODE
+      /// @brief Program the RTC alarm `number` with the next match of its cron rule after the current time.
+      /// @return True if the rule has a next match and the RTC alarm was set.
+      /// @author Chris-70 (2026/10)
+      bool programCronAlarm(uint8_t number);
+
+      #if CRON_ALARM_NVS
+      /// @brief Save the cron expression of the alarm `number` in NVS, `nullptr` removes it.
+      /// @author Chris-70 (2026/10)
+      void saveCronRule(uint8_t number, const char* expression);
+
+      /// @brief Restore the cron rule of the alarm `number` saved in NVS.
+      /// @return True if a valid rule was saved, `cronRule` is then set.
+      /// @author Chris-70 (2026/10)
+      bool loadCronRule(uint8_t number);
+      #endif
+      #endif
+
+      #if TIME_SLEW_CODE
+      /// @brief Plan the phase shift of the current second by `slew`, called from the time task.
+      /// @details Starts `slewTimer` for the point in the second to write the RTC: to lose time
+      ///          the current second is written again late; to gain time the next second is written
+      ///          early. The time task isn't held meanwhile. No shift is made into or out of an
+      ///          alarm second.
+      /// @author Chris-70 (2026/10)
+      void slewTime();
+
+      /// @brief Write the shift planned by `slewTime()` to the RTC, called from the time task on
+      ///        `SLEW_TRIGGER`. The second written by a gain is dispatched like a tick.
+      /// @author Chris-70 (2026/10)
+      void slewWrite();
+
+      /// @brief Cancel the correction in progress and the write planned by `slewTime()`, if any.
+      /// @author Chris-70 (2026/10)
+      void cancelSlew();
+
+      /// @brief The `slewTimer` callback (timer service task): notify the time task of the write.
+      static void slewTimerCallback(TimerHandle_t timer);
+
+      /// @brief Check if the RTC alarm `alarm` is ON and fires at `value` (seconds resolution).
+      bool isAlarmSecond(const AlarmTime& alarm, const DateTime& value) const;
+
+      /// @brief Make the leap second planned by `leapSecond` on the RTC tick, called from the time task
+      ///        before the events of the second are dispatched.
+      /// @details Repeats or skips the second on the RTC (shown as second 60 for a repeat), or
+      ///          slews the part of the smear due. The latency of the write is slewed back.
+      /// @author Chris-70 (2026/10)
+      void leapTime();
+      #endif
+
+      #if METRICS_CODE
+      /// @brief Count the tick in the metrics: the latency from the interrupt, the interrupts not
+      ///        dispatched and the RTC's I2C transactions. Called from the time task, a few stores.
+      /// @author Chris-70 (2026/10)
+      void countTick();
+      #endif
+
       /// @brief This method is to isolate the code needed to setup the alarm.
       /// @author Chris-80 (2025/07)
       void SetupAlarm();
@@ -1149,6 +1352,23 @@ namespace BinaryClockShield
       size_t get_MelodyCount() const { return melodyRegistry.size(); }
       #endif
 
+      //  ingroup properties
+      /// @brief Read only property: The current state of the settings menu.
+      /// @return `SettingsState::Inactive` when the settings menu isn't in use.
+      /// @author Chris-70 (2026/10)
+      SettingsState get_SettingsState() const
+         { return menu.get_CurrentState(); }
+
+      #if SERIAL_COMMAND_CODE
+      //  ingroup properties
+      /// @brief Read only property: The binary serial command protocol handler.
+      /// @details Used to add commands the `BinaryClock` library doesn't handle, e.g. the
+      ///          WiFi credentials, with `BCSerialCommand::RegisterCommand()`.
+      /// @author Chris-70 (2026/10)
+      BCSerialCommand& get_SerialCommand()
+         { return command; }
+      #endif
+
       #if FREE_RTOS
       void set_ClockEventGroup(EventGroupHandle_t value)
          { clockEventGroup = value; }
@@ -1331,6 +1551,9 @@ namespace BinaryClockShield
       AlarmTime Alarm1;                            ///< DS3232 alarm 1, includes seconds in alarm.
       #endif
       AlarmTime Alarm2;                            ///< Default alarm, seconds set at 00.
+      #if CRON_ALARM_CODE
+      BCCronAlarm cronRule[2];                     ///< The cron rules for alarm 1 and 2, not valid when unused.
+      #endif
 
       const char* TimeFormat = timeFormat24;       ///< Pointer to the current format string for the time.
       const char* AlarmFormat = alarmFormat24;     ///< Pointer to the current format string for the alarm.
@@ -1402,6 +1625,30 @@ namespace BinaryClockShield
       #endif
 
       BCMenu menu;                           ///< Settings handler instance
+      #if EVENT_ENGINE_CODE
+      BCEventEngine events;                  ///< Scheduled chimes, timers, snooze and software alarms.
+      ClockEvent firedEvent;                 ///< The event to play in `loop()`, set in `TimeDispatch()`.
+      volatile bool eventFired = false;      ///< Flag: `firedEvent` is waiting to be played.
+      #endif
+      #if SERIAL_COMMAND_CODE
+      BCSerialCommand command;               ///< Binary serial command protocol handler instance
+      #endif
+      #if TIME_SLEW_CODE
+      BCTimeSlew slew;                       ///< The gradual correction of the RTC time in progress.
+      bool timeSlew = true;                  ///< Flag: `AdjustTime()` slews small offsets.
+      volatile unsigned long tickMicros = 0UL; ///< The value of `micros()` at the last RTC tick (interrupt).
+      TimerHandle_t slewTimer = nullptr;     ///< One shot timer: the RTC write of the shift planned.
+      unsigned long slewTick = 0UL;          ///< The value of `tickMicros` when the shift was planned.
+      unsigned long slewWriteAt = 0UL;       ///< The value of `micros()` to write the RTC at.
+      volatile int16_t slewShift = 0;        ///< The shift (ms) planned, 0 if none.
+      uint32_t lastCorrection = 0UL;         ///< The unixtime of the last time correction, 0 if none.
+      BCLeapSecond leapSecond;               ///< The leap second planned, made by `leapTime()`.
+      volatile bool showLeap = false;        ///< Flag: the second repeated for a leap is shown as second 60.
+      #endif
+      #if METRICS_CODE
+      volatile uint32_t isrTicks = 0UL;      ///< The RTC tick interrupts, counted by `RTCinterrupt()`.
+      uint32_t dispatchedTicks = 0UL;        ///< The value of `isrTicks` at the last tick dispatched.
+      #endif
 
       DateTime time;                         ///< Current time from the RTC, updated every second.
       bool amPmMode = DEFAULT_12HR_MODE;     ///< Flag: Indicates if the clock is in 12-hour AM/PM, or 24 Hr mode.
@@ -1501,6 +1748,7 @@ namespace BinaryClockShield
       std::vector<Note> defaultMelody;                    ///< Default melody created from PROGMEM arrays
       std::vector<std::reference_wrapper<const std::vector<Note>>> melodyRegistry; ///< Registry of melody references
       size_t currentMelody;                               ///< Index to the current melody in melodyRegistry
+      mutable volatile bool melodyPlaying = false;        ///< Flag: `PlayMelody()` is playing a melody.
       #else
       bool isDefaultMelody = true;     ///< Flag: using the default (Flash ROM) alarm melody.
       const Note* alarmNotes;          ///< Pointer to the combined alarm notes array
@@ -0,0 +1,185 @@
+/// @file BinaryClockMetrics.cpp
+/// @brief The implementation of the `BinaryClockMetrics` class, the HTTP endpoint of the clock's metrics.
+/// @author Chris-70 (2026/10)
+
+#include "BinaryClockMetrics.h"
+
+#include <Streaming.h>                 /// For Serial << streaming syntax (https://github.com/janelia-arduino/Streaming)
+#include <WiFi.h>                      /// For WiFi.RSSI().
+#include <lwip/sockets.h>             /// For the BSD socket API: socket(); bind(); listen(); accept(); select().
+#include <esp_system.h>                /// For esp_get_free_heap_size() and esp_get_minimum_free_heap_size().
+#include <string.h>                    /// For strstr().
+
+//################################################################################//
+#ifndef SERIAL_OUTPUT
+   #define SERIAL_OUTPUT   true  // true to enable; false to disable
+#endif
+#ifndef DEV_CODE
+   #define DEV_CODE        true  // true to enable; false to disable
+#endif
+#ifndef DEBUG_OUTPUT
+   #define DEBUG_OUTPUT    true  // true to enable; false to disable
+#endif
+#ifndef PRINTF_OK
+   #define PRINTF_OK       true  // true to enable; false to disable
+#endif
+
+#include "SerialOutput.Defines.h"      // For all the serial output macros.
+//################################################################################//
+
+#define METRICS_WAIT_MS       1000U    ///< The wait (ms) on the listening socket between the `End()` checks.
+#define METRICS_BACKLOG          2     ///< The connections queued while a client is answered.
+
+namespace BinaryClockShield
+   {
+   bool BinaryClockMetrics::Begin(uint16_t port)
+      {
+      if (running) { return true; }
+      if (serverTask != nullptr)
+         {
+         LOG_WAN_ERROR("ERROR: metrics: the last task hasn't stopped" << endl)
+         return false;
+         }
+
+      sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if (sock < 0)
+         {
+         LOG_WAN_ERROR("ERROR: metrics: unable to create the TCP socket." << endl)
+         return false;
+         }
+
+      int reuse = 1;
+      setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+      struct sockaddr_in address = { };
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = htonl(INADDR_ANY);
+      if ((bind(sock, (struct sockaddr*)&address, sizeof(address)) < 0) || (listen(sock, METRICS_BACKLOG) < 0))
+         {
+         LOG_WAN_ERROR("ERROR: metrics: unable to listen on TCP port " << port << endl)
+         close(sock);
+         sock = -1;
+         return false;
+         }
+      fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);   // `accept()` never waits, `select()` does.
+
+      // Below the display and callback tasks: a scrape only delays itself.
+      running = true;
+      BaseType_t created = xTaskCreate(serverTaskRun, "MetricsTask", 4096, nullptr, tskIDLE_PRIORITY + 1, &serverTask);
+      if (created != pdPASS)
+         {
+         LOG_WAN_ERROR("ERROR: xTaskCreate failed for MetricsTask" << endl)
+         running = false;
+         serverTask = nullptr;
+         close(sock);
+         sock = -1;
+         return false;
+         }
+
+      LOG_WAN_INFO("Metrics: serving http://" << WiFi.localIP() << ":" << port << "/metrics" << endl)
+      return true;
+      }
+
+   void BinaryClockMetrics::End()
+      {
+      running = false;  // The task closes the socket after the current wait.
+      }
+
+   void BinaryClockMetrics::serve()
+      {
+      fd_set readSet;
+      FD_ZERO(&readSet);
+      FD_SET(sock, &readSet);
+      struct timeval tv = { (time_t)(METRICS_WAIT_MS / 1000), (suseconds_t)((METRICS_WAIT_MS % 1000) * 1000) };
+      if (select(sock + 1, &readSet, nullptr, nullptr, &tv) <= 0) { return; }   // Timed out, check `End()`.
+
+      struct sockaddr_in address = { };
+      socklen_t addressLength = sizeof(address);
+      int client = accept(sock, (struct sockaddr*)&address, &addressLength);
+      if (client < 0) { return; }   // The client gave up meanwhile.
+
+      answer(client);
+      close(client);
+      }
+
+   void BinaryClockMetrics::answer(int client)
+      {
+      // The client socket is blocking, a slow client times out instead of holding the task.
+      fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) & ~O_NONBLOCK);
+      struct timeval tv = { (time_t)(METRICS_CLIENT_MS / 1000), (suseconds_t)((METRICS_CLIENT_MS % 1000) * 1000) };
+      setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+      // Only the request line is needed, read up to its end (or the buffer's).
+      size_t length = 0;
+      while (length < (sizeof(request) - 1))
+         {
+         int received = recv(client, request + length, sizeof(request) - 1 - length, 0);
+         if (received <= 0) { break; }
+         length += (size_t)received;
+         request[length] = '\0';
+         if (strstr(request, "\r\n") != nullptr) { break; }
+         }
+      request[length] = '\0';
+      if (length == 0) { return; }
+
+      bool head = false;
+      uint16_t status = MetricsHttp::Route(request, head);
+      const char* text = "";
+      size_t textLength = 0;
+      if (status == 200)
+         {
+         sample();
+         textLength = BCMetrics::get_Instance().Render(body, sizeof(body));
+         if (textLength == 0)
+            {
+            LOG_WAN_ERROR("ERROR: metrics: METRICS_BUFFER_SIZE (" << METRICS_BUFFER_SIZE << ") is too small." << endl)
+            status = 500;
+            }
+         else
+            {
+            text = body;
+            scrapes++;
+            }
+         }
+
+      size_t headerLength = MetricsHttp::Header(status, textLength, header, sizeof(header));
+      if (headerLength == 0) { return; }
+
+      send(client, header, headerLength, 0);
+      if (!head && (textLength > 0)) { send(client, text, textLength, 0); }
+      }
+
+   void BinaryClockMetrics::sample()
+      {
+      BCMetrics& metrics = BCMetrics::get_Instance();
+      metrics.Set(BCMetric::WiFiRssi, WiFi.isConnected() ? (int32_t)WiFi.RSSI() : BC_METRIC_UNSET);
+      metrics.Set(BCMetric::HeapFree, (int32_t)esp_get_free_heap_size());
+      metrics.Set(BCMetric::HeapMinFree, (int32_t)esp_get_minimum_free_heap_size());
+
+      // The tasks by name, a task that isn't running isn't rendered. ESP-IDF counts the stack in bytes.
+      for (uint8_t i = 0; i < static_cast<uint8_t>(BCMetric::Count); i++)
+         {
+         BCMetric metric = static_cast<BCMetric>(i);
+         const char* name = BCMetrics::GetInfo(metric).task;
+         if (name == nullptr) { continue; }
+
+         TaskHandle_t task = xTaskGetHandle(name);
+         metrics.Set(metric, (task != nullptr) ? (int32_t)uxTaskGetStackHighWaterMark(task) : BC_METRIC_UNSET);
+         }
+      }
+
+   void BinaryClockMetrics::serverTaskRun(void* param)
+      {
+      (void)param;
+      BinaryClockMetrics& server = get_Instance();
+      while (server.running)
+         { server.serve(); }
+
+      close(server.sock);
+      server.sock = -1;
+      LOG_WAN_INFO("Metrics: stopped; " << server.scrapes << " scrapes." << endl)
+      server.serverTask = nullptr;
+      vTaskDelete(nullptr);
+      }
+   } // namespace BinaryClockShield
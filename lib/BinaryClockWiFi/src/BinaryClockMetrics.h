@@ -0,0 +1,106 @@
+/// @file BinaryClockMetrics.h
+/// @brief The header file for the `BinaryClockMetrics` class, the HTTP endpoint of the clock's metrics.
+/// @details `GET /metrics` on TCP port `METRICS_PORT` (9100) returns the `BCMetrics` registry in the
+///          Prometheus text format, so the clocks can be scraped like any other host:
+///          - the server task waits on the non-blocking listening socket with `select()`, one
+///            client at a time with `METRICS_CLIENT_MS` to send its request; it runs below the
+///            display and callback tasks, a scrape only delays itself;
+///          - on each scrape the sampled gauges are read first: WiFi RSSI, the free heap and the
+///            stack high water marks of the tasks named in the registry;
+///          - the request, the header and the text are in fixed buffers of the instance, nothing is
+///            allocated per scrape; `HEAD` gets the header only, other paths 404, other methods 405
+///            (`MetricsHttp`).
+///          `test/host/test_metrics.cpp` checks the rendering and the routing, `test/host/test_metrics_server.cpp`
+///          runs this server on 127.0.0.1, `test/metrics_scrape.py` scrapes a clock (or its stand-in,
+///          `selftest`) and checks the text format.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BINARYCLOCKMETRICS_H__
+#define __BINARYCLOCKMETRICS_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// For size_t
+
+#include <BCMetrics.h>                 /// The metrics registry, rendered for the scrape.
+#include "MetricsHttp.h"               /// The route of a request and the header of the reply.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"             /// For the server task and the stack high water marks.
+
+#ifndef METRICS_PORT
+   #define METRICS_PORT          9100U   ///< The TCP port of the metrics endpoint, the Prometheus node exporter's.
+#endif
+#ifndef METRICS_CLIENT_MS
+   #define METRICS_CLIENT_MS      500U   ///< The time (ms) a client has to send its request, and to take the reply.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The HTTP endpoint of the clock's metrics (Singleton pattern).
+   /// @author Chris-70 (2026/10)
+   class BinaryClockMetrics
+      {
+   public:
+      /// @brief Singleton access method for the `BinaryClockMetrics` instance.
+      static BinaryClockMetrics& get_Instance()
+         {
+         static BinaryClockMetrics instance; // Guaranteed to be destroyed, instantiated on first use
+         return instance;
+         }
+
+      /// @brief Open the listening socket and start the server task.
+      /// @param port The TCP port to serve, default `METRICS_PORT` (9100).
+      /// @return True if the server is running.
+      /// @author Chris-70 (2026/10)
+      bool Begin(uint16_t port = METRICS_PORT);
+
+      /// @brief Stop the server, the task closes the socket within a second.
+      void End();
+
+      /// @brief `IsRunning` Property (RO): Flag: the server task is serving.
+      bool get_IsRunning() const
+         { return running; }
+
+      /// @brief `Scrapes` Property (RO): The `/metrics` requests answered.
+      uint32_t get_Scrapes() const
+         { return scrapes; }
+
+   protected:
+      /// @brief Wait on the listening socket and answer one client.
+      void serve();
+
+      /// @brief Read the request of the `client`, send the reply and close it.
+      /// @param client The client socket.
+      /// @author Chris-70 (2026/10)
+      void answer(int client);
+
+      /// @brief Read the gauges sampled on the scrape: RSSI, heap and stack high water marks.
+      void sample();
+
+      /// @brief The server task: `serve()` until `End()`.
+      /// @param param Not used.
+      static void serverTaskRun(void* param);
+
+      /// @brief Protected constructor for Singleton pattern.
+      ///        Use `get_Instance()` to get the single instance.
+      /// @see get_Instance()
+      BinaryClockMetrics() = default;
+
+      /// @brief Removed copy constructor for Singleton pattern
+      BinaryClockMetrics(const BinaryClockMetrics&) = delete;
+      /// @brief Removed assignment operator for Singleton pattern
+      BinaryClockMetrics& operator=(const BinaryClockMetrics&) = delete;
+
+   private:
+      TaskHandle_t serverTask = nullptr;           ///< The server task.
+      int sock = -1;                               ///< The listening socket, closed by the task.
+      volatile bool running = false;               ///< Flag: serve, cleared by `End()`.
+      uint32_t scrapes = 0;                        ///< The `/metrics` requests answered.
+      char request[256] = { 0 };                   ///< The request, the headers past it are ignored.
+      char header[METRICS_HEADER_SIZE] = { 0 };    ///< The status line and headers of the reply.
+      char body[METRICS_BUFFER_SIZE] = { 0 };      ///< The metrics text.
+      }; // class BinaryClockMetrics
+   } // namespace BinaryClockShield
+
+#endif // __BINARYCLOCKMETRICS_H__
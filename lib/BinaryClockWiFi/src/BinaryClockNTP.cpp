@@ -10,9 +10,14 @@
 #endif // INLINE_HEADER
 
 #include <Streaming.h>                 /// For Serial << streaming syntax (https://github.com/janelia-arduino/Streaming)
+#include <lwip/sockets.h>             /// For the BSD socket API: socket(); sendto(); recvfrom() with a receive timeout.
+#include <esp_timer.h>                 /// For esp_timer_get_time(), the 64 bit monotonic µs timer.
+#include <esp_system.h>                /// For esp_random(), the DNS query ID.
+#include <BCMetrics.h>                 /// For the NTP offset, delay and sync counts of the metrics.
 
 // STL classes required to be included:
 #include <tuple>
+#include <algorithm>
 
 //################################################################################//
 #ifndef SERIAL_OUTPUT
@@ -31,6 +36,26 @@
 #include "SerialOutput.Defines.h"      // For all the serial output macros.
 //################################################################################//
 
+/// The heap of the steady state syncs, at DEBUG: the free heap and its low water mark before and after
+/// `NTP_HEAP_SYNCS` syncs, after the first good sync has opened the socket and cached the names. The same
+/// values after: the syncs kept nothing and no allocation went below the lowest free heap.
+#define NTP_HEAP_CHECK    (LOG_LEVEL_NTP >= LOG_LEVEL_DEBUG)
+#ifndef NTP_HEAP_SYNCS
+   #define NTP_HEAP_SYNCS  8U          ///< The syncs measured together.
+#endif
+#if NTP_HEAP_CHECK
+   #include <esp_heap_caps.h>          /// For heap_caps_get_free_size() and heap_caps_get_minimum_free_size().
+
+   /// @brief The heap and the time of the syncs measured.
+   static struct
+      {
+      uint32_t syncs   = 0;            ///< The syncs since the first good one, which isn't measured.
+      size_t   free    = 0;            ///< The free heap before the syncs measured.
+      size_t   minFree = 0;            ///< The lowest free heap before the syncs measured.
+      int64_t  us      = 0;            ///< The time (µs) in `SyncTime()` of the syncs measured.
+      } ntpHeap;
+#endif
+
 namespace BinaryClockShield
    {
    // size_t NtpEventBits::ntpDefaultOffset = 0U; // Initialize static property
@@ -43,6 +68,8 @@ namespace BinaryClockShield
       {
       // Private constructor - no initialization here
       // Use Begin() method instead
+      dnsMutex = xSemaphoreCreateMutex();
+      queryMutex = xSemaphoreCreateMutex();
       }
 
    BinaryClockNTP::~BinaryClockNTP()
@@ -54,12 +81,12 @@ namespace BinaryClockShield
       {
       if (event == NtpEvents::EventEnd)
          {
-         SERIAL_STREAM("BinaryClockNTP::SignalEvent() - Invalid event: " << static_cast<uint8_t>(event) << endl)
+         LOG_NTP_INFO("BinaryClockNTP::SignalEvent() - Invalid event: " << static_cast<uint8_t>(event) << endl)
          return;
          }
       else if (get_NtpGroupBits() == nullptr)
          {
-         SERIAL_STREAM("BinaryClockNTP::SignalEvent() - No event bits registered to signal event: " << static_cast<uint8_t>(event) << endl)
+         LOG_NTP_INFO("BinaryClockNTP::SignalEvent() - No event bits registered to signal event: " << static_cast<uint8_t>(event) << endl)
          return;
          }
 
@@ -77,7 +104,7 @@ namespace BinaryClockShield
       {
       if ((param == nullptr) || (param->instance == nullptr))
          {
-         SERIAL_PRINTLN("ERROR: ntpDoInitialize() - param or instance is NULL!")
+         LOG_NTP_ERROR("ERROR: ntpDoInitialize() - param or instance is NULL!" << endl)
          return;
          }
 
@@ -89,19 +116,19 @@ namespace BinaryClockShield
       // Note: The caller (SetupWiFiTask) also adds a 5-second delay after Begin() returns.
       if (param->delayMS > 0U)
          {
-         SERIAL_STREAM("BinaryClockNTP::ntpDoInitialize() - delaying initialization for " << param->delayMS << " ms" << endl)
+         LOG_NTP_INFO("BinaryClockNTP::ntpDoInitialize() - delaying initialization for " << param->delayMS << " ms" << endl)
          vTaskDelay(pdMS_TO_TICKS(param->delayMS));
-         SERIAL_STREAM("BinaryClockNTP::ntpDoInitialize() - delay complete, now initializing SNTP" << endl)
+         LOG_NTP_INFO("BinaryClockNTP::ntpDoInitialize() - delay complete, now initializing SNTP" << endl)
          }
 
       // NOTE: Servers are already stored in instance->ntpServers before task creation
       // No need to copy them here - they're already in the singleton instance
 
       // Perform SNTP initialization
-      SERIAL_STREAM("    BinaryClockNTP::ntpDoInitialize() - Initializing SNTP..." << endl)
+      LOG_NTP_INFO("    BinaryClockNTP::ntpDoInitialize() - Initializing SNTP..." << endl)
       instance->initialized = instance->initializeSNTP();
 
-      SERIAL_STREAM("[" << millis() << "] BinaryClockNTP singleton " << (instance->initialized ? "initialized" : "failed to initialize") << endl)
+      LOG_NTP_INFO("[" << millis() << "] BinaryClockNTP singleton " << (instance->initialized ? "initialized" : "failed to initialize") << endl)
       }
 
    /// @brief Static task wrapper for FreeRTOS xTaskCreate.
@@ -113,7 +140,7 @@ namespace BinaryClockShield
       
       if (param == nullptr)
          {
-         SERIAL_PRINTLN("ERROR: ntpTaskWrapper() - param is NULL!")
+         LOG_NTP_ERROR("ERROR: ntpTaskWrapper() - param is NULL!" << endl)
          vTaskDelete(nullptr);
          return;
          }
@@ -123,7 +150,7 @@ namespace BinaryClockShield
          // Call the static initialization function
          ntpDoInitialize(param);
 
-         SERIAL_PRINTLN("ntpTaskWrapper() - deleting param.")
+         LOG_NTP_INFO("ntpTaskWrapper() - deleting param." << endl)
          delete param;
          }
       catch (const std::exception& e)
@@ -137,7 +164,7 @@ namespace BinaryClockShield
          if (param != nullptr) { delete param; }
          }
 
-      SERIAL_PRINTLN("ntpTaskWrapper() - task ending.")
+      LOG_NTP_INFO("ntpTaskWrapper() - task ending." << endl)
       vTaskDelete(nullptr);
       }
 
@@ -147,7 +174,7 @@ namespace BinaryClockShield
       {
       if (initialized)
          {
-         SERIAL_STREAM("BinaryClockNTP::Begin() - already initialized; Call End() then reinitialize." << endl)
+         LOG_NTP_INFO("BinaryClockNTP::Begin() - already initialized; Call End() then reinitialize." << endl)
          return;
          }
 
@@ -177,7 +204,7 @@ namespace BinaryClockShield
             ntpServers[i].toCharArray(ntpServerNames[i], sizeof(ntpServerNames[i]));
             ntpServerCount++;
             }
-         SERIAL_STREAM("    BinaryClockNTP::Begin() - copied " << ntpServerCount << " server names to persistent storage" << endl)
+         LOG_NTP_INFO("    BinaryClockNTP::Begin() - copied " << ntpServerCount << " server names to persistent storage" << endl)
 
          // Create the task parameter structure with the given/known values.
          // NOTE: Servers are NOT stored in taskParam anymore - they're in the instance and persistent C-string array
@@ -187,7 +214,7 @@ namespace BinaryClockShield
 
          // ALWAYS use async execution - blocking mode disabled permanently (BUILD_MARKER_ASYNC_ONLY_V001)
          // The async task wrapper will handle initialization on a separate task
-         SERIAL_STREAM("    [ASYNC_ONLY_V001] Creating async task for NTP initialization" << endl)
+         LOG_NTP_INFO("    [ASYNC_ONLY_V001] Creating async task for NTP initialization" << endl)
          BaseType_t xReturned = xTaskCreate(
                ntpTaskWrapper,          // Static function pointer - reliable with xTaskCreate
                "NTPInitTask",
@@ -199,7 +226,7 @@ namespace BinaryClockShield
          
          if (xReturned != pdPASS)
             {
-            SERIAL_PRINTLN("ERROR: xTaskCreate failed for NTPInitTask!")
+            LOG_NTP_ERROR("ERROR: xTaskCreate failed for NTPInitTask!" << endl)
             delete taskParam;  // Clean up if task creation failed
             }
          }
@@ -218,9 +245,17 @@ namespace BinaryClockShield
          // Disable callbacks before stopping SNTP
          callbacksEnabled = false;
          stopSNTP();
+         if (xSemaphoreTake(queryMutex, portMAX_DELAY) == pdTRUE)
+            {
+            if (querySock >= 0) { close(querySock); }
+            querySock = -1;
+            xSemaphoreGive(queryMutex);
+            }
          ntpServers.clear();
+         pollController.Reset();
+         pollTimerUs = 0;
          initialized = false;
-         SERIAL_STREAM("[" << millis() << "] BinaryClockNTP singleton End" << endl)
+         LOG_NTP_INFO("[" << millis() << "] BinaryClockNTP singleton End" << endl)
          }
       }
 
@@ -234,6 +269,12 @@ namespace BinaryClockShield
       // callback execution while initialization is in progress
       callbacksEnabled = false;
 
+      if (manualSync)
+         {
+         LOG_NTP_INFO("[" << millis() << "] SNTP service not started, manual sync with " << ntpServers.size() << " servers" << endl)
+         return true;
+         }
+
       // Configure SNTP
       // Set SNTP operating mode
       sntp_setoperatingmode(SNTP_OPMODE_POLL);
@@ -246,13 +287,13 @@ namespace BinaryClockShield
       // before the async task was created. The ntpServerCount and ntpServerNames[] 
       // array are already populated and ready to use.
 
-      SERIAL_STREAM("[" << millis() << "] SNTP initialized with " << ntpServerCount << " servers" << endl)
+      LOG_NTP_INFO("[" << millis() << "] SNTP initialized with " << ntpServerCount << " servers" << endl)
 
       // Set NTP servers using persistent C-string storage (populated in main task context)
       for (size_t i = 0; i < ntpServerCount && i < MAX_NTP_SERVERS; i++)
          {
          sntp_setservername(i, ntpServerNames[i]);
-         SERIAL_STREAM("      - SNTP server " << i << " set to: " << ntpServerNames[i] << endl)
+         LOG_NTP_INFO("      - SNTP server " << i << " set to: " << ntpServerNames[i] << endl)
          }
 
       sntp_init();
@@ -260,99 +301,608 @@ namespace BinaryClockShield
       // CRITICAL: Enable callbacks now that SNTP is fully initialized
       // This ensures no callback is invoked until the SNTP service is ready
       callbacksEnabled = true;
-      SERIAL_STREAM("[" << millis() << "] Callbacks enabled for SNTP time sync notifications" << endl) // *** DEBUG ***
+      LOG_NTP_DEBUG("[" << millis() << "] Callbacks enabled for SNTP time sync notifications" << endl) // *** DEBUG ***
 
       return true;
       }
 
-   NTPResult BinaryClockNTP::SyncTime(const String& serverName, uint16_t port)
+   NTPResult BinaryClockNTP::QueryServer(const String& serverName, uint16_t port, uint32_t timeoutMs)
       {
       NTPResult result;
       result.success = false;
+      strncpy(result.serverUsed, serverName.c_str(), sizeof(result.serverUsed) - 1);
 
       if (serverName.isEmpty()) 
          {
-         result.errorMessage = "The `serverName` string is empty.";
+         result.error = NtpError::NoServer;
+         return result;
+         }
+
+      uint32_t serverIP = 0;
+      bool stale = false;
+      if (!ResolveServer(serverName, serverIP, stale))
+         {
+         result.error = NtpError::DnsFailed;
          return result;
          }
 
-      unsigned long startTime = millis();
-      unsigned long endTime = __UINT32_MAX__;
-      DateTime utcTime;
-      WiFiUDP udp;
+      // Wait on the socket for the reply instead of polling.
+      int sock = takeSocket(timeoutMs);
+      if (sock < 0)
+         {
+         result.error = NtpError::SocketFailed;
+         return result;
+         }
+
+      struct sockaddr_in address = { };
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = serverIP;
+      result.serverAddress = serverIP;
+
+      NtpPacket request = { 0 };
+      request.mode = 3;    // Client mode
+      request.vn = 4;
+      request.li = 0;
 
       NtpPacket& packet = result.packet;
-      // packet.li_vn_mode = 0b00100011;  // LI = 0, VN = 4, Mode = 3 (client mode)
-      packet.mode = 3;
-      packet.vn = 4;
-      packet.li = 0;
+      int64_t deadline = SystemMicros() + (int64_t)timeoutMs * 1000LL;
+      result.t1 = SystemMicros();
+      request.txTime = MicrosToNtp(result.t1);  // Returned in `orgTime`, used to match the reply.
+      int sent = sendto(sock, &request, sizeof(request), 0, (struct sockaddr*)&address, sizeof(address));
+      bool replied = false;
+      
+      while (sent == sizeof(request))
+         {
+         int received = recvfrom(sock, &packet, sizeof(packet), 0, nullptr, nullptr);
+         result.t4 = SystemMicros();
+         if (received < 0)
+            {
+            result.error = NtpError::NoReply;
+            break;
+            }
+
+         // Ignore a late reply to an earlier request, it has a different originate time.
+         if ((received >= (int)sizeof(packet)) && (packet.orgTime.intpart32u == request.txTime.intpart32u) 
+               && (packet.orgTime.frac32u == request.txTime.frac32u))
+            {
+            replied = true;
+            if (!checkReply(result))
+               { result.error = NtpError::InvalidReply; }
+            break;
+            }
+         
+         if (SystemMicros() >= deadline)
+            {
+            result.error = NtpError::NoReply;
+            break;
+            }
+         }
 
-      result.serverUsed = serverName;
-      int resBegin = udp.beginPacket(serverName.c_str(), port);
-      int resWrite = udp.write((const uint8_t*)&packet, sizeof(packet));
-      int resEnd = udp.endPacket();
+      if (sent != sizeof(request))
+         { result.error = NtpError::SendFailed; }
 
-      int count = 0;
-      while (udp.peek() < 0 && count < 10)
+      giveSocket(sent != sizeof(request));
+
+      if (result.success)
          {
-         vTaskDelay(pdMS_TO_TICKS(100));
-         count++;
+         result.samples = 1;
+         result.survivors = 1;
+         result.dateTime = DateTime((uint32_t)((result.t4 + result.offsetUs) / 1000000LL));
+         LOG_NTP_DEBUG("QueryServer(" << serverName << "): offset = " << (long)result.offsetUs << " us; delay = " << (long)result.delayUs << " us" << endl) // *** DEBUG ***
          }
+      else if (stale && !replied)
+         {
+         // The server may have moved: resolve the name again and retry once with the new address (a fresh hit).
+         uint32_t newIP = 0;
+         if (lookupServer(serverName.c_str(), newIP) && (newIP != serverIP))
+            {
+            LOG_NTP_INFO("QueryServer(" << serverName << "): no reply from the stale address, retrying with the new one." << endl)
+            return QueryServer(serverName, port, timeoutMs);
+            }
+         }
+
+      return result;
+      }
 
-      SERIAL_PRINTF("SyncTime(): UDP beginPacket=%d, write=%d, endPacket=%d, waitCount=%d\n", resBegin, resWrite, resEnd, count)  // *** DEBUG ***
-      if (udp.parsePacket() >= sizeof(packet))
+   NTPResult BinaryClockNTP::QueryServers(const std::vector<String>& servers, uint16_t port, uint32_t timeoutMs)
+      {
+      NTPResult result;
+      result.success = false;
+
+      size_t serverCount = std::min(servers.size(), (size_t)NTP_MAX_SAMPLES);
+      if (serverCount == 0)
          {
-         udp.read((uint8_t*)&packet, sizeof(packet));
-         endTime = millis();
+         result.error = NtpError::NoServer;
+         return result;
+         }
 
-         uint32_t unixTime = ntpToUnix(packet.txTime);
-         // Convert to DateTime
-         utcTime = DateTime(unixTime);
-         result.success = true;
-         SERIAL_PRINTLN("get_CurrentNtpTime(): NTP time = " + utcTime.timestamp(DateTime::TIMESTAMP_DATETIME12)) // *** DEBUG ***
+      /// @brief The request sent to each server, matched with the reply by address and originate time.
+      struct Request
+         {
+         uint32_t address;             ///< Server IPv4 address, `0` if not sent.
+         fixedpoint64 txTime;          ///< The transmit time sent (network order).
+         int64_t t1;                   ///< The transmit time (T1) in µs.
+         };
+      Request requests[NTP_MAX_SAMPLES] = { };
+      uint32_t addresses[NTP_MAX_SAMPLES] = { };
+      NtpPacket replies[NTP_MAX_SAMPLES];
+      int64_t receiveTimes[NTP_MAX_SAMPLES];
+      size_t outstanding = 0;
+      size_t sent = 0;
+
+      // Resolve every name first so the requests go out back to back.
+      for (size_t i = 0; i < serverCount; i++)
+         {
+         uint32_t serverIP = 0;
+         bool stale = false;   // Refreshed by `RefreshDns()` after the sync.
+         if (ResolveServer(servers[i], serverIP, stale))
+            { requests[i].address = addresses[i] = serverIP; }
+         else
+            { LOG_NTP_WARN("QueryServers(): DNS lookup failed for: " << servers[i] << endl) }
          }
 
-      udp.stop();
+      int sock = takeSocket(timeoutMs);
+      if (sock < 0)
+         {
+         result.error = NtpError::SocketFailed;
+         return result;
+         }
 
+      bool sendFailed = false;
+      for (size_t i = 0; i < serverCount; i++)
+         {
+         if (requests[i].address == 0) { continue; }
+
+         struct sockaddr_in address = { };
+         address.sin_family = AF_INET;
+         address.sin_port = htons(port);
+         address.sin_addr.s_addr = requests[i].address;
+
+         NtpPacket request = { 0 };
+         request.mode = 3;    // Client mode
+         request.vn = 4;
+         request.li = 0;
+         requests[i].t1 = SystemMicros();
+         requests[i].txTime = MicrosToNtp(requests[i].t1);
+         request.txTime = requests[i].txTime;
+         if (sendto(sock, &request, sizeof(request), 0, (struct sockaddr*)&address, sizeof(address)) == sizeof(request))
+            { outstanding++; sent++; }
+         else
+            { requests[i].address = 0; sendFailed = true; }
+         }
+
+      NtpClockFilter filter;
+      int64_t deadline = SystemMicros() + (int64_t)timeoutMs * 1000LL;
+      bool gathering = false;
+      while (outstanding > 0)
+         {
+         int64_t remaining = deadline - SystemMicros();
+         if (remaining <= 0) { break; }
+
+         struct timeval tv = { (time_t)(remaining / 1000000LL), (suseconds_t)(remaining % 1000000LL) };
+         setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+         NtpPacket packet;
+         struct sockaddr_in from = { };
+         socklen_t fromLength = sizeof(from);
+         int received = recvfrom(sock, &packet, sizeof(packet), 0, (struct sockaddr*)&from, &fromLength);
+         int64_t t4 = SystemMicros();
+         if (received < 0) { break; }   // Deadline
+         if (received < (int)sizeof(packet)) { continue; }
+
+         size_t index = serverCount;
+         for (size_t i = 0; i < serverCount; i++)
+            {
+            if ((requests[i].address != 0) && (requests[i].address == from.sin_addr.s_addr)
+                  && (packet.orgTime.intpart32u == requests[i].txTime.intpart32u) && (packet.orgTime.frac32u == requests[i].txTime.frac32u))
+               { index = i; break; }
+            }
+         if (index == serverCount) { continue; }   // Not ours or a duplicate.
+
+         requests[index].address = 0;
+         outstanding--;
+
+         NTPResult sample;
+         sample.packet = packet;
+         sample.t1 = requests[index].t1;
+         sample.t4 = t4;
+         if (!checkReply(sample))
+            {
+            if (sample.kissCode != 0)
+               {
+               result.kissCode = sample.kissCode;
+               result.packet.poll = packet.poll;
+               }
+            LOG_NTP_WARN("QueryServers(): Reply from " << servers[index] << " is not valid (unsynchronized or KoD)" << endl)
+            continue;
+            }
+
+         replies[index] = packet;
+         receiveTimes[index] = t4;
+         int64_t rootDelayUs      = ((int64_t)ntohl(packet.rootDelay)      * 1000000LL) >> 16;
+         int64_t rootDispersionUs = ((int64_t)ntohl(packet.rootDispersion) * 1000000LL) >> 16;
+         filter.Add({ sample.offsetUs, sample.delayUs, NtpClockFilter::RootDistance(sample.delayUs, rootDelayUs, rootDispersionUs), (uint8_t)index });
+         LOG_NTP_DEBUG("QueryServers(): " << servers[index] << " offset = " << (long)sample.offsetUs << " us; delay = " << (long)sample.delayUs << " us" << endl) // *** DEBUG ***
+
+         // Once a majority has replied, only wait a little longer for the others.
+         if (!gathering && ((2 * filter.get_Count()) > sent))
+            {
+            gathering = true;
+            int64_t gather = std::max(sample.delayUs, (int64_t)NTP_GATHER_MIN_MS * 1000LL);
+            deadline = std::min(deadline, t4 + gather);
+            }
+         }
+
+      giveSocket(sendFailed);
+
+      int64_t offsetUs = 0;
+      size_t best = 0;
+      result.samples = (uint8_t)filter.get_Count();
+      if (filter.Select(offsetUs, best))
+         {
+         const NtpSample& sample = filter.get_Sample(best);
+         uint32_t kissCode = result.kissCode;            // Keep any KoD and the poll the server asked for.
+         int8_t kissPoll = (int8_t)result.packet.poll;
+         result.packet = replies[sample.server];
+         strncpy(result.serverUsed, servers[sample.server].c_str(), sizeof(result.serverUsed) - 1);
+         result.serverAddress = addresses[sample.server];
+         result.t1 = requests[sample.server].t1;
+         result.t4 = receiveTimes[sample.server];
+         checkReply(result);
+         result.kissCode = kissCode;
+         if ((kissCode != 0) && (kissPoll > (int8_t)result.packet.poll))
+            { result.packet.poll = (uint8_t)kissPoll; }
+         result.offsetUs = offsetUs;
+         result.survivors = 0;
+         for (size_t i = 0; i < filter.get_Count(); i++)
+            {
+            if (filter.get_Survivors() & (1U << i)) 
+               { result.survivors |= (uint16_t)(1U << filter.get_Sample(i).server); }
+            }
+         result.dateTime = DateTime((uint32_t)((result.t4 + result.offsetUs) / 1000000LL));
+
+         LOG_NTP_INFO("QueryServers(): " << (int)result.samples << " replies; best: " << result.serverUsed << "; offset = " << (long)result.offsetUs 
+               << " us; survivors: 0x" << _HEX(result.survivors) << endl)
+         }
+      else
+         {
+         result.success = false;
+         result.error = (filter.get_Count() > 0) ? NtpError::NoMajority 
+               : ((result.kissCode != 0) ? NtpError::InvalidReply : ((sent > 0) ? NtpError::NoReply : NtpError::SendFailed));
+         LOG_NTP_WARN("QueryServers(): " << NtpErrorText(result.error) << endl)
+         }
+
+      return result;
+      }
+
+   int BinaryClockNTP::takeSocket(uint32_t timeoutMs)
+      {
+      BinaryClockNTP& ntp = get_Instance();
+      if ((ntp.queryMutex == nullptr) || (xSemaphoreTake(ntp.queryMutex, portMAX_DELAY) != pdTRUE)) { return -1; }
+
+      if (ntp.querySock < 0)
+         {
+         ntp.querySock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+         if (ntp.querySock < 0)
+            {
+            xSemaphoreGive(ntp.queryMutex);
+            return -1;
+            }
+         LOG_NTP_DEBUG("takeSocket(): NTP query socket opened." << endl) // *** DEBUG ***
+         }
+
+      // Discard a late reply to the last query, it would only be read and ignored.
+      NtpPacket late;
+      while (recv(ntp.querySock, &late, sizeof(late), MSG_DONTWAIT) >= 0)
+         { ; }
+
+      struct timeval tv = { (time_t)(timeoutMs / 1000), (suseconds_t)((timeoutMs % 1000) * 1000) };
+      setsockopt(ntp.querySock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      return ntp.querySock;
+      }
+
+   void BinaryClockNTP::giveSocket(bool failed)
+      {
+      BinaryClockNTP& ntp = get_Instance();
+      if (failed && (ntp.querySock >= 0))
+         {
+         close(ntp.querySock);   // E.g. the interface went down, the next query opens a new one.
+         ntp.querySock = -1;
+         }
+
+      xSemaphoreGive(ntp.queryMutex);
+      }
+
+   const char* NtpErrorText(NtpError error)
+      {
+      switch (error)
+         {
+         case NtpError::None:          return "No error";
+         case NtpError::NoServer:      return "No NTP server name";
+         case NtpError::DnsFailed:     return "DNS lookup failed";
+         case NtpError::SocketFailed:  return "Unable to create the UDP socket";
+         case NtpError::SendFailed:    return "Unable to send the NTP request";
+         case NtpError::NoReply:       return "NTP sync failed - no reply from server";
+         case NtpError::InvalidReply:  return "NTP server reply is not valid (unsynchronized or KoD)";
+         case NtpError::NoMajority:    return "NTP sync failed - the servers don't agree on the time";
+         default:                      return "Unknown error";
+         }
+      }
+
+   bool BinaryClockNTP::checkReply(NTPResult& result)
+      {
+      const NtpPacket& packet = result.packet;
+      result.success = (packet.mode == 4) && (packet.li != 3) && (packet.stratum != 0) && (packet.txTime.intpart32u != 0);
+      result.kissCode = ((packet.mode == 4) && (packet.stratum == 0)) ? ntohl(packet.refId) : 0U;
       if (result.success)
          {
-         // Successful sync
-         time_t now = utcTime.unixtime();
-         struct tm timeinfo = { 0 };
+         result.t2 = NtpToMicros(packet.recTime);
+         result.t3 = NtpToMicros(packet.txTime);
+         result.offsetUs = ((result.t2 - result.t1) + (result.t3 - result.t4)) / 2;
+         result.delayUs  = (result.t4 - result.t1) - (result.t3 - result.t2);
+         }
 
-         struct tm* localTimeInfo = localtime_r(&now, &timeinfo);
+      return result.success;
+      }
+
+   NTPResult BinaryClockNTP::SyncTime()
+      {
+      static const String defaultServer(NTP_SERVER_1);   // A reference below, the name isn't copied for each sync.
+      #if NTP_HEAP_CHECK
+      int64_t startUs = esp_timer_get_time();
+      if (ntpHeap.syncs == 1)
+         {
+         ntpHeap.free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+         ntpHeap.minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+         ntpHeap.us = 0;
+         }
+      #endif
+
+      NTPResult result;
+      if (ntpServers.size() <= 1)
+         { result = SyncTime(ntpServers.empty() ? defaultServer : ntpServers[0]); }
+      else
+         {
+         result = QueryServers(ntpServers);
+         applyResult(result);
+         }
+
+      #if NTP_HEAP_CHECK
+      ntpHeap.us += esp_timer_get_time() - startUs;
+      LOG_NTP_DEBUG("SyncTime(): round trip " << (long)(result.t4 - result.t1) << " us" << endl) // *** DEBUG ***
+      if (((ntpHeap.syncs > 0) || result.success) && (++ntpHeap.syncs == NTP_HEAP_SYNCS + 1))
+         {
+         LOG_NTP_DEBUG("SyncTime(): " << NTP_HEAP_SYNCS << " syncs, " << (long)(ntpHeap.us / NTP_HEAP_SYNCS) << " us each; free heap "
+                       << ntpHeap.free << " -> " << heap_caps_get_free_size(MALLOC_CAP_DEFAULT) << " bytes, lowest "
+                       << ntpHeap.minFree << " -> " << heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT) << endl) // *** DEBUG ***
+         }
+      #endif
+
+      updatePoll(result.success, result.offsetUs, result.kissCode, (int8_t)result.packet.poll);
+      if (result.success)
+         {
+         BCMetrics::get_Instance().Set(BCMetric::NtpDelayUs, BCMetrics::Clamp(result.delayUs));
+         // The system clock was just set, the event is at the end of its UTC month.
+         if (leap.Update(result.packet.li, SystemMicros() / 1000000LL))
+            { LOG_NTP_INFO("SyncTime(): leap second " << (int)leap.get_Leap() << " at UTC " << (unsigned long)leap.get_EventS() << endl) }
+         SignalEvent(NtpEvents::Synced);
+         }
+      RefreshDns();   // After the clock is set, off the time critical path.
+      return result;
+      }
+
+   NTPResult BinaryClockNTP::SyncTime(const String& serverName, uint16_t port, uint32_t timeoutMs)
+      {
+      NTPResult result = QueryServer(serverName, port, timeoutMs);
+      applyResult(result);
+      return result;
+      }
+
+   bool BinaryClockNTP::ResolveServer(const String& serverName, uint32_t& address, bool& stale)
+      {
+      stale = false;
+      struct in_addr numeric;
+      if (inet_aton(serverName.c_str(), &numeric) != 0)
+         {
+         address = numeric.s_addr;   // An IP address, nothing to resolve.
+         return true;
+         }
+
+      BinaryClockNTP& ntp = get_Instance();
+      DnsLookup lookup = DnsLookup::Miss;
+      if (xSemaphoreTake(ntp.dnsMutex, portMAX_DELAY) == pdTRUE)
+         {
+         lookup = ntp.dnsCache.Lookup(serverName.c_str(), millis(), address);
+         xSemaphoreGive(ntp.dnsMutex);
+         }
+
+      if (lookup != DnsLookup::Miss)
+         {
+         stale = (lookup == DnsLookup::Stale);
+         return true;
+         }
+
+      return lookupServer(serverName.c_str(), address);
+      }
+
+   void BinaryClockNTP::RefreshDns()
+      {
+      char name[DNS_CACHE_NAME_SIZE];
+      for (size_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+         {
+         bool due = false;
+         if (xSemaphoreTake(dnsMutex, portMAX_DELAY) == pdTRUE)
+            {
+            due = dnsCache.GetDue(i, millis(), name);
+            xSemaphoreGive(dnsMutex);
+            }
+
+         uint32_t address = 0;
+         if (due && !lookupServer(name, address))
+            { LOG_NTP_WARN("RefreshDns(): DNS lookup failed for: " << name << ", keeping the last address." << endl) }
+         }
+
+      LOG_NTP_DEBUG("RefreshDns(): hit rate " << dnsCache.GetHitRate() << "%; hits " << dnsCache.get_Hits() << "; stale " << dnsCache.get_Stale()
+                    << "; misses " << dnsCache.get_Misses() << "; failures " << dnsCache.get_Failures() << endl) // *** DEBUG ***
+      }
+
+   bool BinaryClockNTP::lookupServer(const char* serverName, uint32_t& address)
+      {
+      uint32_t ttlS = DNS_CACHE_DEFAULT_TTL_S;
+      bool resolved = queryDns(serverName, address, ttlS);
+      if (!resolved)
+         {
+         IPAddress serverIP;   // No TTL, the default is used.
+         resolved = WiFi.hostByName(serverName, serverIP) && ((uint32_t)serverIP != 0);
+         address = (uint32_t)serverIP;
+         ttlS = DNS_CACHE_DEFAULT_TTL_S;
+         }
+
+      BinaryClockNTP& ntp = get_Instance();
+      if (xSemaphoreTake(ntp.dnsMutex, portMAX_DELAY) == pdTRUE)
+         {
+         if (resolved)
+            { ntp.dnsCache.Store(serverName, address, ttlS, millis()); }
+         else
+            { ntp.dnsCache.Failed(); }
+         xSemaphoreGive(ntp.dnsMutex);
+         }
+
+      return resolved;
+      }
+
+   bool BinaryClockNTP::queryDns(const char* name, uint32_t& address, uint32_t& ttlS)
+      {
+      uint32_t dnsServer = (uint32_t)WiFi.dnsIP(0);
+      uint8_t query[DNS_QUERY_SIZE];
+      uint16_t id = (uint16_t)esp_random();
+      size_t length = DnsCache::MakeQuery(name, id, query, sizeof(query));
+      if ((dnsServer == 0) || (length == 0)) { return false; }
+
+      int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      if (sock < 0) { return false; }
+
+      struct timeval tv = { (time_t)(DNS_QUERY_TIMEOUT_MS / 1000), (suseconds_t)((DNS_QUERY_TIMEOUT_MS % 1000) * 1000) };
+      setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+      struct sockaddr_in server = { };
+      server.sin_family = AF_INET;
+      server.sin_port = htons(DNS_PORT);
+      server.sin_addr.s_addr = dnsServer;
+
+      // Sent twice, a UDP query or reply can be lost.
+      uint8_t message[DNS_MESSAGE_SIZE];
+      DnsReply reply = DnsReply::Invalid;
+      for (int attempt = 0; (attempt < 2) && (reply == DnsReply::Invalid); attempt++)
+         {
+         if (sendto(sock, query, length, 0, (struct sockaddr*)&server, sizeof(server)) != (int)length) { break; }
+
+         uint32_t startMs = millis();
+         while ((reply == DnsReply::Invalid) && ((millis() - startMs) < DNS_QUERY_TIMEOUT_MS))
+            {
+            struct sockaddr_in from = { };
+            socklen_t fromLength = sizeof(from);
+            int received = recvfrom(sock, message, sizeof(message), 0, (struct sockaddr*)&from, &fromLength);
+            if (received < 0) { break; }   // Timed out.
+
+            // Only the DNS server's reply to this query.
+            if (from.sin_addr.s_addr == dnsServer)
+               { reply = DnsCache::ParseReply(message, (size_t)received, id, address, ttlS); }
+            }
+         }
+
+      close(sock);
+      return (reply == DnsReply::Address);
+      }
+
+   bool BinaryClockNTP::applyResult(NTPResult& result)
+      {
+      if (result.success)
+         {
+         // Correct the system time by the offset, then wait for the next whole second so
+         // the caller writes the RTC on the boundary, the RTC only holds whole seconds.
+         int64_t now = SystemMicros() + result.offsetUs;
+         struct timeval tv = { (time_t)(now / 1000000LL), (suseconds_t)(now % 1000000LL) };
+         result.success = (settimeofday(&tv, NULL) == 0);
+
+         uint32_t waitUs = 1000000UL - (uint32_t)tv.tv_usec;
+         if (waitUs > 2000UL) 
+            { vTaskDelay(pdMS_TO_TICKS((waitUs - 1000UL) / 1000UL)); }
+         while ((SystemMicros() / 1000000LL) == (int64_t)tv.tv_sec)
+            { ; }  // Less than a tick, spin to the boundary.
+
+         time_t second = (time_t)(SystemMicros() / 1000000LL);
+         struct tm timeinfo = { 0 };
+         localtime_r(&second, &timeinfo);
 
          DateTime local = DateTime(timeinfo);
          // Check if we have valid time, otherwise return the UTC time.
          if (!local.isValid())
-            { local = utcTime; }
+            { local = DateTime((uint32_t)second); }
 
          result.dateTime = local;
-         result.serverUsed = serverName;
-
-         SERIAL_STREAM("[" << millis() << "] NTP sync successful!" << endl)
-         SERIAL_STREAM(" Time: " << result.dateTime.timestamp(DateTime::TIMESTAMP_DATETIME) << endl)
-         SERIAL_STREAM(" Server: " << result.serverUsed << endl)
-         SERIAL_STREAM(" Round trip: " << (endTime - startTime) << "ms" << endl)
-         struct timeval tv = ntpToTimeval(packet.txTime);
-         int setRes = settimeofday(&tv, NULL);
-         result.success = (setRes == 0);
-         DateTime internal(now);
-         SERIAL_STREAM("Internal: " << internal.timestamp(DateTime::TIMESTAMP_DATETIME) << endl)
+
+         LOG_NTP_INFO("[" << millis() << "] NTP sync successful!" << endl)
+         LOG_NTP_DEBUG(" Time: " << result.dateTime.timestamp(DateTime::TIMESTAMP_DATETIME) << endl)   // *** DEBUG *** A `String` on the heap.
+         LOG_NTP_INFO(" Server: " << result.serverUsed << endl)
+         LOG_NTP_INFO(" Offset: " << (long)result.offsetUs << " us; Round trip: " << (long)result.delayUs << " us" << endl)
          }
       else
          {
-         result.errorMessage = "NTP sync failed - no valid time received";
+         LOG_NTP_WARN("SyncTime(" << result.serverUsed << "): " << NtpErrorText(result.error) << endl)
          }
 
-      return result;
+      return result.success;
+      }
+
+   void BinaryClockNTP::updatePoll(bool success, int64_t offsetUs, uint32_t kissCode, int8_t serverPoll)
+      {
+      int64_t timerUs = esp_timer_get_time();
+      uint32_t interval = pollController.get_Interval();
+
+      BCMetrics& metrics = BCMetrics::get_Instance();
+      metrics.Add(success ? BCMetric::NtpSyncs : BCMetric::NtpFailures);
+      if (success) { metrics.Set(BCMetric::NtpOffsetUs, BCMetrics::Clamp(offsetUs)); }
+
+      if (success && (pollTimerUs != 0))
+         {
+         uint32_t elapsedS = (uint32_t)((timerUs - pollTimerUs) / 1000000LL);
+         interval = pollController.Update(offsetUs, elapsedS);
+         }
+      else if (!success && (kissCode == 0))
+         { interval = pollController.Failed(); }
+
+      if (kissCode != 0)
+         {
+         // RATE: poll less often; DENY / RSTR: the server doesn't want us, poll as little as possible.
+         char code[5] = { (char)(kissCode >> 24), (char)(kissCode >> 16), (char)(kissCode >> 8), (char)kissCode, '\0' };
+         interval = pollController.RateLimit((kissCode == NTP_KISS_RATE) ? serverPoll : (int8_t)NTP_MAX_POLL);
+         LOG_NTP_WARN("updatePoll(): Kiss-o'-Death \"" << code << "\" received, poll 2^" << (int)pollController.get_Poll() << " s" << endl)
+         }
+
+      if (success)
+         {
+         pollTimerUs = timerUs;
+         pollSystemUs = SystemMicros();
+         }
+
+      if (adaptivePoll)
+         {
+         set_SyncInterval(interval * 1000UL);
+         if (initialized && !manualSync) { sntp_set_sync_interval(syncInterval); }
+         }
+
+      LOG_NTP_INFO("[" << millis() << "] NTP poll: offset = " << (long)offsetUs << " us; jitter = " << pollController.get_Jitter() 
+            << " us; drift = " << pollController.get_DriftPpb() << " ppb; next sync in " << interval << " s (2^" << (int)pollController.get_Poll() 
+            << (adaptivePoll ? ")" : ", not adaptive)") << endl)
       }
 
    bool BinaryClockNTP::RegisterSyncCallback(std::function<void(const DateTime&)> callback)
       {
       if (!callback || syncCallback) { return false; }
 
-      SERIAL_PRINTLN("BinaryClockNTP::RegisterSyncCallback() - callback registered.") // *** DEBUG ***
+      LOG_NTP_DEBUG("BinaryClockNTP::RegisterSyncCallback() - callback registered." << endl) // *** DEBUG ***
       syncCallback = callback;
       return true;
       }
@@ -370,37 +920,11 @@ namespace BinaryClockShield
       {
       DateTime result = DateTime::DateTimeEpoch;
 
-      WiFiUDP udp;
-      NtpPacket packet = { 0 };
-      // packet.li_vn_mode = 0b00100011;  // LI = 0, VN = 4, Mode = 3 (client mode)
-      packet.mode = 3;
-      packet.vn = 4;
-      packet.li = 0;
-
-      int resBegin = udp.beginPacket((ntpServers.empty() ? NTP_SERVER_1 : ntpServers[0].c_str()), NTP_DEFAULT_PORT);
-      int resWrite = udp.write((const uint8_t*)&packet, sizeof(packet));
-      int resEnd   = udp.endPacket();
+      NTPResult query = QueryServer((ntpServers.empty() ? String(NTP_SERVER_1) : ntpServers[0]), NTP_DEFAULT_PORT, NTP_REPLY_TIMEOUT_MS);
+      if (query.success)
+         { result = query.dateTime; }
 
-      int count = 0;
-      while (udp.peek() < 0 && count < 10)
-         { 
-         vTaskDelay(pdMS_TO_TICKS(100)); 
-         count++;
-         }
-
-      SERIAL_PRINTF("get_CurrentNtpTime(): UDP beginPacket=%d, write=%d, endPacket=%d, waitCount=%d\n", resBegin, resWrite, resEnd, count)  // *** DEBUG ***
-      if (udp.parsePacket() >= sizeof(packet))
-         {
-         udp.read((uint8_t*)&packet, sizeof(packet));
-
-         uint32_t unixTime = ntpToUnix(packet.txTime);
-
-         // Convert to DateTime
-         result = DateTime(unixTime);
-         }
-
-      udp.stop();
-      SERIAL_PRINTLN("get_CurrentNtpTime(): NTP time = " + result.timestamp(DateTime::TIMESTAMP_DATETIME12)) // *** DEBUG ***
+      LOG_NTP_DEBUG(("get_CurrentNtpTime(): NTP time = " + result.timestamp(DateTime::TIMESTAMP_DATETIME12)) << endl) // *** DEBUG ***
 
       return result;
       }
@@ -418,7 +942,7 @@ namespace BinaryClockShield
       if (!result.isValid())
          { result = utcTime; }
 
-      SERIAL_PRINTLN("get_LocalNtpTime(): Local   time = " + result.timestamp(DateTime::TIMESTAMP_DATETIME12)) // *** DEBUG ***
+      LOG_NTP_DEBUG(("get_LocalNtpTime(): Local   time = " + result.timestamp(DateTime::TIMESTAMP_DATETIME12)) << endl) // *** DEBUG ***
 
       return result;
       }
@@ -439,7 +963,7 @@ namespace BinaryClockShield
       {
       if (!initialized)
          {
-         SERIAL_STREAM("Warning: BinaryClockNTP not initialized - call initialize() first" << endl)
+         LOG_NTP_WARN("Warning: BinaryClockNTP not initialized - call initialize() first" << endl)
          return;
          }
 
@@ -452,8 +976,8 @@ namespace BinaryClockShield
       if (esp_sntp_enabled())
          {
          esp_sntp_stop();
-         SERIAL_STREAM("[" << millis() << "] ")  // *** DEBUG ***
-         SERIAL_STREAM("SNTP stopped" << endl)   // *** DEBUG ***
+         LOG_NTP_DEBUG("[" << millis() << "] ")  // *** DEBUG ***
+         LOG_NTP_DEBUG("SNTP stopped" << endl)   // *** DEBUG ***
          }
       }
 
@@ -463,31 +987,38 @@ namespace BinaryClockShield
       lastSyncStatus = true;
       unsigned long curMillis = millis();
       
-      SERIAL_STREAM("[" << curMillis << "] ")  // *** DEBUG ***
-         SERIAL_STREAM("processTimeSync() - NTP time sync notification received. Delta: " << (curMillis - lastSyncMillis) << " ms" << endl) // *** DEBUG ***
+      LOG_NTP_DEBUG("[" << curMillis << "] ")  // *** DEBUG ***
+         LOG_NTP_DEBUG("processTimeSync() - NTP time sync notification received. Delta: " << (curMillis - lastSyncMillis) << " ms" << endl) // *** DEBUG ***
       DateTime utcTime(tv->tv_sec); // *** DEBUG ***
-      SERIAL_STREAM("[" << curMillis << "] ")  // *** DEBUG ***
-      SERIAL_STREAM("Current time from NTP: " << utcTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl) // *** DEBUG ***
+      LOG_NTP_DEBUG("[" << curMillis << "] ")  // *** DEBUG ***
+      LOG_NTP_DEBUG("Current time from NTP: " << utcTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl) // *** DEBUG ***
 
       // Convert utc timeval to `DateTime` in local timezone.
       time_t now = tv->tv_sec;
       struct tm timeinfo = { 0 };
       struct tm* localTimeInfo = localtime_r(&now, &timeinfo);
 
+      // The SNTP service has already set the clock, the correction it made is the time elapsed
+      // on the system clock less the time elapsed on the monotonic timer since the last correction.
+      int64_t syncUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+      int64_t offsetUs = (pollTimerUs != 0) ? ((syncUs - pollSystemUs) - (esp_timer_get_time() - pollTimerUs)) : 0;
+      updatePoll(true, offsetUs);
+      SignalEvent(NtpEvents::Synced);
+
       lastSyncMillis = millis();
       lastSyncTimeval = *tv;
       lastSyncDateTime = DateTime(timeinfo);
-      SERIAL_STREAM("[" << millis() << "] ")  // *** DEBUG ***
-      SERIAL_STREAM("Local   time from NTP: " << lastSyncDateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl) // *** DEBUG ***
+      LOG_NTP_DEBUG("[" << millis() << "] ")  // *** DEBUG ***
+      LOG_NTP_DEBUG("Local   time from NTP: " << lastSyncDateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl) // *** DEBUG ***
 
       if (syncCallback && callbacksEnabled)  // <-- CRITICAL: Only invoke if callbacks are enabled
          {
-         SERIAL_STREAM("[" << millis() << "] Invoking sync callback..." << endl)  // *** DEBUG ***
+         LOG_NTP_DEBUG("[" << millis() << "] Invoking sync callback..." << endl)  // *** DEBUG ***
 
          try
             {
             syncCallback(lastSyncDateTime);
-            SERIAL_STREAM("[" << millis() << "] Sync callback completed successfully." << endl)  // *** DEBUG ***
+            LOG_NTP_DEBUG("[" << millis() << "] Sync callback completed successfully." << endl)  // *** DEBUG ***
             }
          catch (const std::exception& e)
             {
@@ -500,13 +1031,13 @@ namespace BinaryClockShield
          }
       else
          {
-         SERIAL_STREAM("[" << millis() << "] No sync callback registered, nothing to call." << endl)   // *** DEBUG ***
+         LOG_NTP_DEBUG("[" << millis() << "] No sync callback registered, nothing to call." << endl)   // *** DEBUG ***
          }
      
       char timeStr[64];
       strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-      SERIAL_STREAM("[" << millis() << "] ")  // *** DEBUG ***
-      SERIAL_STREAM("Synchronized time: " << timeStr << endl << endl)   // *** DEBUG ***
+      LOG_NTP_DEBUG("[" << millis() << "] ")  // *** DEBUG ***
+      LOG_NTP_DEBUG("Synchronized time: " << timeStr << endl << endl)   // *** DEBUG ***
       }
 
    time_t BinaryClockNTP::ntpToUnix(uint32_t ntpSeconds, uint32_t ntpFraction, bool round)
@@ -545,6 +1076,28 @@ namespace BinaryClockShield
       return tv;
       }
 
+   int64_t BinaryClockNTP::NtpToMicros(fixedpoint64 ntpTime)
+      {
+      uint32_t seconds  = ntohl(ntpTime.intpart32u);
+      uint32_t fraction = ntohl(ntpTime.frac32u);
+      // Era 0 ends in 2036, the small values are in era 1 (the same rule as `ntpToUnix()`).
+      int64_t unixSeconds = (seconds >= NtpTimestampDelta) 
+            ? (int64_t)(seconds - NtpTimestampDelta) 
+            : (int64_t)seconds + (0x100000000LL - NtpTimestampDelta);
+
+      return unixSeconds * 1000000LL + (int64_t)(((uint64_t)fraction * 1000000ULL) >> 32);
+      }
+
+   fixedpoint64 BinaryClockNTP::MicrosToNtp(int64_t micros)
+      {
+      fixedpoint64 result;
+      uint64_t seconds = (uint64_t)(micros / 1000000LL);
+      uint64_t fraction = (((uint64_t)(micros % 1000000LL)) << 32) / 1000000ULL;
+      result.intpart32u = htonl((uint32_t)(seconds + NtpTimestampDelta));
+      result.frac32u = htonl((uint32_t)fraction);
+      return result;
+      }
+
    uint32_t BinaryClockNTP::swapEndian(uint32_t value)
       {
       // Convert from little-endian to big-endian or vice versa
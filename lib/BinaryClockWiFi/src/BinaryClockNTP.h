@@ -34,16 +34,40 @@
 #include <functional> 
 
 #include <WiFi.h>                      /// For WiFi connectivity class: `WiFiClass`
-#include <WiFiUdp.h>                   /// For WiFi UDP class: `WiFiUDP`
 #include <esp_sntp.h>                  /// For ESP-IDF SNTP functions and types.
 
 #include "DateTime.h"                  /// DateTime and TimeSpan classes (part of RTClibPlus library).
 #include "TaskGroupBits.h"             /// For TaskGroupBits class to manage event group bits
+#include "NtpClockFilter.h"            /// For NtpClockFilter class to select the time from several servers.
+#include "NtpPollController.h"         /// For NtpPollController class, the adaptive sync interval.
+#include "DnsCache.h"                  /// For DnsCache class, the resolved addresses of the servers.
+#include "LeapSecond.h"                /// For LeapSecond class, the leap second announced by the servers.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"           /// For the `dnsMutex` and `queryMutex`, the servers are queried from several tasks.
 
 #define NTP_PACKET_SIZE             48             ///< NTP time stamp is in the first 48 bytes of the message
 #define DEFAULT_NTP_TIMEOUT_MS      (10 * SECONDS_MS) ///< Default NTP server connection timeout in ms (e.g. 10 sec).
 #define SNTP_SYNC_INTERVAL_MS       (3 * HOURS_MS)    ///< SNTP default sync interval in milliseconds (e.g. 900 sec, 15 min).
 #define NTP_UNIX_EPOCS_DELTA        2208988800UL   ///< Difference between NTP (1900/01/01) and Unix (1970/01/01) epochs in seconds
+#ifndef NTP_REPLY_TIMEOUT_MS
+   #define NTP_REPLY_TIMEOUT_MS     1000U          ///< The time to wait on the socket for a NTP server reply in ms.
+#endif
+#ifndef NTP_SERVER_NAME_SIZE
+   #define NTP_SERVER_NAME_SIZE     64U            ///< The size of the server name in `NTPResult`, a longer one is truncated.
+#endif
+#ifndef NTP_GATHER_MIN_MS
+   #define NTP_GATHER_MIN_MS        25U            ///< Minimum time to wait for the other servers after the first reply in ms.
+#endif
+
+#ifndef NTP_ADAPTIVE_POLL
+   #define NTP_ADAPTIVE_POLL        true           ///< true: `SyncTime()` adapts the sync interval to the measured drift.
+#endif
+
+// Kiss-o'-Death codes (RFC 5905 7.4): the `refId` of a stratum 0 reply, 4 ASCII characters (host order).
+#define NTP_KISS_RATE               0x52415445UL   ///< "RATE" - Polling too often, poll less often.
+#define NTP_KISS_DENY               0x44454E59UL   ///< "DENY" - Access denied, stop polling the server.
+#define NTP_KISS_RSTR               0x52535452UL   ///< "RSTR" - Access restricted, stop polling the server.
 
 #define NTP_SERVER_1 "time.nrc.ca"     ///< The primary NTP server
 #define NTP_SERVER_2 "pool.ntp.org"    ///< The secondary NTP server
@@ -305,17 +329,49 @@ namespace BinaryClockShield
       fixedpoint64 txTime;             ///< Transmit timestamp
       } NtpPacket;
       
+   /// @brief The reason a NTP query or sync failed, `NtpErrorText()` has the text for the log.
+   enum class NtpError : uint8_t
+      {
+      None = 0,                        ///< No error.
+      NoServer,                        ///< The server name or list is empty.
+      DnsFailed,                       ///< The server name couldn't be resolved.
+      SocketFailed,                    ///< The UDP socket couldn't be opened.
+      SendFailed,                      ///< The request couldn't be sent.
+      NoReply,                         ///< No reply before the timeout.
+      InvalidReply,                    ///< The reply isn't usable: unsynchronized or a Kiss-o'-Death.
+      NoMajority                       ///< The servers replied but a majority don't agree on the time.
+      };
+
+   /// @brief Get the text of a `NtpError`, for the log.
+   /// @author Chris-70 (2026/10)
+   const char* NtpErrorText(NtpError error);
+
    /// @brief Result structure for NTP synchronization.
    /// @brief This structure contains the result of an NTP synchronization attempt,
    ///        including the NTP packet received, success status, synchronized date and time,
    ///        the server used, and any error messages.
+   /// @details The four timestamps are the client transmit (T1), server receive (T2), server
+   ///          transmit (T3) and client receive (T4) times in microseconds since 1970-01-01 (UTC).
+   ///          The client times are read from the system clock.
+   ///          - offset = ((T2 - T1) + (T3 - T4)) / 2, the server time minus the system time.
+   ///          - delay  = (T4 - T1) - (T3 - T2), the network round trip without the server time.
    struct NTPResult
       {
       NtpPacket packet = { 0 };        ///< The NtpPacket from UPD call to NTP server.
       bool success = false;            ///< True if synchronization was successful
       DateTime dateTime;               ///< The synchronized date and time (local)
-      String serverUsed;               ///< Which server provided the time
-      String errorMessage;             ///< Error description if failed
+      char serverUsed[NTP_SERVER_NAME_SIZE] = { 0 }; ///< Which server provided the time
+      uint32_t serverAddress = 0;      ///< The IPv4 address (network order) of `serverUsed`, the reference ID served.
+      NtpError error = NtpError::None; ///< Why it failed, `NtpErrorText()` for the text.
+      int64_t t1 = 0;                  ///< Client transmit time (T1) in µs.
+      int64_t t2 = 0;                  ///< Server receive time (T2) in µs.
+      int64_t t3 = 0;                  ///< Server transmit time (T3) in µs.
+      int64_t t4 = 0;                  ///< Client receive time (T4) in µs.
+      int64_t offsetUs = 0;            ///< The clock offset, server - system time, in µs.
+      int64_t delayUs = 0;             ///< The round trip delay in µs.
+      uint8_t samples = 0;             ///< The number of valid server replies used (`QueryServers()`).
+      uint16_t survivors = 0;          ///< Bit `n` set: server `n` agreed with the time (`QueryServers()`).
+      uint32_t kissCode = 0;           ///< The Kiss-o'-Death code of a stratum 0 reply (e.g. `NTP_KISS_RATE`), 0 if none.
       };
 
    /// @brief NTP Client class using ESP-IDF SNTP (Singleton pattern).   
@@ -370,22 +426,89 @@ namespace BinaryClockShield
       /// @brief End SNTP service
       void End();
 
-      /// @brief Synchronize time with a NTP server.
+      /// @brief Synchronize time with the NTP servers.
+      /// @details All the servers are queried together (`QueryServers()`), the time is the
+      ///          one the majority of them agree on. The offset measured is passed to the
+      ///          poll controller which sets the next sync interval when `AdaptivePoll` is set.
       /// @return `NTPResult` structure: result of the synchronization attempt
-      NTPResult SyncTime()
-         {
-         String server = (ntpServers.empty() ? NTP_SERVER_1 : ntpServers[0]);
-         return SyncTime(server);
-         }
+      /// @see QueryServers()
+      /// @see set_AdaptivePoll()
+      NTPResult SyncTime();
 
       /// @brief Synchronize the internal time with a specific NTP server.
       /// @details This method synchronizes the internal time with the specified NTP server.
-      ///          The metod sends a NTP request to the server, the resulting time is
-      ///          converted to local time based on the timezone set.
+      ///          The metod sends a NTP request to the server (`QueryServer()`) and corrects
+      ///          the system time by the measured offset, to the microsecond. It then waits for
+      ///          the next whole second so the `dateTime` returned can be written to the RTC
+      ///          on the second boundary. The time is converted to local time based on the 
+      ///          timezone set.
       /// @param serverName The name of the NTP server to synchronize internal time with.
       /// @param port The port number to use for the NTP server, default is `NTP_DEFAULT_PORT`.
+      /// @param timeoutMs The time to wait for the reply in ms. {NTP_REPLY_TIMEOUT_MS}
       /// @return `NTPResult` structure: result of the synchronization attempt
-      static NTPResult SyncTime(const String& serverName, uint16_t port = NTP_DEFAULT_PORT);
+      /// @see QueryServer()
+      static NTPResult SyncTime(const String& serverName, uint16_t port = NTP_DEFAULT_PORT, uint32_t timeoutMs = NTP_REPLY_TIMEOUT_MS);
+
+      /// @brief Send one NTP request and measure the offset and delay, the clock isn't changed.
+      /// @details The request transmit time (T1) is checked against the originate time in the 
+      ///          reply to reject old or spoofed replies. The socket waits for the reply with
+      ///          a timeout, it doesn't poll. The name is resolved from the DNS cache (`ResolveServer()`),
+      ///          if a stale address doesn't reply the name is resolved again and the query retried once.
+      /// @param serverName The name or IP address of the NTP server.
+      /// @param port The port number to use for the NTP server, default is `NTP_DEFAULT_PORT`.
+      /// @param timeoutMs The time to wait for the reply in ms. {NTP_REPLY_TIMEOUT_MS}
+      /// @return `NTPResult` structure with the four timestamps, offset and delay; `dateTime` is
+      ///         the server UTC time at T4.
+      /// @author Chris-70 (2026/10)
+      static NTPResult QueryServer(const String& serverName, uint16_t port = NTP_DEFAULT_PORT, uint32_t timeoutMs = NTP_REPLY_TIMEOUT_MS);
+
+      /// @brief Query all the servers together on one socket and select the time they agree on.
+      /// @details The requests are sent back to back, the replies are collected until they have all
+      ///          arrived, the deadline `timeoutMs` expires or, once a majority has replied, for the
+      ///          longer of the last round trip or `NTP_GATHER_MIN_MS`. So the time taken is set by
+      ///          the fastest servers, not the sum of the timeouts. The samples are selected by
+      ///          `NtpClockFilter` (intersection algorithm): servers that disagree with the majority
+      ///          are discarded and the offset is the weighted average of the others. The clock isn't changed.
+      /// @param servers The names or IP addresses of the servers, at most `NTP_MAX_SAMPLES` are used.
+      /// @param port The port number to use for the NTP servers, default is `NTP_DEFAULT_PORT`.
+      /// @param timeoutMs The deadline for the replies in ms. {NTP_REPLY_TIMEOUT_MS}
+      /// @return `NTPResult` structure with the combined offset, the timestamps, delay, `packet` and
+      ///         `serverUsed` are from the best server (smallest root distance).
+      /// @see NtpClockFilter
+      /// @author Chris-70 (2026/10)
+      static NTPResult QueryServers(const std::vector<String>& servers, uint16_t port = NTP_DEFAULT_PORT, uint32_t timeoutMs = NTP_REPLY_TIMEOUT_MS);
+
+      /// @brief Get the address of a NTP server from the DNS cache, resolve it if it isn't cached.
+      /// @details An IP address is used as is. A cached address is used within its TTL and, while
+      ///          DNS is down or until `RefreshDns()`, after it (stale). A name not cached is resolved
+      ///          now: the A query is sent to the network's DNS server for the TTL, `WiFi.hostByName()`
+      ///          if there is no reply.
+      /// @param serverName The name or IP address of the NTP server.
+      /// @param address Returns the IPv4 address (network order).
+      /// @param stale Returns true if the address is stale.
+      /// @return True if there is an address.
+      /// @see DnsCache
+      /// @author Chris-70 (2026/10)
+      static bool ResolveServer(const String& serverName, uint32_t& address, bool& stale);
+
+      /// @brief Resolve again the cached names that are stale or about to be, after a sync.
+      /// @details Called by `SyncTime()` after the clock is set so the next sync finds a fresh
+      ///          address; the last known good address is kept if DNS fails.
+      void RefreshDns();
+
+      /// @brief Convert a NTP timestamp (network byte order) to microseconds since 1970-01-01.
+      static int64_t NtpToMicros(fixedpoint64 ntpTime);
+
+      /// @brief Convert microseconds since 1970-01-01 to a NTP timestamp (network byte order).
+      static fixedpoint64 MicrosToNtp(int64_t micros);
+
+      /// @brief Read the system clock in microseconds since 1970-01-01.
+      static int64_t SystemMicros()
+         {
+         struct timeval tv;
+         gettimeofday(&tv, nullptr);
+         return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+         }
 
       /// @brief Register a callback function to be called on successful time sync.
       /// @details This method registers a callback function that will be called
@@ -514,6 +637,54 @@ namespace BinaryClockShield
       unsigned long get_SyncInterval() const
          { return syncInterval; }
 
+      /// @brief Property: AdaptivePoll - The sync interval adapts to the measured offset and drift.
+      /// @details When set, each sync feeds `NtpPollController` which sets the sync interval
+      ///          (`set_SyncInterval()`) for both `SyncTime()` and the SNTP service: longer while
+      ///          the offset stays in tolerance, shorter when the offset or jitter grows and never
+      ///          shorter than a server asks for with a Kiss-o'-Death RATE reply.
+      ///          set_ : Enable (true) or disable (false) the adaptive interval.
+      ///          get_ : Get the current setting.
+      /// @see get_PollController()
+      void set_AdaptivePoll(bool value)
+         { adaptivePoll = value; }
+
+      /// @copydoc set_AdaptivePoll()
+      bool get_AdaptivePoll() const
+         { return adaptivePoll; }
+
+      /// @brief Property: ManualSync - The SNTP service isn't started, the owner calls `SyncTime()`.
+      /// @details Used when the radio is off between the syncs (`BinaryClockWAN` duty cycle), the 
+      ///          SNTP service would poll on its own timer with no network. Set before `Begin()`.
+      ///          set_ : Enable (true) or disable (false) the manual sync.
+      ///          get_ : Get the current setting.
+      void set_ManualSync(bool value)
+         { manualSync = value; }
+
+      /// @copydoc set_ManualSync()
+      bool get_ManualSync() const
+         { return manualSync; }
+
+      /// @brief Property (RO): PollController - The adaptive poll controller (poll, jitter and drift).
+      const NtpPollController& get_PollController() const
+         { return pollController; }
+
+      /// @brief Property (RO): DnsCache - The resolved server addresses and the hits, stale hits and misses.
+      /// @see DnsCache::GetHitRate()
+      const DnsCache& get_DnsCache() const
+         { return dnsCache; }
+
+      /// @brief Property (RO): Leap - The leap second announced by the leap indicator of the last sync.
+      /// @details Updated by `SyncTime()` (the SNTP service doesn't report the leap indicator).
+      const LeapSecond& get_Leap() const
+         { return leap; }
+
+      /// @brief The leap second announced was applied at the event, the system clock was stepped.
+      void LeapApplied()
+         {
+         pollSystemUs -= (int64_t)leap.get_Leap() * 1000000LL;   // The step isn't an offset of the clock.
+         leap.Applied();
+         }
+
       #define SYNC_STALE_FACTOR  475U   ///< Factor to calculate stale threshold from sync interval (approx. 2.1 times) (1000/475 = ~2.1)
       /// @brief Property (RO): SyncStaleThreshold - The threshold in seconds to consider time stale.
       /// @details The threshold in seconds to consider time stale. This is calculated as approximately 
@@ -604,6 +775,51 @@ namespace BinaryClockShield
       void SignalEvent(enum NtpEvents event);
 
    private:
+      /// @brief Correct the system time by the offset in `result` and wait for the next second.
+      /// @details Sets `result.dateTime` to the local time of the new second, the caller writes 
+      ///          it to the RTC on the second boundary. Does nothing if `result.success` is false.
+      /// @param result The result from `QueryServer()` or `QueryServers()`, updated.
+      /// @return True if the system time was set.
+      static bool applyResult(NTPResult& result);
+
+      /// @brief Check a reply packet and fill in the timestamps, offset and delay of `result`.
+      /// @return True if the reply is valid (server mode, synchronized, not a KoD).
+      static bool checkReply(NTPResult& result);
+
+      /// @brief Pass the result of a sync to the poll controller and set the next sync interval.
+      /// @details The offset is only used when the time since the previous correction is known,
+      ///          the first sync sets the clock from an unknown state. The new interval is logged
+      ///          with the offset, jitter and drift.
+      /// @param success True if the clock was corrected by `offsetUs`.
+      /// @param offsetUs The correction made in µs.
+      /// @param kissCode The Kiss-o'-Death code received, if any, e.g. `NTP_KISS_RATE`.
+      /// @param serverPoll The poll exponent from the server's reply.
+      void updatePoll(bool success, int64_t offsetUs, uint32_t kissCode = 0U, int8_t serverPoll = 0);
+
+      /// @brief Resolve a name now and store it in the DNS cache, the cached address is kept if it fails.
+      /// @param serverName The name of the NTP server.
+      /// @param address Returns the IPv4 address (network order).
+      /// @return True if the name was resolved.
+      static bool lookupServer(const char* serverName, uint32_t& address);
+
+      /// @brief Take the UDP socket of the queries, open it the first time, with the receive timeout.
+      /// @details The socket is kept open between the syncs, no socket or buffers are allocated for a
+      ///          sync. A datagram left from the last query (a late reply) is discarded.
+      /// @param timeoutMs The receive timeout in ms.
+      /// @return The socket, -1 if it can't be opened; `giveSocket()` must be called if not -1.
+      static int takeSocket(uint32_t timeoutMs);
+
+      /// @brief Give the socket back after a query.
+      /// @param failed True if a send failed, the socket is closed and opened again by the next query.
+      static void giveSocket(bool failed);
+
+      /// @brief Send the A query of a name to the network's DNS server and wait for the reply.
+      /// @param name The host name.
+      /// @param address Returns the IPv4 address (network order).
+      /// @param ttlS Returns the TTL of the address (s).
+      /// @return True if the reply has an address.
+      static bool queryDns(const char* name, uint32_t& address, uint32_t& ttlS);
+
       /// @brief Method to initialize the SNTP service using the configured NTP servers.
       /// @details This method initializes the SNTP service with the list of NTP servers
       ///          configured in the `ntpServers` member variable. It sets up the SNTP
@@ -734,7 +950,8 @@ namespace BinaryClockShield
       // EventGroupHandle_t ntpEventGroup = nullptr; ///< Event group for NTP events.
       TaskGroupBits<NtpEvents>* ntpTaskGroup = nullptr; ///< Pointer to TaskGroupBits for NTP events, used for signaling events to tasks.
 
-      WiFiUDP udp;                     ///< A `WiFiUDP` object for getting the time from the server.
+      int querySock = -1;              ///< The UDP socket of the NTP queries, kept open between the syncs.
+      SemaphoreHandle_t queryMutex = nullptr;  ///< Guards `querySock`, one query at a time.
       unsigned port = NTP_DEFAULT_PORT;   ///< The port to use for the NTP server.
       // NtpPacket ntpTime;
 
@@ -742,6 +959,16 @@ namespace BinaryClockShield
       DateTime lastSyncDateTime;          ///< The `DateTime` value at the last sync event.
       unsigned long lastSyncMillis = 0UL; ///< The value of `millis()` at the last sync event.
 
+      NtpPollController pollController;   ///< The adaptive sync interval controller.
+      bool adaptivePoll = NTP_ADAPTIVE_POLL; ///< Flag: the sync interval is set by `pollController`.
+      bool manualSync = false;            ///< Flag: the SNTP service isn't started, the owner calls `SyncTime()`.
+      int64_t pollTimerUs = 0;            ///< The monotonic timer (µs) at the last correction, 0 if none.
+      int64_t pollSystemUs = 0;           ///< The system time (µs) just after the last correction.
+
+      DnsCache dnsCache;                  ///< The resolved addresses of the servers.
+      SemaphoreHandle_t dnsMutex = nullptr;  ///< Guards `dnsCache`, the servers are resolved from several tasks.
+      LeapSecond leap;                    ///< The leap second announced, updated and applied on the sync task.
+
       /// @brief Callback user function for SNTP time sync notifications.
       /// @details This user function is called when the SNTP service receives a time sync notification.
       ///          The value is set by `RegisterSyncCallback()` and cleared by `UnregisterSyncCallback()`
@@ -0,0 +1,269 @@
+/// @file BinaryClockNtpServer.cpp
+/// @brief The implementation of the `BinaryClockNtpServer` class, a NTP server for the other clocks on the LAN.
+/// @author Chris-70 (2026/10)
+
+#include "BinaryClockNtpServer.h"
+
+#include <Streaming.h>                 /// For Serial << streaming syntax (https://github.com/janelia-arduino/Streaming)
+#include <lwip/sockets.h>             /// For the BSD socket API: socket(); bind(); recvfrom(); sendto().
+#include <time.h>                      /// For mktime(), the RTC local time to UTC.
+#include <sys/time.h>                  /// For settimeofday() and adjtime().
+
+//################################################################################//
+#ifndef SERIAL_OUTPUT
+   #define SERIAL_OUTPUT   true  // true to enable; false to disable
+#endif
+#ifndef DEV_CODE
+   #define DEV_CODE        true  // true to enable; false to disable
+#endif
+#ifndef DEBUG_OUTPUT
+   #define DEBUG_OUTPUT    true  // true to enable; false to disable
+#endif
+#ifndef PRINTF_OK
+   #define PRINTF_OK       true  // true to enable; false to disable
+#endif
+
+#include "SerialOutput.Defines.h"      // For all the serial output macros.
+//################################################################################//
+
+#define NTP_SERVER_BATCH        16U    ///< The queued requests answered back to back before the local check.
+#define NTP_SERVER_WAIT_MS    1000U    ///< The socket wait (ms) between the local checks and the `End()` checks.
+
+namespace BinaryClockShield
+   {
+   BinaryClockNtpServer::BinaryClockNtpServer()
+      {
+      mutex = xSemaphoreCreateMutex();
+      }
+
+   bool BinaryClockNtpServer::Begin(IBinaryClock* clock, uint16_t port)
+      {
+      if (running) { return true; }
+      if ((mutex == nullptr) || (serverTask != nullptr))
+         {
+         LOG_NTP_ERROR("ERROR: NTP server: " << ((mutex == nullptr) ? "no mutex" : "the last task hasn't stopped") << endl)
+         return false;
+         }
+
+      sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      if (sock < 0)
+         {
+         LOG_NTP_ERROR("ERROR: NTP server: unable to create the UDP socket." << endl)
+         return false;
+         }
+
+      struct sockaddr_in address = { };
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = htonl(INADDR_ANY);
+      if (bind(sock, (struct sockaddr*)&address, sizeof(address)) < 0)
+         {
+         LOG_NTP_ERROR("ERROR: NTP server: unable to bind UDP port " << port << endl)
+         close(sock);
+         sock = -1;
+         return false;
+         }
+
+      clockPtr = clock;
+      watching = false;
+      localCheckMs = millis() - NTP_SERVER_LOCAL_CHECK_MS;   // The first local check is now.
+      setWait(NTP_SERVER_WAIT_MS);
+
+      // Below the display and callback tasks: a burst of requests only delays the replies.
+      running = true;
+      BaseType_t created = xTaskCreate(serverTaskRun, "NtpServerTask", 4096, nullptr, tskIDLE_PRIORITY + 1, &serverTask);
+      if (created != pdPASS)
+         {
+         LOG_NTP_ERROR("ERROR: xTaskCreate failed for NtpServerTask" << endl)
+         running = false;
+         serverTask = nullptr;
+         close(sock);
+         sock = -1;
+         return false;
+         }
+
+      LOG_NTP_INFO("NTP server: serving UDP port " << port << (((localStratum != 0) && (clockPtr != nullptr))
+            ? ", local stratum " + String(localStratum) : String("")) << endl)
+      return true;
+      }
+
+   void BinaryClockNtpServer::End()
+      {
+      running = false;  // The task closes the socket after the current wait.
+      }
+
+   void BinaryClockNtpServer::SetReference(const NTPResult& result)
+      {
+      if (!result.success) { return; }
+
+      // The 16.16 seconds fields of the upstream server, in network order.
+      const NtpPacket& packet = result.packet;
+      uint32_t rootDelayUs = (uint32_t)(((uint64_t)ntohl(packet.rootDelay) * 1000000ULL) >> 16);
+      uint32_t rootDispersionUs = (uint32_t)(((uint64_t)ntohl(packet.rootDispersion) * 1000000ULL) >> 16);
+
+      NtpReference reference;
+      reference.stratum = (packet.stratum < 15) ? packet.stratum + 1 : 15;
+      reference.leap = (packet.li < 3) ? packet.li : 0;
+      reference.refId = result.serverAddress;
+      reference.refTimeUs = BinaryClockNTP::SystemMicros();    // The system clock was just corrected.
+      reference.rootDelayUs = rootDelayUs + (uint32_t)((result.delayUs > 0) ? result.delayUs : 0);
+      reference.rootDispersionUs = rootDispersionUs + NTP_MIN_DISPERSION_US;
+
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         responder.set_Reference(reference);
+         upstreamUs = reference.refTimeUs;
+         xSemaphoreGive(mutex);
+         }
+      }
+
+   void BinaryClockNtpServer::ClearLeap()
+      {
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         NtpReference reference = responder.get_Reference();
+         reference.leap = 0;
+         responder.set_Reference(reference);
+         xSemaphoreGive(mutex);
+         }
+      }
+
+   uint32_t BinaryClockNtpServer::GetCount(NtpResponse response)
+      {
+      uint32_t count = 0;
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         count = responder.GetCount(response);
+         xSemaphoreGive(mutex);
+         }
+
+      return count;
+      }
+
+   void BinaryClockNtpServer::serve()
+      {
+      uint8_t request[2 * NTP_REPLY_SIZE];    // Room for the extension fields, they are ignored.
+      uint8_t reply[NTP_REPLY_SIZE];
+
+      // Wait for the first request, then take the queued ones without waiting.
+      int flags = 0;
+      for (size_t i = 0; i < NTP_SERVER_BATCH; i++)
+         {
+         struct sockaddr_in client = { };
+         socklen_t clientLength = sizeof(client);
+         int received = recvfrom(sock, request, sizeof(request), flags, (struct sockaddr*)&client, &clientLength);
+         int64_t receiveUs = BinaryClockNTP::SystemMicros();
+         if (received < 0) { return; }   // Timed out, or nothing more queued.
+         flags = MSG_DONTWAIT;
+
+         NtpResponse response = NtpResponse::Invalid;
+         if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+            {
+            response = responder.Respond(request, (size_t)received, client.sin_addr.s_addr, receiveUs, BinaryClockNTP::SystemMicros(), reply);
+            xSemaphoreGive(mutex);
+            }
+
+         if ((response == NtpResponse::Reply) || (response == NtpResponse::Kiss))
+            { sendto(sock, reply, NTP_REPLY_SIZE, 0, (struct sockaddr*)&client, clientLength); }
+         }
+      }
+
+   void BinaryClockNtpServer::checkLocal()
+      {
+      if ((localStratum == 0) || (clockPtr == nullptr)) { return; }
+
+      if (!watching)
+         {
+         // The upstream reference is served while it's fresh, the RTC takes over after.
+         int64_t nowUs = BinaryClockNTP::SystemMicros();
+         bool upstream = (upstreamUs != 0) && ((nowUs - upstreamUs) < (int64_t)NTP_SERVER_MAX_AGE_S * 1000000LL);
+         if (upstream || ((millis() - localCheckMs) < NTP_SERVER_LOCAL_CHECK_MS)) { return; }
+
+         // The RTC time only changes on its tick, watch for the next one between the requests.
+         watchTime = clockPtr->get_Time();
+         localCheckMs = millis();
+         watching = true;
+         setWait(NTP_SERVER_LOCAL_POLL_MS);
+         return;
+         }
+
+      DateTime rtcTime = clockPtr->get_Time();
+      if (rtcTime == watchTime)
+         {
+         if ((millis() - localCheckMs) > 2 * SECONDS_MS)
+            {
+            LOG_NTP_WARN("NTP server: no RTC tick, the local reference isn't updated." << endl)
+            watching = false;
+            localCheckMs = millis();
+            setWait(NTP_SERVER_WAIT_MS);
+            }
+         return;
+         }
+
+      // The tick was seen up to a poll late, on average half a poll.
+      int64_t nowUs = BinaryClockNTP::SystemMicros() - (int64_t)NTP_SERVER_LOCAL_POLL_MS * 500LL;
+      watching = false;
+      localCheckMs = millis();
+      setWait(NTP_SERVER_WAIT_MS);
+
+      // The RTC holds the local time, `mktime()` converts it with the timezone (TZ).
+      struct tm local = { 0 };
+      local.tm_year = rtcTime.year() - 1900;
+      local.tm_mon = rtcTime.month() - 1;
+      local.tm_mday = rtcTime.day();
+      local.tm_hour = rtcTime.hour();
+      local.tm_min = rtcTime.minute();
+      local.tm_sec = rtcTime.second();
+      local.tm_isdst = -1;
+      time_t utc = mktime(&local);
+      if (utc == (time_t)-1) { return; }
+
+      int64_t offsetUs = (int64_t)utc * 1000000LL - nowUs;
+      if ((offsetUs > NTP_SERVER_LOCAL_STEP_MS * 1000LL) || (offsetUs < -NTP_SERVER_LOCAL_STEP_MS * 1000LL))
+         {
+         int64_t now = BinaryClockNTP::SystemMicros() + offsetUs;
+         struct timeval tv = { (time_t)(now / 1000000LL), (suseconds_t)(now % 1000000LL) };
+         settimeofday(&tv, nullptr);
+         LOG_NTP_INFO("NTP server: system clock stepped " << (int32_t)(offsetUs / 1000LL) << " ms to the RTC." << endl)
+         }
+      else if ((offsetUs > NTP_SERVER_LOCAL_SLEW_MS * 1000LL) || (offsetUs < -NTP_SERVER_LOCAL_SLEW_MS * 1000LL))
+         {
+         struct timeval delta = { (time_t)(offsetUs / 1000000LL), (suseconds_t)(offsetUs % 1000000LL) };
+         adjtime(&delta, nullptr);
+         }
+
+      NtpReference reference;
+      reference.stratum = localStratum;
+      reference.refId = htonl(NTP_REFID_LOCL);
+      reference.refTimeUs = BinaryClockNTP::SystemMicros();
+      reference.rootDispersionUs = NTP_SERVER_LOCAL_DISPERSION_US;
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         responder.set_Reference(reference);
+         xSemaphoreGive(mutex);
+         }
+      }
+
+   void BinaryClockNtpServer::setWait(uint32_t waitMs)
+      {
+      struct timeval tv = { (time_t)(waitMs / 1000), (suseconds_t)((waitMs % 1000) * 1000) };
+      setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      }
+
+   void BinaryClockNtpServer::serverTaskRun(void* param)
+      {
+      BinaryClockNtpServer& server = get_Instance();
+      while (server.running)
+         {
+         server.serve();
+         server.checkLocal();
+         }
+
+      close(server.sock);
+      server.sock = -1;
+      LOG_NTP_INFO("NTP server: stopped; " << server.GetCount(NtpResponse::Reply) << " replies, "
+            << server.GetCount(NtpResponse::Kiss) << " KoD, " << server.GetCount(NtpResponse::Limited) << " rate limited." << endl)
+      server.serverTask = nullptr;
+      vTaskDelete(nullptr);
+      }
+   } // namespace BinaryClockShield
@@ -0,0 +1,143 @@
+/// @file BinaryClockNtpServer.h
+/// @brief The header file for the `BinaryClockNtpServer` class, a NTP server for the other clocks on the LAN.
+/// @details A designated clock answers the NTP requests on UDP port 123 so the clocks on an isolated
+///          network don't each query the public servers, they point `set_NtpServers()` at it:
+///          - the server task waits on the socket and answers the queued requests back to back,
+///            the receive time is read as each request is taken from the socket. It runs below the
+///            display and callback tasks, a burst of requests only delays the replies;
+///          - the replies are made by `NtpResponder` (rate limits, KoD, root delay and dispersion);
+///          - after each upstream sync (`SetReference()`) the stratum is the upstream server's + 1 and
+///            the reference ID is its IPv4 address;
+///          - in local mode (`set_LocalStratum()`) the RTC is the reference when there is no upstream
+///            sync: the system clock is disciplined to the RTC second (stepped or slewed) and served
+///            with the local stratum and the reference ID "LOCL".
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BINARYCLOCKNTPSERVER_H__
+#define __BINARYCLOCKNTPSERVER_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#include <IBinaryClock.h>              /// The pure interface class, the RTC time for the local mode.
+#include "BinaryClockNTP.h"            /// For `NTPResult`, `SystemMicros()` and `NTP_DEFAULT_PORT`.
+#include "NtpResponder.h"              /// The replies and the rate limits.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"             /// For the server task.
+#include "freertos/semphr.h"           /// For the `mutex` of the responder.
+
+#ifndef NTP_SERVER_LOCAL_STRATUM
+   #define NTP_SERVER_LOCAL_STRATUM     0U   ///< The stratum served from the RTC without an upstream sync, 0 = off (e.g. 10).
+#endif
+#ifndef NTP_SERVER_LOCAL_CHECK_MS
+   #define NTP_SERVER_LOCAL_CHECK_MS 60000U  ///< The time (ms) between the checks of the system clock against the RTC.
+#endif
+#ifndef NTP_SERVER_LOCAL_POLL_MS
+   #define NTP_SERVER_LOCAL_POLL_MS     10U  ///< The socket wait (ms) while watching for the next RTC second.
+#endif
+#ifndef NTP_SERVER_LOCAL_STEP_MS
+   #define NTP_SERVER_LOCAL_STEP_MS    500   ///< A larger offset (ms) to the RTC is stepped, a smaller one is slewed.
+#endif
+#ifndef NTP_SERVER_LOCAL_SLEW_MS
+   #define NTP_SERVER_LOCAL_SLEW_MS     20   ///< A smaller offset (ms) to the RTC is left alone, the RTC tick jitter.
+#endif
+#ifndef NTP_SERVER_LOCAL_DISPERSION_US
+   #define NTP_SERVER_LOCAL_DISPERSION_US 50000U  ///< The root dispersion (µs) served in local mode, the RTC tick resolution.
+#endif
+
+#define NTP_REFID_LOCL          0x4C4F434CUL  ///< "LOCL" - the reference ID of the local mode (host order).
+
+namespace BinaryClockShield
+   {
+   /// @brief The NTP server of a designated clock, for the other clocks on the LAN (Singleton pattern).
+   /// @author Chris-70 (2026/10)
+   class BinaryClockNtpServer
+      {
+   public:
+      /// @brief Singleton access method for the `BinaryClockNtpServer` instance.
+      static BinaryClockNtpServer& get_Instance()
+         {
+         static BinaryClockNtpServer instance; // Guaranteed to be destroyed, instantiated on first use
+         return instance;
+         }
+
+      /// @brief Open the UDP socket and start the server task.
+      /// @param clock The clock whose RTC is the reference in local mode, `nullptr` for no local mode.
+      /// @param port The UDP port to serve, default `NTP_DEFAULT_PORT` (123).
+      /// @return True if the server is running.
+      /// @author Chris-70 (2026/10)
+      bool Begin(IBinaryClock* clock = nullptr, uint16_t port = NTP_DEFAULT_PORT);
+
+      /// @brief Stop the server, the task closes the socket within a second.
+      void End();
+
+      /// @brief Set the reference served from an upstream sync, e.g. `BinaryClockNTP::SyncTime()`.
+      /// @details The stratum is the upstream server's + 1, the root delay and dispersion are the
+      ///          upstream server's plus the sync's own delay and `NTP_MIN_DISPERSION_US`.
+      /// @param result The successful sync.
+      /// @author Chris-70 (2026/10)
+      void SetReference(const NTPResult& result);
+
+      /// @brief Stop announcing the leap second of the reference, it was applied at the event.
+      void ClearLeap();
+
+      /// @brief Get the count of the requests by response, e.g. `GetCount(NtpResponse::Reply)`.
+      uint32_t GetCount(NtpResponse response);
+
+      /// @brief `LocalStratum` Property (RW): The stratum served from the RTC without an upstream sync.
+      /// @details 0 turns the local mode off: nothing is served until the first upstream sync and after
+      ///          the reference is older than `NTP_SERVER_MAX_AGE_S`. A network without upstream uses
+      ///          e.g. 10, so a clock with an upstream sync is preferred. The default is `NTP_SERVER_LOCAL_STRATUM`.
+      void set_LocalStratum(uint8_t value)
+         { localStratum = (value < 16) ? value : 15; }
+      /// @copydoc set_LocalStratum()
+      uint8_t get_LocalStratum() const
+         { return localStratum; }
+
+      /// @brief `IsRunning` Property (RO): Flag: the server task is serving.
+      bool get_IsRunning() const
+         { return running; }
+
+   protected:
+      /// @brief Wait on the socket and answer the request and the others queued behind it.
+      void serve();
+
+      /// @brief Local mode: watch for the RTC second, discipline the system clock to it and serve it.
+      /// @author Chris-70 (2026/10)
+      void checkLocal();
+
+      /// @brief Set the socket wait, 1 s or `NTP_SERVER_LOCAL_POLL_MS` while watching the RTC.
+      void setWait(uint32_t waitMs);
+
+      /// @brief The server task: `serve()` and `checkLocal()` until `End()`.
+      /// @param param Not used.
+      static void serverTaskRun(void* param);
+
+      /// @brief Protected constructor for Singleton pattern.
+      ///        Use `get_Instance()` to get the single instance.
+      /// @see get_Instance()
+      BinaryClockNtpServer();
+
+      /// @brief Removed copy constructor for Singleton pattern
+      BinaryClockNtpServer(const BinaryClockNtpServer&) = delete;
+      /// @brief Removed assignment operator for Singleton pattern
+      BinaryClockNtpServer& operator=(const BinaryClockNtpServer&) = delete;
+
+   private:
+
+      NtpResponder responder;                      ///< The replies and the rate limits.
+      SemaphoreHandle_t mutex = nullptr;           ///< Guards `responder`, the reference is set from the sync task.
+      TaskHandle_t serverTask = nullptr;           ///< The server task.
+      int sock = -1;                               ///< The UDP socket, closed by the task.
+      volatile bool running = false;               ///< Flag: serve, cleared by `End()`.
+      IBinaryClock* clockPtr = nullptr;            ///< The clock whose RTC is the reference in local mode.
+      uint8_t localStratum = NTP_SERVER_LOCAL_STRATUM;   ///< The stratum of the local mode, 0 = off.
+      int64_t upstreamUs = 0;                      ///< The time of the last upstream sync, µs since 1970-01-01.
+      uint32_t localCheckMs = 0;                   ///< The time (`millis()`) of the last local check.
+      bool watching = false;                       ///< Flag: watching for the next RTC second.
+      DateTime watchTime;                          ///< The RTC time when the watch started.
+      }; // class BinaryClockNtpServer
+   } // namespace BinaryClockShield
+
+#endif // __BINARYCLOCKNTPSERVER_H__
@@ -0,0 +1,277 @@
+/// @file BinaryClockPeerSync.cpp
+/// @brief The implementation of the `BinaryClockPeerSync` class, the peer to peer time sync over UDP broadcast.
+/// @author Chris-70 (2026/10)
+
+#include "BinaryClockPeerSync.h"
+
+#include <WiFi.h>                      /// For the MAC: `WiFi.macAddress()`.
+#include <Streaming.h>                 /// For Serial << streaming syntax (https://github.com/janelia-arduino/Streaming)
+#include <lwip/sockets.h>             /// For the BSD socket API: socket(); bind(); recvfrom(); sendto().
+#include <time.h>                      /// For localtime_r(), the system time to the local display time.
+#include <sys/time.h>                  /// For gettimeofday(); settimeofday() and adjtime().
+
+//################################################################################//
+#ifndef SERIAL_OUTPUT
+   #define SERIAL_OUTPUT   true  // true to enable; false to disable
+#endif
+#ifndef DEV_CODE
+   #define DEV_CODE        true  // true to enable; false to disable
+#endif
+#ifndef DEBUG_OUTPUT
+   #define DEBUG_OUTPUT    true  // true to enable; false to disable
+#endif
+#ifndef PRINTF_OK
+   #define PRINTF_OK       true  // true to enable; false to disable
+#endif
+
+#include "SerialOutput.Defines.h"      // For all the serial output macros.
+//################################################################################//
+
+namespace BinaryClockShield
+   {
+   /// @brief Read the system clock in microseconds since 1970-01-01.
+   static int64_t systemMicros()
+      {
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+      return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+      }
+
+   BinaryClockPeerSync::BinaryClockPeerSync()
+      {
+      mutex = xSemaphoreCreateMutex();
+      }
+
+   bool BinaryClockPeerSync::Begin(IBinaryClock* clock, uint16_t udpPort)
+      {
+      if (running) { return true; }
+      if ((mutex == nullptr) || (peerTask != nullptr))
+         {
+         LOG_WAN_ERROR("ERROR: Peer sync: " << ((mutex == nullptr) ? "no mutex" : "the last task hasn't stopped") << endl)
+         return false;
+         }
+
+      sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      if (sock < 0)
+         {
+         LOG_WAN_ERROR("ERROR: Peer sync: unable to create the UDP socket." << endl)
+         return false;
+         }
+
+      int broadcast = 1;
+      setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+      struct timeval tv = { 0, (suseconds_t)(PEER_SYNC_WAIT_MS * 1000UL) };
+      setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+      struct sockaddr_in address = { };
+      address.sin_family = AF_INET;
+      address.sin_port = htons(udpPort);
+      address.sin_addr.s_addr = htonl(INADDR_ANY);
+      if (bind(sock, (struct sockaddr*)&address, sizeof(address)) < 0)
+         {
+         LOG_WAN_ERROR("ERROR: Peer sync: unable to bind UDP port " << udpPort << endl)
+         close(sock);
+         sock = -1;
+         return false;
+         }
+
+      uint8_t mac[6] = { 0 };
+      WiFi.macAddress(mac);
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         peerSync.Start(mac);
+         xSemaphoreGive(mutex);
+         }
+
+      port = udpPort;
+      clockPtr = clock;
+      uint32_t nowMs = millis();
+      beaconMs = nowMs - PEER_SYNC_BEACON_MS;   // The first beacon is now.
+      pollMs = nowMs;                           // The first request after the peers are heard.
+      alignMs = nowMs;
+      alignPending = true;
+
+      // Below the display and callback tasks, like the NTP server.
+      running = true;
+      BaseType_t created = xTaskCreate(peerTaskRun, "PeerSyncTask", 4096, nullptr, tskIDLE_PRIORITY + 1, &peerTask);
+      if (created != pdPASS)
+         {
+         LOG_WAN_ERROR("ERROR: xTaskCreate failed for PeerSyncTask" << endl)
+         running = false;
+         peerTask = nullptr;
+         close(sock);
+         sock = -1;
+         return false;
+         }
+
+      LOG_WAN_INFO("Peer sync: UDP port " << udpPort << endl)
+      return true;
+      }
+
+   void BinaryClockPeerSync::End()
+      {
+      running = false;  // The task closes the socket after the current wait.
+      }
+
+   void BinaryClockPeerSync::SetSynced(uint8_t stratum)
+      {
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         peerSync.SetSynced(stratum, millis());
+         xSemaphoreGive(mutex);
+         }
+      }
+
+   bool BinaryClockPeerSync::get_IsLeader()
+      {
+      bool leader = true;
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         leader = (peerSync.GetLeader(millis()) == nullptr);
+         xSemaphoreGive(mutex);
+         }
+
+      return leader;
+      }
+
+   void BinaryClockPeerSync::transmit()
+      {
+      uint8_t message[PEER_SYNC_SIZE];
+      uint32_t nowMs = millis();
+      if ((nowMs - beaconMs) >= PEER_SYNC_BEACON_MS)
+         {
+         beaconMs = nowMs;
+         size_t length = 0;
+         if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+            {
+            length = peerSync.MakeBeacon(nowMs, systemMicros(), message);
+            xSemaphoreGive(mutex);
+            }
+
+         struct sockaddr_in address = { };
+         address.sin_family = AF_INET;
+         address.sin_port = htons(port);
+         address.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+         sendto(sock, message, length, 0, (struct sockaddr*)&address, sizeof(address));
+         }
+
+      if ((nowMs - pollMs) >= PEER_SYNC_POLL_MS)
+         {
+         pollMs = nowMs;
+         size_t length = 0;
+         struct sockaddr_in address = { };
+         address.sin_family = AF_INET;
+         if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+            {
+            const PeerInfo* leader = peerSync.GetLeader(nowMs);
+            if (leader != nullptr)
+               {
+               address.sin_port = htons(leader->port);
+               address.sin_addr.s_addr = leader->address;
+               length = peerSync.MakeRequest(nowMs, systemMicros(), message);   // The transmit time, just before it's sent.
+               }
+            xSemaphoreGive(mutex);
+            }
+
+         if (length > 0)
+            { sendto(sock, message, length, 0, (struct sockaddr*)&address, sizeof(address)); }
+         }
+      }
+
+   void BinaryClockPeerSync::receive()
+      {
+      uint8_t message[2 * PEER_SYNC_SIZE];
+      uint8_t reply[PEER_SYNC_SIZE];
+      struct sockaddr_in peer = { };
+      socklen_t peerLength = sizeof(peer);
+      int received = recvfrom(sock, message, sizeof(message), 0, (struct sockaddr*)&peer, &peerLength);
+      int64_t receiveUs = systemMicros();
+      if (received < 0) { return; }   // Timed out.
+
+      PeerMessage type = PeerMessage::None;
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         type = peerSync.Receive(message, (size_t)received, peer.sin_addr.s_addr, ntohs(peer.sin_port), millis(),
+                                 receiveUs, systemMicros(), reply);
+         xSemaphoreGive(mutex);
+         }
+
+      if (type == PeerMessage::Request)
+         { sendto(sock, reply, PEER_SYNC_SIZE, 0, (struct sockaddr*)&peer, peerLength); }
+      else if (type == PeerMessage::Response)
+         { correct(); }
+      }
+
+   void BinaryClockPeerSync::correct()
+      {
+      int64_t offsetUs = 0;
+      PeerCorrection correction = PeerCorrection::None;
+      int64_t delayUs = 0;
+      if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
+         {
+         correction = peerSync.Correct(offsetUs);
+         delayUs = peerSync.get_LastDelayUs();
+         xSemaphoreGive(mutex);
+         }
+
+      switch (correction)
+         {
+         case PeerCorrection::Step:
+            {
+            int64_t now = systemMicros() + offsetUs;
+            struct timeval tv = { (time_t)(now / 1000000LL), (suseconds_t)(now % 1000000LL) };
+            settimeofday(&tv, nullptr);
+            alignPending = true;    // Once the next samples are within the deadband.
+            LOG_WAN_INFO("Peer sync: system clock stepped " << (int32_t)(offsetUs / 1000LL) << " ms to the leader." << endl)
+            }
+            break;
+
+         case PeerCorrection::Slew:
+            {
+            struct timeval delta = { (time_t)(offsetUs / 1000000LL), (suseconds_t)(offsetUs % 1000000LL) };
+            adjtime(&delta, nullptr);
+            LOG_WAN_DEBUG("Peer sync: slewing " << (int32_t)offsetUs << " us; delay " << (int32_t)delayUs << " us" << endl)
+            }
+            break;
+
+         default:
+            // Locked to the leader, the display follows.
+            if (alignPending) { align(); }
+            break;
+         }
+      }
+
+   void BinaryClockPeerSync::align()
+      {
+      alignMs = millis();
+      alignPending = false;
+      if (clockPtr == nullptr) { return; }
+
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+      struct tm timeinfo = { 0 };
+      localtime_r(&tv.tv_sec, &timeinfo);
+
+      DateTime local(timeinfo);
+      bool slewed = clockPtr->AdjustTime(local, (uint16_t)(tv.tv_usec / 1000L));
+      LOG_WAN_DEBUG("Peer sync: display aligned to the system clock" << (slewed ? " (slewing)" : "") << endl)
+      }
+
+   void BinaryClockPeerSync::peerTaskRun(void* param)
+      {
+      BinaryClockPeerSync& peers = get_Instance();
+      while (peers.running)
+         {
+         peers.transmit();
+         peers.receive();
+         if ((millis() - peers.alignMs) >= PEER_SYNC_ALIGN_MS)
+            { peers.align(); }
+         }
+
+      close(peers.sock);
+      peers.sock = -1;
+      LOG_WAN_INFO("Peer sync: stopped." << endl)
+      peers.peerTask = nullptr;
+      vTaskDelete(nullptr);
+      }
+   } // namespace BinaryClockShield
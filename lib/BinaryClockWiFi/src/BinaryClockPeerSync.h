@@ -0,0 +1,113 @@
+/// @file BinaryClockPeerSync.h
+/// @brief The header file for the `BinaryClockPeerSync` class, the peer to peer time sync over UDP broadcast.
+/// @details The clocks on a LAN follow one leader so their seconds change together, without
+///          internet access (`PeerSync` has the protocol):
+///          - the task broadcasts the beacons, sends a follower's requests to the leader and
+///            answers the requests of the others, the receive time is read as each message is
+///            taken from the socket;
+///          - a follower steps or slews the system clock to the leader's (within about a ms on a LAN);
+///          - the display is aligned to the system clock with `IBinaryClock::AdjustTime()`, which
+///            slews the RTC second: after the first lock, after a step and every `PEER_SYNC_ALIGN_MS`
+///            (the RTC drift is learned between the alignments, more often it isn't).
+///          A clock synced by NTP (`SetSynced()`) wins the election over the clocks that aren't.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __BINARYCLOCKPEERSYNC_H__
+#define __BINARYCLOCKPEERSYNC_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#include <IBinaryClock.h>              /// The pure interface class, to align the display.
+#include "PeerSync.h"                  /// The protocol: beacons, election and exchanges.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"             /// For the peer sync task.
+#include "freertos/semphr.h"           /// For the `mutex` of the protocol.
+
+#ifndef PEER_SYNC_ALIGN_MS
+   #define PEER_SYNC_ALIGN_MS   3600000UL   ///< The time (ms) between the alignments of the display to the system clock, 1 hour.
+#endif
+#ifndef PEER_SYNC_WAIT_MS
+   #define PEER_SYNC_WAIT_MS        100U    ///< The socket wait (ms), the resolution of the beacon and poll timers.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The peer to peer time sync of the clocks on a LAN (Singleton pattern).
+   /// @author Chris-70 (2026/10)
+   class BinaryClockPeerSync
+      {
+   public:
+      /// @brief Singleton access method for the `BinaryClockPeerSync` instance.
+      static BinaryClockPeerSync& get_Instance()
+         {
+         static BinaryClockPeerSync instance; // Guaranteed to be destroyed, instantiated on first use
+         return instance;
+         }
+
+      /// @brief Open the UDP broadcast socket and start the peer sync task.
+      /// @param clock The clock whose display is aligned to the system clock, `nullptr` for none.
+      /// @param port The UDP port of all the clocks, default `PEER_SYNC_PORT`.
+      /// @return True if the task is running.
+      /// @author Chris-70 (2026/10)
+      bool Begin(IBinaryClock* clock = nullptr, uint16_t port = PEER_SYNC_PORT);
+
+      /// @brief Stop the peer sync, the task closes the socket within `PEER_SYNC_WAIT_MS`.
+      void End();
+
+      /// @brief This clock was synced by NTP, it advertises the stratum (the server's + 1).
+      /// @param stratum The stratum of this clock.
+      void SetSynced(uint8_t stratum);
+
+      /// @brief `IsLeader` Property (RO): Flag: this clock is the leader the others follow.
+      bool get_IsLeader();
+
+      /// @brief `IsRunning` Property (RO): Flag: the peer sync task is running.
+      bool get_IsRunning() const
+         { return running; }
+
+   protected:
+      /// @brief Send the beacon and the follower's request when they are due.
+      void transmit();
+
+      /// @brief Wait on the socket for a message and handle it.
+      void receive();
+
+      /// @brief Make the correction of the samples to the system clock.
+      /// @author Chris-70 (2026/10)
+      void correct();
+
+      /// @brief Align the display (the RTC second) to the system clock.
+      void align();
+
+      /// @brief The peer sync task: `transmit()` and `receive()` until `End()`.
+      /// @param param Not used.
+      static void peerTaskRun(void* param);
+
+      /// @brief Protected constructor for Singleton pattern.
+      ///        Use `get_Instance()` to get the single instance.
+      /// @see get_Instance()
+      BinaryClockPeerSync();
+
+      /// @brief Removed copy constructor for Singleton pattern
+      BinaryClockPeerSync(const BinaryClockPeerSync&) = delete;
+      /// @brief Removed assignment operator for Singleton pattern
+      BinaryClockPeerSync& operator=(const BinaryClockPeerSync&) = delete;
+
+   private:
+      PeerSync peerSync;                           ///< The protocol: beacons, election and exchanges.
+      SemaphoreHandle_t mutex = nullptr;           ///< Guards `peerSync`, the stratum is set from the sync task.
+      TaskHandle_t peerTask = nullptr;             ///< The peer sync task.
+      int sock = -1;                               ///< The UDP socket, closed by the task.
+      uint16_t port = PEER_SYNC_PORT;              ///< The UDP port of all the clocks.
+      volatile bool running = false;               ///< Flag: run, cleared by `End()`.
+      IBinaryClock* clockPtr = nullptr;            ///< The clock whose display is aligned.
+      uint32_t beaconMs = 0;                       ///< The time (`millis()`) of the last beacon.
+      uint32_t pollMs = 0;                         ///< The time (`millis()`) of the last request.
+      uint32_t alignMs = 0;                        ///< The time (`millis()`) of the last alignment of the display.
+      bool alignPending = true;                    ///< Flag: align the display once the system clock is locked.
+      }; // class BinaryClockPeerSync
+   } // namespace BinaryClockShield
+
+#endif // __BINARYCLOCKPEERSYNC_H__
@@ -1,5 +1,6 @@
 
 #include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// For `offsetof()`
 
 #ifndef INLINE_HEADER
    #define INLINE_HEADER false
@@ -13,10 +14,12 @@
    
 #include <String>
 #include <vector>
-#include <map>
+#include <algorithm>
 
 #include <Streaming.h>    /// Streaming serial output with `operator<<` (https://github.com/espressif/arduino-esp32/blob/master/libraries/Streaming/)
 #include <Preferences.h>  /// ESP32 NVS storage preferences functions.
+#include <esp_rom_crc.h>  /// ROM CRC functions: `esp_rom_crc32_le()`
+#include <esp_system.h>   /// For `esp_register_shutdown_handler()`
 
 //################################################################################//
 #ifndef SERIAL_OUTPUT
@@ -41,7 +44,11 @@
 namespace BinaryClockShield
    {
    BinaryClockSettings::BinaryClockSettings() 
-      { }
+      { 
+      clearSlots();
+      mutex = xSemaphoreCreateRecursiveMutex();
+      commitTimer = xTimerCreate("Settings", pdMS_TO_TICKS(SETTINGS_COMMIT_DELAY_MS), pdFALSE, this, commitTimerCallback);
+      }
 
    BinaryClockSettings::~BinaryClockSettings()
       { 
@@ -51,202 +58,415 @@ namespace BinaryClockShield
 
    void BinaryClockSettings::Begin()
       {
-      SERIAL_PRINTLN("Begin(): Initializing BinaryClockSettings...")   // *** DEBUG ***
-      // Open NVS namespace
-      if (!nvs.begin(nvsNamespace, true))
+      LOG_WAN_DEBUG("Begin(): Initializing BinaryClockSettings..." << endl)   // *** DEBUG ***
+      SettingsLock lock(mutex);
+      if (initialized) { return; }
+
+      // Open NVS namespace in RW mode, it stays open until `End()`.
+      nvsOpen = nvs.begin(nvsNamespace, false);
+      if (!nvsOpen)
          {
-         SERIAL_PRINTLN("Begin(): Failed to open NVS namespace in RO mode.") // *** DEBUG ***
-         if (!nvs.begin(nvsNamespace, false))
+         LOG_WAN_ERROR("Begin(): Failed to open NVS namespace in RW mode." << endl) // *** DEBUG ***
+         if (!nvs.begin(nvsNamespace, true))
             {
-            SERIAL_PRINTLN("Begin(): Failed to open NVS namespace in RW mode.") // *** DEBUG ***
+            LOG_WAN_ERROR("Begin(): Failed to open NVS namespace in RO mode." << endl) // *** DEBUG ***
             return;
             }
          }
 
-      // Get number of access points stored
-      numAPs = nvs.getUChar(nvsKeyNumAPs, 0);
-      lastID = nvs.getUChar(nvsKeyLastID, 0);
+      static bool shutdownRegistered = false;
+      if (!shutdownRegistered)
+         { shutdownRegistered = (esp_register_shutdown_handler(shutdownHandler) == ESP_OK); }
+      nvsWrites = 0;
+
       timezone = nvs.getString(nvsKeyTimezone, TIMEZONE_UTC);
 
+      fastConnect = APFastConnect();
+      if (nvs.getBytesLength(nvsKeyFastConnect) == sizeof(fastConnect))
+         { nvs.getBytes(nvsKeyFastConnect, &fastConnect, sizeof(fastConnect)); }
+
       // Clear existing data
       Clear();
 
-      if (numAPs > 0)
+      // The AP records, or the single blob of the old format to migrate to records.
+      // Both set `modified` when the records need to be written: migrated or damaged.
+      modified = false;
+      storeHeader = APStoreHeader();
+      if (!loadRecords())
+         { loadBlob(); }
+      numAPs = apCreds.size();
+      buildIndex();
+
+      // Mark as initialized and not modified
+      initialized = true;
+      if (!nvsOpen) { nvs.end(); }  // Read only, the settings can't be saved.
+
+      LOG_WAN_DEBUG("Loaded " << apCreds.size() << " WiFi credentials from NVS" << endl)   // *** DEBUG ***
+      if (modified)
+         {
+         LOG_WAN_INFO("Begin(): Writing the WiFi credentials records, migrated or repaired." << endl)
+         Save();
+         }
+      }
+
+   bool BinaryClockSettings::loadRecords()
+      {
+      APStoreHeader header;
+      if ((nvs.getBytesLength(nvsKeyAPHeader) != sizeof(header))
+            || (nvs.getBytes(nvsKeyAPHeader, &header, sizeof(header)) != sizeof(header))
+            || (header.version != AP_RECORD_VERSION)
+            || (header.crc != recordCrc(&header, offsetof(APStoreHeader, crc))))
+         { return false; }
+
+      storeHeader = header;
+      lastID = header.lastID;
+      size_t count = 0;
+      for (uint32_t bits : header.ids)
+         { count += __builtin_popcount(bits); }
+      apCreds.reserve(count);   // One allocation for all the records.
+
+      for (unsigned id = 1; id <= MAX_ID_SIZE; id++)
+         {
+         if (!header.Has(id)) { continue; }
+
+         // Read the record in place, into its entry.
+         apCreds.emplace_back();
+         APRecord& record = apCreds.back().record;
+         char key[8];
+         recordKey(id, key);
+         if ((nvs.getBytes(key, &record, sizeof(record)) != sizeof(record)) || (record.version != AP_RECORD_VERSION)
+               || (record.id != id) || (record.crc != recordCrc(&record, offsetof(APRecord, crc))))
+            {
+            LOG_WAN_ERROR("loadRecords(): The record of AP ID " << id << " is damaged, skipped." << endl)
+            apCreds.pop_back();
+            modified = true;   // `Save()` drops it from the header.
+            continue;
+            }
+
+         // Just in case, the CRC was good.
+         record.ssid[sizeof(record.ssid) - 1] = '\0';
+         record.pw[sizeof(record.pw) - 1] = '\0';
+         setSlot(record.id, apCreds.size() - 1);
+         }
+
+      return true;
+      }
+
+   bool BinaryClockSettings::loadBlob()
+      {
+      // Get number of access points stored
+      uint8_t count = nvs.getUChar(nvsKeyNumAPs, 0);
+      lastID = nvs.getUChar(nvsKeyLastID, 0);
+      if (count == 0) { return false; }
+
+      // Get the size of the stored blob
+      size_t blobSize = nvs.getBytesLength(nvsKeyAPCreds);
+      if (blobSize == 0) { return false; }
+
+      // Allocate buffer for reading the blob
+      uint8_t* buffer = new uint8_t[blobSize];
+      
+      // Read the blob from NVS
+      size_t readSize = nvs.getBytes(nvsKeyAPCreds, buffer, blobSize);
+      
+      if (readSize == blobSize)
          {
-         // Get the size of the stored blob
-         size_t blobSize = nvs.getBytesLength(nvsKeyAPCreds);
+         // Deserialize the APCreds from the buffer
+         size_t offset = 0;
          
-         if (blobSize > 0)
+         for (uint8_t i = 0; i < count && offset < blobSize; i++)
             {
-            // Allocate buffer for reading the blob
-            uint8_t* buffer = new uint8_t[blobSize];
-            
-            // Read the blob from NVS
-            size_t readSize = nvs.getBytes(nvsKeyAPCreds, buffer, blobSize);
+            APCredsPlus creds;
             
-            if (readSize == blobSize)
+            // Deserialize base APCreds
+            deserializeAPCreds(buffer, offset, creds);
+            if (creds.id > lastID)
+               { lastID = creds.id; } // Update lastID if needed
+
+            // Written as a record by the next `Save()`.
+            ApAllInfo credsInfo;
+            credsInfo.modifiedAP = true;
+            credsInfo.record.id = creds.id;
+
+            // Only add if we have valid data (at least SSID)
+            if (!creds.ssid.isEmpty() && toRecord(creds, credsInfo.record))
                {
-               // Deserialize the APCreds from the buffer
-               size_t offset = 0;
-               
-               for (uint8_t i = 0; i < numAPs && offset < blobSize; i++)
-                  {
-                  ApAllInfo credsInfo;
-                  
-                  // Deserialize base APCreds
-                  deserializeAPCreds(buffer, offset, credsInfo);
-                  if (credsInfo.id > lastID)
-                     { lastID = credsInfo.id; } // Update lastID if needed
-                           
-                  
-                  // Reset all modification flags since we're loading from NVS
-                  credsInfo.modifiedAP = false;
-                  credsInfo.toBeDeleted = false;
-
-                  // Only add if we have valid data (at least SSID)
-                  if (!credsInfo.ssid.isEmpty())
-                     {
-                     // Add ApAllInfo object to apCreds vector
-                     apCreds.push_back(credsInfo);
-
-                     // Add to idList map: ID -> apCreds vector index
-                     size_t vectorIndex = apCreds.size() - 1;
-                     idList[credsInfo.id] = vectorIndex;
-                     }
-                  }
-               }
-            else
-               {
-               SERIAL_PRINTLN("Begin(): Failed to read AP credentials blob from NVS.")   // *** DEBUG ***
+               // Add ApAllInfo object to apCreds vector
+               apCreds.push_back(credsInfo);
+
+               // Add to the ID table: ID -> apCreds vector index
+               setSlot(creds.id, apCreds.size() - 1);
                }
-               
-            delete[] buffer;
             }
          }
-
-      // Mark as initialized and not modified
-      initialized = true;
-      modified = false;
-      nvs.end();
-
-      SERIAL_PRINT("Loaded ")                        // *** DEBUG ***
-      SERIAL_PRINT(apCreds.size())
-      SERIAL_PRINTLN(" WiFi credentials from NVS")   // *** DEBUG ***
+      else
+         {
+         LOG_WAN_ERROR("loadBlob(): Failed to read AP credentials blob from NVS." << endl)   // *** DEBUG ***
+         }
+         
+      delete[] buffer;
+      modified = !apCreds.empty();   // Written as records by `Save()`.
+      return modified;
       }
 
    void BinaryClockSettings::Clear()
       {
+      SettingsLock lock(mutex);
       apCreds.clear();
-      idList.clear();
+      clearSlots();
+      ssidIndex.clear();
       }
       
    bool BinaryClockSettings::Save()
       {
-      SERIAL_STREAM("Save(): Saving " << numAPs << " WiFi credentials to NVS..." << endl)  // *** DEBUG ***
-      bool result = false;
+      LOG_WAN_DEBUG("Save(): Saving " << numAPs << " WiFi credentials to NVS..." << endl)  // *** DEBUG ***
+      SettingsLock lock(mutex);
+      bool result = true;
       if (!initialized || !modified) { return !modified; } // Nothing to save
 
-      // Open NVS namespace in RW mode
-      if (!nvs.begin(nvsNamespace, false))
+      savePending = false;
+      if (commitTimer != nullptr) { xTimerStop(commitTimer, 0); }   // Saved now.
+      if (!nvsOpen)
          {
-         SERIAL_PRINTLN("Save(): Failed to open NVS namespace in RW mode")   // *** DEBUG ***
-         return result;
+         LOG_WAN_ERROR("Save(): The NVS namespace isn't open in RW mode" << endl)   // *** DEBUG ***
+         return false;
          }
 
-      if (numAPs > 0)
+      // Write the new and changed records first, the header only lists the records in NVS.
+      APStoreHeader header;
+      header.lastID = lastID;
+      unsigned written = 0;
+      for (auto& creds : apCreds)
          {
-         SERIAL_STREAM("Save(): Saving " << numAPs << " AP credentials to NVS..." << endl) // *** DEBUG ***
-         // Calculate total size needed for serialization
-         size_t totalSize = calculateTotalSize();
-         
-         // Allocate buffer
-         uint8_t* buffer = new uint8_t[totalSize];
-         size_t offset = 0;
+         if (creds.toBeDeleted) { continue; }
 
-         // Serialize all APCreds to buffer that aren't marked for deletion.
-         for (auto it = apCreds.begin(); it != apCreds.end(); ++it)
+         uint8_t id = creds.record.id;
+         bool stored = storeHeader.Has(id);
+         if (creds.modifiedAP || !stored)
             {
-            const auto& creds = *it;
-            // Remove the entries marked for deletion and continue
-            if (creds.toBeDeleted)
-               { 
-               idList.erase(creds.id);
-               apCreds.erase(it);
-               continue; 
-               } 
-
-            serializeAPCreds(buffer, offset, creds);
+            if (writeRecord(creds.record))
+               {
+               creds.modifiedAP = false;
+               stored = true;
+               written++;
+               }
+            else
+               {
+               LOG_WAN_ERROR("Save(): Failed to save the record of AP ID " << static_cast<int>(id) << endl) // *** DEBUG ***
+               result = false;
+               }
             }
 
-         // Store the blob in NVS
-         size_t written = nvs.putBytes(nvsKeyAPCreds, buffer, offset);
-         
-         if (written != offset)
+         if (stored) { header.Set(id); }   // A failed update keeps the old record.
+         }
+
+      bool headerSaved = (memcmp(header.ids, storeHeader.ids, sizeof(header.ids)) == 0) && (header.lastID == storeHeader.lastID)
+            && nvs.isKey(nvsKeyAPHeader);
+      if (!headerSaved)
+         {
+         header.crc = recordCrc(&header, offsetof(APStoreHeader, crc));
+         headerSaved = nvsPut(nvsKeyAPHeader, &header, sizeof(header));
+         }
+
+      if (headerSaved)
+         {
+         // Remove the records no longer listed, e.g. deleted entries or after `Clear()`.
+         for (unsigned id = 1; id <= MAX_ID_SIZE; id++)
             {
-            SERIAL_PRINTLN("Save(): Failed to save AP credentials blob to NVS") // *** DEBUG ***
-            result = false;
+            if (storeHeader.Has(id) && !header.Has(id))
+               {
+               char key[8];
+               recordKey(id, key);
+               nvsRemove(key);
+               }
             }
-         else
+         storeHeader = header;
+
+         // Remove the old format, the records replace it.
+         if (nvs.isKey(nvsKeyAPCreds))
             {
-            SERIAL_PRINT("Saved ")                      // *** DEBUG ***
-            SERIAL_PRINT(numAPs)
-            SERIAL_PRINTLN(" WiFi credentials to NVS")  // *** DEBUG ***
-            for (auto& creds : apCreds)
-               { creds.modifiedAP = false; } // Clear modified flag after successful save
-
-            modified = false; // Clear modified flag after successful save
-            result = true;
+            nvsRemove(nvsKeyAPCreds);
+            nvsRemove(nvsKeyNumAPs);
+            nvsRemove(nvsKeyLastID);
             }
 
-         delete[] buffer;
+         // Remove the entries marked for deletion from RAM, then rebuild the ID map and index.
+         apCreds.erase(std::remove_if(apCreds.begin(), apCreds.end(), [](const ApAllInfo& creds) { return creds.toBeDeleted; }), 
+                       apCreds.end());
+         clearSlots();
+         for (size_t i = 0; i < apCreds.size(); i++)
+            { setSlot(apCreds[i].record.id, i); }
+         buildIndex();
          }
       else
          {
-         // No APs to save, remove the blob
-         nvs.remove(nvsKeyAPCreds);
-         modified = false;
-         // TODO: Is this result a success or failure? Success for now.
-         SERIAL_PRINTLN("Save(): No AP credentials to save, removed blob from NVS.")  // *** DEBUG ***
-         result = true;
+         LOG_WAN_ERROR("Save(): Failed to save the AP records header to NVS" << endl) // *** DEBUG ***
+         result = false;
          }
 
-      // Update numAPs based on current vector size
       numAPs = apCreds.size();
-      
-      nvs.putUChar(nvsKeyNumAPs, numAPs);
-      nvs.putUChar(nvsKeyLastID, lastID);
-      nvs.putString(nvsKeyTimezone, timezone);
-      SERIAL_STREAM("Save(): Saved timezone: [" << timezone << "]" << endl) // *** DEBUG ***
-      nvs.end();
+      if (nvs.getString(nvsKeyTimezone, "") != timezone)
+         {
+         nvs.putString(nvsKeyTimezone, timezone);
+         nvsWrites++;
+         LOG_WAN_DEBUG("Save(): Saved timezone: [" << timezone << "]" << endl) // *** DEBUG ***
+         }
 
+      modified = !result;  // Try again at the next `Save()`.
+      LOG_WAN_DEBUG("Save(): Wrote " << written << " of " << numAPs << " AP records" << (result ? "" : ", FAILED") << endl)  // *** DEBUG ***
       return result;
       }
 
-   void BinaryClockSettings::serializeAPCreds(uint8_t* buffer, size_t& offset, const APCredsPlus& creds) const
+   bool BinaryClockSettings::writeRecord(APRecord& record)
       {
-      // Store ID
-      buffer[offset++] = creds.id;
-      
-      // Store SSID length and data
-      uint16_t ssidLen = creds.ssid.length();
-      memcpy(buffer + offset, &ssidLen, sizeof(ssidLen));
-      offset += sizeof(ssidLen);
-      memcpy(buffer + offset, creds.ssid.c_str(), ssidLen);
-      offset += ssidLen;
-      
-      // Store BSSID length and data
-      uint16_t bssidLen = creds.bssid.length();
-      memcpy(buffer + offset, &bssidLen, sizeof(bssidLen));
-      offset += sizeof(bssidLen);
-      memcpy(buffer + offset, creds.bssid.c_str(), bssidLen);
-      offset += bssidLen;
-      
-      // Store password length and data
-      uint16_t pwLen = creds.pw.length();
-      memcpy(buffer + offset, &pwLen, sizeof(pwLen));
-      offset += sizeof(pwLen);
-      memcpy(buffer + offset, creds.pw.c_str(), pwLen);
-      offset += pwLen;
+      record.version = AP_RECORD_VERSION;
+      record.crc = recordCrc(&record, offsetof(APRecord, crc));
+
+      char key[8];
+      recordKey(record.id, key);
+      return nvsPut(key, &record, sizeof(record));
+      }
+
+   bool BinaryClockSettings::nvsPut(const char* key, const void* value, size_t length)
+      {
+      nvsWrites++;
+      return (nvs.putBytes(key, value, length) == length);
+      }
+
+   void BinaryClockSettings::nvsRemove(const char* key)
+      {
+      if (nvs.isKey(key))
+         {
+         nvsWrites++;
+         nvs.remove(key);
+         }
+      }
+
+   bool BinaryClockSettings::SaveDeferred()
+      {
+      SettingsLock lock(mutex);
+      if (!initialized || !modified) { return !modified; } // Nothing to save
+      if (commitTimer == nullptr) { return Save(); }
+
+      // Restart the quiet period, the changes made until it ends are saved together.
+      savePending = (xTimerReset(commitTimer, 0) == pdPASS);
+      return savePending || Save();
+      }
+
+   bool BinaryClockSettings::Flush()
+      {
+      SettingsLock lock(mutex);
+      return !savePending || Save();
+      }
+
+   void BinaryClockSettings::set_FlushEvent(EventGroupHandle_t group, EventBits_t bits)
+      {
+      SettingsLock lock(mutex);
+      flushGroup = group;
+      flushBits = bits;
+      }
+
+   void BinaryClockSettings::Checkpoint()
+      {
+      SettingsLock lock(mutex);
+      checkpointCreds = apCreds;
+      checkpointTimezone = timezone;
+      checkpointLastID = lastID;
+      checkpointModified = modified;
+      checkpointWrites = nvsWrites;
+      hasCheckpoint = true;
+      }
+
+   bool BinaryClockSettings::Rollback()
+      {
+      SettingsLock lock(mutex);
+      if (!hasCheckpoint) { return false; }
+
+      apCreds.swap(checkpointCreds);
+      timezone = checkpointTimezone;
+      lastID = checkpointLastID;
+      modified = checkpointModified || (nvsWrites != checkpointWrites);   // A failed `Save()` may have written part of it.
+      numAPs = apCreds.size();
+      clearSlots();
+      for (size_t i = 0; i < apCreds.size(); i++)
+         { setSlot(apCreds[i].record.id, i); }
+      buildIndex();
+
+      Release();
+      return true;
+      }
+
+   void BinaryClockSettings::Release()
+      {
+      SettingsLock lock(mutex);
+      checkpointCreds.clear();
+      checkpointCreds.shrink_to_fit();
+      checkpointTimezone = "";
+      hasCheckpoint = false;
+      }
+
+   void BinaryClockSettings::commitTimerCallback(TimerHandle_t timer)
+      {
+      BinaryClockSettings* settings = static_cast<BinaryClockSettings*>(pvTimerGetTimerID(timer));
+      if (settings->flushGroup != nullptr)
+         {
+         xEventGroupSetBits(settings->flushGroup, settings->flushBits);   // The task saves.
+         return;
+         }
+
+      bool result = settings->Flush();
+      (void)result;                    // Only logged.
+      LOG_WAN_DEBUG("Settings: deferred save " << (result ? "done" : "FAILED") << ", NVS writes: " << settings->nvsWrites << endl)  // *** DEBUG ***
+      }
+
+   void BinaryClockSettings::shutdownHandler()
+      {
+      get_Instance().Flush();
+      }
+
+   bool BinaryClockSettings::toRecord(const APCreds& creds, APRecord& record) const
+      {
+      uint8_t bssid[6];
+      if ((creds.ssid.length() > maxSSIDLength) || (creds.pw.length() > maxPasswordLength) || !creds.bssidToBytes(bssid))
+         { return false; }
+
+      memset(record.ssid, 0, sizeof(record.ssid));   // No old bytes after the terminator in NVS.
+      memset(record.pw, 0, sizeof(record.pw));
+      memcpy(record.ssid, creds.ssid.c_str(), creds.ssid.length());
+      memcpy(record.pw, creds.pw.c_str(), creds.pw.length());
+      memcpy(record.bssid, bssid, sizeof(record.bssid));
+      return true;
+      }
+
+   APCredsPlus BinaryClockSettings::fromRecord(const APRecord& record)
+      {
+      char bssid[18] = "";
+      if (!anyBssid(record.bssid))
+         {
+         // The same format as `WiFiClass::BSSIDstr()`.
+         snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X", 
+               record.bssid[0], record.bssid[1], record.bssid[2], record.bssid[3], record.bssid[4], record.bssid[5]);
+         }
+
+      APCredsPlus creds(APCreds(APNames(String(record.ssid), String(bssid)), String(record.pw)));
+      creds.id = record.id;
+      return creds;
+      }
+
+   bool BinaryClockSettings::anyBssid(const uint8_t* bssid)
+      {
+      static const uint8_t zero[6] = { 0 };
+      return (memcmp(bssid, zero, sizeof(zero)) == 0);
+      }
+
+   void BinaryClockSettings::recordKey(uint8_t id, char (&key)[8])
+      {
+      snprintf(key, sizeof(key), "ap_%u", static_cast<unsigned>(id));
+      }
+
+   uint32_t BinaryClockSettings::recordCrc(const void* data, size_t size)
+      {
+      return esp_rom_crc32_le(0, static_cast<const uint8_t*>(data), size);
       }
 
    void BinaryClockSettings::deserializeAPCreds(const uint8_t* buffer, size_t& offset, APCredsPlus& creds) const
@@ -288,36 +508,63 @@ namespace BinaryClockShield
       offset += pwLen;
       }
 
-   size_t BinaryClockSettings::calculateAPCredsSize(const APCredsPlus& creds) const
+   uint8_t BinaryClockSettings::GetID(const APNames& names) const
       {
-      return 1 + // ID (uint8_t)
-             sizeof(uint16_t) + creds.ssid.length() + // SSID length + data
-             sizeof(uint16_t) + creds.bssid.length() + // BSSID length + data  
-             sizeof(uint16_t) + creds.pw.length(); // Password length + data
+      SettingsLock lock(mutex);
+      LOG_WAN_DEBUG("- GetID(): Looking for SSID: " << names.ssid << " BSSID: " << names.bssid << endl) // *** DEBUG ***
+      uint8_t result = 0;
+      if (!initialized || names.ssid.isEmpty()) { return result; } // Error
+
+      int index = matchIndex(names, false);
+      if (index >= 0)
+         { result = apCreds[index].record.id; }
+
+      return result;
       }
 
-   size_t BinaryClockSettings::calculateTotalSize() const
+   int BinaryClockSettings::matchIndex(const APNames& names, bool deleted) const
       {
-      size_t total = 0;
-      for (const auto& creds : apCreds)
+      uint8_t bssid[6];
+      if (!names.bssidToBytes(bssid)) { return -1; }
+
+      // Only the entries with the same SSID hash are compared, in `apCreds` order.
+      std::pair<uint32_t, uint16_t> key(HashSSID(names.ssid.c_str()), 0);
+      for (auto it = std::lower_bound(ssidIndex.begin(), ssidIndex.end(), key);
+           (it != ssidIndex.end()) && (it->first == key.first); ++it)
          {
-         total += calculateAPCredsSize(creds);
+         const ApAllInfo& creds = apCreds[it->second];
+         if ((creds.toBeDeleted && !deleted) || (strcmp(creds.record.ssid, names.ssid.c_str()) != 0)) { continue; }
+
+         // The same as `APNames::operator==()`: an empty BSSID matches any.
+         if (anyBssid(creds.record.bssid) || anyBssid(bssid) || (memcmp(creds.record.bssid, bssid, sizeof(bssid)) == 0))
+            { return it->second; }
          }
 
-      return total;
+      return -1;
       }
 
-   uint8_t BinaryClockSettings::GetID(const APNames& names) const
+   uint8_t BinaryClockSettings::FindID(const char* ssid, const uint8_t* bssid) const
       {
-      SERIAL_STREAM("- GetID(): Looking for SSID: " << names.ssid << " BSSID: " << names.bssid << endl) // *** DEBUG ***
+      SettingsLock lock(mutex);
       uint8_t result = 0;
-      if (!initialized || names.ssid.isEmpty()) { return result; } // Error
+      if (!initialized || ssid == nullptr || ssid[0] == '\0') { return result; } // Error
 
-      for (const auto& creds : apCreds)
+      std::pair<uint32_t, uint16_t> key(HashSSID(ssid), 0);
+      for (auto it = std::lower_bound(ssidIndex.begin(), ssidIndex.end(), key);
+           (it != ssidIndex.end()) && (it->first == key.first); ++it)
          {
-         if (creds == names && !creds.toBeDeleted)
+         const APRecord& record = apCreds[it->second].record;
+         if (apCreds[it->second].toBeDeleted || strcmp(record.ssid, ssid) != 0) { continue; }
+
+         if (anyBssid(record.bssid))
             {
-            result = creds.id;
+            if (result == 0) { result = record.id; }  // Any AP with the SSID, keep looking for the BSSID.
+            continue;
+            }
+
+         if ((bssid != nullptr) && (memcmp(record.bssid, bssid, sizeof(record.bssid)) == 0))
+            {
+            result = record.id;
             break;
             }
          }
@@ -325,18 +572,40 @@ namespace BinaryClockShield
       return result;
       }
 
+   uint32_t BinaryClockSettings::HashSSID(const char* ssid)
+      {
+      uint32_t hash = 2166136261UL;          // FNV-1a offset basis
+      while (*ssid != '\0')
+         {
+         hash ^= (uint8_t)*ssid++;
+         hash *= 16777619UL;                 // FNV prime
+         }
+
+      return hash;
+      }
+
+   void BinaryClockSettings::buildIndex()
+      {
+      ssidIndex.clear();
+      ssidIndex.reserve(apCreds.size());
+      for (size_t i = 0; i < apCreds.size(); i++)
+         { ssidIndex.push_back(std::make_pair(HashSSID(apCreds[i].record.ssid), static_cast<uint16_t>(i))); }
+
+      std::sort(ssidIndex.begin(), ssidIndex.end());
+      }
+
 std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
       {
-      SERIAL_STREAM("- GetIDs(): Looking any matches for SSID: " << ssid << endl)  // *** DEBUG ***
+      LOG_WAN_DEBUG("- GetIDs(): Looking any matches for SSID: " << ssid << endl)  // *** DEBUG ***
       std::vector<uint8_t> result;
       if (!initialized || ssid.isEmpty()) { return result; } // Error
 
       for (size_t i = 0; i < apCreds.size(); i++)
          {
-         const ApAllInfo& creds = apCreds[static_cast<uint8_t>(i)];
-         if (creds.ssid == ssid && !creds.toBeDeleted)
+         const ApAllInfo& creds = apCreds[i];
+         if (!creds.toBeDeleted && (strcmp(creds.record.ssid, ssid.c_str()) == 0))
             {
-            result.push_back(creds.id);
+            result.push_back(creds.record.id);
             }
          }
 
@@ -348,24 +617,45 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
       int result = -1;
       if (!initialized) { return result; } // Error
 
-      auto it = idList.find(ID);
-      if (it != idList.end())
+      if (idSlots[ID] != AP_NO_SLOT)
+         { result = idSlots[ID]; }
+
+      return result;
+      }
+
+   void BinaryClockSettings::setSlot(uint8_t id, size_t index)
+      {
+      idSlots[id] = static_cast<uint8_t>(index);
+      idUsed[id / 32] |= (1UL << (id % 32));
+      }
+
+   void BinaryClockSettings::clearSlots()
+      {
+      memset(idSlots, AP_NO_SLOT, sizeof(idSlots));
+      memset(idUsed, 0, sizeof(idUsed));
+      }
+
+   uint16_t BinaryClockSettings::findFreeID(uint16_t first) const
+      {
+      for (uint16_t word = first / 32; word < 8; word++)
          {
-         size_t index = it->second;
-         result = static_cast<int>(index);
+         uint32_t free = ~idUsed[word];
+         if (word == first / 32) { free &= (~0UL << (first % 32)); }   // Skip the IDs before `first`.
+         if (free != 0) { return word * 32 + __builtin_ctz(free); }
          }
 
-      return result;
+      return UINT8_MAX + 1;
       }
 
    bool BinaryClockSettings::changeDeleteStatus(uint8_t id, bool toDelete)
       {
+      SettingsLock lock(mutex);
       bool result = false;
       if (!initialized) { return result; } // Error
 
       // Find the index of the credentials, -1 indicates an error.
       int index = GetIndex(id);
-      if (index >= 0 && index < apCreds.size())
+      if (index >= 0 && (size_t)index < apCreds.size())
          {
          // Mark the entry for deletion
          apCreds[index].toBeDeleted = toDelete;
@@ -378,33 +668,20 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    uint8_t BinaryClockSettings::GetNewID()
       {
-      SERIAL_STREAM("GetNewID(): Generating new ID... Last ID: " << static_cast<int>(lastID) << ". idList size: " << idList.size() 
+      LOG_WAN_DEBUG("GetNewID(): Generating new ID... Last ID: " << static_cast<int>(lastID) << ". IDs used: " << apCreds.size() 
              << " Initialized? " << (initialized ? "Yes" : "No") << endl)  // *** DEBUG ***
       uint8_t result = 0; // 0 == error
-      if (!initialized || idList.size() >= MAX_ID_SIZE) { return result; } // Error
+      if (!initialized || apCreds.size() >= MAX_ID_SIZE) { return result; } // Error
 
-      unsigned counter = 0;
-      auto it = idList.find(lastID);
-      if (lastID == 0 && it == idList.end())
-         {
-         // First ID
-         result = 1;
-         lastID = 1;
-         return result;
-         }
-         
-      // Loop looking for an available ID number, wrap around if needed.
-      // Stop when we find an unused number, or we have checked all possible numbers.
-      while ((++counter < MAX_ID_SIZE) && (it != idList.end()))
-         {
-         if (++lastID == 0) { lastID = 1; }
+      // The next ID after the last one, wrap around to the lowest available ID if needed.
+      uint16_t id = findFreeID((lastID >= MAX_ID_SIZE) ? 1 : lastID + 1);
+      if (id > MAX_ID_SIZE) 
+         { id = findFreeID(1); }
 
-         it = idList.find(lastID);
-         if (it == idList.end())
-            {
-            result = lastID;
-            break;
-            }
+      if (id <= MAX_ID_SIZE)
+         {
+         result = static_cast<uint8_t>(id);
+         lastID = result;
          }
 
       return result; 
@@ -416,28 +693,26 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
       if (!initialized) { return id; } // Error
 
       // First check if the entry exists in our list (i.e. same ssid && same bssid)
-      for(auto& existingCreds : apCreds)
+      int index = matchIndex(creds, true);
+      if (index >= 0)
          {
-         if (existingCreds == creds)
+         ApAllInfo& existingCreds = apCreds[index];
+         id = existingCreds.record.id;
+         // Do we update the PW?
+         if (strcmp(existingCreds.record.pw, creds.pw.c_str()) != 0)
             {
-            id = existingCreds.id;
-            // Do we update the PW?
-            if (existingCreds.pw != creds.pw)
-               {
-               SERIAL_PRINTLN("updateWiFiCreds(): WiFi SSID and BSSID already exist with different password. Updating password.")   // *** DEBUG ***
-               // Update password
-               existingCreds.pw = creds.pw;
-               existingCreds.modifiedAP = true;
-               existingCreds.toBeDeleted = false; // In case it was marked for deletion
-               modified = true; // Mark NVS as modified
-               }
-            else
-               {
-               existingCreds.toBeDeleted = false; // In case it was marked for deletion
-               SERIAL_PRINTLN("updateWiFiCreds(): WiFi credentials already exist. Not updating.")   // *** DEBUG ***
-               }
-
-            break;
+            LOG_WAN_DEBUG("updateWiFiCreds(): WiFi SSID and BSSID already exist with different password. Updating password." << endl)   // *** DEBUG ***
+            // Update password
+            memset(existingCreds.record.pw, 0, sizeof(existingCreds.record.pw));
+            memcpy(existingCreds.record.pw, creds.pw.c_str(), creds.pw.length());
+            existingCreds.modifiedAP = true;
+            existingCreds.toBeDeleted = false; // In case it was marked for deletion
+            modified = true; // Mark NVS as modified
+            }
+         else
+            {
+            existingCreds.toBeDeleted = false; // In case it was marked for deletion
+            LOG_WAN_DEBUG("updateWiFiCreds(): WiFi credentials already exist. Not updating." << endl)   // *** DEBUG ***
             }
          }
 
@@ -446,10 +721,18 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    uint8_t BinaryClockSettings::AddWiFiCreds(const APCreds& creds)
       {
+      SettingsLock lock(mutex);
       uint8_t id = 0;
       if (!initialized) { return id; } // Error
 
-      SERIAL_PRINT(creds.ssid)
+      LOG_WAN_DEBUG(creds.ssid)
+      ApAllInfo credsInfo;
+      if (!toRecord(creds, credsInfo.record))
+         {
+         LOG_WAN_ERROR("AddWiFiCreds(): The SSID, password or BSSID is too long or invalid." << endl)  // *** DEBUG ***
+         return id;
+         }
+
       id = updateWiFiCreds(creds);
 
       if (id == 0)
@@ -458,20 +741,20 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
          id = GetNewID();
          if (id != 0)
             {
-            ApAllInfo credsInfo = ApAllInfo(creds);
-            credsInfo.id = id;
+            credsInfo.record.id = id;
             credsInfo.modifiedAP = true; // New entry, mark as modified
             apCreds.push_back(credsInfo);
 
             numAPs = apCreds.size();
-            idList[id] = apCreds.size() - 1; // Map new ID to vector index
+            setSlot(id, apCreds.size() - 1); // Map new ID to vector index
+            buildIndex();
             modified = true; // Mark NVS as modified
-            SERIAL_STREAM("Added new WiFi credentials, SSID: " << creds.ssid << " with ID " << static_cast<int>(id) 
+            LOG_WAN_DEBUG("Added new WiFi credentials, SSID: " << creds.ssid << " with ID " << static_cast<int>(id) 
                   << ". Total APs: " << static_cast<int>(numAPs) << endl) // *** DEBUG ***
             }
          else
             {
-            SERIAL_PRINTLN("Error: Unable to generate new ID for WiFi credentials.")  // *** DEBUG ***
+            LOG_WAN_ERROR("Error: Unable to generate new ID for WiFi credentials." << endl)  // *** DEBUG ***
             }
          }
       return id;
@@ -479,29 +762,72 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    void BinaryClockSettings::End(bool save)
       {
-      if (save && modified)
+      SettingsLock lock(mutex);
+      if ((save || savePending) && modified)   // A deferred save was promised.
          {
          Save();
          }
+      savePending = false;
+      if (commitTimer != nullptr) { xTimerStop(commitTimer, 0); }
 
       apCreds.clear();
-      idList.clear();
+      clearSlots();
+      ssidIndex.clear();
       initialized = false;
       modified = false;
       numAPs = 0;
-      nvs.end();
+      if (nvsOpen) { nvs.end(); }
+      nvsOpen = false;
+      }
+
+   bool BinaryClockSettings::GetFastConnect(APFastConnect& value) const
+      {
+      SettingsLock lock(mutex);
+      value = APFastConnect();
+      if (!initialized || !fastConnect.IsValid()) { return false; }
+
+      // The AP credentials may have been deleted since.
+      int index = GetIndex(fastConnect.id);
+      if (index < 0 || (size_t)index >= apCreds.size() || apCreds[index].toBeDeleted) { return false; }
+
+      value = fastConnect;
+      return true;
+      }
+
+   bool BinaryClockSettings::SetFastConnect(const APFastConnect& value)
+      {
+      SettingsLock lock(mutex);
+      if (memcmp(&value, &fastConnect, sizeof(fastConnect)) == 0) { return true; } // Unchanged, save the flash.
+
+      if (!nvsOpen)
+         {
+         LOG_WAN_ERROR("SetFastConnect(): The NVS namespace isn't open in RW mode" << endl)   // *** DEBUG ***
+         return false;
+         }
+
+      bool result = true;
+      if (value.IsValid())
+         { result = nvsPut(nvsKeyFastConnect, &value, sizeof(value)); }
+      else
+         { nvsRemove(nvsKeyFastConnect); }
+
+      if (result) { fastConnect = value; }
+      LOG_WAN_DEBUG("SetFastConnect(): AP ID " << static_cast<int>(value.id) << ", channel " << static_cast<int>(value.channel) 
+            << (result ? " saved" : " FAILED") << endl)  // *** DEBUG ***
+      return result;
       }
 
    APCredsPlus BinaryClockSettings::GetWiFiAP(uint8_t id) const
       {
+      SettingsLock lock(mutex);
       APCredsPlus result;
       if (!initialized) { return result; } // Error
 
       // Find the index of the credentials
       int index = GetIndex(id);
-      if (index >= 0 && index < apCreds.size())
+      if (index >= 0 && (size_t)index < apCreds.size())
          {
-         result = apCreds[index];
+         result = fromRecord(apCreds[index].record);
          // // TODO: Think about protecting passwords and if it's needed. Also from whom? What is the threat model?
          // result.pw.clear();
          }
@@ -511,6 +837,7 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    std::vector<APCredsPlus> BinaryClockSettings::GetWiFiAPs(const String& ssid) const
       {
+      SettingsLock lock(mutex);
       std::vector<APCredsPlus> result;
       if (!initialized || ssid.isEmpty()) { return result; } // Error
 
@@ -518,9 +845,10 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
       std::vector<uint8_t> ids = GetIDs(ssid);
       for (const auto& id : ids)
          {
-         if (id < apCreds.size())
+         int index = GetIndex(id);
+         if (index >= 0)
             {
-            APCredsPlus cred = apCreds[id];
+            APCredsPlus cred = fromRecord(apCreds[index].record);
             // TODO: Think about protecting passwords and if it's needed. Also from whom? What is the threat model?
             cred.pw.clear(); // Clear password for security theater
             result.push_back(cred);
@@ -532,7 +860,8 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    std::vector<APCredsPlus> BinaryClockSettings::GetWiFiAPs(const std::vector<APNames>& names) const
       {
-      SERIAL_STREAM("GetWiFiAPs(APNames): Looking for " << names.size() << " APs. Initialized? " << (initialized ? "Yes" : "No") << endl)  // *** DEBUG ***
+      SettingsLock lock(mutex);
+      LOG_WAN_DEBUG("GetWiFiAPs(APNames): Looking for " << names.size() << " APs. Initialized? " << (initialized ? "Yes" : "No") << endl)  // *** DEBUG ***
       std::vector<APCredsPlus> result;
       if (!initialized || names.empty()) { return result; } // Error
 
@@ -551,7 +880,8 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
 
    std::vector<std::pair<APCredsPlus, WiFiInfo>> BinaryClockSettings::GetWiFiAPs(const std::vector<WiFiInfo>& wifiInfos) const
       {
-      SERIAL_STREAM("GetWiFiAPs(WiFiInfo): Looking for " << wifiInfos.size() << " APs. Initialized? " << (initialized ? "Yes" : "No") << endl)  // *** DEBUG ***
+      SettingsLock lock(mutex);
+      LOG_WAN_DEBUG("GetWiFiAPs(WiFiInfo): Looking for " << wifiInfos.size() << " APs. Initialized? " << (initialized ? "Yes" : "No") << endl)  // *** DEBUG ***
       std::vector<std::pair<APCredsPlus, WiFiInfo>> result;
       if (!initialized || wifiInfos.empty()) { return result; } // Error
 
@@ -560,7 +890,7 @@ std::vector<uint8_t> BinaryClockSettings::GetIDs(const String& ssid) const
          uint8_t id = GetID(info);
          if (id != 0)
             {
-            SERIAL_STREAM("GetWiFiAPs(WiFiInfo): Found matching AP SSID: " << info.ssid << " BSSID: " << info.bssid << " with ID: " << static_cast<int>(id) << endl)  // *** DEBUG ***
+            LOG_WAN_DEBUG("GetWiFiAPs(WiFiInfo): Found matching AP SSID: " << info.ssid << " BSSID: " << info.bssid << " with ID: " << static_cast<int>(id) << endl)  // *** DEBUG ***
             APCredsPlus cred = GetWiFiAP(id);
             result.push_back(std::make_pair(cred, info));
             }
@@ -10,17 +10,47 @@
 // STL classes required to be included:
 #include <String>
 #include <vector>
-#include <map>
 
 #include <Preferences.h>               /// Preferences class, part of the ESP32 NVS storage library
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "nvs_handle.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"           /// For the `mutex`, the deferred `Save()` runs on another task.
+#include "freertos/timers.h"           /// For the `commitTimer`, the deferred `Save()`.
+#include "freertos/event_groups.h"     /// For the `flushGroup`, the task that makes the deferred `Save()`.
 
 #define TIMEZONE_UTC        "UTC"      ///< UTC timezone string, used when no timezone is defined.
+#define AP_RECORD_VERSION     1        ///< The version of the NVS AP record format, `APRecord` and `APStoreHeader`.
+#define AP_NO_SLOT          0xFF       ///< `idSlots` value of an unused ID.
+
+#ifndef SETTINGS_COMMIT_DELAY_MS
+   #define SETTINGS_COMMIT_DELAY_MS  5000   ///< The quiet period (ms) after the last change before a deferred `Save()`.
+#endif
 
 namespace BinaryClockShield
    {
+   /// @brief The fast reconnect data of the last AP connected to, kept in NVS.
+   /// @details With the BSSID and channel the connection is made without a scan. With the IP
+   ///          configuration of the DHCP lease the DHCP exchange is skipped too; the lease is
+   ///          renewed every `WIFI_FAST_IP_USES` connections so it doesn't expire on the server.
+   /// @see BinaryClockWAN::Begin()
+   /// @author Chris-70 (2026/10)
+   struct APFastConnect
+      {
+      uint8_t  id       = 0;        ///< The ID of the AP credentials, 0 = no data.
+      uint8_t  channel  = 0;        ///< The WiFi channel of the AP.
+      uint8_t  bssid[6] = { 0 };    ///< The MAC address of the AP.
+      uint8_t  ipUses   = 0;        ///< The number of connections with the cached IP since the DHCP lease.
+      uint8_t  reserved[3] = { 0 }; ///< Padding, no uninitialized bytes in the NVS blob.
+      uint32_t ip       = 0;        ///< The IP address of the DHCP lease, 0 = none.
+      uint32_t gateway  = 0;        ///< The gateway IP address of the DHCP lease.
+      uint32_t subnet   = 0;        ///< The subnet mask of the DHCP lease.
+      uint32_t dns1     = 0;        ///< The primary DNS server of the DHCP lease.
+      uint32_t dns2     = 0;        ///< The secondary DNS server of the DHCP lease.
+      bool IsValid() const { return (id != 0) && (channel != 0); }
+      }; // struct APFastConnect
+
    /// @brief The class that manages the Binary Clock settings, including WiFi credentials.
    /// @details This class uses the Preferences library to store and retrieve WiFi credentials.
    ///          It supports storing multiple access points and uses an `ID` value to differentiate
@@ -29,10 +59,18 @@ namespace BinaryClockShield
    ///          must be unique, however, multiple APs with the same SSID but different `BSSID`s
    ///          are stored as different entries and can have different passwords. The `BSSID` can be
    ///          empty, in which case the first AP with the matching SSID will be used.
+   ///          Each AP is stored as a fixed size record with a CRC under its own key (`APRecord`),
+   ///          a header lists the IDs stored (`APStoreHeader`). `Save()` only writes the records that
+   ///          changed and removes the deleted ones; the single blob of the old format is migrated
+   ///          by `Begin()`.
    /// @remarks `Begin()` must be called first in order to initialize this instance with the values
    ///          from the Non-Volatile Storage (NVS). `End()` should be called when done to free resources
    ///          and to optionally save any changes. `Clear()` can be used to clear all the stored APs
    ///          `Save()` must be called to save the current settings, including additions and/or deletions.
+   ///          `SaveDeferred()` waits for a quiet period so a burst of changes is saved together.
+   ///          The NVS namespace stays open from `Begin()` to `End()`. The methods are thread safe,
+   ///          the deferred save runs on the task given by `set_FlushEvent()`, else in the FreeRTOS
+   ///          timer task.
    /// @note    Calling `Clear()` followed by `Save()` will have the effect of removing all AP credentials
    ///          from the NVS.
    /// @author Chris-70 (2025/09)
@@ -78,11 +116,53 @@ namespace BinaryClockShield
 
       /// @brief Save the current AP credentials to NVS.
       /// @details This method saves the current AP credentials stored in RAM to NVS. It must be called
-      ///          after making any changes to the AP credentials to persist those changes.
+      ///          after making any changes to the AP credentials to persist those changes.   
+      ///          Only the new and changed records are written, then the header, then the records
+      ///          of the deleted entries are removed. A power failure leaves either the old or the
+      ///          new list of APs, each record is written whole or not at all.
       /// @return True if the save operation was successful, false otherwise.
       /// @author Chris-70 (2025/09)
       bool Save();
 
+      /// @brief Save the changes after a quiet period of `SETTINGS_COMMIT_DELAY_MS`.
+      /// @details Each call restarts the quiet period, the changes made until it ends are saved
+      ///          together by one `Save()`. `Flush()`, `End()` or a restart (`esp_restart()`) save
+      ///          a pending change at once.
+      /// @return True if the save is scheduled (or there is nothing to save).
+      /// @see Flush()
+      /// @author Chris-70 (2026/10)
+      bool SaveDeferred();
+
+      /// @brief Save a pending deferred change now, e.g. before a restart.
+      /// @return True if saved (or there is nothing to save).
+      /// @author Chris-70 (2026/10)
+      bool Flush();
+
+      /// @brief Set the event bits the deferred save signals, the task waiting on them calls `Flush()`.
+      /// @details The NVS writes block, from tens of ms to an erase of a page, and the mutex may be
+      ///          held by another task: the timer task then only sets the bits. Without an event
+      ///          group (`nullptr`) the timer callback saves.
+      /// @param group The event group, `nullptr` to save in the timer task.
+      /// @param bits The bits to set in `group`.
+      /// @author Chris-70 (2026/10)
+      void set_FlushEvent(EventGroupHandle_t group, EventBits_t bits);
+
+      /// @brief Keep a copy of the settings in RAM, to undo a set of changes with `Rollback()`.
+      /// @details E.g. a serial command frame: its records are applied after a checkpoint and,
+      ///          if one of them or the `Save()` fails, rolled back so none of them is kept.
+      /// @see Rollback()
+      /// @author Chris-70 (2026/10)
+      void Checkpoint();
+
+      /// @brief Restore the settings in RAM to the last `Checkpoint()`; the checkpoint is dropped.
+      /// @return True if restored, false if there is no checkpoint.
+      /// @see Checkpoint()
+      /// @author Chris-70 (2026/10)
+      bool Rollback();
+
+      /// @brief Drop the last `Checkpoint()`, the changes are kept.
+      void Release();
+
       /// @brief End the BinaryClockSettings instance and free resources.
       /// @details This method frees any resources used by the instance and optionally saves any changes.
       /// @note After this call, you must call `Begin()` before any other calls. 
@@ -99,6 +179,21 @@ namespace BinaryClockShield
       /// @author Chris-70 (2025/09)
       uint8_t GetID(const APNames& names) const;
 
+      /// @brief Find the ID of the stored AP credentials for an AP found by a scan.
+      /// @details The lookup goes through the hashed SSID index, no `String` is made for the APs
+      ///          of the scan that aren't stored. Credentials with the same BSSID are preferred to
+      ///          credentials without a BSSID (any AP with the SSID).
+      /// @param ssid The SSID of the AP, null terminated (e.g. `wifi_ap_record_t::ssid`).
+      /// @param bssid The 6 byte BSSID of the AP, nullptr for any.
+      /// @return The ID of the AP credentials if found, 0 otherwise.
+      /// @author Chris-70 (2026/10)
+      uint8_t FindID(const char* ssid, const uint8_t* bssid) const;
+
+      /// @brief The 32 bit FNV-1a hash of a SSID, the key of the SSID index.
+      /// @param ssid The SSID, null terminated.
+      /// @return The hash value.
+      static uint32_t HashSSID(const char* ssid);
+
       /// @brief Get the AP credentials for the given ID.
       /// @param id The ID of the access point.
       /// @return An APCredsPlus structure containing the AP credentials if found, otherwise an empty structure.
@@ -190,6 +285,7 @@ namespace BinaryClockShield
          // if (value.isEmpty())
          //    { value = TIMEZONE_UTC; }
             
+         SettingsLock lock(mutex);
          if (value != timezone)
             {
             timezone = value;
@@ -201,37 +297,98 @@ namespace BinaryClockShield
       /// @return A String object containing the timezone in Proleptic Format.
       /// @see set_Timezone()
       String get_Timezone() const
-         { return timezone; }
+         { 
+         SettingsLock lock(mutex);
+         return timezone; 
+         }
          
+      /// @brief Get the fast reconnect data of the last AP connected to.
+      /// @param value [OUT] The `APFastConnect` data, empty if none.
+      /// @return True if the data is valid and the AP credentials still exist.
+      /// @author Chris-70 (2026/10)
+      bool GetFastConnect(APFastConnect& value) const;
+
+      /// @brief Set the fast reconnect data and write it to NVS, if it changed.
+      /// @details The data is written at once, not by `Save()`, it isn't part of the AP credentials.
+      /// @param value The `APFastConnect` data, an empty value removes it from NVS.
+      /// @return True if the data is in NVS (or unchanged), false if the write failed.
+      /// @author Chris-70 (2026/10)
+      bool SetFastConnect(const APFastConnect& value);
+
+      /// @brief Remove the fast reconnect data, e.g. the AP credentials changed.
+      bool ClearFastConnect()
+         { return SetFastConnect(APFastConnect()); }
+
       /// @brief `Modified` Property: Indicates if the settings have been modified since last save.
       /// @details This property indicates whether any settings have been changed since the last save.
       /// @return True if settings have been modified, false otherwise.
       bool get_Modified() const
          { return modified; }
 
+      /// @brief Read only property: The number of NVS writes (each one a commit) since `Begin()`.
+      uint32_t get_NvsWrites() const
+         { return nvsWrites; }
+
    //#################################################################################//  
    // Protected METHODS                                                               //   
    //#################################################################################//   
 
    protected:
-      /// @brief Child structure of `APCredsPlus` to hold additional flags needed by this class.
+      /// @brief Scoped lock of the settings (recursive), released when it goes out of scope.
+      /// @author Chris-70 (2026/10)
+      struct SettingsLock
+         {
+         SemaphoreHandle_t handle;
+         explicit SettingsLock(SemaphoreHandle_t mutex) : handle(mutex) { xSemaphoreTakeRecursive(handle, portMAX_DELAY); }
+         ~SettingsLock() { xSemaphoreGiveRecursive(handle); }
+         };
+
+      /// @brief The NVS record of one AP's credentials, stored under its own key ("ap_<id>").
+      /// @details The record has a fixed size so a change rewrites only this record, not every AP;
+      ///          the CRC finds a damaged record, it is skipped by `Begin()` instead of losing all the APs.
+      ///          The same structure is kept in RAM (`ApAllInfo`), it is read and written in place, no
+      ///          `String` is made until the credentials are returned as an `APCredsPlus`.
+      /// @author Chris-70 (2026/10)
+      struct APRecord
+         {
+         uint8_t  version     = AP_RECORD_VERSION;  ///< The record format version.
+         uint8_t  id          = 0;                  ///< The ID of the AP credentials.
+         uint8_t  bssid[6]    = { 0 };              ///< The BSSID, all 0 for any AP with the SSID.
+         char     ssid[33]    = { 0 };              ///< The SSID, null terminated.
+         char     pw[65]      = { 0 };              ///< The password, null terminated.
+         uint8_t  reserved[2] = { 0 };              ///< Padding, no uninitialized bytes in the NVS blob.
+         uint32_t crc         = 0;                  ///< The CRC-32 of the record before this field.
+         };
+
+      /// @brief The AP credentials record with the additional flags needed by this class.
       /// @details This structure adds flags to indicate if the AP has been modified or marked for deletion.
       ///          The internal `apCreds` vector holds these objects which track the state of each AP and are
-      ///          used when saving the `APCredsPlus` objects to NVS.   
+      ///          used when saving the records to NVS.   
       ///          The `Save()` method processes this vector to update NVS and removes the entries 
       ///          marked for deletion.
       /// @see Save()
       /// @author Chris-70 (2025/09)
-      struct ApAllInfo : public APCredsPlus
+      struct ApAllInfo
          {
+         APRecord record;          ///< The AP credentials, as stored in NVS.
          bool modifiedAP  = false; ///< The AP value(s) has been modified and needs to be saved.
          bool toBeDeleted = false; ///< The AP entry is marked for deletion.
-         ApAllInfo(const APCredsPlus& creds) : APCredsPlus(creds) { }
-         ApAllInfo(const APCreds& creds) : APCredsPlus(creds) { }
-         ApAllInfo(const APNames& names) : APCredsPlus(names) { }
-         ApAllInfo(const ApAllInfo& apInfo) = default;
-         ApAllInfo() = default; // : APCredsPlus() {}
-         virtual ~ApAllInfo() = default;
+         };
+
+      /// @brief The NVS header of the AP records: the format version, the last ID and the IDs stored.
+      /// @details The header is written after the records it lists and before the records of the
+      ///          deleted entries are removed, so it never lists a record that isn't in NVS.
+      /// @author Chris-70 (2026/10)
+      struct APStoreHeader
+         {
+         uint8_t  version     = AP_RECORD_VERSION;  ///< The record format version.
+         uint8_t  lastID      = 0;                  ///< The ID assigned to the last AP created.
+         uint8_t  reserved[2] = { 0 };              ///< Padding, no uninitialized bytes in the NVS blob.
+         uint32_t ids[8]      = { 0 };              ///< Bitmap of the IDs with a record in NVS.
+         uint32_t crc         = 0;                  ///< The CRC-32 of the header before this field.
+         bool Has(uint8_t id) const { return (ids[id / 32] & (1UL << (id % 32))) != 0; }
+         void Set(uint8_t id)       { ids[id / 32] |= (1UL << (id % 32)); }
+         void Reset(uint8_t id)     { ids[id / 32] &= ~(1UL << (id % 32)); }
          };
 
       /// @brief Get a list of IDs for APs that match the given SSID.
@@ -243,7 +400,7 @@ namespace BinaryClockShield
 
       /// @brief Get the index of an AP entry by its ID.
       /// @details This helper method returns the index of the AP entry with the specified ID.
-      ///          This uses the `idList` map for efficient lookup. If the ID is not found, -1 is returned.
+      ///          This is a direct lookup in the `idSlots` table. If the ID is not found, -1 is returned.
       /// @param ID The ID of the AP entry to search for.
       /// @return The index of the matching AP entry, or -1 if not found.
       /// @author Chris-70 (2025/09)
@@ -251,9 +408,10 @@ namespace BinaryClockShield
 
       /// @brief Generate a new unique ID for a new AP entry.
       /// @details This method generates a new unique ID that is usually one greater than the last assigned ID.
-      ///          If the last ID is at the maximum value (255), it searches for the lowest available ID.
-      ///          Before assigning the ID it checks `idList` first to confirm it's not used.
-      ///          A maximum of `MAX_ID_SIZE` (i.e. 255) unique IDs can be generated.
+      ///          If the last ID is at the maximum value (`MAX_ID_SIZE`), it searches for the lowest available ID.
+      ///          The `idUsed` bitmap is searched 32 IDs at a time with a count trailing zeros.
+      ///          A maximum of `MAX_ID_SIZE` (i.e. 254) unique IDs can be generated. The ID of an entry
+      ///          marked for deletion stays in use until `Save()` removes the entry.
       /// @return A new unique ID for the AP entry, or 0 if no IDs are available.
       /// @author Chris-70 (2025/09)
       uint8_t GetNewID();
@@ -272,44 +430,64 @@ namespace BinaryClockShield
       /// @author Chris-70 (2025/09)
       bool changeDeleteStatus(uint8_t id, bool toDelete);
 
-      // Helper methods for serialization
-      /// @brief Serialize the AP credentials to a byte buffer.
-      /// @details This helper method serializes the given `APCredsPlus` object into a byte buffer.
-      ///          This buffer is stored in the NVS and is read back in the `deserializeAPCreds()` method.
-      /// @param buffer The byte buffer to write to.
-      /// @param offset The current offset in the buffer.
-      /// @param creds The `APCredsPlus` credentials to serialize.
+      /// @brief Load the AP records listed by the NVS header.
+      /// @details A damaged record (bad CRC, wrong size or ID) is skipped, `modified` is set so
+      ///          `Begin()` saves the header without it.
+      /// @return True if the header was found, false if there are no records (e.g. the old format).
+      /// @author Chris-70 (2026/10)
+      bool loadRecords();
+
+      /// @brief Load the AP credentials from the single blob of the old format, to be migrated.
+      /// @details The entries are marked as modified so `Save()`, called by `Begin()`, writes them
+      ///          as records, then removes the old blob.
+      /// @return True if AP credentials were loaded.
       /// @see deserializeAPCreds()
-      /// @author Chris-70 (2025/09)
-      void serializeAPCreds(uint8_t* buffer, size_t& offset, const APCredsPlus& creds) const;
-
-      /// @brief Deserialize the AP credentials from a byte buffer.
+      /// @author Chris-70 (2026/10)
+      bool loadBlob();
+
+      /// @brief Write the record of an AP's credentials to NVS, under its own key.
+      /// @param record The record to write, the CRC is set.
+      /// @return True if the record was written.
+      /// @author Chris-70 (2026/10)
+      bool writeRecord(APRecord& record);
+
+      /// @brief Get the index in `apCreds` of the entry matching the names, an empty BSSID matches any.
+      /// @param names The SSID and BSSID of the AP.
+      /// @param deleted True to include the entries marked for deletion.
+      /// @return The index of the first matching entry, -1 if not found.
+      /// @author Chris-70 (2026/10)
+      int matchIndex(const APNames& names, bool deleted) const;
+
+      /// @brief Copy the credentials into a record, the ID isn't changed.
+      /// @param creds The `APCreds` credentials.
+      /// @param record [OUT] The record.
+      /// @return True if the credentials fit: SSID, password and BSSID lengths and BSSID format.
+      bool toRecord(const APCreds& creds, APRecord& record) const;
+
+      /// @brief Make the `APCredsPlus` credentials of a record.
+      static APCredsPlus fromRecord(const APRecord& record);
+
+      /// @brief Check if a 6 byte BSSID is all 0, i.e. any AP with the SSID.
+      static bool anyBssid(const uint8_t* bssid);
+
+      /// @brief Get the NVS key of the record of an AP, e.g. "ap_12".
+      /// @param id The ID of the AP credentials.
+      /// @param key [OUT] The key, null terminated.
+      static void recordKey(uint8_t id, char (&key)[8]);
+
+      /// @brief Get the CRC-32 of a record or header, up to its `crc` field.
+      static uint32_t recordCrc(const void* data, size_t size);
+
+      /// @brief Deserialize the AP credentials from a byte buffer, the old single blob format.
       /// @details This helper method deserializes an `APCredsPlus` object from a byte buffer.
-      ///          This buffer is read from the NVS and is written back in the `serializeAPCreds()` method.
+      ///          The blob is only read to migrate it to the records, see `loadBlob()`.
       /// @param buffer The byte buffer to read from.
       /// @param offset The current offset in the buffer.
       /// @param creds The `APCredsPlus` credentials to deserialize.
-      /// @see serializeAPCreds()
+      /// @see loadBlob()
       /// @author Chris-70 (2025/09)
       void deserializeAPCreds(const uint8_t* buffer, size_t& offset, APCredsPlus& creds) const;
 
-      /// @brief Calculate the size needed to serialize an `APCredsPlus` object.
-      /// @details This helper method calculates the size in bytes needed to serialize the given
-      ///          `APCredsPlus` object.
-      /// @param creds The `APCredsPlus` credentials to serialize.
-      /// @return The size in bytes needed to serialize the `APCredsPlus` object.
-      /// @see calculateTotalSize()
-      /// @author Chris-70 (2025/09)
-      size_t calculateAPCredsSize(const APCredsPlus& creds) const;
-
-      /// @brief Calculate the total size needed to serialize all stored AP credentials.
-      /// @details This helper method calculates the total size in bytes needed to serialize all
-      ///          stored `APCredsPlus` objects.
-      /// @return The total size in bytes needed to serialize all `APCredsPlus` objects.
-      /// @see calculateAPCredsSize()
-      /// @author Chris-70 (2025/09)
-      size_t calculateTotalSize() const;
-
       /// @brief Update/find the AP credentials for an existing entry with the same SSID and BSSID, 
       ///        or just return the ID if the credentials are the same. 
       /// @details This helper method checks if an AP entry with the same SSID and BSSID already exists. 
@@ -322,6 +500,34 @@ namespace BinaryClockShield
       /// @author Chris-70 (2026/03)
       uint8_t updateWiFiCreds(const APCreds& creds);
 
+      /// @brief Set the `apCreds` index of an ID in the `idSlots` table and mark the ID as used.
+      void setSlot(uint8_t id, size_t index);
+
+      /// @brief Clear the `idSlots` table and the `idUsed` bitmap: no IDs.
+      void clearSlots();
+
+      /// @brief Get the first ID not used from `first` on.
+      /// @param first The first ID to check.
+      /// @return The ID, > `MAX_ID_SIZE` if there are none.
+      uint16_t findFreeID(uint16_t first) const;
+
+      /// @brief Write a blob to NVS and count the write.
+      /// @return True if written.
+      bool nvsPut(const char* key, const void* value, size_t length);
+
+      /// @brief Remove a key from NVS, if there, and count the write.
+      void nvsRemove(const char* key);
+
+      /// @brief The timer callback of the deferred `Save()`.
+      static void commitTimerCallback(TimerHandle_t timer);
+
+      /// @brief The `esp_restart()` shutdown handler, saves a pending deferred change.
+      static void shutdownHandler();
+
+      /// @brief Rebuild the hashed SSID index of `apCreds`, after entries are loaded, added or removed.
+      /// @author Chris-70 (2026/10)
+      void buildIndex();
+
    //#################################################################################//  
    //                                   FIELDS                                        //  
    //#################################################################################//   
@@ -334,19 +540,39 @@ namespace BinaryClockShield
    private:
       Preferences nvs;                    ///< The `Preferences` instance of the Non-Volatile Storage (NVS).
       std::vector<ApAllInfo> apCreds;     ///< Vector to hold the AP credentials in RAM.
-      std::map<uint8_t, size_t> idList;   ///< Map of the IDs in NVS, and their index in `apCreds`
+      uint8_t idSlots[UINT8_MAX + 1];     ///< The index in `apCreds` of each ID, `AP_NO_SLOT` if not used.
+      uint32_t idUsed[8]   = { 0 };       ///< Bitmap of the IDs in `apCreds`, incl. the entries marked for deletion.
+      std::vector<std::pair<uint32_t, uint16_t>> ssidIndex; ///< The SSID hash and `apCreds` index, sorted: the SSID index.
       String timezone;                    ///< The timezone string stored in NVS.
+      APFastConnect fastConnect;          ///< The fast reconnect data stored in NVS.
+      APStoreHeader storeHeader;          ///< The header of the AP records in NVS.
+      std::vector<ApAllInfo> checkpointCreds;  ///< The AP credentials at the last `Checkpoint()`.
+      String checkpointTimezone;          ///< The timezone at the last `Checkpoint()`.
+
+      SemaphoreHandle_t mutex          = nullptr;           ///< The recursive mutex of the settings.
+      TimerHandle_t commitTimer        = nullptr;           ///< The one shot timer of the deferred `Save()`.
+      EventGroupHandle_t flushGroup    = nullptr;           ///< The event group of the task that makes the deferred `Save()`.
+      EventBits_t flushBits            = 0;                 ///< The bits of `flushGroup` set when the deferred `Save()` is due.
+      uint32_t nvsWrites               = 0;                 ///< The NVS writes (commits) since `Begin()`.
+      uint32_t checkpointWrites        = 0;                 ///< The `nvsWrites` at the last `Checkpoint()`.
 
       bool initialized                 = false;             ///< Flag: The NVS data has been processed to RAM
+      bool nvsOpen                     = false;             ///< Flag: The NVS namespace is open (RW), from `Begin()` to `End()`.
+      bool savePending                 = false;             ///< Flag: A deferred `Save()` is scheduled.
       bool modified                    = false;             ///< Flag: A changes was made to the data.
       uint8_t numAPs                   = 0;                 ///< The number of saved APs in NVS.
       uint8_t lastID                   = 0;                 ///< The ID assigned to the last `APCredsPlus` object created.
+      uint8_t checkpointLastID         = 0;                 ///< The `lastID` at the last `Checkpoint()`.
+      bool checkpointModified          = false;             ///< The `modified` flag at the last `Checkpoint()`.
+      bool hasCheckpoint               = false;             ///< Flag: `Checkpoint()` was called, not yet rolled back or released.
 
       const char* nvsNamespace         = "bc_settings";     ///< The NVS namespace for the AP settings
-      const char* nvsKeyAPCreds        = "ap_creds";        ///< Key to store the vector of APCreds as blob
-      const char* nvsKeyNumAPs         = "num_aps";         ///< Key to store the number of access points in NVS (i.e. size of `id_array`)
-      const char* nvsKeyLastID         = "last_id";         ///< Key to store the last ID saved (next ID = last_id + 1;)
+      const char* nvsKeyAPHeader       = "ap_hdr";          ///< Key to store the `APStoreHeader` of the AP records
+      const char* nvsKeyAPCreds        = "ap_creds";        ///< Old format: Key to store the vector of APCreds as blob
+      const char* nvsKeyNumAPs         = "num_aps";         ///< Old format: Key to store the number of access points in NVS (i.e. size of `id_array`)
+      const char* nvsKeyLastID         = "last_id";         ///< Old format: Key to store the last ID saved (next ID = last_id + 1;)
       const char* nvsKeyTimezone       = "timezone";        ///< Key to store the timezone string
+      const char* nvsKeyFastConnect    = "fast_conn";       ///< Key to store the `APFastConnect` blob
 
       const size_t maxSSIDLength       = 32;                ///< Maximum SSID length
       const size_t maxPasswordLength   = 64;                ///< Maximum password length
@@ -18,6 +18,7 @@
 #include "esp_event.h"
 #include "esp_wifi.h"
 #include "esp_log.h"
+#include "esp_random.h"
 
 //################################################################################//
 #ifndef SERIAL_OUTPUT
@@ -42,15 +43,23 @@ namespace BinaryClockShield
    {
    BinaryClockWAN::BinaryClockWAN() : initialized(false), localIP(0,0,0,0)
       {
-      SERIAL_PRINT("BinaryClockWAN() constructor with IBinaryClock*: ")
-      SERIAL_PRINTLN(clockPtr? clockPtr->get_IdName() : "NULL")
+      LOG_WAN_INFO("BinaryClockWAN() constructor with IBinaryClock*: ")
+      LOG_WAN_INFO((clockPtr? clockPtr->get_IdName() : "NULL") << endl)
       WiFi.mode(WIFI_STA);
       zuluOffset = TimeSpan(0, -5, 0, 0); // Default to EST (UTC-5) // *** DEBUG ***
       wanEventGroup = xEventGroupCreate(); // Create the event group for WiFi events.
       ntpEventBits = TaskGroupBits<NtpEvents>(wanEventGroup, static_cast<uint8_t>(0)); // Initialize NTP event bits with no offset.
       wpsEventBits = TaskGroupBits<WpsEvents>(wanEventGroup, ntpEventBits.EventsCount); // Initialize WPS event bits with offset after NTP events.
+      wps.set_EventBits(wpsEventBits);       // The WPS events are signaled in the WAN event group.
       taskEventList.push_back(ntpEventBits); // Add NTP event bits to the task event list.
       taskEventList.push_back(wpsEventBits); // Add WPS event bits to the task event list.
+      wifiEventBits = TaskGroupBits<WiFiEvents>(wanEventGroup, ntpEventBits.EventsCount + wpsEventBits.EventsCount); // After the WPS events.
+      taskEventList.push_back(wifiEventBits); // Add WiFi event bits to the task event list.
+
+      wifiMutex = xSemaphoreCreateMutex();
+      wifiTimer = xTimerCreate("WiFiTimer", pdMS_TO_TICKS(WIFI_ATTEMPT_MS), pdFALSE, nullptr, wifiTimerCallback);
+      dutyTimer = xTimerCreate("DutyTimer", pdMS_TO_TICKS(SNTP_SYNC_INTERVAL_MS), pdFALSE, nullptr, dutyTimerCallback);
+      leapTimer = xTimerCreate("LeapTimer", pdMS_TO_TICKS(LEAP_TIMER_MAX_MS), pdFALSE, nullptr, leapTimerCallback);
       }
 
    BinaryClockWAN::~BinaryClockWAN()
@@ -62,21 +71,21 @@ namespace BinaryClockShield
       {
       if (!initialized) { return initialized; } // Ensure Begin() was called
 
-      bool result = false;
-      auto res = WiFi.disconnect(false, true); // Disconnect, keep radio ON and erase credentials to ensure clean state
-      SERIAL_STREAM("BinaryClockWAN() disconnecting from WiFi, result: " << (res ? "SUCCESS" : "FAILURE") << endl)  // *** DEBUG ***
-      vTaskDelay(pdMS_TO_TICKS(100)); // Short delay to ensure disconnect is processed
+      // The state machine connects by the credentials ID; restore the old entry if it fails.
+      APCredsPlus previous = settings.GetWiFiAP(settings.GetID(creds));
+      uint8_t id = settings.AddWiFiCreds(creds);
+      if (id == 0) { return false; }
 
-      // Connect to the specified WiFi network using the provided credentials.
-      auto status = WiFi.begin(creds.ssid.c_str(), creds.pw.c_str());
-      SERIAL_STREAM("BinaryClockWAN() connecting to " << creds.ssid << ", result: " << WiFiStatusString(status) << endl)
-      if (status == WL_CONNECTED)
+      WiFiCandidate candidate;
+      candidate.id = id;
+      bool result = connectWait(std::vector<WiFiCandidate>{ candidate });
+      LOG_WAN_INFO("BinaryClockWAN() connecting to " << creds.ssid << ", result: " << (result ? "SUCCESS" : "FAILURE") << endl)
+      if (!result)
          {
-         SERIAL_STREAM("Connected to " << creds.ssid << " with IP address " << WiFi.localIP() << endl)
-         settings.AddWiFiCreds(creds);
-         localIP = WiFi.localIP();
-         localCreds = creds;
-         result = true;
+         if (previous.IsValid())
+            { settings.AddWiFiCreds(previous); }
+         else
+            { settings.DeleteID(id); }
          }
 
       return result;
@@ -92,11 +101,17 @@ namespace BinaryClockShield
       {
       if (!bypassCheck && !initialized) { return initialized; } // Ensure Begin() was called
 
-      bool result = false;
       bool sta = WiFi.mode(WIFI_STA);
-      SERIAL_STREAM("connectLocalWiFi() - WiFi Station Mode: " << (sta ? "YES" : "NO") << endl)  // *** DEBUG ***
+      LOG_WAN_DEBUG("connectLocalWiFi() - WiFi Station Mode: " << (sta ? "YES" : "NO") << endl)  // *** DEBUG ***
+
+      if (localAPs.empty())
+         { scanKnownAPs(); }  // `Begin()` skips the scan with a fast connection.
+
+      APFastConnect cache;
+      settings.GetFastConnect(cache);
 
       std::vector<std::pair<APCredsPlus, WiFiInfo>> apCredList = settings.GetWiFiAPs(localAPs);
+      std::vector<WiFiCandidate> candidates;
       // Changed from structured binding to explicit access for compatibility with C++11.
       //    `for (const auto& [cred, info] : apCredList)`
       // While C++17 is prefeered such as for structured bindings, this change allows the code to compile in 
@@ -105,83 +120,279 @@ namespace BinaryClockShield
          {
          const APCredsPlus& cred = apEntry.first;
          const WiFiInfo& info = apEntry.second;
-         SERIAL_STREAM("  SSID: " << cred.ssid << ", BSSID: [" << cred.bssid << "], P/W: " << cred.pw 
-                << ", RSSI: " << info.rssi << ", AuthMode: " << AuthModeString(info.authMode) << endl) // *** DEBUG ***
+         LOG_WAN_DEBUG("  SSID: " << cred.ssid << ", BSSID: [" << cred.bssid << "], RSSI: " << info.rssi 
+                << ", AuthMode: " << AuthModeString(info.authMode) << endl) // *** DEBUG ***
 
-         // Ensure clean state before connection attempt
-         WiFi.disconnect(true);
-         vTaskDelay(pdMS_TO_TICKS(100));
+         WiFiCandidate candidate;
+         candidate.id = cred.id;
+         candidate.rssi = info.rssi;
+         candidate.bonus = (cred.id == cache.id) ? WIFI_LAST_AP_BONUS : 0;   // It worked last time.
+         candidates.push_back(candidate);
+         }
 
-         wl_status_t status;
-         uint8_t bssidArray[6];
+      return connectWait(candidates);
+      }
+
+   bool BinaryClockWAN::connectWait(const std::vector<WiFiCandidate>& candidates)
+      {
+      if (candidates.empty()) { return false; }
+
+      // The state machine makes the attempts from the WiFi events and the timer, just wait for the result.
+      wifiEventBits.WaitForBits({ WiFiEvents::Connected, WiFiEvents::Failed }, 0);   // Clear any old result.
+      if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+         {
+         wifiFsm.set_Candidates(candidates);
+         wifiFsm.set_Retry(false);   // The caller gets the result, e.g. `Begin()` falls back to WPS.
+         runAction(wifiFsm.Start());
+         xSemaphoreGive(wifiMutex);
+         }
 
-         if (!cred.bssid.isEmpty() && cred.bssidToBytes(bssidArray))
+      size_t msToWait = candidates.size() * WIFI_ATTEMPT_MS + SECONDS_MS;
+      EventBits_t bits = wifiEventBits.WaitForBits({ WiFiEvents::Connected, WiFiEvents::Failed }, msToWait);
+      return wifiEventBits.IsBitSet(bits, WiFiEvents::Connected);
+      }
+
+   void BinaryClockWAN::runAction(const WiFiAction& action)
+      {
+      switch (action.type)
+         {
+         case WiFiAction::Connect:
             {
-            // Single WiFi.begin() call with BSSID
-            status = WiFi.begin(cred.ssid.c_str(), cred.pw.c_str(), info.channel, bssidArray, true);
-            SERIAL_STREAM("  BinaryClockWAN()::connectLocalWiFi() - connecting to " << cred.ssid << ", on channel: " << info.channel << ", with BSSID" << endl)   // *** DEBUG ***
+            bool cached = startAttempt(action.id);
+            uint32_t timeoutMs = cached ? WIFI_FAST_CONNECT_MS : action.delayMs;
+            xTimerChangePeriod(wifiTimer, pdMS_TO_TICKS(timeoutMs), 0);  // Starts the timer.
             }
-         else
+            break;
+
+         case WiFiAction::Wait:
+            LOG_WAN_INFO("WiFi: no AP connected, retrying in " << action.delayMs << " ms" << endl)
+            xTimerChangePeriod(wifiTimer, pdMS_TO_TICKS(action.delayMs), 0);
+            break;
+
+         case WiFiAction::Failed:
+            xTimerStop(wifiTimer, 0);
+            wifiEventBits.SignalEvent(WiFiEvents::Failed);
+            break;
+
+         case WiFiAction::Done:
+            xTimerStop(wifiTimer, 0);
+            wifiEventBits.SignalEvent(WiFiEvents::Connected);
+            break;
+
+         default:
+            break;
+         }
+      }
+
+   bool BinaryClockWAN::startAttempt(uint8_t id)
+      {
+      APCredsPlus cred = settings.GetWiFiAP(id);
+      bool firstTry = (wifiFsm.GetFailures(id) == 0);
+
+      // The BSSID and channel from the scan, or the fast reconnect cache, save the driver's scan.
+      // After a failure the driver scans, the AP may have changed channel.
+      int32_t channel = 0;
+      uint8_t bssid[6] = { 0 };
+      bool haveBssid = false;
+      for (const auto& info : localAPs)
+         {
+         if (firstTry && (settings.GetID(info) == id) && info.bssidToBytes(bssid))
             {
-            SERIAL_STREAM("    Missing/Invalid BSSID format in credentials: [" << cred.bssid << "]" << endl) // *** DEBUG ***
-            status = WiFi.begin(cred.ssid.c_str(), cred.pw.c_str());
-            SERIAL_STREAM("BinaryClockWAN() connecting to " << cred.ssid << " without BSSID" << endl) // *** DEBUG ***
+            channel = info.channel;
+            haveBssid = true;
+            break;
             }
+         }
+
+      APFastConnect cache;
+      bool cached = firstTry && settings.GetFastConnect(cache) && (cache.id == id);
+      if (cached && !haveBssid)
+         {
+         channel = cache.channel;
+         memcpy(bssid, cache.bssid, sizeof(bssid));
+         haveBssid = true;
+         }
+
+      // The cached DHCP lease skips the DHCP exchange.
+      bool cachedIP = cached && (cache.ip != 0) && (cache.ipUses < WIFI_FAST_IP_USES);
+      if (cachedIP)
+         {
+         WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet),
+                     IPAddress(cache.dns1), IPAddress(cache.dns2));
+         }
+      else if (attemptCachedIP)
+         { WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); }  // Back to DHCP.
+      attemptCachedIP = cachedIP;
 
-         // Wait for connection with proper timeout
-         uint32_t startTime = millis();
-         const uint32_t CONNECT_TIMEOUT = 15000;  // 15 seconds
-         uint8_t count = 0;
+      LOG_WAN_DEBUG("WiFi: attempt " << wifiFsm.get_Attempts() << ", connecting to " << cred.ssid << " (ID " << id 
+            << ", failures " << wifiFsm.GetFailures(id) << ")" << (haveBssid ? " with BSSID" : "") 
+            << (cachedIP ? " with the cached IP" : "") << endl)   // *** DEBUG ***
+      if (haveBssid)
+         { WiFi.begin(cred.ssid.c_str(), cred.pw.c_str(), channel, bssid, true); }
+      else
+         { WiFi.begin(cred.ssid.c_str(), cred.pw.c_str()); }
 
-         while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < CONNECT_TIMEOUT)
-            {
-            wl_status_t currentStatus = WiFi.status();
+      return cached;
+      }
 
-            // Check for failure states
-            if  (    currentStatus == WL_CONNECT_FAILED
-                  || currentStatus == WL_NO_SSID_AVAIL 
-                  || currentStatus == WL_CONNECTION_LOST)
+   void BinaryClockWAN::wifiTimerCallback(TimerHandle_t timer)
+      {
+      // The timer task can't block on the mutex and the WiFi driver, the WAN task runs the state machine.
+      get_Instance().wifiEventBits.SignalEvent(WiFiEvents::Timeout);
+      }
+
+   void BinaryClockWAN::wifiTimeout()
+      {
+      if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+         {
+         if (xTimerIsTimerActive(wifiTimer) == pdFALSE)  // Not started again since it expired.
+            {
+            if (wifiFsm.get_State() == WiFiState::Connecting)
                {
-               SERIAL_STREAM("Connection failed with status: " << WiFiStatusString(currentStatus) << endl)   // *** DEBUG ***
-               break;
+               // The attempt timed out, end it first; its disconnect event is expected, not a failure.
+               LOG_WAN_INFO("WiFi: attempt timed out" << endl)
+               leaving = true;
+               WiFi.disconnect(false);
                }
-
-            vTaskDelay(pdMS_TO_TICKS(500));
-            SERIAL_PRINT(".")   // *** DEBUG ***
-            count++;
+            runAction(wifiFsm.TimerExpired());
             }
-         SERIAL_PRINTLN()
+         xSemaphoreGive(wifiMutex);
+         }
+      }
 
-         // Check final status
-         wl_status_t finalStatus = WiFi.status();
-         SERIAL_STREAM("BinaryClockWAN() final result: " << WiFiStatusString(finalStatus) << endl) // *** DEBUG ***
+   void BinaryClockWAN::wanTaskRun(void* param)
+      {
+      BinaryClockWAN& wan = get_Instance();
+      for (;;)
+         {
+         EventBits_t bits = wan.wifiEventBits.WaitForBits({ WiFiEvents::Timeout, WiFiEvents::Flush }, HOURS_MS);
+         if (wan.wifiEventBits.IsBitSet(bits, WiFiEvents::Timeout))
+            { wan.wifiTimeout(); }
+         if (wan.wifiEventBits.IsBitSet(bits, WiFiEvents::Flush))
+            { wan.settings.Flush(); }
+         }
+      }
 
-         if (finalStatus == WL_CONNECTED)
-            {
-            SERIAL_PRINTLN("  >> Connected! <<")  // *** DEBUG ***
-            SERIAL_STREAM("Connected to " << cred.ssid << " with IP address " << WiFi.localIP() << endl)  // *** DEBUG ***
+   bool BinaryClockWAN::scanKnownAPs()
+      {
+      // The channel order: the last AP's channel, the usual 1, 6 and 11, then the others allowed.
+      wifi_country_t country = { };
+      if ((esp_wifi_get_country(&country) != ESP_OK) || (country.nchan == 0))
+         {
+         country.schan = 1;
+         country.nchan = 11;
+         }
+      uint8_t lastChannel = (uint8_t)(country.schan + country.nchan - 1);
 
-            localIP = WiFi.localIP();
-            localCreds = cred;
-            WiFi.persistent(true);
-            WiFi.setAutoReconnect(true);
+      APFastConnect cache;
+      settings.GetFastConnect(cache);
+      const uint8_t first[] = { cache.channel, 1, 6, 11 };
+      scanCount = 0;
+      for (uint8_t channel : first)
+         {
+         if ((channel >= country.schan) && (channel <= lastChannel) && (memchr(scanChannels, channel, scanCount) == nullptr))
+            { scanChannels[scanCount++] = channel; }
+         }
+      scanLikely = scanCount;
+      for (uint8_t channel = country.schan; (channel <= lastChannel) && (scanCount < sizeof(scanChannels)); channel++)
+         {
+         if (memchr(scanChannels, channel, scanCount) == nullptr)
+            { scanChannels[scanCount++] = channel; }
+         }
 
-            result = true;
-            break; // Exit the loop on successful connection
-            }
-         else
-            {
-            SERIAL_STREAM("Failed to connect to " << cred.ssid << ", final status: " << WiFiStatusString(finalStatus) << endl) // *** DEBUG ***
-            }
+      localAPs.clear();
+      scanBestRssi = INT16_MIN;
+      scanNext = 0;
+      wifiEventBits.WaitForBits(WiFiEvents::ScanDone, 0);   // Clear any old result.
+      uint32_t startMs = millis();
+
+      scanning = true;
+      if (!scanNextChannel())
+         { scanning = false; }
+      else
+         {
+         size_t msToWait = scanCount * (WIFI_SCAN_DWELL_LONG_MS + 50) + SECONDS_MS;
+         wifiEventBits.WaitForBits(WiFiEvents::ScanDone, msToWait);
+         scanning = false;
          }
 
-      return result;
+      LOG_WAN_INFO("scanKnownAPs() - found " << localAPs.size() << " known APs on " << scanNext << " of " << scanCount 
+            << " channels in " << (millis() - startMs) << " ms" << endl)
+      return !localAPs.empty();
+      }
+
+   bool BinaryClockWAN::scanNextChannel()
+      {
+      while (scanNext < scanCount)
+         {
+         uint8_t channel = scanChannels[scanNext++];
+         uint32_t dwellMs = (scanNext <= scanLikely) ? WIFI_SCAN_DWELL_LONG_MS : WIFI_SCAN_DWELL_MS;
+         int16_t status = WiFi.scanNetworks(true, false, false, dwellMs, channel);
+         if (status != WIFI_SCAN_FAILED) { return true; }
+
+         LOG_WAN_ERROR("scanNextChannel() - failed to scan channel " << channel << endl)
+         }
+
+      return false;
+      }
+
+   void BinaryClockWAN::scanChannelDone()
+      {
+      int16_t count = WiFi.scanComplete();
+      for (int16_t i = 0; i < count; i++)
+         {
+         // Match the raw scan record, a `WiFiInfo` is only made for the APs with stored credentials.
+         const wifi_ap_record_t* record = static_cast<const wifi_ap_record_t*>(WiFi.getScanInfoByIndex(i));
+         if (record == nullptr) { continue; }
+
+         uint8_t id = settings.FindID(reinterpret_cast<const char*>(record->ssid), record->bssid);
+         if (id == 0) { continue; }
+
+         WiFiInfo info(APNames(String(reinterpret_cast<const char*>(record->ssid)), WiFi.BSSIDstr(i)));
+         info.rssi = record->rssi;
+         info.channel = record->primary;
+         info.authMode = record->authmode;
+         localAPs.push_back(info);
+         if (info.rssi > scanBestRssi) { scanBestRssi = info.rssi; }
+         LOG_WAN_DEBUG("  Known AP " << info.ssid << ", BSSID: [" << info.bssid << "] (" << info.rssi << "dBm) on channel " 
+               << info.channel << ", ID " << id << endl)  // *** DEBUG ***
+         }
+      WiFi.scanDelete();
+
+      // A strong known AP is good enough, don't spend the time on the other channels.
+      if ((scanBestRssi >= WIFI_SCAN_GOOD_RSSI) || !scanNextChannel())
+         {
+         scanning = false;
+         wifiEventBits.SignalEvent(WiFiEvents::ScanDone);
+         }
+      }
+
+   void BinaryClockWAN::saveFastConnect(uint8_t id, bool cachedIP)
+      {
+      APFastConnect cache;
+      settings.GetFastConnect(cache);
+      uint8_t ipUses = (cachedIP && cache.ipUses < UINT8_MAX) ? cache.ipUses + 1 : 0;
+
+      cache = APFastConnect();
+      const uint8_t* bssid = WiFi.BSSID();
+      if (id == 0 || bssid == nullptr) { return; }
+
+      cache.id = id;
+      cache.channel = static_cast<uint8_t>(WiFi.channel());
+      memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+      cache.ipUses = ipUses;
+      cache.ip = static_cast<uint32_t>(WiFi.localIP());
+      cache.gateway = static_cast<uint32_t>(WiFi.gatewayIP());
+      cache.subnet = static_cast<uint32_t>(WiFi.subnetMask());
+      cache.dns1 = static_cast<uint32_t>(WiFi.dnsIP(0));
+      cache.dns2 = static_cast<uint32_t>(WiFi.dnsIP(1));
+      settings.SetFastConnect(cache);
       }
 
    std::vector<WiFiInfo> BinaryClockWAN::GetAvailableNetworks()
       {
       size_t n = WiFi.scanNetworks(false, true);
-      SERIAL_STREAM("GetAvailableNetworks() - scan done, found " << n << " networks" << endl) // *** DEBUG ***
+      LOG_WAN_DEBUG("GetAvailableNetworks() - scan done, found " << n << " networks" << endl) // *** DEBUG ***
       std::vector<WiFiInfo> networks(n);
       for (size_t i = 0; i < n; ++i)
          {
@@ -194,7 +405,7 @@ namespace BinaryClockShield
          
          // networks.push_back(info);
          networks[i] = info;
-         SERIAL_STREAM(i + 1 << ": " << info.ssid << ", BSSID: [" << info.bssid << "] (" << info.rssi << "dBm) " 
+         LOG_WAN_DEBUG(i + 1 << ": " << info.ssid << ", BSSID: [" << info.bssid << "] (" << info.rssi << "dBm) " 
                     << AuthModeString(info.authMode) << endl) // << WiFi.persistent(true) << WiFi.isProvEnabled() << endl)  // *** DEBUG ***
          }
 
@@ -208,11 +419,11 @@ namespace BinaryClockShield
       clockPtr = &binClock;   // Save the pointer to the implementation of IBinaryClock
       bool result = !autoConnect;
 
-      SERIAL_PRINT("BinaryClockWAN::Begin(IBinaryClock& binClock, bool autoConnect) called with: ")
-      SERIAL_PRINTLN(binClock.get_IdName())
+      LOG_WAN_INFO("BinaryClockWAN::Begin(IBinaryClock& binClock, bool autoConnect) called with: ")
+      LOG_WAN_INFO((binClock.get_IdName()) << endl)
       if (clockPtr == nullptr || clockPtr != &binClock)  // Safety check
          {
-         SERIAL_PRINTLN("ERROR: Invalid IBinaryClock reference!")
+         LOG_WAN_ERROR("ERROR: Invalid IBinaryClock reference!" << endl)
          return false;
          }
          
@@ -227,48 +438,84 @@ namespace BinaryClockShield
                this->WiFiEvent(event, info);
                });
 
+         // The WiFi timer and the deferred save of the settings are handled on the WAN task.
+         if (wanTask == nullptr)
+            {
+            BaseType_t created = xTaskCreate(wanTaskRun, "WiFiWanTask", 4096, nullptr, tskIDLE_PRIORITY + 2, &wanTask);
+            if (created != pdPASS)
+               {
+               LOG_WAN_ERROR("ERROR: xTaskCreate failed for WiFiWanTask" << endl)
+               wanTask = nullptr;
+               return false;
+               }
+            }
+
+         uint32_t startMs = millis();
          settings.Begin();    // Read the settings from the Non-Volatile Storage.
-         localAPs = GetAvailableNetworks();  // Find all the APs in the area.
-         SERIAL_STREAM("BinaryClockWAN::Begin() - found " << localAPs.size() << " networks" << endl)
+         settings.set_FlushEvent(wifiEventBits.get_EventGroup(), wifiEventBits.GetMask(WiFiEvents::Flush));
 
-         if (autoConnect)
+         // The state machine reconnects after a lost connection, not the WiFi driver.
+         WiFi.setAutoReconnect(false);
+         wifiFsm.Reset();
+         wifiFsm.set_Seed(esp_random());
+
+         // Try the last AP first, without a scan; scan for all the APs if that fails.
+         APFastConnect cache;
+         bool fastResult = false;
+         if (autoConnect && settings.GetFastConnect(cache))
             {
-            bool apResult = connectLocalWiFi(true);
-            SERIAL_STREAM("Begin(): Connected to local AP: " << (apResult ? WiFi.SSID() : "false") << endl) // *** DEBUG ***
+            WiFiCandidate candidate;
+            candidate.id = cache.id;
+            fastResult = connectWait(std::vector<WiFiCandidate>{ candidate });
+            }
+         if (!fastResult)
+            {
+            scanKnownAPs();  // Find the known APs in the area.
+            LOG_WAN_INFO("BinaryClockWAN::Begin() - found " << localAPs.size() << " known networks" << endl)
+            }
 
-            // Wait for connection to stabilize BEFORE initializing SNTP
-            vTaskDelay(pdMS_TO_TICKS(2000));  // Give WiFi time to stabilize
+         if (autoConnect)
+            {
+            bool apResult = fastResult || connectLocalWiFi(true);
+            LOG_WAN_DEBUG("Begin(): Connected to local AP: " << (apResult ? WiFi.SSID() : "false") << endl) // *** DEBUG ***
+            if (apResult)
+               {
+               connectMs = millis();
+               LOG_WAN_INFO("Begin(): WiFi connected " << connectMs << " ms after boot, in " << (connectMs - startMs) 
+                     << " ms (" << (fastResult ? "cached AP" : "scan") << ")" << endl)
+               }
 
-            // Check connection was made and is still active
+            // Check connection was made (got an IP) and is still active
             if (!apResult || !WiFi.isConnected())
                {
-               //
+               if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+                  {
+                  xTimerStop(wifiTimer, 0);
+                  wifiFsm.Stop();   // The WiFi events of the WPS enrollment are ignored.
+                  xSemaphoreGive(wifiMutex);
+                  }
+
                WPSResult wpsResult = wps.ConnectWPS();
-               if (wpsResult.success)
+               if (wpsResult.success && connectProvisioned(wpsResult))
                   {
-                  SERIAL_STREAM("    WPS connected to " << wpsResult.credentials.ssid << " with IP " << WiFi.localIP() << endl) // *** DEBUG ***
-                  localIP = WiFi.localIP();
-                  localCreds = wpsResult.credentials;
-                  settings.AddWiFiCreds(wpsResult.credentials);
-                  settings.Save();
+                  LOG_WAN_DEBUG("    WPS connected to " << wpsResult.credentials.ssid << " with IP " << WiFi.localIP() << endl) // *** DEBUG ***
                   result = ConnectSNTP();
                   }
                else
                   {
-                  SERIAL_STREAM("    WPS connection failed: " << wpsResult.errorMessage << endl) // *** DEBUG ***
+                  LOG_WAN_ERROR("    WPS connection failed: " << wpsResult.errorMessage << endl) // *** DEBUG ***
                   result = false;
                   }
                }
             else
                {
-               SERIAL_STREAM("    Connected to WiFi. ")
-               WiFi.setAutoReconnect(true);
+               LOG_WAN_INFO("    Connected to WiFi. ")
 
                // Disable WiFi power saving
                WiFi.setSleep(false);
                esp_wifi_set_ps(WIFI_PS_NONE);
 
-               SERIAL_STREAM("BinaryClockWAN::Begin() - Connection is stable, now initializing NTP..." << endl) // *** DEBUG ***
+               LOG_WAN_DEBUG("BinaryClockWAN::Begin() - Connection is stable, now initializing NTP..." << endl) // *** DEBUG ***
                result = ConnectSNTP();
                }
             }
@@ -285,7 +532,7 @@ namespace BinaryClockShield
          }
 
       initialized = result;   // Sync the flag with the final result.
-      SERIAL_STREAM("    BinaryClockWAN::Begin() Result: " << (result ? "Success" : "Failure") << endl) // *** DEBUG ***
+      LOG_WAN_DEBUG("    BinaryClockWAN::Begin() Result: " << (result ? "Success" : "Failure") << endl) // *** DEBUG ***
       // SERIAL_STREAM("[" << millis() << "] BinaryClockWAN::Begin() - Waiting for splash screen to complete (via EventGroup)..." << endl)
    
       // // Wait for splash screen to finish using FreeRTOS EventGroup (proper synchronization, no polling/delays)
@@ -326,11 +573,11 @@ namespace BinaryClockShield
       //       this->SyncAlert(time);  // Call the instance method
       //       });
       bool regResult = ntp.RegisterSyncCallback(std::bind(&BinaryClockWAN::SyncAlert, this, std::placeholders::_1));
-      SERIAL_STREAM("    Registered SyncAlert callback: " << (regResult ? "Success" : "Failure") << endl) // *** DEBUG ***
+      LOG_WAN_DEBUG("    Registered SyncAlert callback: " << (regResult ? "Success" : "Failure") << endl) // *** DEBUG ***
       
       if (!regResult)
          {
-         SERIAL_PRINTLN("    ERROR: Failed to register NTP sync callback!")
+         LOG_WAN_ERROR("    ERROR: Failed to register NTP sync callback!" << endl)
          return false;
          }
       
@@ -347,15 +594,239 @@ namespace BinaryClockShield
       // Give the system a moment to stabilize after callback registration
       vTaskDelay(pdMS_TO_TICKS(100));
       
-      ntp.Begin(ntpServers, 5000, false);  // Increased delay to 5000ms to give Core 0/1 time to stabilize
+      // With the duty cycle the SNTP service isn't started, `dutyWake()` calls `SyncTime()` with the radio on.
+      // The NTP server and the peer sync need the sync results (reference, stratum), they sync the same way
+      // with the radio kept on. The metrics server only needs the radio on, for the scrapes.
+      const size_t startDelayMs = 5000;
+      bool keepOn = serveTime || peerMode;
+      bool manualSync = dutyMode || keepOn;
+      dutyCycle.set_KeepOn(keepOn || serveMetrics);
+      ntp.set_NtpGroupBits(&ntpEventBits);
+      ntp.set_ManualSync(manualSync);
+      ntp.Begin(ntpServers, startDelayMs, false);  // Increased delay to 5000ms to give Core 0/1 time to stabilize
+      wifiEventBits.SignalEvent(WiFiEvents::RadioOn);
+      if (manualSync) 
+         { startDutyCycle(startDelayMs); }
+      if (keepOn)
+         { WiFi.setSleep(false); }   // The modem sleep would delay the requests by up to a DTIM interval.
+      if (serveTime)
+         { ntpServer.Begin(clockPtr); }
+      if (peerMode)
+         { peerSync.Begin(clockPtr); }
+      if (serveMetrics)
+         { metricsServer.Begin(); }
       
-      SERIAL_STREAM("    BinaryClockWAN::ConnectSNTP() - initialized NTP; Updating time..." << endl) // *** DEBUG ***
+      LOG_WAN_DEBUG("    BinaryClockWAN::ConnectSNTP() - initialized NTP; Updating time..." << endl) // *** DEBUG ***
 
       return regResult;
       }
 
+   void BinaryClockWAN::startDutyCycle(uint32_t delayMs)
+      {
+      if (dutyTask == nullptr)
+         {
+         BaseType_t created = xTaskCreate(dutyTaskRun, "WiFiDutyTask", 4096, nullptr, tskIDLE_PRIORITY + 1, &dutyTask);
+         if (created != pdPASS)
+            {
+            LOG_WAN_ERROR("ERROR: xTaskCreate failed for WiFiDutyTask, the radio stays on" << endl)
+            dutyTask = nullptr;
+            return;
+            }
+         }
+
+      dutyCycle.Start(millis());
+      xTimerChangePeriod(dutyTimer, pdMS_TO_TICKS(delayMs), 0);   // Starts the timer.
+      }
+
+   void BinaryClockWAN::dutyWake()
+      {
+      bool connected = WiFi.isConnected();
+      if (!connected)
+         {
+         radioOn();
+         dutyCycle.Wake(millis());
+
+         // The last AP with its cached BSSID, channel and IP first, the scan for the known APs if that fails.
+         APFastConnect cache;
+         if (settings.GetFastConnect(cache))
+            {
+            WiFiCandidate candidate;
+            candidate.id = cache.id;
+            connected = connectWait(std::vector<WiFiCandidate>{ candidate });
+            }
+         if (!connected)
+            {
+            localAPs.clear();
+            connected = connectLocalWiFi(true);
+            }
+         }
+
+      uint32_t sleepMs = 0;
+      if (connected)
+         {
+         dutyCycle.Connected(millis());
+         DateTime synced = SyncTimeNTP();    // Signals `NtpEvents::Synced`.
+         sleepMs = dutyCycle.Synced(millis(), synced > DateTime::DateTimeEpoch, ntp.get_SyncInterval());
+         }
+      else
+         { sleepMs = dutyCycle.Failed(millis(), ntp.get_SyncInterval()); }
+
+      if (dutyCycle.get_State() == RadioState::Off)
+         { radioOff(); }
+      xTimerChangePeriod(dutyTimer, pdMS_TO_TICKS(sleepMs), 0);
+
+      uint32_t nowMs = millis();
+      LOG_WAN_INFO("WiFi duty cycle: " << (connected ? "synced" : "not connected") << ", next wake in " << (sleepMs / SECONDS_MS) 
+            << " s (lead " << dutyCycle.get_LeadMs() << " ms); radio on " << (dutyCycle.GetOnMsPerDay(nowMs) / SECONDS_MS) 
+            << " s/day, " << dutyCycle.GetAverageUa(nowMs) << " uA average" << endl)
+      }
+
+   void BinaryClockWAN::radioOn()
+      {
+      WiFi.mode(WIFI_STA);
+      WiFi.setSleep(false);   // No power save while on, the radio is only on for the sync.
+      wifiEventBits.SignalEvent(WiFiEvents::RadioOn);
+      }
+
+   void BinaryClockWAN::radioOff()
+      {
+      if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+         {
+         xTimerStop(wifiTimer, 0);
+         wifiFsm.Stop();   // The disconnect event is ignored, no reconnect.
+         xSemaphoreGive(wifiMutex);
+         }
+
+      xEventGroupClearBits(wifiEventBits.get_EventGroup(), wifiEventBits.GetMask(WiFiEvents::RadioOn));
+      WiFi.disconnect(true);  // Disconnect and power the radio down (WIFI_OFF).
+      }
+
+   void BinaryClockWAN::dutyTaskRun(void* param)
+      {
+      BinaryClockWAN& wan = get_Instance();
+      for (;;)
+         {
+         EventBits_t bits = wan.wifiEventBits.WaitForBits({ WiFiEvents::Wake, WiFiEvents::Leap }, HOURS_MS);
+         if (wan.wifiEventBits.IsBitSet(bits, WiFiEvents::Leap))
+            { wan.leapStep(); }
+         if (wan.wifiEventBits.IsBitSet(bits, WiFiEvents::Wake))
+            { wan.dutyWake(); }
+         }
+      }
+
+   void BinaryClockWAN::dutyTimerCallback(TimerHandle_t timer)
+      {
+      // The timer task can't block on the connection and the sync, the duty cycle task does them.
+      get_Instance().wifiEventBits.SignalEvent(WiFiEvents::Wake);
+      }
+
+   void BinaryClockWAN::scheduleLeap()
+      {
+      if (dutyTask == nullptr) { return; }   // The SNTP service sets the clock, its next sync has the leap.
+
+      const LeapSecond& leap = ntp.get_Leap();
+      if ((leap.get_Leap() == leapPlanned) && (leap.get_EventS() == leapEventS)) { return; }
+
+      leapPlanned = leap.get_Leap();
+      leapEventS = leap.get_EventS();
+      if (leapPlanned == 0)
+         {
+         xTimerStop(leapTimer, 0);
+         if (leapOnClock && (clockPtr != nullptr)) { clockPtr->ScheduleLeapSecond(DateTime(), 0); }
+         leapOnClock = false;
+         LOG_WAN_INFO("Leap second: withdrawn by the NTP servers." << endl)
+         return;
+         }
+
+      // The clock plans it in local time: the first second after the leap.
+      time_t eventS = (time_t)leapEventS;
+      struct tm timeinfo = { 0 };
+      localtime_r(&eventS, &timeinfo);
+      DateTime at(timeinfo);
+      leapOnClock = (clockPtr != nullptr) && clockPtr->ScheduleLeapSecond(at, leapPlanned, leapSmearS);
+      LOG_WAN_INFO("Leap second: " << ((leapPlanned > 0) ? "insert" : "delete") << " a second before " 
+                   << at.timestamp(DateTime::TIMESTAMP_DATETIME) << " (local); " << (leapOnClock ? "made by the clock" : "clock aligned after it") << endl)
+      leapStep();    // Starts the timer.
+      }
+
+   void BinaryClockWAN::leapStep()
+      {
+      const LeapSecond& leap = ntp.get_Leap();
+      int8_t value = leap.get_Leap();
+      if (value == 0) { return; }   // Withdrawn, or a sync after the event applied it.
+
+      // The timer is started again until the system clock is there, it may have been synced meanwhile.
+      int64_t nowUs = BinaryClockNTP::SystemMicros();
+      int64_t waitMs = (leap.get_StepS() * 1000000LL - nowUs) / 1000LL;
+      if (waitMs > 0)
+         {
+         uint32_t periodMs = (waitMs > (int64_t)LEAP_TIMER_MAX_MS) ? LEAP_TIMER_MAX_MS : (uint32_t)waitMs;
+         TickType_t ticks = pdMS_TO_TICKS(periodMs);
+         xTimerChangePeriod(leapTimer, (ticks > 0) ? ticks : 1, 0);   // Starts the timer.
+         return;
+         }
+
+      // The system clock repeats 23:59:59 (insert) or skips it (delete).
+      int64_t stepUs = nowUs - (int64_t)value * 1000000LL;
+      struct timeval tv = { (time_t)(stepUs / 1000000LL), (suseconds_t)(stepUs % 1000000LL) };
+      settimeofday(&tv, nullptr);
+      ntp.LeapApplied();
+      leapPlanned = 0;
+      leapEventS = 0;
+      if (serveTime) { ntpServer.ClearLeap(); }
+
+      if (!leapOnClock && (clockPtr != nullptr))
+         {
+         uint16_t fractionMs = 0;
+         DateTime now = getSystemTime(fractionMs);
+         clockPtr->AdjustTime(now, fractionMs);    // A second, slewed.
+         }
+      leapOnClock = false;
+      LOG_WAN_INFO("Leap second: system clock stepped " << (int)-value << " s, " << (int)(-waitMs) << " ms after the event." << endl)
+      }
+
+   void BinaryClockWAN::leapTimerCallback(TimerHandle_t timer)
+      {
+      // The timer task can't block on the clock's I2C, the duty cycle task makes the step.
+      get_Instance().wifiEventBits.SignalEvent(WiFiEvents::Leap);
+      }
+
+   bool BinaryClockWAN::connectProvisioned(const WPSResult& wpsResult)
+      {
+      uint8_t id = settings.AddWiFiCreds(wpsResult.credentials);
+      if (id == 0) { return false; }
+      settings.SaveDeferred();
+
+      // The BSSID and channel of the AP that enrolled the clock make the first attempt a fast connect.
+      APFastConnect cache;
+      if ((wpsResult.channel != 0) && !wpsResult.credentials.bssid.isEmpty() && wpsResult.credentials.bssidToBytes(cache.bssid))
+         {
+         cache.id = id;
+         cache.channel = wpsResult.channel;
+         settings.SetFastConnect(cache);
+         }
+
+      // A failed fast attempt is retried once with the driver's scan, e.g. the AP changed channel.
+      WiFiCandidate candidate;
+      candidate.id = id;
+      std::vector<WiFiCandidate> candidates{ candidate };
+      return connectWait(candidates) || connectWait(candidates);
+      }
+
    void BinaryClockWAN::End(bool save)
       {
+      if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+         {
+         xTimerStop(wifiTimer, 0);
+         wifiFsm.Stop();   // The disconnect event is ignored.
+         xSemaphoreGive(wifiMutex);
+         }
+      xTimerStop(dutyTimer, 0);  // The duty cycle task waits for the next `Begin()`.
+      xTimerStop(leapTimer, 0);
+      ntpServer.End();
+      peerSync.End();
+      metricsServer.End();
+      xEventGroupClearBits(wifiEventBits.get_EventGroup(), wifiEventBits.GetMask(WiFiEvents::RadioOn));
       ntp.UnregisterSyncCallback();
       WiFi.disconnect();
       WiFi.removeEvent(eventID);
@@ -371,24 +842,36 @@ namespace BinaryClockShield
       return UpdateTime(time);
       }
 
-   bool BinaryClockWAN::UpdateTime(DateTime& time)
+   bool BinaryClockWAN::UpdateTime(DateTime& time, uint16_t fractionMs)
       {
       if (!initialized || clockPtr == nullptr) { return false; } // Ensure Begin() was called and clockPtr is valid
 
       bool result = false;
       if (time > DateTime::DateTimeEpoch)
          {
-         SERIAL_STREAM("Setting time on binClock: " << clockPtr->get_IdName() << "; " << (clockPtr == nullptr? "NULL" : "Valid") << endl) // *** DEBUG ***
-         clockPtr->set_Time(time);
+         LOG_WAN_DEBUG("Setting time on binClock: " << clockPtr->get_IdName() << "; " << (clockPtr == nullptr? "NULL" : "Valid") << endl) // *** DEBUG ***
+         bool slewed = clockPtr->AdjustTime(time, fractionMs);
          DateTime validateTime = clockPtr->get_Time();
-         SERIAL_STREAM("UpdateTime(): Time synchronized: " << time.timestamp(DateTime::TIMESTAMP_DATETIME12) << " Result time: " 
-                     << validateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << endl) // *** DEBUG ***
-         result = (time == validateTime); // Success IFF the time was set correctly.
+         LOG_WAN_DEBUG("UpdateTime(): Time synchronized: " << time.timestamp(DateTime::TIMESTAMP_DATETIME12) << " Result time: " 
+                     << validateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) << (slewed ? " (slewing)" : "") << endl) // *** DEBUG ***
+         result = slewed || (time == validateTime); // Success IFF the time was set correctly or is being slewed.
          }
       
       return result;
       }
 
+   DateTime BinaryClockWAN::getSystemTime(uint16_t& fractionMs)
+      {
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+
+      struct tm timeinfo = { 0 };
+      localtime_r(&tv.tv_sec, &timeinfo);
+
+      fractionMs = (uint16_t)(tv.tv_usec / 1000L);
+      return DateTime(timeinfo);
+      }
+
    DateTime BinaryClockWAN::SyncTimeNTP()
       {
       if (!initialized) { return DateTime::DateTimeEpoch; } // Ensure Begin() was called
@@ -396,9 +879,17 @@ namespace BinaryClockShield
       NTPResult syncResult = ntp.SyncTime();
       if (syncResult.success)
          {
-         SERIAL_STREAM("SyncTimeNTP(): Success; Time (internal) synchronized: " << syncResult.dateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) 
+         LOG_WAN_DEBUG("SyncTimeNTP(): Success; Time (internal) synchronized: " << syncResult.dateTime.timestamp(DateTime::TIMESTAMP_DATETIME12) 
                     << "; Calling UpdateTime()" << endl) // *** DEBUG ***
-         bool updateRes = UpdateTime(syncResult.dateTime);
+         // The system clock was just corrected, read it again for the milliseconds.
+         uint16_t fractionMs = 0;
+         DateTime now = getSystemTime(fractionMs);
+         bool updateRes = UpdateTime(now.isValid() ? now : syncResult.dateTime, fractionMs);
+         if (serveTime) 
+            { ntpServer.SetReference(syncResult); }
+         if (peerMode)
+            { peerSync.SetSynced(syncResult.packet.stratum + 1); }
+         scheduleLeap();
          }
 
       return syncResult.dateTime;
@@ -412,7 +903,7 @@ namespace BinaryClockShield
       if (!initialized || clockPtr == nullptr) 
          { 
          String prefix("[" + String(millis()) + "] BinaryClockWAN::SyncAlert(): ");
-         SERIAL_PRINTLN(prefix + (clockPtr == nullptr ? "- clockPtr is NULL!" : "- Not initialized"))
+         LOG_WAN_INFO((prefix + (clockPtr == nullptr ? "- clockPtr is NULL!" : "- Not initialized")) << endl)
          return; 
          }
 
@@ -421,12 +912,18 @@ namespace BinaryClockShield
       // Double-check clockPtr is still valid (multi-core safety)
       if (clockPtr == nullptr)
          {
-         SERIAL_PRINTLN(prefix + "- clockPtr became NULL during callback execution!")
+         LOG_WAN_INFO((prefix + "- clockPtr became NULL during callback execution!") << endl)
          return;
          }
 
-      clockPtr->set_Time(dateTime);
-      SERIAL_STREAM(prefix << " Time synchronized: " << dateTime.timestamp(clockPtr->get_Is12HourFormat()
+      // The SNTP service just set the system clock, `dateTime` is truncated to the second.
+      uint16_t fractionMs = 0;
+      DateTime now = getSystemTime(fractionMs);
+      if (now.isValid())
+         { clockPtr->AdjustTime(now, fractionMs); }
+      else
+         { clockPtr->set_Time(dateTime); }
+      LOG_WAN_DEBUG(prefix << " Time synchronized: " << dateTime.timestamp(clockPtr->get_Is12HourFormat()
             ? DateTime::TIMESTAMP_DATETIME12 : DateTime::TIMESTAMP_DATETIME) << endl)  // *** DEBUG ***
       }
 
@@ -436,12 +933,12 @@ namespace BinaryClockShield
 
       String curZone = settings.get_Timezone();
       ntp.set_Timezone(value.c_str());
-      SERIAL_STREAM("[" << millis() << "] BinaryClockWAN::set_Timezone(): Changing timezone from [" << curZone << "] to [" << value << "]" << endl) // *** DEBUG ***
+      LOG_WAN_DEBUG("[" << millis() << "] BinaryClockWAN::set_Timezone(): Changing timezone from [" << curZone << "] to [" << value << "]" << endl) // *** DEBUG ***
       if (curZone != value)
          {
          settings.set_Timezone(value);
-         bool saveRes = settings.Save();
-         SERIAL_STREAM("    Saved new timezone [" << value << "] to settings " << (saveRes ? "successfully." : "with errors.") << endl) // *** DEBUG ***
+         bool saveRes = settings.SaveDeferred();   // Saved with any other changes made with it.
+         LOG_WAN_DEBUG("    Saving new timezone [" << value << "] to settings " << (saveRes ? "scheduled." : "with errors.") << endl) // *** DEBUG ***
          }
       }
 
@@ -460,47 +957,67 @@ namespace BinaryClockShield
 
       switch (event)
          {
-         case ARDUINO_EVENT_WIFI_READY:               SERIAL_PRINTLN("WiFi interface ready") break;
-         case ARDUINO_EVENT_WIFI_SCAN_DONE:           SERIAL_PRINTLN("Completed scan for access points") break;
-         case ARDUINO_EVENT_WIFI_STA_START:           SERIAL_PRINTLN("WiFi client started") break;
-         case ARDUINO_EVENT_WIFI_STA_STOP:            SERIAL_PRINTLN("WiFi clients stopped") break;
-         case ARDUINO_EVENT_WIFI_STA_CONNECTED:       SERIAL_PRINTLN("Connected to access point") break;
+         case ARDUINO_EVENT_WIFI_READY:               LOG_WAN_INFO("WiFi interface ready" << endl) break;
+         case ARDUINO_EVENT_WIFI_SCAN_DONE:
+            LOG_WAN_INFO("Completed scan for access points" << endl)
+            if (scanning) { scanChannelDone(); }
+            break;
+         case ARDUINO_EVENT_WIFI_STA_START:           LOG_WAN_INFO("WiFi client started" << endl) break;
+         case ARDUINO_EVENT_WIFI_STA_STOP:            LOG_WAN_INFO("WiFi clients stopped" << endl) break;
+         case ARDUINO_EVENT_WIFI_STA_CONNECTED:       LOG_WAN_INFO("Connected to access point" << endl) break;
          case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:    
-            SERIAL_PRINT("Disconnected from WiFi access point\n    Reason:")
-            SERIAL_PRINTLN(WiFiDisconnectReasonString((wifi_err_reason_t)info.wifi_sta_disconnected.reason))
-            // TODO: Reconnect!
-            if (localCreds.IsValid())
+            LOG_WAN_INFO("Disconnected from WiFi access point\n    Reason:")
+            LOG_WAN_INFO((WiFiDisconnectReasonString((wifi_err_reason_t)info.wifi_sta_disconnected.reason)) << endl)
+            if (leaving && (info.wifi_sta_disconnected.reason == WIFI_REASON_ASSOC_LEAVE))
+               { leaving = false; }    // We ended a timed out attempt, not a failure of the next one.
+            else if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
                {
-               SERIAL_PRINTLN("Attempting to reconnect to last known WiFi credentials...")
-               bool apResult = Connect(localCreds);
-               SERIAL_STREAM("Reconnection attempt result: " << (apResult ? "SUCCESS" : "FAILURE") << endl) // *** DEBUG ***
+               if (wifiFsm.get_State() == WiFiState::Connected)
+                  { BCMetrics::get_Instance().Add(BCMetric::WiFiReconnects); }   // A lost connection, not a failed attempt.
+               runAction(wifiFsm.Disconnected());   // The next AP, a backoff or reconnect at once.
+               xSemaphoreGive(wifiMutex);
                }
             break;
-         case ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE: SERIAL_PRINTLN("Authentication mode of access point has changed") break;
+         case ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE: LOG_WAN_INFO("Authentication mode of access point has changed" << endl) break;
          case ARDUINO_EVENT_WIFI_STA_GOT_IP:
-            SERIAL_PRINT("Obtained IP address: ")
-            SERIAL_PRINTLN(WiFi.localIP())
+            LOG_WAN_INFO("Obtained IP address: ")
+            LOG_WAN_INFO((WiFi.localIP()) << endl)
+            if (xSemaphoreTake(wifiMutex, portMAX_DELAY) == pdTRUE)
+               {
+               WiFiState state = wifiFsm.get_State();
+               if ((state == WiFiState::Connecting) || (state == WiFiState::Connected))
+                  {
+                  uint8_t id = wifiFsm.get_CurrentID();
+                  leaving = false;
+                  localIP = WiFi.localIP();
+                  localCreds = settings.GetWiFiAP(id);
+                  saveFastConnect(id, attemptCachedIP);
+                  runAction(wifiFsm.Connected(id));
+                  wifiFsm.set_Retry(true);   // Connected: reconnect with backoff from now on.
+                  }
+               xSemaphoreGive(wifiMutex);
+               }
             break;
-         case ARDUINO_EVENT_WIFI_STA_LOST_IP:        SERIAL_PRINTLN("Lost IP address and IP address is reset to 0") break;
-         case ARDUINO_EVENT_WPS_ER_SUCCESS:          SERIAL_PRINTLN("WiFi Protected Setup (WPS): succeeded in enrollee mode") break;
-         case ARDUINO_EVENT_WPS_ER_FAILED:           SERIAL_PRINTLN("WiFi Protected Setup (WPS): failed in enrollee mode") break;
-         case ARDUINO_EVENT_WPS_ER_TIMEOUT:          SERIAL_PRINTLN("WiFi Protected Setup (WPS): timeout in enrollee mode") break;
-         case ARDUINO_EVENT_WPS_ER_PIN:              SERIAL_PRINTLN("WiFi Protected Setup (WPS): pin code in enrollee mode") break;
-         case ARDUINO_EVENT_WIFI_AP_START:           SERIAL_PRINTLN("WiFi access point started") break;
-         case ARDUINO_EVENT_WIFI_AP_STOP:            SERIAL_PRINTLN("WiFi access point  stopped") break;
-         case ARDUINO_EVENT_WIFI_AP_STACONNECTED:    SERIAL_PRINTLN("Client connected") break;
-         case ARDUINO_EVENT_WIFI_AP_STADISCONNECTED: SERIAL_PRINTLN("Client disconnected") break;
-         case ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED:   SERIAL_PRINTLN("Assigned IP address to client") break;
-         case ARDUINO_EVENT_WIFI_AP_PROBEREQRECVED:  SERIAL_PRINTLN("Received probe request") break;
-         case ARDUINO_EVENT_WIFI_AP_GOT_IP6:         SERIAL_PRINTLN("AP IPv6 is preferred") break;
-         case ARDUINO_EVENT_WIFI_STA_GOT_IP6:        SERIAL_PRINTLN("STA IPv6 is preferred") break;
-         case ARDUINO_EVENT_ETH_GOT_IP6:             SERIAL_PRINTLN("Ethernet IPv6 is preferred") break;
-         case ARDUINO_EVENT_ETH_START:               SERIAL_PRINTLN("Ethernet started") break;
-         case ARDUINO_EVENT_ETH_STOP:                SERIAL_PRINTLN("Ethernet stopped") break;
-         case ARDUINO_EVENT_ETH_CONNECTED:           SERIAL_PRINTLN("Ethernet connected") break;
-         case ARDUINO_EVENT_ETH_DISCONNECTED:        SERIAL_PRINTLN("Ethernet disconnected") break;
-         case ARDUINO_EVENT_ETH_GOT_IP:              SERIAL_PRINTLN("Ethernet obtained IP address") break;
-         default:                                    SERIAL_PRINTLN("default case") break;
+         case ARDUINO_EVENT_WIFI_STA_LOST_IP:        LOG_WAN_INFO("Lost IP address and IP address is reset to 0" << endl) break;
+         case ARDUINO_EVENT_WPS_ER_SUCCESS:          LOG_WAN_INFO("WiFi Protected Setup (WPS): succeeded in enrollee mode" << endl) break;
+         case ARDUINO_EVENT_WPS_ER_FAILED:           LOG_WAN_ERROR("WiFi Protected Setup (WPS): failed in enrollee mode" << endl) break;
+         case ARDUINO_EVENT_WPS_ER_TIMEOUT:          LOG_WAN_INFO("WiFi Protected Setup (WPS): timeout in enrollee mode" << endl) break;
+         case ARDUINO_EVENT_WPS_ER_PIN:              LOG_WAN_INFO("WiFi Protected Setup (WPS): pin code in enrollee mode" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_START:           LOG_WAN_INFO("WiFi access point started" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_STOP:            LOG_WAN_INFO("WiFi access point  stopped" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_STACONNECTED:    LOG_WAN_INFO("Client connected" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_STADISCONNECTED: LOG_WAN_INFO("Client disconnected" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_STAIPASSIGNED:   LOG_WAN_INFO("Assigned IP address to client" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_PROBEREQRECVED:  LOG_WAN_INFO("Received probe request" << endl) break;
+         case ARDUINO_EVENT_WIFI_AP_GOT_IP6:         LOG_WAN_INFO("AP IPv6 is preferred" << endl) break;
+         case ARDUINO_EVENT_WIFI_STA_GOT_IP6:        LOG_WAN_INFO("STA IPv6 is preferred" << endl) break;
+         case ARDUINO_EVENT_ETH_GOT_IP6:             LOG_WAN_INFO("Ethernet IPv6 is preferred" << endl) break;
+         case ARDUINO_EVENT_ETH_START:               LOG_WAN_INFO("Ethernet started" << endl) break;
+         case ARDUINO_EVENT_ETH_STOP:                LOG_WAN_INFO("Ethernet stopped" << endl) break;
+         case ARDUINO_EVENT_ETH_CONNECTED:           LOG_WAN_INFO("Ethernet connected" << endl) break;
+         case ARDUINO_EVENT_ETH_DISCONNECTED:        LOG_WAN_INFO("Ethernet disconnected" << endl) break;
+         case ARDUINO_EVENT_ETH_GOT_IP:              LOG_WAN_INFO("Ethernet obtained IP address" << endl) break;
+         default:                                    LOG_WAN_INFO("default case" << endl) break;
          }
       }
 
@@ -19,12 +19,69 @@
 #include "BinaryClockSettings.h"    /// Binary Clock Settings class: handles all settings kept on NVS.
 #include "BinaryClockNTP.h"         /// Binary Clock NTP class: handles all NTP related functionality.
 #include "BinaryClockWPS.h"         /// Binary Clock WPS class: handles WPS connection functionality.
+#include "WiFiStateMachine.h"       /// The event driven WiFi connection logic.
+#include "RadioDutyCycle.h"         /// The radio schedule around the NTP syncs.
+#include "BinaryClockNtpServer.h"   /// The NTP server for the other clocks on the LAN.
+#include "BinaryClockPeerSync.h"    /// The peer to peer time sync of the clocks on the LAN.
+#include "BinaryClockMetrics.h"     /// The HTTP endpoint of the clock's metrics (Prometheus text format).
 
 #include <WiFi.h>                   /// For WiFi connectivity class: `WiFiClass`
 #include <esp_wifi_types.h>         /// For `wifi_auth_mode_t` enum and related types.
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"        /// For the `wifiMutex`
+#include "freertos/timers.h"        /// For the `wifiTimer`, the attempt timeout and backoff.
+
+#ifndef WIFI_FAST_CONNECT_MS
+   #define WIFI_FAST_CONNECT_MS   5000   ///< The timeout (ms) of the attempt to the cached AP, with its BSSID and channel.
+#endif
+#ifndef WIFI_SCAN_DWELL_MS
+   #define WIFI_SCAN_DWELL_MS      120   ///< The active scan time (ms) of a channel.
+#endif
+#ifndef WIFI_SCAN_DWELL_LONG_MS
+   #define WIFI_SCAN_DWELL_LONG_MS 300   ///< The active scan time (ms) of the likely channels: the last AP's; 1; 6; 11.
+#endif
+#ifndef WIFI_SCAN_GOOD_RSSI
+   #define WIFI_SCAN_GOOD_RSSI     -67   ///< A known AP this strong (dBm) ends the scan, the other channels aren't scanned.
+#endif
+#ifndef WIFI_LAST_AP_BONUS
+   #define WIFI_LAST_AP_BONUS       10   ///< The rank bonus (dB) of the last AP connected to.
+#endif
+#ifndef WIFI_DUTY_CYCLE
+   #define WIFI_DUTY_CYCLE       false   ///< true: the radio is off between the NTP syncs (see `RadioDutyCycle`).
+#endif
+#ifndef NTP_SERVER_MODE
+   #define NTP_SERVER_MODE       false   ///< true: serve NTP to the other clocks on the LAN (see `BinaryClockNtpServer`).
+#endif
+#ifndef WIFI_PEER_SYNC
+   #define WIFI_PEER_SYNC        false   ///< true: follow the leader of the clocks on the LAN (see `BinaryClockPeerSync`).
+#endif
+#ifndef WIFI_METRICS
+   #define WIFI_METRICS          false   ///< true: serve the metrics on `METRICS_PORT` (see `BinaryClockMetrics`).
+#endif
+#ifndef LEAP_TIMER_MAX_MS
+   #define LEAP_TIMER_MAX_MS   3600000UL   ///< The longest wait (ms) of the leap timer, it is started again closer to the event.
+#endif
+#ifndef WIFI_FAST_IP_USES
+   #define WIFI_FAST_IP_USES         8   ///< The cached IP is reused this many times, then DHCP renews the lease. 0 = always DHCP.
+#endif
 
 namespace BinaryClockShield
    {
+   /// @brief The WiFi connection events signaled by the state machine, `Begin()` and `Connect()` wait on them.
+   enum class WiFiEvents : uint8_t
+      {
+      Reserved = 0,                    ///< Reserved bit, sets the starting values for the enum.
+      Connected,                       ///< Connected to an AP with an IP address.
+      Failed,                          ///< Every candidate AP failed.
+      ScanDone,                        ///< The scan for the known APs is done.
+      Wake,                            ///< The duty cycle timer: power the radio up for the next sync.
+      RadioOn,                         ///< The radio is on (set) or off (clear), wait on it to use the network.
+      Leap,                            ///< The leap timer: the leap second event is due.
+      Timeout,                         ///< The WiFi timer: an attempt timed out or a backoff ended.
+      Flush,                           ///< The settings timer: the deferred save is due.
+      EventEnd                         ///< Last `EventBits` enum end marker value; subtract `Reserved` to get the size.
+      };
+
    /// @brief The BinaryClockWAN class provides WiFi connectivity and time synchronization 
    ///        features for the Binary Clock project.
    /// @details This class manages WiFi connections, including connecting to known access points, 
@@ -98,14 +155,17 @@ namespace BinaryClockShield
       ///          This can be used to cross reference with the list of saved AP credentials to
       ///          automate the reconnection.
       /// @design  This method is static so that is can be used without an instance of the class.
-      ///          The constructor calls this method to get a list of the APs in the area.
+      /// @note    This scan blocks and keeps every AP; `Begin()` uses the asynchronous `scanKnownAPs()`.
       /// @return A vector of `WiFiInfo` structures containing the details of each available AP.
       /// @author Chris-70 (2025/09)
       static std::vector<WiFiInfo> GetAvailableNetworks();
 
       /// @brief Begin the WiFi connection process, prepare the enviroment and optionally connect.
       /// @details This method initiates the WiFi connection process. If `autoConnect` is true,
-      ///          it will attempt to connect to a known access point automatically.
+      ///          it will attempt to connect to a known access point automatically.  
+      ///          The last AP connected to is tried first without a scan, with its cached BSSID,
+      ///          channel and IP configuration (see `APFastConnect`). The scan of all the APs is
+      ///          only done when that fails.
       /// @param clock Reference to an `IBinaryClock` Interface class instance to ???????????
       /// @param autoConnect Flag [optional] - the method will attempt to connect to a known AP automatically.  
       ///                    The default is `true` if not specified.
@@ -142,9 +202,12 @@ namespace BinaryClockShield
       /// @author Chris-70 (2025/09)
       bool UpdateTime();
       /// @copydoc UpdateTime()
+      /// @details The clock is corrected with `IBinaryClock::AdjustTime()`, small offsets are
+      ///          slewed so the display doesn't skip or repeat seconds, large ones are stepped.
       /// @param time Reference to a DateTime object with the time to set instead of the time from NTP.
+      /// @param fractionMs The milliseconds elapsed in the second `time`. {0}
       /// @see UpdateTime()
-      bool UpdateTime(DateTime& time);
+      bool UpdateTime(DateTime& time, uint16_t fractionMs = 0);
 
       /// @brief Synchronize the time with the NTP server.
       /// @details This method contacts the configured NTP server and retrieves the current time.
@@ -170,6 +233,11 @@ namespace BinaryClockShield
       /// @param info Additional information about the event.
       void WiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info);
 
+      /// @brief Get the local time from the system clock (e.g. just set by NTP) with the milliseconds.
+      /// @param fractionMs Returns the milliseconds elapsed in the second returned.
+      /// @return The local time, whole seconds.
+      static DateTime getSystemTime(uint16_t& fractionMs);
+
    //#################################################################################//  
    // Private METHODS                                                                 //   
    //#################################################################################//   
@@ -181,6 +249,114 @@ namespace BinaryClockShield
       ///          within the `Begin()` method without checking the `initialized` flag.
       bool connectLocalWiFi(bool bypassCheck = false);
 
+      /// @brief Connect to the best of the candidate APs: start the state machine and wait for the result.
+      /// @details The attempts are made from the WiFi events and the `wifiTimer`, this task waits on
+      ///          the `WiFiEvents` bits and wakes up as soon as an AP is connected or all failed.
+      /// @param candidates The candidate APs.
+      /// @return True if connected (got an IP address), false otherwise.
+      /// @author Chris-70 (2026/10)
+      bool connectWait(const std::vector<WiFiCandidate>& candidates);
+
+      /// @brief Do the action returned by the state machine. Call with `wifiMutex` taken.
+      /// @param action The action: connect; start the timer; signal the result.
+      void runAction(const WiFiAction& action);
+
+      /// @brief Start a connection attempt to the AP credentials `id`, without waiting.
+      /// @details The first attempt to an AP uses the BSSID and channel from the scan or the
+      ///          fast reconnect cache, and the cached IP configuration; a retry lets the driver scan.
+      /// @param id The ID of the AP credentials.
+      /// @return True if the fast reconnect cache is used, the attempt timeout is `WIFI_FAST_CONNECT_MS`.
+      /// @author Chris-70 (2026/10)
+      bool startAttempt(uint8_t id);
+
+      /// @brief Scan for the APs with stored credentials, one channel at a time, without blocking the radio.
+      /// @details The channels are scanned asynchronously (`ARDUINO_EVENT_WIFI_SCAN_DONE` starts
+      ///          the next one): the last AP's channel, 1, 6 and 11 first with a longer dwell, then
+      ///          the others. The scan ends early when a known AP of `WIFI_SCAN_GOOD_RSSI` is found.
+      ///          Only the known APs, matched through the settings' SSID index, are kept in `localAPs`.
+      /// @return True if a known AP was found.
+      /// @author Chris-70 (2026/10)
+      bool scanKnownAPs();
+
+      /// @brief Start the asynchronous scan of the next channel in `scanChannels`.
+      /// @return True if a scan was started, false if there are no more channels.
+      bool scanNextChannel();
+
+      /// @brief Collect the known APs of a channel scan, then scan the next channel or end the scan.
+      /// @remarks Called from `WiFiEvent()` for `ARDUINO_EVENT_WIFI_SCAN_DONE`.
+      /// @author Chris-70 (2026/10)
+      void scanChannelDone();
+
+      /// @brief Start the duty cycle: the first sync in `delayMs`, then the radio is off between the syncs.
+      /// @param delayMs The time (ms) to the first sync.
+      void startDutyCycle(uint32_t delayMs);
+
+      /// @brief Power the radio up, reconnect (cached AP first), sync and power it down until the next sync.
+      /// @details Runs on the duty cycle task when the `Wake` bit is set by `dutyTimer`. The reconnect
+      ///          waits on the `Connected` / `Failed` bits, the sync signals `NtpEvents::Synced`.
+      /// @author Chris-70 (2026/10)
+      void dutyWake();
+
+      /// @brief Power the radio up in station mode and set the `RadioOn` bit.
+      void radioOn();
+
+      /// @brief Stop the state machine, power the radio down and clear the `RadioOn` bit.
+      void radioOff();
+
+      /// @brief The duty cycle task: wait on the `Wake` bit and run `dutyWake()`.
+      /// @param param Not used.
+      static void dutyTaskRun(void* param);
+
+      /// @brief The `dutyTimer` callback: set the `Wake` bit.
+      /// @param timer The timer handle.
+      static void dutyTimerCallback(TimerHandle_t timer);
+
+      /// @brief Plan the leap second announced by the last sync on the clock and start `leapTimer`,
+      ///        or cancel the one planned if it was withdrawn.
+      /// @author Chris-70 (2026/10)
+      void scheduleLeap();
+
+      /// @brief The leap second event: step the system clock and stop the NTP server announcing it.
+      /// @details Runs on the duty cycle task when the `Leap` bit is set by `leapTimer`. The timer
+      ///          is started again if the system clock (synced meanwhile) isn't there yet. A clock
+      ///          that didn't plan the leap is aligned to the system clock with `AdjustTime()`.
+      /// @author Chris-70 (2026/10)
+      void leapStep();
+
+      /// @brief The `leapTimer` callback: set the `Leap` bit.
+      /// @param timer The timer handle.
+      static void leapTimerCallback(TimerHandle_t timer);
+
+      /// @brief Connect with the credentials received by WPS.
+      /// @details The credentials are added to the settings, the AP's BSSID and channel from the
+      ///          enrollment are put in the fast reconnect cache so the state machine connects
+      ///          without a scan; the connection and its DHCP lease are cached on `GOT_IP`.
+      /// @param wpsResult The successful WPS result.
+      /// @return True if connected (got an IP address).
+      /// @author Chris-70 (2026/10)
+      bool connectProvisioned(const WPSResult& wpsResult);
+
+      /// @brief The `wifiTimer` callback: set the `Timeout` bit.
+      /// @param timer The timer handle.
+      static void wifiTimerCallback(TimerHandle_t timer);
+
+      /// @brief An attempt timed out or a backoff ended: run the state machine.
+      /// @details Runs on the WAN task when the `Timeout` bit is set by `wifiTimer`. A timer started
+      ///          again meanwhile (e.g. the next attempt from a WiFi event) makes the bit stale.
+      /// @author Chris-70 (2026/10)
+      void wifiTimeout();
+
+      /// @brief The WAN task: wait on the `Timeout` and `Flush` bits, run `wifiTimeout()` and the
+      ///        deferred save of the settings. Both block (mutex, WiFi driver, NVS), the timer task can't.
+      /// @param param Not used.
+      static void wanTaskRun(void* param);
+
+      /// @brief Save the BSSID, channel and IP configuration of the current connection for `startAttempt()`.
+      /// @param id The ID of the AP credentials connected with.
+      /// @param cachedIP True if the cached IP configuration was used, false if it came from DHCP.
+      /// @author Chris-70 (2026/10)
+      void saveFastConnect(uint8_t id, bool cachedIP);
+
    //#################################################################################//  
    // Public PROPERTIES                                                               //   
    //#################################################################################//   
@@ -219,6 +395,77 @@ namespace BinaryClockShield
       IPAddress get_LocalIP() const
          { return localIP; }
 
+      /// @brief `ConnectMs` Property (RO): The time since boot (ms) when `Begin()` connected, 0 if not connected.
+      /// @details Logged with the method used (cached AP or scan) to measure the boot to connected time.
+      /// @author Chris-70 (2026/10)
+      uint32_t get_ConnectMs() const
+         { return connectMs; }
+
+      /// @brief `DutyCycle` Property (RW): Flag: the radio is off between the NTP syncs.
+      /// @details The radio is powered up the reconnect time before each sync (see `RadioDutyCycle`),
+      ///          reconnects with the cached AP, syncs with `BinaryClockNTP::SyncTime()` and is powered
+      ///          down; the SNTP service isn't used. The `RadioOn` bit of the `WiFiEvents` tells when
+      ///          the network can be used. Set before `Begin()`. The default is `WIFI_DUTY_CYCLE`.
+      /// @author Chris-70 (2026/10)
+      void set_DutyCycle(bool value)
+         { dutyMode = value; }
+      /// @copydoc set_DutyCycle()
+      bool get_DutyCycle() const
+         { return dutyMode; }
+
+      /// @brief `ServeTime` Property (RW): Flag: this clock serves NTP to the other clocks on the LAN.
+      /// @details The `BinaryClockNtpServer` answers on UDP port 123 with the time of the last sync,
+      ///          the other clocks point `set_NtpServers()` at this clock's address. The syncs are
+      ///          made by the duty cycle task with the radio kept on and without power save, the
+      ///          SNTP service isn't used. Set before `Begin()`. The default is `NTP_SERVER_MODE`.
+      /// @see BinaryClockNtpServer::set_LocalStratum()
+      /// @author Chris-70 (2026/10)
+      void set_ServeTime(bool value)
+         { serveTime = value; }
+      /// @copydoc set_ServeTime()
+      bool get_ServeTime() const
+         { return serveTime; }
+
+      /// @brief `PeerSync` Property (RW): Flag: the clocks on the LAN follow one leader (UDP broadcast).
+      /// @details The clock with the lowest stratum (NTP synced first), then the lowest MAC, leads;
+      ///          the others align their system clock and display second to it, no internet access
+      ///          is needed. The radio is kept on. Set before `Begin()`. The default is `WIFI_PEER_SYNC`.
+      /// @author Chris-70 (2026/10)
+      void set_PeerSync(bool value)
+         { peerMode = value; }
+      /// @copydoc set_PeerSync()
+      bool get_PeerSync() const
+         { return peerMode; }
+
+      /// @brief `ServeMetrics` Property (RW): Flag: serve the clock's metrics over HTTP for a scraper.
+      /// @details `BinaryClockMetrics` answers `GET /metrics` on TCP port `METRICS_PORT` (9100) in the
+      ///          Prometheus text format: the tick latency, the missed ticks, the NTP offset, the
+      ///          heap, etc. The radio is kept on. Set before `Begin()`. The default is `WIFI_METRICS`.
+      /// @author Chris-70 (2026/10)
+      void set_ServeMetrics(bool value)
+         { serveMetrics = value; }
+      /// @copydoc set_ServeMetrics()
+      bool get_ServeMetrics() const
+         { return serveMetrics; }
+
+      /// @brief `LeapSmear` Property (RW): The window (s) ending at a leap second to smear it over
+      ///        on the display, 0 to show 23:59:60.
+      /// @details A leap second announced by the NTP servers (the leap indicator of the syncs made
+      ///          by `SyncTime()`: duty cycle, NTP server or peer sync mode) is planned on the clock
+      ///          with `IBinaryClock::ScheduleLeapSecond()`; at the event the system clock is stepped
+      ///          and the NTP server stops announcing it. The default is `LEAP_SMEAR_S`.
+      /// @author Chris-70 (2026/10)
+      void set_LeapSmear(uint32_t value)
+         { leapSmearS = value; }
+      /// @copydoc set_LeapSmear()
+      uint32_t get_LeapSmear() const
+         { return leapSmearS; }
+
+      /// @brief `RadioDutyCycle` Property (RO): The duty cycle, e.g. the radio on time per day and the average current.
+      /// @author Chris-70 (2026/10)
+      const RadioDutyCycle& get_RadioDutyCycle() const
+         { return dutyCycle; }
+
       /// @brief `IsConnected` Property (RO): Indicates whether the device is currently connected to WiFi.
       /// @details This property checks the connection status of the WiFi interface.
       /// @return True if the device is connected to WiFi, false otherwise.
@@ -305,14 +552,45 @@ namespace BinaryClockShield
       EventGroupHandle_t wanEventGroup = nullptr;  ///< Event group handle for WAN task notifications.
       TaskGroupBits<NtpEvents> ntpEventBits;       ///< Event bits for NTP synchronization events.
       TaskGroupBits<WpsEvents> wpsEventBits;       ///< Event bits for WPS connection events.
+      TaskGroupBits<WiFiEvents> wifiEventBits;     ///< Event bits for the WiFi connection result.
       std::vector<std::reference_wrapper<TaskGroupBase>> taskEventList;    ///< List of task event bit groups for managing multiple event groups together.
 
       DateTime lastSync;               ///< The time of the last sync with the NTP server.
       TimeSpan zuluOffset;             ///< Current time offset to UTC/Zulu time.
       bool initialized = false;        ///< Flag: True if the `Begin()` method has been called.
       bool ntpSynced = false;          ///< Flag: True if the time has been synchronized with NTP.
-
-      std::vector<WiFiInfo> localAPs;  ///< List of local WiFi access points.
+      uint32_t connectMs = 0;          ///< The time since boot (ms) when `Begin()` connected.
+
+      WiFiStateMachine wifiFsm;              ///< The WiFi connection state machine.
+      SemaphoreHandle_t wifiMutex = nullptr; ///< Serializes the WiFi events, the timer and the callers on `wifiFsm`.
+      TimerHandle_t wifiTimer = nullptr;     ///< One shot timer: the attempt timeout or the backoff.
+      volatile bool leaving = false;         ///< Flag: we ended a timed out attempt, ignore its disconnect event.
+      bool attemptCachedIP = false;          ///< Flag: the current attempt uses the cached IP configuration.
+
+      std::vector<WiFiInfo> localAPs;  ///< List of local WiFi access points with stored credentials.
+      uint8_t scanChannels[14] = { 0 };   ///< The channels to scan, in order.
+      uint8_t scanCount = 0;              ///< The number of channels in `scanChannels`.
+      uint8_t scanNext = 0;               ///< The index of the next channel to scan.
+      uint8_t scanLikely = 0;             ///< The number of likely channels, at the start of `scanChannels`.
+      int32_t scanBestRssi = INT16_MIN;   ///< The RSSI of the strongest known AP found.
+      volatile bool scanning = false;     ///< Flag: a scan for the known APs is in progress.
+
+      RadioDutyCycle dutyCycle;              ///< The radio schedule around the NTP syncs.
+      bool dutyMode = WIFI_DUTY_CYCLE;       ///< Flag: the radio is off between the NTP syncs.
+      TimerHandle_t dutyTimer = nullptr;     ///< One shot timer: the next wake of the radio.
+      TaskHandle_t dutyTask = nullptr;       ///< The duty cycle task, runs `dutyWake()`.
+      TaskHandle_t wanTask = nullptr;        ///< The WAN task, runs `wifiTimeout()` and the deferred settings save.
+      BinaryClockNtpServer& ntpServer = BinaryClockNtpServer::get_Instance();   ///< The NTP server for the LAN.
+      bool serveTime = NTP_SERVER_MODE;      ///< Flag: serve NTP to the other clocks on the LAN.
+      BinaryClockPeerSync& peerSync = BinaryClockPeerSync::get_Instance();  ///< The peer to peer time sync.
+      bool peerMode = WIFI_PEER_SYNC;        ///< Flag: follow the leader of the clocks on the LAN.
+      BinaryClockMetrics& metricsServer = BinaryClockMetrics::get_Instance();   ///< The HTTP endpoint of the metrics.
+      bool serveMetrics = WIFI_METRICS;      ///< Flag: serve the metrics over HTTP.
+      TimerHandle_t leapTimer = nullptr;     ///< One shot timer: the leap second event, at most `LEAP_TIMER_MAX_MS` away.
+      int64_t leapEventS = 0;                ///< The UTC time (s) of the leap second planned, 0 if none.
+      int8_t leapPlanned = 0;                ///< The leap second planned: +1 insert; -1 delete; 0 none.
+      bool leapOnClock = false;              ///< Flag: the clock makes the leap second planned on the RTC.
+      uint32_t leapSmearS = LEAP_SMEAR_S;    ///< The window (s) to smear the leap second over, 0 shows :60.
       }; // class BinaryClockWAN
    } // namespace BinaryClockShield
 
@@ -29,11 +29,10 @@ namespace BinaryClockShield
    {
    BinaryClockWPS::BinaryClockWPS()
          : timeout(DEFAULT_WPS_TIMEOUT_MS)
-         , wpsActive(false)
-         , wpsSuccess(false)
-         , wpsTimeout(false)
+         , state(WpsState::Idle)
       {
       memset(&wpsConfig, 0, sizeof(wpsConfig));
+      wpsTimer = xTimerCreate("WpsTimer", pdMS_TO_TICKS(DEFAULT_WPS_TIMEOUT_MS), pdFALSE, nullptr, wpsTimerCallback);
       }
 
    BinaryClockWPS::~BinaryClockWPS()
@@ -47,227 +46,101 @@ namespace BinaryClockShield
       return instance;
       }
 
-   WPSResult BinaryClockWPS::ConnectWPS()
+   bool BinaryClockWPS::Start()
       {
-      WPSResult result;
-      uint32_t startTime = millis();
+      if (state == WpsState::Enrolling) { return true; }
+
+      LOG_WAN_INFO(endl << "Starting WPS Push Button connection (timeout: " << timeout << "ms)" << endl)
+      if (eventBits.get_EventGroup() == nullptr)
+         { eventBits.set_EventGroup(xEventGroupCreate()); }
+      eventBits.WaitForBits({ WpsEvents::Success, WpsEvents::Timeout, WpsEvents::Error }, 0);   // Clear any old result.
 
-      SERIAL_STREAM(endl << "Starting WPS Push Button connection (timeout: " << timeout << "ms)" << endl)
+      credentials = APCreds();
+      channel = 0;
+      apSsid = "";
+      wpsError = "";
 
-      // Ensure WiFi is in station mode
-      WiFi.enableSTA(true);
-      vTaskDelay(pdMS_TO_TICKS(100));
-      WiFi.disconnect(true);
-      vTaskDelay(pdMS_TO_TICKS(100));
+      // Ensure WiFi is in station mode, without an attempt in progress.
       WiFi.mode(WIFI_STA);
+      WiFi.disconnect(false);
 
       // Initialize WPS
       if (!initWPS())
          {
-         result.errorMessage = "Failed to initialize WPS";
-         return result;
+         wpsError = "Failed to initialize WPS";
+         state = WpsState::Failed;
+         return false;
          }
 
-      // Reset event flags
-      wpsSuccess = false;
-      wpsTimeout = false;
-      wpsError   = "";
-      wpsActive  = true;
-
       // Register event handler
       esp_err_t err = esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler, this);
       if (err != ESP_OK)
          {
-         result.errorMessage = "Failed to register WiFi event handler: " + EspErrorToString(err);
+         wpsError = "Failed to register WiFi event handler: " + EspErrorToString(err);
          cleanupWPS(true);
-         return result;
+         state = WpsState::Failed;
+         return false;
          }
 
-      // Start WPS
+      // Start WPS, the events drive it from here.
+      state = WpsState::Enrolling;
       err = esp_wifi_wps_start(0);
       if (err != ESP_OK)
          {
-         result.errorMessage = "Failed to start WPS: " + EspErrorToString(err);
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
+         wpsError = "Failed to start WPS: " + EspErrorToString(err);
          cleanupWPS(true);
-         return result;
+         state = WpsState::Failed;
+         return false;
          }
 
-      SERIAL_STREAM("WPS started - Please press the WPS button on your router now..." << endl)
-
-      // ===== PHASE 1: Wait for WPS to complete =====
-      uint32_t lastStatus = millis();
-      while (wpsActive && (millis() - startTime) < timeout)
-         {
-         // Print status every 10 seconds
-         if (millis() - lastStatus > 10000)
-            {
-            SERIAL_STREAM("WPS still waiting... (" << (millis() - startTime) / 1000 << " sec. elapsed)" << endl)
-            lastStatus = millis();
-            }
-
-         // Check for WPS completion
-         if (wpsSuccess)
-            {
-            break;  // Exit WPS wait loop
-            }
-
-         if (wpsTimeout || !wpsError.isEmpty())
-            {
-            result.errorMessage = wpsTimeout ? "WPS timeout" : wpsError;
-            SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-            // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-            cleanupWPS(true);
-            wpsActive = false;
-            return result;
-            }
-
-         vTaskDelay(pdMS_TO_TICKS(100));
-         }
+      xTimerChangePeriod(wpsTimer, pdMS_TO_TICKS(timeout), 0);   // Starts the timer.
+      LOG_WAN_INFO("WPS started - Please press the WPS button on your router now..." << endl)
+      return true;
+      }
 
-      // Handle WPS timeout
-      if (wpsActive && (millis() - startTime) >= timeout)
-         {
-         result.errorMessage = "WPS timeout (" + String(timeout / 1000) + " seconds)";
-         SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-         cleanupWPS(true);
-         wpsActive = false;
-         return result;
-         }
+   WPSResult BinaryClockWPS::ConnectWPS()
+      {
+      WPSResult result;
+      uint32_t startTime = millis();
 
-      SERIAL_PRINTLN("WPS: WPS enrollment completed, credentials received");
-      
-      // ===== PHASE 2: Connect to WiFi with obtained credentials =====
-      SERIAL_PRINTLN("WPS: Disconnecting from any previous connections...");
-      WiFi.disconnect(true);  // Turn off radio
-      vTaskDelay(pdMS_TO_TICKS(500));
-      
-      SERIAL_PRINTLN("WPS: Re-enabling WiFi station mode...");
-      WiFi.mode(WIFI_OFF);
-      vTaskDelay(pdMS_TO_TICKS(100));
-      WiFi.mode(WIFI_STA);
-      vTaskDelay(pdMS_TO_TICKS(100));
-      
-      SERIAL_PRINTLN("WPS: Attempting WiFi connection with received credentials...");
-      esp_err_t connectErr = esp_wifi_connect();
-      if (connectErr != ESP_OK)
+      if (!Start())
          {
-         result.errorMessage = "esp_wifi_connect() failed: " + EspErrorToString(connectErr);
-         SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-         cleanupWPS(true);
-         // WiFi.disconnect(true);
+         result.errorMessage = wpsError;
+         LOG_WAN_ERROR("WPS connection failed: " << result.errorMessage << endl)
          return result;
          }
 
-      vTaskDelay(pdMS_TO_TICKS(1000));  // Give it a second to process
-
-      SERIAL_STREAM("WiFi config after reconnection attempt:" << endl)
-      wifi_config_t conf;
-      esp_wifi_get_config(WIFI_IF_STA, &conf);
-      SERIAL_STREAM("  SSID: " << (char*)conf.sta.ssid << endl)
-      SERIAL_STREAM("  BSSID: " << WiFi.BSSIDstr() << endl)
-      SERIAL_STREAM("  Status: " << WiFiStatusString(WiFi.status()) << endl)
-
-      // Wait for connection with timeout
-      uint32_t connectionStart = millis();
-      const uint32_t connectionTimeout = 15000;  // 15 seconds
-      
-      while ((millis() - connectionStart) < connectionTimeout)
-         {
-         wl_status_t status = WiFi.status();
-         
-         SERIAL_PRINT(".");
-         
-         if (status == WL_CONNECTED)
-            {
-            SERIAL_PRINTLN("\n✅ WiFi Connected!");
-            break;
-            }
-         
-         if (status == WL_CONNECT_FAILED)
-            {
-            result.errorMessage = "WiFi connection failed";
-            SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-            // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-            cleanupWPS(true);
-            // WiFi.disconnect(true);
-            return result;
-            }
-         
-         vTaskDelay(pdMS_TO_TICKS(500));
-         }
-
-      // Check if we actually connected
-      if (WiFi.status() != WL_CONNECTED)
-         {
-         result.errorMessage = "WiFi connection timeout";
-         SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-         cleanupWPS(true);
-         // WiFi.disconnect(true);
-         return result;
-         }
+      // Sleep until the AP answers, WPS fails or the timer expires; the margin covers a lost timer.
+      EventBits_t bits = eventBits.WaitForBits({ WpsEvents::Success, WpsEvents::Timeout, WpsEvents::Error }, timeout + SECONDS_MS);
+      bool success = eventBits.IsBitSet(bits, WpsEvents::Success);
+      cleanupWPS(!success);
+      result.connectionTimeMs = millis() - startTime;
 
-      SERIAL_PRINTLN("");  // Newline after dots
-      
-      // ===== PHASE 3: Verify DHCP configuration =====
-      uint32_t dhcpStart = millis();
-      const uint32_t dhcpTimeout = 10000;  // 10 seconds
-      IPAddress ip;
-      
-      while ((millis() - dhcpStart) < dhcpTimeout)
-         {
-         ip = WiFi.localIP();
-         if (ip[0] != 0)  // Got valid IP
-            {
-            SERIAL_PRINT("✅ IP Address: ");
-            SERIAL_PRINTLN(ip);
-            break;
-            }
-         vTaskDelay(pdMS_TO_TICKS(100));
-         }
-      
-      // Final verification
-      if (WiFi.status() != WL_CONNECTED || ip[0] == 0)
+      if (!success)
          {
-         result.errorMessage = "WiFi connected but DHCP failed or connection lost";
-         SERIAL_STREAM("WPS connection failed: " << result.errorMessage << endl)
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-         cleanupWPS(true);
-         // WiFi.disconnect(true);
+         result.errorMessage = (bits == 0) ? String("WPS timeout") : wpsError;
+         LOG_WAN_ERROR("WPS connection failed: " << result.errorMessage << endl)
          return result;
          }
 
       // ===== SUCCESS =====
       result.success = true;
-      result.credentials = extractCredentials();
-      result.connectionTimeMs = millis() - startTime;
+      result.credentials = credentials;
+      result.channel = channel;
 
-      SERIAL_STREAM("✅ WPS connection successful!" << endl)
-      SERIAL_STREAM("Connected to: " << result.credentials.ssid << endl)
-      SERIAL_STREAM("IP Address: " << ip << endl)
-      SERIAL_STREAM("Connection time: " << result.connectionTimeMs / 1000.0 << " seconds" << endl)
-
-      // Cleanup
-      // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-      cleanupWPS(false);
-      wpsActive = false;
+      LOG_WAN_INFO("✅ WPS credentials received from: " << result.credentials.ssid << " [" << result.credentials.bssid 
+            << "] channel " << channel << " in " << result.connectionTimeMs << " ms" << endl)
 
       return result;
       } // ConnectWPS
 
    void BinaryClockWPS::CancelWPS()
       {
-      if (wpsActive)
+      if (state == WpsState::Enrolling)
          {
-         SERIAL_STREAM("Cancelling WPS connection..." << endl)
-         // esp_wifi_wps_disable();
-         // esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
-         // wpsActive = false;
+         LOG_WAN_INFO("Cancelling WPS connection..." << endl)
+         failed(WpsEvents::Error, "WPS cancelled");
          cleanupWPS(true);
-         // WiFi.disconnect(true);
          }
       }
 
@@ -282,10 +155,10 @@ namespace BinaryClockShield
 
       // Enable WPS
       esp_err_t err = esp_wifi_wps_enable(&wpsConfig);
-      SERIAL_STREAM("WPS enabled, esp_wifi_wps_enable(): " << EspErrorToString(err) << endl)
+      LOG_WAN_ERROR("WPS enabled, esp_wifi_wps_enable(): " << EspErrorToString(err) << endl)
       if (err != ESP_OK)
          {
-         SERIAL_STREAM("Failed to enable WPS: " << EspErrorToString(err) << endl)
+         LOG_WAN_ERROR("Failed to enable WPS: " << EspErrorToString(err) << endl)
          return false;
          }
 
@@ -294,27 +167,66 @@ namespace BinaryClockShield
 
    void BinaryClockWPS::cleanupWPS(bool disconnectWiFi)
       {
-      wpsActive = false;
+      if (wpsTimer != nullptr) { xTimerStop(wpsTimer, 0); }
+      if (state == WpsState::Enrolling) { state = WpsState::Idle; }
       esp_wifi_wps_disable();
       esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wpsEventHandler);
       if (disconnectWiFi)
          { WiFi.disconnect(true); }
       }
 
-   APCreds BinaryClockWPS::extractCredentials()
+   void BinaryClockWPS::received(const wifi_event_sta_wps_er_success_t* success)
       {
-      APCreds creds;
+      if (state != WpsState::Enrolling) { return; }
+      xTimerStop(wpsTimer, 0);
+
+      char ssid[MAX_SSID_LEN + 1] = { 0 };
+      char pw[MAX_PASSPHRASE_LEN + 1] = { 0 };
+      if ((success != nullptr) && (success->ap_cred_cnt > 0))
+         {
+         memcpy(ssid, success->ap_cred[0].ssid, MAX_SSID_LEN);
+         memcpy(pw, success->ap_cred[0].passphrase, MAX_PASSPHRASE_LEN);
+         }
+      else
+         {
+         wifi_config_t config = { };
+         esp_wifi_get_config(WIFI_IF_STA, &config);
+         memcpy(ssid, config.sta.ssid, MAX_SSID_LEN);
+         memcpy(pw, config.sta.password, MAX_PASSPHRASE_LEN);
+         }
 
-      // Get SSID
-      creds.ssid = WiFi.SSID();
+      // The AP associated with to enroll gave the credentials, its BSSID and channel save a scan.
+      String bssid;
+      if (apSsid == ssid)
+         {
+         char buffer[18];
+         snprintf(buffer, sizeof(buffer), "%02X:%02X:%02X:%02X:%02X:%02X", 
+                  apBssid[0], apBssid[1], apBssid[2], apBssid[3], apBssid[4], apBssid[5]);
+         bssid = buffer;
+         }
+      else
+         { channel = 0; }
 
-      // Get BSSID
-      creds.bssid = WiFi.BSSIDstr();
+      credentials = APCreds(APNames(String(ssid), bssid), String(pw));
+      state = WpsState::Received;
+      eventBits.SignalEvent(WpsEvents::Success);
+      }
 
-      //Get PSK (pw)
-      creds.pw = WiFi.psk();
+   void BinaryClockWPS::failed(WpsEvents event, const String& message)
+      {
+      if (state != WpsState::Enrolling) { return; }
+      xTimerStop(wpsTimer, 0);
 
-      return creds;
+      wpsError = message;
+      state = WpsState::Failed;
+      eventBits.SignalEvent(event);
+      }
+
+   void BinaryClockWPS::wpsTimerCallback(TimerHandle_t timer)
+      {
+      BinaryClockWPS& wps = get_Instance();
+      LOG_WAN_WARN("WPS: no AP answered in " << wps.timeout / 1000 << " sec." << endl)
+      wps.failed(WpsEvents::Timeout, "WPS timeout (" + String(wps.timeout / 1000) + " seconds)");
       }
 
    void BinaryClockWPS::wpsEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
@@ -326,120 +238,62 @@ namespace BinaryClockShield
       switch (event_id)
          {
          case WIFI_EVENT_STA_START:
-            SERIAL_STREAM("WPS: WiFi station started" << endl)
+            LOG_WAN_INFO("WPS: WiFi station started" << endl)
             ESP_ERROR_CHECK(esp_netif_init());
             break;
 
          case WIFI_EVENT_STA_CONNECTED:
             {
-            SERIAL_STREAM("WPS: WiFi station connected" << endl)
+            // The association to enroll, the AP that will send the credentials.
             wifi_event_sta_connected_t* connectData = static_cast<wifi_event_sta_connected_t*>(event_data);
-            strncpy((char*)ssid, (const char*)connectData->ssid, max(connectData->ssid_len, (uint8_t)(sizeof(ssid) - 1)));
-            SERIAL_STREAM("  SSID: " << ssid << ", Channel: " << (int)connectData->channel << endl)
-            wps->OnWPSSuccess();
+            strncpy((char*)ssid, (const char*)connectData->ssid, min(connectData->ssid_len, (uint8_t)(sizeof(ssid) - 1)));
+            LOG_WAN_INFO("WPS: WiFi station connected, SSID: " << ssid << ", Channel: " << (int)connectData->channel << endl)
+            if (wps->state == WpsState::Enrolling)
+               {
+               wps->apSsid = ssid;
+               memcpy(wps->apBssid, connectData->bssid, sizeof(wps->apBssid));
+               wps->channel = connectData->channel;
+               }
             }
             break;
 
          case WIFI_EVENT_STA_DISCONNECTED:
             {
+            // Part of the normal WPS process, not a failure.
             wifi_event_sta_disconnected_t* disconnected = (wifi_event_sta_disconnected_t*)event_data;
-            SERIAL_STREAM("WPS: Disconnected " << (char*)(disconnected->ssid) << ", reason: " << WiFiDisconnectUint8tString(disconnected->reason) << endl)
-
-            // Don't treat disconnect as failure during WPS process
-            if (!wps->wpsSuccess)
-               {
-               // This might be part of the normal WPS process
-               SERIAL_STREAM("  WPS: Disconnect during WPS process (normal)" << endl)
-               }
+            LOG_WAN_INFO("WPS: Disconnected " << (char*)(disconnected->ssid) << ", reason: " << WiFiDisconnectUint8tString(disconnected->reason) << endl)
             }
             break;
 
          case WIFI_EVENT_STA_WPS_ER_SUCCESS:
-            SERIAL_STREAM("WPS: WiFi station success." << endl)
-            wps->OnWPSSuccess();
+            LOG_WAN_INFO("WPS: ER Success - credentials received" << endl)
+            wps->received(static_cast<wifi_event_sta_wps_er_success_t*>(event_data));
             break;
 
          case WIFI_EVENT_STA_WPS_ER_FAILED:
-            SERIAL_STREAM("WPS: ER Failed" << endl)
-            wps->wpsError = "WPS ER Failed";
-            wps->wpsActive = false;
+            LOG_WAN_ERROR("WPS: ER Failed" << endl)
+            wps->failed(WpsEvents::Error, "WPS ER Failed");
             break;
 
          case WIFI_EVENT_STA_WPS_ER_TIMEOUT:
-            SERIAL_STREAM("WPS: ER Timeout" << endl)
-            wps->wpsTimeout = true;
-            wps->wpsActive = false;
+            LOG_WAN_WARN("WPS: ER Timeout" << endl)
+            wps->failed(WpsEvents::Timeout, "WPS timeout");
             break;
 
          case WIFI_EVENT_STA_WPS_ER_PIN:
-            SERIAL_STREAM("WPS: Error: PIN mode not supported." << endl)
-            wps->wpsError = "WPS PIN mode not supported";
-            wps->wpsActive = false;
+            LOG_WAN_ERROR("WPS: Error: PIN mode not supported." << endl)
+            wps->failed(WpsEvents::Error, "WPS PIN mode not supported");
             break;
 
-         default:
-            SERIAL_STREAM("WPS: Unhandled WiFi event: " << event_id << endl)
+         case WIFI_EVENT_STA_WPS_ER_PBC_OVERLAP:
+            LOG_WAN_ERROR("WPS: Error: more than one AP in push button mode." << endl)
+            wps->failed(WpsEvents::Error, "WPS push button overlap, more than one AP");
             break;
-         }
-      }
-
-   void BinaryClockWPS::OnWPSSuccess()
-      {
-      SERIAL_PRINTLN("WPS: ER Success - credentials received");
-      esp_wifi_wps_disable();
-      wpsSuccess = true;
-      wpsActive = false;  // ← Tell main loop WPS is done
-      }
-
-   bool BinaryClockWPS::WaitForConnection(uint32_t timeoutMs)
-      {
-      uint32_t startTime = millis();
-
-      while (millis() - startTime < timeoutMs)
-         {
-         wl_status_t status = WiFi.status();
-
-         SERIAL_PRINT(".");  // Progress indicator
-
-         if (status == WL_CONNECTED)
-            {
-            SERIAL_PRINTLN("\n✅ Connected!");
-            return true;
-            }
-
-         if (status == WL_CONNECT_FAILED)
-            {
-            SERIAL_PRINTLN("\n❌ Connection failed");
-            return false;
-            }
 
-         delay(500);
-         }
-
-      SERIAL_PRINTLN("\n❌ Connection timeout");
-      return false;
-      }
-
-   bool BinaryClockWPS::EnsureDHCPConfigured()
-      {
-      uint32_t startTime = millis();
-      
-      while (millis() - startTime < 10000)
-         {
-         IPAddress ip = WiFi.localIP();
-         if (ip[0] != 0)
-            {
-            SERIAL_PRINT("✅ IP: ");
-            SERIAL_PRINTLN(ip);
-            return true;
-            }
-
-         delay(100);
+         default:
+            LOG_WAN_INFO("WPS: Unhandled WiFi event: " << event_id << endl)
+            break;
          }
-      
-      SERIAL_PRINTLN("❌ DHCP timeout");
-      return false;
       }
 
    } // namespace BinaryClockShield
-
@@ -2,6 +2,8 @@
 /// @brief Header file for BinaryClockWPS class for WPS WiFi connection.
 /// @details This file defines the BinaryClockWPS class which provides
 ///          functionality to connect to WiFi networks using WPS Push Button mode.
+///          The enrollment is driven by the ESP-IDF WPS events, the waiting task sleeps on the
+///          `WpsEvents` bits until the AP answers, WPS fails or the timeout timer expires.
 /// @author Chris-70 (2025/09)
 
 #pragma once
@@ -30,6 +32,7 @@
 #endif
 
 #include <BinaryClock.Structs.h>       /// Global structures and enums used by the Binary Clock project.
+#include "TaskGroupBits.h"             /// For TaskGroupBits class to manage event group bits
 
 #define DEFAULT_WPS_TIMEOUT_MS 120000  ///< Default WPS timeout in milliseconds (2 minutes)
 
@@ -38,20 +41,31 @@ namespace BinaryClockShield
    /// @brief WPS connection result structure
    struct WPSResult
       {
-      bool success = false;           // True if WPS connection was successful
-      APCreds credentials;            // Populated AP credentials on success
+      bool success = false;           // True if the AP sent its credentials
+      APCreds credentials;            // Populated AP credentials on success, with the BSSID when known
+      uint8_t channel = 0;            // The channel of the AP, 0 = unknown
       String errorMessage;            // Error description if failed
-      uint32_t connectionTimeMs = 0;  // Time taken to connect in milliseconds
+      uint32_t connectionTimeMs = 0;  // Time taken to receive the credentials in milliseconds
       };
 
+   /// @brief The WPS events, signaled by the ESP-IDF WPS events and the timeout timer.
    enum class WpsEvents : uint8_t
       {
       Reserved = 0,
-      Success,
-      Timeout,
-      Error,
+      Success,                         ///< The AP sent its credentials.
+      Timeout,                         ///< No AP answered in time.
+      Error,                           ///< WPS failed or was cancelled.
       EventEnd
       };
+
+   /// @brief The states of the WPS enrollment.
+   enum class WpsState : uint8_t
+      {
+      Idle = 0,                        ///< WPS is off.
+      Enrolling,                       ///< Waiting for the AP, the user presses its WPS button.
+      Received,                        ///< The credentials were received.
+      Failed                           ///< WPS failed, timed out or was cancelled.
+      };
       
    /// @brief BinaryClockWPS class for WiFi connection using WPS Push Button mode
    /// @details This class handles WiFi Protected Setup (WPS) connections using the push button method.
@@ -62,18 +76,33 @@ namespace BinaryClockShield
    public:
       static BinaryClockWPS& get_Instance();
 
-      /// @brief Start WPS Push Button connection
+      /// @brief Start WPS Push Button enrollment and return at once.
+      /// @details The end of the enrollment is signaled on the `WpsEvents` bits: `Success`,
+      ///          `Timeout` (after `get_Timeout()` ms) or `Error`.
+      /// @return True if WPS was started, or is already in progress.
+      /// @author Chris-70 (2026/10)
+      bool Start();
+
+      /// @brief Get the WPS credentials from the AP.
       /// @details Initiates WPS push button mode. User must press the WPS button on the router
-      ///          within the timeout period for connection to succeed.
+      ///          within the timeout period. The task sleeps until the AP sends its credentials,
+      ///          it doesn't connect, the caller connects with them (e.g. `BinaryClockWAN`).
       /// @return WPSResult containing success status and AP credentials
       WPSResult ConnectWPS();
       
-      /// @brief Cancel any ongoing WPS connection attempt
+      /// @brief Cancel any ongoing WPS connection attempt, `Error` is signaled.
       void CancelWPS();
 
       /// @brief Check if WPS connection is in progress
       /// @return True if WPS connection attempt is active
-      bool get_IsConnecting() const { return wpsActive; }
+      bool get_IsConnecting() const { return (state == WpsState::Enrolling); }
+
+      /// @brief Read only property: The state of the WPS enrollment.
+      WpsState get_State() const { return state; }
+
+      /// @brief Property (WO): EventBits - The event bits to signal the `WpsEvents` on, e.g. in the
+      ///        event group of `BinaryClockWAN`; an event group is created if not set.
+      void set_EventBits(const TaskGroupBits<WpsEvents>& value) { eventBits = value; }
       
       /// @brief Set the timeout for WPS connection.
       /// @param timeoutMs Timeout in milliseconds.
@@ -105,29 +134,37 @@ namespace BinaryClockShield
       /// @param disconnectWiFi If true, disconnects the current WiFi connection; otherwise preserves it.
       void cleanupWPS(bool disconnectWiFi);
 
-      /// @brief Extract AP credentials from WiFi connection.
-      /// @return APCreds structure with connection details.
-      APCreds extractCredentials();
+      /// @brief The AP sent its credentials: keep them and signal `Success`.
+      /// @param success The event data, the credentials when there is more than one AP; with one
+      ///                the driver has put them in the station configuration.
+      /// @author Chris-70 (2026/10)
+      void received(const wifi_event_sta_wps_er_success_t* success);
+
+      /// @brief End the enrollment with the `event` (`Timeout` or `Error`).
+      /// @param event The event to signal.
+      /// @param message The error description.
+      void failed(WpsEvents event, const String& message);
 
       // Static callback functions for WPS events.
       static void wpsEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 
-      void OnWPSSuccess();
+      /// @brief The timeout timer callback, runs in the FreeRTOS timer task.
+      static void wpsTimerCallback(TimerHandle_t timer);
 
-      bool WaitForConnection(uint32_t timeoutMs);
-
-      bool EnsureDHCPConfigured();
-      
       uint32_t timeout;             // WPS connection timeout in milliseconds.
-      bool wpsActive;               // Flag indicating WPS is active.
+      volatile WpsState state;      // The state of the enrollment.
 
       // WPS configuration
       esp_wps_config_t wpsConfig;
 
       // WPS event handling
-      bool wpsSuccess;
-      bool wpsTimeout;
-      String wpsError;
+      TaskGroupBits<WpsEvents> eventBits;    // The WPS event bits.
+      TimerHandle_t wpsTimer = nullptr;      // The one shot timer of the enrollment timeout.
+      APCreds credentials;                   // The credentials received.
+      uint8_t channel = 0;                   // The channel of the AP, 0 = unknown.
+      String  apSsid;                        // The SSID of the AP associated with to enroll.
+      uint8_t apBssid[6] = { 0 };            // The BSSID of the AP associated with to enroll.
+      String  wpsError;                      // The error description.
       }; // class BinaryClockWPS
 
    } // namespace BinaryClockShield
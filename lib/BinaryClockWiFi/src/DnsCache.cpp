@@ -0,0 +1,193 @@
+/// @file DnsCache.cpp
+/// @brief The implementation of the `DnsCache` class, the resolved addresses of the NTP servers.
+/// @author Chris-70 (2026/10)
+
+#include "DnsCache.h"
+
+#include <string.h>                    /// For strlen(); strchr(); strcmp(); strncpy(); memcpy() and memset().
+
+#define DNS_HEADER_SIZE     12U        ///< The size of the DNS header.
+#define DNS_TYPE_A           1U        ///< The type of an IPv4 address record.
+#define DNS_CLASS_IN         1U        ///< The Internet class.
+
+namespace BinaryClockShield
+   {
+   DnsLookup DnsCache::Lookup(const char* name, uint32_t nowMs, uint32_t& address)
+      {
+      size_t index = find(name);
+      if (index == DNS_CACHE_ENTRIES)
+         {
+         misses++;
+         return DnsLookup::Miss;
+         }
+
+      Entry& entry = entries[index];
+      uint32_t age = nowMs - entry.storedMs;
+      if (age >= entry.ttlMs + DNS_CACHE_STALE_S * 1000UL)
+         {
+         entry = Entry();     // Too old to trust, resolve it again.
+         misses++;
+         return DnsLookup::Miss;
+         }
+
+      entry.usedMs = nowMs;
+      entry.inUse = true;
+      address = entry.address;
+      if (age < entry.ttlMs)
+         {
+         hits++;
+         return DnsLookup::Fresh;
+         }
+
+      stale++;
+      return DnsLookup::Stale;
+      }
+
+   void DnsCache::Store(const char* name, uint32_t address, uint32_t ttlS, uint32_t nowMs)
+      {
+      if ((name == nullptr) || (strlen(name) >= DNS_CACHE_NAME_SIZE) || (address == 0)) { return; }
+
+      size_t index = find(name);
+      if (index == DNS_CACHE_ENTRIES)
+         {
+         // A free entry, else the least recently used.
+         index = 0;
+         for (size_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+            {
+            if (entries[i].name[0] == '\0') { index = i; break; }
+            if ((uint32_t)(nowMs - entries[i].usedMs) > (uint32_t)(nowMs - entries[index].usedMs)) { index = i; }
+            }
+         entries[index] = Entry();
+         strncpy(entries[index].name, name, DNS_CACHE_NAME_SIZE - 1);
+         }
+
+      ttlS = (ttlS < DNS_CACHE_MIN_TTL_S) ? DNS_CACHE_MIN_TTL_S : ((ttlS > DNS_CACHE_MAX_TTL_S) ? DNS_CACHE_MAX_TTL_S : ttlS);
+      Entry& entry = entries[index];
+      entry.address = address;
+      entry.storedMs = nowMs;
+      entry.ttlMs = ttlS * 1000UL;
+      entry.usedMs = nowMs;
+      entry.inUse = false;
+      }
+
+   bool DnsCache::GetDue(size_t index, uint32_t nowMs, char* name) const
+      {
+      if ((index >= DNS_CACHE_ENTRIES) || (entries[index].name[0] == '\0') || !entries[index].inUse) { return false; }
+
+      const Entry& entry = entries[index];
+      uint32_t age = nowMs - entry.storedMs;
+      uint32_t refreshMs = DNS_CACHE_REFRESH_S * 1000UL;
+      if ((age + refreshMs) < entry.ttlMs) { return false; }
+
+      memcpy(name, entry.name, DNS_CACHE_NAME_SIZE);
+      return true;
+      }
+
+   uint32_t DnsCache::GetHitRate() const
+      {
+      uint32_t lookups = hits + stale + misses;
+      return (lookups > 0) ? (uint32_t)(((uint64_t)(hits + stale) * 100ULL) / lookups) : 0;
+      }
+
+   size_t DnsCache::MakeQuery(const char* name, uint16_t id, uint8_t* out, size_t size)
+      {
+      size_t nameLength = (name != nullptr) ? strlen(name) : 0;
+      if ((nameLength == 0) || (nameLength > 253) || (DNS_HEADER_SIZE + nameLength + 2 + 4 > size)) { return 0; }
+
+      // Header: ID, flags RD (recursion desired), 1 question.
+      memset(out, 0, DNS_HEADER_SIZE);
+      out[0] = (uint8_t)(id >> 8);
+      out[1] = (uint8_t)id;
+      out[2] = 0x01;
+      out[5] = 1;
+
+      // The name as labels: "pool.ntp.org" => 4 pool 3 ntp 3 org 0.
+      size_t offset = DNS_HEADER_SIZE;
+      const char* label = name;
+      while (*label != '\0')
+         {
+         const char* dot = strchr(label, '.');
+         size_t labelLength = (dot != nullptr) ? (size_t)(dot - label) : strlen(label);
+         if ((labelLength == 0) || (labelLength > 63)) { return 0; }
+
+         out[offset++] = (uint8_t)labelLength;
+         memcpy(out + offset, label, labelLength);
+         offset += labelLength;
+         label += labelLength + ((dot != nullptr) ? 1 : 0);   // A trailing dot ends the name.
+         }
+      out[offset++] = 0;
+
+      out[offset++] = 0;
+      out[offset++] = DNS_TYPE_A;
+      out[offset++] = 0;
+      out[offset++] = DNS_CLASS_IN;
+      return offset;
+      }
+
+   DnsReply DnsCache::ParseReply(const uint8_t* in, size_t length, uint16_t id, uint32_t& address, uint32_t& ttlS)
+      {
+      if ((length < DNS_HEADER_SIZE) || (in[0] != (uint8_t)(id >> 8)) || (in[1] != (uint8_t)id) || ((in[2] & 0x80) == 0))
+         { return DnsReply::Invalid; }   // Not the reply to the query.
+      if ((in[3] & 0x0F) != 0)
+         { return DnsReply::NoAddress; }   // NXDOMAIN, SERVFAIL, REFUSED, ...
+
+      size_t questions = ((size_t)in[4] << 8) | in[5];
+      size_t answers = ((size_t)in[6] << 8) | in[7];
+      size_t offset = DNS_HEADER_SIZE;
+      for (size_t i = 0; i < questions; i++)
+         {
+         offset = skipName(in, length, offset);
+         if ((offset == 0) || (offset + 4 > length)) { return DnsReply::Invalid; }
+         offset += 4;   // Type and class.
+         }
+
+      uint32_t minTtl = UINT32_MAX;
+      for (size_t i = 0; i < answers; i++)
+         {
+         offset = skipName(in, length, offset);
+         if ((offset == 0) || (offset + 10 > length)) { return DnsReply::Invalid; }
+
+         uint16_t type = ((uint16_t)in[offset] << 8) | in[offset + 1];
+         uint16_t rclass = ((uint16_t)in[offset + 2] << 8) | in[offset + 3];
+         uint32_t ttl = ((uint32_t)in[offset + 4] << 24) | ((uint32_t)in[offset + 5] << 16) | ((uint32_t)in[offset + 6] << 8) | in[offset + 7];
+         size_t dataLength = ((size_t)in[offset + 8] << 8) | in[offset + 9];
+         offset += 10;
+         if (offset + dataLength > length) { return DnsReply::Invalid; }
+
+         minTtl = (ttl < minTtl) ? ttl : minTtl;
+         if ((type == DNS_TYPE_A) && (rclass == DNS_CLASS_IN) && (dataLength == 4))
+            {
+            memcpy(&address, in + offset, 4);   // Already in network order.
+            ttlS = minTtl;
+            return DnsReply::Address;
+            }
+         offset += dataLength;
+         }
+
+      return DnsReply::NoAddress;
+      }
+
+   size_t DnsCache::skipName(const uint8_t* in, size_t length, size_t offset)
+      {
+      while (offset < length)
+         {
+         uint8_t labelLength = in[offset];
+         if (labelLength == 0) { return offset + 1; }
+         if ((labelLength & 0xC0) == 0xC0) { return (offset + 2 <= length) ? offset + 2 : 0; }   // A pointer ends the name.
+         if ((labelLength & 0xC0) != 0) { return 0; }
+         offset += 1 + labelLength;
+         }
+
+      return 0;
+      }
+
+   size_t DnsCache::find(const char* name) const
+      {
+      for (size_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+         {
+         if ((entries[i].name[0] != '\0') && (strcmp(entries[i].name, name) == 0)) { return i; }
+         }
+
+      return DNS_CACHE_ENTRIES;
+      }
+   } // namespace BinaryClockShield
@@ -0,0 +1,166 @@
+/// @file DnsCache.h
+/// @brief The header file for the `DnsCache` class, the resolved addresses of the NTP servers.
+/// @details A sync should be a single UDP round trip, not a DNS lookup then the NTP exchange:
+///          - each name resolved is kept with the TTL of its A record (clamped to
+///            `DNS_CACHE_MIN_TTL_S` - `DNS_CACHE_MAX_TTL_S`), a lookup within the TTL is a hit;
+///          - after the TTL the address is still used (stale, RFC 8767) and the name is refreshed
+///            after the sync (`GetDue()`), off the sync's critical path;
+///          - when DNS fails the last known good address is used for `DNS_CACHE_STALE_S`;
+///          - the hits, stale hits, misses and failures are counted, `GetHitRate()`.
+///          `MakeQuery()` and `ParseReply()` build the A query and read the reply with its TTL, the
+///          query is sent by `BinaryClockNTP` to the DNS server of the network.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host,
+///          `test/host/test_dns_cache.cpp` checks it against a stub resolver, `test/ntp_standin.py dns`
+///          is one to test a clock against. The times are `millis()` values (the differences are
+///          wrap safe), the addresses are IPv4 in network order.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __DNSCACHE_H__
+#define __DNSCACHE_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef DNS_CACHE_ENTRIES
+   #define DNS_CACHE_ENTRIES           8U   ///< The names cached, the least recently used is replaced.
+#endif
+#ifndef DNS_CACHE_NAME_SIZE
+   #define DNS_CACHE_NAME_SIZE        64U   ///< The longest name cached + 1, a longer one isn't cached.
+#endif
+#ifndef DNS_CACHE_MIN_TTL_S
+   #define DNS_CACHE_MIN_TTL_S        60U   ///< The shortest TTL (s) kept, e.g. a pool with TTL 0.
+#endif
+#ifndef DNS_CACHE_MAX_TTL_S
+   #define DNS_CACHE_MAX_TTL_S     86400U   ///< The longest TTL (s) kept, 1 day.
+#endif
+#ifndef DNS_CACHE_DEFAULT_TTL_S
+   #define DNS_CACHE_DEFAULT_TTL_S   300U   ///< The TTL (s) of an address resolved without a TTL (e.g. `hostByName()`).
+#endif
+#ifndef DNS_CACHE_REFRESH_S
+   #define DNS_CACHE_REFRESH_S        60U   ///< A name is refreshed this long (s) before its TTL ends.
+#endif
+#ifndef DNS_CACHE_STALE_S
+   #define DNS_CACHE_STALE_S      604800U   ///< The last known good address is used this long (s) after its TTL, 7 days.
+#endif
+#ifndef DNS_QUERY_TIMEOUT_MS
+   #define DNS_QUERY_TIMEOUT_MS      750U   ///< The time (ms) to wait for the DNS reply, the query is sent twice.
+#endif
+
+#define DNS_MESSAGE_SIZE             512U   ///< The largest DNS message over UDP.
+#define DNS_QUERY_SIZE               272U   ///< The largest A query: the header, a 253 character name and the type and class.
+#define DNS_PORT                      53U   ///< The UDP port of the DNS server.
+
+namespace BinaryClockShield
+   {
+   /// @brief The result of a cache lookup.
+   enum class DnsLookup : uint8_t
+      {
+      Miss = 0,                        ///< Not cached, or older than `DNS_CACHE_STALE_S`: resolve it now.
+      Fresh,                           ///< Cached within its TTL.
+      Stale                            ///< Cached after its TTL: use it and refresh it after the sync.
+      };
+
+   /// @brief What a DNS reply is.
+   enum class DnsReply : uint8_t
+      {
+      Invalid = 0,                     ///< Malformed or not the reply to the query, keep waiting.
+      Address,                         ///< The A record: the address and the TTL.
+      NoAddress                        ///< The name doesn't exist or has no A record, or the server failed.
+      };
+
+   /// @brief The cache of the resolved addresses of the NTP servers, with the TTL and a stale fallback.
+   /// @author Chris-70 (2026/10)
+   class DnsCache
+      {
+   public:
+      DnsCache() = default;
+
+      /// @brief Look a name up.
+      /// @param name The host name.
+      /// @param nowMs The time, `millis()`.
+      /// @param address Returns the address (network order) for `Fresh` and `Stale`.
+      /// @return `Fresh`, `Stale` or `Miss`; the counts are updated.
+      /// @author Chris-70 (2026/10)
+      DnsLookup Lookup(const char* name, uint32_t nowMs, uint32_t& address);
+
+      /// @brief Store the address of a name just resolved.
+      /// @param name The host name.
+      /// @param address The address (network order).
+      /// @param ttlS The TTL of the record (s), clamped to `DNS_CACHE_MIN_TTL_S` - `DNS_CACHE_MAX_TTL_S`.
+      /// @param nowMs The time, `millis()`.
+      void Store(const char* name, uint32_t address, uint32_t ttlS, uint32_t nowMs);
+
+      /// @brief Count a name that couldn't be resolved, the cached address (if any) is kept.
+      void Failed() { failures++; }
+
+      /// @brief Get the name of entry `index` if it is due for a refresh: looked up since it was
+      ///        resolved and stale, or within `DNS_CACHE_REFRESH_S` of its TTL. A name no longer
+      ///        used isn't refreshed, it is replaced in time.
+      /// @param index The entry, 0 to `DNS_CACHE_ENTRIES` - 1.
+      /// @param nowMs The time, `millis()`.
+      /// @param name Returns the name, `DNS_CACHE_NAME_SIZE` characters.
+      /// @return True if the entry is due.
+      bool GetDue(size_t index, uint32_t nowMs, char* name) const;
+
+      /// @brief Get the hit rate in percent: the fresh and stale hits of all the lookups, 0 if none.
+      uint32_t GetHitRate() const;
+
+      /// @brief Read only property: The lookups within the TTL.
+      uint32_t get_Hits() const { return hits; }
+      /// @brief Read only property: The lookups after the TTL, the stale address was used.
+      uint32_t get_Stale() const { return stale; }
+      /// @brief Read only property: The lookups that weren't cached.
+      uint32_t get_Misses() const { return misses; }
+      /// @brief Read only property: The names that couldn't be resolved.
+      uint32_t get_Failures() const { return failures; }
+
+      /// @brief Make the A query of a name.
+      /// @param name The host name.
+      /// @param id The query ID, returned in the reply.
+      /// @param out Returns the query.
+      /// @param size The size of `out`.
+      /// @return The length of the query, 0 if the name isn't valid or too long.
+      static size_t MakeQuery(const char* name, uint16_t id, uint8_t* out, size_t size);
+
+      /// @brief Read the reply to a query.
+      /// @details The first A record of the answers is the address, the TTL is the smallest of the
+      ///          answers up to it (e.g. a CNAME chain).
+      /// @param in The reply.
+      /// @param length The length of the reply.
+      /// @param id The query ID.
+      /// @param address Returns the address (network order) for `Address`.
+      /// @param ttlS Returns the TTL (s) for `Address`.
+      /// @return What the reply is.
+      /// @author Chris-70 (2026/10)
+      static DnsReply ParseReply(const uint8_t* in, size_t length, uint16_t id, uint32_t& address, uint32_t& ttlS);
+
+   protected:
+      /// @brief Skip a name (labels or a compression pointer).
+      /// @return The offset after the name, 0 if it's malformed.
+      static size_t skipName(const uint8_t* in, size_t length, size_t offset);
+
+      /// @brief Find the entry of a name, `DNS_CACHE_ENTRIES` if it isn't cached.
+      size_t find(const char* name) const;
+
+   private:
+      /// @brief A name resolved.
+      struct Entry
+         {
+         char     name[DNS_CACHE_NAME_SIZE] = { 0 };   ///< The host name, empty if the entry is free.
+         uint32_t address  = 0;        ///< The address (network order).
+         uint32_t storedMs = 0;        ///< The time (`millis()`) it was resolved.
+         uint32_t ttlMs    = 0;        ///< The TTL (ms).
+         uint32_t usedMs   = 0;        ///< The time (`millis()`) of the last lookup, the least recent is replaced.
+         bool     inUse    = false;    ///< Flag: looked up since it was resolved.
+         };
+
+      Entry    entries[DNS_CACHE_ENTRIES];         ///< The names resolved.
+      uint32_t hits     = 0;                       ///< The lookups within the TTL.
+      uint32_t stale    = 0;                       ///< The lookups after the TTL.
+      uint32_t misses   = 0;                       ///< The lookups that weren't cached.
+      uint32_t failures = 0;                       ///< The names that couldn't be resolved.
+      }; // class DnsCache
+   } // namespace BinaryClockShield
+
+#endif // __DNSCACHE_H__
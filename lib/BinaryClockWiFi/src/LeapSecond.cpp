@@ -0,0 +1,87 @@
+/// @file LeapSecond.cpp
+/// @brief The implementation of the `LeapSecond` class, the leap second announced by the NTP servers.
+/// @author Chris-70 (2026/10)
+
+#include "LeapSecond.h"
+
+#define DAY_S   86400LL                ///< The seconds in a day, UTC days have no leap seconds in POSIX time.
+
+namespace BinaryClockShield
+   {
+   bool LeapSecond::Update(uint8_t li, int64_t utcS)
+      {
+      if (li > 2) { return false; }   // Unsynchronized, the server's LI means nothing.
+
+      bool changed = false;
+      if ((leap != 0) && (utcS >= eventS))
+         {
+         // The event passed without `Applied()`, the server's time this sync has the leap already.
+         appliedS = eventS;
+         leap = 0;
+         eventS = 0;
+         changed = true;
+         }
+
+      if (li == 0)
+         {
+         if (leap != 0)
+            {
+            leap = 0;      // Withdrawn before the event.
+            eventS = 0;
+            changed = true;
+            }
+         return changed;
+         }
+
+      if ((appliedS != 0) && (utcS < appliedS + (int64_t)LEAP_HOLDOFF_S)) { return changed; }
+
+      int8_t value = (li == 1) ? 1 : -1;
+      int64_t event = NextMonthS(utcS);
+      if ((value != leap) || (event != eventS))
+         {
+         leap = value;
+         eventS = event;
+         changed = true;
+         }
+
+      return changed;
+      }
+
+   void LeapSecond::Applied()
+      {
+      if (leap == 0) { return; }
+
+      appliedS = eventS;
+      applied++;
+      leap = 0;
+      eventS = 0;
+      }
+
+   int64_t LeapSecond::NextMonthS(int64_t utcS)
+      {
+      // The civil date of the day (H. Hinnant's algorithm, the proleptic Gregorian calendar).
+      int64_t days = (utcS >= 0) ? (utcS / DAY_S) : ((utcS - DAY_S + 1) / DAY_S);
+      int64_t z = days + 719468;
+      int64_t era = ((z >= 0) ? z : (z - 146096)) / 146097;
+      int64_t doe = z - era * 146097;
+      int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+      int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+      int64_t mp = (5 * doy + 2) / 153;
+      int64_t month = (mp < 10) ? (mp + 3) : (mp - 9);
+      int64_t year = yoe + era * 400 + ((month <= 2) ? 1 : 0);
+
+      // The 1st of the next month, back to days.
+      if (++month > 12)
+         {
+         month = 1;
+         year++;
+         }
+      year -= (month <= 2) ? 1 : 0;
+      era = ((year >= 0) ? year : (year - 399)) / 400;
+      yoe = year - era * 400;
+      doy = (153 * ((month > 2) ? (month - 3) : (month + 9)) + 2) / 5;
+      doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+      return (era * 146097 + doe - 719468) * DAY_S;
+      }
+   } // namespace BinaryClockShield
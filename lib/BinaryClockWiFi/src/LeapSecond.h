@@ -0,0 +1,76 @@
+/// @file LeapSecond.h
+/// @brief The header file for the `LeapSecond` class, the leap second announced by the NTP servers.
+/// @details The leap indicator (LI) of the NTP replies announces a leap second at the end of the
+///          current UTC month: 1 inserts 23:59:60, 2 deletes 23:59:59. The time of the servers
+///          doesn't change before the event, so without the LI the clock is a second off until the
+///          next sync after it. `Update()` is called after each sync with the LI of the reply used:
+///          - an announcement sets the event, 00:00:00 UTC of the 1st of the next month;
+///          - a reply without the LI before the event cancels it (the server withdrew it);
+///          - an announcement within `LEAP_HOLDOFF_S` after a leap is ignored, a server that
+///            hasn't cleared its LI yet would announce a leap at the end of the next month.
+///          At the event the caller steps the system clock (`get_StepS()`) and calls `Applied()`.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host,
+///          `test/host/test_leap_second.cpp` feeds it synthetic announcements, as does the Python
+///          model `test/leap_second_sim.py`. The times are UTC seconds since 1970-01-01.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __LEAPSECOND_H__
+#define __LEAPSECOND_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#ifndef LEAP_SMEAR_S
+   #define LEAP_SMEAR_S               0U   ///< The display smear window (s) ending at the leap, 0 shows 23:59:60.
+#endif
+#ifndef LEAP_HOLDOFF_S
+   #define LEAP_HOLDOFF_S         86400U   ///< The announcements are ignored this long (s) after a leap, 1 day.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The leap second announced by the NTP servers, from the leap indicator of the replies.
+   /// @author Chris-70 (2026/10)
+   class LeapSecond
+      {
+   public:
+      LeapSecond() = default;
+
+      /// @brief Update the leap second from the leap indicator of a sync.
+      /// @param li The leap indicator of the reply: 0 none; 1 insert; 2 delete; 3 (unsynchronized) is ignored.
+      /// @param utcS The UTC time of the sync (s).
+      /// @return True if the leap second changed: announced, moved, cancelled or missed.
+      /// @author Chris-70 (2026/10)
+      bool Update(uint8_t li, int64_t utcS);
+
+      /// @brief The leap second was applied at the event, the system clock was stepped.
+      void Applied();
+
+      /// @brief Read only property: The leap second pending: +1 insert; -1 delete; 0 none.
+      int8_t get_Leap() const { return leap; }
+
+      /// @brief Read only property: The event: the UTC time (s) of the first second after the leap, 0 if none.
+      int64_t get_EventS() const { return eventS; }
+
+      /// @brief Read only property: The UTC time (s) the system clock is stepped by -`get_Leap()` s:
+      ///        the event to repeat 23:59:59 (insert), a second before it to skip 23:59:59 (delete).
+      int64_t get_StepS() const { return (leap < 0) ? (eventS - 1) : eventS; }
+
+      /// @brief Read only property: The leap seconds applied.
+      uint32_t get_Applied() const { return applied; }
+
+      /// @brief Get the start of the next UTC month, 00:00:00 of the 1st.
+      /// @param utcS The UTC time (s).
+      /// @return The UTC time (s) of the start of the next month.
+      /// @author Chris-70 (2026/10)
+      static int64_t NextMonthS(int64_t utcS);
+
+   private:
+      int64_t  eventS   = 0;           ///< The UTC time (s) of the first second after the leap, 0 if none.
+      int64_t  appliedS = 0;           ///< The UTC time (s) of the last leap applied, 0 if none.
+      uint32_t applied  = 0;           ///< The leap seconds applied.
+      int8_t   leap     = 0;           ///< The leap second pending: +1 insert; -1 delete; 0 none.
+      }; // class LeapSecond
+   } // namespace BinaryClockShield
+
+#endif // __LEAPSECOND_H__
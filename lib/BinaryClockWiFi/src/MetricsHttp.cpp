@@ -0,0 +1,48 @@
+/// @file MetricsHttp.cpp
+/// @brief The implementation of the `MetricsHttp` class, the route of a metrics request and the
+///        header of its reply.
+/// @author Chris-70 (2026/10)
+
+#include "MetricsHttp.h"
+
+#include <stdio.h>                     /// For snprintf()
+#include <string.h>                    /// For strncmp(), strchr() and memchr()
+
+namespace BinaryClockShield
+   {
+   uint16_t MetricsHttp::Route(const char* request, bool& head)
+      {
+      // The request line: "<method> <path>[?<query>] HTTP/1.x"
+      head = (strncmp(request, "HEAD ", 5) == 0);
+      const char* path = strchr(request, ' ');
+      const char* version = (path != nullptr) ? strchr(path + 1, ' ') : nullptr;
+      if ((version == nullptr) || (strncmp(version + 1, "HTTP/1.", 7) != 0)) { return 400; }
+      if (!head && (strncmp(request, "GET ", 4) != 0)) { return 405; }
+
+      path++;
+      size_t length = (size_t)(version - path);
+      const char* query = (const char*)memchr(path, '?', length);
+      if (query != nullptr) { length = (size_t)(query - path); }
+      return ((length == 8) && (strncmp(path, "/metrics", 8) == 0)) ? 200 : 404;
+      }
+
+   const char* MetricsHttp::Reason(uint16_t status)
+      {
+      switch (status)
+         {
+         case 200: return "OK";
+         case 400: return "Bad Request";
+         case 404: return "Not Found";
+         case 405: return "Method Not Allowed";
+         default:  return "Internal Server Error";
+         }
+      }
+
+   size_t MetricsHttp::Header(uint16_t status, size_t length, char* out, size_t size)
+      {
+      int written = snprintf(out, size, "HTTP/1.1 %u %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n%sConnection: close\r\n\r\n",
+            (unsigned)status, Reason(status), ((status == 200) ? METRICS_CONTENT_TYPE : "text/plain"),
+            (unsigned)length, ((status == 405) ? "Allow: GET, HEAD\r\n" : ""));
+      return ((written <= 0) || ((size_t)written >= size)) ? 0 : (size_t)written;
+      }
+   } // namespace BinaryClockShield
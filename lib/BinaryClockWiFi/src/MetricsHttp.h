@@ -0,0 +1,55 @@
+/// @file MetricsHttp.h
+/// @brief The header file for the `MetricsHttp` class, the HTTP side of the metrics endpoint: the
+///        route of a request and the header of the reply.
+/// @details The server (`BinaryClockMetrics`) owns the sockets and the buffers; this class only reads
+///          the request line and writes the status line and headers:
+///          - `GET` (or `HEAD`) `/metrics`, the query string ignored, is 200; another path 404;
+///            another method 405 (with `Allow`); a line that isn't HTTP/1.x 400;
+///          - the reply always has `Content-Length` and `Connection: close`, one request per client.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host,
+///          `test/host/test_metrics.cpp`; the buffer sizes of the server are here for the same reason.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __METRICSHTTP_H__
+#define __METRICSHTTP_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// For size_t
+
+#define METRICS_CONTENT_TYPE  "text/plain; version=0.0.4; charset=utf-8"   ///< The Prometheus text format.
+#define METRICS_HEADER_SIZE   160U     ///< The size of the status line and headers of a reply.
+#ifndef METRICS_BUFFER_SIZE
+   #define METRICS_BUFFER_SIZE   2560U   ///< The size of the text buffer, all the metrics with their HELP and TYPE.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The route of a metrics request and the header of its reply.
+   /// @author Chris-70 (2026/10)
+   class MetricsHttp
+      {
+   public:
+      /// @brief Get the status of a request: 200 for `GET` (or `HEAD`) `/metrics`, 404 for another
+      ///        path, 405 for another method and 400 if it isn't a HTTP request line.
+      /// @param request The request, at least the request line.
+      /// @param head Returns true for a `HEAD` request.
+      /// @return The HTTP status code.
+      /// @author Chris-70 (2026/10)
+      static uint16_t Route(const char* request, bool& head);
+
+      /// @brief Get the reason phrase of a status code, "Internal Server Error" for one not routed.
+      static const char* Reason(uint16_t status);
+
+      /// @brief Write the status line and the headers of a reply.
+      /// @param status The HTTP status code.
+      /// @param length The length of the body, also sent for `HEAD`.
+      /// @param out Returns the header, NUL terminated.
+      /// @param size The size of `out`, `METRICS_HEADER_SIZE`.
+      /// @return The length of the header, 0 if `out` is too small.
+      /// @author Chris-70 (2026/10)
+      static size_t Header(uint16_t status, size_t length, char* out, size_t size);
+      }; // class MetricsHttp
+   } // namespace BinaryClockShield
+
+#endif // __METRICSHTTP_H__
@@ -0,0 +1,92 @@
+/// @file NtpClockFilter.cpp
+/// @brief The implementation of the `NtpClockFilter` class, the intersection algorithm used to
+///        select the time from several NTP servers.
+/// @author Chris-70 (2026/10)
+
+#include "NtpClockFilter.h"
+
+namespace BinaryClockShield
+   {
+   bool NtpClockFilter::Add(const NtpSample& sample)
+      {
+      if (count >= NTP_MAX_SAMPLES) { return false; }
+
+      samples[count++] = sample;
+      return true;
+      }
+
+   bool NtpClockFilter::Select(int64_t& offsetUs, size_t& best)
+      {
+      survivors = 0;
+      if (count == 0) { return false; }
+
+      // The interval end points sorted by value, a low end sorts before a high end of the same value.
+      struct EndPoint { int64_t value; int8_t type; };   // type: +1 low end; -1 high end
+      EndPoint points[2 * NTP_MAX_SAMPLES];
+      size_t pointCount = 0;
+      for (size_t i = 0; i < count; i++)
+         {
+         points[pointCount++] = { samples[i].offsetUs - samples[i].distanceUs, +1 };
+         points[pointCount++] = { samples[i].offsetUs + samples[i].distanceUs, -1 };
+         }
+
+      for (size_t i = 1; i < pointCount; i++)   // Insertion sort, at most 16 entries.
+         {
+         EndPoint point = points[i];
+         size_t j = i;
+         while ((j > 0) && ((points[j - 1].value > point.value) || ((points[j - 1].value == point.value) && (points[j - 1].type < point.type))))
+            {
+            points[j] = points[j - 1];
+            j--;
+            }
+         points[j] = point;
+         }
+
+      // Allow `falsetickers` samples outside the intersection, fewer than half.
+      int64_t low = 0, high = 0;
+      bool found = false;
+      for (size_t falsetickers = 0; (2 * falsetickers < count) && !found; falsetickers++)
+         {
+         int needed = (int)(count - falsetickers);
+         int overlap = 0;
+         size_t i;
+         for (i = 0; i < pointCount; i++)
+            {
+            overlap += points[i].type;
+            if (overlap >= needed) { low = points[i].value; break; }
+            }
+         if (i == pointCount) { continue; }
+
+         overlap = 0;
+         for (i = pointCount; i-- > 0; )
+            {
+            overlap -= points[i].type;
+            if (overlap >= needed) { high = points[i].value; break; }
+            }
+
+         found = (low <= high);
+         }
+
+      if (!found) { return false; }
+
+      // The survivors contain the intersection, average them weighted by 1 / distance.
+      double weightSum = 0.0;
+      double offsetSum = 0.0;
+      for (size_t i = 0; i < count; i++)
+         {
+         const NtpSample& sample = samples[i];
+         if (((sample.offsetUs - sample.distanceUs) <= high) && ((sample.offsetUs + sample.distanceUs) >= low))
+            {
+            survivors |= (uint16_t)(1U << i);
+            double weight = 1.0 / (double)(sample.distanceUs > 0 ? sample.distanceUs : 1);
+            weightSum += weight;
+            offsetSum += weight * (double)sample.offsetUs;
+            if ((survivors == (1U << i)) || (sample.distanceUs < samples[best].distanceUs))
+               { best = i; }
+            }
+         }
+
+      offsetUs = (int64_t)(offsetSum / weightSum);
+      return true;
+      }
+   } // namespace BinaryClockShield
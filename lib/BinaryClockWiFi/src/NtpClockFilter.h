@@ -0,0 +1,91 @@
+/// @file NtpClockFilter.h
+/// @brief The header file for the `NtpClockFilter` class, the selection of the best time from
+///        the replies of several NTP servers.
+/// @details Each reply is a sample with an offset and a root distance (the maximum error: half
+///          the round trip delay plus the server's own root delay and dispersion). The sample's
+///          correctness interval is [offset - distance, offset + distance]. The intersection
+///          algorithm (Marzullo / RFC 5905 section 11.2.1) finds the smallest interval shared by
+///          a majority of the samples, the samples that don't overlap it (falsetickers, e.g. a
+///          server that lies) are discarded. The offset is the average of the survivors weighted by
+///          1 / distance and the survivor with the smallest distance is reported as the best.
+/// @remarks The class has no Arduino or ESP-IDF dependencies, `test/host/test_ntp_clock_filter.cpp`
+///          checks it on the host; `test/ntp_standin.py` has the same algorithm to test against
+///          stand-in servers.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __NTPCLOCKFILTER_H__
+#define __NTPCLOCKFILTER_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef NTP_MAX_SAMPLES
+   #define NTP_MAX_SAMPLES       8U    ///< The maximum number of servers queried together.
+#endif
+#ifndef NTP_MIN_DISPERSION_US
+   #define NTP_MIN_DISPERSION_US 5000  ///< The minimum dispersion added to each sample in µs (RFC 5905 MINDISP).
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief One NTP server reply.
+   struct NtpSample
+      {
+      int64_t offsetUs;                ///< The clock offset, server - system time, in µs.
+      int64_t delayUs;                 ///< The round trip delay in µs.
+      int64_t distanceUs;              ///< The root distance (maximum error) in µs.
+      uint8_t server;                  ///< The index of the server in the list queried.
+      };
+
+   /// @brief The selection of the best time from several NTP server replies (intersection algorithm).
+   /// @author Chris-70 (2026/10)
+   class NtpClockFilter
+      {
+   public:
+      NtpClockFilter() = default;
+
+      /// @brief Add a sample, ignored when the filter is full.
+      /// @return True if the sample was added.
+      bool Add(const NtpSample& sample);
+
+      /// @brief Remove all the samples.
+      void Clear() { count = 0; survivors = 0; }
+
+      /// @brief Select the time from the samples.
+      /// @details Finds the intersection shared by the most samples, at least a majority. Falsetickers
+      ///          (samples whose interval doesn't overlap the intersection) are discarded.
+      /// @param offsetUs Returns the weighted average offset of the survivors in µs.
+      /// @param best Returns the index (in `get_Sample()`) of the survivor with the smallest distance.
+      /// @return True if a majority of the samples agree, false if there is no sample or no majority.
+      /// @author Chris-70 (2026/10)
+      bool Select(int64_t& offsetUs, size_t& best);
+
+      /// @brief Calculate the root distance of a sample: the maximum error of its offset.
+      /// @param delayUs The round trip delay measured in µs.
+      /// @param rootDelayUs The server's root delay (to the reference clock) in µs.
+      /// @param rootDispersionUs The server's root dispersion in µs.
+      /// @return The root distance in µs, at least `NTP_MIN_DISPERSION_US`.
+      static int64_t RootDistance(int64_t delayUs, int64_t rootDelayUs, int64_t rootDispersionUs)
+         {
+         if (delayUs < 0) { delayUs = 0; }
+         return (rootDelayUs + delayUs) / 2 + rootDispersionUs + NTP_MIN_DISPERSION_US;
+         }
+
+      /// @brief Read only property: The number of samples.
+      size_t get_Count() const { return count; }
+
+      /// @brief Read only property: The sample at `index`.
+      const NtpSample& get_Sample(size_t index) const { return samples[index]; }
+
+      /// @brief Read only property: Bit `n` is set if sample `n` survived the last `Select()`.
+      uint16_t get_Survivors() const { return survivors; }
+
+   private:
+      NtpSample samples[NTP_MAX_SAMPLES];    ///< The samples added.
+      size_t count = 0;                      ///< The number of samples.
+      uint16_t survivors = 0;                ///< The truechimers of the last `Select()`.
+      }; // class NtpClockFilter
+   } // namespace BinaryClockShield
+
+#endif // __NTPCLOCKFILTER_H__
@@ -0,0 +1,111 @@
+/// @file NtpPollController.cpp
+/// @brief The implementation of the `NtpPollController` class, the adaptive NTP poll interval.
+/// @author Chris-70 (2026/10)
+
+#include "NtpPollController.h"
+
+#include <math.h>                      /// For sqrt() and fabs()
+
+namespace BinaryClockShield
+   {
+   uint32_t NtpPollController::Update(int64_t offsetUs, uint32_t elapsedS)
+      {
+      // Exponential averages, 1/4 weight for the new value (the ntpd clock filter uses 1/4 too).
+      // The jitter is the offset the drift doesn't predict, the offset grows with the interval.
+      if (hasLast)
+         {
+         double expected = (elapsedS > 0) ? drift * (double)elapsedS / 1000.0 : (double)lastOffset;
+         double difference = (double)offsetUs - expected;
+         jitter = sqrt((3.0 * jitter * jitter + difference * difference) / 4.0);
+         }
+      if (elapsedS > 0)
+         {
+         double measured = (double)offsetUs * 1000.0 / (double)elapsedS;   // µs/s * 1000 => ppb
+         drift = hasLast ? (3.0 * drift + measured) / 4.0 : measured;
+         }
+      lastOffset = offsetUs;
+      hasLast = true;
+
+      // The server answered at this rate, after a hold-off lower the floor one step at a time.
+      if ((rateFloor > NTP_MIN_POLL) && (++rateGood >= NTP_RATE_HOLD))
+         {
+         rateFloor--;
+         rateGood = 0;
+         }
+
+      int64_t magnitude = (offsetUs < 0) ? -offsetUs : offsetUs;
+      if ((magnitude <= tolerance) && (jitter <= tolerance))
+         {
+         count += poll;
+         if (count >= NTP_POLL_LIMIT)
+            {
+            count = 0;
+            poll++;
+            }
+         }
+      else
+         {
+         count -= 2 * poll;
+         if ((count <= -NTP_POLL_LIMIT) || (magnitude > 4 * (int64_t)tolerance))
+            {
+            count = 0;
+            poll--;
+            }
+         }
+
+      // The drift cap: the error expected at the next poll must stay within the tolerance.
+      // Only the drift the jitter can't explain counts, noise over a short interval isn't drift.
+      double driftMagnitude = fabs(drift);
+      if (elapsedS > 0) { driftMagnitude -= jitter * 1000.0 / (double)elapsedS; }
+      if (driftMagnitude > 0.0)
+         {
+         double maxInterval = (double)tolerance * 1000.0 / driftMagnitude;  // seconds
+         while ((poll > NTP_MIN_POLL) && ((double)(1UL << poll) > maxInterval))
+            { poll--; }
+         }
+
+      clamp();
+      return get_Interval();
+      }
+
+   uint32_t NtpPollController::RateLimit(int8_t serverPoll)
+      {
+      int8_t floor = poll + 1;
+      if (serverPoll > floor) { floor = serverPoll; }
+      if (floor > NTP_MAX_POLL) { floor = NTP_MAX_POLL; }
+      if (floor > rateFloor) { rateFloor = floor; }
+
+      rateGood = 0;
+      count = 0;
+      clamp();
+      return get_Interval();
+      }
+
+   uint32_t NtpPollController::Failed()
+      {
+      count = 0;
+      poll--;
+      clamp();
+      return get_Interval();
+      }
+
+   void NtpPollController::Reset()
+      {
+      poll = NTP_START_POLL;
+      rateFloor = NTP_MIN_POLL;
+      rateGood = 0;
+      count = 0;
+      jitter = 0.0;
+      drift = 0.0;
+      lastOffset = 0;
+      hasLast = false;
+      clamp();
+      }
+
+   void NtpPollController::clamp()
+      {
+      if (poll < rateFloor)    { poll = rateFloor; }
+      if (poll < NTP_MIN_POLL) { poll = NTP_MIN_POLL; }
+      if (poll > NTP_MAX_POLL) { poll = NTP_MAX_POLL; }
+      }
+   } // namespace BinaryClockShield
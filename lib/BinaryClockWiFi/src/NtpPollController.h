@@ -0,0 +1,115 @@
+/// @file NtpPollController.h
+/// @brief The header file for the `NtpPollController` class, the adaptive NTP poll interval.
+/// @details Like the ntpd poll exponent the interval is a power of 2 seconds (2^poll). After each
+///          sync the measured offset and jitter are compared with the tolerance:
+///          - in tolerance: a counter goes up by `poll`, when it reaches `NTP_POLL_LIMIT` the
+///            interval doubles;
+///          - out of tolerance: the counter goes down by `2 * poll`, at `-NTP_POLL_LIMIT` (or at
+///            once for a large offset) the interval halves.
+///          The drift (offset / elapsed time) caps the interval so the expected error at the
+///          next poll stays within the tolerance. A Kiss-o'-Death RATE reply sets a floor under
+///          the interval (at least double the current one and the server's poll value); the floor
+///          is lowered by one after each `NTP_RATE_HOLD` successful polls without another RATE.
+///          A quiet clock (e.g. the DS3231 with the system time corrected each sync) ends up
+///          polling every 18 - 36 hours, saving WiFi airtime and power.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host
+///          against synthetic drift traces.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __NTPPOLLCONTROLLER_H__
+#define __NTPPOLLCONTROLLER_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#ifndef NTP_MIN_POLL
+   #define NTP_MIN_POLL             6  ///< The minimum poll exponent, 2^6 = 64 seconds.
+#endif
+#ifndef NTP_MAX_POLL
+   #define NTP_MAX_POLL            17  ///< The maximum poll exponent, 2^17 s (~36 hours, SNTP max).
+#endif
+#ifndef NTP_START_POLL
+   #define NTP_START_POLL          10  ///< The starting poll exponent, 2^10 = 1024 seconds (~17 min).
+#endif
+#ifndef NTP_POLL_LIMIT
+   #define NTP_POLL_LIMIT          30  ///< The hysteresis counter limit to change the poll exponent.
+#endif
+#ifndef NTP_RATE_HOLD
+   #define NTP_RATE_HOLD            8  ///< The successful polls without a KoD RATE before the rate floor is lowered by one.
+#endif
+#ifndef NTP_OFFSET_TOLERANCE_US
+   #define NTP_OFFSET_TOLERANCE_US 50000L ///< The offset / jitter tolerance in µs (50 ms).
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The adaptive NTP poll interval controller.
+   /// @author Chris-70 (2026/10)
+   class NtpPollController
+      {
+   public:
+      /// @brief Constructor
+      /// @param toleranceUs The offset and jitter tolerance in µs. {NTP_OFFSET_TOLERANCE_US}
+      NtpPollController(int32_t toleranceUs = NTP_OFFSET_TOLERANCE_US)
+            : tolerance(toleranceUs)
+         { }
+
+      /// @brief Update the controller with the offset measured at a sync.
+      /// @details A successful sync also counts towards lowering a KoD RATE floor.
+      /// @param offsetUs The offset measured (server - local) in µs, the clock is then corrected.
+      /// @param elapsedS The time since the previous correction in seconds, `0` if unknown.
+      /// @return The next poll interval in seconds.
+      /// @author Chris-70 (2026/10)
+      uint32_t Update(int64_t offsetUs, uint32_t elapsedS);
+
+      /// @brief The server sent a Kiss-o'-Death RATE: poll less often.
+      /// @param serverPoll The poll exponent in the server's reply, its minimum interval.
+      /// @return The next poll interval in seconds.
+      /// @author Chris-70 (2026/10)
+      uint32_t RateLimit(int8_t serverPoll);
+
+      /// @brief The sync failed (no reply), retry sooner but not faster than any rate limit.
+      /// @return The next poll interval in seconds.
+      uint32_t Failed();
+
+      /// @brief Reset to the starting poll exponent, e.g. after a new network connection.
+      void Reset();
+
+      /// @brief Read only property: The poll exponent, the interval is 2^poll seconds.
+      int8_t get_Poll() const { return poll; }
+
+      /// @brief Read only property: The minimum poll exponent set by the KoD RATE replies.
+      int8_t get_RateFloor() const { return rateFloor; }
+
+      /// @brief Read only property: The poll interval in seconds.
+      uint32_t get_Interval() const { return (1UL << poll); }
+
+      /// @brief Read only property: The offset jitter (RMS of the offsets the drift doesn't predict) in µs.
+      int32_t get_Jitter() const { return (int32_t)jitter; }
+
+      /// @brief Read only property: The clock drift in ppb (ns/s), +ve the local clock is slow.
+      int32_t get_DriftPpb() const { return (int32_t)drift; }
+
+      /// @brief Property: Tolerance - The offset and jitter tolerance in µs.
+      void set_Tolerance(int32_t value) { tolerance = (value > 0 ? value : 1); }
+      /// @copydoc set_Tolerance()
+      int32_t get_Tolerance() const { return tolerance; }
+
+   protected:
+      /// @brief Limit the poll exponent to the minimum, rate limit and maximum.
+      void clamp();
+
+   private:
+      int8_t  poll      = NTP_START_POLL;    ///< The poll exponent.
+      int8_t  rateFloor = NTP_MIN_POLL;      ///< The minimum poll exponent from KoD RATE replies.
+      int16_t count     = 0;                 ///< The hysteresis counter.
+      uint8_t rateGood  = 0;                 ///< The successful polls since the last KoD RATE or floor change.
+      int32_t tolerance;                     ///< The offset and jitter tolerance in µs.
+      double  jitter    = 0.0;               ///< The smoothed RMS of the unpredicted offsets in µs.
+      double  drift     = 0.0;               ///< The smoothed drift in ppb.
+      int64_t lastOffset = 0;                ///< The previous offset in µs.
+      bool    hasLast   = false;             ///< Flag: `lastOffset` is valid.
+      }; // class NtpPollController
+   } // namespace BinaryClockShield
+
+#endif // __NTPPOLLCONTROLLER_H__
@@ -0,0 +1,124 @@
+/// @file NtpResponder.cpp
+/// @brief The implementation of the `NtpResponder` class, the server side of NTP: the reply to a client request.
+/// @author Chris-70 (2026/10)
+
+#include "NtpResponder.h"
+#include "NtpPollController.h"         /// For NTP_MIN_POLL and NTP_MAX_POLL, the poll exponent range.
+
+#include <string.h>                    /// For memcpy() and memset()
+
+#define NTP_UNIX_DELTA_S   2208988800ULL  ///< The seconds from 1900-01-01 (NTP) to 1970-01-01 (Unix).
+#define NTP_REFID_RATE     0x52415445UL   ///< "RATE" - the Kiss-o'-Death code to poll less often.
+
+namespace BinaryClockShield
+   {
+   NtpResponse NtpResponder::Respond(const uint8_t* request, size_t length, uint32_t client, int64_t receiveUs, int64_t transmitUs, uint8_t* reply)
+      {
+      // A client request: mode 3, version 1 - 4; anything else (e.g. a server or broadcast packet) is ignored.
+      uint8_t mode = (length >= NTP_REPLY_SIZE) ? (request[0] & 0x07) : 0;
+      uint8_t version = (request[0] >> 3) & 0x07;
+      NtpResponse response = NtpResponse::Invalid;
+      if ((mode == 3) && (version >= 1) && (version <= 4))
+         {
+         int64_t ageUs = receiveUs - reference.refTimeUs;
+         bool synced = (reference.stratum != 0) && (ageUs >= 0) && (ageUs < (int64_t)NTP_SERVER_MAX_AGE_S * 1000000LL);
+         response = synced ? admit(client, receiveUs) : NtpResponse::Unsynced;
+         }
+
+      counts[(uint8_t)response]++;
+      if ((response != NtpResponse::Reply) && (response != NtpResponse::Kiss))
+         { return response; }
+
+      int8_t poll = (int8_t)request[2];
+      poll = (poll < NTP_MIN_POLL) ? NTP_MIN_POLL : ((poll > NTP_MAX_POLL) ? NTP_MAX_POLL : poll);
+
+      memset(reply, 0, NTP_REPLY_SIZE);
+      memcpy(reply + 24, request + 40, 8);          // Originate = the client's transmit time.
+      PutTimestamp(receiveUs, reply + 32);
+      PutTimestamp(transmitUs, reply + 40);
+      reply[2] = (uint8_t)poll;
+      reply[3] = (uint8_t)(int8_t)NTP_SERVER_PRECISION;
+
+      if (response == NtpResponse::Kiss)
+         {
+         reply[0] = (uint8_t)((3 << 6) | (version << 3) | 4);   // LI = 3, stratum 0: a KoD.
+         put32(reply + 12, NTP_REFID_RATE);
+         return response;
+         }
+
+      // The dispersion grows by PHI since the reference time; the 16.16 seconds fields saturate.
+      uint64_t dispersionUs = reference.rootDispersionUs + (uint64_t)(receiveUs - reference.refTimeUs) * NTP_PHI_PPM / 1000000ULL;
+      uint64_t rootDelay = ((uint64_t)reference.rootDelayUs << 16) / 1000000ULL;
+      uint64_t rootDispersion = (dispersionUs << 16) / 1000000ULL;
+
+      reply[0] = (uint8_t)(((reference.leap & 0x03) << 6) | (version << 3) | 4);
+      reply[1] = reference.stratum;
+      put32(reply + 4, (rootDelay > UINT32_MAX) ? UINT32_MAX : (uint32_t)rootDelay);
+      put32(reply + 8, (rootDispersion > UINT32_MAX) ? UINT32_MAX : (uint32_t)rootDispersion);
+      memcpy(reply + 12, &reference.refId, 4);     // Already in network order.
+      PutTimestamp(reference.refTimeUs, reply + 16);
+      return response;
+      }
+
+   void NtpResponder::PutTimestamp(int64_t micros, uint8_t* out)
+      {
+      uint64_t seconds = (uint64_t)(micros / 1000000LL) + NTP_UNIX_DELTA_S;
+      uint64_t fraction = ((uint64_t)(micros % 1000000LL) << 32) / 1000000ULL;
+      put32(out, (uint32_t)seconds);            // Wraps in 2036 (NTP era 1), like the clients expect.
+      put32(out + 4, (uint32_t)fraction);
+      }
+
+   NtpResponse NtpResponder::admit(uint32_t client, int64_t nowUs)
+      {
+      if ((nowUs - windowUs) >= 1000000LL)
+         {
+         windowUs = nowUs;
+         windowCount = 0;
+         }
+      if (windowCount >= NTP_SERVER_MAX_RATE)
+         { return NtpResponse::Limited; }
+
+      // Leaky bucket: it drains in real time, each request adds the interval; over the burst is over the rate.
+      Client& entry = clients[clientIndex(client)];
+      int64_t elapsedUs = nowUs - entry.lastUs;
+      entry.scoreUs = ((elapsedUs >= 0) && ((uint64_t)elapsedUs < entry.scoreUs)) ? entry.scoreUs - (uint32_t)elapsedUs : 0;
+      entry.lastUs = nowUs;
+
+      const uint32_t intervalUs = NTP_SERVER_INTERVAL_MS * 1000UL;
+      if ((entry.scoreUs + intervalUs) > (NTP_SERVER_BURST * intervalUs))
+         {
+         if (entry.kissed) { return NtpResponse::Limited; }
+         entry.kissed = true;
+         windowCount++;
+         return NtpResponse::Kiss;
+         }
+
+      entry.scoreUs += intervalUs;
+      entry.kissed = false;
+      windowCount++;
+      return NtpResponse::Reply;
+      }
+
+   size_t NtpResponder::clientIndex(uint32_t client)
+      {
+      size_t oldest = 0;
+      for (size_t i = 0; i < NTP_SERVER_CLIENTS; i++)
+         {
+         if (clients[i].address == client) { return i; }
+         if ((clients[i].address == 0) || ((clients[oldest].address != 0) && (clients[i].lastUs < clients[oldest].lastUs)))
+            { oldest = i; }
+         }
+
+      clients[oldest] = Client();
+      clients[oldest].address = client;
+      return oldest;
+      }
+
+   void NtpResponder::put32(uint8_t* out, uint32_t value)
+      {
+      out[0] = (uint8_t)(value >> 24);
+      out[1] = (uint8_t)(value >> 16);
+      out[2] = (uint8_t)(value >> 8);
+      out[3] = (uint8_t)value;
+      }
+   } // namespace BinaryClockShield
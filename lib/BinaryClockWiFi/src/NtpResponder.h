@@ -0,0 +1,133 @@
+/// @file NtpResponder.h
+/// @brief The header file for the `NtpResponder` class, the server side of NTP: the reply to a client request.
+/// @details A designated clock answers the NTP requests of the other clocks on the LAN (`BinaryClockNtpServer`):
+///          - the reply is a mode 4 (server) packet with the version of the request, the originate
+///            time copied from the request's transmit time, the receive and transmit times;
+///          - the stratum, reference ID, reference time, root delay and root dispersion come from the
+///            reference (`set_Reference()`): the upstream server's plus this clock's own, the root
+///            dispersion grows by `NTP_PHI_PPM` per second since the reference time (RFC 5905);
+///          - without a reference, or one older than `NTP_SERVER_MAX_AGE_S`, nothing is sent: the
+///            clients time out and try another server sooner than after an unsynchronized reply;
+///          - each client (IPv4 address) has a leaky bucket: `NTP_SERVER_BURST` requests back to back,
+///            then one per `NTP_SERVER_INTERVAL_MS`; the first request over the limit gets a
+///            Kiss-o'-Death RATE reply, the others are dropped. At most `NTP_SERVER_MAX_RATE` replies
+///            a second are sent in all, a flood can't take the CPU from the display.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host, the
+///          packets are raw 48 byte buffers in network order and the times are µs since 1970-01-01 (UTC).
+///          `test/host/test_ntp_responder.cpp` runs it on virtual time, `test/host/test_ntp_loopback.cpp`
+///          serves a UDP socket on 127.0.0.1 as `BinaryClockNtpServer` does.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __NTPRESPONDER_H__
+#define __NTPRESPONDER_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef NTP_SERVER_BURST
+   #define NTP_SERVER_BURST           8U   ///< The requests a client may send back to back (e.g. an iburst).
+#endif
+#ifndef NTP_SERVER_INTERVAL_MS
+   #define NTP_SERVER_INTERVAL_MS  2000U   ///< The sustained request interval (ms) allowed per client.
+#endif
+#ifndef NTP_SERVER_CLIENTS
+   #define NTP_SERVER_CLIENTS        32U   ///< The clients tracked for the rate limit, the oldest is replaced.
+#endif
+#ifndef NTP_SERVER_MAX_RATE
+   #define NTP_SERVER_MAX_RATE       50U   ///< The maximum replies per second, to all the clients.
+#endif
+#ifndef NTP_SERVER_MAX_AGE_S
+   #define NTP_SERVER_MAX_AGE_S  172800U   ///< The oldest reference (s) served, 2 days (~2.6 s of dispersion).
+#endif
+#ifndef NTP_SERVER_PRECISION
+   #define NTP_SERVER_PRECISION     -20    ///< The precision of the system clock, log2 seconds (1 µs).
+#endif
+
+#define NTP_PHI_PPM                  15    ///< The dispersion growth of an undisciplined clock (RFC 5905 PHI), ppm.
+#define NTP_REPLY_SIZE               48U   ///< The size of a NTP packet without extensions.
+
+namespace BinaryClockShield
+   {
+   /// @brief The reference the replies are made from: the upstream sync, or the local RTC.
+   struct NtpReference
+      {
+      uint8_t  stratum       = 0;      ///< The stratum served (upstream + 1), 0 = no reference, nothing is served.
+      uint8_t  leap          = 0;      ///< The leap indicator served (0 - 2).
+      uint32_t refId         = 0;      ///< The reference ID (network order): the upstream IPv4 address, or ASCII e.g. "LOCL".
+      int64_t  refTimeUs     = 0;      ///< The time of the last sync, µs since 1970-01-01 (UTC).
+      uint32_t rootDelayUs   = 0;      ///< The round trip delay to the primary reference, µs.
+      uint32_t rootDispersionUs = 0;   ///< The maximum error to the primary reference at `refTimeUs`, µs.
+      };
+
+   /// @brief What `Respond()` did with a request.
+   enum class NtpResponse : uint8_t
+      {
+      Reply = 0,                       ///< A server reply.
+      Kiss,                            ///< A Kiss-o'-Death RATE reply, the client is over its rate.
+      Limited,                         ///< Dropped: the client is still over its rate, or the total rate is over.
+      Unsynced,                        ///< Dropped: there is no reference or it's too old.
+      Invalid                          ///< Dropped: not a NTP client request.
+      };
+
+   /// @brief The server side of NTP: the reply to a client request, with the rate limits.
+   /// @author Chris-70 (2026/10)
+   class NtpResponder
+      {
+   public:
+      NtpResponder() = default;
+
+      /// @brief Make the reply to a request.
+      /// @param request The request received.
+      /// @param length The length of the request.
+      /// @param client The client's IPv4 address, for the rate limit.
+      /// @param receiveUs The time the request was received, µs since 1970-01-01 (UTC).
+      /// @param transmitUs The time the reply is sent, µs since 1970-01-01 (UTC).
+      /// @param reply Returns the reply, `NTP_REPLY_SIZE` bytes, for `Reply` and `Kiss`.
+      /// @return What was done with the request, the reply is sent for `Reply` and `Kiss`.
+      /// @author Chris-70 (2026/10)
+      NtpResponse Respond(const uint8_t* request, size_t length, uint32_t client, int64_t receiveUs, int64_t transmitUs, uint8_t* reply);
+
+      /// @brief Property: Reference - The reference the replies are made from, e.g. after each upstream sync.
+      void set_Reference(const NtpReference& value) { reference = value; }
+      /// @copydoc set_Reference()
+      const NtpReference& get_Reference() const { return reference; }
+
+      /// @brief Get the count of the requests by response, e.g. `GetCount(NtpResponse::Reply)`.
+      uint32_t GetCount(NtpResponse response) const { return counts[(uint8_t)response]; }
+
+      /// @brief Convert µs since 1970-01-01 to a NTP timestamp (seconds since 1900, 32.32) in network order.
+      /// @param micros The time in µs since 1970-01-01 (UTC).
+      /// @param out Returns the 8 bytes of the timestamp.
+      static void PutTimestamp(int64_t micros, uint8_t* out);
+
+   protected:
+      /// @brief Check the client's leaky bucket and the total rate.
+      /// @return `Reply`, `Kiss` or `Limited`.
+      NtpResponse admit(uint32_t client, int64_t nowUs);
+
+      /// @brief Get the rate limit entry of a client, the oldest entry is replaced for a new client.
+      size_t clientIndex(uint32_t client);
+
+      /// @brief Put a 32 bit value in network order.
+      static void put32(uint8_t* out, uint32_t value);
+
+   private:
+      /// @brief The rate limit of a client.
+      struct Client
+         {
+         uint32_t address = 0;         ///< The IPv4 address, 0 if the entry is free.
+         uint32_t scoreUs = 0;         ///< The leaky bucket level in µs, each request adds `NTP_SERVER_INTERVAL_MS`.
+         int64_t  lastUs  = 0;         ///< The time of the last request.
+         bool     kissed  = false;     ///< Flag: sent a KoD since the client was last admitted.
+         };
+
+      NtpReference reference;                      ///< The reference the replies are made from.
+      Client   clients[NTP_SERVER_CLIENTS];        ///< The clients' rate limits.
+      int64_t  windowUs = 0;                       ///< The start of the current second of the total rate.
+      uint32_t windowCount = 0;                    ///< The replies in the current second.
+      uint32_t counts[(uint8_t)NtpResponse::Invalid + 1] = { 0 };   ///< The requests by response.
+      }; // class NtpResponder
+   } // namespace BinaryClockShield
+
+#endif // __NTPRESPONDER_H__
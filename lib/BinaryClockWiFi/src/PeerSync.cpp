@@ -0,0 +1,237 @@
+/// @file PeerSync.cpp
+/// @brief The implementation of the `PeerSync` class, the peer to peer time sync of the clocks on a LAN.
+/// @author Chris-70 (2026/10)
+
+#include "PeerSync.h"
+
+#include <string.h>                    /// For memcpy(), memcmp() and memset()
+
+#define PEER_SYNC_MAGIC_0   'B'        ///< The first byte of a message.
+#define PEER_SYNC_MAGIC_1   'C'        ///< The second byte of a message.
+
+namespace BinaryClockShield
+   {
+   void PeerSync::Start(const uint8_t* value)
+      {
+      memcpy(mac, value, sizeof(mac));
+      memcpy(leaderMac, value, sizeof(leaderMac));
+      for (PeerInfo& peer : peers) { peer = PeerInfo(); }
+      pendingUs = 0;
+      count = 0;
+      next = 0;
+      samples = 0;
+      }
+
+   void PeerSync::SetSynced(uint8_t stratum, uint32_t nowMs)
+      {
+      synced = true;
+      syncStratum = (stratum == 0) ? 1 : ((stratum < PEER_SYNC_LOCAL_STRATUM) ? stratum : PEER_SYNC_LOCAL_STRATUM);
+      syncMs = nowMs;
+      }
+
+   size_t PeerSync::MakeBeacon(uint32_t nowMs, int64_t nowUs, uint8_t* out)
+      {
+      put(out, PeerMessage::Beacon, GetStratum(nowMs), 0, 0, nowUs);
+      return PEER_SYNC_SIZE;
+      }
+
+   size_t PeerSync::MakeRequest(uint32_t nowMs, int64_t nowUs, uint8_t* out)
+      {
+      if (elect(nowMs) == PEER_SYNC_PEERS) { return 0; }
+
+      // A lost response is replaced by the next request, only the last one is matched.
+      pendingUs = nowUs;
+      put(out, PeerMessage::Request, GetStratum(nowMs), nowUs, 0, 0);
+      return PEER_SYNC_SIZE;
+      }
+
+   PeerMessage PeerSync::Receive(const uint8_t* in, size_t length, uint32_t address, uint16_t port, uint32_t nowMs,
+                                 int64_t receiveUs, int64_t transmitUs, uint8_t* reply)
+      {
+      if ((length < PEER_SYNC_SIZE) || (in[0] != PEER_SYNC_MAGIC_0) || (in[1] != PEER_SYNC_MAGIC_1) || (in[2] != PEER_SYNC_VERSION))
+         { return PeerMessage::None; }
+      PeerMessage type = (PeerMessage)in[3];
+      if ((type < PeerMessage::Beacon) || (type > PeerMessage::Response) || (memcmp(in + 6, mac, sizeof(mac)) == 0))
+         { return PeerMessage::None; }   // A broadcast comes back to its sender.
+
+      // Every message has the sender's stratum, each one refreshes the peer.
+      size_t index = peerIndex(in + 6, nowMs);
+      PeerInfo& peer = peers[index];
+      peer.address = address;
+      peer.port = port;
+      peer.stratum = (in[4] == 0) ? PEER_SYNC_LOCAL_STRATUM : in[4];
+      peer.lastMs = nowMs;
+
+      switch (type)
+         {
+         case PeerMessage::Request:
+            // Any clock answers, a follower that is still electing may ask the wrong one.
+            put(reply, PeerMessage::Response, GetStratum(nowMs), get64(in + 12), receiveUs, transmitUs);
+            break;
+
+         case PeerMessage::Response:
+            {
+            int64_t t1 = get64(in + 12);
+            if ((pendingUs == 0) || (t1 != pendingUs) || (elect(nowMs) != index))
+               { return PeerMessage::None; }   // Late, duplicated or from a clock that isn't the leader.
+
+            int64_t t2 = get64(in + 20);
+            int64_t t3 = get64(in + 28);
+            int64_t t4 = receiveUs;
+            pendingUs = 0;
+
+            Sample& sample = window[next];
+            sample.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+            sample.delayUs = (t4 - t1) - (t3 - t2);
+            sample.delayUs = (sample.delayUs < 0) ? 0 : sample.delayUs;
+            next = (next + 1) % PEER_SYNC_SAMPLES;
+            count = (count < PEER_SYNC_SAMPLES) ? count + 1 : count;
+            lastDelayUs = sample.delayUs;
+            samples++;
+            }
+            break;
+
+         default:
+            elect(nowMs);
+            break;
+         }
+
+      return type;
+      }
+
+   PeerCorrection PeerSync::Correct(int64_t& offsetUs)
+      {
+      offsetUs = 0;
+      if (count == 0) { return PeerCorrection::None; }
+
+      // The smallest delay has the least asymmetry, e.g. a reply that waited in a queue.
+      size_t best = 0;
+      for (size_t i = 1; i < count; i++)
+         {
+         if (window[i].delayUs < window[best].delayUs) { best = i; }
+         }
+
+      int64_t offset = window[best].offsetUs;
+      int64_t magnitude = (offset < 0) ? -offset : offset;
+      if (magnitude > (int64_t)PEER_SYNC_STEP_MS * 1000LL)
+         {
+         count = 0;
+         next = 0;
+         offsetUs = offset;
+         return PeerCorrection::Step;
+         }
+      if (magnitude > (int64_t)PEER_SYNC_DEADBAND_US)
+         {
+         for (size_t i = 0; i < count; i++) { window[i].offsetUs -= offset; }
+         offsetUs = offset;
+         return PeerCorrection::Slew;
+         }
+
+      return PeerCorrection::None;
+      }
+
+   const PeerInfo* PeerSync::GetLeader(uint32_t nowMs)
+      {
+      size_t index = elect(nowMs);
+      return (index < PEER_SYNC_PEERS) ? &peers[index] : nullptr;
+      }
+
+   uint8_t PeerSync::GetStratum(uint32_t nowMs)
+      {
+      if (synced && ((uint32_t)(nowMs - syncMs) >= PEER_SYNC_STRATUM_AGE_S * 1000UL))
+         { synced = false; }   // Cleared before `millis()` wraps back to the sync time.
+
+      return synced ? syncStratum : PEER_SYNC_LOCAL_STRATUM;
+      }
+
+   size_t PeerSync::GetPeerCount(uint32_t nowMs) const
+      {
+      size_t result = 0;
+      for (const PeerInfo& peer : peers)
+         {
+         if ((peer.stratum != 0) && ((uint32_t)(nowMs - peer.lastMs) < PEER_SYNC_TIMEOUT_MS)) { result++; }
+         }
+
+      return result;
+      }
+
+   size_t PeerSync::elect(uint32_t nowMs)
+      {
+      size_t best = PEER_SYNC_PEERS;
+      uint8_t bestStratum = GetStratum(nowMs);
+      const uint8_t* bestMac = mac;
+      for (size_t i = 0; i < PEER_SYNC_PEERS; i++)
+         {
+         const PeerInfo& peer = peers[i];
+         if ((peer.stratum != 0) && ((uint32_t)(nowMs - peer.lastMs) < PEER_SYNC_TIMEOUT_MS)
+               && better(peer.stratum, peer.mac, bestStratum, bestMac))
+            {
+            best = i;
+            bestStratum = peer.stratum;
+            bestMac = peer.mac;
+            }
+         }
+
+      // The samples and the pending request were with the last leader.
+      if (memcmp(bestMac, leaderMac, sizeof(leaderMac)) != 0)
+         {
+         memcpy(leaderMac, bestMac, sizeof(leaderMac));
+         pendingUs = 0;
+         count = 0;
+         next = 0;
+         samples = 0;
+         }
+
+      return best;
+      }
+
+   size_t PeerSync::peerIndex(const uint8_t* value, uint32_t nowMs)
+      {
+      size_t oldest = 0;
+      for (size_t i = 0; i < PEER_SYNC_PEERS; i++)
+         {
+         if ((peers[i].stratum != 0) && (memcmp(peers[i].mac, value, sizeof(mac)) == 0)) { return i; }
+         if ((peers[oldest].stratum != 0) && ((peers[i].stratum == 0) || ((uint32_t)(nowMs - peers[i].lastMs) > (uint32_t)(nowMs - peers[oldest].lastMs))))
+            { oldest = i; }
+         }
+
+      peers[oldest] = PeerInfo();
+      memcpy(peers[oldest].mac, value, sizeof(mac));
+      return oldest;
+      }
+
+   void PeerSync::put(uint8_t* out, PeerMessage type, uint8_t stratum, int64_t t1, int64_t t2, int64_t t3) const
+      {
+      out[0] = PEER_SYNC_MAGIC_0;
+      out[1] = PEER_SYNC_MAGIC_1;
+      out[2] = PEER_SYNC_VERSION;
+      out[3] = (uint8_t)type;
+      out[4] = stratum;
+      out[5] = 0;    // Reserved.
+      memcpy(out + 6, mac, sizeof(mac));
+      put64(out + 12, t1);
+      put64(out + 20, t2);
+      put64(out + 28, t3);
+      }
+
+   bool PeerSync::better(uint8_t stratumA, const uint8_t* macA, uint8_t stratumB, const uint8_t* macB)
+      {
+      return (stratumA < stratumB) || ((stratumA == stratumB) && (memcmp(macA, macB, 6) < 0));
+      }
+
+   void PeerSync::put64(uint8_t* out, int64_t value)
+      {
+      for (int i = 7; i >= 0; i--)
+         {
+         out[i] = (uint8_t)value;
+         value = (int64_t)((uint64_t)value >> 8);
+         }
+      }
+
+   int64_t PeerSync::get64(const uint8_t* in)
+      {
+      uint64_t value = 0;
+      for (int i = 0; i < 8; i++) { value = (value << 8) | in[i]; }
+      return (int64_t)value;
+      }
+   } // namespace BinaryClockShield
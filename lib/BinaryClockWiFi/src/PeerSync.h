@@ -0,0 +1,207 @@
+/// @file PeerSync.h
+/// @brief The header file for the `PeerSync` class, the peer to peer time sync of the clocks on a LAN.
+/// @details Clocks in the same room drift apart, the peers agree on a leader and the others follow
+///          its time, no internet access is needed:
+///          - each clock broadcasts a beacon every `PEER_SYNC_BEACON_MS` with its stratum and MAC;
+///          - the leader is the clock with the lowest stratum, then the lowest MAC, of the peers heard
+///            within `PEER_SYNC_TIMEOUT_MS` and this clock. A clock synced upstream (`SetSynced()`)
+///            has the upstream stratum, the others `PEER_SYNC_LOCAL_STRATUM`. The stratum isn't
+///            inherited from the leader: every clock ranks the same (stratum, MAC) keys and elects
+///            the same leader, two followers never elect each other when the leader goes quiet;
+///          - a follower sends a request to the leader every `PEER_SYNC_POLL_MS`, the response has
+///            the leader's receive and transmit times, the offset and delay are computed as in NTP;
+///          - `Correct()` takes the sample with the smallest delay of the last `PEER_SYNC_SAMPLES`:
+///            an offset over `PEER_SYNC_STEP_MS` is stepped, over `PEER_SYNC_DEADBAND_US` slewed.
+///          When the leader goes quiet the next one is elected, its followers start over.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host,
+///          `test/host/test_peer_sync.cpp` runs peers in memory on virtual time,
+///          `test/host/test_peer_sync_loopback.cpp` runs them on UDP sockets on the loopback interface,
+///          `test/peer_sync_sim.py` runs stand-in peers with the same protocol.
+///          The messages are raw `PEER_SYNC_SIZE` byte buffers in network order, the times
+///          (µs since 1970-01-01) are the system clock, the timeouts are `millis()` values.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __PEERSYNC_H__
+#define __PEERSYNC_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+
+#ifndef PEER_SYNC_PORT
+   #define PEER_SYNC_PORT          12123U   ///< The UDP port of the beacons and the exchanges.
+#endif
+#ifndef PEER_SYNC_BEACON_MS
+   #define PEER_SYNC_BEACON_MS      2000U   ///< The time (ms) between the beacons.
+#endif
+#ifndef PEER_SYNC_POLL_MS
+   #define PEER_SYNC_POLL_MS        4000U   ///< The time (ms) between a follower's requests to the leader.
+#endif
+#ifndef PEER_SYNC_TIMEOUT_MS
+   #define PEER_SYNC_TIMEOUT_MS     7000U   ///< A peer not heard from this long (ms) is gone, ~3 beacons.
+#endif
+#ifndef PEER_SYNC_PEERS
+   #define PEER_SYNC_PEERS            16U   ///< The peers tracked, the oldest is replaced.
+#endif
+#ifndef PEER_SYNC_SAMPLES
+   #define PEER_SYNC_SAMPLES           4U   ///< The samples the one with the smallest delay is taken from.
+#endif
+#ifndef PEER_SYNC_STEP_MS
+   #define PEER_SYNC_STEP_MS          50    ///< A larger offset (ms) is stepped, a smaller one is slewed.
+#endif
+#ifndef PEER_SYNC_DEADBAND_US
+   #define PEER_SYNC_DEADBAND_US     500    ///< A smaller offset (µs) is left alone.
+#endif
+#ifndef PEER_SYNC_LOCAL_STRATUM
+   #define PEER_SYNC_LOCAL_STRATUM    15U   ///< The stratum of a clock that isn't synced upstream.
+#endif
+#ifndef PEER_SYNC_STRATUM_AGE_S
+   #define PEER_SYNC_STRATUM_AGE_S 172800U  ///< The upstream stratum is kept this long (s) after the last sync, 2 days.
+#endif
+
+#define PEER_SYNC_SIZE               36U    ///< The size of a message.
+#define PEER_SYNC_VERSION             1U    ///< The protocol version.
+
+namespace BinaryClockShield
+   {
+   /// @brief The message types, also what `Receive()` did with a message.
+   enum class PeerMessage : uint8_t
+      {
+      None = 0,                        ///< Not a peer message, this clock's own, or a response that doesn't match.
+      Beacon,                          ///< A beacon: stratum and MAC, the transmit time.
+      Request,                         ///< A follower's request, `Receive()` made the response.
+      Response                         ///< The leader's response, `Receive()` added a sample.
+      };
+
+   /// @brief What `Correct()` found to do with the system clock.
+   enum class PeerCorrection : uint8_t
+      {
+      None = 0,                        ///< Nothing: no sample, within the deadband, or this clock is the leader.
+      Slew,                            ///< Slew the system clock by the offset (`adjtime()`).
+      Step                             ///< Step the system clock by the offset (`settimeofday()`).
+      };
+
+   /// @brief A peer heard from.
+   struct PeerInfo
+      {
+      uint8_t  mac[6]   = { 0 };       ///< The MAC, the tie breaker of the election.
+      uint32_t address  = 0;           ///< The IPv4 address (network order) the requests are sent to.
+      uint16_t port     = 0;           ///< The UDP port the requests are sent to.
+      uint8_t  stratum  = 0;           ///< The stratum advertised, 0 if the entry is free.
+      uint32_t lastMs   = 0;           ///< The time (`millis()`) of the last message.
+      };
+
+   /// @brief The peer to peer time sync: beacons, leader election and the follower's exchanges.
+   /// @author Chris-70 (2026/10)
+   class PeerSync
+      {
+   public:
+      PeerSync() = default;
+
+      /// @brief Start over: no peer, no sample.
+      /// @param value This clock's MAC.
+      void Start(const uint8_t* value);
+
+      /// @brief This clock was synced upstream, e.g. NTP: it advertises the stratum for `PEER_SYNC_STRATUM_AGE_S`.
+      /// @param stratum The stratum, the upstream server's + 1.
+      /// @param nowMs The time, `millis()`.
+      void SetSynced(uint8_t stratum, uint32_t nowMs);
+
+      /// @brief Make the beacon to broadcast.
+      /// @param nowMs The time, `millis()`.
+      /// @param nowUs The system time, µs since 1970-01-01.
+      /// @param out Returns the message, `PEER_SYNC_SIZE` bytes.
+      /// @return The size of the message.
+      size_t MakeBeacon(uint32_t nowMs, int64_t nowUs, uint8_t* out);
+
+      /// @brief Make a follower's request to the leader, see `GetLeader()` for the address.
+      /// @param nowMs The time, `millis()`.
+      /// @param nowUs The system time, µs since 1970-01-01.
+      /// @param out Returns the message, `PEER_SYNC_SIZE` bytes.
+      /// @return The size of the message, 0 if this clock is the leader.
+      /// @author Chris-70 (2026/10)
+      size_t MakeRequest(uint32_t nowMs, int64_t nowUs, uint8_t* out);
+
+      /// @brief Handle a message received.
+      /// @param in The message.
+      /// @param length The length of the message.
+      /// @param address The sender's IPv4 address (network order).
+      /// @param port The sender's UDP port.
+      /// @param nowMs The time, `millis()`.
+      /// @param receiveUs The system time the message was received.
+      /// @param transmitUs The system time the response is sent.
+      /// @param reply Returns the response to send back to a `Request`, `PEER_SYNC_SIZE` bytes.
+      /// @return The message type handled, `None` if it was ignored.
+      /// @author Chris-70 (2026/10)
+      PeerMessage Receive(const uint8_t* in, size_t length, uint32_t address, uint16_t port, uint32_t nowMs,
+                          int64_t receiveUs, int64_t transmitUs, uint8_t* reply);
+
+      /// @brief Check the samples for a correction of the system clock, the caller makes it.
+      /// @details The sample with the smallest delay is the best. After a step the samples are
+      ///          discarded, after a slew the offset is taken off the samples kept.
+      /// @param offsetUs Returns the offset to correct, leader - this clock, µs.
+      /// @return The correction to make.
+      /// @author Chris-70 (2026/10)
+      PeerCorrection Correct(int64_t& offsetUs);
+
+      /// @brief Get the leader, `nullptr` if it's this clock.
+      /// @param nowMs The time, `millis()`.
+      const PeerInfo* GetLeader(uint32_t nowMs);
+
+      /// @brief Get the stratum advertised: the upstream stratum while fresh, else `PEER_SYNC_LOCAL_STRATUM`.
+      /// @param nowMs The time, `millis()`.
+      uint8_t GetStratum(uint32_t nowMs);
+
+      /// @brief Get the number of peers heard within `PEER_SYNC_TIMEOUT_MS`.
+      /// @param nowMs The time, `millis()`.
+      size_t GetPeerCount(uint32_t nowMs) const;
+
+      /// @brief Read only property: The number of samples since the leader was elected.
+      uint32_t get_Samples() const { return samples; }
+
+      /// @brief Read only property: The delay (µs) of the last sample.
+      int64_t get_LastDelayUs() const { return lastDelayUs; }
+
+   protected:
+      /// @brief Elect the leader, a new leader discards the samples and the pending request.
+      /// @return The index of the leader in `peers`, `PEER_SYNC_PEERS` if it's this clock.
+      size_t elect(uint32_t nowMs);
+
+      /// @brief Get the entry of a peer, the oldest entry is replaced for a new peer.
+      size_t peerIndex(const uint8_t* mac, uint32_t nowMs);
+
+      /// @brief Write the header and the three times of a message.
+      void put(uint8_t* out, PeerMessage type, uint8_t stratum, int64_t t1, int64_t t2, int64_t t3) const;
+
+      /// @brief Compare two (stratum, MAC) keys, true if `a` wins the election over `b`.
+      static bool better(uint8_t stratumA, const uint8_t* macA, uint8_t stratumB, const uint8_t* macB);
+
+      /// @brief Put / get a 64 bit value in network order.
+      static void put64(uint8_t* out, int64_t value);
+      /// @copydoc put64()
+      static int64_t get64(const uint8_t* in);
+
+   private:
+      /// @brief A follower's exchange with the leader.
+      struct Sample
+         {
+         int64_t offsetUs;             ///< The offset, leader - this clock, µs.
+         int64_t delayUs;              ///< The round trip delay, µs.
+         };
+
+      uint8_t  mac[6]      = { 0 };                ///< This clock's MAC.
+      PeerInfo peers[PEER_SYNC_PEERS];             ///< The peers heard from.
+      uint8_t  leaderMac[6] = { 0 };               ///< The MAC of the leader, a new one starts over.
+      bool     synced      = false;                ///< Flag: synced upstream within `PEER_SYNC_STRATUM_AGE_S`.
+      uint8_t  syncStratum = PEER_SYNC_LOCAL_STRATUM;   ///< The upstream stratum.
+      uint32_t syncMs      = 0;                    ///< The time (`millis()`) of the upstream sync.
+      int64_t  pendingUs   = 0;                    ///< The transmit time of the request waiting for its response, 0 if none.
+      Sample   window[PEER_SYNC_SAMPLES] = { };    ///< The last samples.
+      size_t   count       = 0;                    ///< The samples in `window`.
+      size_t   next        = 0;                    ///< The next entry of `window`.
+      uint32_t samples     = 0;                    ///< The samples since the leader was elected.
+      int64_t  lastDelayUs = 0;                    ///< The delay of the last sample.
+      }; // class PeerSync
+   } // namespace BinaryClockShield
+
+#endif // __PEERSYNC_H__
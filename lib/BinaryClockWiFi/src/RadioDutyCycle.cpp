@@ -0,0 +1,113 @@
+/// @file RadioDutyCycle.cpp
+/// @brief The implementation of the `RadioDutyCycle` class, the WiFi radio schedule around the NTP syncs.
+/// @author Chris-70 (2026/10)
+
+#include "RadioDutyCycle.h"
+
+#define DAY_MS    86400000ULL          ///< The milliseconds in a day.
+
+namespace BinaryClockShield
+   {
+   void RadioDutyCycle::Start(uint32_t nowMs)
+      {
+      state = RadioState::On;
+      lastMs = nowMs;
+      wakeMs = nowMs;
+      elapsedMs = 0;
+      onMs = 0;
+      retryMs = WIFI_DUTY_RETRY_MS;
+      wakes = 0;
+      failures = 0;
+      }
+
+   void RadioDutyCycle::Wake(uint32_t nowMs)
+      {
+      advance(nowMs);
+      if (state == RadioState::Off)
+         {
+         state = RadioState::Waking;
+         wakeMs = nowMs;
+         wakes++;
+         }
+      }
+
+   void RadioDutyCycle::Connected(uint32_t nowMs)
+      {
+      advance(nowMs);
+      if (state == RadioState::Waking)
+         {
+         // Smoothed with 1/4 weight for the new value, one slow reconnect doesn't double the lead.
+         uint32_t measured = nowMs - wakeMs;
+         connectMs = (3 * connectMs + measured) / 4;
+         leadMs = connectMs + WIFI_DUTY_LEAD_MARGIN_MS;
+         leadMs = (leadMs < WIFI_DUTY_LEAD_MAX_MS) ? leadMs : WIFI_DUTY_LEAD_MAX_MS;
+         }
+
+      state = RadioState::On;
+      retryMs = WIFI_DUTY_RETRY_MS;
+      }
+
+   uint32_t RadioDutyCycle::Synced(uint32_t nowMs, bool success, uint32_t intervalMs)
+      {
+      advance(nowMs);
+      if (success) { retryMs = WIFI_DUTY_RETRY_MS; }
+
+      return sleepFor(intervalMs);
+      }
+
+   uint32_t RadioDutyCycle::Failed(uint32_t nowMs, uint32_t intervalMs)
+      {
+      advance(nowMs);
+      failures++;
+      state = keepOn ? RadioState::On : RadioState::Off;
+
+      uint32_t delayMs = retryMs;
+      uint32_t maxMs = (intervalMs > WIFI_DUTY_RETRY_MS) ? intervalMs : WIFI_DUTY_RETRY_MS;
+      retryMs = (retryMs < maxMs / 2) ? 2 * retryMs : maxMs;
+      return delayMs;
+      }
+
+   uint64_t RadioDutyCycle::GetOnMs(uint32_t nowMs) const
+      {
+      return onMs + ((state != RadioState::Off) ? (uint32_t)(nowMs - lastMs) : 0);
+      }
+
+   uint64_t RadioDutyCycle::GetElapsedMs(uint32_t nowMs) const
+      {
+      return elapsedMs + (uint32_t)(nowMs - lastMs);
+      }
+
+   uint32_t RadioDutyCycle::GetOnMsPerDay(uint32_t nowMs) const
+      {
+      uint64_t elapsed = GetElapsedMs(nowMs);
+      return (elapsed > 0) ? (uint32_t)(GetOnMs(nowMs) * DAY_MS / elapsed) : 0;
+      }
+
+   uint32_t RadioDutyCycle::GetAverageUa(uint32_t nowMs) const
+      {
+      uint64_t elapsed = GetElapsedMs(nowMs);
+      return (elapsed > 0) ? (uint32_t)(GetOnMs(nowMs) * WIFI_DUTY_ON_UA / elapsed) : 0;
+      }
+
+   void RadioDutyCycle::advance(uint32_t nowMs)
+      {
+      // Called at least every sync interval (< 49 days), the `millis()` difference is wrap safe.
+      uint32_t delta = nowMs - lastMs;
+      elapsedMs += delta;
+      if (state != RadioState::Off) { onMs += delta; }
+      lastMs = nowMs;
+      }
+
+   uint32_t RadioDutyCycle::sleepFor(uint32_t delayMs)
+      {
+      // Wake the lead before the sync; a short sleep isn't worth the reconnect, stay on to the sync.
+      if (!keepOn && (delayMs >= leadMs + WIFI_DUTY_MIN_SLEEP_MS))
+         {
+         state = RadioState::Off;
+         return delayMs - leadMs;
+         }
+
+      state = RadioState::On;
+      return delayMs;
+      }
+   } // namespace BinaryClockShield
@@ -0,0 +1,147 @@
+/// @file RadioDutyCycle.h
+/// @brief The header file for the `RadioDutyCycle` class, the WiFi radio schedule around the NTP syncs.
+/// @details The clock only needs the network for the NTP syncs, the radio can be off in between:
+///          - `Synced()` (or `Failed()`) ends a wake, the radio goes off until the next sync less
+///            the lead, the time to reconnect;
+///          - `Wake()` powers the radio up, `Connected()` measures the reconnect time which sets
+///            the lead (smoothed, plus `WIFI_DUTY_LEAD_MARGIN_MS`) so the sync happens on time;
+///          - a wake that doesn't connect retries after `WIFI_DUTY_RETRY_MS`, doubling up to the
+///            sync interval;
+///          - a sleep shorter than `WIFI_DUTY_MIN_SLEEP_MS` isn't worth the reconnect, the radio stays on;
+///          - with `set_KeepOn()` (e.g. serving NTP to the LAN) the syncs are scheduled the same way
+///            but the radio is never powered down.
+///          The radio on time is accounted from `Start()`, `GetOnMsPerDay()` and `GetAverageUa()`
+///          give the radio on time per day and the average current the radio adds (`WIFI_DUTY_ON_UA`
+///          while on). With the adaptive poll interval (2^10 s to 2^17 s) and a fast reconnect of
+///          about 1 s the radio is on a few seconds to a couple of minutes a day instead of 24 hours.
+/// @remarks The class has no Arduino or ESP-IDF dependencies so it can be run on the host, the
+///          times are `millis()` values (the differences are wrap safe); `BinaryClockWAN` powers
+///          the radio, connects, syncs and runs the timer.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __RADIODUTYCYCLE_H__
+#define __RADIODUTYCYCLE_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+#ifndef WIFI_DUTY_LEAD_MS
+   #define WIFI_DUTY_LEAD_MS         2000UL   ///< The starting reconnect time (ms), before it is measured.
+#endif
+#ifndef WIFI_DUTY_LEAD_MARGIN_MS
+   #define WIFI_DUTY_LEAD_MARGIN_MS   500UL   ///< The margin (ms) added to the measured reconnect time for the lead.
+#endif
+#ifndef WIFI_DUTY_LEAD_MAX_MS
+   #define WIFI_DUTY_LEAD_MAX_MS    30000UL   ///< The maximum lead (ms), e.g. when the reconnect needs a scan.
+#endif
+#ifndef WIFI_DUTY_MIN_SLEEP_MS
+   #define WIFI_DUTY_MIN_SLEEP_MS   30000UL   ///< A shorter sleep (ms) isn't worth the reconnect, the radio stays on.
+#endif
+#ifndef WIFI_DUTY_RETRY_MS
+   #define WIFI_DUTY_RETRY_MS       60000UL   ///< The sleep (ms) after the first wake that didn't connect, it doubles.
+#endif
+#ifndef WIFI_DUTY_ON_UA
+   #define WIFI_DUTY_ON_UA         100000UL   ///< The current (µA) the radio adds while on, ESP32 RX ~100 mA without power save.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The radio states of the duty cycle.
+   enum class RadioState : uint8_t
+      {
+      Off = 0,                         ///< The radio is off until the next wake.
+      Waking,                          ///< The radio is on, reconnecting for the next sync.
+      On                               ///< The radio is on: connected, syncing or staying on.
+      };
+
+   /// @brief The WiFi radio duty cycle, the radio is only on around the NTP syncs.
+   /// @author Chris-70 (2026/10)
+   class RadioDutyCycle
+      {
+   public:
+      RadioDutyCycle() = default;
+
+      /// @brief Start the accounting with the radio on, e.g. connected by `Begin()`.
+      /// @param nowMs The time, `millis()`.
+      void Start(uint32_t nowMs);
+
+      /// @brief The radio was powered up for the next sync.
+      /// @param nowMs The time, `millis()`.
+      void Wake(uint32_t nowMs);
+
+      /// @brief The wake connected, the time since `Wake()` updates the lead.
+      /// @param nowMs The time, `millis()`.
+      /// @author Chris-70 (2026/10)
+      void Connected(uint32_t nowMs);
+
+      /// @brief The sync is done, the radio goes off until the next one (see `get_State()`).
+      /// @param nowMs The time, `millis()`.
+      /// @param success True if the time was synced.
+      /// @param intervalMs The time (ms) to the next sync, e.g. from the adaptive poll interval.
+      /// @return The time (ms) to the next `Wake()`.
+      /// @author Chris-70 (2026/10)
+      uint32_t Synced(uint32_t nowMs, bool success, uint32_t intervalMs);
+
+      /// @brief The wake didn't connect, the radio goes off and the wake is retried with a backoff.
+      /// @param nowMs The time, `millis()`.
+      /// @param intervalMs The sync interval (ms), the longest backoff.
+      /// @return The time (ms) to the next `Wake()`.
+      /// @author Chris-70 (2026/10)
+      uint32_t Failed(uint32_t nowMs, uint32_t intervalMs);
+
+      /// @brief Read only property: The radio state, `Off` after `Synced()` or `Failed()` if the radio is to be powered down.
+      RadioState get_State() const { return state; }
+
+      /// @brief Property: KeepOn - Flag: the radio stays on between the syncs, only the syncs are scheduled.
+      void set_KeepOn(bool value) { keepOn = value; }
+      /// @copydoc set_KeepOn()
+      bool get_KeepOn() const { return keepOn; }
+
+      /// @brief Read only property: The lead (ms), the radio is powered up this long before a sync.
+      uint32_t get_LeadMs() const { return leadMs; }
+
+      /// @brief Read only property: The number of wakes.
+      uint32_t get_Wakes() const { return wakes; }
+
+      /// @brief Read only property: The number of wakes that didn't connect.
+      uint32_t get_Failures() const { return failures; }
+
+      /// @brief Get the total time (ms) the radio was on since `Start()`.
+      /// @param nowMs The time, `millis()`.
+      uint64_t GetOnMs(uint32_t nowMs) const;
+
+      /// @brief Get the time (ms) since `Start()`.
+      /// @param nowMs The time, `millis()`.
+      uint64_t GetElapsedMs(uint32_t nowMs) const;
+
+      /// @brief Get the radio on time per day (ms), averaged since `Start()`.
+      /// @param nowMs The time, `millis()`.
+      uint32_t GetOnMsPerDay(uint32_t nowMs) const;
+
+      /// @brief Get the average current (µA) the radio adds, averaged since `Start()`.
+      /// @param nowMs The time, `millis()`.
+      uint32_t GetAverageUa(uint32_t nowMs) const;
+
+   protected:
+      /// @brief Add the time since the last call to the elapsed and radio on totals.
+      void advance(uint32_t nowMs);
+
+      /// @brief The time to the next wake: the sleep, or 0 to stay on, less the lead.
+      uint32_t sleepFor(uint32_t delayMs);
+
+   private:
+      RadioState state   = RadioState::On;       ///< The radio state.
+      uint32_t lastMs    = 0;                    ///< The time of the last call.
+      uint32_t wakeMs    = 0;                    ///< The time of the last `Wake()`.
+      uint64_t elapsedMs = 0;                    ///< The time since `Start()`.
+      uint64_t onMs      = 0;                    ///< The radio on time since `Start()`.
+      uint32_t connectMs = WIFI_DUTY_LEAD_MS;    ///< The smoothed reconnect time.
+      uint32_t leadMs    = WIFI_DUTY_LEAD_MS + WIFI_DUTY_LEAD_MARGIN_MS;   ///< The lead before a sync.
+      uint32_t retryMs   = WIFI_DUTY_RETRY_MS;   ///< The next backoff after a wake that didn't connect.
+      uint32_t wakes     = 0;                    ///< The number of wakes.
+      uint32_t failures  = 0;                    ///< The number of wakes that didn't connect.
+      bool     keepOn    = false;                ///< Flag: the radio stays on between the syncs.
+      }; // class RadioDutyCycle
+   } // namespace BinaryClockShield
+
+#endif // __RADIODUTYCYCLE_H__
@@ -0,0 +1,198 @@
+/// @file WiFiStateMachine.cpp
+/// @brief The implementation of the `WiFiStateMachine` class, the event driven WiFi connection logic.
+/// @author Chris-70 (2026/10)
+
+#include "WiFiStateMachine.h"
+
+namespace BinaryClockShield
+   {
+   void WiFiStateMachine::set_Candidates(const std::vector<WiFiCandidate>& value)
+      {
+      std::vector<WiFiCandidate> list = value;
+      for (auto& candidate : list)
+         {
+         int index = indexOf(candidate.id);
+         candidate.failures = (index >= 0) ? candidates[index].failures : candidate.failures;
+         candidate.tried = false;
+         }
+
+      candidates = list;
+      }
+
+   WiFiAction WiFiStateMachine::Start()
+      {
+      for (auto& candidate : candidates)
+         { candidate.tried = false; }
+      reconnect = false;
+
+      WiFiAction action = nextCandidate();
+      return (action.type == WiFiAction::None) ? endRound() : action;
+      }
+
+   WiFiAction WiFiStateMachine::Connected(uint8_t id)
+      {
+      int index = indexOf(id);
+      if (index >= 0) { candidates[index].failures = 0; }
+
+      currentID = id;
+      state = WiFiState::Connected;
+      reconnect = false;
+      backoffMs = WIFI_BACKOFF_MIN_MS;
+
+      WiFiAction action;
+      action.type = WiFiAction::Done;
+      action.id = id;
+      return action;
+      }
+
+   WiFiAction WiFiStateMachine::Disconnected()
+      {
+      WiFiAction action;
+      switch (state)
+         {
+         case WiFiState::Connecting:
+            action = attemptFailed();
+            break;
+
+         case WiFiState::Connected:
+            // The connection was lost: try the same AP again at once, then the others.
+            for (auto& candidate : candidates)
+               { candidate.tried = false; }
+            reconnect = true;
+            action = nextCandidate();
+            if (action.type == WiFiAction::None) { action = endRound(); }
+            break;
+
+         default:    // Idle; Backoff; Failed: nothing in progress.
+            break;
+         }
+
+      return action;
+      }
+
+   WiFiAction WiFiStateMachine::TimerExpired()
+      {
+      WiFiAction action;
+      switch (state)
+         {
+         case WiFiState::Connecting:
+            action = attemptFailed();
+            break;
+
+         case WiFiState::Backoff:
+            action = Start();
+            break;
+
+         default:    // Idle; Connected; Failed: a stale timer.
+            break;
+         }
+
+      return action;
+      }
+
+   void WiFiStateMachine::Reset()
+      {
+      for (auto& candidate : candidates)
+         {
+         candidate.failures = 0;
+         candidate.tried = false;
+         }
+
+      state = WiFiState::Idle;
+      currentID = 0;
+      reconnect = false;
+      backoffMs = WIFI_BACKOFF_MIN_MS;
+      attempts = 0;
+      }
+
+   uint8_t WiFiStateMachine::GetFailures(uint8_t id) const
+      {
+      int index = indexOf(id);
+      return (index >= 0) ? candidates[index].failures : 0;
+      }
+
+   WiFiAction WiFiStateMachine::attemptFailed()
+      {
+      int index = indexOf(currentID);
+      if ((index >= 0) && (candidates[index].failures < WIFI_FAIL_MAX))
+         { candidates[index].failures++; }
+
+      WiFiAction action = nextCandidate();
+      return (action.type == WiFiAction::None) ? endRound() : action;
+      }
+
+   WiFiAction WiFiStateMachine::nextCandidate()
+      {
+      WiFiAction action;
+      int best = -1;
+      int32_t bestScore = INT32_MIN;
+
+      // After a lost connection the same AP is tried first, it was working.
+      int current = reconnect ? indexOf(currentID) : -1;
+      if ((current >= 0) && !candidates[current].tried)
+         { best = current; }
+      else
+         {
+         for (size_t i = 0; i < candidates.size(); i++)
+            {
+            const WiFiCandidate& candidate = candidates[i];
+            int32_t score = candidate.rssi + candidate.bonus - (int32_t)candidate.failures * WIFI_FAIL_PENALTY;
+            if (!candidate.tried && (score > bestScore))
+               {
+               best = (int)i;
+               bestScore = score;
+               }
+            }
+         }
+
+      if (best >= 0)
+         {
+         candidates[best].tried = true;
+         currentID = candidates[best].id;
+         state = WiFiState::Connecting;
+         attempts++;
+
+         action.type = WiFiAction::Connect;
+         action.id = currentID;
+         action.delayMs = WIFI_ATTEMPT_MS;
+         }
+
+      return action;
+      }
+
+   WiFiAction WiFiStateMachine::endRound()
+      {
+      WiFiAction action;
+      reconnect = false;
+      if (!retry)
+         {
+         state = WiFiState::Failed;
+         action.type = WiFiAction::Failed;
+         return action;
+         }
+
+      // Exponential backoff with +/-25% jitter so clocks restarted together (e.g. after a
+      // power failure) don't all retry at the same time.
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      uint32_t jitter = seed % (backoffMs / 2 + 1);
+
+      state = WiFiState::Backoff;
+      action.type = WiFiAction::Wait;
+      action.delayMs = backoffMs - backoffMs / 4 + jitter;
+
+      backoffMs = (backoffMs < WIFI_BACKOFF_MAX_MS / 2) ? 2 * backoffMs : WIFI_BACKOFF_MAX_MS;
+      return action;
+      }
+
+   int WiFiStateMachine::indexOf(uint8_t id) const
+      {
+      for (size_t i = 0; i < candidates.size(); i++)
+         {
+         if (candidates[i].id == id) { return (int)i; }
+         }
+
+      return -1;
+      }
+   } // namespace BinaryClockShield
@@ -0,0 +1,170 @@
+/// @file WiFiStateMachine.h
+/// @brief The header file for the `WiFiStateMachine` class, the event driven WiFi connection logic.
+/// @details The connection is driven by the WiFi events instead of polling `WiFi.status()`:
+///          - `Start()` ranks the candidate APs and returns the first one to connect to;
+///          - `Connected()` (got an IP) ends the attempt, the AP's failure count is cleared;
+///          - `Disconnected()` or `TimerExpired()` during an attempt counts a failure against the AP
+///            and moves on to the next candidate at once;
+///          - when every candidate of a round has failed the next round starts after a backoff
+///            (doubling from `WIFI_BACKOFF_MIN_MS` to `WIFI_BACKOFF_MAX_MS` with +/-25% jitter);
+///          - losing an established connection reconnects to the same AP at once, then backs off.
+///          The candidates are ranked by RSSI plus a bonus for past success (e.g. the last AP
+///          connected to) minus `WIFI_FAIL_PENALTY` dB per recent failure, so an AP that keeps
+///          failing (e.g. a wrong password) is tried last, not first.
+/// @remarks The class only decides what to do next, it has no Arduino or ESP-IDF dependencies so
+///          it can be run on the host; `BinaryClockWAN` makes the connections and runs the timer.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __WIFISTATEMACHINE_H__
+#define __WIFISTATEMACHINE_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// For size_t
+
+// STL classes required to be included:
+#include <vector>
+
+#ifndef WIFI_ATTEMPT_MS
+   #define WIFI_ATTEMPT_MS        15000UL   ///< The timeout (ms) of one connection attempt, association to IP.
+#endif
+#ifndef WIFI_BACKOFF_MIN_MS
+   #define WIFI_BACKOFF_MIN_MS     2000UL   ///< The backoff (ms) after the first failed round.
+#endif
+#ifndef WIFI_BACKOFF_MAX_MS
+   #define WIFI_BACKOFF_MAX_MS   300000UL   ///< The maximum backoff (ms) between rounds, 5 minutes.
+#endif
+#ifndef WIFI_FAIL_PENALTY
+   #define WIFI_FAIL_PENALTY         10     ///< The rank penalty (dB of RSSI) of each recent failure of an AP.
+#endif
+#ifndef WIFI_FAIL_MAX
+   #define WIFI_FAIL_MAX              8     ///< The maximum failure count of an AP.
+#endif
+
+namespace BinaryClockShield
+   {
+   /// @brief The states of the WiFi connection.
+   enum class WiFiState : uint8_t
+      {
+      Idle = 0,                        ///< Not connecting, WiFi events are ignored (e.g. during WPS).
+      Connecting,                      ///< An attempt is in progress.
+      Connected,                       ///< Connected with an IP address.
+      Backoff,                         ///< Waiting for the timer to start the next round.
+      Failed                           ///< Every candidate failed and retrying is off.
+      };
+
+   /// @brief The action `BinaryClockWAN` takes after an input to the state machine.
+   struct WiFiAction
+      {
+      /// @brief The action types.
+      enum Type : uint8_t
+         {
+         None = 0,                     ///< Nothing to do.
+         Connect,                      ///< Connect to candidate `id`, start the timer for `delayMs`.
+         Wait,                         ///< Start the timer for `delayMs`, then call `TimerExpired()`.
+         Failed,                       ///< Every candidate failed, no retry.
+         Done                          ///< Connected, stop the timer.
+         };
+      Type     type    = None;         ///< The action to take.
+      uint8_t  id      = 0;            ///< The ID of the AP credentials for `Connect`.
+      uint32_t delayMs = 0;            ///< The timer delay in ms for `Connect` and `Wait`.
+      };
+
+   /// @brief A candidate AP to connect to.
+   struct WiFiCandidate
+      {
+      uint8_t id        = 0;           ///< The ID of the AP credentials.
+      int32_t rssi      = -100;        ///< The signal strength in dBm, from the scan.
+      int16_t bonus     = 0;           ///< The rank bonus in dB, e.g. the last AP connected to.
+      uint8_t failures  = 0;           ///< The recent failures, kept between rounds and scans.
+      bool    tried     = false;       ///< Flag: tried in the current round.
+      };
+
+   /// @brief The event driven WiFi connection state machine.
+   /// @author Chris-70 (2026/10)
+   class WiFiStateMachine
+      {
+   public:
+      WiFiStateMachine() = default;
+
+      /// @brief Set the candidate APs, e.g. after a scan; the failure counts are kept by ID.
+      /// @param candidates The candidate APs, the order is not important.
+      void set_Candidates(const std::vector<WiFiCandidate>& candidates);
+
+      /// @brief Start a round of connection attempts with the best ranked candidate.
+      /// @return `Connect` the first candidate, or `Failed` (or `Wait` when retrying) if there are none.
+      /// @author Chris-70 (2026/10)
+      WiFiAction Start();
+
+      /// @brief The connection was made (got an IP address) to the AP `id`.
+      /// @return `Done`.
+      WiFiAction Connected(uint8_t id);
+
+      /// @brief The station was disconnected (attempt failed or connection lost).
+      /// @return The next action: the next candidate, a backoff, `Failed` or `None`.
+      /// @author Chris-70 (2026/10)
+      WiFiAction Disconnected();
+
+      /// @brief The timer expired: an attempt took too long or a backoff ended.
+      /// @return The next action.
+      /// @author Chris-70 (2026/10)
+      WiFiAction TimerExpired();
+
+      /// @brief Stop connecting, WiFi events are ignored until `Start()`.
+      void Stop() { state = WiFiState::Idle; }
+
+      /// @brief Forget the failure counts and the backoff.
+      void Reset();
+
+      /// @brief Property: Retry - Flag: back off and retry when every candidate failed, instead of `Failed`.
+      void set_Retry(bool value) { retry = value; }
+      /// @copydoc set_Retry()
+      bool get_Retry() const { return retry; }
+
+      /// @brief Property (WO): Seed - The seed of the backoff jitter, e.g. a hardware random number.
+      void set_Seed(uint32_t value) { seed = (value != 0 ? value : 1); }
+
+      /// @brief Read only property: The connection state.
+      WiFiState get_State() const { return state; }
+
+      /// @brief Read only property: The ID of the AP being tried or connected to, 0 if none.
+      uint8_t get_CurrentID() const { return currentID; }
+
+      /// @brief Read only property: The backoff (ms) before the next round, without the jitter.
+      uint32_t get_Backoff() const { return backoffMs; }
+
+      /// @brief Read only property: The number of connection attempts made.
+      uint32_t get_Attempts() const { return attempts; }
+
+      /// @brief Get the failure count of an AP.
+      /// @param id The ID of the AP credentials.
+      /// @return The recent failures of the AP, 0 if unknown.
+      uint8_t GetFailures(uint8_t id) const;
+
+   protected:
+      /// @brief Count a failure of the current attempt and move on to the next candidate or back off.
+      WiFiAction attemptFailed();
+
+      /// @brief Connect to the best ranked candidate not tried in this round.
+      /// @return `Connect`, or `None` if every candidate was tried.
+      WiFiAction nextCandidate();
+
+      /// @brief End the round: back off (retry) or fail.
+      WiFiAction endRound();
+
+      /// @brief Get the index of the candidate `id`, -1 if not found.
+      int indexOf(uint8_t id) const;
+
+   private:
+      std::vector<WiFiCandidate> candidates;          ///< The candidate APs.
+      WiFiState state       = WiFiState::Idle;        ///< The connection state.
+      uint8_t   currentID   = 0;                      ///< The AP being tried or connected to.
+      bool      retry       = false;                  ///< Flag: back off and retry.
+      bool      reconnect   = false;                  ///< Flag: the connection was lost, try the same AP first.
+      uint32_t  backoffMs   = WIFI_BACKOFF_MIN_MS;    ///< The next backoff in ms.
+      uint32_t  attempts    = 0;                      ///< The connection attempts made.
+      uint32_t  seed        = 1;                      ///< The xorshift state of the backoff jitter.
+      }; // class WiFiStateMachine
+   } // namespace BinaryClockShield
+
+#endif // __WIFISTATEMACHINE_H__
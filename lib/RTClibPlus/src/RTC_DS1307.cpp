@@ -145,6 +145,7 @@ uint8_t RTC_DS1307::isrunning(void) { return !(read_register(0) >> 7); }
 bool RTC_DS1307::getIs12HourMode()
    {
    uint8_t buffer = DS1307_HOUR;     // Hour register number
+   i2cTransactions++;
    i2c_dev->read(&buffer, 1, false); // Read the hour register
    // Check the 12 hour mode flag, bit 6 (0x40), for 12 hour mode
    return (buffer & DS_HOUR_12_24_MASK) != 0;
@@ -193,6 +194,7 @@ void RTC_DS1307::adjust(const DateTime &dt, bool use12HourFormat) {
               (uint8_t)(bin2bcd(dt.day() % (31 + 1))         & DS_DATE_MASK),    // (1-31)
               (uint8_t)(bin2bcd(dt.month() % (12 + 1))       & DS_MONTH_MASK),   // (1-12)
               (uint8_t)(bin2bcd(dt.year() % 100U)            & DS_YEAR_MASK)};   // (0-99)
+  i2cTransactions++;
   i2c_dev->write(buffer, 8);
 }
 /*!
@@ -210,6 +212,7 @@ void RTC_DS1307::adjust(const DateTime &dt)
 DateTime RTC_DS1307::now() {
   uint8_t buffer[7];
   buffer[0] = DS1307_TIME;
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
 
   return DateTime(bcd2bin(buffer[6]) + 2000U,             // Year, 2000-2099
@@ -251,6 +254,7 @@ void RTC_DS1307::writeSqwPinMode(Ds1307SqwPinMode mode) {
 /**************************************************************************/
 void RTC_DS1307::readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
   uint8_t addrByte = DS1307_NVRAM + address;
+  i2cTransactions++;
   i2c_dev->write_then_read(&addrByte, 1, buf, size);
 }
 
@@ -264,6 +268,7 @@ void RTC_DS1307::readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
 /**************************************************************************/
 void RTC_DS1307::writenvram(uint8_t address, const uint8_t *buf, uint8_t size) {
   uint8_t addrByte = DS1307_NVRAM + address;
+  i2cTransactions++;
   i2c_dev->write(buf, size, true, &addrByte, 1);
 }
 
@@ -212,6 +212,7 @@ uint8_t* RTC_DS3231::adjust(const DateTime& dt, bool use12HourMode, uint8_t (buf
              (uint8_t)(bin2bcd(dt.year() % 100U)            & DS_YEAR_MASK)   // 0-99
       };
 
+  i2cTransactions++;
   i2c_dev->write(buffer, 8);
    if (buf != nullptr) {
       memmove(buf, buffer, 8);
@@ -243,6 +244,7 @@ void RTC_DS3231::adjust(const DateTime &dt, bool use12HourMode)
 DateTime RTC_DS3231::now() {
   uint8_t buffer[7];
   buffer[0] = 0;
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
   
   return DateTime(bcd2bin(buffer[6]) 
@@ -291,6 +293,7 @@ void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {
 /**************************************************************************/
 float RTC_DS3231::getTemperature() {
   uint8_t buffer[2] = {DS3231_TEMPERATUREREG, 0};
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 2);
   return (float)buffer[0] + (buffer[1] >> 6) * 0.25f;
 }
@@ -315,6 +318,32 @@ int RTC_DS3231::getIntTemperature() {
    uint8_t buffer = read_register(DS3231_TEMPERATUREREG);
    return (int8_t)buffer; // Return the temperature as signed integer
 }
+
+/**************************************************************************/
+/*!
+    @brief  Get the DS3231 aging offset register value.
+    @details The aging offset trims the oscillator frequency, each LSB is
+             about 0.1 ppm at 25 C. Positive values add capacitance and slow
+             the clock, negative values speed it up.
+    @return The aging offset (-128 to +127), 2's complement.
+*/
+/**************************************************************************/
+int8_t RTC_DS3231::getAgingOffset() {
+  return (int8_t)read_register(DS3231_AGING_OFFSET);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the DS3231 aging offset register value.
+    @details The new value is used at the next temperature conversion, every
+             64 seconds.
+    @param offset The aging offset (-128 to +127), ~0.1 ppm per LSB,
+           positive values slow the clock.
+*/
+/**************************************************************************/
+void RTC_DS3231::setAgingOffset(int8_t offset) {
+  write_register(DS3231_AGING_OFFSET, (uint8_t)offset);
+}
 /**************************************************************************/
 /*!
     @brief  Get the current 12/24 hour mode for the Time & alarms.
@@ -375,6 +404,7 @@ void RTC_DS3231::setIs12HourMode(bool value)
       // Alarm1: Read the time; Read the mode; Store the alarm back in the new format.
       uint8_t buffer = DS3231_ALARM1_HOUR;
       // Read the current alarm 1 hour mode, get the current 12 hour mode value.
+      i2cTransactions++;
       uint8_t alarmMode12 = (i2c_dev->read(&buffer, 1, false) & 0x40) > 0;
       Ds3231Alarm1Mode mode1 = getAlarm1Mode();
       dt = getAlarm1(); // Get the current alarm 1 time
@@ -383,6 +413,7 @@ void RTC_DS3231::setIs12HourMode(bool value)
 
       // Alarm2: Read the time; Read the mode; Store the alarm back in the new format.
       buffer = DS3231_ALARM2_HOUR;
+      i2cTransactions++;
       alarmMode12 = (i2c_dev->read(&buffer, 1, false) & 0x40) > 0;
       Ds3231Alarm2Mode mode2 = getAlarm2Mode();
       dt = getAlarm2(); // Get the current alarm 2 time
@@ -441,6 +472,7 @@ bool RTC_DS3231::setAlarm1(const DateTime &alarmTime, Ds3231Alarm1Mode alarm_mod
                        uint8_t(bin2bcd(dt.minute()) | A1M2),
                        uint8_t(SET_HOUR(dt.hour(), use12HourMode) | A1M3),
                        uint8_t(bin2bcd(day) | A1M4 | DY_DT)};
+  i2cTransactions++;
   i2c_dev->write(buffer, 5);
 
   write_register(DS3231_CONTROL, ctrl | 0x01); // AI1E
@@ -515,6 +547,7 @@ bool RTC_DS3231::setAlarm2(const DateTime& alarmTime, Ds3231Alarm2Mode alarm_mod
               (uint8_t)(bin2bcd(dt.minute()) | A2M2),
               (uint8_t)(SET_HOUR(dt.hour(), use12HourMode) | A2M3),
               (uint8_t)(bin2bcd(day) | A2M4 | DY_DT)};
+  i2cTransactions++;
   i2c_dev->write(buffer, 4);
 
   write_register(DS3231_CONTROL, ctrl | 0x02); // AI2E
@@ -560,6 +593,7 @@ bool RTC_DS3231::setAlarm2(uint8_t day, uint8_t hour24, uint8_t min, Ds3231Alarm
 /**************************************************************************/
 DateTime RTC_DS3231::getAlarm1() {
   uint8_t buffer[5] = {DS3231_ALARM1, 0, 0, 0, 0};
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 5);
 
   uint8_t seconds = bcd2bin(buffer[0] & 0x7F);
@@ -607,6 +641,7 @@ DateTime RTC_DS3231::getAlarm1() {
 /**************************************************************************/
 DateTime RTC_DS3231::getAlarm2() {
   uint8_t buffer[4] = {DS3231_ALARM2, 0, 0, 0};
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 4);
 
   uint8_t minutes = bcd2bin(buffer[0] & 0x7F);
@@ -648,6 +683,7 @@ DateTime RTC_DS3231::getAlarm2() {
 /**************************************************************************/
 Ds3231Alarm1Mode RTC_DS3231::getAlarm1Mode() {
   uint8_t buffer[5] = {DS3231_ALARM1, 0, 0, 0, 0};
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 5);
 
   uint8_t alarm_mode =   (buffer[0] & 0x80) >> 7  //  A1M1 - Seconds bit   (every second) (x1111)
@@ -679,6 +715,7 @@ Ds3231Alarm1Mode RTC_DS3231::getAlarm1Mode() {
 /**************************************************************************/
 Ds3231Alarm2Mode RTC_DS3231::getAlarm2Mode() {
   uint8_t buffer[4] = {DS3231_ALARM2, 0, 0, 0};
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 4);
 
   uint8_t alarm_mode =   (buffer[0] & 0x80) >> 7  //  A2M2 - Minutes bit   (every minute) (x111)
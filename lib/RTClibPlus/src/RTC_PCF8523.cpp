@@ -67,6 +67,7 @@ void RTC_PCF8523::adjust(const DateTime &dt) {
                        bin2bcd(0), // skip weekdays
                        bin2bcd(dt.month()),
                        bin2bcd(dt.year() - 2000U)};
+  i2cTransactions++;
   i2c_dev->write(buffer, 8);
 
   // set to battery switchover mode
@@ -82,6 +83,7 @@ void RTC_PCF8523::adjust(const DateTime &dt) {
 DateTime RTC_PCF8523::now() {
   uint8_t buffer[7];
   buffer[0] = 3;
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
 
   return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5]),
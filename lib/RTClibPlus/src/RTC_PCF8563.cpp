@@ -50,6 +50,7 @@ void RTC_PCF8563::adjust(const DateTime &dt) {
                        bin2bcd(dt.hour()),   bin2bcd(dt.day()),
                        bin2bcd(0), // skip weekdays
                        bin2bcd(dt.month()),  bin2bcd(dt.year() - 2000U)};
+  i2cTransactions++;
   i2c_dev->write(buffer, 8);
 }
 
@@ -62,6 +63,7 @@ void RTC_PCF8563::adjust(const DateTime &dt) {
 DateTime RTC_PCF8563::now() {
   uint8_t buffer[7];
   buffer[0] = PCF8563_VL_SECONDS; // start at location 2, VL_SECONDS
+  i2cTransactions++;
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
 
   return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5] & 0x1F),
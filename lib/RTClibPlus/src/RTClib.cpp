@@ -56,6 +56,8 @@
     #define pgm_read_byte(addr) (*(const unsigned char *)(addr))
 #endif
 
+volatile uint32_t RTC_I2C::i2cTransactions = 0;
+
 /**************************************************************************/
 /*!
     @brief Write value to register.
@@ -65,6 +67,7 @@
 /**************************************************************************/
 void RTC_I2C::write_register(uint8_t reg, uint8_t val) {
   uint8_t buffer[2] = {reg, val};
+  i2cTransactions++;
   i2c_dev->write(buffer, 2);
 }
 
@@ -77,6 +80,7 @@ void RTC_I2C::write_register(uint8_t reg, uint8_t val) {
 /**************************************************************************/
 uint8_t RTC_I2C::read_register(uint8_t reg) {
   uint8_t buffer[1];
+  i2cTransactions += 2;
   i2c_dev->write(&reg, 1);
   i2c_dev->read(buffer, 1);
   return buffer[0];
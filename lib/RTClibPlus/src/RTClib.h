@@ -150,8 +150,15 @@ public:
   static uint8_t bin2bcd(uint8_t val) { return val + 6 * (val / 10); }
   uint8_t read_register(uint8_t reg);
   void write_register(uint8_t reg, uint8_t val);
+  /*!
+      @brief  Get the count of the I2C transactions made with the RTC, e.g.
+      for the metrics
+      @return The writes, reads and write-then-reads since boot
+  */
+  static uint32_t transactions() { return i2cTransactions; }
 protected:
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
+  static volatile uint32_t i2cTransactions; ///< The I2C transactions made
 };
 
 /**************************************************************************/
@@ -217,6 +224,8 @@ public:
   bool isEnabled32K(void);
   float getTemperature();   // in Celsius degree, +- 0.25 degree resolution
   int getIntTemperature(); // in Celsius degree, (-128 to +127 C) no floating point
+  int8_t getAgingOffset();  // Aging offset register, ~0.1 ppm per LSB, +ve slows the clock
+  void setAgingOffset(int8_t offset);
   /*!
       @brief  Convert the day of the week to a representation suitable for
               storing in the DS3231: from 1 (WeekdayEpoch.dayOfTheWeek() + 1) to 7.
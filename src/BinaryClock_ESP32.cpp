@@ -76,6 +76,12 @@ static BinaryClock& get_BinaryClock();
 #if WIFI
    void setupWiFi(BinaryClock & binClock, BinaryClockWAN & wifi, bool autoConnect);
    static BinaryClockWAN& get_BinaryClockWAN();
+   #if SERIAL_COMMAND_CODE
+   #define WIFI_CREDS_COMMAND    0x40  ///< Serial command: ssid len | ssid | password len | password | bssid len | bssid
+   #define TIMEZONE_COMMAND      0x41  ///< Serial command: the timezone string in Proleptic Format.
+   BCSerialCommand::Status WiFiCredsCommand(BCSerialCommand::Phase phase, const uint8_t* data, uint8_t length);
+   BCSerialCommand::Status TimezoneCommand(BCSerialCommand::Phase phase, const uint8_t* data, uint8_t length);
+   #endif
 #endif
 
 #if (DEVELOPMENT || SERIAL_OUTPUT) && !defined(UNO_R3)
@@ -163,6 +169,79 @@ void setupWiFi(BinaryClock& binClock, BinaryClockWAN& wifi, bool autoConnect)
    
    SERIAL_STREAM("[" << millis() << "] SetupWiFi() - Task exiting successfully." << endl)
    } // setupWiFi()
+
+#if SERIAL_COMMAND_CODE
+/// @brief Serial commit handler of the settings, shared by the WiFi credentials and the timezone
+///        so a frame is saved once: a checkpoint before the frame, one save after, or undone.
+BCSerialCommand::Status SettingsCommit(BCSerialCommand::Phase phase)
+   {
+   BinaryClockSettings& settings = BinaryClockSettings::get_Instance();
+   switch (phase)
+      {
+      case BCSerialCommand::Phase::Begin:
+         settings.Checkpoint();
+         return BCSerialCommand::Status::Ok;
+
+      case BCSerialCommand::Phase::Commit:
+         if (!settings.Save()) { return BCSerialCommand::Status::Failed; }
+         settings.Release();
+         return BCSerialCommand::Status::Ok;
+
+      case BCSerialCommand::Phase::Rollback:
+         return settings.Rollback() ? BCSerialCommand::Status::Ok : BCSerialCommand::Status::Failed;
+
+      default:
+         return BCSerialCommand::Status::Ok;
+      }
+   }
+
+/// @brief Serial command handler to add the WiFi credentials, saved by `SettingsCommit()`.
+BCSerialCommand::Status WiFiCredsCommand(BCSerialCommand::Phase phase, const uint8_t* data, uint8_t length)
+   {
+   BinaryClockSettings& settings = BinaryClockSettings::get_Instance();
+   // Three length prefixed strings: SSID (1 - 32); password (0 - 64); BSSID (0 or 17, "00:11:22:33:44:55")
+   const uint8_t* field[3];
+   uint8_t size[3];
+   uint8_t pos = 0;
+   for (int i = 0; i < 3; i++)
+      {
+      if (pos >= length) { return BCSerialCommand::Status::BadLength; }
+      size[i]  = data[pos++];
+      field[i] = data + pos;
+      if ((pos + size[i]) > length) { return BCSerialCommand::Status::BadLength; }
+      pos += size[i];
+      }
+
+   if ((pos != length) || (size[0] == 0) || (size[0] > 32) || (size[1] > 64) || ((size[2] != 0) && (size[2] != 17)))
+      { return BCSerialCommand::Status::BadValue; }
+
+   if (phase == BCSerialCommand::Phase::Apply)
+      {
+      String ssid, password, bssid;
+      ssid.concat((const char*)field[0], size[0]);
+      password.concat((const char*)field[1], size[1]);
+      bssid.concat((const char*)field[2], size[2]);
+      if (settings.AddWiFiCreds(ssid, password, bssid) == 0) { return BCSerialCommand::Status::Failed; }
+      }
+
+   return BCSerialCommand::Status::Ok;
+   }
+
+/// @brief Serial command handler to set the timezone, saved with the WiFi credentials by `SettingsCommit()`.
+BCSerialCommand::Status TimezoneCommand(BCSerialCommand::Phase phase, const uint8_t* data, uint8_t length)
+   {
+   if ((length == 0) || (length > 64)) { return BCSerialCommand::Status::BadLength; }
+
+   if (phase == BCSerialCommand::Phase::Apply)
+      {
+      String timezone;
+      timezone.concat((const char*)data, length);
+      BinaryClockSettings::get_Instance().set_Timezone(timezone);
+      }
+
+   return BCSerialCommand::Status::Ok;
+   }
+#endif // SERIAL_COMMAND_CODE
 #endif // WIFI
 
 __attribute__((used)) void setup()
@@ -266,6 +345,12 @@ __attribute__((used)) void setup()
       wifi.set_WanEventGroup(taskEventGroup);
       }
 
+   #if SERIAL_COMMAND_CODE
+   // The WiFi settings are in the `BinaryClockWiFi` library, add them to the serial commands here.
+   binClock.get_SerialCommand().RegisterCommand(WIFI_CREDS_COMMAND, WiFiCredsCommand, SettingsCommit);
+   binClock.get_SerialCommand().RegisterCommand(TIMEZONE_COMMAND,   TimezoneCommand,  SettingsCommit);
+   #endif
+
    auto wifiHandle = CreateMethodTask<BinaryClock&, BinaryClockWAN&, bool> 
                         ( &setupWiFi
                         , "SetupWiFiTask"
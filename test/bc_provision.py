@@ -0,0 +1,506 @@
+#!/usr/bin/env python3
+"""Host tool for the binary serial command protocol (SERIAL_COMMAND_CODE).
+
+Provisions a clock in one round trip: all the settings in the configuration file
+are sent in a single frame, the clock validates every record before it applies
+any of them, and replies with a compact status. See `BCSerialCommand.h`:
+
+    0x00 | COBS( version | sequence | records ... | CRC-16 LE ) | 0x00
+    record: command (u8) | length (u8) | data[length]
+
+Usage:
+    bc_provision.py provision CONFIG.json --port /dev/ttyUSB0 [--baud 115200]
+    bc_provision.py status --port /dev/ttyUSB0
+    bc_provision.py selftest
+
+`provision` and `status` need pyserial. `selftest` runs the host side against a
+device emulator over a Linux pseudo-terminal (no hardware, no pyserial); the
+firmware's own parser is run behind a pty by test/host/test_serial_command.cpp.
+
+Configuration (JSON, every key is optional):
+    {
+      "time": "now" | "2026-10-18T14:30:00",
+      "hour_mode": 12 | 24,
+      "brightness": 30,
+      "alarm": {"number": 2, "hour": 6, "minute": 30, "day": 0, "repeat": "daily", "on": true, "melody": 0},
+      "on_colors": ["#FF0000", ...],     (NUM_LEDS colors)
+      "off_colors": ["#000000", ...],
+      "am_color": "#00BFFF", "pm_color": "#4B0082",
+      "melody": 0  |  "notes": [[440, 250], [0, 100], ...],
+      "wifi": [{"ssid": "Home", "password": "secret", "bssid": ""}],
+      "timezone": "EST+5EDT,M3.2.0/2,M11.1.0/2"
+    }
+"""
+
+import argparse
+import datetime
+import json
+import os
+import struct
+import sys
+import threading
+import time
+
+VERSION = 1
+NUM_LEDS = 17
+
+CMD_PING = 0x01
+CMD_STATUS = 0x02
+CMD_TIME = 0x10
+CMD_ALARM = 0x11
+CMD_HOUR_MODE = 0x12
+CMD_BRIGHTNESS = 0x13
+CMD_ON_COLORS = 0x14
+CMD_OFF_COLORS = 0x15
+CMD_AMPM_COLORS = 0x16
+CMD_MELODY = 0x17
+CMD_MELODY_NOTES = 0x18
+CMD_WIFI_CREDS = 0x40
+CMD_TIMEZONE = 0x41
+
+STATUS_NAMES = ["Ok", "BadFrame", "BadVersion", "UnknownCommand", "BadLength", "BadValue", "Busy", "Failed"]
+REPEAT_NAMES = ["never", "hourly", "daily", "weekly", "monthly"]
+STATUS_BLOCK = struct.Struct("<IBBBBBBBBHH")
+SECONDS_1970_TO_2000 = 946684800
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, identical to `BCSerialCommand::Crc16()`."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_index = 0
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(byte)
+            code += 1
+            if code == 0xFF:
+                out[code_index] = code
+                code_index = len(out)
+                out.append(0)
+                code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        if code == 0 or pos + code - 1 > len(data):
+            raise ValueError("bad COBS data")
+        out += data[pos:pos + code - 1]
+        pos += code - 1
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def make_frame(sequence, body):
+    payload = bytes([VERSION, sequence]) + body
+    return b"\x00" + cobs_encode(payload + struct.pack("<H", crc16(payload))) + b"\x00"
+
+
+def parse_frame(encoded):
+    """Return the decoded payload without the CRC, or None if it isn't a valid frame."""
+    try:
+        payload = cobs_decode(encoded)
+    except ValueError:
+        return None
+    if len(payload) < 4 or crc16(payload[:-2]) != struct.unpack_from("<H", payload, len(payload) - 2)[0]:
+        return None
+    return payload[:-2]
+
+
+def record(command, data=b""):
+    if len(data) > 255:
+        raise ValueError(f"record 0x{command:02X} is too long ({len(data)} bytes)")
+    return bytes([command, len(data)]) + bytes(data)
+
+
+def parse_color(text):
+    value = int(text.lstrip("#"), 16) if isinstance(text, str) else int(text)
+    return bytes([(value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF])
+
+
+def build_records(config):
+    """Convert the configuration to the list of records, in the order they are applied."""
+    records = []
+    if "hour_mode" in config:
+        records.append(record(CMD_HOUR_MODE, [1 if int(config["hour_mode"]) == 12 else 0]))
+    if "time" in config:
+        when = datetime.datetime.now() if config["time"] == "now" else datetime.datetime.fromisoformat(config["time"])
+        # The RTC keeps local time, the unixtime is computed without a timezone.
+        seconds = int((when.replace(tzinfo=None) - datetime.datetime(1970, 1, 1)).total_seconds())
+        records.append(record(CMD_TIME, struct.pack("<I", seconds)))
+    if "brightness" in config:
+        records.append(record(CMD_BRIGHTNESS, [int(config["brightness"])]))
+    for key, command in (("on_colors", CMD_ON_COLORS), ("off_colors", CMD_OFF_COLORS)):
+        if key in config:
+            records.append(record(command, b"".join(parse_color(c) for c in config[key])))
+    if "am_color" in config or "pm_color" in config:
+        records.append(record(CMD_AMPM_COLORS, parse_color(config.get("am_color", "#00BFFF"))
+                              + parse_color(config.get("pm_color", "#4B0082"))))
+    if "notes" in config:
+        records.append(record(CMD_MELODY_NOTES, b"".join(struct.pack("<HH", t, d) for t, d in config["notes"])))
+    elif "melody" in config:
+        records.append(record(CMD_MELODY, [int(config["melody"])]))
+    if "alarm" in config:
+        alarm = config["alarm"]
+        repeat = alarm.get("repeat", "daily")
+        repeat = REPEAT_NAMES.index(repeat) if isinstance(repeat, str) else int(repeat)
+        records.append(record(CMD_ALARM, [alarm.get("number", 2), alarm["hour"], alarm["minute"], alarm.get("day", 0),
+                                          repeat, 1 if alarm.get("on", True) else 0, alarm.get("melody", 0)]))
+    for creds in config.get("wifi", []):
+        fields = [creds["ssid"], creds.get("password", ""), creds.get("bssid", "")]
+        data = b"".join(bytes([len(f.encode())]) + f.encode() for f in fields)
+        records.append(record(CMD_WIFI_CREDS, data))
+    if "timezone" in config:
+        records.append(record(CMD_TIMEZONE, config["timezone"].encode()))
+    return records
+
+
+def decode_status(data):
+    fields = STATUS_BLOCK.unpack(data[:STATUS_BLOCK.size])
+    (unixtime, hour, minute, alarm_on, repeat, flags, brightness, melody, melodies, frames, errors) = fields
+    return {
+        "time": datetime.datetime(1970, 1, 1) + datetime.timedelta(seconds=unixtime),
+        "alarm": f"{hour:02d}:{minute:02d} {'ON' if alarm_on else 'OFF'} {REPEAT_NAMES[repeat] if repeat < 5 else repeat}",
+        "12 hour": bool(flags & 0x01), "menu busy": bool(flags & 0x02), "alarm ringing": bool(flags & 0x04),
+        "brightness": brightness, "melody": f"{melody} of {melodies}", "frames": frames, "errors": errors,
+    }
+
+
+class FdPort:
+    """Minimal serial port over a file descriptor (e.g. the pty master), same calls as pyserial."""
+
+    def __init__(self, fd):
+        self.fd = fd
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self, size, timeout):
+        import select
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        return os.read(self.fd, size) if ready else b""
+
+
+class SerialPort:
+    def __init__(self, name, baud):
+        import serial  # pyserial, only needed for a real port.
+        self.port = serial.Serial(name, baud, timeout=0.05)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, size, timeout):
+        self.port.timeout = timeout
+        return self.port.read(size)
+
+
+def transact(port, body, sequence=1, timeout=3.0, echo_text=True):
+    """Send one request frame and wait for the reply with the same sequence number.
+
+    Returns (status, record index, status block or None). The text output from the
+    clock (log messages) between the frames is echoed to stderr.
+    """
+    port.write(make_frame(sequence, body))
+    deadline = time.monotonic() + timeout
+    pending = b""
+    while time.monotonic() < deadline:
+        pending += port.read(256, 0.05)
+        while b"\x00" in pending:
+            chunk, pending = pending.split(b"\x00", 1)
+            payload = parse_frame(chunk) if chunk else None
+            if payload is None:
+                if chunk and echo_text:
+                    sys.stderr.write(chunk.decode("latin-1"))
+                continue
+            if payload[0] == VERSION and payload[1] == sequence and len(payload) >= 4:
+                block = decode_status(payload[4:]) if len(payload) >= 4 + STATUS_BLOCK.size else None
+                return payload[2], payload[3], block
+    raise TimeoutError("no reply from the clock")
+
+
+def report(status, index, block):
+    name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+    print(f"Status: {name}" + ("" if status == 0 else f" (record {index})"))
+    for key, value in (block or {}).items():
+        print(f"  {key:14}: {value}")
+    return 0 if status == 0 else 1
+
+
+def open_port(options):
+    return SerialPort(options.port, options.baud)
+
+
+def cmd_provision(options):
+    with open(options.config, encoding="utf-8") as f:
+        config = json.load(f)
+    records = build_records(config) + [record(CMD_STATUS)]
+    body = b"".join(records)
+    print(f"Sending {len(records)} records ({len(body)} bytes) in one frame.")
+    return report(*transact(open_port(options), body))
+
+
+def cmd_status(options):
+    return report(*transact(open_port(options), record(CMD_STATUS)))
+
+
+#################################################################################
+# Device emulator, mirrors `BCSerialCommand` for the pseudo-terminal self test.
+#################################################################################
+
+class DeviceEmulator(threading.Thread):
+    def __init__(self, fd):
+        super().__init__(daemon=True)
+        self.fd = fd
+        self.text = bytearray()
+        self.state = {"time": 0, "hour_mode": 0, "brightness": 20, "alarm": (2, 0, 0, 0, 2, 0, 0), "melody": 0,
+                      "melodies": 1, "on_colors": None, "off_colors": None, "ampm": None, "wifi": [], "timezone": ""}
+        self.frames = 0
+        self.errors = 0
+        self.saves = 0
+        self.running = True
+
+    def run(self):
+        frame = bytearray()
+        in_frame = False
+        while self.running:
+            try:
+                data = FdPort(self.fd).read(256, 0.05)
+            except OSError:
+                return
+            for byte in data:
+                if byte == 0:
+                    if in_frame and frame:
+                        self.process(bytes(frame))
+                        in_frame = False
+                    else:
+                        in_frame = True
+                    frame.clear()
+                elif in_frame:
+                    frame.append(byte)
+                else:
+                    self.text.append(byte)
+
+    def validate(self, command, data, apply, state):
+        lengths = {CMD_PING: 0, CMD_STATUS: 0, CMD_TIME: 4, CMD_ALARM: 7, CMD_HOUR_MODE: 1, CMD_BRIGHTNESS: 1,
+                   CMD_ON_COLORS: NUM_LEDS * 3, CMD_OFF_COLORS: NUM_LEDS * 3, CMD_AMPM_COLORS: 6, CMD_MELODY: 1}
+        if command in lengths and len(data) != lengths[command]:
+            return 4
+        if command == CMD_TIME:
+            if struct.unpack("<I", data)[0] < SECONDS_1970_TO_2000:
+                return 5
+            if apply:
+                state["time"] = struct.unpack("<I", data)[0]
+        elif command == CMD_ALARM:
+            if not (1 <= data[0] <= 2 and data[1] <= 23 and data[2] <= 59 and data[3] <= 31 and data[4] < 5
+                    and data[5] <= 1 and data[6] < state["melodies"]):
+                return 5
+            if apply:
+                state["alarm"] = tuple(data)
+        elif command == CMD_HOUR_MODE:
+            if data[0] > 1:
+                return 5
+            if apply:
+                state["hour_mode"] = data[0]
+        elif command == CMD_BRIGHTNESS:
+            if apply:
+                state["brightness"] = data[0]
+        elif command in (CMD_ON_COLORS, CMD_OFF_COLORS, CMD_AMPM_COLORS):
+            if apply:
+                state[{CMD_ON_COLORS: "on_colors", CMD_OFF_COLORS: "off_colors", CMD_AMPM_COLORS: "ampm"}[command]] = data
+        elif command == CMD_MELODY:
+            if data[0] >= state["melodies"]:
+                return 5
+            if apply:
+                state["melody"] = data[0]
+        elif command == CMD_MELODY_NOTES:
+            if not data or len(data) % 4:
+                return 4
+            if apply:
+                state["melodies"] = 2
+                state["melody"] = 1
+        elif command == CMD_WIFI_CREDS:
+            sizes = []
+            pos = 0
+            for _ in range(3):
+                if pos >= len(data) or pos + 1 + data[pos] > len(data):
+                    return 4
+                sizes.append(data[pos])
+                pos += 1 + data[pos]
+            if pos != len(data) or not 1 <= sizes[0] <= 32 or sizes[1] > 64 or sizes[2] not in (0, 17):
+                return 5
+            if apply:
+                state["wifi"].append(data)
+        elif command == CMD_TIMEZONE:
+            if not 1 <= len(data) <= 64:
+                return 4
+            if apply:
+                state["timezone"] = data.decode()
+        elif command not in (CMD_PING, CMD_STATUS):
+            return 3
+        return 0
+
+    def records(self, body, apply, state):
+        pos = 0
+        index = 0
+        while pos < len(body):
+            if pos + 2 > len(body) or pos + 2 + body[pos + 1] > len(body):
+                return 4, index
+            status = self.validate(body[pos], body[pos + 2:pos + 2 + body[pos + 1]], apply, state)
+            if status:
+                return status, index
+            pos += 2 + body[pos + 1]
+            index += 1
+        return 0, index
+
+    def process(self, encoded):
+        payload = parse_frame(encoded)
+        if payload is None:
+            self.errors += 1
+            return
+        sequence = payload[1]
+        if payload[0] != VERSION:
+            self.errors += 1
+            self.reply(sequence, 2, 0, False)
+            return
+        self.frames += 1
+        body = payload[2:]
+        status, index = self.records(body, False, dict(self.state, wifi=list(self.state["wifi"])))
+        if status == 0:
+            status, index = self.records(body, True, self.state)
+            if any(body[p] in (CMD_WIFI_CREDS, CMD_TIMEZONE) for p in self.record_offsets(body)):
+                self.saves += 1
+        add_status = any(body[p] == CMD_STATUS for p in self.record_offsets(body))
+        self.reply(sequence, status, index, add_status)
+
+    @staticmethod
+    def record_offsets(body):
+        pos = 0
+        while pos + 2 <= len(body):
+            yield pos
+            pos += 2 + body[pos + 1]
+
+    def reply(self, sequence, status, index, add_status):
+        body = bytes([status, index])
+        if add_status:
+            alarm = self.state["alarm"]
+            body += STATUS_BLOCK.pack(self.state["time"], alarm[1], alarm[2], alarm[5], alarm[4], self.state["hour_mode"],
+                                      self.state["brightness"], self.state["melody"], self.state["melodies"],
+                                      self.frames, self.errors)
+        # Log text before the reply, like the clock's own output.
+        os.write(self.fd, f"Serial command #{sequence}: status {status}\r\n".encode())
+        payload = bytes([VERSION, sequence]) + body
+        os.write(self.fd, b"\x00" + cobs_encode(payload + struct.pack("<H", crc16(payload))) + b"\x00")
+
+
+def cmd_selftest(_options):
+    import pty
+    import tty
+
+    master, slave = pty.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    device = DeviceEmulator(slave)
+    device.start()
+    port = FdPort(master)
+    failures = []
+
+    def check(name, condition):
+        print(f"  {'PASS' if condition else 'FAIL'}: {name}")
+        if not condition:
+            failures.append(name)
+
+    # COBS round trip, including the 254 byte block boundary and zero runs.
+    for sample in (b"", b"\x00", b"\x00\x00", b"\x11\x00\x22", bytes(range(1, 255)), bytes(range(256)) * 3):
+        check(f"COBS round trip ({len(sample)} bytes)", cobs_decode(cobs_encode(sample)) == sample
+              and 0 not in cobs_encode(sample))
+    check("CRC-16/CCITT-FALSE check value", crc16(b"123456789") == 0x29B1)
+
+    config = {"time": "2026-10-18T14:30:00", "hour_mode": 12, "brightness": 42,
+              "alarm": {"hour": 6, "minute": 45, "repeat": "weekly", "day": 3, "on": True},
+              "on_colors": ["#FF0000"] * NUM_LEDS, "am_color": "#00BFFF", "pm_color": "#4B0082",
+              "notes": [[440, 250], [0, 100], [880, 250]],
+              "wifi": [{"ssid": "Rack-A", "password": "secret1"},
+                       {"ssid": "Rack-B", "password": "secret2", "bssid": "00:11:22:33:44:55"}],
+              "timezone": "EST+5EDT,M3.2.0/2,M11.1.0/2"}
+    records = build_records(config) + [record(CMD_STATUS)]
+    status, index, block = transact(port, b"".join(records), sequence=7, echo_text=False)
+    check("provision in one round trip", status == 0 and block is not None)
+    check("status block: time", block and block["time"] == datetime.datetime(2026, 10, 18, 14, 30))
+    check("status block: alarm", block and block["alarm"] == "06:45 ON weekly")
+    check("status block: brightness & 12 hour", block and block["brightness"] == 42 and block["12 hour"])
+    check("WiFi credentials saved once", len(device.state["wifi"]) == 2 and device.saves == 1)
+
+    # One bad record (alarm hour 25) anywhere in the batch: nothing is applied.
+    before = dict(device.state, wifi=list(device.state["wifi"]))
+    bad = [record(CMD_BRIGHTNESS, [99]), record(CMD_WIFI_CREDS, b"\x01X\x00\x00"),
+           record(CMD_ALARM, [2, 25, 0, 0, 2, 1, 0])]
+    status, index, _ = transact(port, b"".join(bad), sequence=8, echo_text=False)
+    check("bad record rejected with its index", status == 5 and index == 2)
+    check("batch is atomic, nothing applied", device.state == before)
+
+    status, index, _ = transact(port, record(0x7E), sequence=9, echo_text=False)
+    check("unknown command", status == 3 and index == 0)
+
+    # A corrupted frame is dropped without a reply, the next one works.
+    frame = bytearray(make_frame(10, record(CMD_PING)))
+    frame[3] ^= 0x01
+    port.write(bytes(frame))
+    time.sleep(0.3)
+    received = port.read(1024, 0.1)
+    check("corrupted frame ignored", all(parse_frame(c) is None for c in received.split(b"\x00") if c))
+    status, _, block = transact(port, record(CMD_STATUS), sequence=11, echo_text=False)
+    check("recovers after the bad CRC", status == 0 and block["errors"] == 1)
+
+    port.write(b"L3")
+    time.sleep(0.2)
+    check("text outside a frame passes through", bytes(device.text).endswith(b"L3"))
+
+    device.running = False
+    os.close(master)
+    os.close(slave)
+    print("Self test " + ("FAILED: " + ", ".join(failures) if failures else "passed."))
+    return 1 if failures else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    provision = sub.add_parser("provision", help="Send all the settings in the configuration file in one frame")
+    provision.add_argument("config", help="JSON configuration file")
+    status = sub.add_parser("status", help="Read the compact status")
+    for p in (provision, status):
+        p.add_argument("--port", required=True, help="Serial port, e.g. /dev/ttyUSB0 (requires pyserial)")
+        p.add_argument("--baud", type=int, default=115200)
+    provision.set_defaults(func=cmd_provision)
+    status.set_defaults(func=cmd_status)
+
+    selftest = sub.add_parser("selftest", help="Loopback test against a device emulator on a pseudo-terminal")
+    selftest.set_defaults(func=cmd_selftest)
+
+    options = parser.parse_args()
+    sys.exit(options.func(options))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,484 @@
+#!/usr/bin/env python3
+"""Host side detokenizer for the tokenized serial output (SERIAL_TOKENIZED).
+
+The serial output macros write a binary frame instead of text when
+`SERIAL_TOKENIZED` is true, see `SerialTokenLog.h`:
+
+    0x1B | length (u8) | token (u16/u32 LE) | values ...
+
+The printf macros (`SERIAL_PRINTF`, ...) have the token of the format string. The
+stream macros (`SERIAL_STREAM`, `LOG_<MODULE>_<LEVEL>`, `SERIAL_PRINTLN`, ...) have
+the token of the statement's source text, as the preprocessor stringizes it; the
+literal operands of `<<` are in the database, the others are tagged values.
+
+Usage:
+    detokenize.py database [--root DIR] [--dirs lib src] [--bits 32] [-o tokens.csv]
+    detokenize.py decode   [--db tokens.csv] [--bits 32] [FILE | --port /dev/ttyUSB0 [--baud 115200]]
+    detokenize.py report   [--root DIR] [--bits 32] [--exclude lib/BinaryClockWiFi] [--only SERIAL_OUT]
+
+`database` scans the sources for the output macros and writes the token
+database. `decode` converts a captured stream (or a live serial port, needs
+pyserial) to text, all other text passes through unchanged. `report` prints the
+flash saved by the tokens compared with storing the literals.
+"""
+
+import argparse
+import csv
+import re
+import struct
+import sys
+from pathlib import Path
+
+ESCAPE = 0x1B
+MACROS = ("SERIAL_PRINTF", "SERIAL_OUT_PRINTF", "DEBUG_PRINTF")
+STREAM_MACROS = ("SERIAL_STREAM", "SERIAL_OUT_STREAM", "DEBUG_STREAM", "SERIAL_PRINT", "SERIAL_OUT_PRINT", "DEBUG_PRINT")
+LINE_MACROS = ("SERIAL_PRINTLN", "SERIAL_OUT_PRINTLN", "DEBUG_PRINTLN")
+LOG_MACRO = r"LOG_[A-Z]+_(?:ERROR|WARN|INFO|DEBUG|VERBOSE)"
+SOURCE_DIRS = ("lib", "src")
+SOURCE_EXT = (".cpp", ".h", ".ino")
+OPERANDS_MAX = 32
+
+MACRO_RE = re.compile(r"\b(" + "|".join(MACROS) + r")\s*\(")
+STREAM_RE = re.compile(r"\b(" + "|".join(STREAM_MACROS + LINE_MACROS) + "|" + LOG_MACRO + r")\s*\(")
+LITERAL_RE = re.compile(r'\s*"((?:[^"\\]|\\.)*)"')
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(hh|h|ll|l|z|j|t|L)?([diuoxXcsfeEgGp%])")
+
+C_ESCAPES = {"n": "\n", "r": "\r", "t": "\t", "0": "\0", "\\": "\\", '"': '"', "'": "'", "a": "\a", "b": "\b", "f": "\f", "v": "\v"}
+
+
+def token_hash(text, bits=32):
+    """FNV-1a hash, identical to `TokenHash()` in SerialTokenLog.h."""
+    value = 2166136261
+    for byte in text.encode("utf-8"):
+        value ^= byte
+        value = (value * 16777619) & 0xFFFFFFFF
+    if bits == 16:
+        value = (value >> 16) ^ (value & 0xFFFF)
+    return value
+
+
+def unescape_c(text):
+    """Convert the C string literal body to the actual characters."""
+    result = []
+    i = 0
+    while i < len(text):
+        ch = text[i]
+        if ch == "\\" and i + 1 < len(text):
+            nxt = text[i + 1]
+            if nxt == "x":
+                match = re.match(r"[0-9a-fA-F]{1,2}", text[i + 2:])
+                result.append(chr(int(match.group(0), 16)))
+                i += 2 + len(match.group(0))
+                continue
+            result.append(C_ESCAPES.get(nxt, nxt))
+            i += 2
+            continue
+        result.append(ch)
+        i += 1
+    return "".join(result)
+
+
+def source_files(root, dirs=SOURCE_DIRS, exclude=()):
+    """Yield (path, content) of the source files, without the excluded folders."""
+    root = Path(root)
+    excluded = [(root / folder).resolve() for folder in exclude]
+    for folder in dirs:
+        for path in sorted((root / folder).rglob("*")):
+            if path.suffix not in SOURCE_EXT or any(part in excluded for part in path.resolve().parents):
+                continue
+            yield path, path.read_text(encoding="utf-8", errors="replace")
+
+
+def is_code(content, match):
+    """False for a macro in a comment or in a `#define`."""
+    line_start = content.rfind("\n", 0, match.start()) + 1
+    prefix = content[line_start:match.start()].strip()
+    return not (prefix.startswith("//") or prefix.startswith("#define"))
+
+
+def macro_argument(content, pos):
+    """The source of the macro argument starting at `pos` (after the '('), up to the matching ')'."""
+    depth = 1
+    start = pos
+    while pos < len(content):
+        ch = content[pos]
+        if ch in "\"'":
+            pos += 1
+            while pos < len(content) and content[pos] != ch:
+                pos += 2 if content[pos] == "\\" else 1
+        elif content.startswith("//", pos):
+            pos = content.find("\n", pos) - 1
+        elif content.startswith("/*", pos):
+            pos = content.find("*/", pos) + 1
+        elif ch == "(":
+            depth += 1
+        elif ch == ")":
+            depth -= 1
+            if depth == 0:
+                return content[start:pos]
+        pos += 1
+    return None
+
+
+def stringize(source):
+    """The text of `#argument`: comments and white space between tokens are a single space."""
+    source = source.replace("\\\n", "")
+    out = []
+    pos = 0
+    space = False
+    while pos < len(source):
+        ch = source[pos]
+        if ch in "\"'":
+            end = pos + 1
+            while end < len(source) and source[end] != ch:
+                end += 2 if source[end] == "\\" else 1
+            token = source[pos:end + 1]
+            pos = end + 1
+        elif source.startswith("//", pos):
+            end = source.find("\n", pos)
+            pos = len(source) if end < 0 else end
+            space = True
+            continue
+        elif source.startswith("/*", pos):
+            pos = source.find("*/", pos) + 2
+            space = True
+            continue
+        elif ch.isspace():
+            pos += 1
+            space = True
+            continue
+        else:
+            token = ch
+            pos += 1
+        if space and out:
+            out.append(" ")
+        space = False
+        out.append(token)
+    return "".join(out)
+
+
+def split_operands(text):
+    """The operands of `<<` outside of parentheses, brackets and literals, as `TokenOperandEnd()`."""
+    operands = []
+    depth = 0
+    start = 0
+    pos = 0
+    while pos < len(text):
+        ch = text[pos]
+        if ch in "\"'":
+            pos += 1
+            while pos < len(text) and text[pos] != ch:
+                pos += 2 if text[pos] == "\\" else 1
+        elif ch in "([{":
+            depth += 1
+        elif ch in ")]}":
+            depth -= 1
+        elif depth == 0 and text.startswith("<<", pos):
+            operands.append(text[start:pos])
+            start = pos + 2
+            pos += 1
+        pos += 1
+    operands.append(text[start:])
+    return operands
+
+
+def literal_value(operand):
+    """The text of a literal operand, as `TokenIsLiteral()`, or None for a value."""
+    operand = operand.strip(" ")
+    if operand == "endl":
+        return "\r\n"
+    flash = re.fullmatch(r"F *\((.*)\)", operand)
+    if flash:
+        operand = flash.group(1).strip(" ")
+    parts = []
+    pos = 0
+    while pos < len(operand):
+        literal = re.compile(r'"((?:[^"\\]|\\.)*)" *').match(operand, pos)
+        if not literal:
+            return None
+        parts.append(literal.group(1))
+        pos = literal.end()
+    return unescape_c("".join(parts)) if parts else None
+
+
+def scan_streams(root, dirs=SOURCE_DIRS, exclude=(), only=None):
+    """Yield (text, location, macro) for every stream, print and log macro."""
+    for path, content in source_files(root, dirs, exclude):
+        for match in STREAM_RE.finditer(content):
+            if not is_code(content, match) or (only and not re.match(only, match.group(1))):
+                continue
+            argument = macro_argument(content, match.end())
+            if argument is None:
+                continue
+            text = stringize(argument)
+            if match.group(1) in LINE_MACROS:
+                text += " << endl"
+            line = content.count("\n", 0, match.start()) + 1
+            yield text, f"{path.relative_to(root)}:{line}", match.group(1)
+
+
+def scan_sources(root, dirs=SOURCE_DIRS, exclude=(), only=None):
+    """Yield (format, location) for every printf style macro with a literal format."""
+    for path, content in source_files(root, dirs, exclude):
+        for match in MACRO_RE.finditer(content):
+            if not is_code(content, match) or (only and not re.match(only, match.group(1))):
+                continue
+            pos = match.end()
+            parts = []
+            while True:
+                literal = LITERAL_RE.match(content, pos)
+                if not literal:
+                    break
+                parts.append(literal.group(1))
+                pos = literal.end()
+            if not parts:
+                continue
+            line = content.count("\n", 0, match.start()) + 1
+            yield unescape_c("".join(parts)), f"{path.relative_to(root)}:{line}"
+
+
+def build_database(root, bits, dirs=SOURCE_DIRS, exclude=(), only=None):
+    """Return {token: (kind, text, [locations])}, kind is "printf" (text is the format) or
+    "stream" (text is the source text); collisions are reported on stderr."""
+    database = {}
+    entries = [("printf", fmt, location) for fmt, location in scan_sources(root, dirs, exclude, only)]
+    entries += [("stream", text, location) for text, location, _ in scan_streams(root, dirs, exclude, only)]
+    for kind, text, location in entries:
+        token = token_hash(text, bits)
+        if token in database and database[token][:2] != (kind, text):
+            print(f"WARNING: token 0x{token:08X} collision: {location}", file=sys.stderr)
+            continue
+        database.setdefault(token, (kind, text, []))[2].append(location)
+    return database
+
+
+def load_database(path):
+    database = {}
+    with open(path, newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            kind = row.get("kind") or "printf"
+            text = unescape_c(row["format"]) if kind == "printf" else row["format"]
+            database[int(row["token"], 16)] = (kind, text, row["locations"].split(";"))
+    return database
+
+
+def read_varint(data, pos):
+    shift = 0
+    value = 0
+    while pos < len(data):
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return (value >> 1) ^ -(value & 1), pos
+    raise ValueError("truncated varint")
+
+
+def format_frame(fmt, args):
+    """Apply the arguments to the C format string using the argument encoding."""
+    out = []
+    pos = 0
+    last = 0
+    for spec in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:spec.start()])
+        last = spec.end()
+        flags, width, precision, length, conv = spec.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            if conv in "fFeEgG":
+                value = struct.unpack_from("<f", args, pos)[0]
+                pos += 4
+            elif conv == "s":
+                size = args[pos]
+                value = args[pos + 1:pos + 1 + size].decode("latin-1")
+                pos += 1 + size
+            else:
+                value, pos = read_varint(args, pos)
+                if conv in "uoxXp" and value < 0:
+                    value += 1 << (64 if length == "ll" else 32)
+        except (IndexError, ValueError, struct.error):
+            out.append("<truncated>")
+            return "".join(out)
+        py_spec = "%" + (flags or "") + (width if width and width != "*" else "")
+        if precision and precision != "*":
+            py_spec += "." + precision
+        py_spec += {"u": "d", "p": "x", "i": "d"}.get(conv, conv)
+        out.append(py_spec % value)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def read_value(args, pos):
+    """One tagged stream operand, formatted as `Print` prints it."""
+    tag = chr(args[pos])
+    pos += 1
+    if tag == "c":
+        return chr(args[pos]), pos + 1
+    if tag == "f":
+        return "%.2f" % struct.unpack_from("<f", args, pos)[0], pos + 4
+    if tag == "s":
+        size = args[pos]
+        if pos + 1 + size > len(args):
+            raise ValueError("truncated string")
+        return args[pos + 1:pos + 1 + size].decode("latin-1"), pos + 1 + size
+    if tag == "a":
+        if pos + 4 > len(args):
+            raise ValueError("truncated address")
+        return ".".join(str(byte) for byte in args[pos:pos + 4]), pos + 4
+    if tag == "b":
+        base = args[pos]
+        value, pos = read_varint(args, pos + 1)
+        if base != 10 and value < 0:
+            value += 1 << 32
+        digits = {16: "%X", 8: "%o", 10: "%d"}.get(base)
+        return (digits % value) if digits else format(value, "b"), pos
+    if tag in "iuU":
+        value, pos = read_varint(args, pos)
+        if tag != "i" and value < 0:
+            value += 1 << (64 if tag == "U" else 32)
+        return str(value), pos
+    raise ValueError(f"unknown tag {tag!r}")
+
+
+def format_stream(text, args):
+    """The literal operands of the statement and its values, in order."""
+    out = []
+    pos = 0
+    for operand in split_operands(text):
+        literal = literal_value(operand)
+        if literal is not None:
+            out.append(literal)
+            continue
+        try:
+            value, pos = read_value(args, pos)
+        except (IndexError, ValueError, struct.error):
+            value = "<?>"
+            pos = len(args)
+        out.append(value)
+    return "".join(out)
+
+
+def decode_stream(data, database, bits):
+    """Decode a buffer, returns (text, unused_tail) so a live stream can be continued."""
+    token_size = bits // 8
+    out = []
+    pos = 0
+    while pos < len(data):
+        start = data.find(bytes([ESCAPE]), pos)
+        if start < 0:
+            out.append(data[pos:].decode("latin-1"))
+            return "".join(out), b""
+        out.append(data[pos:start].decode("latin-1"))
+        if start + 2 > len(data) or start + 2 + data[start + 1] > len(data):
+            return "".join(out), data[start:]
+        length = data[start + 1]
+        frame = data[start + 2:start + 2 + length]
+        pos = start + 2 + length
+        if length < token_size:
+            out.append(f"<bad frame {frame.hex()}>")
+            continue
+        token = int.from_bytes(frame[:token_size], "little")
+        entry = database.get(token)
+        if entry is None:
+            out.append(f"<unknown token 0x{token:0{token_size * 2}X} {frame[token_size:].hex()}>")
+        else:
+            kind, text = entry[0], entry[1]
+            out.append((format_frame if kind == "printf" else format_stream)(text, frame[token_size:]))
+    return "".join(out), b""
+
+
+def cmd_database(options):
+    database = build_database(options.root, options.bits, options.dirs)
+    output = open(options.output, "w", newline="", encoding="utf-8") if options.output else sys.stdout
+    writer = csv.writer(output)
+    writer.writerow(["token", "kind", "format", "locations"])
+    for token, (kind, text, locations) in sorted(database.items()):
+        if kind == "printf":
+            text = text.encode("unicode_escape").decode("ascii")
+        writer.writerow([f"{token:08X}", kind, text, ";".join(locations)])
+    if options.output:
+        output.close()
+        print(f"{len(database)} tokens written to {options.output}", file=sys.stderr)
+
+
+def cmd_decode(options):
+    database = load_database(options.db) if options.db else build_database(options.root, options.bits, options.dirs)
+    if options.port:
+        import serial  # pyserial, only needed for a live port.
+        port = serial.Serial(options.port, options.baud, timeout=0.1)
+        tail = b""
+        try:
+            while True:
+                text, tail = decode_stream(tail + port.read(4096), database, options.bits)
+                sys.stdout.write(text)
+                sys.stdout.flush()
+        except KeyboardInterrupt:
+            pass
+    else:
+        source = sys.stdin.buffer if options.file in (None, "-") else open(options.file, "rb")
+        text, tail = decode_stream(source.read(), database, options.bits)
+        sys.stdout.write(text)
+        if tail:
+            sys.stdout.write(f"<incomplete frame {tail.hex()}>\n")
+
+
+def literal_bytes(kind, text):
+    """The bytes of the string literals the token replaces (with the terminating 0)."""
+    if kind == "printf":
+        return len(text) + 1
+    literals = (literal_value(operand) for operand in split_operands(text) if operand.strip(" ") != "endl")
+    return sum(len(literal) + 1 for literal in literals if literal is not None)
+
+
+def cmd_report(options):
+    database = build_database(options.root, options.bits, options.dirs, options.exclude, options.only)
+    token_size = options.bits // 8
+    print(f"Token size {options.bits} bit" + (f", excluding {', '.join(options.exclude)}" if options.exclude else "")
+          + (f", macros {options.only}" if options.only else ""))
+    for kind in ("printf", "stream"):
+        entries = [entry for entry in database.values() if entry[0] == kind]
+        sites = sum(len(locations) for _, _, locations in entries)
+        string_bytes = sum(literal_bytes(kind, text) for _, text, _ in entries)
+        token_bytes = token_size * sites
+        print(f"{kind:6s}: {sites:4d} call sites ({len(entries)} unique), literals {string_bytes} bytes,"
+              f" tokens {token_bytes} bytes, saved {string_bytes - token_bytes} bytes")
+    print("Not counted: printf/vsnprintf and Print code removed when nothing else uses it, the")
+    print("tag bytes on the wire, and the per call CPU saved by not formatting on the target.")
+    ranked = sorted(database.items(), key=lambda item: -literal_bytes(item[1][0], item[1][1]))
+    for token, (kind, text, locations) in ranked[:options.top]:
+        print(f"  0x{token:0{token_size * 2}X} {literal_bytes(kind, text):4d} B x{len(locations)}  {text.strip()[:60]!r}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--root", default=str(Path(__file__).resolve().parent.parent), help="Project root folder")
+    parser.add_argument("--bits", type=int, choices=(16, 32), default=32, help="SERIAL_TOKEN_BITS used in the build")
+    parser.add_argument("--dirs", nargs="+", default=list(SOURCE_DIRS), help="Source folders under the root")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    db_parser = sub.add_parser("database", help="Build the token database from the sources")
+    db_parser.add_argument("-o", "--output", help="CSV output file (default: stdout)")
+    db_parser.set_defaults(func=cmd_database)
+
+    decode_parser = sub.add_parser("decode", help="Decode a captured stream or a serial port")
+    decode_parser.add_argument("file", nargs="?", help="Captured binary stream, '-' for stdin")
+    decode_parser.add_argument("--db", help="Token database CSV (default: scan the sources)")
+    decode_parser.add_argument("--port", help="Serial port to read live (requires pyserial)")
+    decode_parser.add_argument("--baud", type=int, default=115200)
+    decode_parser.set_defaults(func=cmd_decode)
+
+    report_parser = sub.add_parser("report", help="Report the flash saved by the tokens")
+    report_parser.add_argument("--exclude", nargs="+", default=[], help="Folders not in the build, e.g. lib/BinaryClockWiFi")
+    report_parser.add_argument("--only", help="Regex of the macros in the build, e.g. SERIAL_OUT")
+    report_parser.add_argument("--top", type=int, default=20, help="The largest entries listed")
+    report_parser.set_defaults(func=cmd_report)
+
+    options = parser.parse_args()
+    options.func(options)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,175 @@
+/// @file HostSocket.h
+/// @brief The sockets of the host loopback tests: the classes that serve the LAN run on real
+///        UDP and TCP sockets on 127.0.0.1, the messages go through the host's network stack.
+/// @details The whole 127.0.0.0/8 is the loopback interface on Linux, a socket bound to
+///          127.0.0.2 is a second client with its own IPv4 address (e.g. its own rate limit).
+///          The times are the host's system clock, µs since 1970-01-01, as `SystemMicros()` on the clock.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_SOCKET_H__
+#define __HOST_SOCKET_H__
+
+#include <arpa/inet.h>                 /// For htonl(), htons(), ntohs()
+#include <netinet/in.h>                /// For sockaddr_in, INADDR_LOOPBACK
+#include <poll.h>                      /// For poll()
+#include <sys/socket.h>                /// For socket(); bind(); sendto(); recvfrom()
+#include <sys/time.h>                  /// For gettimeofday()
+#include <unistd.h>                    /// For close()
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <string>
+
+namespace HostTest
+   {
+   /// @brief The IPv4 address 127.0.0.`host` in network order.
+   inline uint32_t Loopback(uint8_t host = 1)
+      { return htonl((INADDR_LOOPBACK & 0xFFFFFF00UL) | host); }
+
+   /// @brief The system time, µs since 1970-01-01 (UTC).
+   inline int64_t SystemMicros()
+      {
+      struct timeval now;
+      gettimeofday(&now, nullptr);
+      return (int64_t)now.tv_sec * 1000000LL + now.tv_usec;
+      }
+
+   /// @brief A UDP socket bound to a loopback address, closed when it goes out of scope.
+   class UdpSocket
+      {
+   public:
+      /// @brief Open the socket and bind it.
+      /// @param address The IPv4 address (network order), e.g. `Loopback(2)`.
+      /// @param port The UDP port, 0 for one picked by the system (see `get_Port()`).
+      explicit UdpSocket(uint32_t address = Loopback(), uint16_t port = 0)
+         {
+         fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+         struct sockaddr_in local = { };
+         local.sin_family = AF_INET;
+         local.sin_port = htons(port);
+         local.sin_addr.s_addr = address;
+         socklen_t length = sizeof(local);
+         if ((fd < 0) || (bind(fd, (struct sockaddr*)&local, sizeof(local)) < 0)
+                      || (getsockname(fd, (struct sockaddr*)&local, &length) < 0))
+            {
+            Close();
+            return;
+            }
+         this->address = local.sin_addr.s_addr;
+         this->port = ntohs(local.sin_port);
+         }
+
+      ~UdpSocket() { Close(); }
+      UdpSocket(const UdpSocket&) = delete;
+      UdpSocket& operator=(const UdpSocket&) = delete;
+
+      /// @brief Send a datagram.
+      /// @param to The IPv4 address (network order).
+      /// @param toPort The UDP port.
+      /// @return true if it was sent whole.
+      bool SendTo(const uint8_t* data, size_t length, uint32_t to, uint16_t toPort) const
+         {
+         struct sockaddr_in remote = { };
+         remote.sin_family = AF_INET;
+         remote.sin_port = htons(toPort);
+         remote.sin_addr.s_addr = to;
+         return sendto(fd, data, length, 0, (struct sockaddr*)&remote, sizeof(remote)) == (ssize_t)length;
+         }
+
+      /// @brief Wait for a datagram and receive it.
+      /// @param timeoutMs The wait (ms), 0 to only take one already queued.
+      /// @param from Returns the sender's IPv4 address (network order), if not `nullptr`.
+      /// @param fromPort Returns the sender's UDP port, if not `nullptr`.
+      /// @return The length of the datagram, -1 if none came in time.
+      int Receive(uint8_t* data, size_t size, int timeoutMs, uint32_t* from = nullptr, uint16_t* fromPort = nullptr) const
+         {
+         struct pollfd wait = { fd, POLLIN, 0 };
+         if (poll(&wait, 1, timeoutMs) <= 0) { return -1; }
+
+         struct sockaddr_in remote = { };
+         socklen_t length = sizeof(remote);
+         int received = (int)recvfrom(fd, data, size, 0, (struct sockaddr*)&remote, &length);
+         if (from != nullptr) { *from = remote.sin_addr.s_addr; }
+         if (fromPort != nullptr) { *fromPort = ntohs(remote.sin_port); }
+         return received;
+         }
+
+      void Close()
+         {
+         if (fd >= 0) { close(fd); }
+         fd = -1;
+         }
+
+      /// @brief Read only property: true if the socket is open and bound.
+      bool get_IsOpen() const { return fd >= 0; }
+      /// @brief Read only property: The IPv4 address bound (network order).
+      uint32_t get_Address() const { return address; }
+      /// @brief Read only property: The UDP port bound.
+      uint16_t get_Port() const { return port; }
+
+   private:
+      int      fd = -1;
+      uint32_t address = 0;
+      uint16_t port = 0;
+      }; // class UdpSocket
+
+   /// @brief A TCP client connected to a loopback server, closed when it goes out of scope.
+   class TcpClient
+      {
+   public:
+      /// @brief Connect to the server.
+      /// @param port The TCP port of the server on `address`.
+      explicit TcpClient(uint16_t port, uint32_t address = Loopback())
+         {
+         fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+         struct sockaddr_in remote = { };
+         remote.sin_family = AF_INET;
+         remote.sin_port = htons(port);
+         remote.sin_addr.s_addr = address;
+         if ((fd >= 0) && (connect(fd, (struct sockaddr*)&remote, sizeof(remote)) < 0)) { Close(); }
+         }
+
+      ~TcpClient() { Close(); }
+      TcpClient(const TcpClient&) = delete;
+      TcpClient& operator=(const TcpClient&) = delete;
+
+      /// @brief Send the text.
+      /// @return true if it was sent whole.
+      bool Send(const std::string& text) const
+         { return send(fd, text.data(), text.size(), MSG_NOSIGNAL) == (ssize_t)text.size(); }
+
+      /// @brief Receive until the server closes the connection.
+      /// @param timeoutMs The longest wait (ms) for the next data.
+      /// @param closed Returns true if the server closed the connection, false if the wait timed out.
+      /// @return The data received.
+      std::string ReceiveAll(int timeoutMs, bool* closed = nullptr) const
+         {
+         std::string result;
+         char data[512];
+         bool done = false;
+         struct pollfd wait = { fd, POLLIN, 0 };
+         while (!done && (poll(&wait, 1, timeoutMs) > 0))
+            {
+            ssize_t received = recv(fd, data, sizeof(data), 0);
+            if (received > 0) { result.append(data, (size_t)received); }
+            else { done = true; }
+            }
+         if (closed != nullptr) { *closed = done; }
+         return result;
+         }
+
+      void Close()
+         {
+         if (fd >= 0) { close(fd); }
+         fd = -1;
+         }
+
+      /// @brief Read only property: true if the client is connected.
+      bool get_IsOpen() const { return fd >= 0; }
+
+   private:
+      int fd = -1;
+      }; // class TcpClient
+   } // namespace HostTest
+
+#endif // __HOST_SOCKET_H__
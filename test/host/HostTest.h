@@ -0,0 +1,54 @@
+/// @file HostTest.h
+/// @brief The checks of the host tests: the Arduino free classes of the clock run on the host
+///        with virtual time, each test is a small executable run by `ctest`.
+/// @details Each check prints one line, `name ... ok` or `name ... FAILED`; `Result()` prints
+///          PASS or FAIL and is the exit code of the test.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdarg.h>                    /// For va_list, vsnprintf()
+#include <stdio.h>                     /// For printf()
+
+namespace HostTest
+   {
+   /// @brief The number of failed checks.
+   inline int& Failures()
+      {
+      static int failures = 0;
+      return failures;
+      }
+
+   /// @brief Check a condition, print its name and the result.
+   /// @param condition The condition checked.
+   /// @param format The name of the check, a `printf()` format.
+   /// @return The condition.
+   inline bool Check(bool condition, const char* format, ...)
+      {
+      char name[96];
+      va_list args;
+      va_start(args, format);
+      vsnprintf(name, sizeof(name), format, args);
+      va_end(args);
+
+      printf("  %-60s %s\n", name, (condition ? "ok" : "FAILED"));
+      if (!condition) { Failures()++; }
+      return condition;
+      }
+
+   /// @brief Print the title of a test.
+   inline void Title(const char* title)
+      { printf("%s:\n", title); }
+
+   /// @brief Print the result of the test.
+   /// @return The exit code: 0 if every check passed.
+   inline int Result()
+      {
+      printf("%s\n", (Failures() == 0) ? "PASS" : "FAIL");
+      return (Failures() == 0) ? 0 : 1;
+      }
+   } // namespace HostTest
+
+#endif // __HOST_TEST_H__
@@ -0,0 +1,37 @@
+/// @file Adafruit_I2CDevice.h
+/// @brief Host stand-in for the Adafruit BusIO I2C device: no I2C bus on the host, the transfers fail.
+/// @details Only for the `DateTime` and `TimeSpan` code of RTClibPlus (`RTClib.cpp`) built for the
+///          host tests, the RTC chips aren't used.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_ADAFRUIT_I2CDEVICE_H__
+#define __HOST_ADAFRUIT_I2CDEVICE_H__
+
+#include <Arduino.h>
+
+/// @brief The Arduino `Wire` bus.
+class TwoWire { };
+inline TwoWire Wire;
+
+/// @brief An I2C device, every transfer fails.
+class Adafruit_I2CDevice
+   {
+public:
+   Adafruit_I2CDevice(uint8_t address, TwoWire* wire = &Wire) : address(address) { (void)wire; }
+   bool begin(bool addressDetect = true) { (void)addressDetect; return false; }
+   bool write(const uint8_t* buffer, size_t length) { (void)buffer; (void)length; return false; }
+   bool read(uint8_t* buffer, size_t length)
+      {
+      for (size_t i = 0; i < length; i++) { buffer[i] = 0; }
+      return false;
+      }
+   bool write_then_read(const uint8_t* output, size_t outLength, uint8_t* input, size_t inLength)
+      { return write(output, outLength) && read(input, inLength); }
+   uint8_t get_Address() const { return address; }
+
+private:
+   uint8_t address;
+   };
+
+#endif // __HOST_ADAFRUIT_I2CDEVICE_H__
@@ -0,0 +1,177 @@
+/// @file Arduino.h
+/// @brief Host stand-in for the parts of the Arduino core the host tests use: `String`,
+///        `Print` and a `Serial` that keeps what is written.
+/// @details Only for the host tests of the classes that include `<Arduino.h>`, the firmware is
+///          built with the real core.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+#include <stdio.h>                     /// For snprintf()
+#include <string.h>                    /// For strlen(), memcpy()
+#include <string>
+#include <algorithm>                   /// For std::min(), std::max()
+#include <chrono>                      /// For millis()
+#include <poll.h>                      /// For poll(), the `Serial` port
+#include <unistd.h>                    /// For read(), write()
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+// The flash is memory mapped, as on the ESP32.
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+#define memcpy_P memcpy
+
+using std::min;
+using std::max;
+
+/// @brief The milliseconds since the start of the test.
+inline unsigned long millis()
+   {
+   static const auto start = std::chrono::steady_clock::now();
+   return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+   }
+
+/// @brief The Arduino `String`, kept in a `std::string`.
+class String
+   {
+public:
+   String() { }
+   String(const char* text) : value((text != nullptr) ? text : "") { }
+   String(const std::string& text) : value(text) { }
+   explicit String(long number, int base = DEC)
+      {
+      char buffer[24];
+      snprintf(buffer, sizeof(buffer), (base == HEX) ? "%lx" : "%ld", number);
+      value = buffer;
+      }
+
+   const char* c_str() const { return value.c_str(); }
+   unsigned int length() const { return (unsigned int)value.size(); }
+   bool concat(const char* text, unsigned int size) { value.append(text, size); return true; }
+   bool isEmpty() const { return value.empty(); }
+   void clear() { value.clear(); }
+   String& operator+=(const String& text) { value += text.value; return *this; }
+   friend String operator+(const String& left, const String& right) { return String(left.value + right.value); }
+   bool operator==(const String& other) const { return value == other.value; }
+   bool operator!=(const String& other) const { return value != other.value; }
+
+private:
+   std::string value;
+   };
+
+/// @brief The Arduino `Print`, the text formatting of the `print()` overloads.
+class Print
+   {
+public:
+   virtual ~Print() { }
+   virtual size_t write(uint8_t byte) = 0;
+   virtual size_t write(const uint8_t* buffer, size_t size)
+      {
+      for (size_t i = 0; i < size; i++) { write(buffer[i]); }
+      return size;
+      }
+
+   size_t print(const char* text)                { return write((const uint8_t*)text, strlen(text)); }
+   size_t print(const String& text)              { return print(text.c_str()); }
+   size_t print(const __FlashStringHelper* text) { return print(reinterpret_cast<const char*>(text)); }
+   size_t print(char value)                      { return write((uint8_t)value); }
+   size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+   size_t print(int value, int base = DEC)       { return print((long)value, base); }
+   size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+   size_t print(long value, int base = DEC)
+      {
+      if (base != DEC) { return print((unsigned long)value, base); }
+      char buffer[24];
+      return print(format(buffer, sizeof(buffer), "%ld", value));
+      }
+   size_t print(unsigned long value, int base = DEC)
+      {
+      char buffer[24];
+      return print(format(buffer, sizeof(buffer), (base == HEX) ? "%lX" : (base == OCT) ? "%lo" : "%lu", value));
+      }
+   size_t print(double value, int digits = 2)
+      {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+      return print(buffer);
+      }
+   size_t println() { return print("\r\n"); }
+   template<typename T>
+   size_t println(const T& value) { return print(value) + println(); }
+
+private:
+   template<typename T>
+   static const char* format(char* buffer, size_t size, const char* spec, T value)
+      {
+      snprintf(buffer, size, spec, value);
+      return buffer;
+      }
+   };
+
+/// @brief The serial port: keeps everything written. With `set_Port()` it is also a file
+///        descriptor, e.g. the slave side of a pty, the bytes read come from it.
+class HostSerial : public Print
+   {
+public:
+   using Print::write;
+   size_t write(uint8_t byte) override { return write(&byte, 1); }
+   size_t write(const uint8_t* buffer, size_t size) override
+      {
+      output.append((const char*)buffer, size);
+      if ((port >= 0) && (::write(port, buffer, size) < 0)) { return 0; }
+      return size;
+      }
+
+   /// @brief The number of bytes received, never waits.
+   int available()
+      {
+      receive();
+      return (int)input.size();
+      }
+
+   /// @brief The next byte received, -1 if none.
+   int read()
+      {
+      receive();
+      if (input.empty()) { return -1; }
+      int ch = (uint8_t)input[0];
+      input.erase(0, 1);
+      return ch;
+      }
+
+   /// @brief Property: Port - The file descriptor read and written, -1 for none.
+   void set_Port(int value) { port = value; }
+
+   std::string output;                 ///< The bytes written.
+   std::string input;                  ///< The bytes received, not read yet.
+
+private:
+   void receive()
+      {
+      struct pollfd poller = { port, POLLIN, 0 };
+      uint8_t buffer[256];
+      while ((port >= 0) && (poll(&poller, 1, 0) > 0) && (poller.revents & POLLIN))
+         {
+         ssize_t size = ::read(port, buffer, sizeof(buffer));
+         if (size <= 0) { break; }
+         input.append((const char*)buffer, (size_t)size);
+         }
+      }
+
+   int port = -1;                      ///< The file descriptor, -1 for none.
+   };
+
+inline HostSerial Serial;
+
+#endif // __HOST_ARDUINO_H__
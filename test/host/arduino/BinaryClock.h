@@ -0,0 +1,93 @@
+/// @file BinaryClock.h
+/// @brief Host stand-in for the `BinaryClock` class: the properties the serial commands
+///        (`BCSerialCommand`) set and read, kept in memory and counted.
+/// @details Only for `test_serial_command`, the real class needs the shield (RTC, LEDs, buttons).
+///          The built-in commands are applied to these members; `changes` counts every setter
+///          called so a test can check that a rejected frame changed nothing.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_BINARYCLOCK_H__
+#define __HOST_BINARYCLOCK_H__
+
+#include <Arduino.h>
+#include <BinaryClock.Defines.h>       /// BinaryClock project-wide definitions and MACROs.
+#include <BinaryClock.Structs.h>       /// Global structures and enums used by the Binary Clock project.
+#include <FastLED.h>                   /// CRGB, fl::array
+
+#include <functional>
+#include <vector>
+
+namespace BinaryClockShield
+   {
+   /// @brief The state of the settings menu (`BCMenu.h`).
+   enum class SettingsState : uint8_t
+      {
+      Inactive = 0,
+      TimeSettings,
+      AlarmSettings,
+      Processing,
+      Exiting
+      };
+
+   /// @brief The clock properties used by `BCSerialCommand`.
+   class BinaryClock
+      {
+   public:
+      BinaryClock() { RegisterMelody(defaultMelody); }
+
+      void set_Time(DateTime value)                         { time = value; changes++; }
+      DateTime get_Time() const                             { return time; }
+      void set_Alarm(AlarmTime value)                       { alarm = value; changes++; }
+      AlarmTime get_Alarm() const                           { return alarm; }
+      void set_Is12HourFormat(bool value)                   { is12Hour = value; changes++; }
+      bool get_Is12HourFormat() const                       { return is12Hour; }
+      void set_Brightness(uint8_t value)                    { brightness = value; changes++; }
+      uint8_t get_Brightness()                              { return brightness; }
+      void set_OnColors(const fl::array<CRGB, NUM_LEDS>& value)  { onColors = value; changes++; }
+      void set_OffColors(const fl::array<CRGB, NUM_LEDS>& value) { offColors = value; changes++; }
+      void set_AmColor(CRGB value)                          { amColor = value; changes++; }
+      void set_PmColor(CRGB value)                          { pmColor = value; changes++; }
+      void set_Melody(size_t value)                         { if (value < melodyRegistry.size()) { currentMelody = value; changes++; } }
+      size_t get_Melody() const                             { return currentMelody; }
+      size_t get_MelodyCount() const                        { return melodyRegistry.size(); }
+      SettingsState get_SettingsState() const               { return settingsState; }
+
+      size_t RegisterMelody(const std::vector<Note>& melody)
+         {
+         melodyRegistry.emplace_back(std::cref(melody));
+         return melodyRegistry.size() - 1;
+         }
+
+      const std::vector<Note>& GetMelodyById(size_t id) const
+         { return (id < melodyRegistry.size()) ? melodyRegistry[id].get() : defaultMelody; }
+
+      void ReplaceMelody(std::vector<Note>& melody, std::vector<Note>& notes)
+         {
+         melody.swap(notes);
+         replaced++;
+         }
+
+      bool get_IsMelodyPlaying() const                      { return melodyPlaying; }
+
+      DateTime time;
+      AlarmTime alarm;
+      bool is12Hour = false;
+      uint8_t brightness = 20;
+      fl::array<CRGB, NUM_LEDS> onColors;
+      fl::array<CRGB, NUM_LEDS> offColors;
+      CRGB amColor;
+      CRGB pmColor;
+      size_t currentMelody = 0;
+      SettingsState settingsState = SettingsState::Inactive;
+      bool melodyPlaying = false;      ///< The alarm is sounding.
+      unsigned changes = 0;            ///< The number of setters called.
+      unsigned replaced = 0;           ///< The number of `ReplaceMelody()` calls.
+
+   private:
+      std::vector<Note> defaultMelody = { { 440, 250 } };
+      std::vector<std::reference_wrapper<const std::vector<Note>>> melodyRegistry;
+      }; // class BinaryClock
+   } // namespace BinaryClockShield
+
+#endif // __HOST_BINARYCLOCK_H__
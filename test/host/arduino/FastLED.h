@@ -0,0 +1,32 @@
+/// @file FastLED.h
+/// @brief Host stand-in for the parts of FastLED (https://github.com/FastLED/FastLED) the host
+///        tests use: the `CRGB` color and `fl::array`.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_FASTLED_H__
+#define __HOST_FASTLED_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+#include <array>
+
+/// @brief An RGB color.
+struct CRGB
+   {
+   uint8_t r = 0;
+   uint8_t g = 0;
+   uint8_t b = 0;
+
+   CRGB() = default;
+   CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) { }
+   bool operator==(const CRGB& other) const { return (r == other.r) && (g == other.g) && (b == other.b); }
+   bool operator!=(const CRGB& other) const { return !(*this == other); }
+   };
+
+namespace fl
+   {
+   template<typename T, size_t N>
+   using array = std::array<T, N>;
+   }
+
+#endif // __HOST_FASTLED_H__
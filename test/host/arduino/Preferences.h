@@ -0,0 +1,117 @@
+/// @file Preferences.h
+/// @brief Host stand-in for the ESP32 `Preferences` library: the NVS namespaces kept in memory.
+/// @details The namespaces outlive the `Preferences` instances, so a `Begin()` after `End()` reads
+///          back what was written. The writes (`put*()`, `remove()`) are counted and can be made to
+///          fail, as a full or worn NVS partition does.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_PREFERENCES_H__
+#define __HOST_PREFERENCES_H__
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences
+   {
+public:
+   typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+   /// @brief The NVS partition: every namespace, by name.
+   static std::map<std::string, Namespace>& Storage()
+      {
+      static std::map<std::string, Namespace> storage;
+      return storage;
+      }
+
+   static uint32_t writes;             ///< The number of `put*()` and `remove()` calls that changed the NVS.
+   static int failWrites;              ///< The number of the next `put*()` calls that fail, -1 for all.
+
+   bool begin(const char* name, bool readOnly = false, const char* = nullptr)
+      {
+      if (readOnly && (Storage().find(name) == Storage().end())) { return false; }
+
+      space = &Storage()[name];
+      this->readOnly = readOnly;
+      return true;
+      }
+
+   void end()
+      { space = nullptr; }
+
+   bool isKey(const char* key)
+      { return (space != nullptr) && (space->find(key) != space->end()); }
+
+   bool remove(const char* key)
+      {
+      if (readOnly || !isKey(key)) { return false; }
+      space->erase(key);
+      writes++;
+      return true;
+      }
+
+   bool clear()
+      {
+      if ((space == nullptr) || readOnly) { return false; }
+      space->clear();
+      writes++;
+      return true;
+      }
+
+   size_t putBytes(const char* key, const void* value, size_t length)
+      {
+      if ((space == nullptr) || readOnly || failWrite()) { return 0; }
+      const uint8_t* bytes = static_cast<const uint8_t*>(value);
+      (*space)[key].assign(bytes, bytes + length);
+      writes++;
+      return length;
+      }
+
+   size_t getBytesLength(const char* key)
+      { return isKey(key) ? (*space)[key].size() : 0; }
+
+   size_t getBytes(const char* key, void* buffer, size_t maxLength)
+      {
+      size_t length = getBytesLength(key);
+      if ((length == 0) || (length > maxLength)) { return 0; }
+      memcpy(buffer, (*space)[key].data(), length);
+      return length;
+      }
+
+   size_t putUChar(const char* key, uint8_t value)
+      { return putBytes(key, &value, sizeof(value)); }
+
+   uint8_t getUChar(const char* key, uint8_t defaultValue = 0)
+      {
+      uint8_t value = defaultValue;
+      return (getBytes(key, &value, sizeof(value)) == sizeof(value)) ? value : defaultValue;
+      }
+
+   size_t putString(const char* key, const String& value)
+      { return putBytes(key, value.c_str(), value.length() + 1); }
+
+   String getString(const char* key, const String& defaultValue = String())
+      {
+      size_t length = getBytesLength(key);
+      if (length == 0) { return defaultValue; }
+      return String(std::string(reinterpret_cast<const char*>((*space)[key].data()), length - 1));
+      }
+
+private:
+   static bool failWrite()
+      {
+      if (failWrites == 0) { return false; }
+      if (failWrites > 0) { failWrites--; }
+      return true;
+      }
+
+   Namespace* space = nullptr;
+   bool readOnly = false;
+   };
+
+inline uint32_t Preferences::writes = 0;
+inline int Preferences::failWrites = 0;
+
+#endif // __HOST_PREFERENCES_H__
@@ -0,0 +1,42 @@
+/// @file Streaming.h
+/// @brief Host stand-in for the Streaming library (https://github.com/janelia-arduino/Streaming):
+///        `operator<<` on a `Print`, `endl` and `_HEX()`.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_STREAMING_H__
+#define __HOST_STREAMING_H__
+
+#include <Arduino.h>
+
+template<class T>
+inline Print& operator<<(Print& stream, const T& value)
+   {
+   stream.print(value);
+   return stream;
+   }
+
+struct _BASED
+   {
+   long val;
+   int base;
+   _BASED(long value, int base) : val(value), base(base) { }
+   };
+
+#define _HEX(a) _BASED(a, HEX)
+
+inline Print& operator<<(Print& stream, const _BASED& value)
+   {
+   stream.print(value.val, value.base);
+   return stream;
+   }
+
+enum _EndLineCode { endl };
+
+inline Print& operator<<(Print& stream, _EndLineCode)
+   {
+   stream.println();
+   return stream;
+   }
+
+#endif // __HOST_STREAMING_H__
@@ -0,0 +1,122 @@
+/// @file WiFi.h
+/// @brief Host stand-in for the types of the ESP32 `WiFi.h` used by `BinaryClock.Structs.h`:
+///        the authentication modes, the disconnect reasons, `wl_status_t` and `esp_err_t`; and
+///        the `WiFi` state read by the metrics server.
+/// @details The names only, the values aren't those of ESP-IDF except where the structures depend on them.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_WIFI_H__
+#define __HOST_WIFI_H__
+
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#define ESP_OK    0
+#define ESP_FAIL -1
+
+inline const char* esp_err_to_name(esp_err_t error)
+   { return (error == ESP_OK) ? "ESP_OK" : "ESP_FAIL"; }
+
+typedef enum
+   {
+   WIFI_AUTH_OPEN = 0,
+   WIFI_AUTH_WEP,
+   WIFI_AUTH_WPA_PSK,
+   WIFI_AUTH_WPA2_PSK,
+   WIFI_AUTH_WPA_WPA2_PSK,
+   WIFI_AUTH_ENTERPRISE,
+   WIFI_AUTH_WPA3_PSK,
+   WIFI_AUTH_WPA2_WPA3_PSK,
+   WIFI_AUTH_WAPI_PSK,
+   WIFI_AUTH_WPA3_ENT_192,
+   WIFI_AUTH_MAX
+   } wifi_auth_mode_t;
+
+typedef enum
+   {
+   WIFI_REASON_UNSPECIFIED = 1,
+   WIFI_REASON_AUTH_EXPIRE,
+   WIFI_REASON_AUTH_LEAVE,
+   WIFI_REASON_ASSOC_EXPIRE,
+   WIFI_REASON_ASSOC_TOOMANY,
+   WIFI_REASON_NOT_AUTHED,
+   WIFI_REASON_NOT_ASSOCED,
+   WIFI_REASON_ASSOC_LEAVE,
+   WIFI_REASON_ASSOC_NOT_AUTHED,
+   WIFI_REASON_DISASSOC_PWRCAP_BAD,
+   WIFI_REASON_DISASSOC_SUPCHAN_BAD,
+   WIFI_REASON_BSS_TRANSITION_DISASSOC,
+   WIFI_REASON_IE_INVALID,
+   WIFI_REASON_MIC_FAILURE,
+   WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT,
+   WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT,
+   WIFI_REASON_IE_IN_4WAY_DIFFERS,
+   WIFI_REASON_GROUP_CIPHER_INVALID,
+   WIFI_REASON_PAIRWISE_CIPHER_INVALID,
+   WIFI_REASON_AKMP_INVALID,
+   WIFI_REASON_UNSUPP_RSN_IE_VERSION,
+   WIFI_REASON_INVALID_RSN_IE_CAP,
+   WIFI_REASON_802_1X_AUTH_FAILED,
+   WIFI_REASON_CIPHER_SUITE_REJECTED,
+   WIFI_REASON_TDLS_PEER_UNREACHABLE,
+   WIFI_REASON_TDLS_UNSPECIFIED,
+   WIFI_REASON_SSP_REQUESTED_DISASSOC,
+   WIFI_REASON_NO_SSP_ROAMING_AGREEMENT,
+   WIFI_REASON_BAD_CIPHER_OR_AKM,
+   WIFI_REASON_NOT_AUTHORIZED_THIS_LOCATION,
+   WIFI_REASON_SERVICE_CHANGE_PERCLUDES_TS,
+   WIFI_REASON_UNSPECIFIED_QOS,
+   WIFI_REASON_NOT_ENOUGH_BANDWIDTH,
+   WIFI_REASON_MISSING_ACKS,
+   WIFI_REASON_EXCEEDED_TXOP,
+   WIFI_REASON_STA_LEAVING,
+   WIFI_REASON_END_BA,
+   WIFI_REASON_UNKNOWN_BA,
+   WIFI_REASON_TIMEOUT,
+   WIFI_REASON_PEER_INITIATED,
+   WIFI_REASON_AP_INITIATED,
+   WIFI_REASON_INVALID_FT_ACTION_FRAME_COUNT,
+   WIFI_REASON_INVALID_PMKID,
+   WIFI_REASON_INVALID_MDE,
+   WIFI_REASON_INVALID_FTE,
+   WIFI_REASON_TRANSMISSION_LINK_ESTABLISH_FAILED,
+   WIFI_REASON_ALTERATIVE_CHANNEL_OCCUPIED,
+   WIFI_REASON_BEACON_TIMEOUT = 200,
+   WIFI_REASON_NO_AP_FOUND,
+   WIFI_REASON_AUTH_FAIL,
+   WIFI_REASON_ASSOC_FAIL,
+   WIFI_REASON_HANDSHAKE_TIMEOUT,
+   WIFI_REASON_CONNECTION_FAIL,
+   WIFI_REASON_AP_TSF_RESET,
+   WIFI_REASON_ROAMING,
+   WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG,
+   WIFI_REASON_SA_QUERY_TIMEOUT,
+   } wifi_err_reason_t;
+
+typedef enum
+   {
+   WL_NO_SHIELD        = 255,
+   WL_IDLE_STATUS      = 0,
+   WL_NO_SSID_AVAIL    = 1,
+   WL_SCAN_COMPLETED   = 2,
+   WL_CONNECTED        = 3,
+   WL_CONNECT_FAILED   = 4,
+   WL_CONNECTION_LOST  = 5,
+   WL_DISCONNECTED     = 6
+   } wl_status_t;
+
+/// @brief The station state read by `BinaryClockMetrics`, set by the test.
+class HostWiFi
+   {
+public:
+   bool isConnected() const { return connected; }
+   int8_t RSSI() const { return rssi; }
+
+   bool connected = false;
+   int8_t rssi = 0;
+   };
+
+inline HostWiFi WiFi;
+
+#endif // __HOST_WIFI_H__
@@ -0,0 +1,26 @@
+/// @file esp_rom_crc.h
+/// @brief Host stand-in for the ESP32 ROM CRC functions.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_ESP_ROM_CRC_H__
+#define __HOST_ESP_ROM_CRC_H__
+
+#include <stddef.h>                    /// Macros & defines: size_t, NULL, etc.
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+/// @brief CRC-32 (IEEE 802.3), little endian, the same result as the ROM function.
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len)
+   {
+   crc = ~crc;
+   for (uint32_t i = 0; i < len; i++)
+      {
+      crc ^= buf[i];
+      for (int bit = 0; bit < 8; bit++)
+         { crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL))); }
+      }
+
+   return ~crc;
+   }
+
+#endif // __HOST_ESP_ROM_CRC_H__
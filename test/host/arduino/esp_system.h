@@ -0,0 +1,45 @@
+/// @file esp_system.h
+/// @brief Host stand-in for the ESP-IDF system functions: the shutdown handlers of `esp_restart()`
+///        and the free heap, `HostHeap::Free` and `HostHeap::MinFree`.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <WiFi.h>                      /// For esp_err_t, ESP_OK
+
+typedef void (*shutdown_handler_t)(void);
+
+/// @brief The handlers registered, called by `esp_restart()`.
+inline shutdown_handler_t& HostShutdownHandler()
+   {
+   static shutdown_handler_t handler = nullptr;
+   return handler;
+   }
+
+inline esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler)
+   {
+   HostShutdownHandler() = handler;
+   return ESP_OK;
+   }
+
+/// @brief Calls the shutdown handler, the host doesn't restart.
+inline void esp_restart()
+   {
+   if (HostShutdownHandler() != nullptr) { HostShutdownHandler()(); }
+   }
+
+namespace HostHeap
+   {
+   const uint32_t Free    = 180000U;   ///< The free heap (bytes).
+   const uint32_t MinFree = 150000U;   ///< The lowest free heap (bytes) since boot.
+   }
+
+inline uint32_t esp_get_free_heap_size()
+   { return HostHeap::Free; }
+
+inline uint32_t esp_get_minimum_free_heap_size()
+   { return HostHeap::MinFree; }
+
+#endif // __HOST_ESP_SYSTEM_H__
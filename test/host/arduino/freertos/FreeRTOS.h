@@ -0,0 +1,22 @@
+/// @file FreeRTOS.h
+/// @brief Host stand-in for the FreeRTOS types and macros used by the settings: ticks of 1 ms.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>                    /// Integer types: uint8_t; uint16_t; etc.
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdFALSE           0
+#define pdTRUE            1
+#define pdFAIL            0
+#define pdPASS            1
+#define portMAX_DELAY     ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif // __HOST_FREERTOS_H__
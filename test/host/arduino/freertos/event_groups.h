@@ -0,0 +1,37 @@
+/// @file event_groups.h
+/// @brief Host stand-in for the FreeRTOS event groups: the bits, set and cleared, no waiting.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_EVENT_GROUPS_H__
+#define __HOST_EVENT_GROUPS_H__
+
+#include "FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+
+/// @brief An event group: its bits.
+struct HostEventGroup
+   {
+   EventBits_t bits = 0;
+   };
+
+typedef HostEventGroup* EventGroupHandle_t;
+
+inline EventGroupHandle_t xEventGroupCreate()
+   { return new HostEventGroup(); }
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+   { return group->bits |= bits; }
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+   {
+   EventBits_t previous = group->bits;
+   group->bits &= ~bits;
+   return previous;
+   }
+
+inline EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+   { return group->bits; }
+
+#endif // __HOST_EVENT_GROUPS_H__
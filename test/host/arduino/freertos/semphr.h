@@ -0,0 +1,32 @@
+/// @file semphr.h
+/// @brief Host stand-in for the FreeRTOS recursive mutex, a `std::recursive_mutex`.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_SEMPHR_H__
+#define __HOST_SEMPHR_H__
+
+#include "FreeRTOS.h"
+#include <mutex>
+
+typedef std::recursive_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+   { return new std::recursive_mutex(); }
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t)
+   {
+   mutex->lock();
+   return pdTRUE;
+   }
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex)
+   {
+   mutex->unlock();
+   return pdTRUE;
+   }
+
+inline void vSemaphoreDelete(SemaphoreHandle_t mutex)
+   { delete mutex; }
+
+#endif // __HOST_SEMPHR_H__
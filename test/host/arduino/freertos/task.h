@@ -0,0 +1,94 @@
+/// @file task.h
+/// @brief Host stand-in for the FreeRTOS tasks used by the metrics server: a task is a thread.
+/// @details `xTaskCreate()` starts a detached `std::thread` and keeps the handle for
+///          `xTaskGetHandle()`; the task returns after `vTaskDelete(nullptr)`, as the firmware's do.
+///          The stack high water mark is `HostTasks::StackFree`.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_TASK_H__
+#define __HOST_TASK_H__
+
+#include "FreeRTOS.h"
+
+#include <mutex>
+#include <string.h>                    /// For strcmp()
+#include <thread>
+#include <vector>
+
+#define tskIDLE_PRIORITY  ((UBaseType_t)0U)
+
+/// @brief A task: its name and thread, the handle is its address.
+struct HostTask
+   {
+   const char* name;
+   std::thread::id id;
+   };
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* param);
+
+namespace HostTasks
+   {
+   /// @brief The stack high water mark (bytes) of every task.
+   const UBaseType_t StackFree = 1536U;
+
+   /// @brief The tasks running, by name.
+   inline std::vector<TaskHandle_t>& All()
+      {
+      static std::vector<TaskHandle_t> tasks;
+      return tasks;
+      }
+
+   inline std::mutex& Lock()
+      {
+      static std::mutex lock;
+      return lock;
+      }
+   } // namespace HostTasks
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* param,
+                              UBaseType_t priority, TaskHandle_t* created)
+   {
+   (void)stackDepth;
+   (void)priority;
+   // Locked until the thread id is kept: a task that ends at once finds its handle.
+   std::lock_guard<std::mutex> lock(HostTasks::Lock());
+   TaskHandle_t task = new HostTask { name, std::thread::id() };
+   std::thread thread(function, param);
+   task->id = thread.get_id();
+   thread.detach();
+   HostTasks::All().push_back(task);
+   if (created != nullptr) { *created = task; }
+   return pdPASS;
+   }
+
+inline TaskHandle_t xTaskGetHandle(const char* name)
+   {
+   std::lock_guard<std::mutex> lock(HostTasks::Lock());
+   for (TaskHandle_t task : HostTasks::All())
+      {
+      if (strcmp(task->name, name) == 0) { return task; }
+      }
+   return nullptr;
+   }
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+   { return (task != nullptr) ? HostTasks::StackFree : 0; }
+
+/// @brief The handle is forgotten; the thread isn't stopped, a task deletes itself (`nullptr`) and returns.
+inline void vTaskDelete(TaskHandle_t task)
+   {
+   std::lock_guard<std::mutex> lock(HostTasks::Lock());
+   std::vector<TaskHandle_t>& tasks = HostTasks::All();
+   for (size_t i = 0; i < tasks.size(); i++)
+      {
+      if ((tasks[i] == task) || ((task == nullptr) && (tasks[i]->id == std::this_thread::get_id())))
+         {
+         delete tasks[i];
+         tasks.erase(tasks.begin() + (long)i);
+         break;
+         }
+      }
+   }
+
+#endif // __HOST_TASK_H__
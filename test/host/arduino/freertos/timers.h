@@ -0,0 +1,98 @@
+/// @file timers.h
+/// @brief Host stand-in for the FreeRTOS software timers, run with virtual time.
+/// @details A started timer expires when `HostTimers::Advance()` moves the virtual time past its
+///          period; the callback runs on the caller, as it does in the timer service task.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_TIMERS_H__
+#define __HOST_TIMERS_H__
+
+#include "FreeRTOS.h"
+#include <vector>
+
+struct HostTimer;
+typedef HostTimer* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+/// @brief A software timer: the period, the callback and the expiry time while it runs.
+struct HostTimer
+   {
+   TickType_t period;
+   bool autoReload;
+   void* id;
+   TimerCallbackFunction_t callback;
+   bool active = false;
+   TickType_t expiry = 0;
+   };
+
+namespace HostTimers
+   {
+   /// @brief The virtual time, in ticks.
+   inline TickType_t& Now()
+      {
+      static TickType_t now = 0;
+      return now;
+      }
+
+   /// @brief Every timer created.
+   inline std::vector<TimerHandle_t>& All()
+      {
+      static std::vector<TimerHandle_t> timers;
+      return timers;
+      }
+
+   /// @brief Move the virtual time forward, the timers that expire run their callbacks.
+   inline void Advance(TickType_t ticks)
+      {
+      TickType_t end = Now() + ticks;
+      for (bool fired = true; fired; )
+         {
+         fired = false;
+         for (TimerHandle_t timer : All())
+            {
+            if (timer->active && (timer->expiry <= end))
+               {
+               Now() = timer->expiry;
+               timer->active = timer->autoReload;
+               timer->expiry += timer->period;
+               timer->callback(timer);
+               fired = true;
+               }
+            }
+         }
+      Now() = end;
+      }
+   } // namespace HostTimers
+
+inline TimerHandle_t xTimerCreate(const char*, TickType_t period, UBaseType_t autoReload, void* id,
+                                  TimerCallbackFunction_t callback)
+   {
+   TimerHandle_t timer = new HostTimer{ period, autoReload != pdFALSE, id, callback };
+   HostTimers::All().push_back(timer);
+   return timer;
+   }
+
+inline BaseType_t xTimerReset(TimerHandle_t timer, TickType_t)
+   {
+   timer->active = true;
+   timer->expiry = HostTimers::Now() + timer->period;
+   return pdPASS;
+   }
+
+inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait)
+   { return xTimerReset(timer, wait); }
+
+inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t)
+   {
+   timer->active = false;
+   return pdPASS;
+   }
+
+inline BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+   { return timer->active ? pdTRUE : pdFALSE; }
+
+inline void* pvTimerGetTimerID(TimerHandle_t timer)
+   { return timer->id; }
+
+#endif // __HOST_TIMERS_H__
@@ -0,0 +1,17 @@
+/// @file sockets.h
+/// @brief Host stand-in for the lwIP BSD socket API: the host's own sockets.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#ifndef __HOST_LWIP_SOCKETS_H__
+#define __HOST_LWIP_SOCKETS_H__
+
+#include <arpa/inet.h>                 /// For htonl(), htons(), ntohs()
+#include <fcntl.h>                     /// For fcntl(), O_NONBLOCK
+#include <netinet/in.h>                /// For sockaddr_in, INADDR_ANY
+#include <sys/select.h>                /// For select(), fd_set
+#include <sys/socket.h>                /// For socket(); bind(); listen(); accept(); recv(); send()
+#include <sys/time.h>                  /// For timeval
+#include <unistd.h>                    /// For close()
+
+#endif // __HOST_LWIP_SOCKETS_H__
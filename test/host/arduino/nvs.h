@@ -0,0 +1,5 @@
+/// @file nvs.h
+/// @brief Host stand-in for the ESP-IDF NVS header, the host tests use the `Preferences` mock.
+/// @author Chris-70 (2026/10)
+
+#pragma once
@@ -0,0 +1,5 @@
+/// @file pins_arduino.h
+/// @brief Host stand-in for the board pin definitions, no pins on the host.
+/// @author Chris-70 (2026/10)
+
+#pragma once
@@ -0,0 +1,6 @@
+/// @file wstring.h
+/// @brief Host stand-in for the Arduino core `wstring.h`, the `String` class.
+/// @author Chris-70 (2026/10)
+
+#pragma once
+#include <Arduino.h>
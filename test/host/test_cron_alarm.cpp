@@ -0,0 +1,106 @@
+/// @file test_cron_alarm.cpp
+/// @brief Host test of the cron alarm rules (`BCCronAlarm`): the parser, the bitmasks and the
+///        next match search across the month, year and leap day boundaries.
+/// @details The times are unixtime of the RTC local time, built here from the civil date.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCCronAlarm.h>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief The unixtime of a civil date and time (Howard Hinnant's days from civil).
+   uint32_t at(int year, int month, int day, int hour = 0, int minute = 0, int second = 0)
+      {
+      year -= (month <= 2) ? 1 : 0;
+      int era = year / 400;
+      int yoe = year - era * 400;
+      int doy = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+      int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+      uint32_t days = (uint32_t)(era * 146097 + doe - 719468);
+      return days * BCCRON_SECONDS_DAY + hour * 3600UL + minute * 60UL + second;
+      }
+
+   bool valid(const char* expression)
+      { return BCCronAlarm(expression).get_IsValid(); }
+   }
+
+int main()
+   {
+   HostTest::Title("Parse");
+   Check(valid("30 6 * * 1-5"), "\"30 6 * * 1-5\"");
+   Check(valid("*/15 9-17 * * *"), "\"*/15 9-17 * * *\"");
+   Check(valid("0 0 1 jan,Jul *") && valid("0 8 * * MON-FRI"), "month and weekday names, any case");
+   Check(valid("  0 12 * * *  ") && valid("@daily") && valid("@Hourly"), "spaces and the shortcuts");
+   Check(!valid("60 * * * *") && !valid("* 24 * * *") && !valid("* * 0 * *") && !valid("* * * 13 *") && !valid("* * * * 8"),
+         "a value out of range is rejected");
+   Check(!valid("* * * *") && !valid("* * * * * *") && !valid("") && !valid(nullptr), "the wrong number of fields is rejected");
+   Check(!valid("5-1 * * * *") && !valid("*/0 * * * *") && !valid("1,,2 * * * *") && !valid("x * * * *") && !valid("@never"),
+         "a bad range, step, list, value or shortcut is rejected");
+   BCCronAlarm rule("0 0 * * *");
+   Check(!rule.Parse("0 0 * *") && !rule.get_IsValid() && (rule.NextMatch(at(2026, 10, 18)) == 0),
+         "a failed parse clears the rule");
+
+   HostTest::Title("Bitmasks");
+   rule.Parse("*/15 9-17 * * *");
+   Check(rule.get_Minutes() == ((1ULL << 0) | (1ULL << 15) | (1ULL << 30) | (1ULL << 45)), "*/15 minutes: 0x%llX",
+         (unsigned long long)rule.get_Minutes());
+   Check(rule.get_Hours() == 0x3FE00UL, "9-17 hours: 0x%lX", (unsigned long)rule.get_Hours());
+   Check((rule.get_Days() == 0xFFFFFFFEUL) && (rule.get_Months() == 0x1FFE) && (rule.get_Weekdays() == 0x7F), "* day, month and weekday");
+   rule.Parse("30 6 * * MON-FRI");
+   Check((rule.get_Minutes() == (1ULL << 30)) && (rule.get_Hours() == (1UL << 6)) && (rule.get_Weekdays() == 0x3E), "30 6 * * MON-FRI");
+   rule.Parse("0 0 1 JAN,JUL 7");
+   Check((rule.get_Months() == ((1U << 1) | (1U << 7))) && (rule.get_Weekdays() == 0x01), "JAN,JUL months, weekday 7 is Sunday");
+   rule.Parse("10-40/10 0 5/10 * *");
+   Check((rule.get_Minutes() == ((1ULL << 10) | (1ULL << 20) | (1ULL << 30) | (1ULL << 40))) && (rule.get_Days() == ((1UL << 5) | (1UL << 15) | (1UL << 25))),
+         "N-M/S and N/S steps");
+   rule.Parse("@hourly");
+   Check((rule.get_Minutes() == 1) && (rule.get_Hours() == 0xFFFFFFUL), "@hourly is \"0 * * * *\"");
+
+   HostTest::Title("NextMatch");
+   rule.Parse("0 0 1 * *");
+   Check(rule.NextMatch(at(2026, 1, 31, 23, 59, 30)) == at(2026, 2, 1), "monthly, across the month end");
+   Check(rule.NextMatch(at(2026, 2, 1)) == at(2026, 3, 1), "the result is always later than the time");
+   rule.Parse("30 6 * * *");
+   Check(rule.NextMatch(at(2026, 12, 31, 7, 0)) == at(2027, 1, 1, 6, 30), "daily, across the year end");
+   Check(rule.NextMatch(at(2026, 12, 31, 6, 29, 59)) == at(2026, 12, 31, 6, 30), "daily, the same day");
+   rule.Parse("0 12 31 * *");
+   Check(rule.NextMatch(at(2026, 4, 1)) == at(2026, 5, 31, 12, 0), "the 31st skips April");
+   rule.Parse("0 0 29 2 *");
+   Check(rule.NextMatch(at(2026, 3, 1)) == at(2028, 2, 29), "the leap day, two years on");
+   rule.Parse("0 0 31 2 *");
+   Check(rule.NextMatch(at(2026, 3, 1)) == 0, "no match (Feb 31) within the search limit");
+   rule.Parse("0 9 * DEC,JAN *");
+   Check(rule.NextMatch(at(2026, 2, 10)) == at(2026, 12, 1, 9, 0), "the months skipped whole");
+   Check(rule.NextMatch(at(2026, 12, 31, 10, 0)) == at(2027, 1, 1, 9, 0), "December to January");
+
+   HostTest::Title("Day of month and weekday");
+   rule.Parse("0 8 13 * MON");
+   Check(rule.NextMatch(at(2026, 10, 18, 9, 0)) == at(2026, 10, 19, 8, 0), "either one: the Monday (Sun 2026-10-18)");
+   Check(rule.NextMatch(at(2026, 11, 10)) == at(2026, 11, 13, 8, 0), "either one: the 13th (a Friday)");
+   rule.Parse("0 8 * * MON");
+   Check(rule.NextMatch(at(2026, 11, 10)) == at(2026, 11, 16, 8, 0), "the day of month '*': the weekday only");
+   rule.Parse("0 8 13 * *");
+   Check(rule.NextMatch(at(2026, 11, 14)) == at(2026, 12, 13, 8, 0), "the weekday '*': the day of month only");
+   rule.Parse("30 6 * * 1-5");
+   Check(rule.NextMatch(at(2027, 1, 1, 7, 0)) == at(2027, 1, 4, 6, 30), "weekdays, over the weekend (Fri 2027-01-01)");
+   Check(rule.Matches(at(2027, 1, 4, 6, 30, 59)) && !rule.Matches(at(2027, 1, 3, 6, 30)), "Matches(): Monday yes, Sunday no");
+
+   HostTest::Title("*/15 9-17");
+   rule.Parse("*/15 9-17 * * *");
+   Check(rule.NextMatch(at(2026, 10, 19, 8, 50)) == at(2026, 10, 19, 9, 0), "before the hours: 09:00");
+   Check(rule.NextMatch(at(2026, 10, 19, 12, 7)) == at(2026, 10, 19, 12, 15), "in the hours: the next quarter");
+   Check(rule.NextMatch(at(2026, 10, 19, 17, 45)) == at(2026, 10, 20, 9, 0), "after 17:45: the next day at 09:00");
+   Check(rule.Matches(at(2026, 10, 19, 17, 45)) && !rule.Matches(at(2026, 10, 19, 18, 0)) && !rule.Matches(at(2026, 10, 19, 9, 5)),
+         "Matches(): 17:45 yes, 18:00 and 09:05 no");
+   int count = 0;
+   for (uint32_t next = rule.NextMatch(at(2026, 10, 19) - 1); (next != 0) && (next < at(2026, 10, 20)); next = rule.NextMatch(next))
+      { count++; }
+   Check(count == 36, "36 matches in a day: %d", count);
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,203 @@
+/// @file test_dns_cache.cpp
+/// @brief Host test of the DNS cache (`DnsCache`): the query and reply wire format and the cache
+///        rules on virtual time: TTL, serve stale, refresh and the last known good fallback.
+/// @details The resolver is a table of records answered with `ParseReply()` of a reply built here,
+///          the syncs are every 15 minutes with the refresh after each.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <DnsCache.h>
+
+#include <map>
+#include <string>
+#include <string.h>                    /// For memcpy() and strcmp()
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   uint32_t ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      {
+      uint8_t bytes[4] = { a, b, c, d };
+      uint32_t value;
+      memcpy(&value, bytes, 4);        // Network order.
+      return value;
+      }
+
+   /// @brief A stub resolver: A records and CNAMEs, the reply to a query as on the wire.
+   struct Resolver
+      {
+      struct Record
+         {
+         uint32_t address;
+         uint32_t ttlS;
+         };
+      std::map<std::string, Record> records;
+      std::map<std::string, std::pair<std::string, uint32_t>> cnames;
+      bool down = false;
+      uint32_t queries = 0;
+
+      /// @brief Put a resource record: a pointer to the question name, type, class, TTL and data.
+      static size_t putAnswer(uint8_t* out, size_t offset, uint16_t type, uint32_t ttlS, const uint8_t* data, uint16_t length)
+         {
+         const uint8_t head[] = { 0xC0, 12, (uint8_t)(type >> 8), (uint8_t)type, 0, 1,
+                                  (uint8_t)(ttlS >> 24), (uint8_t)(ttlS >> 16), (uint8_t)(ttlS >> 8), (uint8_t)ttlS,
+                                  (uint8_t)(length >> 8), (uint8_t)length };
+         memcpy(out + offset, head, sizeof(head));
+         memcpy(out + offset + sizeof(head), data, length);
+         return offset + sizeof(head) + length;
+         }
+
+      /// @brief Answer a query: the question, then the CNAME (if any) and the A record.
+      size_t Answer(const uint8_t* query, size_t length, const char* name, uint8_t* out)
+         {
+         queries++;
+         memcpy(out, query, length);
+         out[2] = 0x81;
+         out[3] = 0x80;
+         std::string target = name;
+         size_t offset = length;
+         uint16_t answers = 0;
+         auto alias = cnames.find(target);
+         if (alias != cnames.end())
+            {
+            const uint8_t pointer[] = { 0xC0, 12 };    // Any name, the parser skips it.
+            offset = putAnswer(out, offset, 5, alias->second.second, pointer, sizeof(pointer));
+            answers++;
+            target = alias->second.first;
+            }
+         auto record = records.find(target);
+         if (record == records.end())
+            {
+            out[3] = 0x83;             // NXDOMAIN
+            return length;
+            }
+         offset = putAnswer(out, offset, 1, record->second.ttlS, (const uint8_t*)&record->second.address, 4);
+         answers++;
+         out[7] = (uint8_t)answers;
+         return offset;
+         }
+
+      /// @brief Resolve a name as `BinaryClockNTP` does: the query, the reply, `ParseReply()`.
+      bool Resolve(const char* name, uint32_t& address, uint32_t& ttlS)
+         {
+         if (down) { return false; }
+         uint8_t query[DNS_QUERY_SIZE];
+         uint8_t reply[DNS_MESSAGE_SIZE];
+         size_t length = DnsCache::MakeQuery(name, 0x1234, query, sizeof(query));
+         size_t replyLength = Answer(query, length, name, reply);
+         return (length != 0) && (DnsCache::ParseReply(reply, replyLength, 0x1234, address, ttlS) == DnsReply::Address);
+         }
+      };
+
+   /// @brief A lookup as in a sync: the cache, else resolve and store (or count the failure).
+   DnsLookup lookup(DnsCache& cache, Resolver& resolver, const char* name, uint32_t nowMs, uint32_t& address)
+      {
+      DnsLookup result = cache.Lookup(name, nowMs, address);
+      if (result != DnsLookup::Miss) { return result; }
+
+      uint32_t ttlS = 0;
+      if (resolver.Resolve(name, address, ttlS)) { cache.Store(name, address, ttlS, nowMs); }
+      else
+         {
+         cache.Failed();
+         address = 0;
+         }
+      return result;
+      }
+
+   /// @brief The refresh after a sync: resolve the names due again.
+   void refreshDue(DnsCache& cache, Resolver& resolver, uint32_t nowMs)
+      {
+      char name[DNS_CACHE_NAME_SIZE];
+      for (size_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+         {
+         if (!cache.GetDue(i, nowMs, name)) { continue; }
+         uint32_t address = 0;
+         uint32_t ttlS = 0;
+         if (resolver.Resolve(name, address, ttlS)) { cache.Store(name, address, ttlS, nowMs); }
+         else { cache.Failed(); }
+         }
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("DNS cache (stub resolver, virtual time)");
+
+   uint8_t query[DNS_QUERY_SIZE];
+   size_t length = DnsCache::MakeQuery("pool.ntp.org", 0xBEEF, query, sizeof(query));
+   const uint8_t labels[] = { 4, 'p', 'o', 'o', 'l', 3, 'n', 't', 'p', 3, 'o', 'r', 'g', 0, 0, 1, 0, 1 };
+   Check((length == 12 + sizeof(labels)) && (query[0] == 0xBE) && (query[1] == 0xEF) && (query[2] == 0x01) && (query[5] == 1)
+         && (memcmp(query + 12, labels, sizeof(labels)) == 0), "query: header, labels, type A class IN");
+   Check((DnsCache::MakeQuery("bad..name", 1, query, sizeof(query)) == 0) && (DnsCache::MakeQuery("", 1, query, sizeof(query)) == 0),
+         "query: an empty label or name is refused");
+
+   Resolver resolver;
+   resolver.records["pool.test"] = { ipv4(192, 0, 2, 10), 300 };
+   resolver.records["short.test"] = { ipv4(192, 0, 2, 20), 5 };
+   resolver.cnames["time.test"] = { "pool.test", 120 };
+
+   uint32_t address = 0;
+   uint32_t ttlS = 0;
+   Check(resolver.Resolve("pool.test", address, ttlS) && (address == ipv4(192, 0, 2, 10)) && (ttlS == 300), "A record and its TTL");
+   Check(resolver.Resolve("time.test", address, ttlS) && (address == ipv4(192, 0, 2, 10)) && (ttlS == 120), "CNAME chain, the smallest TTL");
+   Check(!resolver.Resolve("none.test", address, ttlS), "unknown name has no address");
+
+   uint8_t reply[DNS_MESSAGE_SIZE];
+   length = DnsCache::MakeQuery("pool.test", 0x1234, query, sizeof(query));
+   size_t replyLength = resolver.Answer(query, length, "pool.test", reply);
+   Check((DnsCache::ParseReply(reply, replyLength, 0x4321, address, ttlS) == DnsReply::Invalid)
+         && (DnsCache::ParseReply(reply, replyLength - 3, 0x1234, address, ttlS) == DnsReply::Invalid),
+         "reply: another ID or truncated is invalid");
+
+   DnsCache cache;
+   resolver.queries = 0;
+   DnsLookup first = lookup(cache, resolver, "pool.test", 0, address);
+   lookup(cache, resolver, "short.test", 0, address);
+   uint32_t inSync = 0;
+   uint32_t nowMs = 0;
+   for (uint32_t step = 1; step <= 96; step++)
+      {
+      nowMs = step * 900000UL;
+      uint32_t queries = resolver.queries;
+      lookup(cache, resolver, "pool.test", nowMs, address);
+      inSync += resolver.queries - queries;
+      refreshDue(cache, resolver, nowMs);
+      }
+   Check((first == DnsLookup::Miss) && (inSync == 0), "no DNS query in a sync after the first");
+   Check((cache.GetHitRate() >= 97) && (cache.get_Stale() == 96), "hit rate %u%% (%u stale)", (unsigned)cache.GetHitRate(),
+         (unsigned)cache.get_Stale());
+   char name[DNS_CACHE_NAME_SIZE];
+   bool shortDue = false;
+   for (size_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+      { shortDue = shortDue || (cache.GetDue(i, nowMs, name) && (strcmp(name, "short.test") == 0)); }
+   Check(!shortDue, "a name not in use isn't refreshed");
+
+   DnsCache clamped;
+   clamped.Store("short.test", ipv4(192, 0, 2, 20), 5, 0);
+   Check((clamped.Lookup("short.test", DNS_CACHE_MIN_TTL_S * 1000UL - 1, address) == DnsLookup::Fresh)
+         && (clamped.Lookup("short.test", DNS_CACHE_MIN_TTL_S * 1000UL, address) == DnsLookup::Stale), "TTL clamped to the minimum");
+
+   resolver.down = true;
+   nowMs += 900000UL;
+   DnsLookup result = lookup(cache, resolver, "pool.test", nowMs, address);
+   refreshDue(cache, resolver, nowMs);
+   Check((result == DnsLookup::Stale) && (address == ipv4(192, 0, 2, 10)) && (cache.get_Failures() == 1),
+         "resolver down, last known good used");
+   Check((lookup(cache, resolver, "other.test", nowMs, address) == DnsLookup::Miss) && (address == 0) && (cache.get_Failures() == 2),
+         "resolver down, a new name fails");
+
+   resolver.down = false;
+   resolver.records["pool.test"] = { ipv4(192, 0, 2, 11), 300 };
+   nowMs += 900000UL;
+   lookup(cache, resolver, "pool.test", nowMs, address);
+   refreshDue(cache, resolver, nowMs);
+   Check((cache.Lookup("pool.test", nowMs + 1000, address) == DnsLookup::Fresh) && (address == ipv4(192, 0, 2, 11)),
+         "the refresh picks up the new address");
+   Check(cache.Lookup("pool.test", nowMs + (300UL + DNS_CACHE_STALE_S) * 1000UL, address) == DnsLookup::Miss, "too old to use, resolved again");
+
+   return HostTest::Result();
+   }
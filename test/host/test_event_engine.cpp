@@ -0,0 +1,179 @@
+/// @file test_event_engine.cpp
+/// @brief Host test of the clock event scheduler (`BCEventEngine`), fast-forwarded on virtual time.
+/// @details The clock side is `BinaryClock::TimeDispatch()`: once per tick one due event is handed
+///          to `loop()` when the previous one was played, the others stay due in the heap.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCEventEngine.h>
+
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   const uint32_t Start = 1798761600UL;   ///< 2027-01-01 00:00:00, on the hour.
+
+   /// @brief Run the ticks from `from` to `to` (inclusive) as `TimeDispatch()` does: at most one
+   ///        event per tick, `loop()` plays it before the next tick.
+   std::vector<ClockEvent> dispatch(BCEventEngine& events, uint32_t from, uint32_t to, std::vector<uint32_t>* when = nullptr)
+      {
+      std::vector<ClockEvent> played;
+      ClockEvent event;
+      for (uint32_t now = from; now <= to; now++)
+         {
+         if (events.PopDue(now, event))
+            {
+            played.push_back(event);
+            if (when != nullptr) { when->push_back(now); }
+            }
+         }
+
+      return played;
+      }
+
+   size_t countType(const std::vector<ClockEvent>& played, EventType type)
+      {
+      size_t count = 0;
+      for (const ClockEvent& event : played) { count += (event.type == type) ? 1 : 0; }
+      return count;
+      }
+
+   /// @brief The next fire time of the first event of the type.
+   uint32_t nextOf(const BCEventEngine& events, EventType type)
+      {
+      for (size_t i = 0; i < events.get_Count(); i++)
+         {
+         if (events.get_Event(i).type == type) { return events.get_Event(i).nextFire; }
+         }
+
+      return UINT32_MAX;
+      }
+
+   /// @brief A day of hourly chimes and a periodic timer, second by second.
+   void testDay()
+      {
+      BCEventEngine events;
+      events.AddChime(Start - 1, 1);
+      events.AddTimer(Start, 600, 2, true);
+      std::vector<uint32_t> when;
+      std::vector<ClockEvent> played = dispatch(events, Start, Start + 86400UL - 1, &when);
+      Check(countType(played, EventType::Chime) == 24, "24 chimes in a day");
+      Check(countType(played, EventType::Timer) == 143, "a 10 min periodic timer: 143 in the day");
+
+      bool onTime = true;
+      for (size_t i = 0; i < played.size(); i++)
+         {
+         uint32_t period = (played[i].type == EventType::Chime) ? BCEVENT_SECONDS_HOUR : 600;
+         onTime = onTime && (((when[i] - Start) % period) <= 1);
+         }
+      Check(onTime, "each one on its tick, or the next one when two are due");
+      }
+
+   /// @brief The events due on the same tick are all played, the highest type first.
+   void testSameTick()
+      {
+      BCEventEngine events;
+      uint32_t hour = Start + BCEVENT_SECONDS_HOUR;
+      events.AddChime(Start, 1);
+      events.AddAlarm(hour, 0, 3, 2);
+      events.AddTimer(hour - 100, 100, 2);
+      events.AddSnooze(hour - 300, 300, 4, 1);
+
+      std::vector<uint32_t> when;
+      std::vector<ClockEvent> played = dispatch(events, hour - 1, hour + 10, &when);
+      Check(played.size() == 4, "4 events due on the same tick, 4 played");
+      Check((played.size() == 4) && (played[0].type == EventType::Alarm) && (played[1].type == EventType::Snooze)
+            && (played[2].type == EventType::Timer) && (played[3].type == EventType::Chime), "alarm, snooze, timer, then chime");
+      Check((when.size() == 4) && (when[0] == hour) && (when[3] == hour + 3), "one per tick from the tick they were due");
+      Check((events.get_Count() == 1) && (events.get_NextFire() == hour + BCEVENT_SECONDS_HOUR), "the chime rescheduled to the next hour");
+
+      // Not taken on the tick: still due on the next ones, in the same order.
+      events.AddAlarm(hour + 20, 0, 3, 1);
+      events.AddTimer(hour + 10, 10, 2);         // The same time, a lower type.
+      ClockEvent event;
+      bool first = events.PopDue(hour + 25, event) && (event.type == EventType::Alarm);
+      Check(first && events.PopDue(hour + 25, event) && (event.type == EventType::Timer) && !events.PopDue(hour + 25, event),
+            "PopDue() until false: every due event, none dropped");
+      }
+
+   /// @brief A jump forward fires a periodic event once, a one shot event fires late.
+   void testJump()
+      {
+      BCEventEngine events;
+      events.AddChime(Start, 1);
+      events.AddTimer(Start, 60, 2, true);
+      events.AddAlarm(Start + 5000, 0, 3, 1);
+      uint32_t later = Start + 10UL * 86400UL + 30;
+      std::vector<ClockEvent> played = dispatch(events, later, later + 2);
+      Check((played.size() == 3) && (countType(played, EventType::Chime) == 1) && (countType(played, EventType::Alarm) == 1),
+            "10 days later: each event once, the oldest first");
+
+      // The next ones on their periods, not counted from the jump.
+      ClockEvent event;
+      Check(!events.PopDue(later + 29, event) && events.PopDue(later + 30, event) && (event.type == EventType::Timer),
+            "the periodic timer keeps its phase");
+      Check(nextOf(events, EventType::Chime) == Start + 10UL * 86400UL + BCEVENT_SECONDS_HOUR, "the chime on the next hour");
+      }
+
+   /// @brief `TimeChanged()`: relative events keep their remaining time, wall clock events move.
+   void testTimeChanged()
+      {
+      BCEventEngine events;
+      events.AddTimer(Start, 100, 2);
+      events.AddChime(Start, 1);
+      events.TimeChanged(Start + 10, Start + 10 + 7200);
+      ClockEvent event;
+      Check(!events.PopDue(Start + 7299, event) && events.PopDue(Start + 7300, event) && (event.type == EventType::Timer),
+            "step forward: the timer keeps its 90 s");
+      Check(events.get_NextFire() == Start + 3 * BCEVENT_SECONDS_HOUR, "step forward: the chime on the next hour");
+
+      events.TimeChanged(Start + 7400, Start + 100);
+      Check(events.get_NextFire() == Start + BCEVENT_SECONDS_HOUR, "step back: the chime back to the next hour");
+      }
+
+   /// @brief Cancel, the ids and a full engine.
+   void testIds()
+      {
+      BCEventEngine events;
+      uint8_t first = events.AddTimer(Start, 10, 1);
+      uint8_t second = events.AddTimer(Start, 20, 1);
+      Check((first != 0) && (second != first) && events.Cancel(first) && !events.Cancel(first) && (events.get_Count() == 1),
+            "Cancel() by id");
+      Check(events.AddTimer(Start, 0, 1) == 0, "a 0 s timer isn't added");
+
+      events.AddSnooze(Start, 300, 1, 1);
+      events.AddSnooze(Start, 600, 1, 1);
+      Check(events.CancelType(EventType::Snooze) == 1, "one snooze at a time");
+
+      bool unique = true;
+      for (int i = 0; i < 300; i++)
+         {
+         uint8_t id = events.AddTimer(Start, 5, 1);
+         unique = unique && (id != 0) && (id != second);
+         events.Cancel(id);
+         }
+      Check(unique, "the ids wrap, never 0 or one in use");
+
+      events.Clear();
+      bool added = true;
+      for (unsigned i = 0; i < BCEVENT_MAX_EVENTS; i++) { added = (events.AddTimer(Start, 10 + i, 1) != 0) && added; }
+      Check(added && (events.AddTimer(Start, 5, 1) == 0), "full at %u events", (unsigned)BCEVENT_MAX_EVENTS);
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Event engine");
+
+   testDay();
+   testSameTick();
+   testJump();
+   testTimeChanged();
+   testIds();
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,277 @@
+/// @file test_leap_second.cpp
+/// @brief Host test of the leap second: the announcements (`LeapSecond`) and the leap made on a
+///        virtual DS3231 (`BCLeapSecond` with `BCTimeSlew`).
+/// @details The clock side is `BinaryClock::TimeDispatch()`: `leapTime()` then `slewTime()` on each
+///          tick. The leap second is in the virtual time, the RTC (like POSIX time) has none, so
+///          after the event the RTC must be a second behind (insert) or ahead (delete) of it.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCLeapSecond.h>
+#include <LeapSecond.h>
+
+#include <math.h>                      /// For fabs()
+#include <stdlib.h>                    /// For abs()
+#include <time.h>                      /// For timegm() and gmtime_r(), the reference calendar.
+#include <set>
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief UTC seconds of a date and time.
+   int64_t utc(int year, int month, int day, int hour = 0, int minute = 0, int second = 0)
+      {
+      struct tm value = { };
+      value.tm_year = year - 1900;
+      value.tm_mon = month - 1;
+      value.tm_mday = day;
+      value.tm_hour = hour;
+      value.tm_min = minute;
+      value.tm_sec = second;
+      return (int64_t)timegm(&value);
+      }
+
+   /// @brief The 1st of the next month with the C library's calendar.
+   int64_t referenceNextMonth(int64_t utcS)
+      {
+      time_t value = (time_t)utcS;
+      struct tm day;
+      gmtime_r(&value, &day);
+      return utc(day.tm_year + 1900 + ((day.tm_mon == 11) ? 1 : 0), (day.tm_mon + 1) % 12 + 1, 1);
+      }
+
+   /// @brief A second shown: 0 - 60 and when it was shown (ms).
+   struct Shown
+      {
+      int label;
+      double at;
+      };
+
+   /// @brief `BinaryClock` on a virtual RTC, in phase with the virtual time at the start.
+   struct Clock
+      {
+      int64_t second;                  ///< The RTC second.
+      double start;                    ///< The virtual time (ms) the RTC second started.
+      double latency = 3.0;            ///< The tick to dispatch latency (ms).
+      BCTimeSlew slew;
+      BCLeapSecond plan;
+      bool showLeap = false;
+      int64_t lastSecond = -1;
+      std::set<int64_t> alarms;
+      std::vector<int64_t> fired;
+      std::vector<Shown> shown;
+
+      explicit Clock(int64_t value) : second(value), start((double)value * 1000.0) { }
+
+      bool blocked(int64_t a, int64_t b) const
+         { return (alarms.count(a) != 0) || (alarms.count(b) != 0); }
+
+      void write(double now, int64_t value)
+         {
+         second = value;
+         start = now;
+         }
+
+      void dispatch(double tick)
+         {
+         double now = tick + latency;
+
+         // leapTime()
+         showLeap = false;
+         if (plan.get_IsPending())
+            {
+            int64_t at = plan.get_AtS();
+            int32_t slewMs = 0;
+            BCLeapAction action = plan.Tick((uint32_t)second, blocked(at, at - 1), slewMs);
+            if ((action == BCLeapAction::Repeat) || (action == BCLeapAction::Skip))
+               {
+               write(now, (action == BCLeapAction::Repeat) ? (at - 1) : at);
+               showLeap = (action == BCLeapAction::Repeat);
+               if ((now - tick) >= BC_SLEW_MIN_MS) { slew.Start(slew.get_Remaining() + (int32_t)(now - tick)); }
+               }
+            else if (action == BCLeapAction::Slew)
+               { slew.Start(slew.get_Remaining() + slewMs); }
+            }
+         shown.push_back({ showLeap ? 60 : (int)(second % 60), now });
+
+         // slewTime()
+         if (!slew.get_IsSlewing() || (second == lastSecond)) { return; }
+         lastSecond = second;
+         int16_t shift = slew.NextShift(blocked(second, second + 1));
+         if (shift == 0) { return; }
+
+         double writeAt = start + BCTimeSlew::WriteAtMs(shift);
+         if (writeAt < now)
+            {
+            slew.Undo(shift);
+            return;
+            }
+         write(writeAt, second + BCTimeSlew::WriteSecond(shift));
+         if (BCTimeSlew::WriteSecond(shift) != 0) { dispatch(writeAt); }   // A gain is dispatched like a tick.
+         }
+
+      void runUntil(int64_t value)
+         {
+         while (second < value)
+            {
+            double tick = start + 1000.0;
+            start = tick;
+            second++;
+            if (alarms.count(second) != 0) { fired.push_back(second); }
+            dispatch(tick);
+            }
+         }
+
+      /// @brief RTC time - POSIX time (ms) at virtual time `now`, the leap second is in the virtual time.
+      double posixOffset(double now, int64_t at, int leap) const
+         {
+         double posix = now;
+         if ((leap > 0) && (now >= (double)at * 1000.0 + 1000.0)) { posix = now - 1000.0; }
+         else if ((leap < 0) && (now >= (double)(at - 1) * 1000.0)) { posix = now + 1000.0; }
+         return ((double)second * 1000.0 + (now - start)) - posix;
+         }
+      };
+
+   /// @brief Each second shown once, in order: 59, 60, 0 (insert); 58, 0 (delete).
+   bool sequenceOk(const std::vector<Shown>& shown, int leap)
+      {
+      for (size_t i = 1; i < shown.size(); i++)
+         {
+         int a = shown[i - 1].label;
+         int b = shown[i].label;
+         if ((leap > 0) && (((a == 59) && (b == 60)) || ((a == 60) && (b == 0)))) { continue; }
+         if ((leap < 0) && (a == 58) && (b == 0)) { continue; }
+         if (b != (a + 1) % 60) { return false; }
+         }
+      return true;
+      }
+
+   bool durationsOk(const std::vector<Shown>& shown)
+      {
+      for (size_t i = 1; i < shown.size(); i++)
+         {
+         double length = shown[i].at - shown[i - 1].at;
+         if ((length < 900.0 - 1.0) || (length > 1100.0 + 1.0)) { return false; }
+         }
+      return true;
+      }
+
+   size_t count(const std::vector<Shown>& shown, int label)
+      {
+      size_t result = 0;
+      for (const Shown& value : shown) { result += (value.label == label) ? 1 : 0; }
+      return result;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Leap second (synthetic announcements, virtual RTC)");
+
+   // The calendar: random times to 2100 and the month boundaries.
+   std::vector<int64_t> times;
+   uint32_t seed = 1;
+   for (int i = 0; i < 2000; i++)
+      {
+      seed = seed * 1664525UL + 1013904223UL;
+      times.push_back((int64_t)(((uint64_t)seed * 4102444800ULL) >> 32));
+      }
+   const int years[] = { 1999, 2000, 2016, 2024, 2100 };
+   for (int year : years)
+      {
+      for (int month = 1; month <= 12; month++)
+         {
+         for (int delta = -1; delta <= 1; delta++) { times.push_back(utc(year, month, 1) + delta); }
+         }
+      }
+   bool calendar = true;
+   for (int64_t value : times) { calendar = calendar && (LeapSecond::NextMonthS(value) == referenceNextMonth(value)); }
+   Check(calendar, "next month start = C library (%u times)", (unsigned)times.size());
+
+   // The announcements, the last day of 2016 (a real leap second).
+   int64_t event = utc(2017, 1, 1);
+   LeapSecond leap;
+   Check(leap.Update(1, event - 12 * 3600) && (leap.get_Leap() == 1), "LI=1 at 2016-12-31 12:00 UTC: insert");
+   Check((leap.get_EventS() == event) && (leap.get_StepS() == event), "  event 2017-01-01 00:00 UTC, step at the event");
+   Check(!leap.Update(1, event - 6 * 3600) && (leap.get_Leap() == 1), "  announced again: unchanged");
+   Check(!leap.Update(3, event - 3600) && (leap.get_Leap() == 1), "  LI=3 (unsynchronized): ignored");
+   Check(leap.Update(0, event - 1800) && (leap.get_Leap() == 0) && (leap.get_EventS() == 0), "  LI=0 before the event: withdrawn");
+
+   Check(leap.Update(2, utc(2024, 6, 30, 20)) && (leap.get_Leap() == -1) && (leap.get_StepS() == utc(2024, 7, 1) - 1),
+         "LI=2 on 2024-06-30: delete, step at 23:59:59");
+   Check(leap.Update(1, utc(2024, 6, 30, 21)) && (leap.get_Leap() == 1), "  changed to LI=1: insert");
+   leap.Applied();
+   Check(!leap.Update(1, utc(2024, 7, 1, 0, 5)) && (leap.get_Leap() == 0) && (leap.get_Applied() == 1),
+         "  applied; LI=1 5 min after: held off");
+   Check(leap.Update(1, utc(2024, 7, 15)) && (leap.get_EventS() == utc(2024, 8, 1)), "  LI=1 two weeks after: next leap 2024-08-01");
+
+   LeapSecond missed;
+   missed.Update(1, event - 3600);
+   Check(missed.Update(0, event + 60) && (missed.get_Leap() == 0), "missed (sync after the event): cleared");
+   Check(!missed.Update(1, event + 120) && (missed.get_Leap() == 0), "  lagging server then: held off");
+
+   // The leap second on the virtual RTC, 2016-12-31 23:59:60 UTC.
+   for (int value : { 1, -1 })
+      {
+      const char* name = (value > 0) ? "insert" : "delete";
+      Clock clock(event - 5);
+      clock.plan.Schedule((uint32_t)event, (int8_t)value);
+      clock.runUntil(event + 10);
+      double end = clock.shown.back().at;
+      Check(sequenceOk(clock.shown, value) && (count(clock.shown, 60) == ((value > 0) ? 1U : 0U))
+            && (count(clock.shown, 59) == ((value > 0) ? 1U : 0U)),
+            "%s: %s", name, (value > 0) ? "59, 60, 0 shown" : "58, 0 shown (59 skipped)");
+      Check(durationsOk(clock.shown), "%s: seconds last 0.9 - 1.1 s", name);
+      Check(fabs(clock.posixOffset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency,
+            "%s: RTC right after the event %.1f ms", name, clock.posixOffset(end, event, value));
+      }
+
+   // An alarm in the second repeated or skipped: slewed out instead, the alarm fires once.
+   for (int value : { 1, -1 })
+      {
+      const char* name = (value > 0) ? "insert" : "delete";
+      int64_t alarm = (value > 0) ? event : (event - 1);
+      Clock clock(event - 5);
+      clock.alarms.insert(alarm);
+      clock.plan.Schedule((uint32_t)event, (int8_t)value);
+      clock.runUntil(event + 30);
+      double end = clock.shown.back().at;
+      Check((count(clock.shown, 60) == 0) && (clock.fired.size() == 1) && (clock.fired[0] == alarm) && sequenceOk(clock.shown, 0),
+            "%s with an alarm in the second: no :60, alarm once", name);
+      Check(!clock.slew.get_IsSlewing() && (fabs(clock.posixOffset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency),
+            "%s with an alarm: slewed, RTC right %.1f ms", name, clock.posixOffset(end, event, value));
+      }
+
+   // Smear over 10 minutes: linear, each second shown once, right at the end.
+   for (int value : { 1, -1 })
+      {
+      const char* name = (value > 0) ? "insert" : "delete";
+      const int64_t smear = 600;
+      Clock clock(event - smear - 5);
+      clock.plan.Schedule((uint32_t)event, (int8_t)value, (uint32_t)smear);
+      clock.runUntil(event - smear / 2);
+      double half = clock.posixOffset(clock.shown.back().at, event, value);
+      Check(fabs(half - (-value * 500)) <= BC_SLEW_MIN_MS + BC_SLEW_STEP_MS, "%s smear %d s: half way %.0f ms", name, (int)smear, half);
+      clock.runUntil(event + 10);
+      double end = clock.shown.back().at;
+      Check((count(clock.shown, 60) == 0) && sequenceOk(clock.shown, 0) && durationsOk(clock.shown),
+            "%s smear: each second once, 0.9 - 1.1 s", name);
+      Check(fabs(clock.posixOffset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency,
+            "%s smear: RTC right after the event %.1f ms", name, clock.posixOffset(end, event, value));
+      }
+
+   // Withdrawn part way through the smear: the part smeared is returned to slew back.
+   BCLeapSecond plan;
+   plan.Schedule((uint32_t)event, 1, 600);
+   int32_t slewMs = 0;
+   for (int64_t second = event - 600; second < event - 300; second++) { plan.Tick((uint32_t)second, false, slewMs); }
+   int32_t smeared = plan.get_SmearedMs();
+   Check((plan.Schedule(0, 0) == smeared) && (abs(smeared + 500) <= BC_SLEW_MIN_MS) && !plan.get_IsPending(),
+         "smear withdrawn half way: %d ms to slew back", (int)-smeared);
+
+   return HostTest::Result();
+   }
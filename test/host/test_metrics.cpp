@@ -0,0 +1,88 @@
+/// @file test_metrics.cpp
+/// @brief Host test of the metrics endpoint: the registry rendered in the Prometheus text format
+///        (`BCMetrics`), the route of a request and the header of the reply (`MetricsHttp`).
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCMetrics.h>
+#include <MetricsHttp.h>
+
+#include <string.h>                    /// For strstr() and strlen()
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief The times `text` is found in `buffer`.
+   int count(const char* buffer, const char* text)
+      {
+      int result = 0;
+      for (const char* at = strstr(buffer, text); at != nullptr; at = strstr(at + 1, text)) { result++; }
+      return result;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Metrics (Prometheus text format, HTTP)");
+
+   bool head = false;
+   Check((MetricsHttp::Route("GET /metrics HTTP/1.1\r\nHost: clock\r\n\r\n", head) == 200) && !head, "GET /metrics: 200");
+   Check((MetricsHttp::Route("HEAD /metrics HTTP/1.0\r\n\r\n", head) == 200) && head, "HEAD /metrics: 200, no body");
+   Check(MetricsHttp::Route("GET /metrics?name[]=bc_ticks_total HTTP/1.1\r\n", head) == 200, "the query string is ignored");
+   Check((MetricsHttp::Route("GET / HTTP/1.1\r\n", head) == 404) && (MetricsHttp::Route("GET /metricsx HTTP/1.1\r\n", head) == 404),
+         "another path: 404");
+   Check(MetricsHttp::Route("POST /metrics HTTP/1.1\r\n", head) == 405, "another method: 405");
+   Check((MetricsHttp::Route("GET /metrics\r\n", head) == 400) && (MetricsHttp::Route("\x16\x03\x01", head) == 400),
+         "not HTTP/1.x (e.g. TLS): 400");
+
+   char header[METRICS_HEADER_SIZE];
+   size_t length = MetricsHttp::Header(200, 1234, header, sizeof(header));
+   Check((length == strlen(header)) && (strncmp(header, "HTTP/1.1 200 OK\r\n", 17) == 0) && (strstr(header, "Content-Length: 1234\r\n") != nullptr)
+         && (strstr(header, METRICS_CONTENT_TYPE) != nullptr) && (strstr(header, "Allow:") == nullptr)
+         && (strcmp(header + length - 4, "\r\n\r\n") == 0), "200: the content type and length");
+   length = MetricsHttp::Header(405, 0, header, sizeof(header));
+   Check((length != 0) && (strstr(header, "405 Method Not Allowed\r\n") != nullptr) && (strstr(header, "Allow: GET, HEAD\r\n") != nullptr)
+         && (strstr(header, "text/plain\r\n") != nullptr), "405: with Allow");
+   Check(MetricsHttp::Header(200, 1234, header, 40) == 0, "a header too large for the buffer: 0");
+
+   BCMetrics& metrics = BCMetrics::get_Instance();
+   static char body[METRICS_BUFFER_SIZE];
+   length = metrics.Render(body, sizeof(body));
+   Check((length == strlen(body)) && (strstr(body, "bc_ticks_total 0\n") != nullptr) && (strstr(body, "bc_ntp_offset_us") == nullptr),
+         "the counters start at 0, an unset gauge isn't rendered");
+
+   metrics.Add(BCMetric::Ticks, 3);
+   metrics.Set(BCMetric::NtpOffsetUs, BCMetrics::Clamp(-5000000000LL));
+   metrics.Max(BCMetric::TickLatencyMaxUs, 120);
+   metrics.Max(BCMetric::TickLatencyMaxUs, 80);
+   metrics.Min(BCMetric::HeapMinFree, 100000);
+   metrics.Min(BCMetric::HeapMinFree, 150000);
+   metrics.Set(BCMetric::TicksMissed, -1);          // A counter at 2^32 - 1.
+   metrics.Set(BCMetric::StackTimeTask, 1024);
+   metrics.Set(BCMetric::StackDutyTask, 2048);
+   length = metrics.Render(body, sizeof(body));
+   Check((strstr(body, "bc_ticks_total 3\n") != nullptr) && (strstr(body, "bc_ticks_missed_total 4294967295\n") != nullptr),
+         "counters are unsigned");
+   Check((strstr(body, "bc_ntp_offset_us -2147483647\n") != nullptr) && (strstr(body, "bc_tick_latency_max_us 120\n") != nullptr)
+         && (strstr(body, "bc_heap_min_free_bytes 100000\n") != nullptr), "gauges: clamped, maximum, minimum");
+   Check((count(body, "# TYPE bc_stack_free_bytes gauge\n") == 1) && (count(body, "# HELP bc_stack_free_bytes ") == 1)
+         && (strstr(body, "bc_stack_free_bytes{task=\"TimeTask\"} 1024\n") != nullptr)
+         && (strstr(body, "bc_stack_free_bytes{task=\"WiFiDutyTask\"} 2048\n") != nullptr)
+         && (strstr(body, "task=\"CallbackTask\"") == nullptr), "HELP and TYPE once for the tasks, a task label each");
+   Check((count(body, "# TYPE ") == count(body, "# HELP ")) && (body[length - 1] == '\n'), "HELP and TYPE in pairs, the last line ended");
+   Check(metrics.Render(body, length) == 0, "a buffer too small: 0");
+
+   // The worst case: every metric set, the longest values.
+   for (uint8_t i = 0; i < static_cast<uint8_t>(BCMetric::Count); i++)
+      {
+      BCMetric metric = static_cast<BCMetric>(i);
+      metrics.Set(metric, (BCMetrics::GetInfo(metric).type == BCMetricType::Counter) ? -1 : (BC_METRIC_UNSET + 1));
+      }
+   length = metrics.Render(body, sizeof(body));
+   Check(length != 0, "the worst case fits %u bytes (%u)", (unsigned)METRICS_BUFFER_SIZE, (unsigned)length);
+
+   return HostTest::Result();
+   }
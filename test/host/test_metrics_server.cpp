@@ -0,0 +1,143 @@
+/// @file test_metrics_server.cpp
+/// @brief Host test of the metrics server (`BinaryClockMetrics`) on a TCP port of 127.0.0.1,
+///        scraped by clients on their own connections: 200, 404, 405, `HEAD`, a request line in
+///        two parts and a silent client that times out.
+/// @details The firmware's `BinaryClockMetrics.cpp` with the stand-ins in arduino/: the server task
+///          is a thread (freertos/task.h), the sockets are the host's (lwip/sockets.h), the heap
+///          and the WiFi state are fixed values (esp_system.h, WiFi.h).
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+#include "HostSocket.h"
+
+#include <BinaryClockMetrics.h>
+#include <WiFi.h>
+#include <esp_system.h>
+
+#include <chrono>
+#include <stdlib.h>                    /// For atoi()
+#include <string>
+#include <thread>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+using HostTest::TcpClient;
+
+namespace
+   {
+   const uint16_t FirstPort = 39100;   ///< The first port tried, the next ones if it's taken.
+
+   /// @brief A reply: the status code, the headers and the body.
+   struct Reply
+      {
+      int status = 0;
+      std::string headers;
+      std::string body;
+      bool closed = false;             ///< The server closed the connection.
+      double seconds = 0.0;            ///< The time from the connect to the close.
+      };
+
+   /// @brief Connect, send the request (in parts) and read the reply until the server closes.
+   Reply scrape(uint16_t port, const std::string& request, const std::string& rest = std::string())
+      {
+      Reply reply;
+      auto start = std::chrono::steady_clock::now();
+      TcpClient client(port);
+      if (!client.get_IsOpen()) { return reply; }
+      if (!request.empty()) { client.Send(request); }
+      if (!rest.empty())
+         {
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+         client.Send(rest);
+         }
+      std::string text = client.ReceiveAll(3 * METRICS_CLIENT_MS, &reply.closed);
+      reply.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      size_t end = text.find("\r\n\r\n");
+      if ((text.compare(0, 9, "HTTP/1.1 ") != 0) || (end == std::string::npos)) { return reply; }
+      reply.status = atoi(text.c_str() + 9);
+      reply.headers = text.substr(0, end + 2);
+      reply.body = text.substr(end + 4);
+      return reply;
+      }
+
+   /// @brief The value of a header, -1 if it's missing.
+   long contentLength(const Reply& reply)
+      {
+      size_t at = reply.headers.find("Content-Length: ");
+      return (at == std::string::npos) ? -1 : atol(reply.headers.c_str() + at + 16);
+      }
+
+   bool has(const std::string& text, const std::string& part)
+      { return text.find(part) != std::string::npos; }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Metrics server on 127.0.0.1");
+
+   BinaryClockMetrics& server = BinaryClockMetrics::get_Instance();
+   uint16_t port = FirstPort;
+   while (!server.Begin(port) && (port < FirstPort + 20)) { port++; }
+   Check(server.get_IsRunning(), "serving on port %u", (unsigned)port);
+   WiFi.connected = true;
+   WiFi.rssi = -61;
+
+   Reply reply = scrape(port, "GET /metrics HTTP/1.1\r\nHost: clock\r\nAccept: */*\r\n\r\n");
+   Check((reply.status == 200) && has(reply.headers, "Content-Type: " METRICS_CONTENT_TYPE "\r\n"), "GET /metrics: 200, the Prometheus text format");
+   Check(reply.closed && (contentLength(reply) == (long)reply.body.size()) && has(reply.headers, "Connection: close\r\n"),
+         "Content-Length %ld, then closed", contentLength(reply));
+   Check(has(reply.body, "# TYPE bc_heap_free_bytes gauge\nbc_heap_free_bytes " + std::to_string(HostHeap::Free) + "\n")
+         && has(reply.body, "bc_heap_min_free_bytes " + std::to_string(HostHeap::MinFree) + "\n")
+         && has(reply.body, "bc_wifi_rssi_dbm -61\n"), "the heap and RSSI sampled on the scrape");
+   Check(has(reply.body, "bc_stack_free_bytes{task=\"MetricsTask\"} " + std::to_string(HostTasks::StackFree) + "\n")
+         && !has(reply.body, "task=\"TimeTask\""), "the stack of its own task, not of a task not running");
+   Check(server.get_Scrapes() == 1, "one scrape counted");
+
+   reply = scrape(port, "HEAD /metrics HTTP/1.0\r\n\r\n");
+   Check((reply.status == 200) && (contentLength(reply) > 0) && reply.body.empty() && reply.closed, "HEAD: 200, the length of the body, no body");
+
+   reply = scrape(port, "GET /metrics?name[]=bc_ticks_total HTTP/1.1\r\n\r\n");
+   Check((reply.status == 200) && (contentLength(reply) == (long)reply.body.size()), "the query string is ignored");
+
+   reply = scrape(port, "GET /favicon.ico HTTP/1.1\r\n\r\n");
+   Check((reply.status == 404) && has(reply.headers, "HTTP/1.1 404 Not Found\r\n") && reply.body.empty() && reply.closed, "another path: 404");
+
+   reply = scrape(port, "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+   Check((reply.status == 405) && has(reply.headers, "Allow: GET, HEAD\r\n") && reply.body.empty(), "another method: 405, Allow: GET, HEAD");
+
+   reply = scrape(port, "\x16\x03\x01\x02\r\n");
+   Check(reply.status == 400, "a TLS hello: 400");
+
+   reply = scrape(port, "GET /met", "rics HTTP/1.1\r\n\r\n");
+   Check(reply.status == 200, "the request line in two parts: 200");
+   Check(server.get_Scrapes() == 4, "4 scrapes counted: %u", (unsigned)server.get_Scrapes());
+
+   HostTest::Title("A silent client");
+   // It holds the server METRICS_CLIENT_MS, the scrape queued behind it is answered after.
+   auto start = std::chrono::steady_clock::now();
+   Reply silent;
+   std::thread quiet([&]() { silent = scrape(port, ""); });
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));
+   reply = scrape(port, "GET /metrics HTTP/1.1\r\n\r\n");
+   double queued = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   quiet.join();
+   const double limit = METRICS_CLIENT_MS / 1000.0;
+   Check(silent.closed && silent.headers.empty() && silent.body.empty(), "closed without a reply");
+   Check((silent.seconds > 0.9 * limit) && (silent.seconds < limit + 0.5), "after METRICS_CLIENT_MS: %.3f s", silent.seconds);
+   Check((reply.status == 200) && (queued > 0.9 * limit), "the next scrape answered after it: %.3f s", queued);
+
+   HostTest::Title("End()");
+   server.End();
+   bool closed = false;
+   for (int i = 0; (i < 40) && !closed; i++)
+      {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      closed = !TcpClient(port).get_IsOpen();
+      }
+   Check(closed && !server.get_IsRunning(), "the port is closed within 2 s");
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));   // The task deletes itself after the close.
+   Check(xTaskGetHandle("MetricsTask") == nullptr, "the task ended");
+
+   return HostTest::Result();
+   }
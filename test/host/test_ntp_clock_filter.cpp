@@ -0,0 +1,110 @@
+/// @file test_ntp_clock_filter.cpp
+/// @brief Host test of the NTP clock filter (`NtpClockFilter`): the intersection algorithm with
+///        a falseticker, a slow or high dispersion server, no majority and a single server.
+/// @details Each server is a sample built with `RootDistance()` from its delay, root delay and
+///          root dispersion, as `SyncTime()` does from the replies.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <NtpClockFilter.h>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief A server reply: the offset, the round trip delay and the server's root delay and dispersion (µs).
+   NtpSample sample(uint8_t server, int64_t offsetUs, int64_t delayUs, int64_t rootDelayUs = 2000, int64_t rootDispersionUs = 1000)
+      {
+      return { offsetUs, delayUs, NtpClockFilter::RootDistance(delayUs, rootDelayUs, rootDispersionUs), server };
+      }
+
+   int64_t magnitude(int64_t value)
+      { return (value < 0) ? -value : value; }
+   }
+
+int main()
+   {
+   NtpClockFilter filter;
+   int64_t offsetUs = 0;
+   size_t best = 0;
+
+   HostTest::Title("RootDistance");
+   Check(NtpClockFilter::RootDistance(20000, 2000, 1000) == 11000 + 1000 + NTP_MIN_DISPERSION_US, "(delay + root delay) / 2 + dispersion + MINDISP");
+   Check(NtpClockFilter::RootDistance(-50, 0, 0) == NTP_MIN_DISPERSION_US, "a negative delay counts as 0");
+
+   HostTest::Title("One liar among 3 servers");
+   filter.Add(sample(0, -42000, 20000));
+   filter.Add(sample(1, -40000, 24000));
+   filter.Add(sample(2, 3600000000LL, 22000));   // An hour off.
+   bool selected = filter.Select(offsetUs, best);
+   Check(selected && (filter.get_Survivors() == 0x3), "the liar is discarded: survivors 0x%X", filter.get_Survivors());
+   Check(selected && (offsetUs >= -42000) && (offsetUs <= -40000), "offset between the truechimers: %lld us", (long long)offsetUs);
+   Check(selected && (best == 0), "best: the smallest distance (server 0)");
+
+   HostTest::Title("One liar among 4 servers");
+   filter.Clear();
+   filter.Add(sample(0, 15000, 30000));
+   filter.Add(sample(1, -250000, 18000));       // 250 ms off, outside the others' intervals.
+   filter.Add(sample(2, 12000, 16000));
+   filter.Add(sample(3, 18000, 40000));
+   selected = filter.Select(offsetUs, best);
+   Check(selected && (filter.get_Survivors() == 0xD), "the liar is discarded: survivors 0x%X", filter.get_Survivors());
+   Check(selected && (offsetUs >= 12000) && (offsetUs <= 18000), "offset between the truechimers: %lld us", (long long)offsetUs);
+   Check(selected && (filter.get_Sample(best).server == 2), "best: server %u", (unsigned)filter.get_Sample(best).server);
+
+   HostTest::Title("A slow or high dispersion server");
+   filter.Clear();
+   filter.Add(sample(0, 1000, 10000));
+   filter.Add(sample(1, 2000, 12000));
+   filter.Add(sample(2, 90000, 400000));         // A slow link: 400 ms round trip.
+   selected = filter.Select(offsetUs, best);
+   Check(selected && (filter.get_Survivors() == 0x7), "the slow server survives, its interval is wide");
+   Check(selected && (magnitude(offsetUs - 1500) < 10000), "its weight is small: offset %lld us", (long long)offsetUs);
+   Check(selected && (best == 0), "best: not the slow server");
+
+   filter.Clear();
+   filter.Add(sample(0, 1000, 10000));
+   filter.Add(sample(1, -60000, 10000, 2000, 500000));   // Half a second of root dispersion.
+   filter.Add(sample(2, 2000, 12000));
+   selected = filter.Select(offsetUs, best);
+   Check(selected && (magnitude(offsetUs - 1500) < 10000), "high dispersion, small weight: offset %lld us", (long long)offsetUs);
+   Check(selected && (filter.get_Sample(best).server != 1), "best: not the high dispersion server");
+
+   HostTest::Title("No majority");
+   filter.Clear();
+   filter.Add(sample(0, 0, 10000));
+   filter.Add(sample(1, 500000, 10000));
+   filter.Add(sample(2, -500000, 10000));
+   Check(!filter.Select(offsetUs, best) && (filter.get_Survivors() == 0), "3 servers, all disagree: no time");
+
+   filter.Clear();
+   filter.Add(sample(0, 0, 10000));
+   filter.Add(sample(1, 1000, 10000));
+   filter.Add(sample(2, 800000, 10000));
+   filter.Add(sample(3, 801000, 10000));
+   Check(!filter.Select(offsetUs, best), "4 servers, 2 against 2: no time");
+
+   filter.Clear();
+   filter.Add(sample(0, 0, 10000));
+   filter.Add(sample(1, 800000, 10000));
+   Check(!filter.Select(offsetUs, best), "2 servers that disagree: no time");
+
+   filter.Clear();
+   Check(!filter.Select(offsetUs, best), "no sample: no time");
+
+   HostTest::Title("A single server");
+   filter.Clear();
+   filter.Add(sample(4, -123456, 30000));
+   selected = filter.Select(offsetUs, best);
+   Check(selected && (offsetUs == -123456) && (best == 0) && (filter.get_Survivors() == 0x1), "its offset is used: %lld us", (long long)offsetUs);
+
+   HostTest::Title("Full");
+   filter.Clear();
+   for (uint8_t i = 0; i < NTP_MAX_SAMPLES; i++) { filter.Add(sample(i, i * 100, 10000)); }
+   Check(!filter.Add(sample(NTP_MAX_SAMPLES, 0, 10000)) && (filter.get_Count() == NTP_MAX_SAMPLES), "a sample over NTP_MAX_SAMPLES is ignored");
+   Check(filter.Select(offsetUs, best) && (filter.get_Survivors() == ((1U << NTP_MAX_SAMPLES) - 1)), "all %u agree", (unsigned)NTP_MAX_SAMPLES);
+
+   return HostTest::Result();
+   }
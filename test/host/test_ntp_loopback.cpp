@@ -0,0 +1,198 @@
+/// @file test_ntp_loopback.cpp
+/// @brief Host test of the NTP server (`NtpResponder`) on a UDP socket on 127.0.0.1, queried by
+///        clients on their own sockets: the offset, the stratum, the reference ID, the KoD RATE
+///        of a burst and the silence of a server without a reference.
+/// @details The server thread is `BinaryClockNtpServer::serve()` on the host: `recvfrom()`, the
+///          system time at receive and transmit, `Respond()`, `sendto()` of a `Reply` or `Kiss`.
+///          The server's clock is the system clock + `ServerOffsetUs`, the clients compute it from
+///          the four timestamps as any NTP client does.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+#include "HostSocket.h"
+
+#include <NtpResponder.h>
+
+#include <atomic>
+#include <string.h>                    /// For memset() and memcmp()
+#include <thread>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+using HostTest::Loopback;
+using HostTest::SystemMicros;
+using HostTest::UdpSocket;
+
+namespace
+   {
+   const int64_t ServerOffsetUs = 250000;   ///< The server's clock is 250 ms ahead of the clients'.
+   const int ReplyWaitMs = 300;             ///< The client's wait for a reply.
+
+   /// @brief A `NtpResponder` serving a UDP socket on 127.0.0.1 from its own thread.
+   class Server
+      {
+   public:
+      explicit Server(const NtpReference& reference)
+         {
+         responder.set_Reference(reference);
+         thread = std::thread([this]() { serve(); });
+         }
+
+      ~Server() { Stop(); }
+
+      /// @brief Stop the thread, the counts of `responder` can be read after.
+      void Stop()
+         {
+         running = false;
+         if (thread.joinable()) { thread.join(); }
+         }
+
+      uint16_t get_Port() const { return socket.get_Port(); }
+
+      NtpResponder responder;
+
+   private:
+      void serve()
+         {
+         uint8_t request[2 * NTP_REPLY_SIZE];
+         uint8_t reply[NTP_REPLY_SIZE];
+         while (running)
+            {
+            uint32_t client = 0;
+            uint16_t clientPort = 0;
+            int received = socket.Receive(request, sizeof(request), 10, &client, &clientPort);
+            int64_t receiveUs = SystemMicros() + ServerOffsetUs;
+            if (received < 0) { continue; }
+
+            NtpResponse response = responder.Respond(request, (size_t)received, client, receiveUs, SystemMicros() + ServerOffsetUs, reply);
+            if ((response == NtpResponse::Reply) || (response == NtpResponse::Kiss))
+               { socket.SendTo(reply, NTP_REPLY_SIZE, client, clientPort); }
+            }
+         }
+
+      UdpSocket socket;
+      std::atomic<bool> running { true };
+      std::thread thread;
+      }; // class Server
+
+   /// @brief A client request (mode 3, version 4) with its transmit time.
+   void makeRequest(uint8_t* request, int64_t transmitUs)
+      {
+      memset(request, 0, NTP_REPLY_SIZE);
+      request[0] = (uint8_t)((4 << 3) | 3);
+      NtpResponder::PutTimestamp(transmitUs, request + 40);
+      }
+
+   /// @brief Read a timestamp back to µs since 1970 (era 0).
+   int64_t getTimestamp(const uint8_t* in)
+      {
+      uint64_t seconds = ((uint64_t)in[0] << 24) | ((uint64_t)in[1] << 16) | ((uint64_t)in[2] << 8) | in[3];
+      uint64_t fraction = ((uint64_t)in[4] << 24) | ((uint64_t)in[5] << 16) | ((uint64_t)in[6] << 8) | in[7];
+      return (int64_t)(seconds - 2208988800ULL) * 1000000LL + (int64_t)((fraction * 1000000ULL + 0x80000000ULL) >> 32);
+      }
+
+   uint32_t get32(const uint8_t* in)
+      { return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3]; }
+
+   NtpReference reference()
+      {
+      NtpReference value;
+      value.stratum = 2;
+      value.refId = 0x0100000A;        // 10.0.0.1 in network order (little endian host).
+      value.refTimeUs = SystemMicros() + ServerOffsetUs - 30000000LL;
+      value.rootDelayUs = 20000;
+      value.rootDispersionUs = 1000;
+      return value;
+      }
+
+   /// @brief One exchange: the request from `client`, the reply and the offset and delay from its timestamps.
+   /// @return true if a reply came, `offsetUs` and `delayUs` are only set for a server reply.
+   bool query(const UdpSocket& client, uint16_t port, uint8_t* reply, int64_t& offsetUs, int64_t& delayUs)
+      {
+      uint8_t request[NTP_REPLY_SIZE];
+      int64_t t1 = SystemMicros();
+      makeRequest(request, t1);
+      if (!client.SendTo(request, sizeof(request), Loopback(), port)) { return false; }
+      if (client.Receive(reply, NTP_REPLY_SIZE, ReplyWaitMs) != (int)NTP_REPLY_SIZE) { return false; }
+      int64_t t4 = SystemMicros();
+
+      int64_t t2 = getTimestamp(reply + 32);
+      int64_t t3 = getTimestamp(reply + 40);
+      offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+      delayUs = (t4 - t1) - (t3 - t2);
+      return memcmp(reply + 24, request + 40, 8) == 0;
+      }
+
+   int64_t magnitude(int64_t value)
+      { return (value < 0) ? -value : value; }
+   } // namespace
+
+int main()
+   {
+   uint8_t reply[NTP_REPLY_SIZE];
+   int64_t offsetUs = 0;
+   int64_t delayUs = 0;
+
+   HostTest::Title("NTP server on 127.0.0.1");
+   Server server(reference());
+   UdpSocket client(Loopback(1));
+   Check(client.get_IsOpen() && (server.get_Port() != 0), "the sockets are bound, server port %u", (unsigned)server.get_Port());
+
+   bool replied = query(client, server.get_Port(), reply, offsetUs, delayUs);
+   Check(replied, "a request is answered, originate = the request's transmit time");
+   // The error of the offset is at most half the round trip.
+   Check(replied && (magnitude(offsetUs - ServerOffsetUs) <= delayUs / 2 + 100), "the offset: %lld us (%lld us delay)",
+         (long long)offsetUs, (long long)delayUs);
+   Check(replied && ((reply[0] & 0x07) == 4) && (((reply[0] >> 3) & 0x07) == 4) && ((reply[0] >> 6) == 0), "mode 4, version 4, no leap");
+   Check(replied && (reply[1] == 2), "stratum 2");
+   Check(replied && (reply[12] == 10) && (reply[13] == 0) && (reply[14] == 0) && (reply[15] == 1), "the reference ID: 10.0.0.1");
+   Check(replied && (get32(reply + 4) == (20000ULL << 16) / 1000000ULL) && (magnitude(getTimestamp(reply + 16) - server.responder.get_Reference().refTimeUs) < 2),
+         "the root delay and the reference time");
+
+   replied = query(client, server.get_Port(), reply, offsetUs, delayUs);
+   Check(replied && (magnitude(offsetUs - ServerOffsetUs) <= delayUs / 2 + 100), "again: %lld us", (long long)offsetUs);
+
+   HostTest::Title("A burst from 127.0.0.2");
+   UdpSocket burst(Loopback(2));
+   uint8_t request[NTP_REPLY_SIZE];
+   makeRequest(request, SystemMicros());
+   const int sent = (int)NTP_SERVER_BURST + 4;
+   for (int i = 0; i < sent; i++) { burst.SendTo(request, sizeof(request), Loopback(), server.get_Port()); }
+   int replies = 0;
+   int kisses = 0;
+   int others = 0;
+   uint32_t from = 0;
+   while (burst.Receive(reply, sizeof(reply), ReplyWaitMs, &from) == (int)NTP_REPLY_SIZE)
+      {
+      if ((reply[1] == 0) && (memcmp(reply + 12, "RATE", 4) == 0)) { kisses++; }
+      else if (reply[1] == 2) { replies++; }
+      else { others++; }
+      }
+   Check((replies == (int)NTP_SERVER_BURST) && (kisses == 1) && (others == 0), "%d requests: %d replies, %d KoD RATE, the rest dropped",
+         sent, replies, kisses);
+   Check(from == Loopback(), "the replies are from 127.0.0.1");
+   replied = query(client, server.get_Port(), reply, offsetUs, delayUs);
+   Check(replied && (reply[1] == 2), "127.0.0.1 has its own bucket, still answered");
+
+   server.Stop();
+   Check((server.responder.GetCount(NtpResponse::Kiss) == 1) && (server.responder.GetCount(NtpResponse::Limited) == (uint32_t)(sent - replies - 1)),
+         "the server counted the KoD and the drops");
+
+   HostTest::Title("A server without a reference");
+   Server unsynced(NtpReference { });
+   replied = query(client, unsynced.get_Port(), reply, offsetUs, delayUs);
+   Check(!replied, "no reply in %d ms, the client tries another server", ReplyWaitMs);
+
+   NtpReference stale = reference();
+   stale.refTimeUs -= (int64_t)(NTP_SERVER_MAX_AGE_S + 1) * 1000000LL;
+   Server old(stale);
+   replied = query(client, old.get_Port(), reply, offsetUs, delayUs);
+   Check(!replied, "a reference too old: no reply either");
+   unsynced.Stop();
+   old.Stop();
+   Check((unsynced.responder.GetCount(NtpResponse::Unsynced) == 1) && (old.responder.GetCount(NtpResponse::Unsynced) == 1),
+         "the requests were received, counted Unsynced");
+   Check(client.Receive(reply, sizeof(reply), 0) < 0, "nothing came late");
+
+   return HostTest::Result();
+   }
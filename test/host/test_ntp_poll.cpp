@@ -0,0 +1,104 @@
+/// @file test_ntp_poll.cpp
+/// @brief Host test of the adaptive NTP poll interval (`NtpPollController`) on synthetic drift traces.
+/// @details The clock drifts `ppm`, each sync measures the drift over the interval plus gaussian
+///          network noise; the trace may change the drift part way or send a Kiss-o'-Death RATE.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <NtpPollController.h>
+
+#include <math.h>                      /// For fabs()
+#include <random>
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief A sync of the trace: the offset measured (µs) and the poll exponent after it.
+   struct Sync
+      {
+      double offsetUs;
+      int8_t poll;
+      };
+
+   /// @brief Run the controller on a drift trace.
+   /// @param ppm The drift.
+   /// @param noiseUs The standard deviation of the network noise.
+   /// @param steps The syncs.
+   /// @param changeAt The sync the drift changes to `changePpm`, -1 none.
+   /// @param kodAt The sync answered with a KoD RATE of poll `kodPoll`, -1 none.
+   std::vector<Sync> driftTrace(double ppm, double noiseUs = 2000.0, int steps = 60, int changeAt = -1, double changePpm = 0.0,
+                                int kodAt = -1, int8_t kodPoll = 0)
+      {
+      std::mt19937 random(1);
+      std::normal_distribution<double> noise(0.0, noiseUs);
+      NtpPollController controller;
+      uint32_t interval = controller.get_Interval();
+      std::vector<Sync> trace;
+      for (int step = 0; step < steps; step++)
+         {
+         if (step == changeAt) { ppm = changePpm; }
+         double offsetUs = ppm * (double)interval + noise(random);
+         interval = (step == kodAt) ? controller.RateLimit(kodPoll) : controller.Update((int64_t)offsetUs, interval);
+         trace.push_back({ offsetUs, controller.get_Poll() });
+         }
+      return trace;
+      }
+
+   /// @brief The largest offset (µs) after the first 10 syncs.
+   double settled(const std::vector<Sync>& trace)
+      {
+      double result = 0.0;
+      for (size_t i = 10; i < trace.size(); i++) { result = fmax(result, fabs(trace[i].offsetUs)); }
+      return result;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("NTP poll interval (synthetic drift traces)");
+
+   std::vector<Sync> trace = driftTrace(2.0);
+   Check((trace.back().poll == 14) && (settled(trace) < NTP_OFFSET_TOLERANCE_US), "2 ppm (DS3231): poll grows to 2^14");
+   trace = driftTrace(20.0);
+   Check((trace.back().poll == 11) && (settled(trace) < NTP_OFFSET_TOLERANCE_US), "20 ppm crystal: poll held at 2^11");
+   trace = driftTrace(0.0, 100.0);
+   Check(trace.back().poll == NTP_MAX_POLL, "no drift: poll grows to the maximum 2^%d", NTP_MAX_POLL);
+   trace = driftTrace(2.0, 2000.0, 60, 30, 50.0);
+   Check((trace[29].poll == 14) && (trace.back().poll <= 9) && (fabs(trace.back().offsetUs) < NTP_OFFSET_TOLERANCE_US),
+         "drift change 2 -> 50 ppm: poll shrinks");
+   trace = driftTrace(2.0, 80000.0);
+   Check(trace.back().poll < NTP_START_POLL, "jitter above the tolerance: poll shrinks");
+   trace = driftTrace(20.0, 2000.0, 8, -1, 0.0, 3, 13);
+   bool floor = true;
+   for (size_t i = 3; i < trace.size(); i++) { floor = floor && (trace[i].poll >= 13); }
+   Check(floor, "KoD RATE: poll not below the server's");
+   trace = driftTrace(20.0, 2000.0, 60, -1, 0.0, 3, 13);
+   bool held = true;
+   for (int i = 3; i < 3 + NTP_RATE_HOLD; i++) { held = held && (trace[i].poll >= 13); }
+   Check(held && (trace.back().poll == 11), "KoD RATE: floor held %d polls, then back to 2^11", NTP_RATE_HOLD);
+
+   NtpPollController rate;
+   rate.RateLimit(14);
+   for (int i = 0; i < NTP_RATE_HOLD - 1; i++) { rate.Update(0, rate.get_Interval()); }
+   rate.RateLimit(14);
+   int8_t rateFloor = rate.get_RateFloor();
+   for (int i = 0; i < NTP_RATE_HOLD - 1; i++) { rate.Update(0, rate.get_Interval()); }
+   bool restarted = (rateFloor >= 14) && (rate.get_RateFloor() == rateFloor);
+   rate.Update(0, rate.get_Interval());
+   Check(restarted && (rate.get_RateFloor() == rateFloor - 1), "another KoD RATE restarts the hold-off");
+   rate.Reset();
+   Check(rate.get_RateFloor() == NTP_MIN_POLL, "reset: no rate floor");
+
+   NtpPollController controller;
+   controller.Failed();
+   controller.Failed();
+   Check(controller.get_Poll() == NTP_START_POLL - 2, "a failed sync halves the interval");
+   controller.Reset();
+   Check(controller.get_Poll() == NTP_START_POLL, "reset: the starting interval");
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,122 @@
+/// @file test_ntp_responder.cpp
+/// @brief Host test of the server side of NTP (`NtpResponder`): the replies, the offset and delay a
+///        client computes from them, and the rate limits on virtual time.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <NtpResponder.h>
+
+#include <string.h>                    /// For memset() and memcpy()
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   const int64_t NowUs = 1790000000LL * 1000000LL;   ///< The virtual time at the start, 2026.
+
+   /// @brief A client request (mode 3) with its transmit time.
+   void makeRequest(uint8_t* request, int64_t transmitUs, uint8_t version = 4, int8_t poll = 10)
+      {
+      memset(request, 0, NTP_REPLY_SIZE);
+      request[0] = (uint8_t)((version << 3) | 3);
+      request[2] = (uint8_t)poll;
+      NtpResponder::PutTimestamp(transmitUs, request + 40);
+      }
+
+   /// @brief Read a timestamp back to µs since 1970 (era 0).
+   int64_t getTimestamp(const uint8_t* in)
+      {
+      uint64_t seconds = ((uint64_t)in[0] << 24) | ((uint64_t)in[1] << 16) | ((uint64_t)in[2] << 8) | in[3];
+      uint64_t fraction = ((uint64_t)in[4] << 24) | ((uint64_t)in[5] << 16) | ((uint64_t)in[6] << 8) | in[7];
+      return (int64_t)(seconds - 2208988800ULL) * 1000000LL + (int64_t)((fraction * 1000000ULL + 0x80000000ULL) >> 32);
+      }
+
+   uint32_t get32(const uint8_t* in)
+      { return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3]; }
+
+   NtpReference reference(int64_t refTimeUs)
+      {
+      NtpReference value;
+      value.stratum = 2;
+      value.refId = 0x0100000A;        // 10.0.0.1 in network order (little endian host).
+      value.refTimeUs = refTimeUs;
+      value.rootDelayUs = 20000;
+      value.rootDispersionUs = 1000;
+      return value;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("NTP responder (virtual time)");
+
+   uint8_t request[NTP_REPLY_SIZE];
+   uint8_t reply[NTP_REPLY_SIZE];
+   int64_t stamp = 1700000000LL * 1000000LL + 123456;
+   NtpResponder::PutTimestamp(stamp, reply);
+   Check(getTimestamp(reply) == stamp, "timestamp round trip");
+
+   NtpResponder responder;
+   makeRequest(request, NowUs);
+   Check(responder.Respond(request, sizeof(request), 1, NowUs, NowUs, reply) == NtpResponse::Unsynced, "no reference: nothing served");
+
+   responder.set_Reference(reference(NowUs - 60000000LL));
+   // The client is 250 ms behind, 20 ms round trip: T1 client, T2/T3 server, T4 client.
+   const int64_t clientOffsetUs = -250000;
+   int64_t t1 = NowUs + clientOffsetUs;
+   makeRequest(request, t1);
+   int64_t t2 = NowUs + 10000;
+   int64_t t3 = t2 + 300;
+   NtpResponse response = responder.Respond(request, sizeof(request), 1, t2, t3, reply);
+   int64_t t4 = t3 + 10000 + clientOffsetUs;
+   int64_t offset = ((getTimestamp(reply + 32) - getTimestamp(reply + 24)) + (getTimestamp(reply + 40) - t4)) / 2;
+   int64_t delay = (t4 - getTimestamp(reply + 24)) - (getTimestamp(reply + 40) - getTimestamp(reply + 32));
+   Check(response == NtpResponse::Reply, "a client request is answered");
+   Check(((reply[0] & 0x07) == 4) && (((reply[0] >> 3) & 0x07) == 4) && (reply[1] == 2), "mode 4, the version, stratum 2");
+   Check(memcmp(reply + 24, request + 40, 8) == 0, "originate = the client's transmit time");
+   Check((offset > -clientOffsetUs - 2) && (offset < -clientOffsetUs + 2) && (delay > 19998) && (delay < 20002),
+         "the client's offset and delay (%lld us, %lld us)", (long long)offset, (long long)delay);
+   Check((get32(reply + 4) == (20000ULL << 16) / 1000000ULL) && (get32(reply + 8) > (1000ULL << 16) / 1000000ULL),
+         "root delay; root dispersion grows");
+   Check(memcmp(reply + 12, &responder.get_Reference().refId, 4) == 0, "the reference ID");
+
+   request[0] = (uint8_t)((4 << 3) | 4);
+   Check(responder.Respond(request, sizeof(request), 1, t2, t3, reply) == NtpResponse::Invalid, "a server packet is ignored");
+   Check(responder.Respond(request, 12, 1, t2, t3, reply) == NtpResponse::Invalid, "a short packet is ignored");
+
+   responder.set_Reference(reference(NowUs - (int64_t)(NTP_SERVER_MAX_AGE_S + 1) * 1000000LL));
+   makeRequest(request, NowUs);
+   Check(responder.Respond(request, sizeof(request), 1, NowUs, NowUs, reply) == NtpResponse::Unsynced, "a reference too old isn't served");
+
+   // A burst of 8, then a KoD RATE, then dropped; the bucket drains at one request per interval.
+   NtpResponder limited;
+   limited.set_Reference(reference(NowUs));
+   int replies = 0;
+   int kisses = 0;
+   int dropped = 0;
+   for (int i = 0; i < 12; i++)
+      {
+      NtpResponse value = limited.Respond(request, sizeof(request), 7, NowUs + i * 1000, NowUs + i * 1000, reply);
+      replies += (value == NtpResponse::Reply) ? 1 : 0;
+      kisses += (value == NtpResponse::Kiss) ? 1 : 0;
+      dropped += (value == NtpResponse::Limited) ? 1 : 0;
+      if (value == NtpResponse::Kiss) { kisses += ((reply[1] == 0) && (get32(reply + 12) == 0x52415445UL)) ? 10 : 0; }
+      }
+   Check((replies == (int)NTP_SERVER_BURST) && (kisses == 11) && (dropped == 3), "burst %d, then a KoD RATE, then dropped", replies);
+   int64_t laterUs = NowUs + (int64_t)NTP_SERVER_INTERVAL_MS * 1000LL + 12000;
+   Check(limited.Respond(request, sizeof(request), 7, laterUs, laterUs, reply) == NtpResponse::Reply, "one more after the interval");
+   Check(limited.Respond(request, sizeof(request), 8, laterUs, laterUs, reply) == NtpResponse::Reply, "another client has its own bucket");
+
+   // The total rate: at most NTP_SERVER_MAX_RATE replies in a second, to all the clients.
+   NtpResponder flood;
+   flood.set_Reference(reference(NowUs));
+   uint32_t served = 0;
+   for (uint32_t client = 1; client <= 2 * NTP_SERVER_MAX_RATE; client++)
+      { served += (flood.Respond(request, sizeof(request), client, NowUs, NowUs, reply) == NtpResponse::Reply) ? 1 : 0; }
+   Check((served == NTP_SERVER_MAX_RATE) && (flood.GetCount(NtpResponse::Limited) == NTP_SERVER_MAX_RATE),
+         "a flood is capped at %u replies/s", (unsigned)served);
+
+   return HostTest::Result();
+   }
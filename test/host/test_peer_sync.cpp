@@ -0,0 +1,229 @@
+/// @file test_peer_sync.cpp
+/// @brief Host test of the peer to peer time sync (`PeerSync`): several peers exchange the messages
+///        in memory on virtual time.
+/// @details Each peer has a system clock with an offset and a drift from the virtual time, the
+///          `BinaryClockPeerSync` task is modelled: a beacon every `PEER_SYNC_BEACON_MS`, a request
+///          to the leader every `PEER_SYNC_POLL_MS`, `Correct()` after each response. A message
+///          takes 1 to 2 ms each way (random, so the paths are asymmetric); the slew is applied
+///          at once, `adjtime()` takes a few ms on the ESP32.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <PeerSync.h>
+
+#include <math.h>                      /// For fabs()
+#include <string.h>                    /// For memcmp() and memcpy()
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief One peer: the protocol and its system clock.
+   struct Peer
+      {
+      PeerSync sync;
+      uint8_t  mac[6] = { 2, 0, 0, 0, 0, 0 };
+      double   offsetUs = 0.0;         ///< The system clock - the virtual time.
+      double   ppm = 0.0;              ///< The drift of the system clock, > 0 fast.
+      bool     running = true;
+      uint32_t steps = 0;
+      uint32_t slews = 0;
+
+      int64_t NowUs(int64_t virtualUs) const { return virtualUs + (int64_t)offsetUs; }
+      };
+
+   /// @brief A message on its way.
+   struct Message
+      {
+      int64_t atUs;                    ///< The virtual time it is received.
+      size_t  to;                      ///< The peer it is sent to.
+      size_t  from;                    ///< The peer it is sent by.
+      uint8_t data[PEER_SYNC_SIZE];
+      };
+
+   /// @brief The peers and the messages on virtual time.
+   struct Network
+      {
+      std::vector<Peer> peers;
+      std::vector<Message> messages;
+      int64_t nowUs = 1000000000LL;    ///< The virtual time, ~1 s into `millis()`.
+      uint32_t seed = 1;
+
+      Network(const std::vector<double>& offsetsMs, const std::vector<double>& ppms, const std::vector<uint8_t>& strata)
+         {
+         peers.resize(offsetsMs.size());
+         for (size_t i = 0; i < peers.size(); i++)
+            {
+            Peer& peer = peers[i];
+            peer.mac[5] = (uint8_t)(i + 1);
+            peer.offsetUs = offsetsMs[i] * 1000.0;
+            peer.ppm = ppms[i];
+            peer.sync.Start(peer.mac);
+            if (strata[i] < PEER_SYNC_LOCAL_STRATUM) { peer.sync.SetSynced(strata[i], nowMs()); }
+            }
+         }
+
+      uint32_t nowMs() const { return (uint32_t)(nowUs / 1000); }
+
+      /// @brief The one way delay: 1 to 2 ms.
+      int64_t delayUs()
+         {
+         seed = seed * 1664525UL + 1013904223UL;
+         return 1000 + (int64_t)(seed >> 22);
+         }
+
+      void send(size_t from, size_t to, const uint8_t* data)
+         {
+         Message message;
+         message.atUs = nowUs + delayUs();
+         message.to = to;
+         message.from = from;
+         memcpy(message.data, data, PEER_SYNC_SIZE);
+         messages.push_back(message);
+         }
+
+      void deliver()
+         {
+         for (size_t i = 0; i < messages.size(); )
+            {
+            if (messages[i].atUs > nowUs) { i++; continue; }
+
+            Message message = messages[i];
+            messages.erase(messages.begin() + (long)i);
+            Peer& peer = peers[message.to];
+            if (!peer.running) { continue; }
+
+            uint8_t reply[PEER_SYNC_SIZE];
+            int64_t receiveUs = peer.NowUs(nowUs);
+            PeerMessage type = peer.sync.Receive(message.data, PEER_SYNC_SIZE, (uint32_t)(message.from + 1), PEER_SYNC_PORT,
+                                                 nowMs(), receiveUs, receiveUs + 50, reply);
+            if (type == PeerMessage::Request) { send(message.to, message.from, reply); }
+            if (type == PeerMessage::Response)
+               {
+               int64_t correction = 0;
+               PeerCorrection action = peer.sync.Correct(correction);
+               peer.steps += (action == PeerCorrection::Step) ? 1 : 0;
+               peer.slews += (action == PeerCorrection::Slew) ? 1 : 0;
+               if (action != PeerCorrection::None) { peer.offsetUs += (double)correction; }
+               }
+            }
+         }
+
+      /// @brief Run the peers for `seconds` of virtual time in 1 ms steps.
+      void Run(double seconds)
+         {
+         int64_t endUs = nowUs + (int64_t)(seconds * 1e6);
+         for (; nowUs < endUs; nowUs += 1000)
+            {
+            uint32_t ms = nowMs();
+            for (size_t i = 0; i < peers.size(); i++)
+               {
+               Peer& peer = peers[i];
+               if (!peer.running) { continue; }
+               peer.offsetUs += peer.ppm * 1e-3;   // 1 ms of drift.
+
+               uint8_t out[PEER_SYNC_SIZE];
+               // The peers start their tasks a little apart.
+               if (((ms + 97 * i) % PEER_SYNC_BEACON_MS) == 0)
+                  {
+                  peer.sync.MakeBeacon(ms, peer.NowUs(nowUs), out);
+                  for (size_t j = 0; j < peers.size(); j++)
+                     {
+                     if (j != i) { send(i, j, out); }
+                     }
+                  }
+               if ((((ms + 131 * i) % PEER_SYNC_POLL_MS) == 0) && (peer.sync.MakeRequest(ms, peer.NowUs(nowUs), out) != 0))
+                  {
+                  const PeerInfo* leader = peer.sync.GetLeader(ms);
+                  send(i, (size_t)(leader->address - 1), out);
+                  }
+               }
+            deliver();
+            }
+         }
+
+      /// @brief The MAC of the leader peer `i` elected.
+      const uint8_t* LeaderOf(size_t i)
+         {
+         const PeerInfo* leader = peers[i].sync.GetLeader(nowMs());
+         return (leader != nullptr) ? leader->mac : peers[i].mac;
+         }
+
+      /// @brief All the running peers elected peer `leader`.
+      bool AllElected(size_t leader)
+         {
+         for (size_t i = 0; i < peers.size(); i++)
+            {
+            if (peers[i].running && (memcmp(LeaderOf(i), peers[leader].mac, 6) != 0)) { return false; }
+            }
+         return true;
+         }
+
+      /// @brief The largest clock offset (ms) of the running peers to the leader.
+      double Spread(size_t leader) const
+         {
+         double result = 0.0;
+         for (const Peer& peer : peers)
+            {
+            if (peer.running) { result = fmax(result, fabs(peer.offsetUs - peers[leader].offsetUs) / 1000.0); }
+            }
+         return result;
+         }
+      };
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Peer sync (in memory, virtual time)");
+
+   Network network({ 350.0, -200.0, 50.0, 1200.0 }, { 0.0, 20.0, -15.0, 40.0 }, { 15, 15, 3, 15 });
+   network.Run(60.0);
+   Check(network.AllElected(2), "the lowest stratum leads");
+   Check(network.Spread(2) < 1.0, "followers within 1 ms of the leader (%.3f ms)", network.Spread(2));
+   Check((network.peers[0].steps >= 1) && (network.peers[1].steps >= 1) && (network.peers[3].steps >= 1) && (network.peers[2].steps == 0),
+         "large offsets stepped, then slewed");
+   Check(network.peers[0].sync.GetPeerCount(network.nowMs()) == 3, "every peer heard");
+
+   network.peers[2].running = false;
+   network.Run(60.0);
+   Check(network.AllElected(0), "leader stopped: the lowest MAC leads");
+   Check(network.Spread(0) < 1.0, "followers within 1 ms of the new leader (%.3f ms)", network.Spread(0));
+
+   Network small({ 0.0, 4.0, -3.0 }, { 0.0, 0.0, 0.0 }, { 15, 15, 15 });
+   small.Run(40.0);
+   Check(small.AllElected(0), "equal strata: the lowest MAC leads");
+   Check((small.Spread(0) < 1.0) && (small.peers[1].steps == 0) && (small.peers[2].steps == 0) && (small.peers[1].slews >= 1),
+         "small offsets slewed, not stepped (%.3f ms)", small.Spread(0));
+
+   // A broadcast comes back to its sender; a message with a bad magic is dropped.
+   PeerSync sync;
+   const uint8_t mac[6] = { 2, 0, 0, 0, 0, 9 };
+   sync.Start(mac);
+   uint8_t out[PEER_SYNC_SIZE];
+   uint8_t reply[PEER_SYNC_SIZE];
+   sync.MakeBeacon(0, 1, out);
+   bool own = (sync.Receive(out, sizeof(out), 1, 1, 0, 0, 0, reply) == PeerMessage::None);
+   out[0] = 'X';
+   out[11] = 1;
+   bool bad = (sync.Receive(out, sizeof(out), 1, 1, 0, 0, 0, reply) == PeerMessage::None);
+   Check(own && bad && (sync.GetPeerCount(0) == 0), "own and malformed messages ignored");
+
+   // A response that doesn't match the pending request isn't a sample.
+   PeerSync follower;
+   PeerSync leader;
+   const uint8_t leaderMac[6] = { 2, 0, 0, 0, 0, 1 };
+   follower.Start(mac);
+   leader.Start(leaderMac);
+   leader.MakeBeacon(0, 0, out);
+   follower.Receive(out, sizeof(out), 1, 1, 0, 0, 0, reply);
+   follower.MakeRequest(10, 1000, out);
+   leader.Receive(out, sizeof(out), 2, 1, 10, 2000, 2100, reply);
+   bool first = (follower.Receive(reply, sizeof(reply), 1, 1, 11, 3000, 3000, out) == PeerMessage::Response);
+   bool duplicate = (follower.Receive(reply, sizeof(reply), 1, 1, 12, 3100, 3100, out) == PeerMessage::None);
+   Check(first && duplicate && (follower.get_Samples() == 1), "a duplicated response is dropped");
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,255 @@
+/// @file test_peer_sync_loopback.cpp
+/// @brief Host test of the peer to peer time sync (`PeerSync`) on UDP sockets: four peers on
+///        127.0.0.1 - 127.0.0.4, each in its own thread, elect a leader, follow its clock and fail
+///        over when it stops.
+/// @details Each peer thread is the `BinaryClockPeerSync` task on the host: a beacon to every peer
+///          each `PEER_SYNC_BEACON_MS` (the firmware broadcasts, here it's sent to each address on
+///          the same port, its own included), a request to the leader each `PEER_SYNC_POLL_MS`,
+///          `Correct()` after each response. A peer's system clock is the host's plus its offset,
+///          a step or a slew is applied to the offset at once.
+///          The protocol intervals are scaled down 20 times (CMakeLists.txt), as `peer_sync_sim.py --scale 0.05`.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+#include "HostSocket.h"
+
+#include <PeerSync.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string.h>                    /// For memcmp()
+#include <thread>
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+using HostTest::Loopback;
+using HostTest::SystemMicros;
+using HostTest::UdpSocket;
+
+namespace
+   {
+   /// @brief The time (ms) since the start, `millis()` on the clock.
+   uint32_t millis()
+      {
+      static const auto start = std::chrono::steady_clock::now();
+      return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      }
+
+   /// @brief One clock: the protocol, its socket on 127.0.0.`index + 1` and its task.
+   class Peer
+      {
+   public:
+      Peer(size_t index, uint16_t port, int64_t offsetUs, uint8_t stratum)
+            : socket(Loopback((uint8_t)(index + 1)), port), offsetUs(offsetUs)
+         {
+         mac[5] = (uint8_t)(index + 1);
+         sync.Start(mac);
+         if (stratum < PEER_SYNC_LOCAL_STRATUM) { sync.SetSynced(stratum, millis()); }
+         }
+
+      ~Peer() { Stop(); }
+
+      /// @brief Start the task, the beacons go to 127.0.0.1 - 127.0.0.`peers` on `port`.
+      void Begin(size_t peers, uint16_t port)
+         {
+         count = peers;
+         this->port = port;
+         running = true;
+         thread = std::thread([this]() { task(); });
+         }
+
+      /// @brief Stop the task and close the socket: the peer goes quiet.
+      void Stop()
+         {
+         running = false;
+         if (thread.joinable()) { thread.join(); }
+         socket.Close();
+         }
+
+      /// @brief The MAC of the leader this peer elected, its own if it leads.
+      void GetLeader(uint8_t* out, uint32_t* address = nullptr)
+         {
+         std::lock_guard<std::mutex> lock(mutex);
+         const PeerInfo* leader = sync.GetLeader(millis());
+         memcpy(out, (leader != nullptr) ? leader->mac : mac, 6);
+         if (address != nullptr) { *address = (leader != nullptr) ? leader->address : socket.get_Address(); }
+         }
+
+      size_t GetPeerCount()
+         {
+         std::lock_guard<std::mutex> lock(mutex);
+         return sync.GetPeerCount(millis());
+         }
+
+      int64_t NowUs() const { return SystemMicros() + offsetUs; }
+
+      UdpSocket socket;
+      uint8_t  mac[6] = { 2, 0, 0, 0, 0, 0 };
+      std::atomic<int64_t>  offsetUs;          ///< The system clock - the host's.
+      std::atomic<uint32_t> steps { 0 };
+      std::atomic<uint32_t> slews { 0 };
+      std::atomic<bool>     running { false };
+
+   private:
+      void task()
+         {
+         uint32_t beaconMs = millis() - PEER_SYNC_BEACON_MS;   // The first beacon is now.
+         uint32_t pollMs = millis();
+         while (running)
+            {
+            uint8_t message[PEER_SYNC_SIZE];
+            uint32_t nowMs = millis();
+            if ((nowMs - beaconMs) >= PEER_SYNC_BEACON_MS)
+               {
+               beaconMs = nowMs;
+               std::unique_lock<std::mutex> lock(mutex);
+               size_t length = sync.MakeBeacon(nowMs, NowUs(), message);
+               lock.unlock();
+               for (size_t i = 0; i < count; i++) { socket.SendTo(message, length, Loopback((uint8_t)(i + 1)), port); }
+               }
+
+            if ((nowMs - pollMs) >= PEER_SYNC_POLL_MS)
+               {
+               pollMs = nowMs;
+               std::unique_lock<std::mutex> lock(mutex);
+               const PeerInfo* leader = sync.GetLeader(nowMs);
+               uint32_t to = (leader != nullptr) ? leader->address : 0;
+               uint16_t toPort = (leader != nullptr) ? leader->port : 0;
+               size_t length = (leader != nullptr) ? sync.MakeRequest(nowMs, NowUs(), message) : 0;
+               lock.unlock();
+               if (length > 0) { socket.SendTo(message, length, to, toPort); }
+               }
+
+            receive();
+            }
+         }
+
+      void receive()
+         {
+         uint8_t message[2 * PEER_SYNC_SIZE];
+         uint8_t reply[PEER_SYNC_SIZE];
+         uint32_t from = 0;
+         uint16_t fromPort = 0;
+         int received = socket.Receive(message, sizeof(message), 5, &from, &fromPort);
+         int64_t receiveUs = NowUs();
+         if (received < 0) { return; }
+
+         std::unique_lock<std::mutex> lock(mutex);
+         PeerMessage type = sync.Receive(message, (size_t)received, from, fromPort, millis(), receiveUs, NowUs(), reply);
+         if (type == PeerMessage::Response)
+            {
+            int64_t correctionUs = 0;
+            PeerCorrection action = sync.Correct(correctionUs);
+            steps += (action == PeerCorrection::Step) ? 1 : 0;
+            slews += (action == PeerCorrection::Slew) ? 1 : 0;
+            if (action != PeerCorrection::None) { offsetUs += correctionUs; }
+            }
+         lock.unlock();
+
+         if (type == PeerMessage::Request) { socket.SendTo(reply, PEER_SYNC_SIZE, from, fromPort); }
+         }
+
+      PeerSync    sync;
+      std::mutex  mutex;               ///< `sync` is shared by the task and the checks.
+      std::thread thread;
+      size_t      count = 0;
+      uint16_t    port = 0;
+      }; // class Peer
+
+   using Peers = std::vector<std::unique_ptr<Peer>>;
+
+   int64_t magnitude(int64_t value)
+      { return (value < 0) ? -value : value; }
+
+   /// @brief All the running peers elected peer `leader`.
+   bool allElected(Peers& peers, size_t leader)
+      {
+      for (auto& peer : peers)
+         {
+         uint8_t elected[6];
+         peer->GetLeader(elected);
+         if (peer->running && (memcmp(elected, peers[leader]->mac, 6) != 0)) { return false; }
+         }
+      return true;
+      }
+
+   /// @brief The largest clock offset (ms) of the running peers to the leader.
+   double spread(Peers& peers, size_t leader)
+      {
+      int64_t result = 0;
+      for (auto& peer : peers)
+         {
+         if (peer->running) { result = std::max(result, magnitude(peer->offsetUs - peers[leader]->offsetUs)); }
+         }
+      return (double)result / 1000.0;
+      }
+
+   /// @brief Wait until `done` or `seconds` are over.
+   /// @return The time (s) it took, < 0 if it timed out.
+   double waitFor(const std::function<bool()>& done, double seconds)
+      {
+      uint32_t startMs = millis();
+      while ((millis() - startMs) < (uint32_t)(seconds * 1000.0))
+         {
+         if (done()) { return (millis() - startMs) / 1000.0; }
+         std::this_thread::sleep_for(std::chrono::milliseconds(20));
+         }
+      return -1.0;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Peer sync on 127.0.0.1 - 127.0.0.4");
+
+   // The offsets (ms) of the system clocks, peer 2 is synced upstream (stratum 3).
+   const int64_t offsetsMs[] = { 300, -150, 40, 900 };
+   const uint8_t strata[] = { 15, 15, 3, 15 };
+   const size_t count = sizeof(offsetsMs) / sizeof(offsetsMs[0]);
+   Peers peers;
+   uint16_t port = 0;
+   for (size_t i = 0; i < count; i++)
+      {
+      peers.emplace_back(new Peer(i, port, offsetsMs[i] * 1000, strata[i]));
+      port = peers[0]->socket.get_Port();   // The others bind the same port on their own address.
+      }
+   bool bound = true;
+   for (auto& peer : peers) { bound = bound && peer->socket.get_IsOpen(); }
+   Check(bound, "%u sockets bound on port %u", (unsigned)count, (unsigned)port);
+   for (auto& peer : peers) { peer->Begin(count, port); }
+
+   double seconds = waitFor([&]() { return allElected(peers, 2); }, 5.0);
+   Check(seconds >= 0.0, "the lowest stratum leads (%.2f s)", seconds);
+   uint8_t elected[6];
+   uint32_t address = 0;
+   peers[0]->GetLeader(elected, &address);
+   Check(address == Loopback(3), "its requests go to 127.0.0.3");
+   Check((peers[0]->GetPeerCount() == count - 1) && (peers[3]->GetPeerCount() == count - 1), "every peer heard the %u others", (unsigned)(count - 1));
+
+   seconds = waitFor([&]() { return spread(peers, 2) < 1.0; }, 10.0);
+   Check(seconds >= 0.0, "the followers within 1 ms of the leader (%.3f ms)", spread(peers, 2));
+   Check((peers[0]->steps >= 1) && (peers[1]->steps >= 1) && (peers[3]->steps >= 1) && (peers[2]->steps == 0) && (peers[2]->slews == 0),
+         "the large offsets stepped, the leader untouched");
+   std::this_thread::sleep_for(std::chrono::milliseconds(10 * PEER_SYNC_POLL_MS));
+   Check(allElected(peers, 2) && (spread(peers, 2) < 1.0), "still locked after 10 polls (%.3f ms)", spread(peers, 2));
+
+   HostTest::Title("The leader stops");
+   const int64_t leaderUs = peers[2]->offsetUs;
+   peers[2]->Stop();
+   seconds = waitFor([&]() { return allElected(peers, 0); }, 5.0);
+   Check(seconds >= 0.0, "the lowest MAC leads (%.2f s, timeout %u ms)", seconds, (unsigned)PEER_SYNC_TIMEOUT_MS);
+   peers[1]->GetLeader(elected, &address);
+   Check(address == Loopback(1), "the requests go to 127.0.0.1");
+   seconds = waitFor([&]() { return (spread(peers, 0) < 1.0) && (peers[1]->GetPeerCount() == count - 2); }, 10.0);
+   Check(seconds >= 0.0, "the followers within 1 ms of the new leader (%.3f ms)", spread(peers, 0));
+   int64_t driftUs = peers[0]->offsetUs - leaderUs;
+   Check(magnitude(driftUs) < 1000, "the new leader kept the old leader's time (%lld us)", (long long)driftUs);
+
+   for (auto& peer : peers) { peer->Stop(); }
+   return HostTest::Result();
+   }
@@ -0,0 +1,118 @@
+/// @file test_radio_duty_cycle.cpp
+/// @brief Host test of the WiFi radio duty cycle (`RadioDutyCycle`) with the adaptive poll interval
+///        (`NtpPollController`) on virtual time.
+/// @details Each wake reconnects in about `connect` seconds (gaussian), a fraction `fail` of the wakes
+///          don't connect and time out; the NTP exchange takes 150 ms. The `millis()` values wrap
+///          every 49.7 days, the week long runs start near the wrap.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <NtpPollController.h>
+#include <RadioDutyCycle.h>
+#include <WiFiStateMachine.h>          /// For WIFI_ATTEMPT_MS, the timeout of a wake that doesn't connect.
+
+#include <math.h>                      /// For fabs()
+#include <random>
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief The result of a run.
+   struct DutyRun
+      {
+      RadioDutyCycle duty;
+      uint32_t nowMs = 0;              ///< The `millis()` at the end.
+      uint32_t syncs = 0;
+      uint32_t lateMs = 0;             ///< The latest a sync started after its time, once the lead settled.
+      };
+
+   /// @brief Run the duty cycle with the poll controller for `days`.
+   void dutyTrace(DutyRun& run, double ppm, double days = 7.0, double connectS = 1.0, double fail = 0.0, double noiseUs = 2000.0)
+      {
+      std::mt19937 random(1);
+      std::normal_distribution<double> noise(0.0, noiseUs);
+      std::normal_distribution<double> connect(connectS * 1000.0, connectS * 250.0);
+      std::uniform_real_distribution<double> chance(0.0, 1.0);
+      NtpPollController controller;
+
+      const uint32_t startMs = 0xF0000000UL;   // `millis()` wraps in the run.
+      uint32_t nowMs = startMs;
+      run.duty.Start(nowMs);
+      uint64_t elapsedMs = 0;
+      uint64_t endMs = (uint64_t)(days * 86400000.0);
+      uint32_t dueMs = nowMs;
+      uint32_t lastSyncMs = 0;
+      bool hasSync = false;
+
+      auto advance = [&](uint32_t deltaMs) { nowMs += deltaMs; elapsedMs += deltaMs; };
+      while (elapsedMs < endMs)
+         {
+         run.duty.Wake(nowMs);
+         if (chance(random) < fail)
+            {
+            advance(WIFI_ATTEMPT_MS);
+            advance(run.duty.Failed(nowMs, controller.get_Interval() * 1000UL));
+            continue;
+            }
+
+         if (run.duty.get_State() == RadioState::Waking) { advance((uint32_t)fmax(100.0, connect(random))); }
+         run.duty.Connected(nowMs);
+         if (run.syncs >= 4) { run.lateMs = ((int32_t)(nowMs - dueMs) > (int32_t)run.lateMs) ? (nowMs - dueMs) : run.lateMs; }
+
+         uint32_t elapsedS = hasSync ? (nowMs - lastSyncMs) / 1000UL : 0;
+         double offsetUs = ppm * (double)elapsedS + noise(random);
+         uint32_t intervalS = hasSync ? controller.Update((int64_t)offsetUs, elapsedS) : controller.get_Interval();
+         lastSyncMs = nowMs;
+         hasSync = true;
+         run.syncs++;
+         advance(150);                 // The NTP exchange.
+         dueMs = lastSyncMs + intervalS * 1000UL;
+         advance(run.duty.Synced(nowMs, true, intervalS * 1000UL - 150));
+         }
+
+      run.nowMs = nowMs;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Radio duty cycle (virtual time)");
+
+   DutyRun run;
+   dutyTrace(run, 2.0);
+   double onS = run.duty.GetOnMsPerDay(run.nowMs) / 1000.0;
+   double averageMa = run.duty.GetAverageUa(run.nowMs) / 1000.0;
+   Check(onS < 60.0, "2 ppm: radio on < 60 s/day (%.1f s)", onS);
+   Check(averageMa < 1.0, "2 ppm: < 1 mA average (%.3f mA)", averageMa);
+   Check((run.lateMs < 1000) && (fabs(run.duty.get_LeadMs() - 1500.0) < 300.0), "the sync is on time, the lead (%.2f s)",
+         run.duty.get_LeadMs() / 1000.0);
+
+   DutyRun slow;
+   dutyTrace(slow, 2.0, 7.0, 5.0);
+   Check((fabs(slow.duty.get_LeadMs() - 5500.0) < 1500.0) && (slow.lateMs < 5000), "slow reconnect, the lead follows (%.2f s)",
+         slow.duty.get_LeadMs() / 1000.0);
+
+   DutyRun failing;
+   dutyTrace(failing, 20.0, 2.0, 1.0, 0.3);
+   Check((failing.duty.get_Failures() > 0) && (failing.syncs > 20), "failed wakes retried (%u of %u)",
+         (unsigned)failing.duty.get_Failures(), (unsigned)failing.duty.get_Wakes());
+
+   RadioDutyCycle duty;
+   duty.Start(0);
+   Check((duty.Synced(10000, true, 20000) == 20000) && (duty.get_State() == RadioState::On), "a short interval keeps the radio on");
+   std::vector<uint32_t> delays;
+   for (int i = 0; i < 6; i++) { delays.push_back(duty.Failed(100000, 600000)); }
+   Check(delays == std::vector<uint32_t>({ 60000, 120000, 240000, 480000, 600000, 600000 }), "the retry doubles up to the interval");
+
+   RadioDutyCycle keepOn;
+   keepOn.Start(0);
+   keepOn.set_KeepOn(true);
+   Check((keepOn.Synced(1000, true, 3600000) == 3600000) && (keepOn.GetOnMsPerDay(3601000) == 86400000UL),
+         "keep on: scheduled, never powered down");
+
+   return HostTest::Result();
+   }
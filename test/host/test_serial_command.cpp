@@ -0,0 +1,307 @@
+/// @file test_serial_command.cpp
+/// @brief Host test of the binary serial command protocol (`BCSerialCommand`) behind a pty
+///        loopback: the clock side reads and writes the pty slave as `Serial`, the test is the
+///        host tool on the master side.
+/// @details `BCSerialCommand.cpp` is the firmware source, the clock is the stand-in of
+///          `arduino/BinaryClock.h`. The frames are checked to be applied whole or not at all:
+///          one bad record, a failed handler, a bad CRC, bad COBS, an overflow or a partial frame
+///          change nothing.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCSerialCommand.h>
+#include <BinaryClock.h>
+
+#include <fcntl.h>                     /// For open(), O_RDWR
+#include <poll.h>                      /// For poll()
+#include <stdlib.h>                    /// For posix_openpt(), grantpt(), unlockpt(), ptsname()
+#include <termios.h>                   /// For cfmakeraw()
+#include <unistd.h>                    /// For read(), write(), close()
+#include <string>
+#include <thread>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+using Command = BCSerialCommand::Command;
+using Status  = BCSerialCommand::Status;
+using Phase   = BCSerialCommand::Phase;
+
+namespace
+   {
+   typedef std::basic_string<uint8_t> Bytes;
+
+   /// @brief The calls to the WiFi credentials stand-in handler (command 0x40) and its commit handler.
+   struct HandlerCalls
+      {
+      int validated = 0;
+      int applied = 0;
+      int begun = 0;
+      int committed = 0;
+      int rolledBack = 0;
+      bool failApply = false;          ///< The apply fails, e.g. the NVS is full.
+      };
+   HandlerCalls calls;
+
+   Status wifiHandler(Phase phase, const uint8_t* data, uint8_t length)
+      {
+      if (phase == Phase::Validate)
+         {
+         calls.validated++;
+         return ((length >= 1) && (data[0] <= 32)) ? Status::Ok : Status::BadValue;
+         }
+
+      if (calls.failApply) { return Status::Failed; }
+      calls.applied++;
+      return Status::Ok;
+      }
+
+   Status wifiCommit(Phase phase)
+      {
+      if (phase == Phase::Begin)    { calls.begun++; }
+      if (phase == Phase::Commit)   { calls.committed++; }
+      if (phase == Phase::Rollback) { calls.rolledBack++; }
+      return Status::Ok;
+      }
+
+   std::string text;                   ///< The characters received outside of a frame.
+   void textHandler(int ch) { text.push_back((char)ch); }
+
+   Bytes record(Command command, const Bytes& data = Bytes())
+      { return Bytes{ (uint8_t)command, (uint8_t)data.size() } + data; }
+
+   Bytes record(uint8_t command, const Bytes& data)
+      { return Bytes{ command, (uint8_t)data.size() } + data; }
+
+   /// @brief The request frame: 0x00 | COBS( version | sequence | body | CRC-16 LE ) | 0x00
+   Bytes frame(uint8_t sequence, const Bytes& body, uint8_t version = BCCMD_VERSION)
+      {
+      Bytes payload = Bytes{ version, sequence } + body;
+      uint16_t crc = BCSerialCommand::Crc16(payload.data(), payload.size());
+      payload += Bytes{ (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+
+      Bytes encoded(payload.size() + payload.size() / 254 + 2, 0);
+      encoded.resize(BCSerialCommand::CobsEncode(payload.data(), payload.size(), &encoded[0]));
+      return Bytes{ 0x00 } + encoded + Bytes{ 0x00 };
+      }
+
+   /// @brief The reply: status, record index and the status block, if any.
+   struct Reply
+      {
+      bool received = false;
+      uint8_t sequence = 0;
+      Status status = Status::Ok;
+      uint8_t index = 0;
+      bool hasBlock = false;
+      BCSerialCommand::StatusBlock block = { };
+      };
+
+   /// @brief The host tool side of the pty loopback, the clock runs on the slave side.
+   class Loopback
+      {
+   public:
+      Loopback()
+         {
+         master = posix_openpt(O_RDWR | O_NOCTTY);
+         if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) { return; }
+         slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+         if (slave < 0) { return; }
+
+         struct termios settings;
+         for (int fd : { master, slave })
+            {
+            tcgetattr(fd, &settings);
+            cfmakeraw(&settings);
+            tcsetattr(fd, TCSANOW, &settings);
+            }
+         Serial.set_Port(slave);
+         }
+
+      ~Loopback()
+         {
+         Serial.set_Port(-1);
+         if (slave >= 0)  { close(slave); }
+         if (master >= 0) { close(master); }
+         }
+
+      bool get_IsOpen() const { return (master >= 0) && (slave >= 0); }
+
+      /// @brief Send the bytes, run the clock and wait for a reply frame (up to `waitMs`).
+      Reply Exchange(BCSerialCommand& command, const Bytes& bytes, int waitMs = 1000)
+         {
+         if (write(master, bytes.data(), bytes.size()) != (ssize_t)bytes.size()) { return Reply(); }
+
+         Reply reply;
+         for (int elapsed = 0; (elapsed < waitMs) && !reply.received; elapsed++)
+            {
+            command.Process();
+            struct pollfd poller = { master, POLLIN, 0 };
+            if (poll(&poller, 1, 1) > 0)
+               {
+               uint8_t buffer[256];
+               ssize_t size = read(master, buffer, sizeof(buffer));
+               if (size > 0) { received.append(buffer, (size_t)size); }
+               }
+            reply = nextReply();
+            }
+
+         return reply;
+         }
+
+   private:
+      /// @brief Take the first valid reply frame from the bytes received, the text is dropped.
+      Reply nextReply()
+         {
+         Reply reply;
+         size_t end;
+         while ((end = received.find((uint8_t)0x00)) != Bytes::npos)
+            {
+            Bytes chunk = received.substr(0, end);
+            received.erase(0, end + 1);
+            if (chunk.empty()) { continue; }
+
+            size_t length = BCSerialCommand::CobsDecode(&chunk[0], chunk.size());
+            if ((length < 6) || (BCSerialCommand::Crc16(chunk.data(), length - 2) != (chunk[length - 2] | (chunk[length - 1] << 8))))
+               { continue; }   // Log text between the frames.
+
+            reply.received = true;
+            reply.sequence = chunk[1];
+            reply.status   = (Status)chunk[2];
+            reply.index    = chunk[3];
+            reply.hasBlock = (length == 6 + sizeof(BCSerialCommand::StatusBlock));
+            if (reply.hasBlock) { memcpy(&reply.block, &chunk[4], sizeof(reply.block)); }
+            return reply;
+            }
+
+         return reply;
+         }
+
+      int master = -1;
+      int slave = -1;
+      Bytes received;
+      };
+   }
+
+int main()
+   {
+   HostTest::Title("COBS and CRC");
+   const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+   Check(BCSerialCommand::Crc16(check, sizeof(check)) == 0x29B1, "CRC-16/CCITT-FALSE check value 0x29B1");
+   uint8_t data[] = { 0x11, 0x00, 0x22 };
+   uint8_t encoded[8];
+   size_t size = BCSerialCommand::CobsEncode(data, sizeof(data), encoded);
+   Check((size == 4) && (encoded[0] == 0x02) && (encoded[1] == 0x11) && (encoded[2] == 0x02) && (encoded[3] == 0x22),
+         "COBS 11 00 22 -> 02 11 02 22");
+   Check((BCSerialCommand::CobsDecode(encoded, size) == 3) && (encoded[1] == 0x00) && (encoded[2] == 0x22), "COBS decode");
+   uint8_t overrun[] = { 0x05, 0x01, 0x02 };
+   Check(BCSerialCommand::CobsDecode(overrun, sizeof(overrun)) == 0, "COBS code past the end: not valid");
+
+   Loopback port;
+   if (!Check(port.get_IsOpen(), "pty opened")) { return HostTest::Result(); }
+
+   BinaryClock clock;
+   BCSerialCommand command(clock);
+   command.set_TextHandler(textHandler);
+   command.RegisterCommand(0x40, wifiHandler, wifiCommit);
+
+   HostTest::Title("A good frame");
+   Bytes body = record(Command::Brightness, { 42 })
+              + record(Command::Alarm, { 2, 6, 45, 0, (uint8_t)AlarmTime::Daily, 1, 0 })
+              + record(0x40, { 4, 'R', 'a', 'c', 'k' })
+              + record(Command::HourMode, { 1 })
+              + record(Command::MelodyNotes, { 0xB8, 0x01, 0xFA, 0x00, 0x00, 0x00, 0x64, 0x00 })
+              + record(Command::Status);
+   Reply reply = port.Exchange(command, frame(7, body));
+   Check(reply.received && (reply.sequence == 7) && (reply.status == Status::Ok), "applied: status %u", (unsigned)reply.status);
+   Check((clock.brightness == 42) && clock.is12Hour && (clock.alarm.time.hour() == 6) && (clock.alarm.time.minute() == 45),
+         "the built-in records are applied");
+   Check((calls.applied == 1) && (calls.begun == 1) && (calls.committed == 1) && (calls.rolledBack == 0), "the handler is applied and committed once");
+   Check((clock.get_MelodyCount() == 2) && (clock.get_Melody() == 1) && (clock.GetMelodyById(1).size() == 2)
+         && (clock.GetMelodyById(1)[0].tone == 440) && (clock.GetMelodyById(1)[1].duration == 100), "the melody is registered and selected");
+   Check(reply.hasBlock && (reply.block.brightness == 42) && (reply.block.melodyCount == 2) && (reply.block.frames == 1),
+         "the status block");
+
+   HostTest::Title("One bad record");
+   unsigned changes = clock.changes;
+   HandlerCalls before = calls;
+   body = record(Command::Brightness, { 99 })
+        + record(0x40, { 5, 'O', 't', 'h', 'e', 'r' })
+        + record(Command::Alarm, { 2, 25, 0, 0, (uint8_t)AlarmTime::Daily, 1, 0 })   // Hour 25.
+        + record(Command::HourMode, { 0 });
+   reply = port.Exchange(command, frame(8, body));
+   Check(reply.received && (reply.status == Status::BadValue) && (reply.index == 2), "rejected with its index: status %u, record %u",
+         (unsigned)reply.status, (unsigned)reply.index);
+   Check((clock.changes == changes) && (clock.brightness == 42) && clock.is12Hour, "nothing is applied");
+   Check((calls.applied == before.applied) && (calls.begun == before.begun) && (calls.committed == before.committed),
+         "the handler isn't applied or committed");
+
+   reply = port.Exchange(command, frame(9, record(Command::Brightness, { 1, 2 })));
+   Check(reply.received && (reply.status == Status::BadLength) && (clock.changes == changes), "a bad length: nothing is applied");
+   reply = port.Exchange(command, frame(10, record(Command::Ping) + record(0x7E, Bytes())));
+   Check(reply.received && (reply.status == Status::UnknownCommand) && (reply.index == 1), "an unknown command");
+   reply = port.Exchange(command, frame(11, record(Command::Melody, { 5 })));
+   Check(reply.received && (reply.status == Status::BadValue) && (clock.changes == changes), "an unknown melody id");
+
+   HostTest::Title("A failed handler");
+   calls.failApply = true;
+   before = calls;
+   reply = port.Exchange(command, frame(12, record(Command::Brightness, { 7 }) + record(0x40, { 1, 'X' })));
+   calls.failApply = false;
+   Check(reply.received && (reply.status == Status::Failed) && (reply.index == 1), "the failure is returned with its index");
+   Check((calls.rolledBack == before.rolledBack + 1) && (calls.committed == before.committed), "the handler is rolled back");
+   Check((clock.changes == changes) && (clock.brightness == 42), "the built-in records aren't applied");
+
+   HostTest::Title("Busy");
+   clock.settingsState = SettingsState::TimeSettings;
+   reply = port.Exchange(command, frame(13, record(Command::Brightness, { 7 })));
+   clock.settingsState = SettingsState::Inactive;
+   Check(reply.received && (reply.status == Status::Busy) && (clock.changes == changes), "the menu is in use: nothing is applied");
+
+   HostTest::Title("Melody upload");
+   const std::vector<Note>& uploaded = clock.GetMelodyById(1);
+   clock.melodyPlaying = true;
+   reply = port.Exchange(command, frame(30, record(Command::MelodyNotes, { 0x10, 0x02, 0x64, 0x00 })));
+   clock.melodyPlaying = false;
+   Check(reply.received && (reply.status == Status::Busy) && (uploaded.size() == 2) && (uploaded[0].tone == 440),
+         "rejected while the alarm sounds, the notes unchanged");
+   reply = port.Exchange(command, frame(31, record(Command::MelodyNotes, { 0x10, 0x02, 0x64, 0x00 })));
+   Check(reply.received && (reply.status == Status::Ok) && (clock.replaced == 1) && (clock.get_MelodyCount() == 2)
+         && (uploaded.size() == 1) && (uploaded[0].tone == 528), "uploaded again: swapped into the same registry entry");
+   changes = clock.changes;
+
+   HostTest::Title("Bad frames");
+   uint16_t errors = command.get_ErrorCount();
+   Bytes bad = frame(14, record(Command::Brightness, { 7 }));
+   bad[4] ^= 0x01;                     // A byte of the body.
+   reply = port.Exchange(command, bad, 100);
+   Check(!reply.received && (command.get_ErrorCount() == errors + 1) && (clock.changes == changes), "a bad CRC: no reply, nothing applied");
+
+   bad = frame(15, record(Command::Brightness, { 7 }));
+   bad[1] = 0x30;                      // The first COBS code past the end of the frame.
+   reply = port.Exchange(command, bad, 100);
+   Check(!reply.received && (command.get_ErrorCount() == errors + 2) && (clock.changes == changes), "bad COBS: no reply, nothing applied");
+
+   reply = port.Exchange(command, frame(16, record(Command::Brightness, { 7 }), BCCMD_VERSION + 1));
+   Check(reply.received && (reply.status == Status::BadVersion) && (command.get_ErrorCount() == errors + 3) && (clock.changes == changes),
+         "another version: BadVersion, nothing applied");
+
+   Bytes big(BCCMD_FRAME_SIZE + 10, 0x01);
+   reply = port.Exchange(command, Bytes{ 0x00 } + big + Bytes{ 0x00 }, 100);
+   Check(!reply.received && (command.get_ErrorCount() == errors + 4) && (clock.changes == changes), "too long: discarded");
+
+   Bytes partial = frame(17, record(Command::Brightness, { 7 }));
+   partial.resize(partial.size() / 2);
+   port.Exchange(command, partial, 10);
+   std::this_thread::sleep_for(std::chrono::milliseconds(BCCMD_FRAME_TIMEOUT + 100));
+   reply = port.Exchange(command, Bytes{ 'L', '3' }, 50);
+   Check((command.get_ErrorCount() == errors + 5) && (clock.changes == changes), "a partial frame times out: discarded");
+   Check(text == "L3", "the text after it goes to the text handler: \"%s\"", text.c_str());
+
+   HostTest::Title("Recovery");
+   reply = port.Exchange(command, frame(18, record(Command::Brightness, { 7 }) + record(Command::Status)));
+   Check(reply.received && (reply.status == Status::Ok) && (clock.brightness == 7), "the next good frame is applied");
+   Check(reply.hasBlock && (reply.block.errors == errors + 5) && (reply.block.frames == command.get_FrameCount()),
+         "the status block counts the frames rejected: %u", reply.hasBlock ? (unsigned)reply.block.errors : 0U);
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,318 @@
+/// @file test_settings.cpp
+/// @brief Host test of `BinaryClockSettings` on a mocked `Preferences`: the ID table (`GetNewID()`,
+///        `DeleteID()`, `UndeleteID()`, the compaction by `Save()`), the NVS records read back by
+///        `Begin()` and the deferred save, with the cost of the ID lookups.
+/// @details The NVS namespace is kept in memory by `arduino/Preferences.h`, the deferred save timer
+///          runs on virtual time (`arduino/freertos/timers.h`), its flush event in `arduino/freertos/event_groups.h`.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BinaryClockSettings.h>
+
+#include <chrono>
+#include <new>
+#include <stdlib.h>                    /// For malloc(), free()
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   size_t allocations = 0;             ///< The number of `operator new` calls.
+   }
+
+void* operator new(size_t size)
+   {
+   allocations++;
+   void* memory = malloc((size == 0) ? 1 : size);
+   if (memory == nullptr) { throw std::bad_alloc(); }
+   return memory;
+   }
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+namespace
+   {
+   /// @brief The settings with the protected ID methods made public; not the singleton, one per test.
+   class TestSettings : public BinaryClockSettings
+      {
+   public:
+      using BinaryClockSettings::GetIndex;
+      using BinaryClockSettings::GetNewID;
+      };
+
+   String ssidOf(int number)
+      {
+      char ssid[16];
+      snprintf(ssid, sizeof(ssid), "AP-%03d", number);
+      return String(ssid);
+      }
+
+   /// @brief Start from an empty NVS partition.
+   void eraseNvs()
+      {
+      Preferences::Storage().clear();
+      Preferences::writes = 0;
+      Preferences::failWrites = 0;
+      }
+
+   /// @brief Is the key in the NVS namespace of the settings.
+   bool nvsHas(const char* key)
+      {
+      const Preferences::Namespace& space = Preferences::Storage()["bc_settings"];
+      return space.find(key) != space.end();
+      }
+
+   /// @brief Add `count` APs named `AP-001`..., the password is the name.
+   bool addAPs(TestSettings& settings, int count)
+      {
+      bool result = true;
+      for (int i = 1; i <= count; i++)
+         { result = (settings.AddWiFiCreds(ssidOf(i), ssidOf(i)) != 0) && result; }
+      return result;
+      }
+
+   /// @brief Nanoseconds per call of `statement`.
+   template<typename F>
+   double timeNs(F statement, int count)
+      {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < count; i++) { statement(i); }
+      auto stop = std::chrono::steady_clock::now();
+      return std::chrono::duration<double, std::nano>(stop - start).count() / count;
+      }
+
+   /// @brief The IDs: 1 to 254 in order, none after the table is full, 0 and 255 never given.
+   void testNewIDs()
+      {
+      eraseNvs();
+      TestSettings settings;
+      Check(settings.GetNewID() == 0, "GetNewID() before Begin() is 0");
+      settings.Begin();
+
+      bool inOrder = true;
+      for (int i = 1; i <= MAX_ID_SIZE; i++)
+         { inOrder = (settings.AddWiFiCreds(ssidOf(i), "pw") == i) && inOrder; }
+      Check(inOrder, "IDs 1 to %d in order", MAX_ID_SIZE);
+      Check((settings.AddWiFiCreds("One more", "pw") == 0) && (settings.GetNewID() == 0), "no ID when all %d are used", MAX_ID_SIZE);
+      Check((settings.GetIndex(0) == -1) && (settings.GetIndex(UINT8_MAX) == -1), "IDs 0 and 255 are never used");
+
+      // A deleted entry keeps its ID until `Save()`, it can be undeleted.
+      uint8_t id = settings.FindID("AP-005", nullptr);
+      Check((id == 5) && settings.DeleteID(id) && (settings.FindID("AP-005", nullptr) == 0) && (settings.GetIndex(id) == 4),
+            "DeleteID(): not found, the entry is kept");
+      Check(settings.GetNewID() == 0, "the ID of a deleted entry isn't reused before Save()");
+      Check(settings.UndeleteID(id) && (settings.FindID("AP-005", nullptr) == id), "UndeleteID(): found again");
+      Check(!settings.DeleteID(UINT8_MAX) && !settings.UndeleteID(0), "DeleteID(), UndeleteID() of an unused ID fail");
+
+      // `Save()` removes the deleted entries, the indexes of the others move down.
+      settings.DeleteID(5);
+      settings.DeleteID(100);
+      Check(settings.Save() && (settings.GetIndex(5) == -1) && (settings.GetIndex(100) == -1)
+            && (settings.GetIndex(6) == 4) && (settings.GetIndex(101) == 98) && (settings.GetIndex(MAX_ID_SIZE) == MAX_ID_SIZE - 3),
+            "Save() compacts the table");
+      Check((settings.GetWiFiAP(101).ssid == "AP-101") && (settings.FindID("AP-254", nullptr) == MAX_ID_SIZE),
+            "the entries after the deleted ones found");
+
+      // The last ID is 254, the next ones wrap to the lowest free IDs.
+      Check((settings.AddWiFiCreds("New 1", "pw") == 5) && (settings.AddWiFiCreds("New 2", "pw") == 100)
+            && (settings.AddWiFiCreds("New 3", "pw") == 0), "the IDs wrap to the lowest free ID");
+      }
+
+   /// @brief Only the records changed are written, `Begin()` reads them back.
+   void testRecords()
+      {
+      eraseNvs();
+      uint8_t bssid[6] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+      {
+      TestSettings settings;
+      settings.Begin();
+      addAPs(settings, 10);
+      settings.AddWiFiCreds("Home", "secret", "00:11:22:33:44:55");
+      settings.set_Timezone("EST+5EDT,M3.2.0/2,M11.1.0/2");
+      uint32_t writes = Preferences::writes;
+      Check(settings.Save() && (Preferences::writes - writes == 13) && !settings.get_Modified(),
+            "Save(): 11 records, the header and the timezone");
+
+      writes = Preferences::writes;
+      settings.AddWiFiCreds("AP-003", "changed");
+      Check(settings.Save() && (Preferences::writes - writes == 1), "a new password writes its record only");
+
+      writes = Preferences::writes;
+      settings.DeleteID(4);
+      Check(settings.Save() && (Preferences::writes - writes == 2) && !nvsHas("ap_4"),
+            "a deleted entry: the header, the record removed");
+      settings.End();
+      }
+
+      TestSettings settings;
+      settings.Begin();
+      Check((settings.FindID("AP-003", nullptr) == 3) && (settings.GetWiFiAP(3).pw == "changed") && (settings.FindID("AP-004", nullptr) == 0),
+            "Begin(): the records read back");
+      Check((settings.FindID("Home", bssid) == 11) && (settings.GetWiFiAP(11).bssid == "00:11:22:33:44:55")
+            && (settings.get_Timezone() == "EST+5EDT,M3.2.0/2,M11.1.0/2"), "Begin(): the BSSID and the timezone");
+      Check(settings.AddWiFiCreds("Next", "pw") == 12, "Begin(): the last ID read back, the next ID follows");
+      }
+
+   /// @brief A damaged record is skipped, the others are kept and the header is repaired.
+   void testDamagedRecord()
+      {
+      eraseNvs();
+      {
+      TestSettings settings;
+      settings.Begin();
+      addAPs(settings, 5);
+      settings.Save();
+      settings.End();
+      }
+
+      Preferences::Storage()["bc_settings"]["ap_2"][40] ^= 0x01;
+      TestSettings settings;
+      settings.Begin();
+      Check((settings.FindID("AP-002", nullptr) == 0) && (settings.FindID("AP-001", nullptr) == 1) && (settings.FindID("AP-005", nullptr) == 5),
+            "Begin(): a record with a bad CRC skipped");
+      Check(!nvsHas("ap_2") && !settings.get_Modified(), "Begin(): the damaged record removed");
+      }
+
+   /// @brief The single blob of the old format is migrated to records.
+   void testMigration()
+      {
+      eraseNvs();
+      std::vector<uint8_t> blob;
+      auto put = [&blob](const char* text)
+         {
+         uint16_t length = strlen(text);
+         blob.push_back(length & 0xFF);
+         blob.push_back(length >> 8);
+         blob.insert(blob.end(), text, text + length);
+         };
+      blob.push_back(7);
+      put("Cottage");
+      put("");
+      put("lake");
+      blob.push_back(9);
+      put("Office");
+      put("AA:BB:CC:DD:EE:FF");
+      put("work");
+
+      Preferences nvs;
+      nvs.begin("bc_settings");
+      nvs.putBytes("ap_creds", blob.data(), blob.size());
+      nvs.putUChar("num_aps", 2);
+      nvs.putUChar("last_id", 9);
+      nvs.end();
+
+      TestSettings settings;
+      settings.Begin();
+      Check((settings.FindID("Cottage", nullptr) == 7) && (settings.GetWiFiAP(9).pw == "work") && (settings.GetWiFiAP(9).bssid == "AA:BB:CC:DD:EE:FF"),
+            "the old blob read");
+      Check(nvsHas("ap_7") && nvsHas("ap_9") && !settings.get_Modified(),
+            "the old blob migrated to records");
+      Check(!nvsHas("ap_creds") && !nvsHas("num_aps") && !nvsHas("last_id") && (settings.AddWiFiCreds("New", "pw") == 10),
+            "the old keys removed, the last ID kept");
+      }
+
+   /// @brief `SaveDeferred()` saves a burst of changes once, after the quiet period.
+   void testDeferred()
+      {
+      eraseNvs();
+      TestSettings settings;
+      settings.Begin();
+      uint32_t writes = Preferences::writes;
+      for (int i = 1; i <= 3; i++)
+         {
+         settings.AddWiFiCreds(ssidOf(i), "pw");
+         settings.SaveDeferred();
+         HostTimers::Advance(SETTINGS_COMMIT_DELAY_MS / 2);
+         }
+      Check((Preferences::writes == writes) && settings.get_Modified(), "nothing written during the burst");
+      HostTimers::Advance(SETTINGS_COMMIT_DELAY_MS);
+      Check((Preferences::writes - writes == 5) && !settings.get_Modified(), "one Save() after the quiet period: 3 records, header, timezone");
+
+      settings.DeleteID(2);
+      settings.SaveDeferred();
+      Check(settings.Flush() && !settings.get_Modified() && !nvsHas("ap_2"), "Flush() saves now");
+
+      // With a flush event the timer only sets the bits, the task waiting on them saves.
+      HostEventGroup event;
+      EventGroupHandle_t group = &event;
+      settings.set_FlushEvent(group, 0x4);
+      settings.AddWiFiCreds(ssidOf(4), "pw");
+      settings.SaveDeferred();
+      writes = Preferences::writes;
+      HostTimers::Advance(SETTINGS_COMMIT_DELAY_MS);
+      Check((xEventGroupGetBits(group) == 0x4) && (Preferences::writes == writes) && settings.get_Modified(),
+            "the timer sets the flush event, no NVS write in the timer task");
+      Check(settings.Flush() && !settings.get_Modified(), "the task's Flush() saves");
+      settings.set_FlushEvent(nullptr, 0);
+      }
+
+   /// @brief `Rollback()` restores the entries and the IDs of the `Checkpoint()`, a failed save is retried.
+   void testRollback()
+      {
+      eraseNvs();
+      TestSettings settings;
+      settings.Begin();
+      addAPs(settings, 3);
+      settings.Save();
+
+      settings.Checkpoint();
+      settings.AddWiFiCreds("Temp", "pw");
+      settings.DeleteID(1);
+      Check(settings.Rollback() && (settings.FindID("Temp", nullptr) == 0) && (settings.FindID("AP-001", nullptr) == 1)
+            && !settings.get_Modified(), "Rollback(): the entries restored");
+      Check(settings.AddWiFiCreds("Temp", "pw") == 4, "Rollback(): the last ID restored");
+
+      Preferences::failWrites = -1;
+      Check(!settings.Save() && settings.get_Modified(), "a failed write keeps the change");
+      Preferences::failWrites = 0;
+      Check(settings.Save() && !settings.get_Modified(), "the next Save() writes it");
+      }
+
+   /// @brief The cost of the ID lookups and the allocations of `Begin()`, for a number of APs.
+   void benchmark()
+      {
+      printf("  APs  GetIndex  Delete+Undelete  GetNewID  Begin() allocations\n");
+      for (int count : { 10, 50, 200 })
+         {
+         eraseNvs();
+         {
+         TestSettings settings;
+         settings.Begin();
+         addAPs(settings, count);
+         settings.Save();
+         settings.End();
+         }
+
+         TestSettings settings;
+         size_t before = allocations;
+         settings.Begin();
+         size_t beginAllocations = allocations - before;
+
+         const int calls = 1000000;
+         volatile int sink = 0;
+         double indexNs = timeNs([&](int i) { sink = settings.GetIndex(1 + i % count); }, calls);
+         double deleteNs = timeNs([&](int i) { uint8_t id = 1 + i % count; settings.DeleteID(id); settings.UndeleteID(id); }, calls);
+         double newIdNs = timeNs([&](int) { sink = settings.GetNewID(); }, calls);
+         printf("  %3d  %5.1f ns  %12.1f ns  %5.1f ns  %zu\n", count, indexNs, deleteNs, newIdNs, beginAllocations);
+         (void)sink;
+         }
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("BinaryClockSettings");
+
+   testNewIDs();
+   testRecords();
+   testDamagedRecord();
+   testMigration();
+   testDeferred();
+   testRollback();
+   benchmark();
+
+   return HostTest::Result();
+   }
@@ -0,0 +1,206 @@
+/// @file test_time_slew.cpp
+/// @brief Host test of the RTC time slew (`BCTimeSlew`) on a virtual DS3231.
+/// @details The virtual RTC runs on a virtual millisecond clock: it ticks once a second (plus its
+///          drift, trimmed by the aging offset register), the countdown restarts when the time is
+///          written and an alarm fires when a tick reaches the alarm second. The clock side is
+///          `BinaryClock::slewTime()` / `slewWrite()`: after each tick (plus a dispatch latency) the
+///          planned shift is written at `BCTimeSlew::WriteAtMs()`, never into or out of an alarm
+///          second; a gain is dispatched like a tick. Offsets over `BC_SLEW_MAX_MS` are stepped.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <BCTimeSlew.h>
+
+#include <math.h>                      /// For fabs()
+#include <set>
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   /// @brief A DS3231 on virtual time (ms): second counter, countdown phase, alarm and aging offset.
+   struct VirtualRtc
+      {
+      int64_t second = 0;              ///< The RTC second.
+      double start = 0.0;              ///< The virtual time the current second started.
+      double driftPpm = 0.0;           ///< The drift, > 0 the RTC is slow.
+      int8_t aging = 0;                ///< The aging offset register.
+      std::set<int64_t> alarms;        ///< The alarm seconds.
+      std::vector<int64_t> fired;      ///< The alarms fired, in order.
+
+      double Period() const
+         { return 1000.0 * (1.0 + (driftPpm + aging * BC_AGING_PPB / 1000.0) * 1e-6); }
+
+      double NextTick() const { return start + Period(); }
+
+      void Tick()
+         {
+         start = NextTick();
+         second++;
+         if (alarms.count(second) != 0) { fired.push_back(second); }
+         }
+
+      void Write(double now, int64_t value)
+         {
+         second = value;
+         start = now;
+         }
+
+      /// @brief Correct time - RTC time in ms, the correct time is the virtual time.
+      double Offset(double now) const
+         { return now - ((double)second * 1000.0 + (now - start)); }
+      };
+
+   /// @brief A second shown: the RTC second and when it was shown.
+   struct Shown
+      {
+      int64_t second;
+      double at;
+      };
+
+   /// @brief Run the clock until the correction is done.
+   double correct(VirtualRtc& rtc, BCTimeSlew& slew, double now, std::vector<Shown>& shown, double latency = 3.0)
+      {
+      shown.push_back({ rtc.second, rtc.start });
+      for (int i = 0; (i < 2000) && slew.get_IsSlewing(); i++)
+         {
+         now = rtc.NextTick();
+         rtc.Tick();
+         shown.push_back({ rtc.second, now });
+
+         // `slewTime()` runs for each second dispatched, a gain dispatches the second written.
+         for (double dispatch = now + latency; ; )
+            {
+            bool blocked = (rtc.alarms.count(rtc.second) != 0) || (rtc.alarms.count(rtc.second + 1) != 0);
+            int16_t shift = slew.NextShift(blocked);
+            if (shift == 0) { break; }
+
+            double writeAt = rtc.start + BCTimeSlew::WriteAtMs(shift);
+            if (writeAt < dispatch)
+               {
+               slew.Undo(shift);       // Too late in the second, the next one.
+               break;
+               }
+
+            rtc.Write(writeAt, rtc.second + BCTimeSlew::WriteSecond(shift));
+            now = writeAt;
+            if (BCTimeSlew::WriteSecond(shift) == 0) { break; }
+
+            shown.push_back({ rtc.second, writeAt });
+            dispatch = writeAt + latency;
+            }
+         }
+
+      return now;
+      }
+
+   /// @brief `BinaryClock::AdjustTime()`: slew, or step when the offset is too large.
+   bool adjust(VirtualRtc& rtc, BCTimeSlew& slew, double& now, double offsetMs, std::vector<Shown>& shown, uint32_t elapsedS = 0)
+      {
+      if (slew.Start((int32_t)offsetMs, elapsedS))
+         {
+         rtc.aging = slew.AgingOffset(rtc.aging);
+         now = correct(rtc, slew, now, shown);
+         return true;
+         }
+
+      double boundary = now - fmod(now, 1000.0);
+      rtc.Write(boundary, (int64_t)(boundary / 1000.0));   // `set_Time()` on the second boundary.
+      return false;
+      }
+
+   /// @brief A RTC `offsetMs` behind (> 0) the correct time `now`.
+   VirtualRtc makeRtc(double now, double offsetMs)
+      {
+      VirtualRtc rtc;
+      double rtcMs = now - offsetMs;
+      rtc.second = (int64_t)floor(rtcMs / 1000.0);
+      rtc.start = now - (rtcMs - (double)rtc.second * 1000.0);
+      return rtc;
+      }
+
+   bool onceEach(const std::vector<Shown>& shown)
+      {
+      for (size_t i = 1; i < shown.size(); i++)
+         {
+         if (shown[i].second != shown[i - 1].second + 1) { return false; }
+         }
+      return true;
+      }
+
+   bool durationsOk(const std::vector<Shown>& shown)
+      {
+      for (size_t i = 1; i < shown.size(); i++)
+         {
+         double length = shown[i].at - shown[i - 1].at;
+         if ((length < 1000.0 - BC_SLEW_STEP_MS - 1.0) || (length > 1000.0 + BC_SLEW_STEP_MS + 1.0)) { return false; }
+         }
+      return true;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Time slew (virtual RTC)");
+
+   const double offsets[] = { 1500.0, -1500.0, 250.0, -80.0, 59000.0, -59000.0 };
+   for (double offset : offsets)
+      {
+      double now = 1000000437.0;
+      VirtualRtc rtc = makeRtc(now, offset);
+      rtc.alarms.insert(rtc.second + 5);
+      BCTimeSlew slew;
+      std::vector<Shown> shown;
+      bool slewed = adjust(rtc, slew, now, rtc.Offset(now), shown);
+      while (rtc.second <= *rtc.alarms.rbegin())   // Run on past the alarm.
+         {
+         rtc.Tick();
+         shown.push_back({ rtc.second, rtc.start });
+         }
+
+      Check(slewed && !slew.get_IsSlewing(), "offset %+.0f ms: slewed", offset);
+      Check(onceEach(shown), "offset %+.0f ms: each second shown once", offset);
+      Check(durationsOk(shown), "offset %+.0f ms: seconds last 0.9 - 1.1 s", offset);
+      Check((rtc.fired.size() == 1) && (rtc.fired[0] == *rtc.alarms.begin()), "offset %+.0f ms: alarm fired once", offset);
+      Check(fabs(rtc.Offset(now)) < BC_SLEW_MIN_MS, "offset %+.0f ms: residual %.1f ms", offset, rtc.Offset(now));
+      }
+
+   double now = 1000000437.0;
+   VirtualRtc rtc = makeRtc(now, 10.0);
+   BCTimeSlew slew;
+   std::vector<Shown> shown;
+   Check(adjust(rtc, slew, now, rtc.Offset(now), shown) && (shown.size() == 1), "offset below %d ms: nothing to do", BC_SLEW_MIN_MS);
+
+   rtc = makeRtc(now, 3600000.0);
+   shown.clear();
+   Check(!adjust(rtc, slew, now, rtc.Offset(now), shown) && (fabs(rtc.Offset(now)) < 1000.0), "offset 1 h: stepped");
+
+   // A shift planned too late in the second is put back and made on the next one.
+   slew.Start(150);
+   int16_t shift = slew.NextShift();
+   slew.Undo(shift);
+   Check((shift == BC_SLEW_STEP_MS) && (slew.get_Remaining() == 150), "a shift undone is made later");
+   slew.Start(0);
+   Check((BCTimeSlew::WriteAtMs(-40) == 40) && (BCTimeSlew::WriteAtMs(100) == 900), "write time: lose late, gain early");
+
+   // A drifting RTC synced every 4 hours: the aging offset takes out the drift.
+   rtc = makeRtc(0.0, 0.0);
+   rtc.driftPpm = 2.0;
+   slew = BCTimeSlew();
+   now = 0.0;
+   for (int i = 0; i < 12; i++)
+      {
+      double target = now + 4 * 3600 * 1000.0;
+      while (rtc.NextTick() <= target) { rtc.Tick(); }
+      now = target;
+      shown.clear();
+      adjust(rtc, slew, now, rtc.Offset(now), shown, 4 * 3600);
+      }
+   double residual = rtc.driftPpm + rtc.aging * BC_AGING_PPB / 1000.0;
+   Check(fabs(residual) <= 0.1, "2 ppm drift: aging %+d leaves %.2f ppm", rtc.aging, residual);
+
+   return HostTest::Result();
+   }
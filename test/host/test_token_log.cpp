@@ -0,0 +1,132 @@
+/// @file test_token_log.cpp
+/// @brief Host test of the tokenized serial output (`SerialTokenLog.h`): the literals of the stream
+///        statements found at compile time, the frames written by the `LOG_*`, `SERIAL_*` macros
+///        and the cost of a statement, tokenized or formatted as text.
+/// @details The frames are also written to `token_log.bin`, the `detokenize` test decodes them with
+///          `test/detokenize.py` and the token database of this file.
+/// @author Chris-70 (2026/10)
+
+#define DEV_CODE          true
+#define SERIAL_OUTPUT     true
+#define DEBUG_OUTPUT      false
+#define SERIAL_ASYNC_LOG  false
+#define SERIAL_TOKENIZED  true
+#define LOG_LEVEL_NTP     LOG_LEVEL_VERBOSE
+
+#include "HostTest.h"
+
+#include <SerialOutput.Defines.h>
+
+#include <chrono>
+#include <stdio.h>                     /// For fopen()
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+// The literals of a stream statement, the stringized text has single spaces.
+static_assert(TokenOperands("\"a\" << x << endl") == 3, "three operands");
+static_assert(TokenLiterals("\"a\" << x << endl") == 0x5UL, "a string literal and endl");
+static_assert(TokenLiterals("F(\"a\") << \"b\" \"c\" << F ( \"d\" )") == 0x7UL, "F() and adjacent literals");
+static_assert(TokenLiterals("(x << 2) << \"<<\" << '<' << y[1 << 2]") == 0x2UL, "<< in parentheses and literals");
+static_assert(TokenLiterals("(a ? \"x\" : \"y\") << Foo(\"z\") << endline") == 0UL, "expressions of literals are values");
+
+namespace
+   {
+   /// @brief The bytes after the frame header: the token, then the values.
+   std::string frameBody(const std::string& output, size_t& pos)
+      {
+      if ((pos + 2 > output.size()) || ((uint8_t)output[pos] != SERIAL_TOKEN_ESCAPE)) { return std::string(); }
+      size_t length = (uint8_t)output[pos + 1];
+      std::string body = output.substr(pos + 2, length);
+      pos += 2 + length;
+      return body;
+      }
+
+   bool hasToken(const std::string& body, token_t token)
+      { return (body.size() >= sizeof(token)) && (memcmp(body.data(), &token, sizeof(token)) == 0); }
+
+   /// @brief Nanoseconds per call of `statement`.
+   template<typename F>
+   double timeNs(F statement, int count)
+      {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < count; i++)
+         {
+         Serial.output.clear();
+         statement(i);
+         }
+      auto stop = std::chrono::steady_clock::now();
+      return std::chrono::duration<double, std::nano>(stop - start).count() / count;
+      }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("Tokenized serial output");
+
+   int offset = -42;
+   String server("pool.ntp.org");
+   LOG_NTP_INFO("Offset " << offset << " ms from " << server << endl)
+   size_t pos = 0;
+   std::string body = frameBody(Serial.output, pos);
+   const char expected[] = { 'i', 83, 's', 12, 'p', 'o', 'o', 'l', '.', 'n', 't', 'p', '.', 'o', 'r', 'g' };
+   Check(hasToken(body, TokenHash("\"Offset \" << offset << \" ms from \" << server << endl"))
+         && (body.size() == sizeof(token_t) + sizeof(expected)) && (memcmp(body.data() + sizeof(token_t), expected, sizeof(expected)) == 0),
+         "LOG_: the token of the text, the values tagged");
+   std::string log = Serial.output;
+
+   Serial.output.clear();
+   SERIAL_PRINTLN(F("Scanning for I2C devices ..."))
+   SERIAL_OUT_PRINT("ok")
+   pos = 0;
+   body = frameBody(Serial.output, pos);
+   bool println = hasToken(body, TokenHash("F(\"Scanning for I2C devices ...\") << endl")) && (body.size() == sizeof(token_t));
+   body = frameBody(Serial.output, pos);
+   Check(println && hasToken(body, TokenHash("\"ok\"")) && (body.size() == sizeof(token_t)) && (pos == Serial.output.size()),
+         "PRINT, PRINTLN: a literal is the token alone");
+   log += Serial.output;
+
+   Serial.output.clear();
+   uint32_t survivors = 0xA5;
+   unsigned long big = 4000000000UL;
+   double ratio = 0.25;
+   char grade = 'B';
+   LOG_NTP_DEBUG("Survivors 0x" << _HEX(survivors) << ", " << big       // The comment is a space.
+                 << " ticks, ratio " << ratio << ", grade " << grade << endl)
+   pos = 0;
+   body = frameBody(Serial.output, pos);
+   Check((body.size() > sizeof(token_t)) && (body[sizeof(token_t)] == 'b') && (body[sizeof(token_t) + 1] == HEX)
+         && (body.find('u') != std::string::npos) && (body.find('f') != std::string::npos) && (body.back() == 'B'),
+         "_HEX, unsigned, float and char tagged");
+   log += Serial.output;
+
+   Serial.output.clear();
+   String name(std::string(200, 'x'));
+   LOG_NTP_WARN("Name " << name << " done" << endl)
+   Check((Serial.output.size() == SERIAL_TOKEN_FRAME_MAX) && ((uint8_t)Serial.output[1] == SERIAL_TOKEN_FRAME_MAX - 2),
+         "a long string is cut to fit the frame");
+   log += Serial.output;
+
+   Serial.output.clear();
+   set_SerialLogCeiling(LOG_LEVEL_INFO);
+   LOG_NTP_DEBUG("Hidden " << offset << endl)
+   set_SerialLogCeiling(LOG_LEVEL_VERBOSE);
+   Check(Serial.output.empty(), "the runtime ceiling still applies");
+
+   Serial.output = "plain text\r\n";
+   SERIAL_STREAM("Steps " << 3 << " of " << 4 << endl)
+   log += Serial.output;
+
+   FILE* file = fopen("token_log.bin", "wb");
+   Check((file != nullptr) && (fwrite(log.data(), 1, log.size(), file) == log.size()), "token_log.bin written (%u bytes)",
+         (unsigned)log.size());
+   if (file != nullptr) { fclose(file); }
+
+   // The cost of a statement: the frame, or the text formatted by `Print`.
+   const int count = 200000;
+   double tokenNs = timeNs([&](int i) { LOG_NTP_INFO("Offset " << i << " ms from " << server << endl) }, count);
+   double textNs = timeNs([&](int i) { Serial << "Offset " << i << " ms from " << server << endl; }, count);
+   printf("  per statement: tokenized %.0f ns, text %.0f ns (host)\n", tokenNs, textNs);
+
+   return HostTest::Result();
+   }
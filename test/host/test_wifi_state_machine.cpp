@@ -0,0 +1,106 @@
+/// @file test_wifi_state_machine.cpp
+/// @brief Host test of the event driven WiFi connection logic (`WiFiStateMachine`): the ranking of
+///        the candidate APs, the move to the next one on a failure, the backoff and the reconnect.
+/// @author Chris-70 (2026/10)
+
+#include "HostTest.h"
+
+#include <WiFiStateMachine.h>
+
+#include <vector>
+
+using namespace BinaryClockShield;
+using HostTest::Check;
+
+namespace
+   {
+   WiFiCandidate candidate(uint8_t id, int32_t rssi, int16_t bonus = 0)
+      {
+      WiFiCandidate value;
+      value.id = id;
+      value.rssi = rssi;
+      value.bonus = bonus;
+      return value;
+      }
+
+   bool isConnect(const WiFiAction& action, uint8_t id)
+      { return (action.type == WiFiAction::Connect) && (action.id == id) && (action.delayMs == WIFI_ATTEMPT_MS); }
+   } // namespace
+
+int main()
+   {
+   HostTest::Title("WiFi state machine");
+
+   // Ranked by RSSI + bonus: 3 (-70 + 25), 2 (-50), 1 (-60).
+   WiFiStateMachine wifi;
+   wifi.set_Candidates({ candidate(1, -60), candidate(2, -50), candidate(3, -70, 25) });
+   WiFiAction action = wifi.Start();
+   Check(isConnect(action, 3) && (wifi.get_State() == WiFiState::Connecting), "the best ranked AP first");
+   action = wifi.Disconnected();
+   Check(isConnect(action, 2) && (wifi.GetFailures(3) == 1), "a failed attempt moves on at once");
+   action = wifi.TimerExpired();
+   Check(isConnect(action, 1) && (wifi.GetFailures(2) == 1), "a timed out attempt moves on");
+   action = wifi.Disconnected();
+   Check((action.type == WiFiAction::Failed) && (wifi.get_State() == WiFiState::Failed) && (wifi.get_Attempts() == 3),
+         "every AP failed, no retry: Failed");
+   Check((wifi.Disconnected().type == WiFiAction::None) && (wifi.TimerExpired().type == WiFiAction::None), "no events after Failed");
+
+   // The failures lower the rank and are kept by ID over a scan: 2 (-45 - 10), 3 (-75 + 25 - 10), 1 (-70 - 10).
+   wifi.set_Candidates({ candidate(3, -75, 25), candidate(1, -70), candidate(2, -45) });
+   Check((wifi.GetFailures(1) == 1) && (wifi.GetFailures(2) == 1) && (wifi.GetFailures(3) == 1), "failure counts kept over a scan");
+   action = wifi.Start();
+   Check(isConnect(action, 2), "ranked with the failures (AP %u)", (unsigned)action.id);
+   action = wifi.Connected(2);
+   Check((action.type == WiFiAction::Done) && (wifi.GetFailures(2) == 0) && (wifi.get_State() == WiFiState::Connected),
+         "connected: the AP's failures cleared");
+
+   // The connection is lost: the same AP at once, even if it ranks lower now.
+   wifi.set_Candidates({ candidate(1, -40), candidate(2, -80), candidate(3, -70) });
+   action = wifi.Disconnected();
+   Check(isConnect(action, 2), "lost connection: the same AP first");
+   action = wifi.Disconnected();
+   Check(isConnect(action, 1), "then the best of the others");
+
+   // Retry: the backoff doubles from the minimum to the maximum, +/-25% jitter.
+   WiFiStateMachine retry;
+   retry.set_Retry(true);
+   retry.set_Seed(0x12345678UL);
+   retry.set_Candidates({ candidate(1, -60) });
+   bool jitterOk = true;
+   bool jitterVaries = false;
+   uint32_t backoff = WIFI_BACKOFF_MIN_MS;
+   action = retry.Start();
+   for (int round = 0; round < 12; round++)
+      {
+      action = retry.TimerExpired();
+      jitterOk = jitterOk && (action.type == WiFiAction::Wait) && (retry.get_State() == WiFiState::Backoff)
+                 && (action.delayMs >= backoff - backoff / 4) && (action.delayMs <= backoff + backoff / 4);
+      jitterVaries = jitterVaries || (action.delayMs != backoff);
+      backoff = (backoff < WIFI_BACKOFF_MAX_MS / 2) ? 2 * backoff : WIFI_BACKOFF_MAX_MS;
+      action = retry.TimerExpired();
+      jitterOk = jitterOk && isConnect(action, 1);
+      }
+   Check(jitterOk && jitterVaries, "backoff %u -> %u ms, within +/-25%%", (unsigned)WIFI_BACKOFF_MIN_MS, (unsigned)WIFI_BACKOFF_MAX_MS);
+   Check(retry.get_Backoff() == WIFI_BACKOFF_MAX_MS, "the backoff stops at the maximum");
+   retry.Connected(1);
+   Check(retry.get_Backoff() == WIFI_BACKOFF_MIN_MS, "connected: the backoff starts over");
+
+   WiFiStateMachine none;
+   none.set_Retry(true);
+   Check(none.Start().type == WiFiAction::Wait, "no candidates, retry: wait for the next round");
+
+   WiFiStateMachine capped;
+   capped.set_Candidates({ candidate(1, -40) });
+   for (int i = 0; i < 2 * WIFI_FAIL_MAX; i++)
+      {
+      capped.Start();
+      capped.Disconnected();
+      }
+   Check(capped.GetFailures(1) == WIFI_FAIL_MAX, "the failure count is capped");
+
+   wifi.Reset();
+   Check((wifi.GetFailures(1) == 0) && (wifi.get_State() == WiFiState::Idle) && (wifi.get_Attempts() == 0), "reset");
+   Check(wifi.Disconnected().type == WiFiAction::None, "idle: events ignored");
+
+   return HostTest::Result();
+   }
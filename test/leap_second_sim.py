@@ -0,0 +1,403 @@
+#!/usr/bin/env python3
+"""Host test of the leap second handling (`LeapSecond`, `BCLeapSecond` and `BinaryClock::leapTime()`).
+
+The NTP servers announce a leap second with the leap indicator (LI) of their replies: 1 inserts
+23:59:60, 2 deletes 23:59:59, at the end of the current UTC month. The synthetic announcements
+come from `ntp_standin.py` stand-in servers set to a time near the end of a month; the tracker
+is the same algorithm as `LeapSecond`. The leap is then made on a virtual DS3231 (from
+`time_slew_sim.py`) by the same plan as `BCLeapSecond`: the tick of the first second after an
+inserted leap writes 23:59:59 again and shows second 60, the tick of 23:59:59 before a deleted
+leap writes 00:00:00, or the second is smeared over a window with the slew. The virtual time
+counts SI seconds, POSIX time is a second behind (insert) or ahead (delete) after the leap.
+
+Usage:
+    leap_second_sim.py run      [--leap +1|-1] [--smear S] [--alarm SEC] [--latency MS]
+    leap_second_sim.py selftest
+
+`run` makes one leap second and prints the seconds shown around it. `selftest` checks the
+announcements (event time, cancel, hold off, missed), that :60 is shown (or 59 skipped) once,
+that an alarm in the second fires once, that the smear is linear and that the RTC is right
+after the event without a sync.
+"""
+
+import argparse
+import calendar
+import datetime
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from ntp_standin import StandinServer, query                           # noqa: E402
+from time_slew_sim import TimeSlew, VirtualRtc, BC_SLEW_MIN_MS, BC_SLEW_STEP_MS  # noqa: E402
+
+LEAP_HOLDOFF_S = 86400          # The same values as LeapSecond.h
+BC_LEAP_MIN_SMEAR_S = 2000 // BC_SLEW_STEP_MS   # BCLeapSecond.cpp
+DAY_S = 86400
+
+NONE, REPEAT, SKIP, SLEW = "none", "repeat", "skip", "slew"
+
+
+def next_month_s(utc_s):
+    """LeapSecond::NextMonthS(): 00:00:00 UTC of the 1st of the next month (H. Hinnant's algorithm)."""
+    days = utc_s // DAY_S
+    z = days + 719468
+    era = (z if z >= 0 else z - 146096) // 146097
+    doe = z - era * 146097
+    yoe = (doe - doe // 1460 + doe // 36524 - doe // 146096) // 365
+    doy = doe - (365 * yoe + yoe // 4 - yoe // 100)
+    mp = (5 * doy + 2) // 153
+    month = mp + 3 if mp < 10 else mp - 9
+    year = yoe + era * 400 + (1 if month <= 2 else 0)
+    month += 1
+    if month > 12:
+        month, year = 1, year + 1
+    year -= 1 if month <= 2 else 0
+    era = (year if year >= 0 else year - 399) // 400
+    yoe = year - era * 400
+    doy = (153 * (month - 3 if month > 2 else month + 9) + 2) // 5
+    doe = yoe * 365 + yoe // 4 - yoe // 100 + doy
+    return (era * 146097 + doe - 719468) * DAY_S
+
+
+class LeapSecond:
+    """The announcement tracker, the same algorithm as `LeapSecond`."""
+
+    def __init__(self):
+        self.event_s = 0
+        self.applied_s = 0
+        self.applied = 0
+        self.leap = 0
+
+    @property
+    def step_s(self):
+        return self.event_s - 1 if self.leap < 0 else self.event_s
+
+    def update(self, li, utc_s):
+        if li > 2:
+            return False
+        changed = False
+        if self.leap and utc_s >= self.event_s:
+            self.applied_s, self.leap, self.event_s, changed = self.event_s, 0, 0, True
+        if li == 0:
+            if self.leap:
+                self.leap, self.event_s, changed = 0, 0, True
+            return changed
+        if self.applied_s and utc_s < self.applied_s + LEAP_HOLDOFF_S:
+            return changed
+        value, event = (1 if li == 1 else -1), next_month_s(utc_s)
+        if value != self.leap or event != self.event_s:
+            self.leap, self.event_s, changed = value, event, True
+        return changed
+
+    def apply(self):
+        if self.leap:
+            self.applied_s, self.applied, self.leap, self.event_s = self.event_s, self.applied + 1, 0, 0
+
+
+class LeapPlan:
+    """The RTC plan, the same algorithm as `BCLeapSecond`."""
+
+    def __init__(self):
+        self.at_s = 0
+        self.smear_s = 0
+        self.smeared_ms = 0
+        self.leap = 0
+
+    def schedule(self, at_s, leap, smear_s=0):
+        leap = (leap > 0) - (leap < 0)
+        if smear_s and smear_s < BC_LEAP_MIN_SMEAR_S:
+            smear_s = BC_LEAP_MIN_SMEAR_S
+        if smear_s >= at_s and leap:
+            smear_s = 0
+        if (leap, at_s, smear_s) == (self.leap, self.at_s, self.smear_s):
+            return 0
+        smeared = self.smeared_ms
+        self.at_s, self.leap, self.smear_s, self.smeared_ms = at_s, leap, smear_s, 0
+        return smeared
+
+    def cancel(self):
+        self.leap, self.smeared_ms = 0, 0
+
+    def tick(self, now_s, blocked):
+        """Returns (action, slew_ms)."""
+        if not self.leap:
+            return NONE, 0
+        leap_ms = -self.leap * 1000
+        if self.smear_s:
+            start_s = self.at_s - self.smear_s
+            if now_s < start_s:
+                return NONE, 0
+            if now_s > self.at_s + 1:
+                self.cancel()
+                return NONE, 0
+            if now_s >= self.at_s:
+                delta = leap_ms - self.smeared_ms
+                self.cancel()
+                return (SLEW if delta else NONE), delta
+            target = int(leap_ms * (now_s - start_s) / self.smear_s)   # C++ truncates toward zero.
+            delta = target - self.smeared_ms
+            if -BC_SLEW_MIN_MS < delta < BC_SLEW_MIN_MS:
+                return NONE, 0
+            self.smeared_ms = target
+            return SLEW, delta
+        second_s = self.at_s if self.leap > 0 else self.at_s - 1
+        if now_s < second_s:
+            return NONE, 0
+        value = self.leap
+        self.cancel()
+        if now_s > second_s + 1:
+            return NONE, 0
+        if blocked or now_s != second_s:
+            return SLEW, leap_ms
+        return (REPEAT if value > 0 else SKIP), 0
+
+
+class Clock:
+    """`BinaryClock` on a virtual RTC: `TimeDispatch()` with `leapTime()` then `slewTime()` on each tick."""
+
+    def __init__(self, second, latency=3.0):
+        self.rtc = VirtualRtc(second=second)
+        self.rtc.start = second * 1000.0          # In phase with the virtual time.
+        self.slew = TimeSlew()
+        self.plan = LeapPlan()
+        self.latency = latency
+        self.show_leap = False
+        self.last_second = None
+        self.shown = []                            # [(second shown 0 - 60, start ms)]
+
+    def blocked(self, *seconds):
+        return any(s in self.rtc.alarms for s in seconds)
+
+    def dispatch(self, tick):
+        now = tick + self.latency
+        rtc = self.rtc
+        # leapTime()
+        if self.plan.leap or self.show_leap:
+            self.show_leap = False
+            if self.plan.leap:
+                at = self.plan.at_s
+                action, ms = self.plan.tick(rtc.second, self.blocked(at, at - 1))
+                if action in (REPEAT, SKIP):
+                    rtc.write(now, at - 1 if action == REPEAT else at)
+                    self.show_leap = action == REPEAT
+                    late = now - tick
+                    if late >= BC_SLEW_MIN_MS:
+                        self.slew.start(self.slew.remaining + int(late))
+                elif action == SLEW:
+                    self.slew.start(self.slew.remaining + ms)
+        self.shown.append((60 if self.show_leap else rtc.second % 60, now))
+
+        # slewTime()
+        if not self.slew.remaining or rtc.second == self.last_second:
+            return
+        self.last_second = rtc.second
+        shift = self.slew.next_shift(self.blocked(rtc.second, rtc.second + 1))
+        if shift == 0:
+            return
+        write_at = rtc.start + (-shift if shift < 0 else 1000 - shift)
+        if write_at < now:
+            self.slew.undo(shift)
+            return
+        if shift < 0:
+            rtc.write(write_at, rtc.second)
+            return
+        rtc.write(write_at, rtc.second + 1)       # Gain: dispatched like a tick.
+        self.dispatch(write_at)
+
+    def run_until(self, second):
+        while self.rtc.second < second:
+            tick = self.rtc.next_tick()
+            self.rtc.tick()
+            self.dispatch(tick)
+
+    def posix_offset(self, now, at, leap):
+        """RTC time - POSIX time (ms) at virtual time `now`, the leap second is in the virtual time."""
+        posix = now
+        if leap > 0 and now >= at * 1000.0 + 1000.0:
+            posix = now - 1000.0
+        elif leap < 0 and now >= (at - 1) * 1000.0:
+            posix = now + 1000.0
+        rtc_ms = self.rtc.second * 1000.0 + (now - self.rtc.start)
+        return rtc_ms - posix
+
+
+def make_leap(at, leap, smear_s=0, alarm=None, latency=3.0, before=None, after=10):
+    before = before if before is not None else max(5, smear_s + 5)
+    clock = Clock(at - before, latency)
+    if alarm is not None:
+        clock.rtc.alarms.add(alarm)
+    clock.plan.schedule(at, leap, smear_s)
+    clock.run_until(at + after)
+    return clock
+
+
+def sequence_ok(labels, leap):
+    """Each second shown once, in order: 59, 60, 0 (insert); 58, 0 (delete)."""
+    for a, b in zip(labels, labels[1:]):
+        if (a, b) in ((59, 60), (60, 0)) and leap > 0:
+            continue
+        if (a, b) == (58, 0) and leap < 0:
+            continue
+        if b != (a + 1) % 60:
+            return False
+    return True
+
+
+def durations(shown):
+    return [b[1] - a[1] for a, b in zip(shown, shown[1:])]
+
+
+def announce(li, utc, offset_s=0.0):
+    """A sync with a stand-in server set to `utc` (UTC seconds): returns (li, server time)."""
+    server = StandinServer(offset=utc - time.time() + offset_s, li=li).start()
+    try:
+        result = query(*server.address)
+    finally:
+        server.stop()
+    return result["li"], int(result["t3"])
+
+
+def check(name, condition):
+    print("  %-58s %s" % (name, "ok" if condition else "FAILED"))
+    return condition
+
+
+def selftest():
+    ok = True
+    print("Leap second self test (synthetic announcements, virtual time):")
+
+    rnd = random.Random(1)
+    times = [rnd.randrange(0, 4102444800) for _ in range(2000)]
+    times += [calendar.timegm((y, m, 1, 0, 0, 0)) + d for y in (1999, 2000, 2016, 2024, 2100)
+              for m in range(1, 13) for d in (-1, 0, 1)]
+
+    def reference(t):
+        day = datetime.datetime.fromtimestamp(t, datetime.timezone.utc)
+        first = datetime.datetime(day.year + (day.month == 12), day.month % 12 + 1, 1, tzinfo=datetime.timezone.utc)
+        return int(first.timestamp())
+    ok &= check("next month start = datetime (%d times)" % len(times), all(next_month_s(t) == reference(t) for t in times))
+
+    # Announcements from the stand-in servers, the last day of 2016 (a real leap second).
+    event = calendar.timegm((2017, 1, 1, 0, 0, 0))
+    leap = LeapSecond()
+    li, utc = announce(1, event - 12 * 3600)
+    ok &= check("LI=1 at 2016-12-31 12:00 UTC: insert", leap.update(li, utc) and leap.leap == 1)
+    ok &= check("  event 2017-01-01 00:00 UTC, step at the event", leap.event_s == event and leap.step_s == event)
+    li, utc = announce(1, event - 6 * 3600)
+    ok &= check("  announced again: unchanged", not leap.update(li, utc) and leap.leap == 1)
+    try:
+        announce(3, event - 3600)
+        rejected = False
+    except ValueError:
+        rejected = True
+    ok &= check("  LI=3 (unsynchronized): reply rejected, ignored", rejected and not leap.update(3, event - 3600))
+    li, utc = announce(0, event - 1800)
+    ok &= check("  LI=0 before the event: withdrawn", leap.update(li, utc) and leap.leap == 0 and leap.event_s == 0)
+
+    li, utc = announce(2, calendar.timegm((2024, 6, 30, 20, 0, 0)))
+    ok &= check("LI=2 on 2024-06-30: delete, step at 23:59:59",
+                leap.update(li, utc) and leap.leap == -1 and leap.step_s == calendar.timegm((2024, 7, 1, 0, 0, 0)) - 1)
+    li, utc = announce(1, calendar.timegm((2024, 6, 30, 21, 0, 0)))
+    ok &= check("  changed to LI=1: insert", leap.update(li, utc) and leap.leap == 1)
+    leap.apply()
+    li, utc = announce(1, calendar.timegm((2024, 7, 1, 0, 5, 0)))
+    ok &= check("  applied; LI=1 5 min after: held off", not leap.update(li, utc) and leap.leap == 0 and leap.applied == 1)
+    li, utc = announce(1, calendar.timegm((2024, 7, 15, 0, 0, 0)))
+    ok &= check("  LI=1 two weeks after: next leap 2024-08-01",
+                leap.update(li, utc) and leap.event_s == calendar.timegm((2024, 8, 1, 0, 0, 0)))
+
+    missed = LeapSecond()
+    missed.update(1, event - 3600)
+    ok &= check("missed (sync after the event): cleared", missed.update(0, event + 60) and missed.leap == 0)
+    ok &= check("  lagging server then: held off", not missed.update(1, event + 120) and missed.leap == 0)
+
+    # The leap second on the virtual RTC, 2016-12-31 23:59:60 UTC.
+    for value in (1, -1):
+        name = "insert" if value > 0 else "delete"
+        clock = make_leap(event, value)
+        labels = [s for s, _ in clock.shown]
+        d = durations(clock.shown)
+        end = clock.shown[-1][1]
+        ok &= check("%s: %s" % (name, "59, 60, 0 shown" if value > 0 else "58, 0 shown (59 skipped)"),
+                    sequence_ok(labels, value) and labels.count(60) == (1 if value > 0 else 0)
+                    and labels.count(59) == (1 if value > 0 else 0))
+        ok &= check("%s: seconds last 0.9 - 1.1 s" % name, all(900 - 1 <= x <= 1100 + 1 for x in d))
+        ok &= check("%s: RTC right after the event %.1f ms" % (name, clock.posix_offset(end, event, value)),
+                    abs(clock.posix_offset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency)
+
+    # An alarm in the second repeated or skipped: slewed out instead, the alarm fires once.
+    for value, alarm in ((1, event), (-1, event - 1)):
+        name = "insert" if value > 0 else "delete"
+        clock = make_leap(event, value, alarm=alarm, after=30)
+        labels = [s for s, _ in clock.shown]
+        end = clock.shown[-1][1]
+        ok &= check("%s with an alarm in the second: no :60, alarm once" % name,
+                    60 not in labels and clock.rtc.fired == [alarm] and sequence_ok(labels, 0))
+        ok &= check("%s with an alarm: slewed, RTC right %.1f ms" % (name, clock.posix_offset(end, event, value)),
+                    clock.slew.remaining == 0 and abs(clock.posix_offset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency)
+
+    # Smear over 10 minutes: linear, each second shown once, right at the end.
+    for value in (1, -1):
+        name = "insert" if value > 0 else "delete"
+        smear = 600
+        clock = Clock(event - smear - 5)
+        clock.plan.schedule(event, value, smear)
+        clock.run_until(event - smear // 2)
+        mid = clock.shown[-1][1]
+        half = clock.posix_offset(mid, event, value)
+        ok &= check("%s smear %d s: half way %.0f ms" % (name, smear, half),
+                    abs(half - (-value * 500)) <= BC_SLEW_MIN_MS + BC_SLEW_STEP_MS)
+        clock.run_until(event + 10)
+        labels = [s for s, _ in clock.shown]
+        d = durations(clock.shown)
+        end = clock.shown[-1][1]
+        ok &= check("%s smear: each second once, 0.9 - 1.1 s" % name,
+                    60 not in labels and sequence_ok(labels, 0) and all(900 - 1 <= x <= 1100 + 1 for x in d))
+        ok &= check("%s smear: RTC right after the event %.1f ms" % (name, clock.posix_offset(end, event, value)),
+                    abs(clock.posix_offset(end, event, value)) < BC_SLEW_MIN_MS + clock.latency)
+
+    # Withdrawn part way through the smear: the part smeared is returned to slew back.
+    plan = LeapPlan()
+    plan.schedule(event, 1, 600)
+    for second in range(event - 600, event - 300):
+        plan.tick(second, False)
+    smeared = plan.smeared_ms
+    ok &= check("smear withdrawn half way: %d ms to slew back" % -smeared,
+                plan.schedule(0, 0) == smeared and abs(smeared + 500) <= BC_SLEW_MIN_MS and not plan.leap)
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def cmd_run(args):
+    event = calendar.timegm((2017, 1, 1, 0, 0, 0))
+    alarm = None if args.alarm is None else event + args.alarm
+    clock = make_leap(event, args.leap, args.smear, alarm, args.latency, before=min(args.smear, 20) + 5 if args.smear else 5)
+    print("Leap %+d at 2017-01-01 00:00:00 UTC; smear %d s" % (args.leap, args.smear))
+    for (second, start), length in zip(clock.shown, durations(clock.shown) + [None]):
+        print("  :%02d at %.1f ms%s" % (second, start - event * 1000.0, "" if length is None else "; shown %.1f ms" % length))
+    end = clock.shown[-1][1]
+    print("RTC - POSIX after the event %.1f ms; alarms fired: %s" % (clock.posix_offset(end, event, args.leap),
+                                                                      [a - event for a in clock.rtc.fired]))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    run = sub.add_parser("run", help="make one leap second and print the seconds shown")
+    run.add_argument("--leap", type=int, default=1, choices=(1, -1), help="+1 insert, -1 delete")
+    run.add_argument("--smear", type=int, default=0, help="smear window in s, 0 shows :60")
+    run.add_argument("--alarm", type=int, help="an alarm N seconds from the event (0 = 00:00:00)")
+    run.add_argument("--latency", type=float, default=3.0, help="tick to dispatch latency in ms")
+    sub.add_parser("selftest", help="check the announcements and the leap on virtual time")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        return cmd_run(args)
+    return selftest()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
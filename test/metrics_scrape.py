@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""Scrape and check the metrics endpoint of the clock (`BinaryClockMetrics` and `BCMetrics`).
+
+The clock answers `GET /metrics` on TCP port 9100 in the Prometheus text format (version 0.0.4):
+  - a `# HELP` and a `# TYPE` line once per metric name, then its samples;
+  - the counters (`*_total`) are always there, a gauge that was never set isn't (e.g. the NTP
+    offset before the first sync, the stack of a task that isn't running);
+  - `HEAD` gets the header only, another path 404, another method 405, not HTTP 400;
+  - one client at a time, `Connection: close`; a client that doesn't send its request within
+    METRICS_CLIENT_MS is dropped.
+
+Usage:
+    metrics_scrape.py scrape   --host HOST [--port 9100] [--watch S] [--count N]
+    metrics_scrape.py serve    [--port 9100]
+    metrics_scrape.py selftest
+
+`scrape` reads the metrics of a clock, checks the text format and prints the samples; `--watch 5`
+scrapes every 5 s and prints the counter rates (ticks, I2C transactions, NTP syncs).
+`serve` runs a stand-in of the clock's endpoint with the same registry, rendering and routing as
+`BCMetrics.h` and `BinaryClockMetrics.cpp` (e.g. to try a Prometheus scrape config).
+`selftest` scrapes the stand-in over the loopback interface: the status codes, the headers, the
+text format, the unset gauges, the worst case size against METRICS_BUFFER_SIZE and a slow client.
+"""
+
+import argparse
+import http.client
+import re
+import socket
+import sys
+import threading
+import time
+
+METRICS_PORT = 9100             # The same values as BinaryClockMetrics.h and MetricsHttp.h
+METRICS_BUFFER_SIZE = 2560
+METRICS_CLIENT_MS = 500
+CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8"
+INT32_MIN = -(1 << 31)
+UNSET = INT32_MIN               # BC_METRIC_UNSET
+
+STACK_HELP = "The stack high water mark (bytes) of the task, the least stack free."
+# The same table as BCMetrics::GetInfo(): name, help, counter, task label.
+REGISTRY = [
+    ("bc_tick_latency_us",        "The time (us) from the RTC tick interrupt to the time read, last tick.", False, None),
+    ("bc_tick_latency_max_us",    "The largest tick latency (us) since boot.",                              False, None),
+    ("bc_ticks_total",            "The RTC ticks dispatched to the display.",                               True,  None),
+    ("bc_ticks_missed_total",     "The RTC seconds skipped between two dispatched ticks.",                  True,  None),
+    ("bc_i2c_transactions_total", "The I2C transactions made with the RTC.",                                True,  None),
+    ("bc_ntp_offset_us",          "The offset (us) of the last NTP sync, server - system time.",            False, None),
+    ("bc_ntp_delay_us",           "The round trip delay (us) of the last NTP query.",                       False, None),
+    ("bc_ntp_syncs_total",        "The successful NTP syncs.",                                              True,  None),
+    ("bc_ntp_failures_total",     "The failed NTP syncs.",                                                  True,  None),
+    ("bc_wifi_rssi_dbm",          "The signal strength (dBm) of the AP connected to.",                      False, None),
+    ("bc_wifi_reconnects_total",  "The WiFi connections lost, reconnected by the state machine.",           True,  None),
+    ("bc_heap_free_bytes",        "The free heap (bytes).",                                                 False, None),
+    ("bc_heap_min_free_bytes",    "The lowest free heap (bytes) since boot.",                               False, None),
+    ("bc_stack_free_bytes",       STACK_HELP,                                                               False, "TimeTask"),
+    ("bc_stack_free_bytes",       STACK_HELP,                                                               False, "CallbackTask"),
+    ("bc_stack_free_bytes",       STACK_HELP,                                                               False, "WiFiDutyTask"),
+    ("bc_stack_free_bytes",       STACK_HELP,                                                               False, "MetricsTask"),
+]
+
+NAME = re.compile(r"^[a-zA-Z_:][a-zA-Z0-9_:]*$")
+SAMPLE = re.compile(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{([a-zA-Z_][a-zA-Z0-9_]*="(?:[^"\\\n]|\\.)*"'
+                    r'(?:,[a-zA-Z_][a-zA-Z0-9_]*="(?:[^"\\\n]|\\.)*")*)?\})? (\S+)$')
+
+
+def render(values, size=METRICS_BUFFER_SIZE):
+    """BCMetrics::Render(): the text, or None if it doesn't fit in `size` bytes with its NUL."""
+    lines = []
+    last = None
+    for (name, help_text, counter, task), value in zip(REGISTRY, values):
+        if not counter and value == UNSET:
+            continue
+        if name != last:
+            lines.append("# HELP %s %s\n# TYPE %s %s\n" % (name, help_text, name, "counter" if counter else "gauge"))
+            last = name
+        label = '{task="%s"}' % task if task else ""
+        lines.append("%s%s %d\n" % (name, label, value & 0xFFFFFFFF if counter else value))
+    text = "".join(lines)
+    return text if len(text.encode()) < size else None
+
+
+def route(request):
+    """BinaryClockMetrics::Route(): (status, head) of the request line."""
+    head = request.startswith("HEAD ")
+    parts = request.split("\r\n", 1)[0].split(" ")
+    if len(parts) < 3 or not parts[2].startswith("HTTP/1."):
+        return 400, head
+    if not head and not request.startswith("GET "):
+        return 405, head
+    return (200 if parts[1].split("?", 1)[0] == "/metrics" else 404), head
+
+
+def parse(text):
+    """Check the Prometheus text format, returns ({(name, labels): value}, {name: type}, [errors])."""
+    samples, types, helps, errors = {}, {}, set(), []
+    seen = set()
+    if text and not text.endswith("\n"):
+        errors.append("the text doesn't end with a newline")
+    for number, line in enumerate(text.split("\n")[:-1], 1):
+        if line.startswith("# HELP ") or line.startswith("# TYPE "):
+            fields = line.split(" ", 3)
+            if len(fields) < 4 or not NAME.match(fields[2]):
+                errors.append("line %d: malformed %s" % (number, line))
+                continue
+            name = fields[2]
+            if fields[1] == "HELP":
+                if name in helps:
+                    errors.append("line %d: a second HELP for %s" % (number, name))
+                helps.add(name)
+            else:
+                if name in types:
+                    errors.append("line %d: a second TYPE for %s" % (number, name))
+                if name in seen:
+                    errors.append("line %d: the TYPE of %s after its samples" % (number, name))
+                if fields[3] not in ("counter", "gauge", "histogram", "summary", "untyped"):
+                    errors.append("line %d: unknown type %s" % (number, fields[3]))
+                types[name] = fields[3]
+            continue
+        if line.startswith("#") or not line:
+            continue
+        match = SAMPLE.match(line)
+        if not match:
+            errors.append("line %d: malformed sample %s" % (number, line))
+            continue
+        name, labels, value = match.group(1), match.group(3) or "", match.group(4)
+        try:
+            number_value = float(value)
+        except ValueError:
+            errors.append("line %d: the value of %s isn't a number" % (number, name))
+            continue
+        if (name, labels) in samples:
+            errors.append("line %d: a second sample of %s{%s}" % (number, name, labels))
+        if types.get(name) == "counter" and number_value < 0:
+            errors.append("line %d: the counter %s is negative" % (number, name))
+        seen.add(name)
+        samples[(name, labels)] = number_value
+    return samples, types, errors
+
+
+def request(host, port, method="GET", path="/metrics", timeout=5.0):
+    """One request, returns (status, headers, body)."""
+    connection = http.client.HTTPConnection(host, port, timeout=timeout)
+    try:
+        connection.request(method, path)
+        response = connection.getresponse()
+        return response.status, dict((k.lower(), v) for k, v in response.getheaders()), response.read().decode()
+    finally:
+        connection.close()
+
+
+class StandIn:
+    """The clock's endpoint: one client at a time, the request line within METRICS_CLIENT_MS."""
+
+    def __init__(self, values, host="127.0.0.1", port=0):
+        self.values = values
+        self.scrapes = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind((host, port))
+        self.sock.listen(2)
+        self.sock.settimeout(0.2)
+        self.port = self.sock.getsockname()[1]
+        self.running = True
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def answer(self, client):
+        client.settimeout(METRICS_CLIENT_MS / 1000.0)
+        data = b""
+        try:
+            while len(data) < 255 and b"\r\n" not in data:
+                chunk = client.recv(255 - len(data))
+                if not chunk:
+                    break
+                data += chunk
+        except socket.timeout:
+            pass
+        if not data:
+            return
+        status, head = route(data.decode("latin-1"))
+        text = ""
+        if status == 200:
+            text = render(self.values)
+            if text is None:
+                status, text = 500, ""
+            else:
+                self.scrapes += 1
+        reason = {200: "OK", 404: "Not Found", 405: "Method Not Allowed", 400: "Bad Request"}.get(status, "Internal Server Error")
+        header = "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n%sConnection: close\r\n\r\n" % (
+            status, reason, CONTENT_TYPE if status == 200 else "text/plain", len(text.encode()),
+            "Allow: GET, HEAD\r\n" if status == 405 else "")
+        client.sendall(header.encode() + (b"" if head else text.encode()))
+
+    def run(self):
+        while self.running:
+            try:
+                client, _ = self.sock.accept()
+            except socket.timeout:
+                continue
+            except OSError:
+                break
+            try:
+                self.answer(client)
+            except OSError:
+                pass
+            finally:
+                client.close()
+
+    def stop(self):
+        self.running = False
+        self.thread.join()
+        self.sock.close()
+
+
+def sample_values():
+    """A clock an hour after boot, NTP synced, the WiFi duty task not running."""
+    values = [412, 1873, 3600, 2, 7214, -1830, 24512, 12, 1, -61, 1, 182340, 170112, 1460, 2210, UNSET, 2780]
+    assert len(values) == len(REGISTRY)
+    return values
+
+
+def cmd_scrape(args):
+    last, last_time = None, None
+    for index in range(args.count):
+        if index:
+            time.sleep(args.watch)
+        status, headers, body = request(args.host, args.port)
+        now = time.monotonic()
+        if status != 200:
+            print("HTTP %d" % status)
+            return 1
+        samples, types, errors = parse(body)
+        for error in errors:
+            print("format: " + error)
+        if last is None:
+            for (name, labels), value in sorted(samples.items()):
+                print("  %-45s %14.0f" % (name + ("{%s}" % labels if labels else ""), value))
+            print("%d samples, %d bytes of %d" % (len(samples), len(body), METRICS_BUFFER_SIZE))
+        else:
+            rates = ["%s %.2f/s" % (name, (samples.get((name, "")) - last.get((name, ""))) / (now - last_time))
+                     for name in ("bc_ticks_total", "bc_i2c_transactions_total", "bc_ntp_syncs_total")
+                     if (name, "") in samples and (name, "") in last]
+            print("  ".join(rates) + "  latency %s us" % samples.get(("bc_tick_latency_us", ""), "-"))
+        if errors:
+            return 1
+        last, last_time = samples, now
+    return 0
+
+
+def cmd_serve(args):
+    server = StandIn(sample_values(), "0.0.0.0", args.port)
+    print("Serving the stand-in metrics on http://0.0.0.0:%d/metrics (Ctrl+C to stop)" % server.port)
+    try:
+        while True:
+            time.sleep(1.0)
+    except KeyboardInterrupt:
+        server.stop()
+    return 0
+
+
+def check(name, condition):
+    print("  %-50s %s" % (name, "ok" if condition else "FAILED"))
+    return condition
+
+
+def selftest():
+    ok = True
+    print("Metrics endpoint self test:")
+
+    values = sample_values()
+    server = StandIn(values)
+    host, port = "127.0.0.1", server.port
+    status, headers, body = request(host, port)
+    samples, types, errors = parse(body)
+    ok &= check("GET /metrics: 200, text format 0.0.4", status == 200 and headers.get("content-type") == CONTENT_TYPE)
+    ok &= check("Content-Length is the text's", int(headers.get("content-length", -1)) == len(body.encode()))
+    ok &= check("the text format is valid", not errors)
+    ok &= check("all the counters are there", all((name, "") in samples for name, _, counter, _ in REGISTRY if counter))
+    ok &= check("HELP and TYPE once for the stack samples",
+                body.count("# TYPE bc_stack_free_bytes") == 1 and types.get("bc_stack_free_bytes") == "gauge")
+    ok &= check("an unset gauge isn't rendered", ("bc_stack_free_bytes", 'task="WiFiDutyTask"') not in samples
+                and ("bc_stack_free_bytes", 'task="MetricsTask"') in samples)
+    ok &= check("the values are the registry's", samples.get(("bc_ntp_offset_us", "")) == -1830
+                and samples.get(("bc_wifi_rssi_dbm", "")) == -61)
+
+    status, headers, head_body = request(host, port, "HEAD")
+    ok &= check("HEAD: the header only", status == 200 and head_body == "" and int(headers["content-length"]) == len(body.encode()))
+    status, _, _ = request(host, port, "GET", "/metrics?name[]=bc_ticks_total")
+    ok &= check("the query string is ignored", status == 200)
+    status, _, _ = request(host, port, "GET", "/")
+    ok &= check("another path: 404", status == 404)
+    status, headers, _ = request(host, port, "POST")
+    ok &= check("another method: 405 with Allow", status == 405 and headers.get("allow") == "GET, HEAD")
+    with socket.create_connection((host, port), timeout=2.0) as client:
+        client.sendall(b"not a request\r\n\r\n")
+        ok &= check("not HTTP: 400", client.recv(64).startswith(b"HTTP/1.1 400 "))
+
+    start = time.monotonic()
+    with socket.create_connection((host, port), timeout=2.0):
+        time.sleep(0.05)     # Connected, the request never comes.
+        status, _, _ = request(host, port)
+    elapsed = time.monotonic() - start
+    ok &= check("a silent client is dropped (%.0f ms)" % (elapsed * 1000.0),
+                status == 200 and elapsed < (METRICS_CLIENT_MS / 1000.0) + 0.4)
+
+    counters = [0xFFFFFFFF if counter else INT32_MIN + 1 for _, _, counter, _ in REGISTRY]
+    worst = render(counters, 1 << 16)
+    ok &= check("the worst case fits METRICS_BUFFER_SIZE (%d bytes)" % len(worst), render(counters) is not None)
+    wrapped = [-1 if counter else UNSET for _, _, counter, _ in REGISTRY]
+    samples, _, errors = parse(render(wrapped))
+    ok &= check("the counters are unsigned 32 bit", not errors and samples[("bc_ticks_total", "")] == 4294967295)
+    ok &= check("a buffer too small fails the scrape", render(values, 256) is None)
+    _, _, errors = parse("# TYPE bc_x counter\nbc_x -1\nbc_y{task=TimeTask} 1\n# TYPE bc_x gauge\n")
+    ok &= check("the checker rejects a malformed text", len(errors) == 4)   # Negative; label; TYPE twice, after the samples.
+    scrapes = server.scrapes
+    server.stop()
+    ok &= check("the scrapes are counted (%d)" % scrapes, scrapes == 4)
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    scrape = sub.add_parser("scrape", help="scrape a clock and check the text format")
+    scrape.add_argument("--host", required=True)
+    scrape.add_argument("--port", type=int, default=METRICS_PORT)
+    scrape.add_argument("--watch", type=float, default=5.0, help="seconds between the scrapes")
+    scrape.add_argument("--count", type=int, default=1, help="the number of scrapes")
+
+    serve = sub.add_parser("serve", help="run a stand-in of the clock's endpoint")
+    serve.add_argument("--port", type=int, default=METRICS_PORT)
+
+    sub.add_parser("selftest", help="scrape the stand-in over the loopback interface")
+
+    args = parser.parse_args()
+    if args.command == "scrape":
+        return cmd_scrape(args)
+    if args.command == "serve":
+        return cmd_serve(args)
+    return selftest()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
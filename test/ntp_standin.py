@@ -0,0 +1,952 @@
+#!/usr/bin/env python3
+"""Local NTP stand-in server and client for host tests of `BinaryClockNTP`.
+
+The server answers NTPv4 client requests on a UDP port with a configurable
+clock error and network delay, so the offset and delay computed by
+`BinaryClockNTP::QueryServer()` can be checked against known values:
+
+    offset = ((T2 - T1) + (T3 - T4)) / 2
+    delay  = (T4 - T1) - (T3 - T2)
+
+Usage:
+    ntp_standin.py serve    [--host 0.0.0.0] [--port 12300] [--offset SEC] [--delay SEC]
+                            [--stratum N] [--li N] [--kod CODE] [--count N]
+    ntp_standin.py query    SERVER[:PORT] ... [--port 123] [--timeout SEC] [--burst N]
+    ntp_standin.py poll     [--ppm PPM] [--noise SEC] [--steps N] [--change N:PPM] [--kod N:POLL]
+    ntp_standin.py duty     [--ppm PPM] [--days N] [--connect SEC] [--fail RATE]
+    ntp_standin.py dns      [--port 5353] --record NAME=ADDRESS[:TTL] ... [--cname ALIAS=NAME[:TTL]]
+    ntp_standin.py selftest
+
+`serve` runs a stand-in server (point `NTP_SERVER_LIST` / `NTP_DEFAULT_PORT` of a
+test build at it). `--offset` is added to the server clock, `--delay` is the
+round trip delay, half on each path. `--kod` sends a Kiss-o'-Death reply
+(stratum 0) with the code, e.g. RATE. `--count N` runs N servers on consecutive ports,
+`--offset` and `--delay` then take comma separated values per server, e.g. a
+liar: `--count 4 --offset 0,0,0,2.5 --delay 0.01,0.03,0.06,0.005`.
+`query` is a client using the same math as the firmware; with several servers
+they are queried together on one socket and the time is selected with the
+intersection algorithm of `NtpClockFilter`. `--burst N` sends N requests back to back to
+check a server's rate limit, e.g. a clock running `BinaryClockNtpServer`. `poll` runs the adaptive poll interval of
+`NtpPollController` against a synthetic drift trace: the clock drifts `--ppm`, each sync measures
+the drift over the interval plus gaussian `--noise`; `--change 30:50` changes the drift at sync 30,
+`--kod 5:12` sends a KoD RATE with poll 12 at sync 5. `selftest` checks the client against stand-in
+servers on the loopback interface and the poll controller against drift traces.
+`duty` runs the WiFi radio duty cycle of `RadioDutyCycle` with the poll controller for `--days`:
+each wake reconnects in about `--connect` seconds, `--fail` is the fraction of wakes that don't
+connect; it prints the radio on time per day and the average current the radio adds.
+`dns` is a stub resolver with fixed records for `DnsCache` (set it as the DNS server of a test
+build); the selftest checks the cache rules against it: TTL, serve stale, refresh and fallback.
+"""
+
+import argparse
+import math
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+
+NTP_PORT = 123
+NTP_UNIX_DELTA = 2208988800
+PACKET = struct.Struct("!BBbbIII8s8s8s8s")   # li_vn_mode, stratum, poll, precision, root delay/dispersion, refid, 4 timestamps
+PACKET_SIZE = PACKET.size                    # 48
+
+
+def to_ntp(unix_seconds):
+    """Unix time (float seconds) to the 64-bit NTP timestamp bytes."""
+    seconds = int(unix_seconds)
+    fraction = int((unix_seconds - seconds) * (1 << 32)) & 0xFFFFFFFF
+    return struct.pack("!II", (seconds + NTP_UNIX_DELTA) & 0xFFFFFFFF, fraction)
+
+
+def from_ntp(data):
+    """The 64-bit NTP timestamp bytes to Unix time (float seconds), same era rule as the firmware."""
+    seconds, fraction = struct.unpack("!II", data)
+    unix = seconds - NTP_UNIX_DELTA if seconds >= NTP_UNIX_DELTA else seconds + (1 << 32) - NTP_UNIX_DELTA
+    return unix + fraction / float(1 << 32)
+
+
+class StandinServer:
+    """A NTP server with a known clock error and delay, runs on its own thread."""
+
+    def __init__(self, host="127.0.0.1", port=0, offset=0.0, delay=0.0, stratum=2, li=0, kod=None, refid=b"STND"):
+        self.offset = offset
+        self.delay = delay
+        self.stratum = stratum
+        self.li = li
+        self.kod = kod
+        self.refid = refid
+        self.requests = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind((host, port))
+        self.sock.settimeout(0.2)
+        self.address = self.sock.getsockname()
+        self._stop = threading.Event()
+        self._thread = threading.Thread(target=self.run, daemon=True)
+
+    def now(self):
+        return time.time() + self.offset
+
+    def start(self):
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop.set()
+        self._thread.join()
+        self.sock.close()
+
+    def run(self):
+        while not self._stop.is_set():
+            try:
+                data, client = self.sock.recvfrom(512)
+            except socket.timeout:
+                continue
+            if len(data) < PACKET_SIZE or (data[0] & 0x07) != 3:
+                continue
+            self.requests += 1
+            # Each reply is sent from its own thread so a delayed reply doesn't hold the others.
+            threading.Thread(target=self.reply, args=(data, client), daemon=True).start()
+
+    def build_reply(self, request, receive, transmit):
+        version = (request[0] >> 3) & 0x07
+        origin = request[40:48]
+        if self.kod:
+            return PACKET.pack((3 << 6) | (version << 3) | 4, 0, request[2], -20, 0, 0,
+                               struct.unpack("!I", self.kod.encode().ljust(4)[:4])[0],
+                               bytes(8), origin, bytes(8), bytes(8))
+        return PACKET.pack((self.li << 6) | (version << 3) | 4, self.stratum, request[2], -20, 0x10, 0x20,
+                           struct.unpack("!I", self.refid.ljust(4)[:4])[0],
+                           to_ntp(receive - 16), origin, to_ntp(receive), to_ntp(transmit))
+
+    def reply(self, request, client):
+        time.sleep(self.delay / 2)
+        receive = self.now()
+        transmit = self.now()
+        packet = self.build_reply(request, receive, transmit)
+        time.sleep(self.delay / 2)
+        try:
+            self.sock.sendto(packet, client)
+        except OSError:
+            pass
+
+
+def query(server, port=NTP_PORT, timeout=1.0):
+    """One NTP exchange, returns a dict with t1..t4, offset, delay (seconds), or raises on failure."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.settimeout(timeout)
+        t1 = time.time()
+        transmit = to_ntp(t1)
+        request = PACKET.pack((0 << 6) | (4 << 3) | 3, 0, 0, 0, 0, 0, 0, bytes(8), bytes(8), bytes(8), transmit)
+        sock.sendto(request, (server, port))
+        deadline = t1 + timeout
+        while True:
+            data, _ = sock.recvfrom(512)
+            t4 = time.time()
+            if len(data) >= PACKET_SIZE and data[24:32] == transmit:
+                break
+            if t4 >= deadline:
+                raise TimeoutError("no matching reply")
+    fields = PACKET.unpack(data[:PACKET_SIZE])
+    li, mode, stratum = fields[0] >> 6, fields[0] & 0x07, fields[1]
+    if mode != 4 or li == 3 or stratum == 0:
+        code = struct.pack("!I", fields[6]).decode(errors="replace") if stratum == 0 else ""
+        raise ValueError("server not usable: li=%d mode=%d stratum=%d %s" % (li, mode, stratum, code))
+    t2, t3 = from_ntp(fields[9]), from_ntp(fields[10])
+    return {"t1": t1, "t2": t2, "t3": t3, "t4": t4,
+            "offset": ((t2 - t1) + (t3 - t4)) / 2, "delay": (t4 - t1) - (t3 - t2),
+            "stratum": stratum, "li": li, "poll": fields[2], "refid": fields[6],
+            "root_delay": fields[4] / 65536.0, "root_dispersion": fields[5] / 65536.0}
+
+
+def refid_text(stratum, refid):
+    """The reference ID: an IPv4 address for stratum 2 and up, else 4 ASCII characters."""
+    if stratum >= 2:
+        return socket.inet_ntoa(struct.pack("!I", refid))
+    return struct.pack("!I", refid).decode(errors="replace").rstrip("\0")
+
+
+def burst(server, port, count, timeout=0.5):
+    """Send `count` requests back to back, returns (replies, kisses, timeouts): checks a server's rate limit."""
+    replies = kisses = timeouts = 0
+    for _ in range(count):
+        try:
+            query(server, port, timeout)
+            replies += 1
+        except ValueError:
+            kisses += 1
+        except (TimeoutError, socket.timeout):
+            timeouts += 1
+    return replies, kisses, timeouts
+
+
+MIN_DISPERSION = 0.005     # NTP_MIN_DISPERSION_US
+GATHER_MIN = 0.025         # NTP_GATHER_MIN_MS
+
+
+def root_distance(delay, root_delay, root_dispersion):
+    """Same as `NtpClockFilter::RootDistance()`."""
+    return (root_delay + max(delay, 0.0)) / 2 + root_dispersion + MIN_DISPERSION
+
+
+def select(samples):
+    """The intersection algorithm of `NtpClockFilter::Select()`.
+
+    `samples` is a list of (offset, distance). Returns (offset, best index, survivor indexes)
+    or None when no majority agrees.
+    """
+    count = len(samples)
+    if count == 0:
+        return None
+    points = sorted([(o - d, +1) for o, d in samples] + [(o + d, -1) for o, d in samples], key=lambda p: (p[0], -p[1]))
+    found = None
+    falsetickers = 0
+    while 2 * falsetickers < count and found is None:
+        needed = count - falsetickers
+        falsetickers += 1
+        overlap, low = 0, None
+        for value, kind in points:
+            overlap += kind
+            if overlap >= needed:
+                low = value
+                break
+        if low is None:
+            continue
+        overlap, high = 0, None
+        for value, kind in reversed(points):
+            overlap -= kind
+            if overlap >= needed:
+                high = value
+                break
+        if low <= high:
+            found = (low, high)
+    if found is None:
+        return None
+    low, high = found
+    survivors = [i for i, (o, d) in enumerate(samples) if o - d <= high and o + d >= low]
+    weights = [1.0 / max(samples[i][1], 1e-6) for i in survivors]
+    offset = sum(w * samples[i][0] for w, i in zip(weights, survivors)) / sum(weights)
+    best = min(survivors, key=lambda i: samples[i][1])
+    return offset, best, survivors
+
+
+def query_many(servers, timeout=1.0):
+    """Query all the (host, port) servers together on one socket, like `BinaryClockNTP::QueryServers()`.
+
+    Returns (selection or None, samples, elapsed seconds), `samples` maps the server index to the
+    `query()` style dict.
+    """
+    start = time.time()
+    pending = {}
+    samples = {}
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        for index, (host, port) in enumerate(servers):
+            t1 = time.time()
+            transmit = to_ntp(t1)
+            request = PACKET.pack((4 << 3) | 3, 0, 0, 0, 0, 0, 0, bytes(8), bytes(8), bytes(8), transmit)
+            sock.sendto(request, (socket.gethostbyname(host), port))
+            pending[(socket.gethostbyname(host), port, transmit)] = (index, t1)
+        deadline = start + timeout
+        gathering = False
+        while pending:
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                break
+            sock.settimeout(remaining)
+            try:
+                data, source = sock.recvfrom(512)
+            except socket.timeout:
+                break
+            t4 = time.time()
+            key = (source[0], source[1], data[24:32])
+            if len(data) < PACKET_SIZE or key not in pending:
+                continue
+            index, t1 = pending.pop(key)
+            fields = PACKET.unpack(data[:PACKET_SIZE])
+            if (fields[0] & 0x07) != 4 or (fields[0] >> 6) == 3 or fields[1] == 0:
+                continue
+            t2, t3 = from_ntp(fields[9]), from_ntp(fields[10])
+            sample = {"t1": t1, "t2": t2, "t3": t3, "t4": t4, "offset": ((t2 - t1) + (t3 - t4)) / 2,
+                      "delay": (t4 - t1) - (t3 - t2)}
+            sample["distance"] = root_distance(sample["delay"], fields[4] / 65536.0, fields[5] / 65536.0)
+            samples[index] = sample
+            if 2 * len(samples) > len(servers) and not gathering:
+                gathering = True
+                deadline = min(deadline, t4 + max(sample["delay"], GATHER_MIN))
+    order = sorted(samples)
+    selection = select([(samples[i]["offset"], samples[i]["distance"]) for i in order])
+    if selection is not None:
+        offset, best, survivors = selection
+        selection = (offset, order[best], [order[i] for i in survivors])
+    return selection, samples, time.time() - start
+
+
+NTP_MIN_POLL = 6               # The same values as NtpPollController.h
+NTP_MAX_POLL = 17
+NTP_START_POLL = 10
+NTP_POLL_LIMIT = 30
+NTP_OFFSET_TOLERANCE = 0.05    # seconds
+
+
+class PollController:
+    """The adaptive poll interval, the same algorithm as `NtpPollController` (offsets in seconds)."""
+
+    def __init__(self, tolerance=NTP_OFFSET_TOLERANCE):
+        self.tolerance = tolerance
+        self.poll = NTP_START_POLL
+        self.rate_floor = NTP_MIN_POLL
+        self.count = 0
+        self.jitter = 0.0
+        self.drift = 0.0                        # seconds per second
+        self.last_offset = None
+
+    @property
+    def interval(self):
+        return 1 << self.poll
+
+    def update(self, offset, elapsed):
+        if self.last_offset is not None:
+            expected = self.drift * elapsed if elapsed > 0 else self.last_offset
+            self.jitter = math.sqrt((3.0 * self.jitter ** 2 + (offset - expected) ** 2) / 4.0)
+        if elapsed > 0:
+            measured = offset / elapsed
+            self.drift = (3.0 * self.drift + measured) / 4.0 if self.last_offset is not None else measured
+        self.last_offset = offset
+
+        if abs(offset) <= self.tolerance and self.jitter <= self.tolerance:
+            self.count += self.poll
+            if self.count >= NTP_POLL_LIMIT:
+                self.count = 0
+                self.poll += 1
+        else:
+            self.count -= 2 * self.poll
+            if self.count <= -NTP_POLL_LIMIT or abs(offset) > 4 * self.tolerance:
+                self.count = 0
+                self.poll -= 1
+
+        drift = abs(self.drift)
+        if elapsed > 0:
+            drift -= self.jitter / elapsed
+        if drift > 0.0:
+            while self.poll > NTP_MIN_POLL and (1 << self.poll) > self.tolerance / drift:
+                self.poll -= 1
+        self.clamp()
+        return self.interval
+
+    def rate_limit(self, server_poll):
+        self.rate_floor = max(self.rate_floor, min(max(self.poll + 1, server_poll), NTP_MAX_POLL))
+        self.count = 0
+        self.clamp()
+        return self.interval
+
+    def failed(self):
+        self.count = 0
+        self.poll -= 1
+        self.clamp()
+        return self.interval
+
+    def clamp(self):
+        self.poll = min(max(self.poll, self.rate_floor, NTP_MIN_POLL), NTP_MAX_POLL)
+
+
+WIFI_DUTY_LEAD = 2.0           # The same values as RadioDutyCycle.h (seconds, mA)
+WIFI_DUTY_LEAD_MARGIN = 0.5
+WIFI_DUTY_LEAD_MAX = 30.0
+WIFI_DUTY_MIN_SLEEP = 30.0
+WIFI_DUTY_RETRY = 60.0
+WIFI_DUTY_ON_MA = 100.0
+
+
+class DutyCycle:
+    """The WiFi radio schedule around the syncs, the same algorithm as `RadioDutyCycle` (seconds)."""
+
+    def __init__(self, now=0.0):
+        self.on = True
+        self.waking = False
+        self.start = self.last = self.wake_time = now
+        self.on_time = 0.0
+        self.connect = WIFI_DUTY_LEAD
+        self.lead = WIFI_DUTY_LEAD + WIFI_DUTY_LEAD_MARGIN
+        self.retry = WIFI_DUTY_RETRY
+        self.wakes = 0
+        self.failures = 0
+
+    def advance(self, now):
+        if self.on:
+            self.on_time += now - self.last
+        self.last = now
+
+    def wake(self, now):
+        self.advance(now)
+        if not self.on:
+            self.on = self.waking = True
+            self.wake_time = now
+            self.wakes += 1
+
+    def connected(self, now):
+        self.advance(now)
+        if self.waking:
+            self.connect = (3.0 * self.connect + (now - self.wake_time)) / 4.0
+            self.lead = min(self.connect + WIFI_DUTY_LEAD_MARGIN, WIFI_DUTY_LEAD_MAX)
+        self.waking = False
+        self.retry = WIFI_DUTY_RETRY
+
+    def synced(self, now, success, interval):
+        self.advance(now)
+        if success:
+            self.retry = WIFI_DUTY_RETRY
+        if interval >= self.lead + WIFI_DUTY_MIN_SLEEP:
+            self.on = False
+            return interval - self.lead
+        self.on = True
+        return interval
+
+    def failed(self, now, interval):
+        self.advance(now)
+        self.failures += 1
+        self.on = self.waking = False
+        delay = self.retry
+        longest = max(interval, WIFI_DUTY_RETRY)
+        self.retry = 2 * self.retry if self.retry < longest / 2 else longest
+        return delay
+
+    def on_per_day(self, now):
+        return self.on_time * 86400.0 / (now - self.start) if now > self.start else 0.0
+
+    def average_ma(self, now):
+        return self.on_time * WIFI_DUTY_ON_MA / (now - self.start) if now > self.start else 0.0
+
+
+def duty_trace(ppm, days=7.0, connect=1.0, fail=0.0, noise=0.002, seed=1):
+    """Run `DutyCycle` with `PollController` for `days`, returns (duty, now, syncs, late) where `late`
+    is the latest a sync started after its scheduled time once the lead settled (4 syncs), in seconds."""
+    rng = random.Random(seed)
+    controller = PollController()
+    duty = DutyCycle()
+    now, syncs, late = 5.0, 0, 0.0
+    due = now                                # The scheduled time of the next sync.
+    last_sync = None
+    end = days * 86400.0
+    while now < end:
+        duty.wake(now)
+        if rng.random() < fail:
+            now += 15.0                      # The attempt timeout.
+            now += duty.failed(now, controller.interval)
+            continue
+        if not duty.waking and not duty.on:
+            raise AssertionError("woke with the radio off")
+        now += max(0.1, rng.gauss(connect, connect / 4.0)) if duty.waking else 0.0
+        duty.connected(now)
+        if syncs >= 4:
+            late = max(late, now - due)
+        elapsed = now - last_sync if last_sync is not None else 0
+        offset = ppm * 1e-6 * elapsed + rng.gauss(0.0, noise)
+        interval = controller.update(offset, elapsed) if last_sync is not None else controller.interval
+        last_sync = now
+        syncs += 1
+        now += 0.15                          # The NTP exchange.
+        due = last_sync + interval
+        now += duty.synced(now, True, interval - 0.15)
+    duty.advance(now)
+    return duty, now, syncs, late
+
+
+def drift_trace(ppm, noise=0.002, steps=60, change=None, kod=None, seed=1):
+    """Run `PollController` on a synthetic drift trace, returns a list of (time, offset, poll)."""
+    rng = random.Random(seed)
+    controller = PollController()
+    interval = controller.interval
+    now = 0.0
+    trace = []
+    for step in range(steps):
+        if change and step == change[0]:
+            ppm = change[1]
+        offset = ppm * 1e-6 * interval + rng.gauss(0.0, noise)
+        now += interval
+        if kod and step == kod[0]:
+            interval = controller.rate_limit(kod[1])
+        else:
+            interval = controller.update(offset, interval)
+        trace.append((now, offset, controller.poll))
+    return trace
+
+
+DNS_CACHE_MIN_TTL = 60          # The same values as DnsCache.h (seconds)
+DNS_CACHE_MAX_TTL = 86400
+DNS_CACHE_REFRESH = 60
+DNS_CACHE_STALE = 604800
+DNS_TYPE_A = 1
+DNS_TYPE_CNAME = 5
+
+
+def dns_name(name):
+    """A host name as DNS labels."""
+    return b"".join(bytes([len(label)]) + label.encode() for label in name.rstrip(".").split(".")) + b"\0"
+
+
+def dns_make_query(name, query_id):
+    """The A query, the same as `DnsCache::MakeQuery()`."""
+    return struct.pack("!HHHHHH", query_id, 0x0100, 1, 0, 0, 0) + dns_name(name) + struct.pack("!HH", DNS_TYPE_A, 1)
+
+
+def dns_skip_name(data, offset):
+    while offset < len(data):
+        length = data[offset]
+        if length == 0:
+            return offset + 1
+        if length & 0xC0 == 0xC0:
+            return offset + 2
+        offset += 1 + length
+    raise ValueError("name past the end")
+
+
+def dns_parse_reply(data, query_id):
+    """The reply to a query, the same rules as `DnsCache::ParseReply()`.
+
+    Returns (address, ttl) for the first A record, the TTL is the smallest up to it; None when the
+    name has no address; raises ValueError for a malformed reply or another query's.
+    """
+    if len(data) < 12:
+        raise ValueError("short reply")
+    ident, flags, questions, answers = struct.unpack("!HHHH", data[:8])
+    if ident != query_id or not flags & 0x8000:
+        raise ValueError("not the reply to the query")
+    if flags & 0x000F:
+        return None
+    offset = 12
+    for _ in range(questions):
+        offset = dns_skip_name(data, offset) + 4
+    ttl_min = None
+    for _ in range(answers):
+        offset = dns_skip_name(data, offset)
+        rtype, rclass, ttl, length = struct.unpack("!HHIH", data[offset:offset + 10])
+        offset += 10
+        ttl_min = ttl if ttl_min is None else min(ttl_min, ttl)
+        if rtype == DNS_TYPE_A and rclass == 1 and length == 4:
+            return socket.inet_ntoa(data[offset:offset + 4]), ttl_min
+        offset += length
+    return None
+
+
+def dns_query(name, server, port=53, timeout=0.75, attempts=2):
+    """Resolve a name like `BinaryClockNTP::queryDns()`: returns (address, ttl), None if it has no address
+    or there is no reply."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.settimeout(timeout)
+        query_id = random.randrange(1 << 16)
+        for _ in range(attempts):
+            sock.sendto(dns_make_query(name, query_id), (server, port))
+            try:
+                while True:
+                    data, source = sock.recvfrom(512)
+                    if source[0] != server:
+                        continue
+                    try:
+                        return dns_parse_reply(data, query_id)
+                    except ValueError:
+                        continue
+            except socket.timeout:
+                continue
+    return None
+
+
+class StubResolver:
+    """A DNS server with fixed A and CNAME records and a TTL, that can stop answering; on its own thread."""
+
+    def __init__(self, records, host="127.0.0.1", port=0, cnames=None):
+        self.records = dict(records)            # name: (address, ttl)
+        self.cnames = dict(cnames or {})        # alias: (name, ttl)
+        self.down = False
+        self.queries = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind((host, port))
+        self.sock.settimeout(0.2)
+        self.address = self.sock.getsockname()
+        self._stop = threading.Event()
+        self._thread = threading.Thread(target=self.run, daemon=True)
+
+    def start(self):
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop.set()
+        self._thread.join()
+        self.sock.close()
+
+    def run(self):
+        while not self._stop.is_set():
+            try:
+                data, client = self.sock.recvfrom(512)
+            except socket.timeout:
+                continue
+            self.queries += 1
+            if self.down or len(data) < 12:
+                continue
+            reply = self.answer(data)
+            if reply:
+                self.sock.sendto(reply, client)
+
+    def answer(self, data):
+        query_id, _, questions = struct.unpack("!HHH", data[:6])
+        end = dns_skip_name(data, 12)
+        labels, offset = [], 12
+        while data[offset]:
+            labels.append(data[offset + 1:offset + 1 + data[offset]].decode())
+            offset += 1 + data[offset]
+        name = ".".join(labels).lower()
+        question = data[12:end + 4]
+        answers = []
+        owner = b"\xc0\x0c"                     # A pointer to the name in the question.
+        while name in self.cnames:
+            target, ttl = self.cnames[name]
+            rdata = dns_name(target)
+            answers.append(owner + struct.pack("!HHIH", DNS_TYPE_CNAME, 1, ttl, len(rdata)) + rdata)
+            owner, name = rdata, target
+        if name not in self.records:
+            return struct.pack("!HHHHHH", query_id, 0x8183, 1, 0, 0, 0) + question    # NXDOMAIN
+        address, ttl = self.records[name]
+        answers.append(owner + struct.pack("!HHIH", DNS_TYPE_A, 1, ttl, 4) + socket.inet_aton(address))
+        return struct.pack("!HHHHHH", query_id, 0x8180, 1, len(answers), 0, 0) + question + b"".join(answers)
+
+
+class DnsCache:
+    """The resolved addresses, the same rules as `DnsCache` and `BinaryClockNTP::ResolveServer()` (times in seconds)."""
+
+    def __init__(self, resolve):
+        self.resolve = resolve                  # name -> (address, ttl) or None
+        self.entries = {}                       # name: [address, stored, ttl, in use]
+        self.hits = self.stale = self.misses = self.failures = 0
+
+    def lookup(self, name, now):
+        """Returns (address, stale) like `ResolveServer()`, a miss is resolved now; None if it can't be."""
+        entry = self.entries.get(name)
+        if entry is not None and now - entry[1] >= entry[2] + DNS_CACHE_STALE:
+            del self.entries[name]
+            entry = None
+        if entry is None:
+            self.misses += 1
+            return (self.entries[name][0], False) if self.store(name, now) else None
+        entry[3] = True
+        if now - entry[1] < entry[2]:
+            self.hits += 1
+            return entry[0], False
+        self.stale += 1
+        return entry[0], True
+
+    def store(self, name, now):
+        """Resolve now and store it, `lookupServer()`; the cached address is kept if it fails."""
+        result = self.resolve(name)
+        if result is None:
+            self.failures += 1
+            return False
+        self.entries[name] = [result[0], now, min(max(result[1], DNS_CACHE_MIN_TTL), DNS_CACHE_MAX_TTL), False]
+        return True
+
+    def refresh_due(self, now):
+        """`RefreshDns()`: the names in use that are stale or within the refresh time of their TTL."""
+        for name, entry in list(self.entries.items()):
+            if entry[3] and now - entry[1] + DNS_CACHE_REFRESH >= entry[2]:
+                self.store(name, now)
+
+    def hit_rate(self):
+        lookups = self.hits + self.stale + self.misses
+        return 100 * (self.hits + self.stale) // lookups if lookups else 0
+
+
+def per_server(text, count, kind=float):
+    values = [kind(value) for value in str(text).split(",")]
+    return (values + values[-1:] * count)[:count]
+
+
+def cmd_serve(args):
+    offsets = per_server(args.offset, args.count)
+    delays = per_server(args.delay, args.count)
+    servers = []
+    for i in range(args.count):
+        server = StandinServer(args.host, args.port + i if args.port else 0, offsets[i], delays[i], args.stratum, args.li, args.kod).start()
+        servers.append(server)
+        print("NTP stand-in on %s:%d offset=%+.6f s delay=%.6f s%s" % (server.address[0], server.address[1], offsets[i], delays[i],
+                                                                     (" KoD=" + args.kod) if args.kod else ""))
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    for server in servers:
+        server.stop()
+    print("%d requests served" % sum(server.requests for server in servers))
+    return 0
+
+
+def parse_server(text, port):
+    host, _, number = text.partition(":")
+    return host, int(number) if number else port
+
+
+def cmd_query(args):
+    servers = [parse_server(text, args.port) for text in args.server]
+    if args.burst:
+        replies, kisses, timeouts = burst(servers[0][0], servers[0][1], args.burst, args.timeout)
+        print("%d requests: %d replies, %d KoD, %d no reply" % (args.burst, replies, kisses, timeouts))
+        return 0
+    if len(servers) == 1:
+        try:
+            result = query(servers[0][0], servers[0][1], args.timeout)
+        except (OSError, ValueError) as error:
+            print("Query failed: %s" % error)
+            return 1
+        print("offset %+.6f s  delay %.6f s  stratum %d  refid %s  root delay %.6f s  root dispersion %.6f s"
+              % (result["offset"], result["delay"], result["stratum"], refid_text(result["stratum"], result["refid"]),
+                 result["root_delay"], result["root_dispersion"]))
+        return 0
+
+    selection, samples, elapsed = query_many(servers, args.timeout)
+    for index, (host, port) in enumerate(servers):
+        sample = samples.get(index)
+        if sample is None:
+            print("  %s:%d  no valid reply" % (host, port))
+        else:
+            mark = "*" if selection and index == selection[1] else ("+" if selection and index in selection[2] else "-")
+            print("%s %s:%d  offset %+.6f s  delay %.6f s  distance %.6f s" % (mark, host, port, sample["offset"], sample["delay"], sample["distance"]))
+    if selection is None:
+        print("No majority of the servers agree (%.3f s)" % elapsed)
+        return 1
+    print("Selected offset %+.6f s from %d servers in %.3f s" % (selection[0], len(selection[2]), elapsed))
+    return 0
+
+
+def cmd_poll(args):
+    change = tuple(float(v) for v in args.change.split(":")) if args.change else None
+    kod = tuple(int(v) for v in args.kod.split(":")) if args.kod else None
+    if change:
+        change = (int(change[0]), change[1])
+    trace = drift_trace(args.ppm, args.noise, args.steps, change, kod)
+    print("  sync      time (h)   offset (ms)  next interval")
+    for step, (now, offset, poll) in enumerate(trace):
+        print("  %4d  %12.2f  %12.3f  2^%d = %d s" % (step, now / 3600.0, offset * 1000.0, poll, 1 << poll))
+    print("%d syncs in %.1f days" % (len(trace), trace[-1][0] / 86400.0))
+    return 0
+
+
+def cmd_dns(args):
+    records, cnames = {}, {}
+    for text in args.record:
+        name, _, value = text.partition("=")
+        address, _, ttl = value.partition(":")
+        records[name.lower()] = (address, int(ttl) if ttl else 300)
+    for text in args.cname:
+        name, _, value = text.partition("=")
+        target, _, ttl = value.partition(":")
+        cnames[name.lower()] = (target.lower(), int(ttl) if ttl else 300)
+    resolver = StubResolver(records, args.host, args.port, cnames).start()
+    print("DNS stub resolver on %s:%d, %d names" % (resolver.address[0], resolver.address[1], len(records) + len(cnames)))
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    resolver.stop()
+    print("%d queries" % resolver.queries)
+    return 0
+
+
+def cmd_duty(args):
+    duty, now, syncs, late = duty_trace(args.ppm, args.days, args.connect, args.fail)
+    print("%d syncs and %d wakes (%d not connected) in %.1f days, the lead is %.2f s" % (syncs, duty.wakes, duty.failures, now / 86400.0, duty.lead))
+    print("radio on %.1f s/day (%.3f%%), %.3f mA average (always on: %.0f mA)" % (duty.on_per_day(now), 100.0 * duty.on_time / now,
+                                                                             duty.average_ma(now), WIFI_DUTY_ON_MA))
+    print("latest sync %.2f s after its scheduled time" % late)
+    return 0
+
+
+def check(name, condition):
+    print("  %-46s %s" % (name, "ok" if condition else "FAILED"))
+    return condition
+
+
+def selftest():
+    ok = True
+    print("Stand-in server self test:")
+    for offset, delay in ((0.0, 0.0), (0.25, 0.02), (-1.5, 0.1), (3600.125, 0.05)):
+        server = StandinServer(offset=offset, delay=delay).start()
+        result = query(*server.address)
+        server.stop()
+        ok &= check("offset %+.3f s delay %.3f s" % (offset, delay),
+                    abs(result["offset"] - offset) < 0.005 and abs(result["delay"] - delay) < 0.01)
+
+    server = StandinServer(kod="RATE").start()
+    try:
+        query(*server.address)
+        ok &= check("KoD reply rejected", False)
+    except ValueError:
+        ok &= check("KoD reply rejected", True)
+    server.stop()
+
+    server = StandinServer(li=3).start()
+    try:
+        query(*server.address)
+        ok &= check("unsynchronized (LI=3) reply rejected", False)
+    except ValueError:
+        ok &= check("unsynchronized (LI=3) reply rejected", True)
+    server.stop()
+
+    ok &= check("timestamp round trip", abs(from_ntp(to_ntp(1700000000.123456)) - 1700000000.123456) < 1e-6)
+
+    # Several servers queried together: delays, a liar, a dead server and a KoD.
+    servers = [StandinServer(offset=0.0, delay=0.01).start(), StandinServer(offset=0.002, delay=0.03).start(),
+               StandinServer(offset=-0.001, delay=0.02).start(), StandinServer(offset=2.5, delay=0.005).start()]
+    selection, samples, elapsed = query_many([s.address for s in servers], timeout=2.0)
+    ok &= check("liar discarded by the intersection", selection is not None and 3 not in selection[2] and len(selection[2]) == 3)
+    ok &= check("selected offset close to the truechimers", selection is not None and abs(selection[0]) < 0.005)
+    ok &= check("best server has the smallest distance", selection is not None and selection[1] == 0)
+    ok &= check("latency set by the fast servers (%.3f s)" % elapsed, elapsed < 0.5)
+    for server in servers:
+        server.stop()
+
+    servers = [StandinServer(delay=0.01).start(), StandinServer(delay=0.02).start(), StandinServer(delay=5.0).start()]
+    selection, samples, elapsed = query_many([s.address for s in servers], timeout=2.0)
+    ok &= check("slow server doesn't hold the sync (%.3f s)" % elapsed, selection is not None and elapsed < 0.2 and len(samples) == 2)
+    for server in servers:
+        server.stop()
+
+    servers = [StandinServer(offset=0.0).start(), StandinServer(offset=3.0).start()]
+    selection, samples, elapsed = query_many([s.address for s in servers], timeout=0.5)
+    ok &= check("two servers that disagree: no majority", selection is None and len(samples) == 2)
+    for server in servers:
+        server.stop()
+
+    servers = [StandinServer(offset=0.001).start(), StandinServer(kod="RATE").start(), StandinServer(offset=-0.001, delay=0.01).start()]
+    selection, samples, elapsed = query_many([s.address for s in servers], timeout=1.0)
+    ok &= check("KoD server ignored, others selected", selection is not None and 1 not in samples and len(selection[2]) == 2)
+    for server in servers:
+        server.stop()
+
+    # The adaptive poll interval against synthetic drift traces (2 ms of network noise).
+    def settled(trace):
+        return max(abs(offset) for _, offset, _ in trace[10:])
+
+    trace = drift_trace(2.0)
+    ok &= check("2 ppm (DS3231): poll grows to 2^14", trace[-1][2] == 14 and settled(trace) < NTP_OFFSET_TOLERANCE)
+    trace = drift_trace(20.0)
+    ok &= check("20 ppm crystal: poll held at 2^11", trace[-1][2] == 11 and settled(trace) < NTP_OFFSET_TOLERANCE)
+    trace = drift_trace(0.0, noise=0.0001)
+    ok &= check("no drift: poll grows to the maximum 2^17", trace[-1][2] == NTP_MAX_POLL)
+    trace = drift_trace(2.0, change=(30, 50.0))
+    ok &= check("drift change 2 -> 50 ppm: poll shrinks", trace[29][2] == 14 and trace[-1][2] <= 9 and abs(trace[-1][1]) < NTP_OFFSET_TOLERANCE)
+    trace = drift_trace(2.0, noise=0.08)
+    ok &= check("jitter above the tolerance: poll shrinks", trace[-1][2] < NTP_START_POLL)
+    trace = drift_trace(20.0, steps=8, kod=(3, 13))
+    ok &= check("KoD RATE: poll not below the server's", min(poll for _, _, poll in trace[3:]) >= 13)
+
+    # The radio duty cycle with the adaptive poll interval.
+    duty, now, syncs, late = duty_trace(2.0, days=7.0)
+    ok &= check("duty 2 ppm: radio on < 60 s/day (%.1f s)" % duty.on_per_day(now), duty.on_per_day(now) < 60.0)
+    ok &= check("duty 2 ppm: < 1 mA average (%.3f mA)" % duty.average_ma(now), duty.average_ma(now) < 1.0)
+    ok &= check("duty: the sync is on time, the lead (%.2f s)" % late, late < 1.0 and abs(duty.lead - 1.5) < 0.3)
+    duty, now, syncs, late = duty_trace(2.0, days=7.0, connect=5.0)
+    ok &= check("duty: slow reconnect, lead follows (%.2f s)" % duty.lead, abs(duty.lead - 5.5) < 1.5 and late < 5.0)
+    duty, now, syncs, late = duty_trace(20.0, days=2.0, fail=0.3)
+    ok &= check("duty: failed wakes retried (%d of %d)" % (duty.failures, duty.wakes), duty.failures > 0 and syncs > 20)
+    duty = DutyCycle()
+    ok &= check("duty: a short interval keeps the radio on", duty.synced(10.0, True, 20.0) == 20.0 and duty.on)
+    delays = [duty.failed(100.0, 600.0) for _ in range(6)]
+    ok &= check("duty: the retry doubles up to the interval", delays == [60.0, 120.0, 240.0, 480.0, 600.0, 600.0])
+
+    # The DNS cache against a stub resolver: a sync every 15 min, the refresh after each.
+    resolver = StubResolver({"pool.test": ("192.0.2.10", 300), "short.test": ("192.0.2.20", 5)},
+                            cnames={"time.test": ("pool.test", 120)}).start()
+    host, port = resolver.address
+    ok &= check("dns: A record and its TTL", dns_query("pool.test", host, port) == ("192.0.2.10", 300))
+    ok &= check("dns: CNAME chain, the smallest TTL", dns_query("time.test", host, port) == ("192.0.2.10", 120))
+    ok &= check("dns: unknown name has no address", dns_query("none.test", host, port) is None)
+    cache = DnsCache(lambda name: dns_query(name, host, port, timeout=0.2))
+    first = cache.lookup("pool.test", 0.0)
+    cache.lookup("short.test", 0.0)
+    in_sync = 0
+    for step in range(1, 97):
+        now = step * 900.0
+        queries = resolver.queries
+        cache.lookup("pool.test", now)
+        in_sync += resolver.queries - queries
+        cache.refresh_due(now)
+    ok &= check("dns: no DNS query in a sync after the first", first == ("192.0.2.10", False) and in_sync == 0)
+    ok &= check("dns: hit rate %d%% (%d stale)" % (cache.hit_rate(), cache.stale), cache.hit_rate() >= 97 and cache.stale == 96)
+    ok &= check("dns: TTL clamped to the minimum", cache.entries["short.test"][2] == DNS_CACHE_MIN_TTL)
+    ok &= check("dns: a name not in use isn't refreshed", cache.entries["short.test"][1] == 0.0)
+    resolver.down = True
+    now += 900.0
+    result = cache.lookup("pool.test", now)
+    cache.refresh_due(now)
+    ok &= check("dns: resolver down, last known good used", result == ("192.0.2.10", True) and cache.failures == 1)
+    ok &= check("dns: resolver down, a new name fails", cache.lookup("other.test", now) is None and cache.failures == 2)
+    resolver.down = False
+    resolver.records["pool.test"] = ("192.0.2.11", 300)
+    now += 900.0
+    cache.lookup("pool.test", now)
+    cache.refresh_due(now)
+    ok &= check("dns: the refresh picks up the new address", cache.lookup("pool.test", now + 1.0) == ("192.0.2.11", False))
+    ok &= check("dns: too old to use, resolved again", cache.lookup("pool.test", now + 300.0 + DNS_CACHE_STALE) == ("192.0.2.11", False))
+    resolver.stop()
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    serve = sub.add_parser("serve", help="run a stand-in NTP server")
+    serve.add_argument("--host", default="0.0.0.0")
+    serve.add_argument("--port", type=int, default=12300)
+    serve.add_argument("--offset", default="0", help="server clock error in seconds, comma separated per server")
+    serve.add_argument("--delay", default="0", help="round trip delay in seconds, comma separated per server")
+    serve.add_argument("--stratum", type=int, default=2)
+    serve.add_argument("--li", type=int, default=0, help="leap indicator (3 = unsynchronized)")
+    serve.add_argument("--kod", help="send a Kiss-o'-Death reply with the code, e.g. RATE")
+    serve.add_argument("--count", type=int, default=1, help="number of servers on consecutive ports")
+
+    client = sub.add_parser("query", help="query a NTP server")
+    client.add_argument("server", nargs="+", help="HOST or HOST:PORT, several are queried together")
+    client.add_argument("--port", type=int, default=NTP_PORT)
+    client.add_argument("--timeout", type=float, default=1.0)
+    client.add_argument("--burst", type=int, default=0, help="send N requests back to back to the first server")
+
+    poll = sub.add_parser("poll", help="run the adaptive poll interval on a synthetic drift trace")
+    poll.add_argument("--ppm", type=float, default=2.0, help="clock drift in ppm")
+    poll.add_argument("--noise", type=float, default=0.002, help="offset noise (standard deviation) in seconds")
+    poll.add_argument("--steps", type=int, default=60, help="number of syncs")
+    poll.add_argument("--change", help="SYNC:PPM change the drift at the sync")
+    poll.add_argument("--kod", help="SYNC:POLL send a KoD RATE with the poll exponent at the sync")
+
+    duty = sub.add_parser("duty", help="run the radio duty cycle with the adaptive poll interval")
+    duty.add_argument("--ppm", type=float, default=2.0, help="clock drift in ppm")
+    duty.add_argument("--days", type=float, default=7.0, help="time to run in days")
+    duty.add_argument("--connect", type=float, default=1.0, help="mean reconnect time in seconds")
+    duty.add_argument("--fail", type=float, default=0.0, help="fraction of the wakes that don't connect")
+
+    dns = sub.add_parser("dns", help="run a stub DNS resolver for the DNS cache")
+    dns.add_argument("--host", default="0.0.0.0")
+    dns.add_argument("--port", type=int, default=5353)
+    dns.add_argument("--record", action="append", default=[], help="NAME=ADDRESS[:TTL] an A record")
+    dns.add_argument("--cname", action="append", default=[], help="ALIAS=NAME[:TTL] a CNAME record")
+
+    sub.add_parser("selftest", help="check the client against stand-in servers, the poll controller, the duty cycle and the DNS cache")
+
+    args = parser.parse_args()
+    if args.command == "serve":
+        return cmd_serve(args)
+    if args.command == "query":
+        return cmd_query(args)
+    if args.command == "poll":
+        return cmd_poll(args)
+    if args.command == "duty":
+        return cmd_duty(args)
+    if args.command == "dns":
+        return cmd_dns(args)
+    return selftest()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+"""Host test of the peer to peer time sync (`PeerSync` and `BinaryClockPeerSync`).
+
+Each peer runs the same protocol as the firmware on a UDP socket with a virtual clock (an
+offset and a drift in ppm from the host clock):
+  - a beacon every BEACON seconds with the stratum and MAC, to all the other peers (the
+    firmware broadcasts on `PEER_SYNC_PORT`, the loopback peers each have their own port);
+  - the leader is the lowest (stratum, MAC) of the peers heard within TIMEOUT and the peer itself;
+  - a follower sends a request to the leader every POLL seconds, the offset and delay are
+    computed as in NTP, the sample with the smallest delay of the last 4 is stepped (> 50 ms)
+    or slewed (> 0.5 ms). The slew is applied at once, `adjtime()` takes a few ms on the ESP32.
+
+Usage:
+    peer_sync_sim.py run      [--count N] [--offset S,S,..] [--ppm P,P,..] [--stratum N,N,..]
+                              [--seconds S] [--stop I:S] [--scale X]
+    peer_sync_sim.py peer     [--port 12123] [--peers HOST:PORT,..] [--offset S] [--stratum N] [--mac XX:..]
+                              [--scale X]
+    peer_sync_sim.py selftest
+
+`run` starts `--count` peers on the loopback interface and prints the leader each one elected and
+its clock offset to the leader every second; `--stop 2:5` stops peer 2 after 5 s (the leader fails
+over). `--scale` shortens the protocol intervals (0.05: a beacon every 0.1 s) to run faster.
+`peer` runs one peer, e.g. on the LAN with the clocks (broadcast) or with `--peers` against other
+peers on the loopback interface; it prints the leader and the corrections.
+`selftest` checks the election (stratum, then MAC), the convergence of the followers to the leader
+within a millisecond and the failover when the leader stops.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import threading
+import time
+
+PEER_SYNC_PORT = 12123          # The same values as PeerSync.h
+PEER_SYNC_BEACON = 2.0
+PEER_SYNC_POLL = 4.0
+PEER_SYNC_TIMEOUT = 7.0
+PEER_SYNC_SAMPLES = 4
+PEER_SYNC_STEP = 0.050
+PEER_SYNC_DEADBAND = 0.0005
+PEER_SYNC_LOCAL_STRATUM = 15
+PEER_SYNC_VERSION = 1
+
+BEACON, REQUEST, RESPONSE = 1, 2, 3
+MESSAGE = struct.Struct("!2sBBBB6sqqq")     # magic, version, type, stratum, reserved, MAC, t1, t2, t3 (µs)
+
+
+class VirtualClock:
+    """The system clock of a peer: the host clock with an offset and a drift."""
+
+    def __init__(self, offset=0.0, ppm=0.0):
+        self.start = time.monotonic()
+        self.base = time.time() + offset
+        self.rate = 1.0 + ppm * 1e-6
+        self.lock = threading.Lock()
+
+    def now(self):
+        with self.lock:
+            return self.base + (time.monotonic() - self.start) * self.rate
+
+    def adjust(self, delta):
+        with self.lock:
+            self.base += delta
+
+
+class Peer:
+    """One peer: the protocol of `PeerSync` and the task of `BinaryClockPeerSync`."""
+
+    def __init__(self, mac, clock, stratum=PEER_SYNC_LOCAL_STRATUM, host="127.0.0.1", port=0, targets=None, scale=1.0):
+        self.mac = mac
+        self.clock = clock
+        self.stratum = stratum
+        self.targets = targets          # None: broadcast on the port.
+        self.beacon = PEER_SYNC_BEACON * scale
+        self.poll = PEER_SYNC_POLL * scale
+        self.timeout = PEER_SYNC_TIMEOUT * scale
+        self.peers = {}                 # MAC: [address, stratum, last]
+        self.leader_mac = mac
+        self.pending = 0
+        self.window = []
+        self.steps = 0
+        self.slews = 0
+        self.samples = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        if targets is None:
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+        self.sock.bind((host, port))
+        self.sock.settimeout(min(0.1, self.beacon / 4))
+        self.address = self.sock.getsockname()
+        self.running = False
+        self.thread = None
+
+    # The protocol, the same as PeerSync.cpp.
+    def pack(self, kind, t1=0, t2=0, t3=0):
+        return MESSAGE.pack(b"BC", PEER_SYNC_VERSION, kind, self.stratum, 0, self.mac, t1, t2, t3)
+
+    def elect(self, now):
+        best, key = None, (self.stratum, self.mac)
+        for mac, (address, stratum, last) in self.peers.items():
+            if now - last < self.timeout and (stratum, mac) < key:
+                best, key = mac, (stratum, mac)
+        leader_mac = best if best is not None else self.mac
+        if leader_mac != self.leader_mac:
+            self.leader_mac = leader_mac
+            self.pending = 0
+            self.window = []
+        return best
+
+    def receive(self, data, address, now, receive_us):
+        if len(data) < MESSAGE.size:
+            return None
+        magic, version, kind, stratum, _, mac, t1, t2, t3 = MESSAGE.unpack(data[:MESSAGE.size])
+        if magic != b"BC" or version != PEER_SYNC_VERSION or kind not in (BEACON, REQUEST, RESPONSE) or mac == self.mac:
+            return None
+        self.peers[mac] = [address, stratum or PEER_SYNC_LOCAL_STRATUM, now]
+        if kind == REQUEST:
+            return self.pack(RESPONSE, t1, receive_us, int(self.clock.now() * 1e6))
+        if kind == RESPONSE:
+            if self.pending == 0 or t1 != self.pending or self.elect(now) != mac:
+                return None
+            self.pending = 0
+            offset = ((t2 - t1) + (t3 - receive_us)) / 2e6
+            delay = max(0.0, ((receive_us - t1) - (t3 - t2)) / 1e6)
+            self.window = (self.window + [[offset, delay]])[-PEER_SYNC_SAMPLES:]
+            self.samples += 1
+            self.correct()
+        else:
+            self.elect(now)
+        return None
+
+    def correct(self):
+        if not self.window:
+            return
+        offset = min(self.window, key=lambda sample: sample[1])[0]
+        if abs(offset) > PEER_SYNC_STEP:
+            self.window = []
+            self.clock.adjust(offset)
+            self.steps += 1
+        elif abs(offset) > PEER_SYNC_DEADBAND:
+            for sample in self.window:
+                sample[0] -= offset
+            self.clock.adjust(offset)
+            self.slews += 1
+
+    # The task.
+    def send(self, data, address):
+        try:
+            self.sock.sendto(data, address)
+        except OSError:
+            pass
+
+    def run(self):
+        beacon_at = 0.0
+        poll_at = time.monotonic()
+        while self.running:
+            now = time.monotonic()
+            if now - beacon_at >= self.beacon:
+                beacon_at = now
+                message = self.pack(BEACON, 0, 0, int(self.clock.now() * 1e6))
+                for target in (self.targets if self.targets is not None else [("255.255.255.255", self.address[1])]):
+                    if target != self.address:
+                        self.send(message, target)
+            if now - poll_at >= self.poll:
+                poll_at = now
+                leader = self.elect(now)
+                if leader is not None:
+                    self.pending = int(self.clock.now() * 1e6)
+                    self.send(self.pack(REQUEST, self.pending), self.peers[leader][0])
+            try:
+                data, address = self.sock.recvfrom(2 * MESSAGE.size)
+            except socket.timeout:
+                continue
+            except OSError:
+                break
+            reply = self.receive(data, address, time.monotonic(), int(self.clock.now() * 1e6))
+            if reply is not None:
+                self.send(reply, address)
+
+    def leader(self):
+        best = self.elect(time.monotonic())
+        return self.mac if best is None else best
+
+    def start(self):
+        self.running = True
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+        return self
+
+    def stop(self):
+        self.running = False
+        self.thread.join()
+        self.sock.close()
+
+
+def mac_text(mac):
+    return ":".join("%02x" % byte for byte in mac)
+
+
+def per_peer(text, count, kind=float):
+    values = [kind(value) for value in str(text).split(",")]
+    return (values + values[-1:] * count)[:count]
+
+
+def start_peers(offsets, ppms, strata, scale):
+    """Start the peers on the loopback interface, peer i has the MAC 02:00:00:00:00:(i+1)."""
+    peers = [Peer(bytes([2, 0, 0, 0, 0, i + 1]), VirtualClock(offsets[i], ppms[i]), strata[i], scale=scale)
+             for i in range(len(offsets))]
+    targets = [peer.address for peer in peers]
+    for peer in peers:
+        peer.targets = targets
+    return [peer.start() for peer in peers]
+
+
+def spread(peers, leader):
+    """The largest clock offset (s) of the peers to the leader, read at the same instant."""
+    reference = leader.clock.now()
+    return max(abs(peer.clock.now() - reference) for peer in peers)
+
+
+def cmd_run(args):
+    count = args.count
+    peers = start_peers(per_peer(args.offset, count), per_peer(args.ppm, count), per_peer(args.stratum, count, int), args.scale)
+    stop = tuple(float(v) for v in args.stop.split(":")) if args.stop else None
+    started = time.monotonic()
+    try:
+        while time.monotonic() - started < args.seconds:
+            time.sleep(1.0)
+            elapsed = time.monotonic() - started
+            if stop and elapsed >= stop[1] and peers[int(stop[0])].running:
+                peers[int(stop[0])].stop()
+                print("  peer %d stopped" % int(stop[0]))
+            live = [peer for peer in peers if peer.running]
+            leaders = {peer.leader() for peer in live}
+            leader = next((peer for peer in live if peer.mac in leaders), live[0])
+            print("%5.1f s  leader %s  offsets (ms) %s" % (elapsed, ", ".join(mac_text(mac)[-2:] for mac in sorted(leaders)),
+                  "  ".join("%+8.3f" % ((peer.clock.now() - leader.clock.now()) * 1000.0) for peer in live)))
+    except KeyboardInterrupt:
+        pass
+    for peer in peers:
+        if peer.running:
+            peer.stop()
+    print("steps %s  slews %s" % ([peer.steps for peer in peers], [peer.slews for peer in peers]))
+    return 0
+
+
+def cmd_peer(args):
+    mac = bytes(int(part, 16) for part in args.mac.split(":"))
+    targets = None
+    if args.peers:
+        targets = [(host, int(port)) for host, _, port in (text.partition(":") for text in args.peers.split(","))]
+    peer = Peer(mac, VirtualClock(args.offset), args.stratum, "0.0.0.0" if targets is None else "127.0.0.1", args.port, targets,
+                args.scale).start()
+    print("Peer %s on port %d, stratum %d, offset %+.3f s" % (mac_text(mac), peer.address[1], args.stratum, args.offset))
+    try:
+        while True:
+            time.sleep(PEER_SYNC_POLL * args.scale)
+            print("  leader %s  peers %d  samples %d  steps %d  slews %d" % (mac_text(peer.leader()), len(peer.peers), peer.samples,
+                                                                           peer.steps, peer.slews))
+    except KeyboardInterrupt:
+        pass
+    peer.stop()
+    return 0
+
+
+def check(name, condition):
+    print("  %-50s %s" % (name, "ok" if condition else "FAILED"))
+    return condition
+
+
+def selftest():
+    ok = True
+    scale = 0.05    # A beacon every 0.1 s, a request every 0.2 s.
+    print("Peer sync self test:")
+
+    peers = start_peers([0.35, -0.2, 0.05, 1.2], [0.0, 20.0, -15.0, 40.0], [15, 15, 3, 15], scale)
+    time.sleep(3.0)
+    ok &= check("the lowest stratum leads", all(peer.leader() == peers[2].mac for peer in peers))
+    error = spread(peers, peers[2])
+    ok &= check("followers within 1 ms of the leader (%.3f ms)" % (error * 1000.0), error < 0.001)
+    ok &= check("large offsets stepped, then slewed", all(peers[i].steps >= 1 for i in (0, 1, 3)) and peers[2].steps == 0)
+
+    peers[2].stop()
+    live = [peers[0], peers[1], peers[3]]
+    time.sleep(3.0)
+    ok &= check("leader stopped: the lowest MAC leads", all(peer.leader() == peers[0].mac for peer in live))
+    error = spread(live, peers[0])
+    ok &= check("followers within 1 ms of the new leader (%.3f ms)" % (error * 1000.0), error < 0.001)
+    for peer in live:
+        peer.stop()
+
+    peers = start_peers([0.0, 0.004, -0.003], [0.0] * 3, [15] * 3, scale)
+    time.sleep(2.0)
+    ok &= check("equal strata: the lowest MAC leads", all(peer.leader() == peers[0].mac for peer in peers))
+    error = spread(peers, peers[0])
+    ok &= check("small offsets slewed, not stepped (%.3f ms)" % (error * 1000.0),
+                error < 0.001 and all(peer.steps == 0 for peer in peers) and peers[1].slews >= 1)
+    for peer in peers:
+        peer.stop()
+
+    peer = Peer(bytes([2, 0, 0, 0, 0, 9]), VirtualClock())
+    ok &= check("own and malformed messages ignored", peer.receive(peer.pack(REQUEST, 1), ("127.0.0.1", 1), 0.0, 0) is None
+                and peer.receive(b"XX" + peer.pack(BEACON)[2:], ("127.0.0.1", 1), 0.0, 0) is None and not peer.peers)
+    peer.sock.close()
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    run = sub.add_parser("run", help="run several peers on the loopback interface")
+    run.add_argument("--count", type=int, default=4)
+    run.add_argument("--offset", default="0.35,-0.2,0.05,1.2", help="clock offsets in seconds, comma separated per peer")
+    run.add_argument("--ppm", default="0,20,-15,40", help="clock drifts in ppm, comma separated per peer")
+    run.add_argument("--stratum", default="15", help="strata, comma separated per peer")
+    run.add_argument("--seconds", type=float, default=10.0)
+    run.add_argument("--stop", help="PEER:SECONDS stop the peer after the time")
+    run.add_argument("--scale", type=float, default=0.25, help="scale of the protocol intervals")
+
+    peer = sub.add_parser("peer", help="run one peer, broadcast on the LAN or with --peers")
+    peer.add_argument("--port", type=int, default=PEER_SYNC_PORT)
+    peer.add_argument("--peers", help="HOST:PORT,.. the other peers instead of the broadcast")
+    peer.add_argument("--offset", type=float, default=0.0, help="clock offset in seconds")
+    peer.add_argument("--stratum", type=int, default=PEER_SYNC_LOCAL_STRATUM)
+    peer.add_argument("--mac", default="02:00:00:00:00:ff")
+    peer.add_argument("--scale", type=float, default=1.0, help="scale of the protocol intervals, e.g. a test build")
+
+    sub.add_parser("selftest", help="check the election, the convergence and the failover")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        return cmd_run(args)
+    if args.command == "peer":
+        return cmd_peer(args)
+    return selftest()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
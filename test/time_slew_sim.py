@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""Virtual time host test of the RTC time slew (`BCTimeSlew` and `BinaryClock::slewTime()`).
+
+A virtual DS3231 runs on a virtual millisecond clock: it ticks once a second (plus its drift,
+trimmed by the aging offset register), the countdown restarts when the time is written and an
+alarm flag is set when a tick reaches the alarm second. The clock side is the same algorithm as
+the firmware: on each tick (after a dispatch latency) the planned phase shift is made by writing
+the current second again late (lose) or the next second early (gain), never into or out of an
+alarm second. Offsets larger than `BC_SLEW_MAX_MS` are stepped.
+
+Usage:
+    time_slew_sim.py run      [--offset MS] [--latency MS] [--alarm SEC] [--drift PPM]
+    time_slew_sim.py selftest
+
+`run` prints the correction of one offset: the seconds shown, how long each was shown and the
+alarms. `selftest` checks that every second and every alarm is shown exactly once for positive,
+negative, small and large offsets, that large offsets are stepped and that the aging offset
+converges on a drifting RTC.
+"""
+
+import argparse
+import sys
+
+BC_SLEW_STEP_MS = 100           # The same values as BCTimeSlew.h
+BC_SLEW_MAX_MS = 60000
+BC_SLEW_MIN_MS = 20
+BC_AGING_PPB = 100
+BC_AGING_STEP = 2
+BC_AGING_MIN_S = 3600
+
+
+class TimeSlew:
+    """The correction plan, the same algorithm as `BCTimeSlew`."""
+
+    def __init__(self):
+        self.remaining = 0
+        self.residual = 0
+        self.drift_ppb = 0
+        self.new_drift = False
+
+    def start(self, offset_ms, elapsed_s=0):
+        if abs(offset_ms) > BC_SLEW_MAX_MS:
+            self.remaining = 0
+            return False
+        if elapsed_s >= BC_AGING_MIN_S and self.remaining == 0:
+            self.drift_ppb = int((offset_ms - self.residual) * 1000000 / elapsed_s)
+            self.new_drift = True
+        if abs(offset_ms) < BC_SLEW_MIN_MS:
+            self.remaining, self.residual = 0, offset_ms
+        else:
+            self.remaining, self.residual = offset_ms, 0
+        return True
+
+    def next_shift(self, blocked=False):
+        if self.remaining == 0 or blocked:
+            return 0
+        shift = max(-BC_SLEW_STEP_MS, min(BC_SLEW_STEP_MS, self.remaining))
+        self.remaining -= shift
+        return shift
+
+    def undo(self, shift):
+        self.remaining += shift
+        if abs(self.remaining) < BC_SLEW_MIN_MS:
+            self.remaining, self.residual = 0, self.remaining
+
+    def aging_offset(self, current):
+        if not self.new_drift:
+            return current
+        self.new_drift = False
+        half = BC_AGING_PPB // 2
+        change = -int((self.drift_ppb + half if self.drift_ppb >= 0 else self.drift_ppb - half) / BC_AGING_PPB)
+        change = max(-BC_AGING_STEP, min(BC_AGING_STEP, change))
+        return max(-128, min(127, current + change))
+
+
+class VirtualRtc:
+    """A DS3231 on virtual time (ms): second counter, countdown phase, alarm and aging offset."""
+
+    def __init__(self, second, drift_ppm=0.0):
+        self.second = second
+        self.start = 0.0              # Virtual time the current second started.
+        self.drift_ppm = drift_ppm    # +ve: the RTC is slow.
+        self.aging = 0
+        self.alarms = set()
+        self.fired = []
+
+    @property
+    def period(self):
+        # ~0.1 ppm per aging LSB, +ve aging slows the oscillator.
+        return 1000.0 * (1.0 + (self.drift_ppm + self.aging * BC_AGING_PPB / 1000.0) * 1e-6)
+
+    def next_tick(self):
+        return self.start + self.period
+
+    def tick(self):
+        self.start = self.next_tick()
+        self.second += 1
+        if self.second in self.alarms:
+            self.fired.append(self.second)
+
+    def write(self, now, second):
+        self.second = second
+        self.start = now
+
+    def offset(self, now):
+        """Correct time - RTC time in ms (the correct time is the virtual time)."""
+        return now - (self.second * 1000.0 + (now - self.start))
+
+
+def correct(rtc, slew, now, latency=3.0, limit=2000):
+    """Run the clock until the correction is done, returns (now, shown) shown = [(second, start ms)]."""
+    shown = [(rtc.second, rtc.start)]
+    last_second = None
+    for _ in range(limit):
+        if not slew.remaining:
+            break
+        now = rtc.next_tick()
+        rtc.tick()
+        shown.append((rtc.second, now))
+
+        dispatch = now + latency
+        # BinaryClock::slewTime(), once per second, the tick was at `now`.
+        while True:
+            if rtc.second == last_second:
+                break
+            last_second = rtc.second
+            blocked = any(s in rtc.alarms for s in (rtc.second, rtc.second + 1))
+            shift = slew.next_shift(blocked)
+            if shift == 0:
+                break
+            write_at = rtc.start + (-shift if shift < 0 else 1000 - shift)
+            if write_at < dispatch:
+                slew.undo(shift)
+                break
+            if shift < 0:
+                rtc.write(write_at, rtc.second)
+                break
+            rtc.write(write_at, rtc.second + 1)          # Gain: dispatched like a tick.
+            shown.append((rtc.second, write_at))
+            dispatch = write_at + latency
+            now = write_at
+    return now, shown
+
+
+def adjust(rtc, slew, now, offset_ms, elapsed_s=0, latency=3.0):
+    """BinaryClock::AdjustTime(): slew, or step when the offset is too large."""
+    if slew.start(int(offset_ms), elapsed_s):
+        aging = slew.aging_offset(rtc.aging)
+        rtc.aging = aging
+        return True, correct(rtc, slew, now, latency)
+    rtc.write(now - now % 1000, int(now // 1000))          # set_Time() on the second boundary.
+    return False, (now, [])
+
+
+def make_rtc(now, offset_ms):
+    """A RTC `offset_ms` behind (+ve) the correct time `now` (ms)."""
+    rtc_ms = now - offset_ms
+    rtc = VirtualRtc(second=int(rtc_ms // 1000))
+    rtc.start = now - (rtc_ms - rtc.second * 1000)
+    return rtc
+
+
+def run_offset(offset_ms, latency=3.0, alarm_in=None, drift_ppm=0.0):
+    now = 1_000_000_437.0
+    rtc = make_rtc(now, offset_ms)
+    rtc.drift_ppm = drift_ppm
+    if alarm_in is not None:
+        rtc.alarms.add(rtc.second + alarm_in)
+    measured = rtc.offset(now)
+    slew = TimeSlew()
+    slewed, (end, shown) = adjust(rtc, slew, now, measured, latency=latency)
+    while alarm_in is not None and rtc.second <= max(rtc.alarms):   # Run on past the alarm.
+        rtc.tick()
+        shown.append((rtc.second, rtc.start))
+    return rtc, slew, slewed, measured, end, shown
+
+
+def check(name, condition):
+    print("  %-52s %s" % (name, "ok" if condition else "FAILED"))
+    return condition
+
+
+def once_each(shown):
+    seconds = [s for s, _ in shown]
+    return all(b == a + 1 for a, b in zip(seconds, seconds[1:]))
+
+
+def durations(shown):
+    return [b[1] - a[1] for a, b in zip(shown, shown[1:])]
+
+
+def selftest():
+    ok = True
+    print("Time slew self test (virtual time):")
+    for offset in (1500.0, -1500.0, 250.0, -80.0, 59000.0, -59000.0):
+        rtc, slew, slewed, measured, end, shown = run_offset(offset, alarm_in=5)
+        d = durations(shown)
+        ok &= check("offset %+.0f ms: slewed" % offset, slewed and slew.remaining == 0)
+        ok &= check("offset %+.0f ms: each second shown once" % offset, once_each(shown))
+        ok &= check("offset %+.0f ms: seconds last 0.9 - 1.1 s" % offset,
+                    all(1000 - BC_SLEW_STEP_MS - 1 <= x <= 1000 + BC_SLEW_STEP_MS + 1 for x in d))
+        ok &= check("offset %+.0f ms: alarm fired once" % offset, rtc.fired == sorted(rtc.alarms))
+        ok &= check("offset %+.0f ms: residual %.1f ms < %d ms" % (offset, rtc.offset(end), BC_SLEW_MIN_MS),
+                    abs(rtc.offset(end)) < BC_SLEW_MIN_MS)
+        ok &= check("offset %+.0f ms: done in %.0f s" % (offset, (end - shown[0][1]) / 1000.0),
+                    (end - shown[0][1]) <= (abs(offset) / BC_SLEW_STEP_MS + 10) * (1000.0 + BC_SLEW_STEP_MS))
+
+    rtc, slew, slewed, measured, end, shown = run_offset(10.0)
+    ok &= check("offset below %d ms: nothing to do" % BC_SLEW_MIN_MS, slewed and len(shown) == 1)
+    rtc, slew, slewed, measured, end, shown = run_offset(3600000.0)
+    ok &= check("offset 1 h: stepped", not slewed and abs(rtc.offset(end)) < 1000.0)
+
+    # A drifting RTC synced every 4 hours: the aging offset takes out the drift.
+    rtc = make_rtc(0.0, 0.0)
+    rtc.drift_ppm = 2.0
+    slew = TimeSlew()
+    now = 0.0
+    for _ in range(12):
+        target = now + 4 * 3600 * 1000.0
+        while rtc.next_tick() <= target:
+            rtc.tick()
+        now = target
+        slewed, (now, _) = adjust(rtc, slew, now, rtc.offset(now), elapsed_s=4 * 3600)
+    residual = rtc.drift_ppm + rtc.aging * BC_AGING_PPB / 1000.0
+    ok &= check("2 ppm drift: aging %+d leaves %.2f ppm" % (rtc.aging, residual), abs(residual) <= 0.1)
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def cmd_run(args):
+    rtc, slew, slewed, measured, end, shown = run_offset(args.offset, args.latency, args.alarm, args.drift)
+    print("Offset %+.1f ms: %s" % (measured, "slewed" if slewed else "stepped"))
+    for (second, start), length in zip(shown, durations(shown) + [None]):
+        mark = " alarm" if second in rtc.alarms else ""
+        print("  second %d at %.1f ms%s%s" % (second, start, "" if length is None else "; shown %.1f ms" % length, mark))
+    print("Residual %.1f ms; alarms fired: %s" % (rtc.offset(end), rtc.fired))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    run = sub.add_parser("run", help="correct one offset and print the seconds shown")
+    run.add_argument("--offset", type=float, default=1500.0, help="correct time - RTC time in ms")
+    run.add_argument("--latency", type=float, default=3.0, help="tick to dispatch latency in ms")
+    run.add_argument("--alarm", type=int, help="an alarm N seconds after the start")
+    run.add_argument("--drift", type=float, default=0.0, help="RTC drift in ppm (+ve slow)")
+    sub.add_parser("selftest", help="check the slew on virtual time")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        return cmd_run(args)
+    return selftest()
+
+
+if __name__ == "__main__":
+    sys.exit(main())